@@ -173,8 +173,7 @@ glusterfs_ctx_defaults_init(glusterfs_ctx_t *ctx)
         goto out;
     }
 
-    INIT_LIST_HEAD(&pool->all_frames);
-    LOCK_INIT(&pool->lock);
+    call_pool_init(pool);
     ctx->pool = pool;
 
     cmd_args = &ctx->cmd_args;
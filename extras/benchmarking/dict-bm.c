@@ -0,0 +1,167 @@
+/*
+   Copyright (c) 2026 Red Hat, Inc. <http://www.redhat.com>
+   This file is part of GlusterFS.
+
+   This file is licensed to you under your choice of the GNU Lesser
+   General Public License, version 3 or any later version (LGPLv3 or
+   later), or the GNU General Public License, version 2 (GPLv2), in all
+   cases as published by the Free Software Foundation.
+*/
+
+/*
+ * dict-bm: micro benchmark of the dict_t operations done for every fop's
+ * xdata. Each pass builds a dict shaped like the xdata of one translator,
+ * looks every key up, serializes it, unserializes it again and deletes
+ * the keys. Build it against the libglusterfs to be measured, e.g.
+ *
+ *   gcc -O2 -D_GNU_SOURCE -D_FILE_OFFSET_BITS=64 -DGF_LINUX_HOST_OS \
+ *       dict-bm.c -lgfapi -lglusterfs -o dict-bm
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include <glusterfs/api/glfs.h>
+#include <glusterfs/dict.h>
+
+#define DICT_BM_MAX_KEYS 32
+
+struct dict_bm_shape {
+    const char *name;
+    const char *keys[DICT_BM_MAX_KEYS];
+    int vallen; /* 0 for a number */
+};
+
+static struct dict_bm_shape shapes[] = {
+    {"afr",
+     {"trusted.afr.dirty", "trusted.afr.vol-client-0",
+      "trusted.afr.vol-client-1", "trusted.afr.vol-client-2",
+      "glusterfs.inodelk-count", "glusterfs.entrylk-count", NULL},
+     12},
+    {"ec",
+     {"trusted.ec.version", "trusted.ec.size", "trusted.ec.dirty",
+      "trusted.ec.config", "glusterfs.inodelk-count", "list-xattr", NULL},
+     16},
+    {"dht",
+     {"trusted.glusterfs.dht", "trusted.glusterfs.dht.linkto",
+      "glusterfs.open-fd-count", "trusted.glusterfs.dht.mds",
+      "trusted.gfid2path.0123456789abcdef", "trusted.glusterfs.mdata",
+      "security.selinux", "system.posix_acl_access",
+      "system.posix_acl_default", "user.swift.metadata",
+      "glusterfs.content", "gfid-req", NULL},
+     0},
+    {NULL}};
+
+static double
+dict_bm_now(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static int
+dict_bm_pass(struct dict_bm_shape *shape, char *value)
+{
+    dict_t *dict = NULL;
+    dict_t *copy = NULL;
+    char *buf = NULL;
+    unsigned int len = 0;
+    uint64_t num = 0;
+    int ret = -1;
+    int i;
+
+    dict = dict_new();
+    if (!dict)
+        goto out;
+
+    for (i = 0; shape->keys[i]; i++) {
+        if (shape->vallen)
+            ret = dict_set_static_bin(dict, (char *)shape->keys[i], value,
+                                      shape->vallen);
+        else
+            ret = dict_set_uint64(dict, (char *)shape->keys[i], i);
+        if (ret)
+            goto out;
+    }
+
+    for (i = 0; shape->keys[i]; i++) {
+        if (!dict_get(dict, (char *)shape->keys[i]))
+            goto out;
+    }
+    /* misses are as common as hits */
+    if (dict_get(dict, "glusterfs.missing-key"))
+        goto out;
+
+    ret = dict_allocate_and_serialize(dict, &buf, &len);
+    if (ret)
+        goto out;
+
+    copy = dict_new();
+    if (!copy)
+        goto out;
+    ret = dict_unserialize(buf, len, &copy);
+    if (ret)
+        goto out;
+
+    for (i = 0; shape->keys[i]; i++) {
+        if (!shape->vallen)
+            dict_get_uint64(copy, (char *)shape->keys[i], &num);
+        dict_del(copy, (char *)shape->keys[i]);
+    }
+    ret = 0;
+out:
+    free(buf);
+    if (copy)
+        dict_unref(copy);
+    if (dict)
+        dict_unref(dict);
+    return ret;
+}
+
+int
+main(int argc, char *argv[])
+{
+    struct dict_bm_shape *shape = NULL;
+    char value[64] = {
+        0,
+    };
+    long count = 1000000;
+    double start = 0;
+    double elapsed = 0;
+    glfs_t *fs = NULL;
+    long i;
+    int nkeys;
+
+    if (argc > 1)
+        count = strtol(argv[1], NULL, 0);
+
+    /* only to get a ctx with the dict mem-pools set up */
+    fs = glfs_new("dict-bm");
+    if (!fs) {
+        fprintf(stderr, "glfs_new failed\n");
+        return 1;
+    }
+
+    for (shape = shapes; shape->name; shape++) {
+        for (nkeys = 0; shape->keys[nkeys]; nkeys++)
+            ;
+
+        start = dict_bm_now();
+        for (i = 0; i < count; i++) {
+            if (dict_bm_pass(shape, value)) {
+                fprintf(stderr, "%s: dict operation failed\n", shape->name);
+                return 1;
+            }
+        }
+        elapsed = dict_bm_now() - start;
+        printf("%-4s %2d keys: %8.1f ns/pass (%ld passes)\n", shape->name,
+               nkeys, elapsed * 1e9 / count, count);
+    }
+
+    glfs_fini(fs);
+    return 0;
+}
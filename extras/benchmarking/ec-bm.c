@@ -0,0 +1,165 @@
+/*
+   Copyright (c) 2026 Red Hat, Inc. <http://www.redhat.com>
+   This file is part of GlusterFS.
+
+   This file is licensed to you under your choice of the GNU Lesser
+   General Public License, version 3 or any later version (LGPLv3 or
+   later), or the GNU General Public License, version 2 (GPLv2), in all
+   cases as published by the Free Software Foundation.
+*/
+
+/*
+ * ec-bm: throughput of ec_method_encode() and ec_method_decode() for each
+ * of the disperse code generators ("cpu-extensions"). Decoding uses the
+ * worst case, with as many data fragments lost as there is redundancy,
+ * and the decoded data is checked against the original. The EC sources
+ * are not a library, so build it from a configured tree, e.g.
+ *
+ *   EC=xlators/cluster/ec/src
+ *   gcc -O2 -DHAVE_CONFIG_H -D_GNU_SOURCE -D_FILE_OFFSET_BITS=64 \
+ *       -DGF_LINUX_HOST_OS -I. -Ilibglusterfs/src -Irpc/rpc-lib/src \
+ *       -Irpc/xdr/src -Ixlators/lib/src -I$EC extras/benchmarking/ec-bm.c \
+ *       $EC/ec-method.c $EC/ec-galois.c $EC/ec-gf8.c $EC/ec-code.c \
+ *       $EC/ec-code-c.c $EC/ec-code-intel.c $EC/ec-code-x64.c \
+ *       $EC/ec-code-sse.c $EC/ec-code-avx.c $EC/ec-code-avx512.c \
+ *       -lgfapi -lglusterfs -o ec-bm
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include <glusterfs/api/glfs.h>
+#include <glusterfs/xlator.h>
+
+#include "ec-method.h"
+#include "ec-code.h"
+
+struct ec_bm_layout {
+    uint32_t fragments;
+    uint32_t redundancy;
+};
+
+static struct ec_bm_layout layouts[] = {{4, 2}, {8, 3}, {16, 4}, {0, 0}};
+
+static const char *generators[] = {"none", "x64", "sse", "avx", "avx512",
+                                   NULL};
+
+static double
+ec_bm_now(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static int
+ec_bm_run(xlator_t *xl, struct ec_bm_layout *layout, const char *gen,
+          uint64_t size, int passes)
+{
+    ec_matrix_list_t list;
+    uint32_t nodes = layout->fragments + layout->redundancy;
+    uint64_t fsize = size / layout->fragments;
+    uint32_t rows[layout->fragments];
+    void *blocks[nodes];
+    void *out[nodes];
+    uintptr_t mask = 0;
+    char *data = NULL;
+    char *frags = NULL;
+    char *decoded = NULL;
+    double start = 0;
+    double encode = 0;
+    double decode = 0;
+    uint32_t i, j;
+    int ret = -1;
+    int pass;
+
+    memset(&list, 0, sizeof(list));
+    if (ec_method_init(xl, &list, layout->fragments, nodes, nodes * 2, gen))
+        return -1;
+
+    if (posix_memalign((void **)&data, EC_METHOD_WORD_SIZE, size) ||
+        posix_memalign((void **)&frags, EC_METHOD_WORD_SIZE, fsize * nodes) ||
+        posix_memalign((void **)&decoded, EC_METHOD_WORD_SIZE, size))
+        goto out;
+
+    for (i = 0; i < size; i++)
+        data[i] = random();
+
+    start = ec_bm_now();
+    for (pass = 0; pass < passes; pass++) {
+        for (i = 0; i < nodes; i++)
+            out[i] = frags + i * fsize;
+        ec_method_encode(&list, size, data, out);
+    }
+    encode = ec_bm_now() - start;
+
+    /* lose the first data fragments, decode from the rest */
+    for (i = layout->redundancy, j = 0; i < nodes; i++, j++) {
+        rows[j] = i + 1;
+        blocks[j] = frags + i * fsize;
+        mask |= 1UL << i;
+    }
+
+    start = ec_bm_now();
+    for (pass = 0; pass < passes; pass++) {
+        if (ec_method_decode(&list, fsize, mask, rows, blocks, decoded))
+            goto out;
+    }
+    decode = ec_bm_now() - start;
+
+    if (memcmp(data, decoded, size)) {
+        fprintf(stderr, "%u+%u %s: decoded data differs\n", layout->fragments,
+                layout->redundancy, gen);
+        goto out;
+    }
+
+    /* an unsupported generator falls back to the next one */
+    printf("%2u+%-2u %-6s (%-6s) encode %8.1f MB/s  decode %8.1f MB/s\n",
+           layout->fragments, layout->redundancy, gen,
+           list.code->gen ? list.code->gen->name : "none",
+           size * passes / encode / 1e6, size * passes / decode / 1e6);
+    ret = 0;
+
+out:
+    free(data);
+    free(frags);
+    free(decoded);
+    ec_method_fini(&list);
+    return ret;
+}
+
+int
+main(int argc, char *argv[])
+{
+    struct ec_bm_layout *layout = NULL;
+    const char **gen = NULL;
+    uint64_t size = 0;
+    int passes = 200;
+    glfs_t *fs = NULL;
+
+    if (argc > 1)
+        passes = strtol(argv[1], NULL, 0);
+
+    /* only to get a ctx with the mem-pools set up */
+    fs = glfs_new("ec-bm");
+    if (!fs) {
+        fprintf(stderr, "glfs_new failed\n");
+        return 1;
+    }
+
+    for (layout = layouts; layout->fragments; layout++) {
+        /* 1MB, rounded to whole stripes */
+        size = (1048576 / (EC_METHOD_CHUNK_SIZE * layout->fragments)) *
+               EC_METHOD_CHUNK_SIZE * layout->fragments;
+        for (gen = generators; *gen; gen++) {
+            if (ec_bm_run(THIS, layout, *gen, size, passes))
+                return 1;
+        }
+    }
+
+    glfs_fini(fs);
+    return 0;
+}
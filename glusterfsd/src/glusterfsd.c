@@ -227,6 +227,9 @@ static struct argp_option gf_options[] = {
     {"congestion-threshold", ARGP_FUSE_CONGESTION_THRESHOLD_KEY, "N", 0,
      "Set fuse module's congestion threshold to N "
      "[default: 48]"},
+    {"max-write", ARGP_FUSE_MAX_WRITE_KEY, "SIZE", 0,
+     "Let the kernel send read and write requests of up to SIZE bytes, "
+     "128KB to 1MB [default: 128KB]"},
 #ifdef GF_LINUX_HOST_OS
     {"oom-score-adj", ARGP_OOM_SCORE_ADJ_KEY, "INTEGER", 0,
      "Set oom_score_adj value for process"
@@ -451,6 +454,10 @@ set_fuse_mount_options(glusterfs_ctx_t *ctx, dict_t *options)
         DICT_SET_VAL(dict_set_int32_sizen, options, "congestion-threshold",
                      cmd_args->congestion_threshold, glusterfsd_msg_3);
     }
+    if (cmd_args->fuse_max_write) {
+        DICT_SET_VAL(dict_set_uint64, options, "max-write",
+                     cmd_args->fuse_max_write, glusterfsd_msg_3);
+    }
 
     switch (cmd_args->fuse_direct_io_mode) {
         case GF_OPTION_DISABLE: /* disable */
@@ -776,6 +783,7 @@ parse_opts(int key, char *arg, struct argp_state *state)
 {
     cmd_args_t *cmd_args = NULL;
     uint32_t n = 0;
+    uint64_t size = 0;
 #ifdef GF_LINUX_HOST_OS
     int32_t k = 0;
     struct oom_api_info *api = NULL;
@@ -1158,6 +1166,18 @@ parse_opts(int key, char *arg, struct argp_state *state)
             argp_failure(state, -1, 0, "unknown congestion threshold option %s",
                          arg);
             break;
+        case ARGP_FUSE_MAX_WRITE_KEY:
+            if (!gf_string2bytesize_uint64(arg, &size) &&
+                size >= 128 * GF_UNIT_KB && size <= GF_UNIT_MB) {
+                cmd_args->fuse_max_write = size;
+                break;
+            }
+
+            argp_failure(state, -1, 0,
+                         "invalid max-write value %s. "
+                         "Valid range: [\"128KB, 1MB\"]",
+                         arg);
+            break;
 
 #ifdef GF_LINUX_HOST_OS
         case ARGP_OOM_SCORE_ADJ_KEY:
@@ -1637,8 +1657,7 @@ glusterfs_ctx_defaults_init(glusterfs_ctx_t *ctx)
         goto out;
     }
 
-    INIT_LIST_HEAD(&ctx->pool->all_frames);
-    LOCK_INIT(&ctx->pool->lock);
+    call_pool_init(ctx->pool);
 
     /* frame_mem_pool size 112 * 4k */
     ctx->pool->frame_mem_pool = mem_pool_new(call_frame_t, 4096);
@@ -1649,3 +1649,143 @@ args_cbk_init(default_args_cbk_t *args_cbk)
 {
     INIT_LIST_HEAD(&args_cbk->entries);
 }
+
+compound_args_t *
+compound_fop_alloc(int length, dict_t *xdata)
+{
+    compound_args_t *args = NULL;
+
+    if (length <= 0 || length > GF_COMPOUND_MAX_FOPS)
+        return NULL;
+
+    args = GF_CALLOC(1, sizeof(*args), gf_common_mt_compound_req_t);
+    if (!args)
+        return NULL;
+
+    /* fop_enum can be used by xlators to see which fops are
+     * included as part of compound fop. This will help in checking
+     * for that particular fop in the compound fop and in building
+     * the corresponding reply.
+     */
+    args->fop_enum = GF_FOP_COMPOUND;
+    args->fop_length = length;
+
+    args->enum_list = GF_CALLOC(length, sizeof(*args->enum_list),
+                                gf_common_mt_int);
+    if (!args->enum_list)
+        goto out;
+
+    args->req_list = GF_CALLOC(length, sizeof(*args->req_list),
+                               gf_common_mt_default_args_t);
+    if (!args->req_list)
+        goto out;
+
+    if (xdata)
+        args->xdata = dict_ref(xdata);
+
+    return args;
+out:
+    GF_FREE(args->enum_list);
+    GF_FREE(args);
+    return NULL;
+}
+
+void
+compound_args_cleanup(compound_args_t *args)
+{
+    int i = 0;
+
+    if (!args)
+        return;
+
+    if (args->xdata)
+        dict_unref(args->xdata);
+
+    if (args->req_list) {
+        for (i = 0; i < args->fop_length; i++) {
+            args_wipe(&args->req_list[i]);
+        }
+    }
+
+    GF_FREE(args->enum_list);
+    GF_FREE(args->req_list);
+    GF_FREE(args);
+}
+
+compound_args_cbk_t *
+compound_args_cbk_alloc(int length, dict_t *xdata)
+{
+    int i = 0;
+    compound_args_cbk_t *args_cbk = NULL;
+
+    if (length <= 0 || length > GF_COMPOUND_MAX_FOPS)
+        return NULL;
+
+    args_cbk = GF_CALLOC(1, sizeof(*args_cbk), gf_common_mt_compound_rsp_t);
+    if (!args_cbk)
+        return NULL;
+
+    args_cbk->fop_enum = GF_FOP_COMPOUND;
+    args_cbk->fop_length = length;
+
+    args_cbk->enum_list = GF_CALLOC(length, sizeof(*args_cbk->enum_list),
+                                    gf_common_mt_int);
+    if (!args_cbk->enum_list)
+        goto out;
+
+    args_cbk->rsp_list = GF_CALLOC(length, sizeof(*args_cbk->rsp_list),
+                                   gf_common_mt_default_args_cbk_t);
+    if (!args_cbk->rsp_list)
+        goto out;
+
+    for (i = 0; i < length; i++) {
+        args_cbk_init(&args_cbk->rsp_list[i]);
+    }
+
+    if (xdata)
+        args_cbk->xdata = dict_ref(xdata);
+
+    return args_cbk;
+out:
+    GF_FREE(args_cbk->enum_list);
+    GF_FREE(args_cbk);
+    return NULL;
+}
+
+void
+compound_args_cbk_cleanup(compound_args_cbk_t *args_cbk)
+{
+    int i = 0;
+
+    if (!args_cbk)
+        return;
+
+    if (args_cbk->xdata)
+        dict_unref(args_cbk->xdata);
+
+    if (args_cbk->rsp_list) {
+        for (i = 0; i < args_cbk->fop_length; i++) {
+            args_cbk_wipe(&args_cbk->rsp_list[i]);
+        }
+    }
+
+    GF_FREE(args_cbk->rsp_list);
+    GF_FREE(args_cbk->enum_list);
+    GF_FREE(args_cbk);
+}
+
+gf_boolean_t
+compound_args_only_fop(compound_args_t *args, glusterfs_fop_t fop)
+{
+    int i = 0;
+
+    if (!args || !args->fop_length)
+        return _gf_false;
+
+    for (i = 0; i < args->fop_length; i++) {
+        if (args->enum_list[i] != fop)
+            return _gf_false;
+    }
+
+    return _gf_true;
+}
@@ -16,19 +16,9 @@
 #include <limits.h>
 #include <fnmatch.h>
 
-
-/* dict_t is always initialized with hash_size = 1
- * with this usage it's implemented as a doubly-linked list
- * and the hash calculation done per operation is not necessary.
- * using this macro to delimit blocks related to hash imp */
-#define DICT_LIST_IMP 1
-
-
 #include "glusterfs/dict.h"
-#if !DICT_LIST_IMP
 #define XXH_INLINE_ALL
 #include "xxhash.h"
-#endif
 #include "glusterfs/compat.h"
 #include "glusterfs/compat-errno.h"
 #include "glusterfs/byte-order.h"
@@ -78,44 +68,32 @@ get_new_data()
     return data;
 }
 
+static void
+dict_init_inline(dict_t *dict)
+{
+    dict->inline_used = 0;
+    dict->inline_keylen = 0;
+    dict->overflow = 0;
+    memset(dict->index, 0, sizeof(dict->index));
+}
+
 static dict_t *
-get_new_dict_full(int size_hint)
+get_new_dict_full(void)
 {
-    dict_t *dict = mem_get0(THIS->ctx->dict_pool);
+    /* not mem_get0(), the inline pairs and keys need no clearing */
+    dict_t *dict = mem_get(THIS->ctx->dict_pool);
 
     if (!dict) {
         return NULL;
     }
 
-    dict->hash_size = size_hint;
-#if DICT_LIST_IMP
-    /*
-     * This is the only case we ever see currently.  If we ever
-     * need to support resizing the hash table, the resize function
-     * will have to take into account the possibility that
-     * "members" is not separately allocated (i.e. don't just call
-     * realloc() blindly.
-     */
-    dict->members = &dict->members_internal;
-#else
-    /*
-     * We actually need to allocate space for size_hint *pointers*
-     * but we actually allocate space for one *structure*.  Since
-     * a data_pair_t consists of five pointers, we're wasting four
-     * pointers' worth for N=1, and will overrun what we allocated
-     * for N>5.  If anybody ever starts using size_hint, we'll need
-     * to fix this.
-     */
-    GF_ASSERT(size_hint <= (sizeof(data_pair_t) / sizeof(data_pair_t *)));
-    dict->members = mem_get0(THIS->ctx->dict_pair_pool);
-    if (!dict->members) {
-        mem_put(dict);
-        return NULL;
-    }
-#endif
-
-    dict->free_pair.key = NULL;
+    dict->max_count = 0;
+    dict->count = 0;
+    GF_ATOMIC_INIT(dict->refcount, 0);
+    dict->members_list = NULL;
+    dict->extra_stdfree = NULL;
     dict->totkvlen = 0;
+    dict_init_inline(dict);
     LOCK_INIT(&dict->lock);
 
     return dict;
@@ -124,7 +102,7 @@ get_new_dict_full(int size_hint)
 dict_t *
 dict_new(void)
 {
-    dict_t *dict = get_new_dict_full(DICT_LIST_IMP);
+    dict_t *dict = get_new_dict_full();
 
     if (dict)
         dict_ref(dict);
@@ -311,7 +289,7 @@ void
 data_destroy(data_t *data)
 {
     if (data) {
-        if (!data->is_static)
+        if (!data->is_static && (data->data != data->inline_data))
             GF_FREE(data->data);
 
         data->len = 0xbabababa;
@@ -334,7 +312,9 @@ data_copy(data_t *old)
     }
 
     newdata->len = old->len;
-    if (old->data) {
+    if (old->data && (old->len <= DATA_INLINE_SIZE)) {
+        newdata->data = memcpy(newdata->inline_data, old->data, old->len);
+    } else if (old->data) {
         newdata->data = gf_memdup(old->data, old->len);
         if (!newdata->data)
             goto err_out;
@@ -349,6 +329,14 @@ err_out:
     return NULL;
 }
 
+/* Callers' keylen is not relied upon for hashing, lookups by dict_get()
+ * and friends only have the string. */
+static inline uint32_t
+dict_key_hash(const char *key)
+{
+    return (uint32_t)XXH64(key, strlen(key), 0);
+}
+
 /* Always need to be called under lock
  * Always this and key variables are not null -
  * checked by callers.
@@ -356,24 +344,160 @@ err_out:
 static data_pair_t *
 dict_lookup_common(const dict_t *this, const char *key, const uint32_t hash)
 {
-    int hashval = 0;
     data_pair_t *pair;
+    uint32_t slot;
+    int i;
 
-    /* If the divisor is 1, the modulo is always 0,
-     * in such case avoid hash calculation.
-     */
-#if !DICT_LIST_IMP
-    hashval = hash % this->hash_size;
-#endif
+    if (!this->overflow) {
+        for (i = 0; i < DICT_INLINE_SLOTS; i++) {
+            slot = this->index[(hash + i) & (DICT_INLINE_SLOTS - 1)];
+            if (!slot)
+                break;
+            pair = (data_pair_t *)&this->inline_pairs[slot - 1];
+            if ((hash == pair->key_hash) && !strcmp(pair->key, key))
+                return pair;
+        }
+        return NULL;
+    }
 
-    for (pair = this->members[hashval]; pair != NULL; pair = pair->hash_next) {
-        if (pair->key && (hash == pair->key_hash) && !strcmp(pair->key, key))
+    for (pair = this->members_list; pair != NULL; pair = pair->next) {
+        if ((hash == pair->key_hash) && !strcmp(pair->key, key))
             return pair;
     }
 
     return NULL;
 }
 
+static void
+dict_index_add(dict_t *this, data_pair_t *pair)
+{
+    uint32_t pos = pair->key_hash;
+
+    while (this->index[pos & (DICT_INLINE_SLOTS - 1)])
+        pos++;
+
+    this->index[pos & (DICT_INLINE_SLOTS - 1)] = (pair - this->inline_pairs) +
+                                                 1;
+}
+
+/* Linear probing cannot just clear a slot, there are never more than
+ * DICT_INLINE_PAIRS entries so rebuilding the index is cheap enough. */
+static void
+dict_index_rebuild(dict_t *this)
+{
+    data_pair_t *pair;
+
+    memset(this->index, 0, sizeof(this->index));
+    for (pair = this->members_list; pair != NULL; pair = pair->next)
+        dict_index_add(this, pair);
+}
+
+static gf_boolean_t
+dict_key_is_inline(const dict_t *this, const char *key)
+{
+    return (key >= this->inline_keys) &&
+           (key < this->inline_keys + DICT_INLINE_KEYS);
+}
+
+/* Always called under lock */
+static void
+dict_pair_put(dict_t *this, data_pair_t *pair)
+{
+    if (!dict_key_is_inline(this, pair->key))
+        GF_FREE(pair->key);
+    pair->key = NULL;
+
+    if ((pair >= this->inline_pairs) &&
+        (pair < this->inline_pairs + DICT_INLINE_PAIRS)) {
+        this->inline_used &= ~(1U << (pair - this->inline_pairs));
+    } else {
+        mem_put(pair);
+    }
+}
+
+/* Always called under lock. Gets a pair, from the inline storage as long
+ * as there is room, and gives it a copy of @key. If @key_owned, @key was
+ * allocated by the caller and is handed over. */
+static data_pair_t *
+dict_pair_new(dict_t *this, char *key, const int keylen, const uint32_t hash,
+              gf_boolean_t key_owned)
+{
+    data_pair_t *pair = NULL;
+    char *pair_key = key;
+    int i;
+
+    if (!key_owned) {
+        if (this->inline_keylen + keylen + 1 <= DICT_INLINE_KEYS) {
+            pair_key = this->inline_keys + this->inline_keylen;
+        } else {
+            pair_key = GF_MALLOC(keylen + 1, gf_common_mt_char);
+            if (!pair_key)
+                return NULL;
+        }
+    }
+
+    if (this->inline_used != (1U << DICT_INLINE_PAIRS) - 1) {
+        i = __builtin_ctz(~this->inline_used);
+        this->inline_used |= (1U << i);
+        pair = &this->inline_pairs[i];
+    } else {
+        pair = mem_get(THIS->ctx->dict_pair_pool);
+        if (!pair) {
+            if (!dict_key_is_inline(this, pair_key))
+                GF_FREE(pair_key);
+            return NULL;
+        }
+        this->overflow = 1;
+    }
+
+    if (!key_owned) {
+        memcpy(pair_key, key, keylen);
+        pair_key[keylen] = '\0';
+        if (dict_key_is_inline(this, pair_key))
+            this->inline_keylen += keylen + 1;
+    }
+    pair->key = pair_key;
+    pair->key_hash = hash;
+
+    return pair;
+}
+
+/* Always called under lock */
+static void
+dict_pair_link(dict_t *this, data_pair_t *pair)
+{
+    pair->next = this->members_list;
+    pair->prev = NULL;
+    if (this->members_list)
+        this->members_list->prev = pair;
+    this->members_list = pair;
+    this->count++;
+
+    if (!this->overflow)
+        dict_index_add(this, pair);
+
+    if (this->max_count < this->count)
+        this->max_count = this->count;
+}
+
+/* Always called under lock */
+static void
+dict_pair_unlink(dict_t *this, data_pair_t *pair)
+{
+    if (pair->prev)
+        pair->prev->next = pair->next;
+    else
+        this->members_list = pair->next;
+
+    if (pair->next)
+        pair->next->prev = pair->prev;
+
+    this->count--;
+
+    if (!this->overflow)
+        dict_index_rebuild(this);
+}
+
 int32_t
 dict_lookup(dict_t *this, char *key, data_t **data)
 {
@@ -386,11 +510,7 @@ dict_lookup(dict_t *this, char *key, data_t **data)
 
     data_pair_t *tmp = NULL;
 
-    uint32_t hash = 0;
-
-#if !DICT_LIST_IMP
-    hash = (uint32_t)XXH64(key, strlen(key), 0);
-#endif
+    uint32_t hash = dict_key_hash(key);
 
     LOCK(&this->lock);
     {
@@ -409,7 +529,6 @@ static int32_t
 dict_set_lk(dict_t *this, char *key, const int key_len, data_t *value,
             const uint32_t hash, gf_boolean_t replace)
 {
-    int hashval = 0;
     data_pair_t *pair;
     int key_free = 0;
     uint32_t key_hash = 0;
@@ -421,9 +540,7 @@ dict_set_lk(dict_t *this, char *key, const int key_len, data_t *value,
             return -1;
         }
         key_free = 1;
-#if !DICT_LIST_IMP
-        key_hash = (uint32_t)XXH64(key, keylen, 0);
-#endif
+        key_hash = dict_key_hash(key);
     } else {
         keylen = key_len;
         key_hash = hash;
@@ -444,56 +561,19 @@ dict_set_lk(dict_t *this, char *key, const int key_len, data_t *value,
         }
     }
 
-    if (this->free_pair.key) { /* the free_pair is used */
-        pair = mem_get(THIS->ctx->dict_pair_pool);
-        if (!pair) {
-            if (key_free)
-                GF_FREE(key);
-            return -1;
-        }
-    } else { /* assign the pair to the free pair */
-        pair = &this->free_pair;
+    /* If the key is ours, the pair takes it over. */
+    pair = dict_pair_new(this, key, keylen, key_hash, key_free);
+    if (!pair) {
+        if (key_free)
+            GF_FREE(key);
+        return -1;
     }
 
-    if (key_free) {
-        /* It's ours.  Use it. */
-        pair->key = key;
-        key_free = 0;
-    } else {
-        pair->key = (char *)GF_MALLOC(keylen + 1, gf_common_mt_char);
-        if (!pair->key) {
-            if (pair != &this->free_pair) {
-                mem_put(pair);
-            }
-            return -1;
-        }
-        strcpy(pair->key, key);
-    }
-    pair->key_hash = key_hash;
     pair->value = data_ref(value);
     this->totkvlen += (keylen + 1 + value->len);
 
-    /* If the divisor is 1, the modulo is always 0,
-     * in such case avoid hash calculation.
-     */
-#if !DICT_LIST_IMP
-    hashval = (key_hash % this->hash_size);
-#endif
-    pair->hash_next = this->members[hashval];
-    this->members[hashval] = pair;
-
-    pair->next = this->members_list;
-    pair->prev = NULL;
-    if (this->members_list)
-        this->members_list->prev = pair;
-    this->members_list = pair;
-    this->count++;
-
-    if (key_free)
-        GF_FREE(key);
+    dict_pair_link(this, pair);
 
-    if (this->max_count < this->count)
-        this->max_count = this->count;
     return 0;
 }
 
@@ -520,11 +600,9 @@ dict_setn(dict_t *this, char *key, const int keylen, data_t *value)
         return -1;
     }
 
-#if !DICT_LIST_IMP
     if (key) {
-        key_hash = (uint32_t)XXH64(key, keylen, 0);
+        key_hash = dict_key_hash(key);
     }
-#endif
 
     LOCK(&this->lock);
 
@@ -556,11 +634,9 @@ dict_addn(dict_t *this, char *key, const int keylen, data_t *value)
         return -1;
     }
 
-#if !DICT_LIST_IMP
     if (key) {
-        key_hash = (uint32_t)XXH64(key, keylen, 0);
+        key_hash = dict_key_hash(key);
     }
-#endif
 
     LOCK(&this->lock);
 
@@ -579,11 +655,7 @@ dict_get(dict_t *this, char *key)
                          "!this || key=%s", (key) ? key : "()");
         return NULL;
     }
-#if !DICT_LIST_IMP
     return dict_getn(this, key, strlen(key));
-#else   
-    return dict_getn(this, key, 0);
-#endif
 }
 
 data_t *
@@ -598,9 +670,7 @@ dict_getn(dict_t *this, char *key, const int keylen)
         return NULL;
     }
 
-#if !DICT_LIST_IMP
-    hash = (uint32_t)XXH64(key, keylen, 0);
-#endif
+    hash = dict_key_hash(key);
 
     LOCK(&this->lock);
     {
@@ -642,17 +712,13 @@ dict_del(dict_t *this, char *key)
                          "!this || key=%s", key);
         return _gf_false;
     }
-#if !DICT_LIST_IMP
     return dict_deln(this, key, strlen(key));
-#else
-    return dict_deln(this, key, 0);
-#endif
 }
 
 gf_boolean_t
 dict_deln(dict_t *this, char *key, const int keylen)
 {
-    int hashval = 0;
+    data_pair_t *pair = NULL;
     uint32_t hash = 0;
     gf_boolean_t rc = _gf_false;
 
@@ -662,54 +728,20 @@ dict_deln(dict_t *this, char *key, const int keylen)
         return rc;
     }
 
-#if !DICT_LIST_IMP
-    hash = (uint32_t)XXH64(key, keylen, 0);
-#endif
+    hash = dict_key_hash(key);
 
     LOCK(&this->lock);
 
-    /* If the divisor is 1, the modulo is always 0,
-     * in such case avoid hash calculation.
-     */
-#if !DICT_LIST_IMP
-    hashval = hash % this->hash_size;
-#endif
-
-    data_pair_t *pair = this->members[hashval];
-    data_pair_t *prev = NULL;
-
-    while (pair) {
-        if ((hash == pair->key_hash) && strcmp(pair->key, key) == 0) {
-            if (prev)
-                prev->hash_next = pair->hash_next;
-            else
-                this->members[hashval] = pair->hash_next;
-
-            this->totkvlen -= pair->value->len;
-            data_unref(pair->value);
-
-            if (pair->prev)
-                pair->prev->next = pair->next;
-            else
-                this->members_list = pair->next;
-
-            if (pair->next)
-                pair->next->prev = pair->prev;
+    pair = dict_lookup_common(this, key, hash);
+    if (pair) {
+        this->totkvlen -= pair->value->len;
+        data_unref(pair->value);
 
-            this->totkvlen -= (strlen(pair->key) + 1);
-            GF_FREE(pair->key);
-            if (pair == &this->free_pair) {
-                this->free_pair.key = NULL;
-            } else {
-                mem_put(pair);
-            }
-            this->count--;
-            rc = _gf_true;
-            break;
-        }
+        dict_pair_unlink(this, pair);
 
-        prev = pair;
-        pair = pair->hash_next;
+        this->totkvlen -= (strlen(pair->key) + 1);
+        dict_pair_put(this, pair);
+        rc = _gf_true;
     }
 
     UNLOCK(&this->lock);
@@ -728,15 +760,12 @@ dict_clear_data(dict_t *this)
     while (curr != NULL) {
         next = curr->next;
         data_unref(curr->value);
-        GF_FREE(curr->key);
-        if (curr == &this->free_pair) {
-            this->free_pair.key = NULL;
-        } else {
-            mem_put(curr);
-        }
+        dict_pair_put(this, curr);
         curr = next;
     }
+    this->members_list = NULL;
     this->count = this->totkvlen = 0;
+    dict_init_inline(this);
 }
 
 static void
@@ -755,9 +784,6 @@ dict_destroy(dict_t *this)
     LOCK_DESTROY(&this->lock);
 
     dict_clear_data(this);
-    if (this->members != &this->members_internal) {
-        mem_put(this->members);
-    }
 
     free(this->extra_stdfree);
 
@@ -845,192 +871,94 @@ data_ref(data_t *this)
     return this;
 }
 
-data_t *
-int_to_data(int64_t value)
+/* Numbers are stored as strings, which nearly always fit in the data_t
+ * itself. Only the odd long one (a double, typically) is allocated. */
+static data_t *
+data_from_number(gf_dict_data_type_t type, const char *fmt, ...)
 {
     data_t *data = get_new_data();
+    va_list ap;
+    int len;
 
     if (!data) {
         return NULL;
     }
 
-    data->len = gf_asprintf(&data->data, "%" PRId64, value);
-    if (-1 == data->len) {
-        gf_msg_debug("dict", 0, "asprintf failed");
-        data_destroy(data);
-        return NULL;
+    va_start(ap, fmt);
+    len = vsnprintf(data->inline_data, DATA_INLINE_SIZE, fmt, ap);
+    va_end(ap);
+
+    if ((len >= 0) && (len < DATA_INLINE_SIZE)) {
+        data->data = data->inline_data;
+    } else {
+        va_start(ap, fmt);
+        len = gf_vasprintf(&data->data, fmt, ap);
+        va_end(ap);
+        if (-1 == len) {
+            gf_msg_debug("dict", 0, "asprintf failed");
+            data->data = NULL;
+            data_destroy(data);
+            return NULL;
+        }
     }
-    data->len++; /* account for terminating NULL */
-    data->data_type = GF_DATA_TYPE_INT;
+    data->len = len + 1; /* account for terminating NULL */
+    data->data_type = type;
 
     return data;
 }
 
 data_t *
-data_from_int64(int64_t value)
+int_to_data(int64_t value)
 {
-    data_t *data = get_new_data();
-
-    if (!data) {
-        return NULL;
-    }
-    data->len = gf_asprintf(&data->data, "%" PRId64, value);
-    if (-1 == data->len) {
-        gf_msg_debug("dict", 0, "asprintf failed");
-        data_destroy(data);
-        return NULL;
-    }
-    data->len++; /* account for terminating NULL */
-    data->data_type = GF_DATA_TYPE_INT;
+    return data_from_number(GF_DATA_TYPE_INT, "%" PRId64, value);
+}
 
-    return data;
+data_t *
+data_from_int64(int64_t value)
+{
+    return data_from_number(GF_DATA_TYPE_INT, "%" PRId64, value);
 }
 
 data_t *
 data_from_int32(int32_t value)
 {
-    data_t *data = get_new_data();
-
-    if (!data) {
-        return NULL;
-    }
-    data->len = gf_asprintf(&data->data, "%" PRId32, value);
-    if (-1 == data->len) {
-        gf_msg_debug("dict", 0, "asprintf failed");
-        data_destroy(data);
-        return NULL;
-    }
-
-    data->len++; /* account for terminating NULL */
-    data->data_type = GF_DATA_TYPE_INT;
-
-    return data;
+    return data_from_number(GF_DATA_TYPE_INT, "%" PRId32, value);
 }
 
 data_t *
 data_from_int16(int16_t value)
 {
-    data_t *data = get_new_data();
-
-    if (!data) {
-        return NULL;
-    }
-    data->len = gf_asprintf(&data->data, "%" PRId16, value);
-    if (-1 == data->len) {
-        gf_msg_debug("dict", 0, "asprintf failed");
-        data_destroy(data);
-        return NULL;
-    }
-
-    data->len++; /* account for terminating NULL */
-    data->data_type = GF_DATA_TYPE_INT;
-
-    return data;
+    return data_from_number(GF_DATA_TYPE_INT, "%" PRId16, value);
 }
 
 data_t *
 data_from_int8(int8_t value)
 {
-    data_t *data = get_new_data();
-
-    if (!data) {
-        return NULL;
-    }
-    data->len = gf_asprintf(&data->data, "%d", value);
-    if (-1 == data->len) {
-        gf_msg_debug("dict", 0, "asprintf failed");
-        data_destroy(data);
-        return NULL;
-    }
-
-    data->len++; /* account for terminating NULL */
-    data->data_type = GF_DATA_TYPE_INT;
-
-    return data;
+    return data_from_number(GF_DATA_TYPE_INT, "%d", value);
 }
 
 data_t *
 data_from_uint64(uint64_t value)
 {
-    data_t *data = get_new_data();
-
-    if (!data) {
-        return NULL;
-    }
-    data->len = gf_asprintf(&data->data, "%" PRIu64, value);
-    if (-1 == data->len) {
-        gf_msg_debug("dict", 0, "asprintf failed");
-        data_destroy(data);
-        return NULL;
-    }
-
-    data->len++; /* account for terminating NULL */
-    data->data_type = GF_DATA_TYPE_UINT;
-
-    return data;
+    return data_from_number(GF_DATA_TYPE_UINT, "%" PRIu64, value);
 }
 
 data_t *
 data_from_double(double value)
 {
-    data_t *data = get_new_data();
-
-    if (!data) {
-        return NULL;
-    }
-
-    data->len = gf_asprintf(&data->data, "%f", value);
-    if (data->len == -1) {
-        gf_msg_debug("dict", 0, "asprintf failed");
-        data_destroy(data);
-        return NULL;
-    }
-    data->len++; /* account for terminating NULL */
-    data->data_type = GF_DATA_TYPE_DOUBLE;
-
-    return data;
+    return data_from_number(GF_DATA_TYPE_DOUBLE, "%f", value);
 }
 
 data_t *
 data_from_uint32(uint32_t value)
 {
-    data_t *data = get_new_data();
-
-    if (!data) {
-        return NULL;
-    }
-    data->len = gf_asprintf(&data->data, "%" PRIu32, value);
-    if (-1 == data->len) {
-        gf_msg_debug("dict", 0, "asprintf failed");
-        data_destroy(data);
-        return NULL;
-    }
-
-    data->len++; /* account for terminating NULL */
-    data->data_type = GF_DATA_TYPE_UINT;
-
-    return data;
+    return data_from_number(GF_DATA_TYPE_UINT, "%" PRIu32, value);
 }
 
 data_t *
 data_from_uint16(uint16_t value)
 {
-    data_t *data = get_new_data();
-
-    if (!data) {
-        return NULL;
-    }
-    data->len = gf_asprintf(&data->data, "%" PRIu16, value);
-    if (-1 == data->len) {
-        gf_msg_debug("dict", 0, "asprintf failed");
-        data_destroy(data);
-        return NULL;
-    }
-
-    data->len++; /* account for terminating NULL */
-    data->data_type = GF_DATA_TYPE_UINT;
-
-    return data;
+    return data_from_number(GF_DATA_TYPE_UINT, "%" PRIu16, value);
 }
 
 static data_t *
@@ -1492,7 +1420,7 @@ dict_copy(dict_t *dict, dict_t *new)
     }
 
     if (!new)
-        new = get_new_dict_full(dict->hash_size);
+        new = get_new_dict_full();
 
     dict_foreach(dict, dict_copy_one, new);
 
@@ -1509,13 +1437,9 @@ dict_reset(dict_t *dict)
         goto out;
     }
 
-    int i;
     LOCK(&dict->lock);
 
     dict_clear_data(dict);
-    for (i = 0; i < dict->hash_size; i++)
-        dict->members[i] = NULL;
-    dict->members_list = NULL;
 
     UNLOCK(&dict->lock);
     ret = 0;
@@ -1559,9 +1483,7 @@ dict_get_with_refn(dict_t *this, char *key, const int keylen, data_t **data)
     int ret = -ENOENT;
     uint32_t hash = 0;
 
-#if !DICT_LIST_IMP
-    hash = (uint32_t)XXH64(key, keylen, 0);
-#endif
+    hash = dict_key_hash(key);
 
     LOCK(&this->lock);
     {
@@ -1585,11 +1507,7 @@ dict_get_with_ref(dict_t *this, char *key, data_t **data)
                          "dict OR key (%s) is NULL", key);
         return -EINVAL;
     }
-#if !DICT_LIST_IMP
     return dict_get_with_refn(this, key, strlen(key), data);
-#else
-    return dict_get_with_refn(this, key, 0, data);
-#endif
 }
 
 static int
@@ -2163,7 +2081,6 @@ _dict_modify_flag(dict_t *this, char *key, int flag, int op)
     int ret = 0;
     data_pair_t *pair = NULL;
     char *ptr = NULL;
-    int hashval = 0;
     uint32_t hash = 0;
 
     if (!this || !key) {
@@ -2179,9 +2096,7 @@ _dict_modify_flag(dict_t *this, char *key, int flag, int op)
      */
     GF_ASSERT(flag >= 0 && flag < DICT_MAX_FLAGS);
 
-#if !DICT_LIST_IMP
-    hash = (uint32_t)XXH64(key, strlen(key), 0);
-#endif
+    hash = dict_key_hash(key);
 
     LOCK(&this->lock);
     {
@@ -2217,44 +2132,17 @@ _dict_modify_flag(dict_t *this, char *key, int flag, int op)
             else
                 BIT_CLEAR((unsigned char *)(data->data), flag);
 
-            if (this->free_pair.key) { /* the free pair is in use */
-                pair = mem_get0(THIS->ctx->dict_pair_pool);
-                if (!pair) {
-                    gf_smsg("dict", GF_LOG_ERROR, ENOMEM, LG_MSG_NO_MEMORY,
-                            "dict pair", NULL);
-                    ret = -ENOMEM;
-                    goto err;
-                }
-            } else { /* use the free pair */
-                pair = &this->free_pair;
-            }
-
-            pair->key = (char *)GF_MALLOC(strlen(key) + 1, gf_common_mt_char);
-            if (!pair->key) {
+            pair = dict_pair_new(this, key, strlen(key), hash, _gf_false);
+            if (!pair) {
                 gf_smsg("dict", GF_LOG_ERROR, ENOMEM, LG_MSG_NO_MEMORY,
                         "dict pair", NULL);
                 ret = -ENOMEM;
                 goto err;
             }
-            strcpy(pair->key, key);
-            pair->key_hash = hash;
             pair->value = data_ref(data);
             this->totkvlen += (strlen(key) + 1 + data->len);
-#if !DICT_LIST_IMP
-            hashval = hash % this->hash_size;
-#endif
-            pair->hash_next = this->members[hashval];
-            this->members[hashval] = pair;
-
-            pair->next = this->members_list;
-            pair->prev = NULL;
-            if (this->members_list)
-                this->members_list->prev = pair;
-            this->members_list = pair;
-            this->count++;
-
-            if (this->max_count < this->count)
-                this->max_count = this->count;
+
+            dict_pair_link(this, pair);
         }
     }
 
@@ -2265,16 +2153,6 @@ err:
     if (key && this)
         UNLOCK(&this->lock);
 
-    if (pair) {
-        if (pair->key) {
-            GF_FREE(pair->key);
-            pair->key = NULL;
-        }
-        if (pair != &this->free_pair) {
-            mem_put(pair);
-        }
-    }
-
     if (data)
         data_destroy(data);
 
@@ -2923,10 +2801,8 @@ dict_rename_key(dict_t *this, char *key, char *replace_key)
     }
 
     replacekey_len = strlen(replace_key);
-#if !DICT_LIST_IMP
-    hash = (uint32_t)XXH64(key, strlen(key), 0);
-    replacekey_hash = (uint32_t)XXH64(replace_key, replacekey_len, 0);
-#endif
+    hash = dict_key_hash(key);
+    replacekey_hash = dict_key_hash(replace_key);
 
     LOCK(&this->lock);
     {
@@ -3250,7 +3126,10 @@ dict_unserialize(char *orig_buf, int32_t size, dict_t **fill)
             goto out;
         }
         value->len = vallen;
-        value->data = gf_memdup(buf, vallen);
+        if (vallen <= DATA_INLINE_SIZE)
+            value->data = memcpy(value->inline_data, buf, vallen);
+        else
+            value->data = gf_memdup(buf, vallen);
         value->data_type = GF_DATA_TYPE_STR_OLD;
         value->is_static = _gf_false;
         buf += vallen;
@@ -3544,9 +3423,7 @@ dict_has_key_from_array(dict_t *dict, char **strings, gf_boolean_t *result)
     LOCK(&dict->lock);
     {
         for (i = 0; strings[i]; i++) {
-#if !DICT_LIST_IMP
-            hash = (uint32_t)XXH64(strings[i], strlen(strings[i]), 0);
-#endif
+            hash = dict_key_hash(strings[i]);
             if (dict_lookup_common(dict, strings[i], hash)) {
                 *result = _gf_true;
                 goto unlock;
@@ -3689,7 +3566,10 @@ dict_unserialize_specific_keys(char *orig_buf, int32_t size, dict_t **fill,
             goto out;
         }
         value->len = vallen;
-        value->data = gf_memdup(buf, vallen);
+        if (vallen <= DATA_INLINE_SIZE)
+            value->data = memcpy(value->inline_data, buf, vallen);
+        else
+            value->data = gf_memdup(buf, vallen);
         value->data_type = GF_DATA_TYPE_STR_OLD;
         value->is_static = _gf_false;
         buf += vallen;
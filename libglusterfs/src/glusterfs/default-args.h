@@ -452,4 +452,25 @@ args_copy_file_range_store(default_args_t *args, fd_t *fd_in, off64_t off_in,
 
 void
 args_cbk_init(default_args_cbk_t *args_cbk);
+
+#define COMPOUND_PACK_ARGS(fop, fop_enum, args, counter, params...)            \
+    do {                                                                       \
+        args->enum_list[counter] = fop_enum;                                   \
+        args_##fop##_store(&args->req_list[counter], params);                  \
+    } while (0)
+
+compound_args_t *
+compound_fop_alloc(int length, dict_t *xdata);
+
+void
+compound_args_cleanup(compound_args_t *args);
+
+compound_args_cbk_t *
+compound_args_cbk_alloc(int length, dict_t *xdata);
+
+void
+compound_args_cbk_cleanup(compound_args_cbk_t *args_cbk);
+
+gf_boolean_t
+compound_args_only_fop(compound_args_t *args, glusterfs_fop_t fop);
 #endif /* _DEFAULT_ARGS_H */
@@ -90,6 +90,14 @@ typedef struct {
     lock_migration_info_t locklist;
 } default_args_t;
 
+/* Upper bound on the number of fops a single compound fop may carry. */
+#define GF_COMPOUND_MAX_FOPS 64
+
+/* Set in the xdata of a compound fop whose steps do not depend on each
+ * other: a failed step does not cancel the ones after it, and every step
+ * carries its own result. Batched lookups are sent this way. */
+#define GF_COMPOUND_INDEPENDENT_KEY "glusterfs.compound-independent"
+
 typedef struct {
     int fop_enum;
     unsigned int fop_length;
@@ -91,16 +91,27 @@ typedef struct _data_pair data_pair_t;
 #define DICT_DATA_HDR_KEY_LEN 4
 #define DICT_DATA_HDR_VAL_LEN 4
 
+/* Small dicts are kept entirely within the dict_t: up to DICT_INLINE_PAIRS
+ * pairs, their keys in DICT_INLINE_KEYS bytes and an open addressing index
+ * of DICT_INLINE_SLOTS (a power of two) entries over them. */
+#define DICT_INLINE_PAIRS 8
+#define DICT_INLINE_SLOTS 16
+#define DICT_INLINE_KEYS 256
+
+/* values up to this size (numbers, AFR/EC xattrs) are stored in the data_t,
+ * aligned for the callers reading them as 64 bit integers */
+#define DATA_INLINE_SIZE 24
+
 struct _data {
     char *data;
     gf_atomic_t refcount;
     gf_dict_data_type_t data_type;
     uint32_t len;
     gf_boolean_t is_static;
+    char inline_data[DATA_INLINE_SIZE] __attribute__((aligned(8)));
 };
 
 struct _data_pair {
-    struct _data_pair *hash_next;
     struct _data_pair *prev;
     struct _data_pair *next;
     data_t *value;
@@ -110,17 +121,22 @@ struct _data_pair {
 
 struct _dict {
     uint64_t max_count;
-    int32_t hash_size;
     int32_t count;
     gf_atomic_t refcount;
-    data_pair_t **members;
     data_pair_t *members_list;
     char *extra_stdfree;
     gf_lock_t lock;
-    data_pair_t *members_internal;
-    data_pair_t free_pair;
     /* Variable to store total keylen + value->len */
     uint32_t totkvlen;
+
+    uint32_t inline_used;   /* bitmap of pairs in inline_pairs[] */
+    uint16_t inline_keylen; /* bytes of inline_keys[] handed out */
+    /* set once a pair had to be allocated separately, lookups then walk
+     * members_list instead of using the index */
+    uint16_t overflow;
+    uint8_t index[DICT_INLINE_SLOTS]; /* 1 + offset in inline_pairs[] */
+    data_pair_t inline_pairs[DICT_INLINE_PAIRS];
+    char inline_keys[DICT_INLINE_KEYS];
 };
 
 typedef gf_boolean_t (*dict_match_t)(dict_t *d, char *k, data_t *v, void *data);
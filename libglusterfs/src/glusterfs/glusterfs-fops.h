@@ -149,6 +149,9 @@ typedef enum gf_lease_cmds_t gf_lease_cmds_t;
 
 #define LEASE_ID_SIZE 16 /* 128bits */
 
+/* lease_flags */
+#define GF_LEASE_METADATA 0x1 /* held by a client side metadata cache */
+
 struct gf_lease {
     gf_lease_cmds_t cmd;
     gf_lease_types_t lease_type;
@@ -93,6 +93,7 @@
 #define ZR_DUMP_FUSE "dump-fuse"
 #define ZR_FUSE_MOUNTOPTS "fuse-mountopts"
 #define IO_THREADS_QUEUE_SIZE_KEY "io-thread-queue-size"
+#define IO_THREADS_LOAD_KEY "io-thread-load"
 
 #define GF_XATTR_CLRLK_CMD "glusterfs.clrlk"
 #define GF_XATTR_PATHINFO_KEY "trusted.glusterfs.pathinfo"
@@ -540,6 +541,7 @@ struct _cmd_args {
     int32_t invalidate_limit;
     int background_qlen;
     int congestion_threshold;
+    uint64_t fuse_max_write;
     char *fuse_mountopts;
     int mem_acct;
     int resolve_gids;
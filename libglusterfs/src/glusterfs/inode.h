@@ -33,21 +33,35 @@ typedef struct _dentry dentry_t;
 #include "glusterfs/compat-uuid.h"
 #include "glusterfs/fd.h"
 
+/* Number of independent shards of an inode table. An inode lives in the
+ * shard its gfid hashes to, and the shard lock protects its refcount, its
+ * place in the active/lru/invalidate lists and the inode hash buckets of
+ * the shard. Must be a power of 2. */
+#define GF_INODE_TABLE_SHARDS 16
+
+struct inode_table_shard {
+    pthread_mutex_t lock;
+    struct list_head active; /* list of inodes currently active (in an fop) */
+    uint32_t active_size;    /* count of inodes in active list */
+    struct list_head lru;    /* list of inodes recently used.
+                                lru.next least recent */
+    uint32_t lru_size;       /* count of inodes in lru list  */
+    struct list_head invalidate; /* inodes which are in invalidation queue */
+    uint32_t invalidate_size;    /* count of inodes in invalidation list */
+} __attribute__((aligned(CAA_CACHE_LINE_SIZE)));
+
 struct _inode_table {
+    /* protects the dentries, the dentry hash and the purge list. When
+       both are needed, it is taken before any shard lock. */
     pthread_mutex_t lock;
     size_t dentry_hashsize; /* Number of buckets for dentry hash*/
     size_t inode_hashsize;  /* Size of inode hash table */
     char *name;             /* name of the inode table, just for gf_log() */
     inode_t *root;          /* root directory inode, with number 1 */
     xlator_t *xl;           /* xlator to be called to do purge */
-    uint32_t lru_limit;     /* maximum LRU cache size */
+    uint32_t lru_limit;     /* maximum LRU cache size, over all shards */
     struct list_head *inode_hash; /* buckets for inode hash table */
     struct list_head *name_hash;  /* buckets for dentry hash table */
-    struct list_head active; /* list of inodes currently active (in an fop) */
-    uint32_t active_size;    /* count of inodes in active list */
-    struct list_head lru;    /* list of inodes recently used.
-                                lru.next most recent */
-    uint32_t lru_size;       /* count of inodes in lru list  */
     struct list_head purge;  /* list of inodes to be purged soon */
     uint32_t purge_size;     /* count of inodes in purge list */
 
@@ -60,12 +74,12 @@ struct _inode_table {
        specially in case of fuse-bridge */
     int32_t (*invalidator_fn)(xlator_t *, inode_t *);
     xlator_t *invalidator_xl;
-    struct list_head invalidate; /* inodes which are in invalidation queue */
-    uint32_t invalidate_size;    /* count of inodes in invalidation list */
 
     /* flag to indicate whether the cleanup of the inode
        table started or not */
     gf_boolean_t cleanup_started;
+
+    struct inode_table_shard shards[GF_INODE_TABLE_SHARDS];
 };
 
 struct _dentry {
@@ -106,10 +120,11 @@ struct _inode {
     uint32_t active_fd_count;     /* Active open fd count */
     uint32_t ref;                 /* reference count on this inode */
     ia_type_t ia_type;            /* what kind of file */
+    uint32_t shard;               /* index in table->shards */
     struct list_head fd_list;     /* list of open files on this inode */
     struct list_head dentry_list; /* list of directory entries for this inode */
     struct list_head hash;        /* hash table pointers */
-    struct list_head list;        /* active/lru/purge */
+    struct list_head list;        /* active/lru/invalidate/purge */
 
     struct _inode_ctx *_ctx; /* replacement for dict_t *(inode->ctx) */
     bool in_invalidate_list; /* Set if inode is in table invalidate list */
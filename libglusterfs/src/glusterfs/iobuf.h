@@ -35,6 +35,7 @@
     ((void *)((unsigned long)(ptr + bound - 1) & (unsigned long)(~(bound - 1))))
 
 #define GF_IOBUF_ALIGN_SIZE 512
+#define GF_IOBUF_ARENA_SLOTS 1024
 #define USE_IOBUF_POOL_IF_SIZE_GREATER_THAN 131072
 
 /* one allocatable unit for the consumers of the IOBUF API */
@@ -49,6 +50,17 @@ struct iobuf_arena;
 /* expandable and contractable pool of memory, internally broken into arenas */
 struct iobuf_pool;
 
+/* called with the pool mutex held whenever an arena's memory is mapped
+ * (@mapped == 1) or is about to be unmapped (@mapped == 0) */
+typedef void (*iobuf_arena_notify_t)(struct iobuf_arena *iobuf_arena,
+                                     int mapped, void *data);
+
+struct iobuf_arena_notify {
+    struct list_head list;
+    iobuf_arena_notify_t fn;
+    void *data;
+};
+
 struct iobuf_init_config {
     size_t pagesize;
     int32_t num_pages;
@@ -101,6 +113,8 @@ struct iobuf_arena {
     int active_cnt;
     int passive_cnt;
     int max_active; /* max active buffers at a given time */
+    int slot;       /* stable id of the mapped region in
+                       [0, GF_IOBUF_ARENA_SLOTS), -1 if none */
 };
 
 struct iobuf_pool {
@@ -123,6 +137,10 @@ struct iobuf_pool {
     uint64_t request_misses; /* mostly the requests for higher
                                value of iobufs */
     int arena_cnt;
+
+    struct list_head arena_notify; /* consumers registering arena
+                                      memory with the kernel */
+    unsigned char slots[GF_IOBUF_ARENA_SLOTS];
 };
 
 struct iobuf_pool *
@@ -175,6 +193,17 @@ iobuf_stats_dump(struct iobuf_pool *iobuf_pool);
 struct iobuf *
 iobuf_get2(struct iobuf_pool *iobuf_pool, size_t page_size);
 
+struct iobuf *
+iobuf_get_from_arena(struct iobuf_pool *iobuf_pool, size_t page_size);
+
+int
+iobuf_pool_add_arena_notify(struct iobuf_pool *iobuf_pool,
+                            iobuf_arena_notify_t fn, void *data);
+
+void
+iobuf_pool_del_arena_notify(struct iobuf_pool *iobuf_pool,
+                            iobuf_arena_notify_t fn, void *data);
+
 struct iobuf *
 iobuf_get_page_aligned(struct iobuf_pool *iobuf_pool, size_t page_size,
                        size_t align_size);
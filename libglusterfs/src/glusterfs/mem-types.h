@@ -106,6 +106,10 @@ enum gf_common_mem_types_ {
     gf_common_mt_scan_data, /* used only in one location */
     gf_common_list_node,
     /*used for compound fops*/
+    gf_common_mt_compound_req_t,
+    gf_common_mt_compound_rsp_t,
+    gf_common_mt_default_args_t,
+    gf_common_mt_default_args_cbk_t,
     gf_common_mt_tw_ctx, /* used only in one location */
     gf_common_mt_tw_timer_list,
     /*lock migration*/
@@ -120,6 +124,7 @@ enum gf_common_mem_types_ {
     gf_common_mt_mgmt_v3_lock_timer_t, /* used only in one location */
     gf_common_mt_server_cmdline_t,     /* used only in one location */
     gf_common_mt_latency_t,
+    gf_common_mt_iobuf_arena_notify, /* used only in one location */
     gf_common_mt_end,
 };
 #endif
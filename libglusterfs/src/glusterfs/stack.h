@@ -48,21 +48,33 @@ typedef int32_t (*ret_fn_t)(call_frame_t *frame, call_frame_t *prev_frame,
 void
 gf_frame_latency_update(call_frame_t *frame);
 
-struct call_pool {
-    union {
-        struct list_head all_frames;
-        struct {
-            call_stack_t *next_call;
-            call_stack_t *prev_call;
-        } all_stacks;
-    };
+void
+call_stack_link(call_pool_t *pool, call_stack_t *stack);
+
+/* Number of independent stack lists in a call pool. Each thread links the
+ * stacks it creates into one shard, so that fop setup and teardown on
+ * different threads don't serialize on a single lock. Must be a power of 2. */
+#define GF_CALL_POOL_SHARDS 64
+
+struct call_pool_shard {
+    struct list_head all_frames;
     int64_t cnt;
-    gf_atomic_t total_count;
+    uint64_t total_count;
     gf_lock_t lock;
+} __attribute__((aligned(CAA_CACHE_LINE_SIZE)));
+
+struct call_pool {
+    struct call_pool_shard shards[GF_CALL_POOL_SHARDS];
     struct mem_pool *frame_mem_pool;
     struct mem_pool *stack_mem_pool;
 };
 
+/* Iterates all stacks of a pool. Each shard's lock must be taken by the
+ * caller around the inner loop; see gf_proc_dump_pending_frames(). */
+#define call_pool_for_each_shard(_shard, _pool)                                \
+    for ((_shard) = &(_pool)->shards[0];                                       \
+         (_shard) < &(_pool)->shards[GF_CALL_POOL_SHARDS]; (_shard)++)
+
 struct _call_frame {
     call_stack_t *root;   /* stack root */
     call_frame_t *parent; /* previous BP */
@@ -101,6 +113,7 @@ struct _call_stack {
         };
     };
     call_pool_t *pool;
+    struct call_pool_shard *shard; /* shard of pool this stack is linked in */
     gf_lock_t stack_lock;
     client_t *client;
     uint64_t unique;
@@ -179,12 +192,12 @@ STACK_DESTROY(call_stack_t *stack)
     call_frame_t *frame = NULL;
     call_frame_t *tmp = NULL;
 
-    LOCK(&stack->pool->lock);
+    LOCK(&stack->shard->lock);
     {
         list_del_init(&stack->all_frames);
-        stack->pool->cnt--;
+        stack->shard->cnt--;
     }
-    UNLOCK(&stack->pool->lock);
+    UNLOCK(&stack->shard->lock);
 
     LOCK_DESTROY(&stack->stack_lock);
 
@@ -208,18 +221,19 @@ STACK_RESET(call_stack_t *stack)
 
     INIT_LIST_HEAD(&toreset);
 
-    /* We acquire call_pool->lock only to remove the frames from this stack
-     * to preserve atomicity. This synchronizes across concurrent requests
-     * like statedump, STACK_DESTROY etc. */
+    /* We acquire the lock of the call_pool shard holding this stack only to
+     * remove the frames from this stack to preserve atomicity. This
+     * synchronizes across concurrent requests like statedump, STACK_DESTROY
+     * etc. */
 
-    LOCK(&stack->pool->lock);
+    LOCK(&stack->shard->lock);
     {
         last = list_last_entry(&stack->myframes, call_frame_t, frames);
         list_del_init(&last->frames);
         list_splice_init(&stack->myframes, &toreset);
         list_add(&last->frames, &stack->myframes);
     }
-    UNLOCK(&stack->pool->lock);
+    UNLOCK(&stack->shard->lock);
 
     list_for_each_entry_safe(frame, tmp, &toreset, frames)
     {
@@ -524,13 +538,7 @@ copy_frame(call_frame_t *frame)
     LOCK_INIT(&newframe->lock);
     LOCK_INIT(&newstack->stack_lock);
 
-    LOCK(&oldstack->pool->lock);
-    {
-        list_add(&newstack->all_frames, &oldstack->all_frames);
-        newstack->pool->cnt++;
-    }
-    UNLOCK(&oldstack->pool->lock);
-    GF_ATOMIC_INC(newstack->pool->total_count);
+    call_stack_link(newstack->pool, newstack);
 
     return newframe;
 }
@@ -538,6 +546,14 @@ copy_frame(call_frame_t *frame)
 void
 call_stack_set_groups(call_stack_t *stack, int ngrps, gid_t **groupbuf_p);
 void
+call_pool_init(call_pool_t *pool);
+void
+call_pool_fini(call_pool_t *pool);
+int64_t
+call_pool_count(call_pool_t *pool);
+uint64_t
+call_pool_total_count(call_pool_t *pool);
+void
 gf_proc_dump_pending_frames(call_pool_t *call_pool);
 void
 gf_proc_dump_pending_frames_to_dict(call_pool_t *call_pool, dict_t *dict);
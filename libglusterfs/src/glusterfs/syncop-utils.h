@@ -13,6 +13,25 @@
 
 typedef int (*syncop_dir_scan_fn_t)(xlator_t *subvol, gf_dirent_t *entry,
                                     loc_t *parent, void *data);
+
+/* Concurrency of a multi-threaded scan driven by the load the clients put on
+ * the bricks: one more job is allowed each interval the client latency stays
+ * below the target, the jobs are halved when it goes above. */
+typedef struct {
+    pthread_mutex_t lock; /* of limit, which the scan reads under its own
+                             mutex */
+    uint32_t limit;       /* jobs allowed to run */
+    uint32_t target;      /* client latency in usecs, 0 not to throttle */
+    gf_atomic_t stamp; /* time of the last adjustment */
+    gf_atomic_t done;  /* jobs run */
+    uint64_t done_then;
+    time_t elapsed;   /* since the previous adjustment */
+    uint64_t latency; /* worst client latency of the bricks, in usecs */
+    uint64_t rate;    /* jobs per minute since the previous adjustment */
+    uint64_t backoffs;
+} syncop_throttle_t;
+
+#define SYNCOP_THROTTLE_INTERVAL 2 /* secs */
 int
 syncop_ftw(xlator_t *subvol, loc_t *loc, int pid, void *data,
            int (*fn)(xlator_t *subvol, gf_dirent_t *entry, loc_t *parent,
@@ -21,7 +40,29 @@ syncop_ftw(xlator_t *subvol, loc_t *loc, int pid, void *data,
 int
 syncop_mt_dir_scan(call_frame_t *frame, xlator_t *subvol, loc_t *loc, int pid,
                    void *data, syncop_dir_scan_fn_t fn, dict_t *xdata,
-                   uint32_t max_jobs, uint32_t max_qlen);
+                   uint32_t max_jobs, syncop_throttle_t *throttle,
+                   uint32_t max_qlen);
+
+void
+syncop_throttle_init(syncop_throttle_t *throttle, uint32_t target_usec,
+                     uint32_t max_jobs);
+
+void
+syncop_throttle_reset(syncop_throttle_t *throttle, uint32_t target_usec,
+                      uint32_t max_jobs);
+
+uint32_t
+syncop_throttle_limit(syncop_throttle_t *throttle);
+
+gf_boolean_t
+syncop_throttle_due(syncop_throttle_t *throttle);
+
+void
+syncop_throttle_adjust(syncop_throttle_t *throttle, uint64_t latency,
+                       uint32_t max_jobs);
+
+int
+syncop_subvol_load(xlator_t *subvol, uint64_t *latency);
 
 int
 syncop_dir_scan(xlator_t *subvol, loc_t *loc, int pid, void *data,
@@ -18,6 +18,19 @@
 
 typedef void (*gf_timer_cbk_t)(void *);
 
+/* Timers are kept in a hierarchical timing wheel: a root wheel with one slot
+ * per tick, and GF_TIMER_WHEEL_LEVELS outer wheels whose slots each cover a
+ * whole turn of the wheel below. Arming and cancelling a timer is O(1);
+ * timers in outer wheels are cascaded inwards as time advances. */
+#define GF_TIMER_TICK_NS 1000000ULL /* 1 ms */
+#define GF_TIMER_WHEEL_ROOT_BITS 8
+#define GF_TIMER_WHEEL_LEVEL_BITS 6
+#define GF_TIMER_WHEEL_LEVELS 4
+#define GF_TIMER_WHEEL_ROOT_SIZE (1 << GF_TIMER_WHEEL_ROOT_BITS)
+#define GF_TIMER_WHEEL_LEVEL_SIZE (1 << GF_TIMER_WHEEL_LEVEL_BITS)
+#define GF_TIMER_WHEEL_ROOT_MASK (GF_TIMER_WHEEL_ROOT_SIZE - 1)
+#define GF_TIMER_WHEEL_LEVEL_MASK (GF_TIMER_WHEEL_LEVEL_SIZE - 1)
+
 struct _gf_timer {
     union {
         struct list_head list;
@@ -27,6 +40,7 @@ struct _gf_timer {
         };
     };
     struct timespec at;
+    uint64_t expires; /* tick at which the timer is due */
     gf_timer_cbk_t callbk;
     void *data;
     xlator_t *xl;
@@ -34,7 +48,22 @@ struct _gf_timer {
 };
 
 struct _gf_timer_registry {
-    struct list_head active;
+    struct list_head root[GF_TIMER_WHEEL_ROOT_SIZE];
+    struct list_head levels[GF_TIMER_WHEEL_LEVELS][GF_TIMER_WHEEL_LEVEL_SIZE];
+    /* non-empty slots of the root wheel */
+    uint64_t root_map[GF_TIMER_WHEEL_ROOT_SIZE / 64];
+    uint64_t tick;        /* next tick to be processed */
+    uint64_t next_wakeup; /* tick gf_timer_proc() is sleeping until */
+    uint64_t pending;
+
+    /* statistics, reported in statedump */
+    uint64_t armed;
+    uint64_t fired;
+    uint64_t cancelled;
+    uint64_t cascaded;
+    uint64_t delay_total; /* ns between due and fire time, summed */
+    uint64_t delay_max;
+
     pthread_mutex_t lock;
     pthread_cond_t cond;
     pthread_t th;
@@ -53,4 +82,7 @@ gf_timer_call_cancel(glusterfs_ctx_t *ctx, gf_timer_t *event);
 
 void
 gf_timer_registry_destroy(glusterfs_ctx_t *ctx);
+
+void
+gf_timer_registry_dump(glusterfs_ctx_t *ctx);
 #endif /* _TIMER_H */
@@ -116,9 +116,8 @@ Based on this, the code could be similar to this:
 */
 // clang-format on
 
-#define INODE_DUMP_LIST(head, key_buf, key_prefix, list_type)                  \
+#define INODE_DUMP_LIST(head, key_buf, key_prefix, list_type, i)               \
     {                                                                          \
-        int i = 1;                                                             \
         inode_t *inode = NULL;                                                 \
         list_for_each_entry(inode, head, list)                                 \
         {                                                                      \
@@ -129,6 +128,10 @@ Based on this, the code could be similar to this:
         }                                                                      \
     }
 
+#define inode_table_for_each_shard(_shard, _table)                             \
+    for ((_shard) = &(_table)->shards[0];                                      \
+         (_shard) < &(_table)->shards[GF_INODE_TABLE_SHARDS]; (_shard)++)
+
 static inode_t *
 __inode_unref(inode_t *inode, bool clear);
 
@@ -161,6 +164,54 @@ hash_gfid(uuid_t uuid, int mod)
     return ((uuid[15] + (uuid[14] << 8)) % mod);
 }
 
+/* the shard owning inode hash bucket @hash, and the inodes in it */
+static struct inode_table_shard *
+inode_table_shard(inode_table_t *table, const int hash)
+{
+    return &table->shards[hash & (GF_INODE_TABLE_SHARDS - 1)];
+}
+
+static struct inode_table_shard *
+__inode_shard(inode_t *inode)
+{
+    return &inode->table->shards[inode->shard];
+}
+
+/* Locks the shard @inode is in. An inode changes shard only once, when it
+ * is first linked and moves to the shard of its gfid, and that is done
+ * with both shards locked. */
+static struct inode_table_shard *
+inode_shard_lock(inode_t *inode)
+{
+    struct inode_table_shard *shard = NULL;
+    uint32_t index = 0;
+
+    for (;;) {
+        index = inode->shard;
+        shard = &inode->table->shards[index];
+        pthread_mutex_lock(&shard->lock);
+        if (inode->shard == index)
+            break;
+        pthread_mutex_unlock(&shard->lock);
+    }
+
+    return shard;
+}
+
+static uint32_t
+__inode_table_lru_size(inode_table_t *table)
+{
+    struct inode_table_shard *shard = NULL;
+    uint32_t lru_size = 0;
+
+    inode_table_for_each_shard(shard, table)
+    {
+        lru_size += shard->lru_size;
+    }
+
+    return lru_size;
+}
+
 static void
 __dentry_hash(dentry_t *dentry, const int hash)
 {
@@ -406,38 +457,44 @@ inode_ctx_merge(fd_t *fd, inode_t *inode, inode_t *linked_inode)
 static void
 __inode_activate(inode_t *inode)
 {
-    list_move(&inode->list, &inode->table->active);
-    inode->table->active_size++;
+    struct inode_table_shard *shard = __inode_shard(inode);
+
+    list_move(&inode->list, &shard->active);
+    shard->active_size++;
 }
 
+/* Dentries are on an inode's list only for as long as they are hashed (see
+ * __dentry_unset()), so unlike retiring, this needs only the shard lock. */
 static void
 __inode_passivate(inode_t *inode)
 {
-    dentry_t *dentry = NULL;
-    dentry_t *t = NULL;
+    struct inode_table_shard *shard = __inode_shard(inode);
 
     GF_ASSERT(!inode->in_lru_list);
-    list_move_tail(&inode->list, &inode->table->lru);
-    inode->table->lru_size++;
+    list_move_tail(&inode->list, &shard->lru);
+    shard->lru_size++;
     inode->in_lru_list = _gf_true;
-
-    list_for_each_entry_safe(dentry, t, &inode->dentry_list, inode_list)
-    {
-        if (!__is_dentry_hashed(dentry))
-            dentry_destroy(__dentry_unset(dentry));
-    }
 }
 
+/* Moves @inode from its shard to the purge list. Needs table->lock and the
+ * shard lock, and has to be followed by __inode_retire_dentries() once the
+ * shard lock is released. */
 static void
 __inode_retire(inode_t *inode)
 {
-    dentry_t *dentry = NULL;
-    dentry_t *t = NULL;
-
     list_move_tail(&inode->list, &inode->table->purge);
     inode->table->purge_size++;
 
     __inode_unhash(inode);
+}
+
+/* Needs only table->lock, as unsetting the dentries unrefs (and may retire)
+ * the parents, which can be in any shard. */
+static void
+__inode_retire_dentries(inode_t *inode)
+{
+    dentry_t *dentry = NULL;
+    dentry_t *t = NULL;
 
     list_for_each_entry_safe(dentry, t, &inode->dentry_list, inode_list)
     {
@@ -461,9 +518,15 @@ out:
     return set_idx;
 }
 
-static inode_t *
-__inode_unref(inode_t *inode, bool clear)
+/* Drops a ref on @inode, with its shard locked. Dropping the last ref of an
+ * inode nobody looked up retires it, which needs table->lock as well: if
+ * the caller doesn't hold it (@retire is NULL), nothing is done and -1 is
+ * returned. Otherwise *@retire tells whether __inode_retire_dentries() has
+ * to follow. */
+static int
+__inode_shard_unref(inode_t *inode, bool clear, bool *retire)
 {
+    struct inode_table_shard *shard = __inode_shard(inode);
     int index = 0;
     xlator_t *this = NULL;
     uint64_t nlookup = 0;
@@ -473,13 +536,8 @@ __inode_unref(inode_t *inode, bool clear)
      * on root inode are no-ops.
      */
     if (__is_root_gfid(inode->gfid))
-        return inode;
+        return 0;
 
-    /*
-     * No need to acquire inode table's lock
-     * as __inode_unref is called after acquiding
-     * the inode table's lock.
-     */
     if (inode->table->cleanup_started && !inode->ref)
         /*
          * There is a good chance that, the inode
@@ -505,16 +563,22 @@ __inode_unref(inode_t *inode, bool clear)
          * below as the refcount of 'a' has been already set
          * to zero.
          *
-         * So return the inode if the inode table cleanup
+         * So just return if the inode table cleanup
          * has already started and inode refcount is 0.
          */
-        return inode;
+        return 0;
+
+    if ((inode->ref == 1) && (clear || !inode->in_invalidate_list)) {
+        nlookup = GF_ATOMIC_GET(inode->nlookup);
+        if (!nlookup && !retire)
+            return -1;
+    }
 
     this = THIS;
 
     if (clear && inode->in_invalidate_list) {
         inode->in_invalidate_list = false;
-        inode->table->invalidate_size--;
+        shard->invalidate_size--;
         __inode_activate(inode);
     }
     GF_ASSERT(inode->ref);
@@ -528,21 +592,43 @@ __inode_unref(inode_t *inode, bool clear)
     }
 
     if (!inode->ref && !inode->in_invalidate_list) {
-        inode->table->active_size--;
+        shard->active_size--;
 
-        nlookup = GF_ATOMIC_GET(inode->nlookup);
-        if (nlookup)
+        if (nlookup) {
             __inode_passivate(inode);
-        else
+        } else {
             __inode_retire(inode);
+            *retire = true;
+        }
     }
 
+    return 0;
+}
+
+/* needs table->lock */
+static inode_t *
+__inode_unref(inode_t *inode, bool clear)
+{
+    struct inode_table_shard *shard = NULL;
+    bool retire = false;
+
+    shard = inode_shard_lock(inode);
+    {
+        __inode_shard_unref(inode, clear, &retire);
+    }
+    pthread_mutex_unlock(&shard->lock);
+
+    if (retire)
+        __inode_retire_dentries(inode);
+
     return inode;
 }
 
+/* needs the inode's shard lock */
 static inode_t *
 __inode_ref(inode_t *inode, bool is_invalidate)
 {
+    struct inode_table_shard *shard = NULL;
     int index = 0;
     xlator_t *this = NULL;
 
@@ -562,20 +648,22 @@ __inode_ref(inode_t *inode, bool is_invalidate)
     if (__is_root_gfid(inode->gfid) && inode->ref)
         return inode;
 
+    shard = __inode_shard(inode);
+
     if (!inode->ref) {
         if (inode->in_invalidate_list) {
             inode->in_invalidate_list = false;
-            inode->table->invalidate_size--;
+            shard->invalidate_size--;
         } else {
-            GF_ASSERT(inode->table->lru_size > 0);
+            GF_ASSERT(shard->lru_size > 0);
             GF_ASSERT(inode->in_lru_list);
-            inode->table->lru_size--;
+            shard->lru_size--;
             inode->in_lru_list = _gf_false;
         }
         if (is_invalidate) {
             inode->in_invalidate_list = true;
-            inode->table->invalidate_size++;
-            list_move_tail(&inode->list, &inode->table->invalidate);
+            shard->invalidate_size++;
+            list_move_tail(&inode->list, &shard->invalidate);
         } else {
             __inode_activate(inode);
         }
@@ -596,17 +684,28 @@ inode_t *
 inode_unref(inode_t *inode)
 {
     inode_table_t *table = NULL;
+    struct inode_table_shard *shard = NULL;
+    int ret = 0;
 
     if (!inode)
         return NULL;
 
     table = inode->table;
 
-    pthread_mutex_lock(&table->lock);
+    shard = inode_shard_lock(inode);
     {
-        inode = __inode_unref(inode, false);
+        ret = __inode_shard_unref(inode, false, NULL);
+    }
+    pthread_mutex_unlock(&shard->lock);
+
+    /* the last ref on an inode which is to be retired */
+    if (ret) {
+        pthread_mutex_lock(&table->lock);
+        {
+            inode = __inode_unref(inode, false);
+        }
+        pthread_mutex_unlock(&table->lock);
     }
-    pthread_mutex_unlock(&table->lock);
 
     inode_table_prune(table);
 
@@ -616,18 +715,16 @@ inode_unref(inode_t *inode)
 inode_t *
 inode_ref(inode_t *inode)
 {
-    inode_table_t *table = NULL;
+    struct inode_table_shard *shard = NULL;
 
     if (!inode)
         return NULL;
 
-    table = inode->table;
-
-    pthread_mutex_lock(&table->lock);
+    shard = inode_shard_lock(inode);
     {
         inode = __inode_ref(inode, false);
     }
-    pthread_mutex_unlock(&table->lock);
+    pthread_mutex_unlock(&shard->lock);
 
     return inode;
 }
@@ -669,6 +766,9 @@ inode_create(inode_table_t *table)
     }
 
     newi->table = table;
+    /* any shard will do until it gets linked */
+    newi->shard = ((uintptr_t)newi / sizeof(*newi)) &
+                  (GF_INODE_TABLE_SHARDS - 1);
 
     LOCK_INIT(&newi->lock);
 
@@ -694,6 +794,7 @@ inode_t *
 inode_new(inode_table_t *table)
 {
     inode_t *inode = NULL;
+    struct inode_table_shard *shard = NULL;
 
     if (!table) {
         gf_msg_callingfn(THIS->name, GF_LOG_WARNING, 0,
@@ -705,15 +806,17 @@ inode_new(inode_table_t *table)
 
     inode = inode_create(table);
     if (inode) {
-        pthread_mutex_lock(&table->lock);
+        shard = __inode_shard(inode);
+
+        pthread_mutex_lock(&shard->lock);
         {
-            list_add(&inode->list, &table->lru);
-            table->lru_size++;
+            list_add(&inode->list, &shard->lru);
+            shard->lru_size++;
             GF_ASSERT(!inode->in_lru_list);
             inode->in_lru_list = _gf_true;
             __inode_ref(inode, false);
         }
-        pthread_mutex_unlock(&table->lock);
+        pthread_mutex_unlock(&shard->lock);
     }
 
     return inode;
@@ -731,24 +834,35 @@ inode_new(inode_table_t *table)
 static inode_t *
 __inode_ref_reduce_by_n(inode_t *inode, uint64_t nref)
 {
+    struct inode_table_shard *shard = NULL;
     uint64_t nlookup = 0;
+    bool retire = false;
 
-    GF_ASSERT(inode->ref >= nref);
+    shard = inode_shard_lock(inode);
+    {
+        GF_ASSERT(inode->ref >= nref);
 
-    inode->ref -= nref;
+        inode->ref -= nref;
 
-    if (!nref)
-        inode->ref = 0;
+        if (!nref)
+            inode->ref = 0;
 
-    if (!inode->ref) {
-        inode->table->active_size--;
+        if (!inode->ref) {
+            shard->active_size--;
 
-        nlookup = GF_ATOMIC_GET(inode->nlookup);
-        if (nlookup)
-            __inode_passivate(inode);
-        else
-            __inode_retire(inode);
+            nlookup = GF_ATOMIC_GET(inode->nlookup);
+            if (nlookup) {
+                __inode_passivate(inode);
+            } else {
+                __inode_retire(inode);
+                retire = true;
+            }
+        }
     }
+    pthread_mutex_unlock(&shard->lock);
+
+    if (retire)
+        __inode_retire_dentries(inode);
 
     return inode;
 }
@@ -810,7 +924,7 @@ inode_grep(inode_table_t *table, inode_t *parent, const char *name)
         if (dentry) {
             inode = dentry->inode;
             if (inode)
-                __inode_ref(inode, false);
+                inode_ref(inode);
         }
     }
     pthread_mutex_unlock(&table->lock);
@@ -909,6 +1023,7 @@ __is_root_gfid(uuid_t gfid)
     return _gf_false;
 }
 
+/* needs the lock of the shard owning bucket @hash */
 inode_t *
 __inode_find(inode_table_t *table, uuid_t gfid, const int hash)
 {
@@ -943,18 +1058,50 @@ inode_find(inode_table_t *table, uuid_t gfid)
     }
 
     int hash = hash_gfid(gfid, table->inode_hashsize);
+    struct inode_table_shard *shard = inode_table_shard(table, hash);
 
-    pthread_mutex_lock(&table->lock);
+    pthread_mutex_lock(&shard->lock);
     {
         inode = __inode_find(table, gfid, hash);
         if (inode)
             __inode_ref(inode, false);
     }
-    pthread_mutex_unlock(&table->lock);
+    pthread_mutex_unlock(&shard->lock);
 
     return inode;
 }
 
+/* Moves a newly linked inode to the shard of its gfid. Needs table->lock
+ * and the lock of @to. Taking a second shard lock is only ever done with
+ * table->lock held, which is what keeps the order of the two safe. */
+static void
+__inode_shard_move(inode_t *inode, struct inode_table_shard *to)
+{
+    struct inode_table_shard *from = __inode_shard(inode);
+
+    if (from == to)
+        return;
+
+    pthread_mutex_lock(&from->lock);
+    {
+        if (inode->in_lru_list) {
+            from->lru_size--;
+            to->lru_size++;
+            list_move_tail(&inode->list, &to->lru);
+        } else if (inode->in_invalidate_list) {
+            from->invalidate_size--;
+            to->invalidate_size++;
+            list_move_tail(&inode->list, &to->invalidate);
+        } else {
+            from->active_size--;
+            to->active_size++;
+            list_move(&inode->list, &to->active);
+        }
+        inode->shard = to - inode->table->shards;
+    }
+    pthread_mutex_unlock(&from->lock);
+}
+
 static inode_t *
 __inode_link(inode_t *inode, inode_t *parent, const char *name,
              struct iatt *iatt, const int dhash)
@@ -964,6 +1111,7 @@ __inode_link(inode_t *inode, inode_t *parent, const char *name,
     inode_t *old_inode = NULL;
     inode_table_t *table = NULL;
     inode_t *link_inode = NULL;
+    struct inode_table_shard *shard = NULL;
     char link_uuid_str[64] = {0}, parent_uuid_str[64] = {0};
 
     table = inode->table;
@@ -1006,15 +1154,21 @@ __inode_link(inode_t *inode, inode_t *parent, const char *name,
 
         int ihash = hash_gfid(iatt->ia_gfid, table->inode_hashsize);
 
-        old_inode = __inode_find(table, iatt->ia_gfid, ihash);
+        shard = inode_table_shard(table, ihash);
+        pthread_mutex_lock(&shard->lock);
+        {
+            old_inode = __inode_find(table, iatt->ia_gfid, ihash);
 
-        if (old_inode) {
-            link_inode = old_inode;
-        } else {
-            gf_uuid_copy(inode->gfid, iatt->ia_gfid);
-            inode->ia_type = iatt->ia_type;
-            __inode_hash(inode, ihash);
+            if (old_inode) {
+                link_inode = old_inode;
+            } else {
+                gf_uuid_copy(inode->gfid, iatt->ia_gfid);
+                inode->ia_type = iatt->ia_type;
+                __inode_shard_move(inode, shard);
+                __inode_hash(inode, ihash);
+            }
         }
+        pthread_mutex_unlock(&shard->lock);
     } else {
         /* @old_inode serves another important purpose - it indicates
            to the code further below whether a dentry cycle check is
@@ -1050,7 +1204,7 @@ __inode_link(inode_t *inode, inode_t *parent, const char *name,
             }
 
             /* dentry linking needs to happen inside lock */
-            dentry->parent = __inode_ref(parent, false);
+            dentry->parent = inode_ref(parent);
             list_add(&dentry->inode_list, &link_inode->dentry_list);
 
             if (old_inode && __is_dentry_cyclic(dentry)) {
@@ -1096,7 +1250,7 @@ inode_link(inode_t *inode, inode_t *parent, const char *name, struct iatt *iatt)
     {
         linked_inode = __inode_link(inode, parent, name, iatt, hash);
         if (linked_inode)
-            __inode_ref(linked_inode, false);
+            inode_ref(linked_inode);
     }
     pthread_mutex_unlock(&table->lock);
 
@@ -1379,7 +1533,7 @@ inode_parent(inode_t *inode, uuid_t pargfid, const char *name)
             parent = dentry->parent;
 
         if (parent)
-            __inode_ref(parent, false);
+            inode_ref(parent);
     }
     pthread_mutex_unlock(&table->lock);
 
@@ -1549,6 +1703,23 @@ inode_table_set_lru_limit(inode_table_t *table, uint32_t lru_limit)
     return;
 }
 
+/* Evicting from the longest lru list keeps the shards about even, which
+ * approximates a single lru list over the whole table. */
+static struct inode_table_shard *
+__inode_table_prune_shard(inode_table_t *table)
+{
+    struct inode_table_shard *shard = NULL;
+    struct inode_table_shard *victim = NULL;
+
+    inode_table_for_each_shard(shard, table)
+    {
+        if (shard->lru_size && (!victim || (shard->lru_size > victim->lru_size)))
+            victim = shard;
+    }
+
+    return victim;
+}
+
 static int
 inode_table_prune(inode_table_t *table)
 {
@@ -1560,12 +1731,21 @@ inode_table_prune(inode_table_t *table)
     inode_t *del = NULL;
     inode_t *tmp = NULL;
     inode_t *entry = NULL;
+    struct inode_table_shard *shard = NULL;
     uint64_t nlookup = 0;
     int64_t lru_size = 0;
 
     if (!table)
         return -1;
 
+    /* Nothing to do is by far the most common case, which must not take
+     * table->lock. The sizes are read unlocked, anything missed is done by
+     * the next caller. */
+    if (!table->purge_size &&
+        (!table->lru_limit ||
+         (__inode_table_lru_size(table) <= table->lru_limit)))
+        return 0;
+
     INIT_LIST_HEAD(&purge);
 
     pthread_mutex_lock(&table->lock);
@@ -1573,20 +1753,23 @@ inode_table_prune(inode_table_t *table)
         if (!table->lru_limit)
             goto purge_list;
 
-        lru_size = table->lru_size;
+        lru_size = __inode_table_lru_size(table);
         while (lru_size > (table->lru_limit)) {
-            if (list_empty(&table->lru)) {
-                GF_ASSERT(0);
-                gf_msg_callingfn(THIS->name, GF_LOG_WARNING, 0,
-                                 LG_MSG_INVALID_INODE_LIST,
-                                 "Empty inode lru list found"
-                                 " but with (%d) lru_size",
-                                 table->lru_size);
+            /* the shards are not frozen by table->lock, they can have
+             * emptied since lru_size was taken */
+            shard = __inode_table_prune_shard(table);
+            if (!shard)
                 break;
-            }
 
             lru_size--;
-            entry = list_entry(table->lru.next, inode_t, list);
+
+            pthread_mutex_lock(&shard->lock);
+            if (list_empty(&shard->lru)) {
+                pthread_mutex_unlock(&shard->lock);
+                continue;
+            }
+
+            entry = list_entry(shard->lru.next, inode_t, list);
             GF_ASSERT(entry->in_lru_list);
             /* The logic of invalidation is required only if invalidator_fn
                is present */
@@ -1595,18 +1778,23 @@ inode_table_prune(inode_table_t *table)
                 nlookup = GF_ATOMIC_GET(entry->nlookup);
                 if (nlookup) {
                     if (entry->invalidate_sent) {
-                        list_move_tail(&entry->list, &table->lru);
+                        list_move_tail(&entry->list, &shard->lru);
+                        pthread_mutex_unlock(&shard->lock);
                         continue;
                     }
                     __inode_ref(entry, true);
+                    pthread_mutex_unlock(&shard->lock);
                     tmp = entry;
                     break;
                 }
             }
 
-            table->lru_size--;
+            shard->lru_size--;
             entry->in_lru_list = _gf_false;
             __inode_retire(entry);
+            pthread_mutex_unlock(&shard->lock);
+
+            __inode_retire_dentries(entry);
             ret++;
         }
 
@@ -1625,7 +1813,9 @@ inode_table_prune(inode_table_t *table)
         pthread_mutex_lock(&table->lock);
         {
             if (!ret1) {
+                shard = inode_shard_lock(tmp);
                 tmp->invalidate_sent = true;
+                pthread_mutex_unlock(&shard->lock);
                 __inode_unref(tmp, false);
             } else {
                 /* Move this back to the lru list*/
@@ -1659,8 +1849,8 @@ __inode_table_init_root(inode_table_t *table)
 
     root = inode_create(table);
 
-    list_add(&root->list, &table->lru);
-    table->lru_size++;
+    list_add(&root->list, &__inode_shard(root)->lru);
+    __inode_shard(root)->lru_size++;
     root->in_lru_list = _gf_true;
 
     iatt.ia_gfid[15] = 1;
@@ -1679,6 +1869,7 @@ inode_table_with_invalidator(uint32_t lru_limit, xlator_t *xl,
 {
     inode_table_t *new = NULL;
     uint32_t mem_pool_size = lru_limit;
+    struct inode_table_shard *shard = NULL;
     int ret = -1;
     int i = 0;
 
@@ -1744,10 +1935,16 @@ inode_table_with_invalidator(uint32_t lru_limit, xlator_t *xl,
         INIT_LIST_HEAD(&new->name_hash[i]);
     }
 
-    INIT_LIST_HEAD(&new->active);
-    INIT_LIST_HEAD(&new->lru);
     INIT_LIST_HEAD(&new->purge);
-    INIT_LIST_HEAD(&new->invalidate);
+
+    inode_table_for_each_shard(shard, new)
+    {
+        pthread_mutex_init(&shard->lock, NULL);
+        INIT_LIST_HEAD(&shard->active);
+        INIT_LIST_HEAD(&shard->lru);
+        INIT_LIST_HEAD(&shard->invalidate);
+    }
+    pthread_mutex_init(&new->lock, NULL);
 
     ret = gf_asprintf(&new->name, "%s/inode", xl->name);
     if (-1 == ret) {
@@ -1759,8 +1956,6 @@ inode_table_with_invalidator(uint32_t lru_limit, xlator_t *xl,
 
     __inode_table_init_root(new);
 
-    pthread_mutex_init(&new->lock, NULL);
-
     ret = 0;
 out:
     if (ret) {
@@ -1798,6 +1993,9 @@ inode_table_ctx_free(inode_table_t *table)
     int lru_count = 0;
     int active_count = 0;
     xlator_t *this = NULL;
+    struct inode_table_shard *shard = NULL;
+    uint32_t active_size = 0;
+    uint32_t lru_size = 0;
     int itable_size = 0;
 
     if (!table)
@@ -1815,40 +2013,49 @@ inode_table_ctx_free(inode_table_t *table)
             }
         }
 
-        list_for_each_entry_safe(del, tmp, &table->lru, list)
+        inode_table_for_each_shard(shard, table)
         {
-            if (del->_ctx) {
-                __inode_ctx_free(del);
-                lru_count++;
+            pthread_mutex_lock(&shard->lock);
+
+            list_for_each_entry_safe(del, tmp, &shard->lru, list)
+            {
+                if (del->_ctx) {
+                    __inode_ctx_free(del);
+                    lru_count++;
+                }
             }
-        }
 
-        /* should the contexts of active inodes be freed?
-         * Since before this function being called fds would have
-         * been migrated and would have held the ref on the new
-         * inode from the new inode table, the older inode would not
-         * be used.
-         */
-        list_for_each_entry_safe(del, tmp, &table->active, list)
-        {
-            if (del->_ctx) {
-                __inode_ctx_free(del);
-                active_count++;
+            /* should the contexts of active inodes be freed?
+             * Since before this function being called fds would have
+             * been migrated and would have held the ref on the new
+             * inode from the new inode table, the older inode would not
+             * be used.
+             */
+            list_for_each_entry_safe(del, tmp, &shard->active, list)
+            {
+                if (del->_ctx) {
+                    __inode_ctx_free(del);
+                    active_count++;
+                }
             }
+
+            active_size += shard->active_size;
+            lru_size += shard->lru_size;
+
+            pthread_mutex_unlock(&shard->lock);
         }
     }
     pthread_mutex_unlock(&table->lock);
 
     ret = purge_count + lru_count + active_count;
-    itable_size = table->active_size + table->lru_size + table->purge_size;
+    itable_size = active_size + lru_size + table->purge_size;
     gf_msg_callingfn(this->name, GF_LOG_INFO, 0, LG_MSG_INODE_CONTEXT_FREED,
                      "total %d (itable size: "
                      "%d) inode contexts have been freed (active: %d, ("
                      "active size: %d), lru: %d, (lru size: %d),  purge: "
                      "%d, (purge size: %d))",
-                     ret, itable_size, active_count, table->active_size,
-                     lru_count, table->lru_size, purge_count,
-                     table->purge_size);
+                     ret, itable_size, active_count, active_size, lru_count,
+                     lru_size, purge_count, table->purge_size);
     return ret;
 }
 
@@ -1881,6 +2088,8 @@ void
 inode_table_destroy(inode_table_t *inode_table)
 {
     inode_t *trav = NULL;
+    struct inode_table_shard *shard = NULL;
+    gf_boolean_t busy = _gf_false;
 
     if (inode_table == NULL)
         return;
@@ -1916,43 +2125,66 @@ inode_table_destroy(inode_table_t *inode_table)
          * shall unref their parent
          *
          * These parent inodes when unref'ed may well again fall
-         * into lru list and if we are at the end of traversing
-         * the list, we may miss to delete/retire that entry. Hence
-         * traverse the lru list till it gets empty.
+         * into lru list of this or any other shard, even one we
+         * are done with. Hence go over the shards till they all
+         * are empty.
          */
-        while (!list_empty(&inode_table->lru)) {
-            trav = list_first_entry(&inode_table->lru, inode_t, list);
-            inode_forget_atomic(trav, 0);
-            GF_ASSERT(inode_table->lru_size > 0);
-            GF_ASSERT(trav->in_lru_list);
-            __inode_retire(trav);
-            inode_table->lru_size--;
-            trav->in_lru_list = _gf_false;
-        }
+        do {
+            busy = _gf_false;
+
+            inode_table_for_each_shard(shard, inode_table)
+            {
+                pthread_mutex_lock(&shard->lock);
+                while (!list_empty(&shard->lru)) {
+                    trav = list_first_entry(&shard->lru, inode_t, list);
+                    inode_forget_atomic(trav, 0);
+                    GF_ASSERT(shard->lru_size > 0);
+                    GF_ASSERT(trav->in_lru_list);
+                    __inode_retire(trav);
+                    shard->lru_size--;
+                    trav->in_lru_list = _gf_false;
+
+                    pthread_mutex_unlock(&shard->lock);
+                    __inode_retire_dentries(trav);
+                    busy = _gf_true;
+                    pthread_mutex_lock(&shard->lock);
+                }
 
-        /* Same logic for invalidate list */
-        while (!list_empty(&inode_table->invalidate)) {
-            trav = list_first_entry(&inode_table->invalidate, inode_t, list);
-            inode_forget_atomic(trav, 0);
-            __inode_retire(trav);
-            inode_table->invalidate_size--;
-        }
+                /* Same logic for invalidate list */
+                while (!list_empty(&shard->invalidate)) {
+                    trav = list_first_entry(&shard->invalidate, inode_t, list);
+                    inode_forget_atomic(trav, 0);
+                    __inode_retire(trav);
+                    shard->invalidate_size--;
+
+                    pthread_mutex_unlock(&shard->lock);
+                    __inode_retire_dentries(trav);
+                    busy = _gf_true;
+                    pthread_mutex_lock(&shard->lock);
+                }
 
-        while (!list_empty(&inode_table->active)) {
-            trav = list_first_entry(&inode_table->active, inode_t, list);
-            /* forget and unref the inode to retire and add it to
-             * purge list. By this time there should not be any
-             * inodes present in the active list except for root
-             * inode. Its a ref_leak otherwise. */
-            if (trav && (trav != inode_table->root))
-                gf_msg_callingfn(THIS->name, GF_LOG_WARNING, 0,
-                                 LG_MSG_REF_COUNT,
-                                 "Active inode(%p) with refcount"
-                                 "(%d) found during cleanup",
-                                 trav, trav->ref);
-            inode_forget_atomic(trav, 0);
-            __inode_ref_reduce_by_n(trav, 0);
-        }
+                while (!list_empty(&shard->active)) {
+                    trav = list_first_entry(&shard->active, inode_t, list);
+                    pthread_mutex_unlock(&shard->lock);
+
+                    /* forget and unref the inode to retire and add it to
+                     * purge list. By this time there should not be any
+                     * inodes present in the active list except for root
+                     * inode. Its a ref_leak otherwise. */
+                    if (trav != inode_table->root)
+                        gf_msg_callingfn(THIS->name, GF_LOG_WARNING, 0,
+                                         LG_MSG_REF_COUNT,
+                                         "Active inode(%p) with refcount"
+                                         "(%d) found during cleanup",
+                                         trav, trav->ref);
+                    inode_forget_atomic(trav, 0);
+                    __inode_ref_reduce_by_n(trav, 0);
+                    busy = _gf_true;
+                    pthread_mutex_lock(&shard->lock);
+                }
+                pthread_mutex_unlock(&shard->lock);
+            }
+        } while (busy);
     }
     pthread_mutex_unlock(&inode_table->lock);
 
@@ -1967,6 +2199,10 @@ inode_table_destroy(inode_table_t *inode_table)
     if (inode_table->fd_mem_pool)
         mem_pool_destroy(inode_table->fd_mem_pool);
 
+    inode_table_for_each_shard(shard, inode_table)
+    {
+        pthread_mutex_destroy(&shard->lock);
+    }
     pthread_mutex_destroy(&inode_table->lock);
 
     GF_FREE(inode_table->name);
@@ -2398,7 +2634,7 @@ int
 inode_is_linked(inode_t *inode)
 {
     int ret = 0;
-    inode_table_t *table = NULL;
+    struct inode_table_shard *shard = NULL;
 
     if (!inode) {
         gf_msg_callingfn(THIS->name, GF_LOG_WARNING, 0, LG_MSG_INODE_NOT_FOUND,
@@ -2406,13 +2642,11 @@ inode_is_linked(inode_t *inode)
         return 0;
     }
 
-    table = inode->table;
-
-    pthread_mutex_lock(&table->lock);
+    shard = inode_shard_lock(inode);
     {
         ret = __is_inode_hashed(inode);
     }
-    pthread_mutex_unlock(&table->lock);
+    pthread_mutex_unlock(&shard->lock);
 
     return ret;
 }
@@ -2493,11 +2727,45 @@ unlock:
     return;
 }
 
+/* Locks all the shards, to dump them consistently. Needs table->lock. */
+static void
+__inode_table_lock_shards(inode_table_t *table, uint32_t *active_size,
+                          uint32_t *lru_size, uint32_t *invalidate_size)
+{
+    struct inode_table_shard *shard = NULL;
+
+    *active_size = *lru_size = *invalidate_size = 0;
+
+    inode_table_for_each_shard(shard, table)
+    {
+        pthread_mutex_lock(&shard->lock);
+        *active_size += shard->active_size;
+        *lru_size += shard->lru_size;
+        *invalidate_size += shard->invalidate_size;
+    }
+}
+
+static void
+__inode_table_unlock_shards(inode_table_t *table)
+{
+    struct inode_table_shard *shard = NULL;
+
+    inode_table_for_each_shard(shard, table)
+    {
+        pthread_mutex_unlock(&shard->lock);
+    }
+}
+
 void
 inode_table_dump(inode_table_t *itable, char *prefix)
 {
     char key[GF_DUMP_MAX_BUF_LEN];
+    struct inode_table_shard *shard = NULL;
+    uint32_t active_size = 0;
+    uint32_t lru_size = 0;
+    uint32_t invalidate_size = 0;
     int ret = 0;
+    int i = 1;
 
     if (!itable)
         return;
@@ -2508,6 +2776,9 @@ inode_table_dump(inode_table_t *itable, char *prefix)
         return;
     }
 
+    __inode_table_lock_shards(itable, &active_size, &lru_size,
+                              &invalidate_size);
+
     gf_proc_dump_build_key(key, prefix, "dentry_hashsize");
     gf_proc_dump_write(key, "%" GF_PRI_SIZET, itable->dentry_hashsize);
     gf_proc_dump_build_key(key, prefix, "inode_hashsize");
@@ -2518,19 +2789,34 @@ inode_table_dump(inode_table_t *itable, char *prefix)
     gf_proc_dump_build_key(key, prefix, "lru_limit");
     gf_proc_dump_write(key, "%d", itable->lru_limit);
     gf_proc_dump_build_key(key, prefix, "active_size");
-    gf_proc_dump_write(key, "%d", itable->active_size);
+    gf_proc_dump_write(key, "%d", active_size);
     gf_proc_dump_build_key(key, prefix, "lru_size");
-    gf_proc_dump_write(key, "%d", itable->lru_size);
+    gf_proc_dump_write(key, "%d", lru_size);
     gf_proc_dump_build_key(key, prefix, "purge_size");
     gf_proc_dump_write(key, "%d", itable->purge_size);
     gf_proc_dump_build_key(key, prefix, "invalidate_size");
-    gf_proc_dump_write(key, "%d", itable->invalidate_size);
+    gf_proc_dump_write(key, "%d", invalidate_size);
+    gf_proc_dump_build_key(key, prefix, "shards");
+    gf_proc_dump_write(key, "%d", GF_INODE_TABLE_SHARDS);
 
-    INODE_DUMP_LIST(&itable->active, key, prefix, "active");
-    INODE_DUMP_LIST(&itable->lru, key, prefix, "lru");
-    INODE_DUMP_LIST(&itable->purge, key, prefix, "purge");
-    INODE_DUMP_LIST(&itable->invalidate, key, prefix, "invalidate");
+    inode_table_for_each_shard(shard, itable)
+    {
+        INODE_DUMP_LIST(&shard->active, key, prefix, "active", i);
+    }
+    i = 1;
+    inode_table_for_each_shard(shard, itable)
+    {
+        INODE_DUMP_LIST(&shard->lru, key, prefix, "lru", i);
+    }
+    i = 1;
+    INODE_DUMP_LIST(&itable->purge, key, prefix, "purge", i);
+    i = 1;
+    inode_table_for_each_shard(shard, itable)
+    {
+        INODE_DUMP_LIST(&shard->invalidate, key, prefix, "invalidate", i);
+    }
 
+    __inode_table_unlock_shards(itable);
     pthread_mutex_unlock(&itable->lock);
 }
 
@@ -2579,8 +2865,12 @@ inode_table_dump_to_dict(inode_table_t *itable, char *prefix, dict_t *dict)
     char key[GF_DUMP_MAX_BUF_LEN] = {
         0,
     };
+    uint32_t active_size = 0;
+    uint32_t lru_size = 0;
+    uint32_t invalidate_size = 0;
     int ret = 0;
 #ifdef DEBUG
+    struct inode_table_shard *shard = NULL;
     inode_t *inode = NULL;
     int count = 0;
 #endif
@@ -2588,18 +2878,21 @@ inode_table_dump_to_dict(inode_table_t *itable, char *prefix, dict_t *dict)
     if (ret)
         return;
 
+    __inode_table_lock_shards(itable, &active_size, &lru_size,
+                              &invalidate_size);
+
     snprintf(key, sizeof(key), "%s.itable.lru_limit", prefix);
     ret = dict_set_uint32(dict, key, itable->lru_limit);
     if (ret)
         goto out;
 
     snprintf(key, sizeof(key), "%s.itable.active_size", prefix);
-    ret = dict_set_uint32(dict, key, itable->active_size);
+    ret = dict_set_uint32(dict, key, active_size);
     if (ret)
         goto out;
 
     snprintf(key, sizeof(key), "%s.itable.lru_size", prefix);
-    ret = dict_set_uint32(dict, key, itable->lru_size);
+    ret = dict_set_uint32(dict, key, lru_size);
     if (ret)
         goto out;
 
@@ -2615,17 +2908,23 @@ inode_table_dump_to_dict(inode_table_t *itable, char *prefix, dict_t *dict)
        If one wants to debug, let them take statedump and debug, this
        wouldn't be available in CLI during production setup.
     */
-    list_for_each_entry(inode, &itable->active, list)
+    inode_table_for_each_shard(shard, itable)
     {
-        snprintf(key, sizeof(key), "%s.itable.active%d", prefix, count++);
-        inode_dump_to_dict(inode, key, dict);
+        list_for_each_entry(inode, &shard->active, list)
+        {
+            snprintf(key, sizeof(key), "%s.itable.active%d", prefix, count++);
+            inode_dump_to_dict(inode, key, dict);
+        }
     }
     count = 0;
 
-    list_for_each_entry(inode, &itable->lru, list)
+    inode_table_for_each_shard(shard, itable)
     {
-        snprintf(key, sizeof(key), "%s.itable.lru%d", prefix, count++);
-        inode_dump_to_dict(inode, key, dict);
+        list_for_each_entry(inode, &shard->lru, list)
+        {
+            snprintf(key, sizeof(key), "%s.itable.lru%d", prefix, count++);
+            inode_dump_to_dict(inode, key, dict);
+        }
     }
     count = 0;
 
@@ -2637,6 +2936,7 @@ inode_table_dump_to_dict(inode_table_t *itable, char *prefix, dict_t *dict)
 #endif
 
 out:
+    __inode_table_unlock_shards(itable);
     pthread_mutex_unlock(&itable->lock);
 
     return;
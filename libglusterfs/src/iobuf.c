@@ -58,6 +58,33 @@ gf_iobuf_get_pagesize(const size_t page_size, int *index)
     return -1;
 }
 
+static void
+__iobuf_arena_notify(struct iobuf_pool *iobuf_pool,
+                     struct iobuf_arena *iobuf_arena, int mapped)
+{
+    struct iobuf_arena_notify *trav = NULL;
+
+    list_for_each_entry(trav, &iobuf_pool->arena_notify, list)
+    {
+        trav->fn(iobuf_arena, mapped, trav->data);
+    }
+}
+
+static int
+__iobuf_arena_slot_get(struct iobuf_pool *iobuf_pool)
+{
+    int i;
+
+    for (i = 0; i < GF_IOBUF_ARENA_SLOTS; i++) {
+        if (!iobuf_pool->slots[i]) {
+            iobuf_pool->slots[i] = 1;
+            return i;
+        }
+    }
+
+    return -1;
+}
+
 static void
 __iobuf_arena_init_iobufs(struct iobuf_arena *iobuf_arena)
 {
@@ -126,6 +153,12 @@ __iobuf_arena_destroy(struct iobuf_pool *iobuf_pool,
 
     __iobuf_arena_destroy_iobufs(iobuf_arena);
 
+    list_del_init(&iobuf_arena->all_list);
+    if (iobuf_arena->slot >= 0) {
+        __iobuf_arena_notify(iobuf_pool, iobuf_arena, 0);
+        iobuf_pool->slots[iobuf_arena->slot] = 0;
+    }
+
     if (iobuf_arena->mem_base && iobuf_arena->mem_base != MAP_FAILED)
         munmap(iobuf_arena->mem_base, iobuf_arena->arena_size);
 
@@ -153,6 +186,7 @@ __iobuf_arena_alloc(struct iobuf_pool *iobuf_pool, size_t page_size,
     INIT_LIST_HEAD(&iobuf_arena->passive_list);
     INIT_LIST_HEAD(&iobuf_arena->active_list);
     iobuf_arena->iobuf_pool = iobuf_pool;
+    iobuf_arena->slot = -1;
 
     rounded_size = gf_iobuf_get_pagesize(page_size, &index);
 
@@ -177,6 +211,10 @@ __iobuf_arena_alloc(struct iobuf_pool *iobuf_pool, size_t page_size,
         goto err;
     }
 
+    iobuf_arena->slot = __iobuf_arena_slot_get(iobuf_pool);
+    if (iobuf_arena->slot >= 0)
+        __iobuf_arena_notify(iobuf_pool, iobuf_arena, 1);
+
     iobuf_pool->arena_cnt++;
 
     return iobuf_arena;
@@ -234,12 +272,21 @@ iobuf_pool_destroy(struct iobuf_pool *iobuf_pool)
 {
     struct iobuf_arena *iobuf_arena = NULL;
     struct iobuf_arena *tmp = NULL;
+    struct iobuf_arena_notify *notify = NULL;
+    struct iobuf_arena_notify *ntmp = NULL;
     int i = 0;
 
     GF_VALIDATE_OR_GOTO("iobuf", iobuf_pool, out);
 
     pthread_mutex_lock(&iobuf_pool->mutex);
     {
+        list_for_each_entry_safe(notify, ntmp, &iobuf_pool->arena_notify,
+                                 list)
+        {
+            list_del_init(&notify->list);
+            GF_FREE(notify);
+        }
+
         for (i = 0; i < IOBUF_ARENA_MAX_INDEX; i++) {
             list_for_each_entry_safe(iobuf_arena, tmp, &iobuf_pool->arenas[i],
                                      list)
@@ -300,6 +347,7 @@ iobuf_create_stdalloc_arena(struct iobuf_pool *iobuf_pool)
     INIT_LIST_HEAD(&iobuf_arena->active_list);
 
     iobuf_arena->iobuf_pool = iobuf_pool;
+    iobuf_arena->slot = -1;
 
     iobuf_arena->page_size = 0x7fffffff;
 
@@ -323,6 +371,7 @@ iobuf_pool_new(void)
     if (!iobuf_pool)
         goto out;
     INIT_LIST_HEAD(&iobuf_pool->all_arenas);
+    INIT_LIST_HEAD(&iobuf_pool->arena_notify);
     pthread_mutex_init(&iobuf_pool->mutex, NULL);
     for (i = 0; i <= IOBUF_ARENA_MAX_INDEX; i++) {
         INIT_LIST_HEAD(&iobuf_pool->arenas[i]);
@@ -604,6 +653,103 @@ post_unlock:
     return iobuf;
 }
 
+/* Same as iobuf_get2(), but small requests are carved out of the arenas
+ * too instead of being served with standard allocation. Used by consumers
+ * which have the arena memory registered with the kernel.
+ */
+struct iobuf *
+iobuf_get_from_arena(struct iobuf_pool *iobuf_pool, size_t page_size)
+{
+    struct iobuf *iobuf = NULL;
+    size_t rounded_size = 0;
+    int index = 0;
+
+    if (page_size == 0) {
+        page_size = iobuf_pool->default_page_size;
+    }
+
+    rounded_size = gf_iobuf_get_pagesize(page_size, &index);
+    if (rounded_size == -1)
+        return iobuf_get2(iobuf_pool, page_size);
+
+    pthread_mutex_lock(&iobuf_pool->mutex);
+    {
+        iobuf = __iobuf_get(iobuf_pool, rounded_size, index);
+        if (iobuf)
+            iobuf_ref(iobuf);
+    }
+    pthread_mutex_unlock(&iobuf_pool->mutex);
+
+    if (!iobuf)
+        gf_smsg(THIS->name, GF_LOG_WARNING, 0, LG_MSG_IOBUF_NOT_FOUND, NULL);
+
+    return iobuf;
+}
+
+/* @fn is called right away for every arena which is currently mapped, and
+ * from then on for every arena mapped or unmapped, until
+ * iobuf_pool_del_arena_notify().
+ */
+int
+iobuf_pool_add_arena_notify(struct iobuf_pool *iobuf_pool,
+                            iobuf_arena_notify_t fn, void *data)
+{
+    struct iobuf_arena_notify *notify = NULL;
+    struct iobuf_arena *trav = NULL;
+
+    GF_VALIDATE_OR_GOTO("iobuf", iobuf_pool, err);
+    GF_VALIDATE_OR_GOTO("iobuf", fn, err);
+
+    notify = GF_CALLOC(1, sizeof(*notify), gf_common_mt_iobuf_arena_notify);
+    if (!notify)
+        goto err;
+
+    INIT_LIST_HEAD(&notify->list);
+    notify->fn = fn;
+    notify->data = data;
+
+    pthread_mutex_lock(&iobuf_pool->mutex);
+    {
+        list_add_tail(&notify->list, &iobuf_pool->arena_notify);
+        list_for_each_entry(trav, &iobuf_pool->all_arenas, all_list)
+        {
+            if (trav->slot >= 0)
+                fn(trav, 1, data);
+        }
+    }
+    pthread_mutex_unlock(&iobuf_pool->mutex);
+
+    return 0;
+err:
+    return -1;
+}
+
+void
+iobuf_pool_del_arena_notify(struct iobuf_pool *iobuf_pool,
+                            iobuf_arena_notify_t fn, void *data)
+{
+    struct iobuf_arena_notify *trav = NULL;
+    struct iobuf_arena_notify *tmp = NULL;
+
+    GF_VALIDATE_OR_GOTO("iobuf", iobuf_pool, out);
+
+    pthread_mutex_lock(&iobuf_pool->mutex);
+    {
+        list_for_each_entry_safe(trav, tmp, &iobuf_pool->arena_notify, list)
+        {
+            if ((trav->fn == fn) && (trav->data == data)) {
+                list_del_init(&trav->list);
+                GF_FREE(trav);
+                break;
+            }
+        }
+    }
+    pthread_mutex_unlock(&iobuf_pool->mutex);
+
+out:
+    return;
+}
+
 struct iobuf *
 iobuf_get_page_aligned(struct iobuf_pool *iobuf_pool, size_t page_size,
                        size_t align_size)
@@ -1028,6 +1174,8 @@ iobuf_arena_info_dump(struct iobuf_arena *iobuf_arena, const char *key_prefix)
     gf_proc_dump_write(key, "%d", iobuf_arena->max_active);
     gf_proc_dump_build_key(key, key_prefix, "page_size");
     gf_proc_dump_write(key, "%" GF_PRI_SIZET, iobuf_arena->page_size);
+    gf_proc_dump_build_key(key, key_prefix, "slot");
+    gf_proc_dump_write(key, "%d", iobuf_arena->slot);
     list_for_each_entry(trav, &iobuf_arena->active_list, list)
     {
         gf_proc_dump_build_key(key, key_prefix, "active_iobuf.%d", i++);
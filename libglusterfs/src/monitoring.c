@@ -104,8 +104,9 @@ static inline void
 dump_call_stack_details(glusterfs_ctx_t *ctx, int fd)
 {
     dprintf(fd, "total.stack.count %" PRIu64 "\n",
-            GF_ATOMIC_GET(ctx->pool->total_count));
-    dprintf(fd, "total.stack.in-flight %" PRIu64 "\n", ctx->pool->cnt);
+            call_pool_total_count(ctx->pool));
+    dprintf(fd, "total.stack.in-flight %" PRIu64 "\n",
+            call_pool_count(ctx->pool));
 }
 
 static inline void
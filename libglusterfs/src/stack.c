@@ -8,10 +8,88 @@
   cases as published by the Free Software Foundation.
 */
 
+#include <urcu/uatomic.h>
+
 #include "glusterfs/statedump.h"
 #include "glusterfs/stack.h"
 #include "glusterfs/libglusterfs-messages.h"
 
+/* Shard of the call pool used by the current thread. Threads are spread
+ * round-robin over the shards the first time they create a stack. */
+static __thread int32_t call_pool_shard_idx = -1;
+static int32_t call_pool_shard_next = 0;
+
+void
+call_pool_init(call_pool_t *pool)
+{
+    struct call_pool_shard *shard = NULL;
+
+    call_pool_for_each_shard(shard, pool)
+    {
+        INIT_LIST_HEAD(&shard->all_frames);
+        shard->cnt = 0;
+        shard->total_count = 0;
+        LOCK_INIT(&shard->lock);
+    }
+}
+
+void
+call_pool_fini(call_pool_t *pool)
+{
+    struct call_pool_shard *shard = NULL;
+
+    call_pool_for_each_shard(shard, pool) { LOCK_DESTROY(&shard->lock); }
+}
+
+/* The per-shard counters are read without taking the shard locks, so the
+ * returned values are only a snapshot when fops are in flight. */
+int64_t
+call_pool_count(call_pool_t *pool)
+{
+    struct call_pool_shard *shard = NULL;
+    int64_t cnt = 0;
+
+    call_pool_for_each_shard(shard, pool) { cnt += uatomic_read(&shard->cnt); }
+
+    return cnt;
+}
+
+uint64_t
+call_pool_total_count(call_pool_t *pool)
+{
+    struct call_pool_shard *shard = NULL;
+    uint64_t total = 0;
+
+    call_pool_for_each_shard(shard, pool)
+    {
+        total += uatomic_read(&shard->total_count);
+    }
+
+    return total;
+}
+
+void
+call_stack_link(call_pool_t *pool, call_stack_t *stack)
+{
+    struct call_pool_shard *shard = NULL;
+
+    if (caa_unlikely(call_pool_shard_idx < 0)) {
+        call_pool_shard_idx = uatomic_add_return(&call_pool_shard_next, 1) &
+                              (GF_CALL_POOL_SHARDS - 1);
+    }
+
+    shard = &pool->shards[call_pool_shard_idx];
+    stack->shard = shard;
+
+    LOCK(&shard->lock);
+    {
+        list_add(&stack->all_frames, &shard->all_frames);
+        shard->cnt++;
+        shard->total_count++;
+    }
+    UNLOCK(&shard->lock);
+}
+
 call_frame_t *
 create_frame(xlator_t *xl, call_pool_t *pool)
 {
@@ -49,14 +127,8 @@ create_frame(xlator_t *xl, call_pool_t *pool)
         memcpy(&frame->begin, &stack->tv, sizeof(stack->tv));
     }
 
-    LOCK(&pool->lock);
-    {
-        list_add(&stack->all_frames, &pool->all_frames);
-        pool->cnt++;
-        stack->unique = unique++;
-    }
-    UNLOCK(&pool->lock);
-    GF_ATOMIC_INC(pool->total_count);
+    stack->unique = uatomic_add_return(&unique, 1) - 1;
+    call_stack_link(pool, stack);
 
     LOCK_INIT(&stack->stack_lock);
 
@@ -210,39 +282,38 @@ gf_proc_dump_call_stack(call_stack_t *call_stack, const char *key_buf, ...)
 void
 gf_proc_dump_pending_frames(call_pool_t *call_pool)
 {
+    struct call_pool_shard *shard = NULL;
     call_stack_t *trav = NULL;
     int i = 1;
     int ret = -1;
-    gf_boolean_t section_added = _gf_false;
 
     if (!call_pool)
         return;
 
-    ret = TRY_LOCK(&(call_pool->lock));
-    if (ret)
-        goto out;
-
     gf_proc_dump_add_section("global.callpool");
-    section_added = _gf_true;
     gf_proc_dump_write("callpool_address", "%p", call_pool);
-    gf_proc_dump_write("callpool.cnt", "%" PRId64, call_pool->cnt);
+    gf_proc_dump_write("callpool.cnt", "%" PRId64, call_pool_count(call_pool));
+    gf_proc_dump_write("callpool.total_count", "%" PRIu64,
+                       call_pool_total_count(call_pool));
 
-    list_for_each_entry(trav, &call_pool->all_frames, all_frames)
+    call_pool_for_each_shard(shard, call_pool)
     {
-        gf_proc_dump_add_section("global.callpool.stack.%d", i);
-        gf_proc_dump_call_stack(trav, "global.callpool.stack.%d", i);
-        i++;
+        ret = TRY_LOCK(&shard->lock);
+        if (ret) {
+            gf_proc_dump_write("Unable to dump the callpool shard",
+                               "(Lock acquisition failed) %p", shard);
+            continue;
+        }
+
+        list_for_each_entry(trav, &shard->all_frames, all_frames)
+        {
+            gf_proc_dump_add_section("global.callpool.stack.%d", i);
+            gf_proc_dump_call_stack(trav, "global.callpool.stack.%d", i);
+            i++;
+        }
+        UNLOCK(&shard->lock);
     }
-    UNLOCK(&(call_pool->lock));
 
-    ret = 0;
-out:
-    if (ret) {
-        if (_gf_false == section_added)
-            gf_proc_dump_add_section("global.callpool");
-        gf_proc_dump_write("Unable to dump the callpool",
-                           "(Lock acquisition failed) %p", call_pool);
-    }
     return;
 }
 
@@ -398,6 +469,7 @@ gf_proc_dump_call_stack_to_dict(call_stack_t *call_stack, char *prefix,
 void
 gf_proc_dump_pending_frames_to_dict(call_pool_t *call_pool, dict_t *dict)
 {
+    struct call_pool_shard *shard = NULL;
     int ret = -1;
     call_stack_t *trav = NULL;
     char key[GF_DUMP_MAX_BUF_LEN] = {
@@ -408,27 +480,29 @@ gf_proc_dump_pending_frames_to_dict(call_pool_t *call_pool, dict_t *dict)
     if (!call_pool || !dict)
         return;
 
-    ret = TRY_LOCK(&call_pool->lock);
-    if (ret) {
-        gf_msg(THIS->name, GF_LOG_WARNING, errno, LG_MSG_LOCK_FAILURE,
-               "Unable to dump call "
-               "pool to dict.");
-        return;
-    }
-
-    ret = dict_set_int32(dict, "callpool.count", call_pool->cnt);
-    if (ret)
-        goto out;
-
-    list_for_each_entry(trav, &call_pool->all_frames, all_frames)
+    call_pool_for_each_shard(shard, call_pool)
     {
-        snprintf(key, sizeof(key), "callpool.stack%d", i);
-        gf_proc_dump_call_stack_to_dict(trav, key, dict);
-        i++;
+        ret = TRY_LOCK(&shard->lock);
+        if (ret) {
+            gf_msg(THIS->name, GF_LOG_WARNING, errno, LG_MSG_LOCK_FAILURE,
+                   "Unable to dump call pool shard to dict.");
+            continue;
+        }
+
+        list_for_each_entry(trav, &shard->all_frames, all_frames)
+        {
+            snprintf(key, sizeof(key), "callpool.stack%d", i);
+            gf_proc_dump_call_stack_to_dict(trav, key, dict);
+            i++;
+        }
+        UNLOCK(&shard->lock);
     }
 
-out:
-    UNLOCK(&call_pool->lock);
+    /* Only the stacks actually dumped are announced, as consumers iterate
+     * callpool.stack0 .. callpool.stack<count - 1>. */
+    ret = dict_set_int32(dict, "callpool.count", i);
+    if (ret)
+        gf_msg_debug(THIS->name, 0, "failed to set callpool.count");
 
     return;
 }
@@ -14,6 +14,7 @@
 #include "glusterfs/statedump.h"
 #include "glusterfs/stack.h"
 #include "glusterfs/syscall.h"
+#include "glusterfs/timer.h"
 
 #ifdef HAVE_MALLOC_H
 #include <malloc.h>
@@ -931,6 +932,8 @@ gf_proc_dump_info(int signum, glusterfs_ctx_t *ctx)
     gf_proc_dump_add_section("dict");
     gf_proc_dump_dict_info(ctx);
 
+    gf_timer_registry_dump(ctx);
+
     if (ctx->root) {
         gf_proc_dump_add_section("fuse");
         gf_proc_dump_single_xlator_info(ctx->root);
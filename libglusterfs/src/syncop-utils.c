@@ -23,6 +23,8 @@ struct syncop_dir_scan_data {
     pthread_mutex_t *mut;
     syncop_dir_scan_fn_t fn;
     uint32_t *jobs_running;
+    syncop_throttle_t *throttle;
+    uint32_t max_jobs;
     uint32_t *qlen;
     int32_t *retval;
 };
@@ -236,6 +238,21 @@ out:
     return ret;
 }
 
+/* The jobs allowed to run now, which the caller may lower during the scan
+ * through the throttle. */
+static uint32_t
+_dir_scan_jobs_limit(uint32_t max_jobs, syncop_throttle_t *throttle)
+{
+    uint32_t limit = 0;
+
+    if (throttle)
+        limit = syncop_throttle_limit(throttle);
+    if (limit && (limit < max_jobs))
+        return limit;
+
+    return max_jobs;
+}
+
 static void
 _scan_data_destroy(struct syncop_dir_scan_data *data)
 {
@@ -269,7 +286,11 @@ _dir_scan_job_fn(void *data)
         {
             if (ret)
                 *scan_data->retval |= ret;
-            if (list_empty(&scan_data->q->list)) {
+            /* a job too many retires, the others drain the queue */
+            if (list_empty(&scan_data->q->list) ||
+                (*scan_data->jobs_running >
+                 _dir_scan_jobs_limit(scan_data->max_jobs,
+                                      scan_data->throttle))) {
                 (*scan_data->jobs_running)--;
                 pthread_cond_broadcast(scan_data->cond);
             } else {
@@ -289,7 +310,8 @@ static int
 _run_dir_scan_task(call_frame_t *frame, xlator_t *subvol, loc_t *parent,
                    gf_dirent_t *q, gf_dirent_t *entry, int *retval,
                    pthread_mutex_t *mut, pthread_cond_t *cond,
-                   uint32_t *jobs_running, uint32_t *qlen,
+                   uint32_t *jobs_running, uint32_t max_jobs,
+                   syncop_throttle_t *throttle, uint32_t *qlen,
                    syncop_dir_scan_fn_t fn, void *data)
 {
     int ret = 0;
@@ -309,6 +331,8 @@ _run_dir_scan_task(call_frame_t *frame, xlator_t *subvol, loc_t *parent,
     scan_data->cond = cond;
     scan_data->fn = fn;
     scan_data->jobs_running = jobs_running;
+    scan_data->max_jobs = max_jobs;
+    scan_data->throttle = throttle;
     scan_data->entry = entry;
     scan_data->q = q;
     scan_data->qlen = qlen;
@@ -330,10 +354,14 @@ out:
     return ret;
 }
 
+/* Runs fn on the entries of the directory from up to max_jobs synctasks, or
+ * fewer if throttle is not NULL and allows less, which may change while the
+ * scan goes on. */
 int
 syncop_mt_dir_scan(call_frame_t *frame, xlator_t *subvol, loc_t *loc, int pid,
                    void *data, syncop_dir_scan_fn_t fn, dict_t *xdata,
-                   uint32_t max_jobs, uint32_t max_qlen)
+                   uint32_t max_jobs, syncop_throttle_t *throttle,
+                   uint32_t max_qlen)
 {
     fd_t *fd = NULL;
     uint64_t offset = 0;
@@ -417,7 +445,8 @@ syncop_mt_dir_scan(call_frame_t *frame, xlator_t *subvol, loc_t *loc, int pid,
             {
                 while (qlen == max_qlen)
                     pthread_cond_wait(&cond, &mut);
-                if (max_jobs == jobs_running) {
+                if (jobs_running >=
+                    _dir_scan_jobs_limit(max_jobs, throttle)) {
                     list_add_tail(&entry->list, &q.list);
                     qlen++;
                     entry = NULL;
@@ -431,8 +460,8 @@ syncop_mt_dir_scan(call_frame_t *frame, xlator_t *subvol, loc_t *loc, int pid,
                 continue;
 
             ret = _run_dir_scan_task(frame, subvol, loc, &q, entry, &retval,
-                                     &mut, &cond, &jobs_running, &qlen, fn,
-                                     data);
+                                     &mut, &cond, &jobs_running, max_jobs,
+                                     throttle, &qlen, fn, data);
             if (ret)
                 goto out;
         }
@@ -455,6 +484,124 @@ out:
     return ret | retval;
 }
 
+void
+syncop_throttle_init(syncop_throttle_t *throttle, uint32_t target_usec,
+                     uint32_t max_jobs)
+{
+    pthread_mutex_init(&throttle->lock, NULL);
+    throttle->limit = max_jobs;
+    throttle->target = target_usec;
+    GF_ATOMIC_INIT(throttle->stamp, gf_time());
+    GF_ATOMIC_INIT(throttle->done, 0);
+    throttle->done_then = 0;
+    throttle->elapsed = SYNCOP_THROTTLE_INTERVAL;
+    throttle->latency = 0;
+    throttle->rate = 0;
+    throttle->backoffs = 0;
+}
+
+/* Sets the target of a new crawl, which runs all the jobs allowed while
+ * there is none. */
+void
+syncop_throttle_reset(syncop_throttle_t *throttle, uint32_t target_usec,
+                      uint32_t max_jobs)
+{
+    pthread_mutex_lock(&throttle->lock);
+    {
+        throttle->target = target_usec;
+        if (!target_usec)
+            throttle->limit = max_jobs;
+    }
+    pthread_mutex_unlock(&throttle->lock);
+}
+
+uint32_t
+syncop_throttle_limit(syncop_throttle_t *throttle)
+{
+    uint32_t limit = 0;
+
+    pthread_mutex_lock(&throttle->lock);
+    {
+        limit = throttle->limit;
+    }
+    pthread_mutex_unlock(&throttle->lock);
+
+    return limit;
+}
+
+/* Tells the one job that should adjust the throttle now, if any. */
+gf_boolean_t
+syncop_throttle_due(syncop_throttle_t *throttle)
+{
+    int64_t then = GF_ATOMIC_GET(throttle->stamp);
+    time_t now = gf_time();
+
+    if (now - then < SYNCOP_THROTTLE_INTERVAL)
+        return _gf_false;
+
+    if (!GF_ATOMIC_CMP_SWAP(throttle->stamp, then, now))
+        return _gf_false;
+
+    throttle->elapsed = now - then;
+    return _gf_true;
+}
+
+/* Halves the jobs allowed while the clients wait longer than the target, and
+ * gives one back per interval while they do not. Clients gone idle give all
+ * of them back at once. */
+void
+syncop_throttle_adjust(syncop_throttle_t *throttle, uint64_t latency,
+                       uint32_t max_jobs)
+{
+    uint64_t done = GF_ATOMIC_GET(throttle->done);
+
+    pthread_mutex_lock(&throttle->lock);
+    {
+        throttle->rate = (done - throttle->done_then) * 60 / throttle->elapsed;
+        throttle->done_then = done;
+        throttle->latency = latency;
+
+        if (!throttle->target || !latency) {
+            throttle->limit = max_jobs;
+        } else if (latency > throttle->target) {
+            throttle->limit = max(throttle->limit / 2, 1);
+            throttle->backoffs++;
+        } else if (throttle->limit < max_jobs) {
+            throttle->limit++;
+        }
+
+        if (throttle->limit > max_jobs)
+            throttle->limit = max_jobs;
+    }
+    pthread_mutex_unlock(&throttle->lock);
+}
+
+/* Asks the io-threads of a brick how long the fops of the clients take, 0
+ * when they leave it idle. */
+int
+syncop_subvol_load(xlator_t *subvol, uint64_t *latency)
+{
+    loc_t loc = {
+        0,
+    };
+    dict_t *xattr = NULL;
+    int ret = 0;
+
+    loc.path = "/";
+    loc.gfid[15] = 1;
+
+    ret = syncop_getxattr(subvol, &loc, &xattr, IO_THREADS_LOAD_KEY, NULL,
+                          NULL);
+    if (ret < 0)
+        goto out;
+
+    ret = dict_get_uint64(xattr, IO_THREADS_LOAD_KEY, latency);
+out:
+    if (xattr)
+        dict_unref(xattr);
+    return ret;
+}
+
 int
 syncop_dir_scan(xlator_t *subvol, loc_t *loc, int pid, void *data,
                 int (*fn)(xlator_t *subvol, gf_dirent_t *entry, loc_t *parent,
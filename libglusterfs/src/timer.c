@@ -14,19 +14,138 @@
 #include "glusterfs/globals.h"
 #include "glusterfs/timespec.h"
 #include "glusterfs/libglusterfs-messages.h"
+#include "glusterfs/statedump.h"
 
 /* fwd decl */
 static gf_timer_registry_t *
 gf_timer_registry_init(glusterfs_ctx_t *);
 
+#define GF_TIMER_WHEEL_SHIFT(level)                                            \
+    (GF_TIMER_WHEEL_ROOT_BITS + (level)*GF_TIMER_WHEEL_LEVEL_BITS)
+
+static uint64_t
+gf_timer_ts_to_tick(struct timespec *ts)
+{
+    return (TS((*ts)) + GF_TIMER_TICK_NS - 1) / GF_TIMER_TICK_NS;
+}
+
+/* to be called with reg->lock held */
+static void
+__gf_timer_wheel_add(gf_timer_registry_t *reg, gf_timer_t *event)
+{
+    struct list_head *vec = NULL;
+    uint64_t expires = event->expires;
+    uint64_t idx = 0;
+    uint32_t slot = 0;
+    int level = 0;
+
+    /* Already due: fire it on the next tick processed. */
+    if (expires < reg->tick)
+        expires = reg->tick;
+
+    idx = expires - reg->tick;
+    if (idx < GF_TIMER_WHEEL_ROOT_SIZE) {
+        slot = expires & GF_TIMER_WHEEL_ROOT_MASK;
+        reg->root_map[slot / 64] |= (1ULL << (slot % 64));
+        vec = &reg->root[slot];
+    } else {
+        while ((level < GF_TIMER_WHEEL_LEVELS - 1) &&
+               (idx >= (1ULL << GF_TIMER_WHEEL_SHIFT(level + 1))))
+            level++;
+
+        /* Farther than the outermost wheel can reach: park the timer in
+         * its last slot. It is re-queued, not fired, once it cascades down
+         * since event->expires is kept untouched. */
+        if (idx >= (1ULL << GF_TIMER_WHEEL_SHIFT(GF_TIMER_WHEEL_LEVELS)))
+            expires = reg->tick +
+                      (1ULL << GF_TIMER_WHEEL_SHIFT(GF_TIMER_WHEEL_LEVELS)) -
+                      1;
+
+        slot = (expires >> GF_TIMER_WHEEL_SHIFT(level)) &
+               GF_TIMER_WHEEL_LEVEL_MASK;
+        vec = &reg->levels[level][slot];
+    }
+
+    list_add_tail(&event->list, vec);
+}
+
+/* Moves every timer of the current slot of the given outer wheel one level
+ * inwards. Returns the slot index, so that the caller continues with the
+ * next outer wheel only when this one has wrapped around. */
+static uint32_t
+__gf_timer_wheel_cascade(gf_timer_registry_t *reg, int level)
+{
+    struct list_head queue;
+    gf_timer_t *event = NULL;
+    gf_timer_t *tmp = NULL;
+    uint32_t slot = 0;
+
+    INIT_LIST_HEAD(&queue);
+
+    slot = (reg->tick >> GF_TIMER_WHEEL_SHIFT(level)) &
+           GF_TIMER_WHEEL_LEVEL_MASK;
+    list_append_init(&reg->levels[level][slot], &queue);
+
+    list_for_each_entry_safe(event, tmp, &queue, list)
+    {
+        list_del_init(&event->list);
+        __gf_timer_wheel_add(reg, event);
+        reg->cascaded++;
+    }
+
+    return slot;
+}
+
+/* Returns the first tick, starting at reg->tick, that may have work to do:
+ * either a non-empty root slot or the next wrap of the root wheel, where
+ * outer wheels need to be cascaded. */
+static uint64_t
+__gf_timer_wheel_next(gf_timer_registry_t *reg)
+{
+    uint32_t slot = reg->tick & GF_TIMER_WHEEL_ROOT_MASK;
+    uint32_t word = slot / 64;
+    uint64_t bits = reg->root_map[word] & (~0ULL << (slot % 64));
+
+    /* Slot 0 is always processed, it is where cascading happens. */
+    if (slot == 0)
+        return reg->tick;
+
+    for (;;) {
+        if (bits)
+            return reg->tick + (word * 64 + __builtin_ctzll(bits)) - slot;
+        if (++word == GF_TIMER_WHEEL_ROOT_SIZE / 64)
+            break;
+        bits = reg->root_map[word];
+    }
+
+    return (reg->tick | GF_TIMER_WHEEL_ROOT_MASK) + 1;
+}
+
+/* Collects the timers due at reg->tick into @expired and advances the wheel
+ * by one tick. */
+static void
+__gf_timer_wheel_expire(gf_timer_registry_t *reg, struct list_head *expired)
+{
+    uint32_t slot = reg->tick & GF_TIMER_WHEEL_ROOT_MASK;
+    int level = 0;
+
+    if (slot == 0) {
+        while ((level < GF_TIMER_WHEEL_LEVELS) &&
+               (__gf_timer_wheel_cascade(reg, level) == 0))
+            level++;
+    }
+
+    list_append_init(&reg->root[slot], expired);
+    reg->root_map[slot / 64] &= ~(1ULL << (slot % 64));
+    reg->tick++;
+}
+
 gf_timer_t *
 gf_timer_call_after(glusterfs_ctx_t *ctx, struct timespec delta,
                     gf_timer_cbk_t callbk, void *data)
 {
     gf_timer_registry_t *reg = NULL;
     gf_timer_t *event = NULL;
-    gf_timer_t *trav = NULL;
-    uint64_t at = 0;
 
     if ((ctx == NULL) || (ctx->cleanup_started)) {
         gf_msg_callingfn("timer", GF_LOG_ERROR, EINVAL, LG_MSG_INVALID_ARG,
@@ -49,19 +168,17 @@ gf_timer_call_after(glusterfs_ctx_t *ctx, struct timespec delta,
     }
     timespec_now(&event->at);
     timespec_adjust_delta(&event->at, delta);
-    at = TS(event->at);
+    event->expires = gf_timer_ts_to_tick(&event->at);
     event->callbk = callbk;
     event->data = data;
     event->xl = THIS;
     pthread_mutex_lock(&reg->lock);
     {
-        list_for_each_entry_reverse(trav, &reg->active, list)
-        {
-            if (TS(trav->at) < at)
-                break;
-        }
-        list_add(&event->list, &trav->list);
-        if (&trav->list == &reg->active) {
+        __gf_timer_wheel_add(reg, event);
+        reg->pending++;
+        reg->armed++;
+        /* Only wake the timer thread if it sleeps past this timer. */
+        if (event->expires < reg->next_wakeup) {
             pthread_cond_signal(&reg->cond);
         }
     }
@@ -107,6 +224,8 @@ gf_timer_call_cancel(glusterfs_ctx_t *ctx, gf_timer_t *event)
         if (fired)
             goto unlock;
         list_del(&event->list);
+        reg->pending--;
+        reg->cancelled++;
     }
 unlock:
     pthread_mutex_unlock(&reg->lock);
@@ -118,64 +237,118 @@ unlock:
     return -1;
 }
 
+static void
+__gf_timer_wheel_purge(struct list_head *vec)
+{
+    gf_timer_t *event = NULL;
+    gf_timer_t *tmp = NULL;
+
+    list_for_each_entry_safe(event, tmp, vec, list)
+    {
+        list_del(&event->list);
+        /* TODO Possible resource leak
+         * Before freeing the event, we need to call the respective
+         * event functions and free any resources.
+         * For example, In case of rpc_clnt_reconnect, we need to
+         * unref rpc object which was taken when added to timer
+         * wheel.
+         */
+        GF_FREE(event);
+    }
+}
+
 static void *
 gf_timer_proc(void *data)
 {
     gf_timer_registry_t *reg = data;
     gf_timer_t *event = NULL;
-    gf_timer_t *tmp = NULL;
     xlator_t *old_THIS = NULL;
+    struct list_head expired;
+    struct timespec now;
+    struct timespec wakeup;
+    uint64_t now_tick = 0;
+    uint64_t next = 0;
+    uint64_t delay = 0;
+    int i = 0;
+    int j = 0;
+
+    INIT_LIST_HEAD(&expired);
 
     pthread_mutex_lock(&reg->lock);
 
     while (!reg->fin) {
-        if (list_empty(&reg->active)) {
+        timespec_now(&now);
+        now_tick = TS(now) / GF_TIMER_TICK_NS;
+
+        if (reg->pending == 0) {
+            /* Nothing armed, all slots are empty: catch up for free. */
+            reg->tick = now_tick;
+            reg->next_wakeup = UINT64_MAX;
             pthread_cond_wait(&reg->cond, &reg->lock);
-        } else {
-            struct timespec now;
-
-            timespec_now(&now);
-            event = list_first_entry(&reg->active, gf_timer_t, list);
-            if (TS(now) < TS(event->at)) {
-                now = event->at;
-                pthread_cond_timedwait(&reg->cond, &reg->lock, &now);
-            } else {
-                event->fired = _gf_true;
-                list_del_init(&event->list);
-
-                pthread_mutex_unlock(&reg->lock);
-
-                old_THIS = NULL;
-                if (event->xl) {
-                    old_THIS = THIS;
-                    THIS = event->xl;
-                }
-                event->callbk(event->data);
-                GF_FREE(event);
-                if (old_THIS) {
-                    THIS = old_THIS;
-                }
-
-                pthread_mutex_lock(&reg->lock);
+            reg->next_wakeup = 0;
+            continue;
+        }
+
+        next = __gf_timer_wheel_next(reg);
+        if (next > now_tick) {
+            reg->next_wakeup = next;
+            wakeup.tv_sec = (next * GF_TIMER_TICK_NS) / GIGA;
+            wakeup.tv_nsec = (next * GF_TIMER_TICK_NS) % GIGA;
+            pthread_cond_timedwait(&reg->cond, &reg->lock, &wakeup);
+            reg->next_wakeup = 0;
+            continue;
+        }
+
+        /* Ticks between reg->tick and next have nothing to process. */
+        reg->tick = next;
+        __gf_timer_wheel_expire(reg, &expired);
+
+        while (!list_empty(&expired)) {
+            event = list_first_entry(&expired, gf_timer_t, list);
+            list_del_init(&event->list);
+
+            if (event->expires > now_tick) {
+                /* parked in the outermost wheel, not due yet */
+                __gf_timer_wheel_add(reg, event);
+                continue;
+            }
+
+            event->fired = _gf_true;
+            reg->pending--;
+            reg->fired++;
+            if (TS(now) > TS(event->at)) {
+                delay = TS(now) - TS(event->at);
+                reg->delay_total += delay;
+                if (delay > reg->delay_max)
+                    reg->delay_max = delay;
+            }
+
+            pthread_mutex_unlock(&reg->lock);
+
+            old_THIS = NULL;
+            if (event->xl) {
+                old_THIS = THIS;
+                THIS = event->xl;
             }
+            event->callbk(event->data);
+            GF_FREE(event);
+            if (old_THIS) {
+                THIS = old_THIS;
+            }
+
+            pthread_mutex_lock(&reg->lock);
         }
     }
 
     /* Do not call gf_timer_call_cancel(),
      * it will lead to deadlock
      */
-    list_for_each_entry_safe(event, tmp, &reg->active, list)
-    {
-        list_del(&event->list);
-        /* TODO Possible resource leak
-         * Before freeing the event, we need to call the respective
-         * event functions and free any resources.
-         * For example, In case of rpc_clnt_reconnect, we need to
-         * unref rpc object which was taken when added to timer
-         * wheel.
-         */
-        GF_FREE(event);
-    }
+    for (i = 0; i < GF_TIMER_WHEEL_ROOT_SIZE; i++)
+        __gf_timer_wheel_purge(&reg->root[i]);
+    for (i = 0; i < GF_TIMER_WHEEL_LEVELS; i++)
+        for (j = 0; j < GF_TIMER_WHEEL_LEVEL_SIZE; j++)
+            __gf_timer_wheel_purge(&reg->levels[i][j]);
+    reg->pending = 0;
 
     pthread_mutex_unlock(&reg->lock);
 
@@ -186,7 +359,10 @@ static gf_timer_registry_t *
 gf_timer_registry_init(glusterfs_ctx_t *ctx)
 {
     gf_timer_registry_t *reg = NULL;
+    struct timespec now;
     int ret = -1;
+    int i = 0;
+    int j = 0;
     pthread_condattr_t attr;
 
     LOCK(&ctx->lock);
@@ -206,7 +382,14 @@ gf_timer_registry_init(glusterfs_ctx_t *ctx)
         pthread_condattr_init(&attr);
         pthread_condattr_setclock(&attr, CLOCK_MONOTONIC);
         pthread_cond_init(&reg->cond, &attr);
-        INIT_LIST_HEAD(&reg->active);
+        for (i = 0; i < GF_TIMER_WHEEL_ROOT_SIZE; i++)
+            INIT_LIST_HEAD(&reg->root[i]);
+        for (i = 0; i < GF_TIMER_WHEEL_LEVELS; i++)
+            for (j = 0; j < GF_TIMER_WHEEL_LEVEL_SIZE; j++)
+                INIT_LIST_HEAD(&reg->levels[i][j]);
+        timespec_now(&now);
+        reg->tick = TS(now) / GF_TIMER_TICK_NS;
+        reg->next_wakeup = 0;
     }
     UNLOCK(&ctx->lock);
     ret = gf_thread_create(&reg->th, NULL, gf_timer_proc, reg, "timer");
@@ -254,3 +437,41 @@ gf_timer_registry_destroy(glusterfs_ctx_t *ctx)
 
     GF_FREE(reg);
 }
+
+void
+gf_timer_registry_dump(glusterfs_ctx_t *ctx)
+{
+    gf_timer_registry_t *reg = NULL;
+
+    if (ctx == NULL)
+        return;
+
+    LOCK(&ctx->lock);
+    {
+        reg = ctx->timer;
+    }
+    UNLOCK(&ctx->lock);
+
+    if (!reg)
+        return;
+
+    gf_proc_dump_add_section("timer");
+
+    if (pthread_mutex_trylock(&reg->lock)) {
+        gf_proc_dump_write("Unable to dump the timer registry",
+                           "(Lock acquisition failed) %p", reg);
+        return;
+    }
+    {
+        gf_proc_dump_write("tick_ns", "%llu", GF_TIMER_TICK_NS);
+        gf_proc_dump_write("pending", "%" PRIu64, reg->pending);
+        gf_proc_dump_write("armed", "%" PRIu64, reg->armed);
+        gf_proc_dump_write("fired", "%" PRIu64, reg->fired);
+        gf_proc_dump_write("cancelled", "%" PRIu64, reg->cancelled);
+        gf_proc_dump_write("cascaded", "%" PRIu64, reg->cascaded);
+        gf_proc_dump_write("fire_delay_avg_ns", "%" PRIu64,
+                           reg->fired ? reg->delay_total / reg->fired : 0);
+        gf_proc_dump_write("fire_delay_max_ns", "%" PRIu64, reg->delay_max);
+    }
+    pthread_mutex_unlock(&reg->lock);
+}
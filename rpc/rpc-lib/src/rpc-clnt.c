@@ -19,6 +19,7 @@
 #include <glusterfs/mem-pool.h>
 #include "xdr-rpc.h"
 #include "rpc-common-xdr.h"
+#include <glusterfs/statedump.h>
 
 void
 rpc_clnt_reply_deinit(struct rpc_req *req, struct mem_pool *pool);
@@ -34,6 +35,7 @@ __saved_frames_get_timedout(struct saved_frames *frames, uint32_t timeout,
         if ((tmp->saved_at.tv_sec + timeout) <= current->tv_sec) {
             bailout_frame = tmp;
             list_del_init(&bailout_frame->list);
+            list_del_init(&bailout_frame->hash);
             frames->count--;
         }
     }
@@ -68,6 +70,7 @@ __saved_frames_put(struct saved_frames *frames, void *frame,
     /* THIS should be saved and set back */
 
     INIT_LIST_HEAD(&saved_frame->list);
+    INIT_LIST_HEAD(&saved_frame->hash);
 
     saved_frame->capital_this = THIS;
     saved_frame->frame = frame;
@@ -80,6 +83,9 @@ __saved_frames_put(struct saved_frames *frames, void *frame,
     else
         list_add_tail(&saved_frame->list, &frames->sf.list);
 
+    list_add_tail(&saved_frame->hash,
+                  &frames->hash[RPC_CLNT_SAVED_FRAMES_HASH(rpcreq->xid)]);
+
     frames->count++;
 
 out:
@@ -229,6 +235,7 @@ struct saved_frames *
 saved_frames_new(void)
 {
     struct saved_frames *saved_frames = NULL;
+    int i = 0;
 
     saved_frames = GF_CALLOC(1, sizeof(*saved_frames),
                              gf_common_mt_rpcclnt_savedframe_t);
@@ -238,10 +245,39 @@ saved_frames_new(void)
 
     INIT_LIST_HEAD(&saved_frames->sf.list);
     INIT_LIST_HEAD(&saved_frames->lk_sf.list);
+    for (i = 0; i < RPC_CLNT_SAVED_FRAMES_HASH_SIZE; i++)
+        INIT_LIST_HEAD(&saved_frames->hash[i]);
 
     return saved_frames;
 }
 
+/* to be called with conn->lock held */
+static struct saved_frame *
+__saved_frame_lookup(struct saved_frames *frames, int64_t callid)
+{
+    struct saved_frame *tmp = NULL;
+    struct list_head *bucket = NULL;
+    uint64_t depth = 0;
+
+    bucket = &frames->hash[RPC_CLNT_SAVED_FRAMES_HASH(callid)];
+
+    list_for_each_entry(tmp, bucket, hash)
+    {
+        depth++;
+        if (tmp->rpcreq->xid == callid)
+            goto out;
+    }
+
+    tmp = NULL;
+out:
+    frames->lookups++;
+    frames->lookup_depth += depth;
+    if (depth > frames->lookup_max_depth)
+        frames->lookup_max_depth = depth;
+
+    return tmp;
+}
+
 int
 __saved_frame_copy(struct saved_frames *frames, int64_t callid,
                    struct saved_frame *saved_frame)
@@ -254,22 +290,10 @@ __saved_frame_copy(struct saved_frames *frames, int64_t callid,
         goto out;
     }
 
-    list_for_each_entry(tmp, &frames->sf.list, list)
-    {
-        if (tmp->rpcreq->xid == callid) {
-            *saved_frame = *tmp;
-            ret = 0;
-            goto out;
-        }
-    }
-
-    list_for_each_entry(tmp, &frames->lk_sf.list, list)
-    {
-        if (tmp->rpcreq->xid == callid) {
-            *saved_frame = *tmp;
-            ret = 0;
-            goto out;
-        }
+    tmp = __saved_frame_lookup(frames, callid);
+    if (tmp) {
+        *saved_frame = *tmp;
+        ret = 0;
     }
 
 out:
@@ -280,30 +304,12 @@ struct saved_frame *
 __saved_frame_get(struct saved_frames *frames, int64_t callid)
 {
     struct saved_frame *saved_frame = NULL;
-    struct saved_frame *tmp = NULL;
-
-    list_for_each_entry(tmp, &frames->sf.list, list)
-    {
-        if (tmp->rpcreq->xid == callid) {
-            list_del_init(&tmp->list);
-            frames->count--;
-            saved_frame = tmp;
-            goto out;
-        }
-    }
-
-    list_for_each_entry(tmp, &frames->lk_sf.list, list)
-    {
-        if (tmp->rpcreq->xid == callid) {
-            list_del_init(&tmp->list);
-            frames->count--;
-            saved_frame = tmp;
-            goto out;
-        }
-    }
 
-out:
+    saved_frame = __saved_frame_lookup(frames, callid);
     if (saved_frame) {
+        list_del_init(&saved_frame->list);
+        list_del_init(&saved_frame->hash);
+        frames->count--;
         THIS = saved_frame->capital_this;
     }
 
@@ -346,6 +352,7 @@ saved_frames_unwind(struct saved_frames *saved_frames)
                               trav->rpcreq->conn->rpc_clnt->reqpool);
 
         list_del_init(&trav->list);
+        list_del_init(&trav->hash);
         mem_put(trav);
     }
 }
@@ -1189,6 +1196,38 @@ rpc_clnt_cleanup_and_start(struct rpc_clnt *rpc)
     return 0;
 }
 
+/* Dumps the state of the outstanding-call table. Must be called from a
+ * statedump context; the connection lock is only tried so that a stuck
+ * connection cannot block the dump. */
+void
+rpc_clnt_saved_frames_dump(struct rpc_clnt *rpc)
+{
+    rpc_clnt_connection_t *conn = NULL;
+    struct saved_frames *frames = NULL;
+
+    if (!rpc)
+        return;
+
+    conn = &rpc->conn;
+
+    if (pthread_mutex_trylock(&conn->lock))
+        return;
+    {
+        frames = conn->saved_frames;
+        if (frames) {
+            gf_proc_dump_write("saved_frames", "%" PRId64, frames->count);
+            gf_proc_dump_write("saved_frames_hash_size", "%d",
+                               RPC_CLNT_SAVED_FRAMES_HASH_SIZE);
+            gf_proc_dump_write("xid_lookups", "%" PRIu64, frames->lookups);
+            gf_proc_dump_write("xid_lookup_depth", "%" PRIu64,
+                               frames->lookup_depth);
+            gf_proc_dump_write("xid_lookup_max_depth", "%" PRIu64,
+                               frames->lookup_max_depth);
+        }
+    }
+    pthread_mutex_unlock(&conn->lock);
+}
+
 int
 rpc_clnt_register_notify(struct rpc_clnt *rpc, rpc_clnt_notify_t fn,
                          void *mydata)
@@ -29,6 +29,13 @@ typedef enum {
 #define SFRAME_GET_PROGVER(sframe) (sframe->rpcreq->prog->progver)
 #define SFRAME_GET_PROCNUM(sframe) (sframe->rpcreq->procnum)
 
+/* Number of buckets in the xid-indexed table of outstanding calls. xids are
+ * allocated sequentially per rpc_clnt, so masking the low bits spreads the
+ * in-flight requests evenly. Must be a power of 2. */
+#define RPC_CLNT_SAVED_FRAMES_HASH_SIZE 512
+#define RPC_CLNT_SAVED_FRAMES_HASH(xid)                                        \
+    ((xid) & (RPC_CLNT_SAVED_FRAMES_HASH_SIZE - 1))
+
 struct rpc_req;
 struct rpc_clnt;
 struct rpc_clnt_config;
@@ -50,6 +57,7 @@ struct saved_frame {
             struct saved_frame *frame_prev;
         };
     };
+    struct list_head hash; /* link in saved_frames->hash[] */
     void *capital_this;
     void *frame;
     struct rpc_req *rpcreq;
@@ -61,6 +69,11 @@ struct saved_frames {
     int64_t count;
     struct saved_frame sf;
     struct saved_frame lk_sf;
+    /* reply lookup statistics, reset along with the frames table */
+    uint64_t lookups;
+    uint64_t lookup_depth;
+    uint64_t lookup_max_depth;
+    struct list_head hash[RPC_CLNT_SAVED_FRAMES_HASH_SIZE];
 };
 
 /* Initialized by procnum */
@@ -195,6 +208,9 @@ rpc_clnt_new(dict_t *options, xlator_t *owner, char *name,
 int
 rpc_clnt_start(struct rpc_clnt *rpc);
 
+void
+rpc_clnt_saved_frames_dump(struct rpc_clnt *rpc);
+
 int
 rpc_clnt_cleanup_and_start(struct rpc_clnt *rpc);
 
@@ -32,6 +32,9 @@
 #include <errno.h>
 #include <rpc/xdr.h>
 #include <sys/ioctl.h>
+#ifdef HAVE_LIBURING_BUF_RING
+#include <liburing.h>
+#endif
 #define GF_LOG_ERRNO(errno) ((errno == ENOTCONN) ? GF_LOG_DEBUG : GF_LOG_ERROR)
 #define SA(ptr) ((struct sockaddr *)ptr)
 
@@ -45,6 +48,7 @@
 #define SSL_EC_CURVE_OPT "transport.socket.ssl-ec-curve"
 #define SSL_CRL_PATH_OPT "transport.socket.ssl-crl-path"
 #define OWN_THREAD_OPT "transport.socket.own-thread"
+#define IO_URING_OPT "transport.socket.io-uring"
 
 #if !defined(DEFAULT_CERT_PATH)
 #define DEFAULT_CERT_PATH SSL_CERT_PATH "/glusterfs.pem"
@@ -168,6 +172,11 @@ static int
 socket_init(rpc_transport_t *this);
 static int
 __socket_nonblock(int fd);
+static ssize_t
+__socket_uring_readv(rpc_transport_t *this, struct iovec *opvector,
+                     int opcount);
+static void
+__socket_uring_reset(rpc_transport_t *this);
 
 static void
 socket_dump_info(struct sockaddr *sa, int is_server, int is_ssl, int sock,
@@ -549,6 +558,8 @@ __socket_ssl_readv(rpc_transport_t *this, struct iovec *opvector, int opcount)
     if (priv->use_ssl) {
         gf_log(this->name, GF_LOG_TRACE, "***** reading over SSL");
         ret = ssl_read_one(this, opvector->iov_base, opvector->iov_len);
+    } else if (priv->uring.active) {
+        ret = __socket_uring_readv(this, opvector, opcount);
     } else {
         gf_log(this->name, GF_LOG_TRACE, "***** reading over non-SSL");
         ret = sys_readv(sock, opvector, IOV_MIN(opcount));
@@ -1154,6 +1165,8 @@ __socket_reset(rpc_transport_t *this)
 
     memset(&priv->incoming, 0, sizeof(priv->incoming));
 
+    __socket_uring_reset(this);
+
     gf_event_unregister_close(this->ctx->event_pool, priv->sock, priv->idx);
     if (priv->use_ssl && priv->ssl_ssl) {
         SSL_clear(priv->ssl_ssl);
@@ -2552,248 +2565,1449 @@ socket_event_poll_in(rpc_transport_t *this, gf_boolean_t notify_handled)
     return ret;
 }
 
-static int
-socket_connect_finish(rpc_transport_t *this)
-{
-    int ret = -1;
-    socket_private_t *priv = NULL;
-    rpc_transport_event_t event = 0;
-    char notify_rpc = 0;
+#ifdef HAVE_LIBURING_BUF_RING
+
+/* io_uring mode
+ *
+ * When transport.socket.io-uring is enabled, a connected non-SSL socket is
+ * taken off the epoll read/write interest set and driven from a ring shared
+ * by all the connections of its glusterfs context:
+ *
+ *  - a single multishot receive is kept armed per connection. The kernel
+ *    picks buffers from a ring of iobufs provided under GF_SOCKET_URING_BGID,
+ *    and every completion is appended to the receive queue of the connection.
+ *    The RPC state machine then consumes that queue instead of calling
+ *    readv(), so a burst of small requests costs no syscall at all.
+ *
+ *  - outgoing messages are queued on the ioq as usual, but only one sendmsg
+ *    is in flight per connection. Everything queued while it runs is
+ *    coalesced into the next one, so replies generated concurrently by
+ *    several threads leave in a single submission.
+ *
+ * Epoll is still used to detect errors while the receive is paused because
+ * of throttling or lack of buffers.
+ *
+ * The ring and its buffers belong to the context, several gfapi instances in
+ * one process neither share nor outlive each other's. It's created by the
+ * first connection that switches to io_uring and destroyed with the last
+ * transport using it. If the ring fails, its connections are torn down and
+ * reconnect through epoll. */
+
+struct socket_uring_buf {
+    struct iobuf *iobuf;
+    uint32_t len; /* bytes received into the buffer */
+    uint32_t off; /* bytes already consumed */
+    int32_t next; /* next buffer in the owner's receive queue */
+};
 
-    priv = this->private;
+struct socket_uring {
+    struct list_head list; /* in socket_urings */
+    glusterfs_ctx_t *ctx;
+    struct io_uring ring;
+    pthread_mutex_t lock;     /* transports and state of the ring */
+    pthread_cond_t cond;      /* the ring thread waits for its end */
+    pthread_mutex_t sq_lock;  /* submission queue */
+    pthread_mutex_t buf_lock; /* provided buffer ring */
+    pthread_t thread;
+    struct io_uring_buf_ring *br;
+    struct socket_uring_buf bufs[GF_SOCKET_URING_BUFS];
+    struct list_head conns;   /* transports using the ring */
+    struct list_head starved; /* only touched by the ring thread */
+    int32_t refs;             /* under socket_urings_lock */
+    int32_t nstarved;
+    int32_t nfree;
+    gf_boolean_t ready; /* setup failed if not */
+    gf_boolean_t broken;
+    gf_boolean_t stop;
+    gf_boolean_t orphan; /* the thread frees the ring when it stops */
+};
 
-    pthread_mutex_lock(&priv->out_lock);
-    {
-        if (priv->connected != 0)
-            goto unlock;
+static struct list_head socket_urings = {&socket_urings, &socket_urings};
+static pthread_mutex_t socket_urings_lock = PTHREAD_MUTEX_INITIALIZER;
 
-        get_transport_identifiers(this);
+/* user_data of requests whose completion carries no information. */
+static char socket_uring_nop;
 
-        ret = __socket_connect_finish(priv->sock);
+static void
+socket_uring_process(rpc_transport_t *this);
 
-        if ((ret < 0) && (errno == EINPROGRESS))
-            ret = 1;
+static int
+socket_uring_submit(struct socket_uring *ring,
+                    void (*prep)(struct io_uring_sqe *, void *), void *data,
+                    void *user_data)
+{
+    struct io_uring_sqe *sqe = NULL;
+    int ret = -1;
 
-        if ((ret < 0) && (errno != EINPROGRESS)) {
-            if (!priv->connect_finish_log) {
-                gf_log(this->name, GF_LOG_ERROR,
-                       "connection to %s failed (%s); "
-                       "disconnecting socket",
-                       this->peerinfo.identifier, strerror(errno));
-                priv->connect_finish_log = 1;
-            }
-            __socket_disconnect(this);
+    if (CMM_LOAD_SHARED(ring->broken))
+        return -EIO;
+
+    pthread_mutex_lock(&ring->sq_lock);
+    {
+        sqe = io_uring_get_sqe(&ring->ring);
+        if (!sqe) {
+            /* flush what is pending and try once more */
+            io_uring_submit(&ring->ring);
+            sqe = io_uring_get_sqe(&ring->ring);
+        }
+        if (!sqe) {
+            ret = -EAGAIN;
             goto unlock;
         }
 
-        if (ret == 0) {
-            notify_rpc = 1;
-
-            this->myinfo.sockaddr_len = sizeof(this->myinfo.sockaddr);
-
-            ret = getsockname(priv->sock, SA(&this->myinfo.sockaddr),
-                              &this->myinfo.sockaddr_len);
-            if (ret != 0) {
-                gf_log(this->name, GF_LOG_WARNING,
-                       "getsockname on (%d) failed (%s) - "
-                       "disconnecting socket",
-                       priv->sock, strerror(errno));
-                __socket_disconnect(this);
-                event = RPC_TRANSPORT_DISCONNECT;
-                goto unlock;
-            }
+        prep(sqe, data);
+        io_uring_sqe_set_data(sqe, user_data);
 
-            priv->connected = 1;
-            priv->connect_finish_log = 0;
-            event = RPC_TRANSPORT_CONNECT;
-        }
+        ret = io_uring_submit(&ring->ring);
+        if (ret > 0)
+            ret = 0;
     }
 unlock:
-    pthread_mutex_unlock(&priv->out_lock);
-
-    if (notify_rpc) {
-        rpc_transport_notify(this, event, this);
-    }
+    pthread_mutex_unlock(&ring->sq_lock);
 
     return ret;
 }
 
-static int
-socket_disconnect(rpc_transport_t *this, gf_boolean_t wait);
+static void
+socket_uring_prep_nop(struct io_uring_sqe *sqe, void *data)
+{
+    io_uring_prep_nop(sqe);
+}
 
-/* socket_is_connected() is for use only in socket_event_handler() */
-static inline gf_boolean_t
-socket_is_connected(socket_private_t *priv)
+static void
+socket_uring_prep_recv(struct io_uring_sqe *sqe, void *data)
 {
-    if (priv->use_ssl) {
-        return priv->is_server ? priv->ssl_accepted : priv->ssl_connected;
-    } else {
-        return priv->is_server ? priv->accepted : priv->connected;
-    }
+    socket_private_t *priv = data;
+
+    io_uring_prep_recv_multishot(sqe, priv->sock, NULL, 0, 0);
+    sqe->flags |= IOSQE_BUFFER_SELECT;
+    sqe->buf_group = GF_SOCKET_URING_BGID;
 }
 
 static void
-ssl_rearm_event_fd(rpc_transport_t *this)
+socket_uring_prep_cancel(struct io_uring_sqe *sqe, void *data)
 {
-    socket_private_t *priv = NULL;
-    glusterfs_ctx_t *ctx = NULL;
-    int idx = -1;
-    int gen = -1;
-    int fd = -1;
+    io_uring_prep_cancel(sqe, data, 0);
+}
 
-    priv = this->private;
-    ctx = this->ctx;
+static void
+socket_uring_prep_send(struct io_uring_sqe *sqe, void *data)
+{
+    socket_private_t *priv = data;
 
-    idx = priv->idx;
-    gen = priv->gen;
-    fd = priv->sock;
+    io_uring_prep_sendmsg(sqe, priv->sock, &priv->uring.send_msg,
+                          MSG_NOSIGNAL);
+}
 
-    if (priv->ssl_error_required == SSL_ERROR_WANT_READ)
-        gf_event_select_on(ctx->event_pool, fd, idx, 1, -1);
-    if (priv->ssl_error_required == SSL_ERROR_WANT_WRITE)
-        gf_event_select_on(ctx->event_pool, fd, idx, -1, 1);
-    gf_event_handled(ctx->event_pool, fd, idx, gen);
+static void
+__socket_uring_buf_add(struct socket_uring *ring, int32_t bid)
+{
+    io_uring_buf_ring_add(ring->br, iobuf_ptr(ring->bufs[bid].iobuf),
+                          GF_SOCKET_URING_BUF_SIZE, bid,
+                          io_uring_buf_ring_mask(GF_SOCKET_URING_BUFS), 0);
+    io_uring_buf_ring_advance(ring->br, 1);
+    ring->nfree++;
+}
+
+/* Hand a buffer back to the kernel once its data has been consumed. */
+static void
+socket_uring_buf_recycle(struct socket_uring *ring, int32_t bid)
+{
+    pthread_mutex_lock(&ring->buf_lock);
+    {
+        __socket_uring_buf_add(ring, bid);
+    }
+    pthread_mutex_unlock(&ring->buf_lock);
+
+    /* Starved connections are re-armed by the ring thread, wake it up if
+     * the buffer was returned from somewhere else. */
+    if (CMM_LOAD_SHARED(ring->nstarved) &&
+        !pthread_equal(pthread_self(), ring->thread))
+        socket_uring_submit(ring, socket_uring_prep_nop, NULL,
+                            &socket_uring_nop);
 }
 
+/* Must be called with priv->uring.lock held. */
 static int
-ssl_handle_server_connection_attempt(rpc_transport_t *this)
+__socket_uring_recv_arm(rpc_transport_t *this)
 {
-    socket_private_t *priv = NULL;
-    glusterfs_ctx_t *ctx = NULL;
-    int idx = -1;
-    int gen = -1;
+    socket_private_t *priv = this->private;
     int ret = -1;
-    int fd = -1;
 
-    priv = this->private;
-    ctx = this->ctx;
+    priv->uring.recv.trans = this;
+    priv->uring.recv.gen = priv->uring.gen;
+    priv->uring.recv.op = SOCKET_URING_RECV;
 
-    idx = priv->idx;
-    gen = priv->gen;
-    fd = priv->sock;
+    ret = socket_uring_submit(priv->uring.ring, socket_uring_prep_recv, priv,
+                              &priv->uring.recv);
+    if (ret == 0)
+        priv->uring.armed = _gf_true;
+    else
+        gf_log(this->name, GF_LOG_WARNING,
+               "failed to arm io_uring receive on socket %d (%s)", priv->sock,
+               strerror(-ret));
 
-    if (!priv->ssl_context_created) {
-        ret = ssl_setup_connection_prefix(this, _gf_true);
-        if (ret < 0) {
-            gf_log(this->name, GF_LOG_TRACE,
-                   "> ssl_setup_connection_prefix() failed!");
-            ret = -1;
-            goto out;
-        } else {
-            priv->ssl_context_created = _gf_true;
-        }
-    }
-    ret = ssl_complete_connection(this);
-    if (ret == 0) {
-        /* nothing to do */
-        gf_event_select_on(ctx->event_pool, fd, idx, 1, 0);
-        gf_event_handled(ctx->event_pool, fd, idx, gen);
-        ret = 1;
-    } else {
-        if (errno == EAGAIN) {
-            ssl_rearm_event_fd(this);
-            ret = 1;
-        } else {
-            ret = -1;
-            gf_log(this->name, GF_LOG_TRACE,
-                   "ssl_complete_connection returned error");
-        }
-    }
-out:
     return ret;
 }
 
-static int
-ssl_handle_client_connection_attempt(rpc_transport_t *this)
+/* Release the data not yet consumed by the state machine. Must be called
+ * with priv->uring.lock held. */
+static void
+__socket_uring_rx_flush(socket_private_t *priv)
 {
-    socket_private_t *priv = NULL;
-    glusterfs_ctx_t *ctx = NULL;
-    int idx = -1;
-    int ret = -1;
-    int fd = -1;
+    struct socket_uring *ring = priv->uring.ring;
+    int32_t bid = -1;
 
-    priv = this->private;
-    ctx = this->ctx;
+    while (priv->uring.rx_head >= 0) {
+        bid = priv->uring.rx_head;
+        priv->uring.rx_head = ring->bufs[bid].next;
+        socket_uring_buf_recycle(ring, bid);
+    }
+    priv->uring.rx_tail = -1;
+}
 
-    idx = priv->idx;
-    fd = priv->sock;
+static ssize_t
+__socket_uring_readv(rpc_transport_t *this, struct iovec *opvector,
+                     int opcount)
+{
+    socket_private_t *priv = this->private;
+    struct socket_uring *ring = priv->uring.ring;
+    struct socket_uring_buf *buf = NULL;
+    size_t copied = 0;
+    size_t offset = 0;
+    size_t len = 0;
+    int32_t bid = -1;
+    int i = 0;
 
-    /* SSL client */
-    if (priv->connect_failed) {
-        gf_log(this->name, GF_LOG_TRACE, ">>> disconnecting SSL socket");
-        (void)socket_disconnect(this, _gf_false);
-        /* Force ret to be -1, as we are officially done with
-           this socket */
-        ret = -1;
-    } else {
-        if (!priv->ssl_context_created) {
-            ret = ssl_setup_connection_prefix(this, _gf_false);
-            if (ret < 0) {
-                gf_log(this->name, GF_LOG_TRACE,
-                       "> ssl_setup_connection_prefix() "
-                       "failed!");
-                ret = -1;
-                goto out;
-            } else {
-                priv->ssl_context_created = _gf_true;
+    pthread_mutex_lock(&priv->uring.lock);
+    {
+        while ((i < opcount) && (priv->uring.rx_head >= 0)) {
+            bid = priv->uring.rx_head;
+            buf = &ring->bufs[bid];
+
+            len = min(buf->len - buf->off, opvector[i].iov_len - offset);
+            memcpy((char *)opvector[i].iov_base + offset,
+                   (char *)iobuf_ptr(buf->iobuf) + buf->off, len);
+            buf->off += len;
+            offset += len;
+            copied += len;
+
+            if (offset == opvector[i].iov_len) {
+                offset = 0;
+                i++;
+            }
+
+            if (buf->off == buf->len) {
+                priv->uring.rx_head = buf->next;
+                if (priv->uring.rx_head < 0)
+                    priv->uring.rx_tail = -1;
+                socket_uring_buf_recycle(ring, bid);
             }
         }
-        ret = ssl_complete_connection(this);
-        if (ret == 0) {
-            ret = socket_connect_finish(this);
-            gf_event_select_on(ctx->event_pool, fd, idx, 1, 0);
-            gf_log(this->name, GF_LOG_TRACE, ">>> completed client connect");
-        } else {
-            if (errno == EAGAIN) {
-                gf_log(this->name, GF_LOG_TRACE,
-                       ">>> retrying client connect 2");
-                ssl_rearm_event_fd(this);
-                ret = 1;
-            } else {
-                /* this is a connection failure */
-                (void)socket_connect_finish(this);
-                gf_log(this->name, GF_LOG_TRACE,
-                       "ssl_complete_connection "
-                       "returned error");
-                ret = -1;
+
+        if (copied == 0) {
+            if (!priv->uring.done) {
+                errno = EAGAIN;
+                copied = -1;
+            } else if (priv->uring.rx_error) {
+                errno = priv->uring.rx_error;
+                copied = -1;
             }
+            /* else EOF */
         }
     }
-out:
-    return ret;
+    pthread_mutex_unlock(&priv->uring.lock);
+
+    return copied;
+}
+
+/* Free the ioq entries of a sendmsg that will not be completed. Must be
+ * called with priv->out_lock held. */
+static void
+__socket_uring_inflight_flush(socket_private_t *priv)
+{
+    struct ioq *entry = NULL;
+
+    while (!list_empty(&priv->uring.inflight)) {
+        entry = list_first_entry(&priv->uring.inflight, struct ioq, list);
+        __socket_ioq_entry_free(entry);
+    }
 }
 
+/* Start a sendmsg with the leftovers of the previous one followed by as many
+ * queued entries as fit. Must be called with priv->out_lock held. */
 static int
-socket_handle_client_connection_attempt(rpc_transport_t *this)
+__socket_uring_send(rpc_transport_t *this)
 {
-    socket_private_t *priv = NULL;
-    glusterfs_ctx_t *ctx = NULL;
-    int idx = -1;
-    int gen = -1;
-    int ret = -1;
-    int fd = -1;
+    socket_private_t *priv = this->private;
+    struct ioq *entry = NULL;
+    int count = 0;
+    int ret = 0;
 
-    priv = this->private;
-    ctx = this->ctx;
+    list_for_each_entry(entry, &priv->uring.inflight, list)
+    {
+        memcpy(&priv->uring.send_iov[count], entry->pending_vector,
+               sizeof(struct iovec) * entry->pending_count);
+        count += entry->pending_count;
+    }
 
-    idx = priv->idx;
-    gen = priv->gen;
-    fd = priv->sock;
+    while (!list_empty(&priv->ioq)) {
+        entry = priv->ioq_next;
+        if (count + entry->pending_count > GF_SOCKET_URING_SEND_IOV)
+            break;
 
-    /* non-SSL client */
-    if (priv->connect_failed) {
-        /* connect failed with some other error than
-           EINPROGRESS or ENOENT, so nothing more to
-           do, fail reading/writing anything even if
-           poll_in or poll_out
-           is set
-           */
-        gf_log("transport", GF_LOG_DEBUG,
-               "connect failed with some other error "
-               "than EINPROGRESS or ENOENT, so "
-               "nothing more to do; disconnecting "
-               "socket");
-        (void)socket_disconnect(this, _gf_false);
+        memcpy(&priv->uring.send_iov[count], entry->pending_vector,
+               sizeof(struct iovec) * entry->pending_count);
+        count += entry->pending_count;
+        list_move_tail(&entry->list, &priv->uring.inflight);
+    }
+
+    if (count == 0)
+        goto out;
+
+    memset(&priv->uring.send_msg, 0, sizeof(priv->uring.send_msg));
+    priv->uring.send_msg.msg_iov = priv->uring.send_iov;
+    priv->uring.send_msg.msg_iovlen = count;
+
+    priv->uring.send.trans = this;
+    priv->uring.send.gen = priv->uring.gen;
+    priv->uring.send.op = SOCKET_URING_SEND;
+
+    ret = socket_uring_submit(priv->uring.ring, socket_uring_prep_send, priv,
+                              &priv->uring.send);
+    if (ret != 0) {
+        gf_log(this->name, GF_LOG_WARNING,
+               "failed to submit io_uring send on socket %d (%s)", priv->sock,
+               strerror(-ret));
+        __socket_uring_inflight_flush(priv);
+        goto out;
+    }
+
+    priv->uring.sending = _gf_true;
+    rpc_transport_ref(this);
+out:
+    return ret;
+}
+
+/* Account @res bytes sent from the head of the inflight list. Returns the
+ * number of messages completely written. */
+static int
+__socket_uring_sent(socket_private_t *priv, size_t res)
+{
+    struct ioq *entry = NULL;
+    struct iovec *iov = NULL;
+    int done = 0;
+
+    while (!list_empty(&priv->uring.inflight)) {
+        entry = list_first_entry(&priv->uring.inflight, struct ioq, list);
+
+        while (entry->pending_count > 0) {
+            iov = entry->pending_vector;
+            if (res < iov->iov_len) {
+                iov->iov_base += res;
+                iov->iov_len -= res;
+                res = 0;
+                break;
+            }
+            res -= iov->iov_len;
+            entry->pending_vector++;
+            entry->pending_count--;
+        }
+
+        if (entry->pending_count > 0)
+            break;
+
+        __socket_ioq_entry_free(entry);
+        done++;
+    }
+
+    return done;
+}
+
+static void
+socket_uring_send_complete(struct socket_uring_req *req, int32_t res)
+{
+    rpc_transport_t *this = req->trans;
+    socket_private_t *priv = this->private;
+    gf_boolean_t notify = _gf_false;
+
+    THIS = this->xl;
+
+    pthread_mutex_lock(&priv->out_lock);
+    {
+        priv->uring.sending = _gf_false;
+
+        if (req->gen != priv->uring.gen) {
+            /* The connection was reset while the send was running. */
+            __socket_uring_inflight_flush(priv);
+            res = 0;
+        } else if (res < 0) {
+            if ((res != -EAGAIN) && (res != -EINTR)) {
+                if (__does_socket_rwv_error_need_logging(priv, 1)) {
+                    GF_LOG_OCCASIONALLY(priv->log_ctr, this->name,
+                                        GF_LOG_WARNING,
+                                        "sendmsg on %s failed (%s)",
+                                        this->peerinfo.identifier,
+                                        strerror(-res));
+                }
+                __socket_uring_inflight_flush(priv);
+                __socket_disconnect(this);
+                goto unlock;
+            }
+            res = 0;
+        } else {
+            this->total_bytes_write += res;
+            notify = (__socket_uring_sent(priv, res) > 0);
+        }
+
+        if (priv->uring.active && (priv->connected == 1)) {
+            if (__socket_uring_send(this) != 0)
+                __socket_disconnect(this);
+        }
+    }
+unlock:
+    pthread_mutex_unlock(&priv->out_lock);
+
+    if (notify)
+        rpc_transport_notify(this, RPC_TRANSPORT_MSG_SENT, NULL);
+
+    rpc_transport_unref(this);
+}
+
+static void
+socket_uring_recv_complete(struct socket_uring_req *req, int32_t res,
+                           uint32_t flags)
+{
+    rpc_transport_t *this = req->trans;
+    socket_private_t *priv = this->private;
+    struct socket_uring *ring = priv->uring.ring;
+    struct socket_uring_buf *buf = NULL;
+    gf_boolean_t more = !!(flags & IORING_CQE_F_MORE);
+    gf_boolean_t process = _gf_false;
+    gf_boolean_t keep = _gf_false;
+    int32_t bid = -1;
+
+    THIS = this->xl;
+
+    if (flags & IORING_CQE_F_BUFFER) {
+        bid = flags >> IORING_CQE_BUFFER_SHIFT;
+        pthread_mutex_lock(&ring->buf_lock);
+        {
+            ring->nfree--;
+        }
+        pthread_mutex_unlock(&ring->buf_lock);
+    }
+
+    pthread_mutex_lock(&priv->uring.lock);
+    {
+        if (req->gen != priv->uring.gen) {
+            /* Completion of a receive issued on a previous connection. If
+             * a new one has been established meanwhile, this is the place
+             * where its receive gets armed. */
+            if (bid >= 0)
+                socket_uring_buf_recycle(ring, bid);
+            if (!more) {
+                priv->uring.armed = _gf_false;
+                if (priv->uring.active && !priv->uring.throttled &&
+                    !priv->uring.done)
+                    keep = (__socket_uring_recv_arm(this) == 0);
+            }
+            goto unlock;
+        }
+
+        if (bid >= 0) {
+            if (res > 0) {
+                buf = &ring->bufs[bid];
+                buf->len = res;
+                buf->off = 0;
+                buf->next = -1;
+                if (priv->uring.rx_tail >= 0)
+                    ring->bufs[priv->uring.rx_tail].next = bid;
+                else
+                    priv->uring.rx_head = bid;
+                priv->uring.rx_tail = bid;
+                process = _gf_true;
+            } else {
+                socket_uring_buf_recycle(ring, bid);
+            }
+        }
+
+        if (more)
+            goto unlock;
+
+        priv->uring.armed = _gf_false;
+
+        if ((res == -ENOBUFS) || (res == -ECANCELED) || (res > 0)) {
+            /* Paused, not finished. Throttled connections are re-armed
+             * when throttling is turned off, starved ones as soon as
+             * buffers are available again. */
+            if (priv->uring.throttled)
+                goto unlock;
+            if (res == -ENOBUFS) {
+                priv->uring.is_starved = _gf_true;
+                list_add_tail(&priv->uring.starved, &ring->starved);
+                CMM_STORE_SHARED(ring->nstarved, ring->nstarved + 1);
+                keep = _gf_true;
+                goto unlock;
+            }
+            keep = (__socket_uring_recv_arm(this) == 0);
+            if (keep)
+                goto unlock;
+            res = -EIO;
+        }
+
+        priv->uring.done = _gf_true;
+        priv->uring.rx_error = -res;
+        process = _gf_true;
+    }
+unlock:
+    pthread_mutex_unlock(&priv->uring.lock);
+
+    if (process)
+        socket_uring_process(this);
+
+    if (!more && !keep)
+        rpc_transport_unref(this);
+}
+
+/* Called from the ring thread to re-arm connections whose receive stopped
+ * because all the buffers were in use. */
+static void
+socket_uring_feed_starved(struct socket_uring *ring)
+{
+    socket_private_t *priv = NULL;
+    socket_private_t *tmp = NULL;
+    rpc_transport_t *this = NULL;
+    gf_boolean_t drop = _gf_false;
+    int32_t nfree = 0;
+
+    pthread_mutex_lock(&ring->buf_lock);
+    {
+        nfree = ring->nfree;
+    }
+    pthread_mutex_unlock(&ring->buf_lock);
+
+    list_for_each_entry_safe(priv, tmp, &ring->starved, uring.starved)
+    {
+        this = priv->uring.recv.trans;
+        drop = _gf_false;
+
+        pthread_mutex_lock(&priv->uring.lock);
+        {
+            if ((priv->uring.recv.gen != priv->uring.gen) ||
+                priv->uring.throttled || priv->uring.done) {
+                drop = _gf_true;
+            } else if (nfree > 0) {
+                if (__socket_uring_recv_arm(this) != 0) {
+                    /* same as a failed receive */
+                    priv->uring.done = _gf_true;
+                    priv->uring.rx_error = EIO;
+                    drop = _gf_true;
+                }
+                nfree--;
+            } else {
+                pthread_mutex_unlock(&priv->uring.lock);
+                continue;
+            }
+            priv->uring.is_starved = _gf_false;
+            list_del_init(&priv->uring.starved);
+            CMM_STORE_SHARED(ring->nstarved, ring->nstarved - 1);
+        }
+        pthread_mutex_unlock(&priv->uring.lock);
+
+        if (drop) {
+            socket_uring_process(this);
+            rpc_transport_unref(this);
+        }
+    }
+}
+
+/* The ring can't be trusted anymore: no completion will ever come for what
+ * was submitted. Take over the references held by the outstanding requests
+ * and tear the connections down, they come back on epoll. */
+static void
+socket_uring_fail(struct socket_uring *ring)
+{
+    struct list_head failed;
+    socket_private_t *priv = NULL;
+    socket_private_t *tmp = NULL;
+    rpc_transport_t *this = NULL;
+
+    INIT_LIST_HEAD(&failed);
+
+    pthread_mutex_lock(&ring->lock);
+    {
+        CMM_STORE_SHARED(ring->broken, _gf_true);
+
+        list_for_each_entry(priv, &ring->conns, uring.conn)
+        {
+            priv->uring.lost = 0;
+
+            pthread_mutex_lock(&priv->out_lock);
+            {
+                if (priv->uring.sending) {
+                    priv->uring.sending = _gf_false;
+                    __socket_uring_inflight_flush(priv);
+                    priv->uring.lost++;
+                }
+            }
+            pthread_mutex_unlock(&priv->out_lock);
+
+            pthread_mutex_lock(&priv->uring.lock);
+            {
+                if (priv->uring.armed) {
+                    priv->uring.armed = _gf_false;
+                    priv->uring.lost++;
+                }
+                if (priv->uring.is_starved) {
+                    priv->uring.is_starved = _gf_false;
+                    list_del_init(&priv->uring.starved);
+                    priv->uring.lost++;
+                }
+                priv->uring.done = _gf_true;
+                priv->uring.rx_error = EIO;
+                priv->uring.hup = _gf_true;
+
+                /* only the connections holding a reference can be used
+                 * outside of the lock */
+                if (priv->uring.lost)
+                    list_add_tail(&priv->uring.starved, &failed);
+            }
+            pthread_mutex_unlock(&priv->uring.lock);
+        }
+        ring->nstarved = 0;
+    }
+    pthread_mutex_unlock(&ring->lock);
+
+    list_for_each_entry_safe(priv, tmp, &failed, uring.starved)
+    {
+        list_del_init(&priv->uring.starved);
+        this = priv->uring.recv.trans;
+        if (!this)
+            this = priv->uring.send.trans;
+
+        socket_uring_process(this);
+        while (priv->uring.lost-- > 0)
+            rpc_transport_unref(this);
+    }
+}
+
+static void
+socket_uring_destroy(struct socket_uring *ring)
+{
+    int32_t i;
+
+    if (ring->br)
+        io_uring_free_buf_ring(&ring->ring, ring->br, GF_SOCKET_URING_BUFS,
+                               GF_SOCKET_URING_BGID);
+    ring->br = NULL;
+
+    for (i = 0; i < GF_SOCKET_URING_BUFS; i++) {
+        if (ring->bufs[i].iobuf)
+            iobuf_unref(ring->bufs[i].iobuf);
+        ring->bufs[i].iobuf = NULL;
+    }
+
+    io_uring_queue_exit(&ring->ring);
+    pthread_mutex_destroy(&ring->sq_lock);
+    pthread_mutex_destroy(&ring->buf_lock);
+}
+
+static void
+socket_uring_free(struct socket_uring *ring)
+{
+    if (ring->ready)
+        socket_uring_destroy(ring);
+    pthread_mutex_destroy(&ring->lock);
+    pthread_cond_destroy(&ring->cond);
+    GF_FREE(ring);
+}
+
+static void *
+socket_uring_thread(void *data)
+{
+    struct socket_uring *ring = data;
+    struct io_uring_cqe *cqe = NULL;
+    struct socket_uring_req *req = NULL;
+    gf_boolean_t orphan = _gf_false;
+    uint32_t flags = 0;
+    int32_t res = 0;
+    int ret = 0;
+
+    while (!CMM_LOAD_SHARED(ring->stop)) {
+        ret = io_uring_wait_cqe(&ring->ring, &cqe);
+        if (ret != 0) {
+            if ((ret == -EINTR) || (ret == -EAGAIN))
+                continue;
+            gf_log("socket", GF_LOG_ERROR,
+                   "unable to get io_uring completion (%s), falling back to "
+                   "epoll based socket IO",
+                   strerror(-ret));
+            socket_uring_fail(ring);
+            break;
+        }
+
+        req = io_uring_cqe_get_data(cqe);
+        res = cqe->res;
+        flags = cqe->flags;
+        io_uring_cqe_seen(&ring->ring, cqe);
+
+        if ((void *)req != (void *)&socket_uring_nop) {
+            if (req->op == SOCKET_URING_RECV)
+                socket_uring_recv_complete(req, res, flags);
+            else
+                socket_uring_send_complete(req, res);
+        }
+
+        if (ring->nstarved)
+            socket_uring_feed_starved(ring);
+    }
+
+    /* a broken ring stays until its last transport goes away */
+    pthread_mutex_lock(&ring->lock);
+    {
+        while (!ring->stop)
+            pthread_cond_wait(&ring->cond, &ring->lock);
+        orphan = ring->orphan;
+    }
+    pthread_mutex_unlock(&ring->lock);
+
+    if (orphan)
+        socket_uring_free(ring);
+
+    return NULL;
+}
+
+/* Check that the kernel supports multishot receives from provided buffers
+ * before letting any connection rely on them. */
+static int
+socket_uring_probe(struct socket_uring *ring)
+{
+    struct io_uring_cqe *cqe = NULL;
+    struct io_uring_sqe *sqe = NULL;
+    int fds[2] = {-1, -1};
+    int ret = -1;
+    int32_t res = 0;
+    uint32_t flags = 0;
+
+    if (socketpair(AF_UNIX, SOCK_STREAM, 0, fds) != 0)
+        return -1;
+
+    sqe = io_uring_get_sqe(&ring->ring);
+    io_uring_prep_recv_multishot(sqe, fds[0], NULL, 0, 0);
+    sqe->flags |= IOSQE_BUFFER_SELECT;
+    sqe->buf_group = GF_SOCKET_URING_BGID;
+    io_uring_sqe_set_data(sqe, &socket_uring_nop);
+    io_uring_submit(&ring->ring);
+
+    if (sys_write(fds[1], "", 1) != 1)
+        goto out;
+    sys_close(fds[1]);
+    fds[1] = -1;
+
+    /* one byte of data and then EOF */
+    do {
+        if (io_uring_wait_cqe(&ring->ring, &cqe) != 0)
+            goto out;
+        res = cqe->res;
+        flags = cqe->flags;
+        io_uring_cqe_seen(&ring->ring, cqe);
+
+        if (flags & IORING_CQE_F_BUFFER) {
+            ring->nfree--;
+            __socket_uring_buf_add(ring, flags >> IORING_CQE_BUFFER_SHIFT);
+        }
+        if ((res < 0) || ((res > 0) && !(flags & IORING_CQE_F_MORE)))
+            goto out;
+    } while (flags & IORING_CQE_F_MORE);
+
+    ret = 0;
+out:
+    if (fds[1] >= 0)
+        sys_close(fds[1]);
+    sys_close(fds[0]);
+
+    return ret;
+}
+
+static int
+socket_uring_setup(rpc_transport_t *this, struct socket_uring *ring)
+{
+    int32_t i;
+    int ret = -1;
+
+    ret = io_uring_queue_init(GF_SOCKET_URING_ENTRIES, &ring->ring, 0);
+    if (ret != 0) {
+        gf_log(this->name, GF_LOG_WARNING, "io_uring setup failed (%s)",
+               strerror(-ret));
+        return -1;
+    }
+    pthread_mutex_init(&ring->sq_lock, NULL);
+    pthread_mutex_init(&ring->buf_lock, NULL);
+
+    ring->br = io_uring_setup_buf_ring(&ring->ring, GF_SOCKET_URING_BUFS,
+                                       GF_SOCKET_URING_BGID, 0, &ret);
+    if (!ring->br) {
+        gf_log(this->name, GF_LOG_WARNING,
+               "io_uring provided buffers not supported (%s)", strerror(-ret));
+        goto err;
+    }
+
+    for (i = 0; i < GF_SOCKET_URING_BUFS; i++) {
+        ring->bufs[i].iobuf = iobuf_get2(ring->ctx->iobuf_pool,
+                                         GF_SOCKET_URING_BUF_SIZE);
+        if (!ring->bufs[i].iobuf)
+            goto err;
+        __socket_uring_buf_add(ring, i);
+    }
+
+    if (socket_uring_probe(ring) != 0) {
+        gf_log(this->name, GF_LOG_WARNING,
+               "kernel does not support io_uring multishot receive");
+        goto err;
+    }
+
+    ret = gf_thread_create(&ring->thread, NULL, socket_uring_thread, ring,
+                           "sockuring");
+    if (ret != 0)
+        goto err;
+
+    return 0;
+
+err:
+    socket_uring_destroy(ring);
+    return -1;
+}
+
+/* Find the ring of the context of the transport, or create it. A context
+ * where the setup failed keeps a ring that is not ready, so that it's not
+ * retried for every new connection. */
+static struct socket_uring *
+socket_uring_get(rpc_transport_t *this)
+{
+    struct socket_uring *ring = NULL;
+
+    pthread_mutex_lock(&socket_urings_lock);
+    {
+        list_for_each_entry(ring, &socket_urings, list)
+        {
+            if (ring->ctx == this->ctx) {
+                ring->refs++;
+                goto unlock;
+            }
+        }
+
+        ring = GF_CALLOC(1, sizeof(*ring), gf_common_mt_socket_private_t);
+        if (!ring)
+            goto unlock;
+
+        ring->ctx = this->ctx;
+        ring->refs = 1;
+        pthread_mutex_init(&ring->lock, NULL);
+        pthread_cond_init(&ring->cond, NULL);
+        INIT_LIST_HEAD(&ring->conns);
+        INIT_LIST_HEAD(&ring->starved);
+
+        if (socket_uring_setup(this, ring) == 0) {
+            ring->ready = _gf_true;
+        } else {
+            gf_log(this->name, GF_LOG_WARNING,
+                   "falling back to epoll based socket IO");
+        }
+        list_add_tail(&ring->list, &socket_urings);
+    }
+unlock:
+    pthread_mutex_unlock(&socket_urings_lock);
+
+    return ring;
+}
+
+/* Called when the transport is destroyed, the last one takes the ring of
+ * its context with it. */
+static void
+socket_uring_release(rpc_transport_t *this)
+{
+    socket_private_t *priv = this->private;
+    struct socket_uring *ring = priv->uring.ring;
+    gf_boolean_t last = _gf_false;
+    gf_boolean_t self = _gf_false;
+
+    if (!ring)
+        return;
+    priv->uring.ring = NULL;
+
+    pthread_mutex_lock(&ring->lock);
+    {
+        if (!list_empty(&priv->uring.conn))
+            list_del_init(&priv->uring.conn);
+    }
+    pthread_mutex_unlock(&ring->lock);
+
+    pthread_mutex_lock(&socket_urings_lock);
+    {
+        if (--ring->refs == 0) {
+            list_del_init(&ring->list);
+            last = _gf_true;
+        }
+    }
+    pthread_mutex_unlock(&socket_urings_lock);
+
+    if (!last)
+        return;
+
+    if (ring->ready) {
+        /* the last transport may go away from a completion, the ring can't
+         * be torn down under the thread running it */
+        self = pthread_equal(pthread_self(), ring->thread);
+
+        pthread_mutex_lock(&ring->lock);
+        {
+            ring->orphan = self;
+            CMM_STORE_SHARED(ring->stop, _gf_true);
+            pthread_cond_signal(&ring->cond);
+        }
+        pthread_mutex_unlock(&ring->lock);
+
+        /* wake the thread up if it's waiting for a completion, bypassing
+         * the broken check of socket_uring_submit() */
+        pthread_mutex_lock(&ring->sq_lock);
+        {
+            struct io_uring_sqe *sqe = io_uring_get_sqe(&ring->ring);
+            if (sqe) {
+                io_uring_prep_nop(sqe);
+                io_uring_sqe_set_data(sqe, &socket_uring_nop);
+                io_uring_submit(&ring->ring);
+            }
+        }
+        pthread_mutex_unlock(&ring->sq_lock);
+
+        if (self) {
+            pthread_detach(ring->thread);
+            return;
+        }
+        pthread_join(ring->thread, NULL);
+    }
+
+    socket_uring_free(ring);
+}
+
+static void
+socket_uring_teardown(rpc_transport_t *this)
+{
+    socket_private_t *priv = this->private;
+
+    gf_log("transport", GF_LOG_DEBUG, "disconnecting (sock:%d) (io_uring)",
+           priv->sock);
+
+    if (socket_event_poll_err(this, priv->gen, priv->idx))
+        rpc_transport_unref(this);
+}
+
+/* Run the RPC state machine over the received data. Only one thread at a
+ * time does it for a given connection, the others just leave a note. */
+static void
+socket_uring_process(rpc_transport_t *this)
+{
+    socket_private_t *priv = this->private;
+    gf_boolean_t teardown = _gf_false;
+    uint64_t consumed = 0;
+    int ret = 0;
+
+    pthread_mutex_lock(&priv->uring.lock);
+    if (priv->uring.busy) {
+        priv->uring.again = _gf_true;
+        goto unlock;
+    }
+    priv->uring.busy = _gf_true;
+
+    do {
+        priv->uring.again = _gf_false;
+
+        while (!priv->uring.throttled &&
+               ((priv->uring.rx_head >= 0) || priv->uring.done)) {
+            consumed = this->total_bytes_read;
+            pthread_mutex_unlock(&priv->uring.lock);
+
+            ret = socket_event_poll_in(this, _gf_false);
+
+            pthread_mutex_lock(&priv->uring.lock);
+            if (ret < 0) {
+                teardown = _gf_true;
+                break;
+            }
+            if (consumed == this->total_bytes_read)
+                break;
+        }
+
+        if (priv->uring.hup && !priv->uring.armed)
+            teardown = _gf_true;
+    } while (priv->uring.again && !teardown);
+
+    if (teardown) {
+        pthread_mutex_unlock(&priv->uring.lock);
+        socket_uring_teardown(this);
+        pthread_mutex_lock(&priv->uring.lock);
+    }
+
+    priv->uring.busy = _gf_false;
+unlock:
+    pthread_mutex_unlock(&priv->uring.lock);
+}
+
+/* Switch a connected socket to io_uring. Called from socket_event_handler(),
+ * which guarantees nobody else is reading from the socket. */
+static int
+socket_uring_start(rpc_transport_t *this)
+{
+    socket_private_t *priv = this->private;
+    struct socket_uring *ring = priv->uring.ring;
+    int ret = -1;
+
+    if (priv->use_ssl)
+        return -1;
+
+    if (!ring) {
+        ring = socket_uring_get(this);
+        if (!ring) {
+            priv->uring.enabled = _gf_false;
+            return -1;
+        }
+        priv->uring.ring = ring;
+    }
+
+    if (!ring->ready) {
+        priv->uring.enabled = _gf_false;
+        return -1;
+    }
+
+    pthread_mutex_lock(&ring->lock);
+    {
+        if (ring->broken) {
+            /* reconnecting after a failure of the ring */
+            priv->uring.enabled = _gf_false;
+            pthread_mutex_unlock(&ring->lock);
+            return -1;
+        }
+        if (list_empty(&priv->uring.conn))
+            list_add_tail(&priv->uring.conn, &ring->conns);
+    }
+    pthread_mutex_unlock(&ring->lock);
+
+    pthread_mutex_lock(&priv->out_lock);
+    {
+        if ((priv->connected != 1) || (priv->sock < 0))
+            goto unlock;
+
+        /* Must be visible before the first completion arrives. */
+        priv->uring.active = _gf_true;
+
+        pthread_mutex_lock(&priv->uring.lock);
+        {
+            if (priv->uring.armed) {
+                /* A receive of a previous connection is still being
+                 * cancelled, its completion will arm the new one. */
+                ret = 0;
+            } else {
+                ret = __socket_uring_recv_arm(this);
+                if (ret == 0)
+                    rpc_transport_ref(this);
+            }
+        }
+        pthread_mutex_unlock(&priv->uring.lock);
+
+        if (ret != 0) {
+            priv->uring.active = _gf_false;
+            goto unlock;
+        }
+
+        priv->idx = gf_event_select_on(this->ctx->event_pool, priv->sock,
+                                       priv->idx, 0, 0);
+
+        if (!priv->uring.sending && (__socket_uring_send(this) != 0))
+            __socket_disconnect(this);
+    }
+unlock:
+    pthread_mutex_unlock(&priv->out_lock);
+
+    if (ret == 0)
+        gf_log(this->name, GF_LOG_DEBUG, "socket %d switched to io_uring",
+               priv->sock);
+
+    return ret;
+}
+
+/* Epoll only reports errors for connections driven by io_uring. */
+static void
+socket_uring_event(rpc_transport_t *this, int poll_err)
+{
+    socket_private_t *priv = this->private;
+
+    if (!poll_err)
+        return;
+
+    pthread_mutex_lock(&priv->uring.lock);
+    {
+        priv->uring.hup = _gf_true;
+    }
+    pthread_mutex_unlock(&priv->uring.lock);
+
+    socket_uring_process(this);
+}
+
+static void
+__socket_uring_throttle(rpc_transport_t *this, gf_boolean_t onoff)
+{
+    socket_private_t *priv = this->private;
+
+    pthread_mutex_lock(&priv->uring.lock);
+    {
+        priv->uring.throttled = onoff;
+
+        if (onoff) {
+            if (priv->uring.armed)
+                socket_uring_submit(priv->uring.ring, socket_uring_prep_cancel,
+                                    &priv->uring.recv, &socket_uring_nop);
+        } else if (!priv->uring.armed && !priv->uring.is_starved &&
+                   !priv->uring.done) {
+            if (__socket_uring_recv_arm(this) == 0)
+                rpc_transport_ref(this);
+            else
+                priv->uring.hup = _gf_true;
+        }
+    }
+    pthread_mutex_unlock(&priv->uring.lock);
+}
+
+/* Forget everything about the current connection. Must be called with
+ * priv->out_lock held, before the socket is closed. */
+static void
+__socket_uring_reset(rpc_transport_t *this)
+{
+    socket_private_t *priv = this->private;
+
+    pthread_mutex_lock(&priv->uring.lock);
+    {
+        priv->uring.gen++;
+        __socket_uring_rx_flush(priv);
+
+        /* An outstanding receive holds its own reference on the file, so
+         * closing the socket is not enough to terminate it. */
+        if (priv->uring.armed && (priv->sock >= 0))
+            shutdown(priv->sock, SHUT_RDWR);
+
+        /* let the ring thread drop its reference */
+        if (priv->uring.is_starved)
+            socket_uring_submit(priv->uring.ring, socket_uring_prep_nop,
+                                NULL, &socket_uring_nop);
+
+        priv->uring.rx_error = 0;
+        priv->uring.done = _gf_false;
+        priv->uring.hup = _gf_false;
+        priv->uring.throttled = _gf_false;
+    }
+    pthread_mutex_unlock(&priv->uring.lock);
+
+    priv->uring.active = _gf_false;
+}
+
+#else /* !HAVE_LIBURING_BUF_RING */
+
+static ssize_t
+__socket_uring_readv(rpc_transport_t *this, struct iovec *opvector,
+                     int opcount)
+{
+    errno = ENOTSUP;
+    return -1;
+}
+
+static int
+__socket_uring_send(rpc_transport_t *this)
+{
+    return -1;
+}
+
+static int
+socket_uring_start(rpc_transport_t *this)
+{
+    socket_private_t *priv = this->private;
+
+    gf_log(this->name, GF_LOG_WARNING,
+           "io_uring support not available at build time, "
+           "using epoll based socket IO");
+    priv->uring.enabled = _gf_false;
+
+    return -1;
+}
+
+static void
+socket_uring_event(rpc_transport_t *this, int poll_err)
+{
+}
+
+static void
+__socket_uring_throttle(rpc_transport_t *this, gf_boolean_t onoff)
+{
+}
+
+static void
+__socket_uring_reset(rpc_transport_t *this)
+{
+}
+
+static void
+socket_uring_process(rpc_transport_t *this)
+{
+}
+
+static void
+socket_uring_release(rpc_transport_t *this)
+{
+}
+
+#endif /* HAVE_LIBURING_BUF_RING */
+
+static int
+socket_connect_finish(rpc_transport_t *this)
+{
+    int ret = -1;
+    socket_private_t *priv = NULL;
+    rpc_transport_event_t event = 0;
+    char notify_rpc = 0;
+
+    priv = this->private;
+
+    pthread_mutex_lock(&priv->out_lock);
+    {
+        if (priv->connected != 0)
+            goto unlock;
+
+        get_transport_identifiers(this);
+
+        ret = __socket_connect_finish(priv->sock);
+
+        if ((ret < 0) && (errno == EINPROGRESS))
+            ret = 1;
+
+        if ((ret < 0) && (errno != EINPROGRESS)) {
+            if (!priv->connect_finish_log) {
+                gf_log(this->name, GF_LOG_ERROR,
+                       "connection to %s failed (%s); "
+                       "disconnecting socket",
+                       this->peerinfo.identifier, strerror(errno));
+                priv->connect_finish_log = 1;
+            }
+            __socket_disconnect(this);
+            goto unlock;
+        }
+
+        if (ret == 0) {
+            notify_rpc = 1;
+
+            this->myinfo.sockaddr_len = sizeof(this->myinfo.sockaddr);
+
+            ret = getsockname(priv->sock, SA(&this->myinfo.sockaddr),
+                              &this->myinfo.sockaddr_len);
+            if (ret != 0) {
+                gf_log(this->name, GF_LOG_WARNING,
+                       "getsockname on (%d) failed (%s) - "
+                       "disconnecting socket",
+                       priv->sock, strerror(errno));
+                __socket_disconnect(this);
+                event = RPC_TRANSPORT_DISCONNECT;
+                goto unlock;
+            }
+
+            priv->connected = 1;
+            priv->connect_finish_log = 0;
+            event = RPC_TRANSPORT_CONNECT;
+        }
+    }
+unlock:
+    pthread_mutex_unlock(&priv->out_lock);
+
+    if (notify_rpc) {
+        rpc_transport_notify(this, event, this);
+    }
+
+    return ret;
+}
+
+static int
+socket_disconnect(rpc_transport_t *this, gf_boolean_t wait);
+
+/* socket_is_connected() is for use only in socket_event_handler() */
+static inline gf_boolean_t
+socket_is_connected(socket_private_t *priv)
+{
+    if (priv->use_ssl) {
+        return priv->is_server ? priv->ssl_accepted : priv->ssl_connected;
+    } else {
+        return priv->is_server ? priv->accepted : priv->connected;
+    }
+}
+
+static void
+ssl_rearm_event_fd(rpc_transport_t *this)
+{
+    socket_private_t *priv = NULL;
+    glusterfs_ctx_t *ctx = NULL;
+    int idx = -1;
+    int gen = -1;
+    int fd = -1;
+
+    priv = this->private;
+    ctx = this->ctx;
+
+    idx = priv->idx;
+    gen = priv->gen;
+    fd = priv->sock;
+
+    if (priv->ssl_error_required == SSL_ERROR_WANT_READ)
+        gf_event_select_on(ctx->event_pool, fd, idx, 1, -1);
+    if (priv->ssl_error_required == SSL_ERROR_WANT_WRITE)
+        gf_event_select_on(ctx->event_pool, fd, idx, -1, 1);
+    gf_event_handled(ctx->event_pool, fd, idx, gen);
+}
+
+static int
+ssl_handle_server_connection_attempt(rpc_transport_t *this)
+{
+    socket_private_t *priv = NULL;
+    glusterfs_ctx_t *ctx = NULL;
+    int idx = -1;
+    int gen = -1;
+    int ret = -1;
+    int fd = -1;
+
+    priv = this->private;
+    ctx = this->ctx;
+
+    idx = priv->idx;
+    gen = priv->gen;
+    fd = priv->sock;
+
+    if (!priv->ssl_context_created) {
+        ret = ssl_setup_connection_prefix(this, _gf_true);
+        if (ret < 0) {
+            gf_log(this->name, GF_LOG_TRACE,
+                   "> ssl_setup_connection_prefix() failed!");
+            ret = -1;
+            goto out;
+        } else {
+            priv->ssl_context_created = _gf_true;
+        }
+    }
+    ret = ssl_complete_connection(this);
+    if (ret == 0) {
+        /* nothing to do */
+        gf_event_select_on(ctx->event_pool, fd, idx, 1, 0);
+        gf_event_handled(ctx->event_pool, fd, idx, gen);
+        ret = 1;
+    } else {
+        if (errno == EAGAIN) {
+            ssl_rearm_event_fd(this);
+            ret = 1;
+        } else {
+            ret = -1;
+            gf_log(this->name, GF_LOG_TRACE,
+                   "ssl_complete_connection returned error");
+        }
+    }
+out:
+    return ret;
+}
+
+static int
+ssl_handle_client_connection_attempt(rpc_transport_t *this)
+{
+    socket_private_t *priv = NULL;
+    glusterfs_ctx_t *ctx = NULL;
+    int idx = -1;
+    int ret = -1;
+    int fd = -1;
+
+    priv = this->private;
+    ctx = this->ctx;
+
+    idx = priv->idx;
+    fd = priv->sock;
+
+    /* SSL client */
+    if (priv->connect_failed) {
+        gf_log(this->name, GF_LOG_TRACE, ">>> disconnecting SSL socket");
+        (void)socket_disconnect(this, _gf_false);
+        /* Force ret to be -1, as we are officially done with
+           this socket */
+        ret = -1;
+    } else {
+        if (!priv->ssl_context_created) {
+            ret = ssl_setup_connection_prefix(this, _gf_false);
+            if (ret < 0) {
+                gf_log(this->name, GF_LOG_TRACE,
+                       "> ssl_setup_connection_prefix() "
+                       "failed!");
+                ret = -1;
+                goto out;
+            } else {
+                priv->ssl_context_created = _gf_true;
+            }
+        }
+        ret = ssl_complete_connection(this);
+        if (ret == 0) {
+            ret = socket_connect_finish(this);
+            gf_event_select_on(ctx->event_pool, fd, idx, 1, 0);
+            gf_log(this->name, GF_LOG_TRACE, ">>> completed client connect");
+        } else {
+            if (errno == EAGAIN) {
+                gf_log(this->name, GF_LOG_TRACE,
+                       ">>> retrying client connect 2");
+                ssl_rearm_event_fd(this);
+                ret = 1;
+            } else {
+                /* this is a connection failure */
+                (void)socket_connect_finish(this);
+                gf_log(this->name, GF_LOG_TRACE,
+                       "ssl_complete_connection "
+                       "returned error");
+                ret = -1;
+            }
+        }
+    }
+out:
+    return ret;
+}
+
+static int
+socket_handle_client_connection_attempt(rpc_transport_t *this)
+{
+    socket_private_t *priv = NULL;
+    glusterfs_ctx_t *ctx = NULL;
+    int idx = -1;
+    int gen = -1;
+    int ret = -1;
+    int fd = -1;
+
+    priv = this->private;
+    ctx = this->ctx;
+
+    idx = priv->idx;
+    gen = priv->gen;
+    fd = priv->sock;
+
+    /* non-SSL client */
+    if (priv->connect_failed) {
+        /* connect failed with some other error than
+           EINPROGRESS or ENOENT, so nothing more to
+           do, fail reading/writing anything even if
+           poll_in or poll_out
+           is set
+           */
+        gf_log("transport", GF_LOG_DEBUG,
+               "connect failed with some other error "
+               "than EINPROGRESS or ENOENT, so "
+               "nothing more to do; disconnecting "
+               "socket");
+        (void)socket_disconnect(this, _gf_false);
 
         /* Force ret to be -1, as we are officially
          * done with this socket
@@ -2928,6 +4142,14 @@ socket_event_handler(int fd, int idx, int gen, void *data, int poll_in,
         }
     }
 
+    if (priv->uring.active ||
+        (!ret && !poll_err && priv->uring.enabled &&
+         (socket_uring_start(this) == 0))) {
+        socket_uring_event(this, poll_err);
+        gf_event_handled(ctx->event_pool, fd, idx, gen);
+        goto out;
+    }
+
     if (!ret && poll_out) {
         ret = socket_event_poll_out(this);
         gf_log(this->name, GF_LOG_TRACE,
@@ -3175,6 +4397,7 @@ socket_server_event_handler(int fd, int idx, int gen, void *data, int poll_in,
         new_priv->sock = new_sock;
 
         new_priv->ssl_enabled = priv->ssl_enabled;
+        new_priv->uring.enabled = priv->uring.enabled;
         new_priv->connected = 1;
         new_priv->is_server = _gf_true;
 
@@ -3808,6 +5031,16 @@ socket_submit_outgoing_msg(rpc_transport_t *this, rpc_transport_msg_t *msg)
         if (!entry)
             goto unlock;
 
+        if (priv->uring.active) {
+            /* sent from the ring, batched with whatever gets queued
+             * while the previous sendmsg is running */
+            list_add_tail(&entry->list, &priv->ioq);
+            ret = 0;
+            if (!priv->uring.sending && (__socket_uring_send(this) != 0))
+                __socket_disconnect(this);
+            goto unlock;
+        }
+
         if (list_empty(&priv->ioq)) {
             ret = __socket_ioq_churn_entry(this, entry);
 
@@ -3926,6 +5159,7 @@ static int
 socket_throttle(rpc_transport_t *this, gf_boolean_t onoff)
 {
     socket_private_t *priv = NULL;
+    gf_boolean_t resume = _gf_false;
 
     priv = this->private;
 
@@ -3942,11 +5176,23 @@ socket_throttle(rpc_transport_t *this, gf_boolean_t onoff)
          * on a disconnected transport, which breaks epoll's event to
          * registered fd mapping. */
 
-        if (priv->connected == 1)
-            priv->idx = gf_event_select_on(this->ctx->event_pool, priv->sock,
-                                           priv->idx, (int)!onoff, -1);
+        if (priv->connected == 1) {
+            if (priv->uring.active) {
+                __socket_uring_throttle(this, onoff);
+                resume = !onoff;
+            } else {
+                priv->idx = gf_event_select_on(this->ctx->event_pool,
+                                               priv->sock, priv->idx,
+                                               (int)!onoff, -1);
+            }
+        }
     }
     pthread_mutex_unlock(&priv->out_lock);
+
+    /* consume what was received while throttled */
+    if (resume)
+        socket_uring_process(this);
+
     return 0;
 }
 
@@ -4041,6 +5287,18 @@ reconfigure(rpc_transport_t *this, dict_t *options)
 
     priv->windowsize = (int)windowsize;
 
+    /* only affects connections established from now on */
+    if (dict_get_str_sizen(options, IO_URING_OPT, &optstr) == 0) {
+        if (gf_string2boolean(optstr, &tmp_bool) != 0) {
+            gf_log(this->name, GF_LOG_ERROR,
+                   "'" IO_URING_OPT "' takes only boolean options, "
+                   "not taking any action");
+        } else {
+            priv->uring.enabled = tmp_bool;
+        }
+    } else
+        priv->uring.enabled = _gf_false;
+
     data = dict_get_sizen(options, "non-blocking-io");
     if (data) {
         optstr = data_to_str(data);
@@ -4481,6 +5739,12 @@ socket_init(rpc_transport_t *this)
     INIT_LIST_HEAD(&priv->ioq);
     pthread_mutex_init(&priv->notify.lock, NULL);
     pthread_cond_init(&priv->notify.cond, NULL);
+    pthread_mutex_init(&priv->uring.lock, NULL);
+    INIT_LIST_HEAD(&priv->uring.inflight);
+    INIT_LIST_HEAD(&priv->uring.starved);
+    INIT_LIST_HEAD(&priv->uring.conn);
+    priv->uring.rx_head = -1;
+    priv->uring.rx_tail = -1;
 
     /* All the below section needs 'this->options' to be present */
     if (!this->options)
@@ -4602,6 +5866,15 @@ socket_init(rpc_transport_t *this)
 
     priv->windowsize = (int)windowsize;
 
+    if (dict_get_str_sizen(this->options, IO_URING_OPT, &optstr) == 0) {
+        if (gf_string2boolean(optstr, &priv->uring.enabled) != 0) {
+            gf_log(this->name, GF_LOG_ERROR,
+                   "'" IO_URING_OPT "' takes only boolean options, "
+                   "not taking any action");
+            priv->uring.enabled = _gf_false;
+        }
+    }
+
     priv->ssl_enabled = _gf_false;
     if (dict_get_str_sizen(this->options, SSL_ENABLED_OPT, &optstr) == 0) {
         if (gf_string2boolean(optstr, &priv->ssl_enabled) != 0) {
@@ -4640,6 +5913,9 @@ fini(rpc_transport_t *this)
 
         pthread_mutex_destroy(&priv->out_lock);
 
+        socket_uring_release(this);
+        pthread_mutex_destroy(&priv->uring.lock);
+
         GF_ASSERT(priv->notify.in_progress == 0);
         pthread_mutex_destroy(&priv->notify.lock);
         pthread_cond_destroy(&priv->notify.cond);
@@ -4755,6 +6031,14 @@ struct volume_options options[] = {
     {.key = {SSL_EC_CURVE_OPT}, .type = GF_OPTION_TYPE_STR},
     {.key = {SSL_CRL_PATH_OPT}, .type = GF_OPTION_TYPE_STR},
     {.key = {OWN_THREAD_OPT}, .type = GF_OPTION_TYPE_BOOL},
+    {.key = {IO_URING_OPT},
+     .type = GF_OPTION_TYPE_BOOL,
+     .op_version = {GD_OP_VERSION_10_0},
+     .default_value = "off",
+     .description = "Drive connections through io_uring: multishot "
+                    "receives into provided buffers and batched sends. "
+                    "Ignored for SSL connections and when the kernel "
+                    "lacks support."},
     {.key = {"ssl-own-cert"},
      .op_version = {GD_OP_VERSION_3_7_4},
      .flags = OPT_FLAG_SETTABLE,
@@ -45,6 +45,16 @@
 #define GF_KEEPALIVE_INTERVAL (2)
 #define GF_KEEPALIVE_COUNT (9)
 
+/* io_uring mode: size of the ring shared by all the connections of a
+ * glusterfs context, number and size of the receive buffers provided to the kernel
+ * for multishot receives, and the maximum number of iovecs coalesced into
+ * a single sendmsg. */
+#define GF_SOCKET_URING_ENTRIES 1024
+#define GF_SOCKET_URING_BUFS 256
+#define GF_SOCKET_URING_BUF_SIZE (64 * GF_UNIT_KB)
+#define GF_SOCKET_URING_BGID 1
+#define GF_SOCKET_URING_SEND_IOV 64
+
 typedef enum {
     SP_STATE_NADA = 0,
     SP_STATE_COMPLETE,
@@ -184,6 +194,49 @@ struct gf_sock_incoming {
     char _pad[4];
 };
 
+typedef enum {
+    SOCKET_URING_RECV,
+    SOCKET_URING_SEND,
+} socket_uring_op_t;
+
+/* Identifies the owner of an io_uring completion. The generation is bumped
+ * every time the connection is reset, so completions belonging to a previous
+ * connection on the same transport can be told apart. */
+struct socket_uring_req {
+    rpc_transport_t *trans;
+    uint32_t gen;
+    socket_uring_op_t op;
+};
+
+struct socket_uring;
+
+struct socket_uring_state {
+    pthread_mutex_t lock;
+    struct socket_uring *ring; /* of the context, once io_uring was tried */
+    struct list_head conn;     /* in the connections of the ring */
+    struct list_head inflight; /* ioq entries of the running sendmsg */
+    struct list_head starved;  /* waiting for receive buffers */
+    struct socket_uring_req recv;
+    struct socket_uring_req send;
+    struct msghdr send_msg;
+    struct iovec send_iov[GF_SOCKET_URING_SEND_IOV];
+    uint32_t gen;
+    int32_t rx_head; /* first provided buffer with unread data */
+    int32_t rx_tail;
+    int32_t rx_error;
+    int32_t lost; /* references taken over when the ring failed */
+    gf_boolean_t enabled; /* transport.socket.io-uring */
+    gf_boolean_t active;  /* connection is driven by io_uring */
+    gf_boolean_t armed;   /* multishot receive outstanding */
+    gf_boolean_t is_starved;
+    gf_boolean_t done; /* receive side hit EOF or an error */
+    gf_boolean_t hup;  /* epoll reported an error on the socket */
+    gf_boolean_t throttled;
+    gf_boolean_t busy;  /* a thread is running the state machine */
+    gf_boolean_t again; /* more work arrived while busy */
+    gf_boolean_t sending;
+};
+
 typedef struct {
     union {
         struct list_head ioq;
@@ -229,6 +282,7 @@ typedef struct {
     char *ssl_ca_list;
     char *crl_path;
     struct gf_sock_incoming incoming;
+    struct socket_uring_state uring;
     mgmt_ssl_t srvr_ssl;
     /* -1 = not connected. 0 = in progress. 1 = connected */
     char connected;
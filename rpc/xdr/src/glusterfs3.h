@@ -202,6 +202,7 @@ gf_proto_lease_to_lease(struct gf_proto_lease *gf_proto_lease,
     gf_lease->cmd = gf_proto_lease->cmd;
     gf_lease->lease_type = gf_proto_lease->lease_type;
     memcpy(gf_lease->lease_id, gf_proto_lease->lease_id, LEASE_ID_SIZE);
+    gf_lease->lease_flags = gf_proto_lease->lease_flags;
 }
 
 static inline void
@@ -214,6 +215,7 @@ gf_proto_lease_from_lease(struct gf_proto_lease *gf_proto_lease,
     gf_proto_lease->cmd = gf_lease->cmd;
     gf_proto_lease->lease_type = gf_lease->lease_type;
     memcpy(gf_proto_lease->lease_id, gf_lease->lease_id, LEASE_ID_SIZE);
+    gf_proto_lease->lease_flags = gf_lease->lease_flags;
 }
 
 static inline int
@@ -795,3 +795,46 @@ struct gfs4_entrylk_contention_req {
         string                domain<>;
         opaque                xdata<>;
 };
+
+union compound_req_v2 switch (int fop_enum) {
+        case GF_FOP_LOOKUP:     gfx_lookup_req   compound_lookup_req;
+        case GF_FOP_STAT:       gfx_stat_req     compound_stat_req;
+        case GF_FOP_OPEN:       gfx_open_req     compound_open_req;
+        case GF_FOP_READ:       gfx_read_req     compound_read_req;
+        case GF_FOP_WRITE:      gfx_write_req    compound_write_req;
+        case GF_FOP_FLUSH:      gfx_flush_req    compound_flush_req;
+        case GF_FOP_FSTAT:      gfx_fstat_req    compound_fstat_req;
+        case GF_FOP_INODELK:    gfx_inodelk_req  compound_inodelk_req;
+        case GF_FOP_FINODELK:   gfx_finodelk_req compound_finodelk_req;
+        case GF_FOP_XATTROP:    gfx_xattrop_req  compound_xattrop_req;
+        case GF_FOP_FXATTROP:   gfx_fxattrop_req compound_fxattrop_req;
+        default:                void;
+};
+
+struct gfx_compound_req {
+        int                       compound_version;
+        compound_req_v2           compound_req_array<>;
+        gfx_dict                  xdata;
+};
+
+union compound_rsp_v2 switch (int fop_enum) {
+        case GF_FOP_LOOKUP:     gfx_common_2iatt_rsp compound_lookup_rsp;
+        case GF_FOP_STAT:       gfx_common_iatt_rsp  compound_stat_rsp;
+        case GF_FOP_OPEN:       gfx_open_rsp         compound_open_rsp;
+        case GF_FOP_READ:       gfx_read_rsp         compound_read_rsp;
+        case GF_FOP_WRITE:      gfx_common_2iatt_rsp compound_write_rsp;
+        case GF_FOP_FLUSH:      gfx_common_rsp       compound_flush_rsp;
+        case GF_FOP_FSTAT:      gfx_common_iatt_rsp  compound_fstat_rsp;
+        case GF_FOP_INODELK:    gfx_common_rsp       compound_inodelk_rsp;
+        case GF_FOP_FINODELK:   gfx_common_rsp       compound_finodelk_rsp;
+        case GF_FOP_XATTROP:    gfx_common_dict_rsp  compound_xattrop_rsp;
+        case GF_FOP_FXATTROP:   gfx_common_dict_rsp  compound_fxattrop_rsp;
+        default:                void;
+};
+
+struct gfx_compound_rsp {
+        int                       op_ret;
+        int                       op_errno;
+        compound_rsp_v2           compound_rsp_array<>;
+        gfx_dict                  xdata;
+};
@@ -0,0 +1,43 @@
+#!/bin/bash
+#Test that the post-op and unlock sent as one compound fop leave the
+#changelog clean and the bricks in sync.
+
+. $(dirname $0)/../../include.rc
+. $(dirname $0)/../../volume.rc
+cleanup;
+
+TEST glusterd
+TEST pidof glusterd
+TEST $CLI volume create $V0 replica 3 $H0:$B0/${V0}{0,1,2}
+TEST $CLI volume set $V0 self-heal-daemon off
+TEST $CLI volume set $V0 cluster.eager-lock off
+TEST $CLI volume set $V0 cluster.use-compound-fops on
+TEST $CLI volume set $V0 performance.write-behind off
+TEST $CLI volume start $V0
+TEST $GFS --volfile-id=$V0 --volfile-server=$H0 $M0
+
+TEST dd if=/dev/urandom of=$M0/file bs=128k count=8
+TEST chmod 600 $M0/file
+TEST setfattr -n user.attr -v value $M0/file
+
+EXPECT "^0$" get_pending_heal_count $V0
+
+md5=$(md5sum $M0/file | awk '{print $1}')
+EXPECT "$md5" echo $(md5sum $B0/${V0}0/file | awk '{print $1}')
+EXPECT "$md5" echo $(md5sum $B0/${V0}1/file | awk '{print $1}')
+EXPECT "$md5" echo $(md5sum $B0/${V0}2/file | awk '{print $1}')
+
+#The locks must have been released with the post-op: a second writer
+#through another mount does not block.
+TEST $GFS --volfile-id=$V0 --volfile-server=$H0 $M1
+TEST timeout 10 dd if=/dev/zero of=$M1/file bs=4k count=1 conv=notrunc
+
+#A brick that was down is marked in the post-op of the others.
+TEST kill_brick $V0 $H0 $B0/${V0}2
+TEST dd if=/dev/zero of=$M0/file bs=4k count=1 conv=notrunc
+EXPECT "^00000001" get_hex_xattr trusted.afr.$V0-client-2 $B0/${V0}0/file
+EXPECT "^00000001" get_hex_xattr trusted.afr.$V0-client-2 $B0/${V0}1/file
+
+EXPECT_WITHIN $UMOUNT_TIMEOUT "Y" force_umount $M0
+EXPECT_WITHIN $UMOUNT_TIMEOUT "Y" force_umount $M1
+cleanup;
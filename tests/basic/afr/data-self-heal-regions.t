@@ -0,0 +1,76 @@
+#!/bin/bash
+#Test that data self-heal copies only the regions written while a brick was
+#down when cluster.data-self-heal-region-size is set, and falls back to a
+#regular heal when the record is incomplete.
+
+. $(dirname $0)/../../include.rc
+. $(dirname $0)/../../volume.rc
+
+function region_md5 {
+        dd if=$1 bs=1M skip=$2 count=1 2>/dev/null | md5sum | awk '{print $1}'
+}
+
+function healed_regions_count {
+        grep -c "healed dirty regions" $log_wd/glustershd.log
+}
+
+cleanup;
+
+log_wd=$(gluster --print-logdir)
+TEST glusterd
+TEST pidof glusterd
+rm -f $log_wd/glustershd.log
+TEST $CLI volume create $V0 replica 3 $H0:$B0/${V0}{0,1,2}
+TEST $CLI volume set $V0 cluster.data-self-heal-region-size 1MB
+TEST $CLI volume set $V0 cluster.data-self-heal-algorithm full
+TEST $CLI volume set $V0 performance.write-behind off
+TEST $CLI volume start $V0
+TEST $GFS --volfile-id=$V0 --volfile-server=$H0 $M0
+
+TEST dd if=/dev/urandom of=$M0/file bs=1M count=8
+TEST $CLI volume heal $V0 disable
+
+TEST kill_brick $V0 $H0 $B0/${V0}2
+TEST dd if=/dev/urandom of=$M0/file bs=4k count=1 seek=1280 conv=notrunc
+EXPECT "^00000001" get_hex_xattr trusted.afr.$V0-client-2= $B0/${V0}0/file
+EXPECT "^00000001" get_hex_xattr trusted.afr.$V0-client-2.regions $B0/${V0}0/file
+
+#Scribble over a region no write touched behind the back of the volume, a
+#region heal must leave it alone.
+TEST dd if=/dev/zero of=$B0/${V0}2/file bs=4k count=1 conv=notrunc
+clean=$(region_md5 $B0/${V0}2/file 0)
+
+TEST $CLI volume start $V0 force
+EXPECT_WITHIN $PROCESS_UP_TIMEOUT "1" afr_child_up_status $V0 2
+TEST $CLI volume heal $V0 enable
+EXPECT_WITHIN $PROCESS_UP_TIMEOUT "Y" glustershd_up_status
+EXPECT_WITHIN $CHILD_UP_TIMEOUT "1" afr_child_up_status_in_shd $V0 2
+TEST $CLI volume heal $V0
+EXPECT_WITHIN $HEAL_TIMEOUT "^0$" get_pending_heal_count $V0
+
+EXPECT "$(region_md5 $B0/${V0}0/file 5)" region_md5 $B0/${V0}2/file 5
+EXPECT "$clean" region_md5 $B0/${V0}2/file 0
+EXPECT "^1$" healed_regions_count
+EXPECT "^0*$" get_hex_xattr trusted.afr.$V0-client-2.regions $B0/${V0}0/file
+EXPECT "^0*$" get_hex_xattr trusted.afr.$V0-client-2.regions $B0/${V0}1/file
+
+#A truncate is not recorded in the region map, the next heal copies the whole
+#file.
+TEST $CLI volume heal $V0 disable
+TEST kill_brick $V0 $H0 $B0/${V0}2
+TEST dd if=/dev/urandom of=$M0/file bs=4k count=1 seek=256 conv=notrunc
+TEST truncate -s 6M $M0/file
+TEST $CLI volume start $V0 force
+EXPECT_WITHIN $PROCESS_UP_TIMEOUT "1" afr_child_up_status $V0 2
+TEST $CLI volume heal $V0 enable
+EXPECT_WITHIN $PROCESS_UP_TIMEOUT "Y" glustershd_up_status
+EXPECT_WITHIN $CHILD_UP_TIMEOUT "1" afr_child_up_status_in_shd $V0 2
+TEST $CLI volume heal $V0
+EXPECT_WITHIN $HEAL_TIMEOUT "^0$" get_pending_heal_count $V0
+
+EXPECT "^1$" healed_regions_count
+md5=$(md5sum $B0/${V0}0/file | awk '{print $1}')
+EXPECT "$md5" echo $(md5sum $B0/${V0}2/file | awk '{print $1}')
+
+EXPECT_WITHIN $UMOUNT_TIMEOUT "Y" force_umount $M0
+cleanup;
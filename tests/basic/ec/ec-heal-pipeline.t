@@ -0,0 +1,64 @@
+#!/bin/bash
+#Test that data heal with several windows in flight rebuilds a sparse file
+#correctly, keeps its holes on the healed brick and accounts the healed data
+#in the statedump of the self-heal daemon.
+
+. $(dirname $0)/../../include.rc
+. $(dirname $0)/../../volume.rc
+
+TESTS_EXPECTED_IN_LOOP=14
+
+function healed_bytes {
+        ec_get_info $V0 0 "child\[$1\]\.healed-bytes" $(generate_shd_statedump $V0)
+}
+
+cleanup
+TEST glusterd
+TEST pidof glusterd
+TEST $CLI volume create $V0 disperse 3 redundancy 1 $H0:$B0/${V0}{0..2}
+TEST $CLI volume set $V0 disperse.self-heal-window-size 1
+TEST $CLI volume set $V0 disperse.self-heal-pipeline-depth 4
+TEST $CLI volume set $V0 performance.write-behind off
+TEST $CLI volume heal $V0 disable
+TEST $CLI volume start $V0
+
+TEST $GFS --volfile-id=/$V0 --volfile-server=$H0 $M0
+EXPECT_WITHIN $CHILD_UP_TIMEOUT "3" ec_child_up_count $V0 0
+
+#Two extents of data separated by a large hole.
+TEST truncate -s 128M $M0/file
+TEST dd if=/dev/urandom of=$M0/file bs=1M count=6 conv=notrunc
+TEST dd if=/dev/urandom of=$M0/file bs=1M count=5 seek=96 conv=notrunc
+
+TEST kill_brick $V0 $H0 $B0/${V0}0
+EXPECT_WITHIN $CHILD_UP_TIMEOUT "2" ec_child_up_count $V0 0
+TEST dd if=/dev/urandom of=$M0/file bs=1M count=1 seek=2 conv=notrunc
+TEST dd if=/dev/urandom of=$M0/file bs=1M count=1 seek=98 conv=notrunc
+expected=$(md5sum $M0/file | awk '{print $1}')
+
+TEST $CLI volume start $V0 force
+EXPECT_WITHIN $CHILD_UP_TIMEOUT "3" ec_child_up_count $V0 0
+TEST $CLI volume heal $V0 enable
+EXPECT_WITHIN $PROCESS_UP_TIMEOUT "Y" glustershd_up_status
+EXPECT_WITHIN $CHILD_UP_TIMEOUT "3" ec_child_up_count_shd $V0 0
+TEST $CLI volume heal $V0
+EXPECT_WITHIN $HEAL_TIMEOUT "^0$" get_pending_heal_count $V0
+
+#The hole was not copied to the healed brick.
+EXPECT "^1$" echo $(($(du -k $B0/${V0}0/file | awk '{print $1}') < 16384))
+EXPECT_NOT "^0*$" healed_bytes 0
+EXPECT "^0$" healed_bytes 1
+
+#Read the file back without each of the bricks in turn.
+for i in 0 1 2; do
+        TEST kill_brick $V0 $H0 $B0/${V0}$i
+        EXPECT_WITHIN $UMOUNT_TIMEOUT "Y" force_umount $M0
+        TEST $GFS --volfile-id=/$V0 --volfile-server=$H0 $M0
+        EXPECT_WITHIN $CHILD_UP_TIMEOUT "2" ec_child_up_count $V0 0
+        EXPECT "$expected" echo $(md5sum $M0/file | awk '{print $1}')
+        TEST $CLI volume start $V0 force
+        EXPECT_WITHIN $CHILD_UP_TIMEOUT "3" ec_child_up_count $V0 0
+done
+
+EXPECT_WITHIN $UMOUNT_TIMEOUT "Y" force_umount $M0
+cleanup
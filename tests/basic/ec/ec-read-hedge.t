@@ -0,0 +1,53 @@
+#!/bin/bash
+
+. $(dirname $0)/../../include.rc
+. $(dirname $0)/../../volume.rc
+
+TESTS_EXPECTED_IN_LOOP=6
+
+cleanup
+
+TEST glusterd
+TEST pidof glusterd
+TEST $CLI volume create $V0 disperse 6 redundancy 2 $H0:$B0/${V0}{0..5}
+TEST $CLI volume set $V0 performance.quick-read off
+TEST $CLI volume set $V0 performance.io-cache off
+TEST $CLI volume set $V0 performance.write-behind off
+TEST $CLI volume set $V0 performance.stat-prefetch off
+TEST $CLI volume set $V0 performance.read-ahead off
+TEST $CLI volume heal $V0 disable
+TEST $CLI volume start $V0
+
+#Disable all caching
+TEST glusterfs --direct-io-mode=yes --entry-timeout=0 --attribute-timeout=0 -s $H0 --volfile-id $V0 $M0
+EXPECT_WITHIN $CHILD_UP_TIMEOUT "6" ec_child_up_count $V0 0
+
+TEST dd if=/dev/urandom of=$M0/1 bs=1M count=4
+md5=$(md5sum $M0/1 | awk '{print $1}')
+
+#TEST the load and latency aware policies are accepted and still read from
+#(num-bricks - redundancy) bricks
+for policy in least-load least-latency load-latency-hybrid; do
+        TEST $CLI volume set $V0 disperse.read-policy $policy
+        EXPECT_WITHIN $CONFIG_UPDATE_TIMEOUT "$policy" mount_get_option_value $M0 $V0-disperse-0 read-policy
+        EXPECT "$md5" echo $(md5sum $M0/1 | awk '{print $1}')
+done
+
+#TEST that a hedged read asks one more brick than needed
+TEST $CLI volume set $V0 disperse.read-policy gfid-hash
+TEST $CLI volume set $V0 disperse.read-hedge-count 1
+EXPECT_WITHIN $CONFIG_UPDATE_TIMEOUT "1" mount_get_option_value $M0 $V0-disperse-0 read-hedge-count
+
+TEST $CLI volume profile $V0 start
+TEST dd if=$M0/1 of=/dev/null bs=1M count=4
+hedged_reads=$($CLI volume profile $V0 info cumulative | grep -w READ | wc -l)
+EXPECT "^5$" echo $hedged_reads
+EXPECT "$md5" echo $(md5sum $M0/1 | awk '{print $1}')
+
+#TEST that hedging is capped by the bricks that are up
+TEST kill_brick $V0 $H0 $B0/${V0}0
+TEST $CLI volume set $V0 disperse.read-hedge-count 2
+EXPECT_WITHIN $CONFIG_UPDATE_TIMEOUT "2" mount_get_option_value $M0 $V0-disperse-0 read-hedge-count
+EXPECT "$md5" echo $(md5sum $M0/1 | awk '{print $1}')
+
+cleanup;
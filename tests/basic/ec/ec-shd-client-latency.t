@@ -0,0 +1,87 @@
+#!/bin/bash
+#Test that the self-heal daemon of a disperse volume backs off while the
+#clients of the bricks wait longer than the client latency target, heals at
+#full speed again once they are gone, never runs more heals than
+#shd-max-threads and reports what it did in its statedump.
+
+. $(dirname $0)/../../include.rc
+. $(dirname $0)/../../volume.rc
+
+TESTS_EXPECTED_IN_LOOP=2
+
+LOAD=$B0/client-load
+
+#Rewrites a file with synchronous writes for as long as $LOAD exists
+function client_load {
+        while [ -f $LOAD ]; do
+                dd if=/dev/zero of=$M0/load$1 bs=1M count=8 oflag=sync conv=notrunc 2>/dev/null
+        done
+}
+
+function brick_load_above {
+        local load=$(get_value_from_brick_statedump $V0 $H0 $B0/${V0}0 client_load_usec)
+        [ "${load:-0}" -gt $1 ] && echo "Y" || echo "N"
+}
+
+#Crawls the indices again and prints the sum of the heal limits
+function heal_limit_sum {
+        $CLI volume heal $V0 >/dev/null
+        get_shd_statedump_sum $V0 'child\[[0-9]*\]\.shd-heal-limit'
+}
+
+cleanup;
+
+TEST glusterd
+TEST pidof glusterd
+TEST $CLI volume create $V0 disperse 3 redundancy 1 $H0:$B0/${V0}{0..2}
+TEST $CLI volume set $V0 disperse.shd-max-threads 4
+TEST $CLI volume set $V0 disperse.shd-client-latency-target 1
+TEST ! $CLI volume set $V0 disperse.shd-client-latency-target -1
+TEST $CLI volume start $V0
+TEST $GFS --volfile-id=$V0 --volfile-server=$H0 $M0
+EXPECT_WITHIN $CHILD_UP_TIMEOUT "3" ec_child_up_count $V0 0
+
+TEST $CLI volume heal $V0 disable
+TEST kill_brick $V0 $H0 $B0/${V0}2
+EXPECT_WITHIN $CHILD_UP_TIMEOUT "2" ec_child_up_count $V0 0
+for i in {1..100}; do
+        echo $i > $M0/file$i
+done
+
+TEST $CLI volume start $V0 force
+EXPECT_WITHIN $CHILD_UP_TIMEOUT "3" ec_child_up_count $V0 0
+
+#Heal while the clients wait for their writes far longer than 1ms
+TEST touch $LOAD
+for i in {1..4}; do
+        client_load $i &
+done
+EXPECT_WITHIN $PROCESS_UP_TIMEOUT "Y" brick_load_above 1000
+TEST $CLI volume heal $V0 enable
+EXPECT_WITHIN $PROCESS_UP_TIMEOUT "Y" glustershd_up_status
+EXPECT_WITHIN $CHILD_UP_TIMEOUT "3" ec_child_up_count_shd $V0 0
+TEST $CLI volume heal $V0
+EXPECT_WITHIN $HEAL_TIMEOUT "^[1-9][0-9]*$" get_shd_statedump_sum $V0 'child\[[0-9]*\]\.shd-heal-backoffs'
+TEST [ $(get_shd_statedump_sum $V0 'child\[[0-9]*\]\.shd-heal-limit') -lt 12 ]
+EXPECT "^[1-4]$" get_shd_statedump_max $V0 'child\[[0-9]*\]\.shd-heal-limit'
+
+TEST rm -f $LOAD
+wait
+EXPECT_WITHIN $HEAL_TIMEOUT "^0$" get_pending_heal_count $V0
+EXPECT_NOT "^0$" get_shd_statedump_sum $V0 'child\[[0-9]*\]\.shd-heals'
+
+#With the clients gone every healer gets all of its 4 heals back
+EXPECT_WITHIN $PROCESS_UP_TIMEOUT "^0$" get_value_from_brick_statedump $V0 $H0 $B0/${V0}0 client_load_usec
+EXPECT_WITHIN $HEAL_TIMEOUT "^12$" heal_limit_sum
+
+#Read back without one of the bricks which had the data all along.
+TEST kill_brick $V0 $H0 $B0/${V0}0
+EXPECT_WITHIN $UMOUNT_TIMEOUT "Y" force_umount $M0
+TEST $GFS --volfile-id=$V0 --volfile-server=$H0 $M0
+EXPECT_WITHIN $CHILD_UP_TIMEOUT "2" ec_child_up_count $V0 0
+for i in 1 50 100; do
+        EXPECT "^$i$" cat $M0/file$i
+done
+
+EXPECT_WITHIN $UMOUNT_TIMEOUT "Y" force_umount $M0
+cleanup;
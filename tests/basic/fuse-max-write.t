@@ -0,0 +1,38 @@
+#!/bin/bash
+
+. $(dirname $0)/../include.rc
+. $(dirname $0)/../volume.rc
+
+#This script checks that a mount offering 1MB requests to the kernel reads
+#and writes the same data as one that stays at 128KB
+
+cleanup;
+
+TEST glusterd
+TEST pidof glusterd
+TEST $CLI volume create $V0 $H0:$B0/${V0}{0,1}
+TEST $CLI volume start $V0
+
+TEST ! $GFS --volfile-id=/$V0 --volfile-server=$H0 --max-write=64KB $M0
+TEST ! $GFS --volfile-id=/$V0 --volfile-server=$H0 --max-write=2MB $M0
+
+TEST $GFS --volfile-id=/$V0 --volfile-server=$H0 --max-write=1MB $M0
+TEST $GFS --volfile-id=/$V0 --volfile-server=$H0 $M1
+
+TEST dd if=/dev/urandom of=$B0/data bs=1M count=8
+TEST dd if=$B0/data of=$M0/file bs=1M oflag=direct
+TEST dd if=$B0/data of=$M0/file2 bs=1M
+
+md5=$(md5sum < $B0/data | cut -f1 -d' ')
+EXPECT "$md5" echo $(dd if=$M0/file bs=1M iflag=direct 2>/dev/null | md5sum | cut -f1 -d' ')
+EXPECT "$md5" echo $(md5sum < $M1/file2 | cut -f1 -d' ')
+
+TEST mkdir $M0/dir
+TEST touch $M0/dir/f{1..64}
+EXPECT "64" echo $(ls $M0/dir | wc -l)
+
+EXPECT_WITHIN $UMOUNT_TIMEOUT "Y" force_umount $M0
+EXPECT_WITHIN $UMOUNT_TIMEOUT "Y" force_umount $M1
+rm -f $B0/data
+
+cleanup;
@@ -0,0 +1,42 @@
+#!/bin/bash
+
+. $(dirname $0)/../include.rc
+. $(dirname $0)/../volume.rc
+
+#This script checks the 2q cache policy of io-cache and its counters
+
+cleanup;
+
+TEST glusterd
+TEST pidof glusterd
+TEST $CLI volume create $V0 $H0:$B0/${V0}
+TEST $CLI volume set $V0 performance.io-cache on
+TEST $CLI volume set $V0 performance.quick-read off
+TEST $CLI volume set $V0 performance.read-ahead off
+TEST $CLI volume set $V0 performance.io-cache-size 4MB
+TEST $CLI volume set $V0 performance.io-cache-policy 2q
+TEST ! $CLI volume set $V0 performance.io-cache-policy mru
+TEST $CLI volume start $V0
+
+TEST glusterfs --volfile-id=/$V0 --volfile-server=$H0 $M0 --attribute-timeout=0 --entry-timeout=0
+EXPECT "2q" get_mount_statedump_value $V0 $M0 cache_policy
+
+TEST dd if=/dev/urandom of=$M0/small bs=128k count=4
+TEST dd if=/dev/zero of=$M0/large bs=1M count=64
+
+#Reading the small file twice makes its pages hot
+TEST dd if=$M0/small of=/dev/null bs=128k
+TEST dd if=$M0/small of=/dev/null bs=128k
+EXPECT_NOT "0" get_mount_statedump_value $V0 $M0 cache_hit
+EXPECT_NOT "0" get_mount_statedump_value $V0 $M0 promotions
+
+#Streaming a file larger than the cache evicts its own pages only
+TEST dd if=$M0/large of=/dev/null bs=128k
+EXPECT_NOT "0" get_mount_statedump_value $V0 $M0 evictions
+EXPECT_NOT "0" get_mount_statedump_value $V0 $M0 hot_used
+
+TEST $CLI volume set $V0 performance.io-cache-policy lru
+EXPECT_WITHIN $CONFIG_UPDATE_TIMEOUT "lru" get_mount_statedump_value $V0 $M0 cache_policy
+
+EXPECT_WITHIN $UMOUNT_TIMEOUT "Y" force_umount $M0
+cleanup
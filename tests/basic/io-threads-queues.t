@@ -0,0 +1,55 @@
+#!/bin/bash
+
+. $(dirname $0)/../include.rc
+. $(dirname $0)/../volume.rc
+
+#This script checks that io-threads spreads the requests over one queue per
+#worker, that the workers of the other queues steal from a busy one, and that
+#it keeps serving them when the thread count changes
+
+#Prints how many worker queues report a non-zero value of $1, and the sum
+#of it over all of them
+function iot_queue_field {
+        local field=$1
+        local statedump=$(generate_brick_statedump $V0 $H0 $B0/${V0}0)
+        grep "^worker_queue\[" $statedump | grep -o "$field=[0-9]*" | \
+                cut -f2 -d'=' | awk '$1 > 0 {n++; s+=$1} END {print n+0, s+0}'
+        rm -f $statedump
+}
+
+cleanup;
+
+TEST glusterd
+TEST pidof glusterd
+TEST $CLI volume create $V0 $H0:$B0/${V0}0
+TEST $CLI volume set $V0 performance.io-thread-count 4
+TEST $CLI volume start $V0
+
+TEST $GFS --volfile-id=/$V0 --volfile-server=$H0 $M0
+
+EXPECT "4" get_value_from_brick_statedump $V0 $H0 $B0/${V0}0 worker_queues
+
+#All the requests of the only client go to one queue, the workers bound to
+#the others can only serve them by stealing
+for i in {1..16}; do
+        dd if=/dev/zero of=$M0/file$i bs=64k count=64 oflag=sync 2>/dev/null &
+done
+wait
+TEST [ "$(cat $M0/file{1..16} | wc -c)" = "$((16 * 64 * 65536))" ]
+served=($(iot_queue_field served))
+stolen=($(iot_queue_field stolen))
+TEST [ ${served[0]} -gt 1 ]
+TEST [ ${stolen[0]} -gt 0 ]
+TEST [ ${stolen[1]} -lt ${served[1]} ]
+
+#More workers than queues share them
+TEST $CLI volume set $V0 performance.io-thread-count 8
+for i in {1..16}; do
+        cat $M0/file$i > /dev/null &
+done
+wait
+TEST rm -f $M0/file{1..16}
+
+EXPECT_WITHIN $UMOUNT_TIMEOUT "Y" force_umount $M0
+
+cleanup
@@ -0,0 +1,46 @@
+#!/bin/bash
+
+. $(dirname $0)/../../include.rc
+. $(dirname $0)/../../volume.rc
+
+#This script checks that md-cache takes a metadata lease on a directory, and
+#that a change made on another mount recalls it and is seen right away
+
+cleanup;
+
+TEST glusterd
+TEST pidof glusterd
+TEST $CLI volume create $V0 $H0:$B0/${V0}{0,1}
+TEST $CLI volume set $V0 features.leases on
+TEST $CLI volume set $V0 performance.md-cache-timeout 600
+TEST $CLI volume set $V0 performance.xattr-cache-list "user.*"
+TEST $CLI volume set $V0 performance.md-cache-leases on
+TEST $CLI volume start $V0
+
+TEST glusterfs --volfile-id=/$V0 --volfile-server=$H0 $M0 --attribute-timeout=0 --entry-timeout=0
+TEST glusterfs --volfile-id=/$V0 --volfile-server=$H0 $M1 --attribute-timeout=0 --entry-timeout=0
+
+TEST mkdir $M0/dir
+TEST setfattr -n user.attr -v abc $M0/dir
+
+#The second lookup of the directory asks for the lease, the third one caches
+#the xattrs under it
+TEST stat $M1/dir
+TEST stat $M1/dir
+EXPECT_WITHIN 10 "1" get_mount_statedump_value $V0 $M1 leases_held
+EXPECT "abc" echo $(getfattr --only-values -n user.attr $M1/dir 2>/dev/null)
+
+#Without the recall the cached value would be served for 600 seconds
+TEST setfattr -n user.attr -v xyz $M0/dir
+EXPECT_NOT "0" get_mount_statedump_value $V0 $M1 lease_recalls_received
+EXPECT "xyz" echo $(getfattr --only-values -n user.attr $M1/dir 2>/dev/null)
+
+#The lease goes away with the directory
+TEST stat $M1/dir
+TEST rmdir $M1/dir
+EXPECT "0" get_mount_statedump_value $V0 $M1 leases_held
+
+TEST $CLI volume set $V0 performance.md-cache-leases off
+EXPECT 'off' volinfo_field $V0 'performance.md-cache-leases'
+
+cleanup
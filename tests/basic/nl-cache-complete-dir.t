@@ -0,0 +1,51 @@
+#!/bin/bash
+
+. $(dirname $0)/../include.rc
+. $(dirname $0)/../volume.rc
+
+#This script checks that nl-cache answers the lookups of absent names in a
+#directory read in full, and still finds the names created afterwards
+
+cleanup;
+
+TEST glusterd
+TEST pidof glusterd
+TEST $CLI volume create $V0 $H0:$B0/${V0}{0,1}
+TEST $CLI volume set $V0 group nl-cache
+TEST $CLI volume set $V0 performance.nl-cache-complete-dir on
+TEST ! $CLI volume set $V0 performance.nl-cache-filter-bits 2
+TEST $CLI volume set $V0 performance.nl-cache-filter-bits 12
+TEST $CLI volume start $V0
+
+TEST glusterfs --volfile-id=/$V0 --volfile-server=$H0 $M0 --entry-timeout=0 --negative-timeout=0
+TEST glusterfs --volfile-id=/$V0 --volfile-server=$H0 $M1 --entry-timeout=0 --negative-timeout=0
+
+TEST mkdir $M1/dir
+for i in {1..200}; do echo > $M1/dir/file$i; done
+
+TEST ls $M0/dir
+EXPECT_NOT "0" get_mount_statedump_value $V0 $M0 complete_listings
+
+for i in {1..20}; do ls $M0/dir/absent$i 2>/dev/null; done
+EXPECT_NOT "0" get_mount_statedump_value $V0 $M0 names_filter_hit_count
+TEST ls $M0/dir/file100
+
+#Names created by this client and by the other one are found
+TEST touch $M0/dir/new0
+TEST ls $M0/dir/new0
+TEST touch $M1/dir/new1
+EXPECT_WITHIN $MDC_TIMEOUT "Y" path_exists $M0/dir/new1
+
+#A new directory is known to be empty
+TEST mkdir $M0/dir2
+TEST ! ls $M0/dir2/absent
+TEST touch $M0/dir2/file
+TEST ls $M0/dir2/file
+
+TEST $CLI volume set $V0 performance.nl-cache-complete-dir off
+TEST ls $M0/dir/file1
+
+EXPECT_WITHIN $UMOUNT_TIMEOUT "Y" force_umount $M1
+EXPECT_WITHIN $UMOUNT_TIMEOUT "Y" force_umount $M0
+
+cleanup
@@ -0,0 +1,135 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <pthread.h>
+#include <glusterfs/api/glfs.h>
+#include <glusterfs/api/glfs-handles.h>
+
+#define READ_SIZE (1024 * 1024)
+#define READ_COUNT 16
+#define ROUNDS 8
+
+static pthread_mutex_t lock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t cond = PTHREAD_COND_INITIALIZER;
+static int pending = 0;
+static int failed = 0;
+
+static void
+read_cbk(glfs_fd_t *fd, ssize_t ret, struct glfs_stat *prestat,
+         struct glfs_stat *poststat, void *data)
+{
+    pthread_mutex_lock(&lock);
+    if (ret != READ_SIZE) {
+        fprintf(stderr, "glfs_pread_async: returned %zd\n", ret);
+        failed = 1;
+    }
+    if (--pending == 0)
+        pthread_cond_signal(&cond);
+    pthread_mutex_unlock(&lock);
+}
+
+int
+main(int argc, char *argv[])
+{
+    glfs_t *fs = NULL;
+    glfs_fd_t *fd = NULL;
+    char *bufs[READ_COUNT] = {
+        NULL,
+    };
+    char small[4096];
+    int ret = 1;
+    int round = 0;
+    int i = 0;
+
+    if (argc != 5) {
+        fprintf(stderr, "Syntax: %s <host> <volname> <file-path> <log-file>\n",
+                argv[0]);
+        return 1;
+    }
+
+    fs = glfs_new(argv[2]);
+    if (!fs) {
+        fprintf(stderr, "glfs_new: returned NULL\n");
+        return 1;
+    }
+
+    ret = glfs_set_volfile_server(fs, "tcp", argv[1], 24007);
+    if (ret != 0) {
+        fprintf(stderr, "glfs_set_volfile_server: returned %d\n", ret);
+        goto out;
+    }
+    ret = glfs_set_logging(fs, argv[4], 7);
+    if (ret != 0) {
+        fprintf(stderr, "glfs_set_logging: returned %d\n", ret);
+        goto out;
+    }
+    ret = glfs_init(fs);
+    if (ret != 0) {
+        fprintf(stderr, "glfs_init: returned %d\n", ret);
+        goto out;
+    }
+
+    fd = glfs_open(fs, argv[3], O_RDONLY);
+    if (fd == NULL) {
+        fprintf(stderr, "glfs_open: returned NULL\n");
+        ret = 1;
+        goto out;
+    }
+
+    for (i = 0; i < READ_COUNT; i++) {
+        bufs[i] = malloc(READ_SIZE);
+        if (!bufs[i]) {
+            ret = 1;
+            goto out;
+        }
+    }
+
+    /* enough 1MB reads in flight at once for the brick to map more
+     * arenas, which are purged again once the reads are done */
+    for (round = 0; round < ROUNDS; round++) {
+        pthread_mutex_lock(&lock);
+        pending = READ_COUNT;
+        pthread_mutex_unlock(&lock);
+
+        for (i = 0; i < READ_COUNT; i++) {
+            ret = glfs_pread_async(fd, bufs[i], READ_SIZE,
+                                   (off_t)i * READ_SIZE, 0, read_cbk, NULL);
+            if (ret != 0) {
+                fprintf(stderr, "glfs_pread_async: returned %d\n", ret);
+                pthread_mutex_lock(&lock);
+                pending -= READ_COUNT - i;
+                failed = 1;
+                pthread_mutex_unlock(&lock);
+                break;
+            }
+        }
+
+        pthread_mutex_lock(&lock);
+        while (pending > 0)
+            pthread_cond_wait(&cond, &lock);
+        pthread_mutex_unlock(&lock);
+
+        if (failed) {
+            ret = 1;
+            goto out;
+        }
+    }
+
+    /* one more read brings the fixed buffer table of the brick up to date
+     * with the purged arenas */
+    ret = glfs_pread(fd, small, sizeof(small), 0, 0, NULL);
+    if (ret != sizeof(small)) {
+        fprintf(stderr, "glfs_pread: returned %d\n", ret);
+        ret = 1;
+        goto out;
+    }
+
+    ret = 0;
+out:
+    if (fd)
+        glfs_close(fd);
+    for (i = 0; i < READ_COUNT; i++)
+        free(bufs[i]);
+    glfs_fini(fs);
+
+    return ret;
+}
@@ -0,0 +1,39 @@
+#!/bin/bash
+#Test that reads on a brick with linux-io_uring on use the iobuf arenas
+#registered as fixed buffers, and that the arenas purged by the iobuf pool
+#are released from the ring.
+
+. $(dirname $0)/../../include.rc
+. $(dirname $0)/../../volume.rc
+
+cleanup;
+
+TEST glusterd
+TEST pidof glusterd
+TEST $CLI volume create $V0 $H0:$B0/${V0}0
+TEST $CLI volume set $V0 storage.linux-io_uring on
+TEST $CLI volume set $V0 performance.read-ahead off
+TEST $CLI volume set $V0 performance.io-cache off
+TEST $CLI volume set $V0 performance.quick-read off
+TEST $CLI volume set $V0 performance.open-behind off
+TEST $CLI volume start $V0
+
+#The kernel or liburing may not support registered buffers.
+if [ -z "$(get_value_from_brick_statedump $V0 $H0 $B0/${V0}0 uring_fixed_ios)" ]; then
+        SKIP_TESTS
+        cleanup;
+        exit 0
+fi
+
+TEST $GFS --volfile-id=$V0 --volfile-server=$H0 $M0
+TEST dd if=/dev/urandom of=$M0/file bs=1M count=16
+EXPECT_WITHIN $UMOUNT_TIMEOUT "Y" force_umount $M0
+
+TEST build_tester $(dirname $0)/io-uring-fixed-buffers.c -lgfapi -lpthread -Wall -O2
+TEST $(dirname $0)/io-uring-fixed-buffers $H0 $V0 /file `gluster --print-logdir`/glfs-$V0.log
+
+EXPECT_NOT "^0$" get_value_from_brick_statedump $V0 $H0 $B0/${V0}0 uring_fixed_ios
+EXPECT_NOT "^0$" get_value_from_brick_statedump $V0 $H0 $B0/${V0}0 uring_fixed_bufs_released
+
+cleanup_tester $(dirname $0)/io-uring-fixed-buffers
+cleanup;
@@ -0,0 +1,60 @@
+#!/bin/bash
+#Test that the entry and xattr fops a brick with linux-io_uring on runs
+#through the ring keep the gfid handles, and the xattrs set by path, as the
+#synchronous fops do.
+
+. $(dirname $0)/../../include.rc
+. $(dirname $0)/../../volume.rc
+
+function get_user_xattr {
+        getfattr --only-values -n user.test $1 2>/dev/null
+}
+
+cleanup;
+
+TEST glusterd
+TEST pidof glusterd
+TEST $CLI volume create $V0 $H0:$B0/${V0}0
+TEST $CLI volume set $V0 storage.linux-io_uring on
+TEST $CLI volume set $V0 performance.md-cache-timeout 0
+TEST $CLI volume set $V0 performance.stat-prefetch off
+TEST $CLI volume start $V0
+TEST $GFS --volfile-id=$V0 --volfile-server=$H0 $M0
+
+#A new directory gets its gfid and the symlink handle to its entry
+TEST mkdir $M0/dir
+dir_handle=$(gf_get_gfid_backend_file_path $B0/${V0}0 dir)
+TEST [ -L $dir_handle ]
+
+#Renaming it points the handle at the new entry
+TEST mv $M0/dir $M0/dir2
+EXPECT "^../../00/00/00000000-0000-0000-0000-000000000001/dir2$" readlink $dir_handle
+
+#xattrs set and read by path
+TEST touch $M0/dir2/file
+TEST setfattr -n user.test -v value $M0/dir2/file
+EXPECT "^value$" get_user_xattr $M0/dir2/file
+EXPECT "^value$" get_user_xattr $B0/${V0}0/dir2/file
+
+#Renaming over a file drops the handle of the file replaced
+TEST touch $M0/dir2/victim
+victim_handle=$(gf_get_gfid_backend_file_path $B0/${V0}0 dir2/victim)
+file_handle=$(gf_get_gfid_backend_file_path $B0/${V0}0 dir2/file)
+TEST mv $M0/dir2/file $M0/dir2/victim
+TEST ! stat $victim_handle
+TEST stat $file_handle
+EXPECT "^value$" get_user_xattr $M0/dir2/victim
+
+#The handle of a hard linked file goes with its last link
+TEST ln $M0/dir2/victim $M0/dir2/link
+TEST rm -f $M0/dir2/victim
+TEST stat $file_handle
+EXPECT "^value$" get_user_xattr $M0/dir2/link
+TEST rm -f $M0/dir2/link
+TEST ! stat $file_handle
+
+TEST rmdir $M0/dir2
+TEST ! stat $dir_handle
+
+EXPECT_WITHIN $UMOUNT_TIMEOUT "Y" force_umount $M0
+cleanup;
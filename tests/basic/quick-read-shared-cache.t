@@ -0,0 +1,54 @@
+#!/bin/bash
+
+. $(dirname $0)/../include.rc
+. $(dirname $0)/../volume.rc
+
+#This script checks that two mounts of a volume share the content cached by
+#quick-read, that a write on one of them is seen by the other, and that the
+#segment goes away with the last process using it, however the others ended
+
+function shm_exists {
+        [ -e $SHM ] && echo "Y" || echo "N"
+}
+
+cleanup;
+
+TEST glusterd
+TEST pidof glusterd
+TEST $CLI volume create $V0 $H0:$B0/${V0}{0,1}
+TEST $CLI volume set $V0 performance.quick-read on
+TEST $CLI volume set $V0 performance.quick-read-shared-cache on
+TEST ! $CLI volume set $V0 performance.quick-read-shared-cache-size 1KB
+TEST $CLI volume set $V0 performance.quick-read-shared-cache-size 8MB
+TEST $CLI volume start $V0
+SHM=/dev/shm/glusterfs-qr-$(volinfo_field $V0 'Volume ID')
+
+TEST glusterfs --volfile-id=/$V0 --volfile-server=$H0 $M0 --attribute-timeout=0 --entry-timeout=0
+TEST glusterfs --volfile-id=/$V0 --volfile-server=$H0 $M1 --attribute-timeout=0 --entry-timeout=0
+TEST [ -f $SHM ]
+
+echo "test-message0" > $M0/file
+EXPECT "test-message0" cat $M0/file
+EXPECT "test-message0" cat $M1/file
+EXPECT_NOT "0" get_mount_statedump_value $V0 $M1 shared-cache-hit
+
+#The other mount finds out through the changed mtime
+echo "test-message1" > $M0/file
+EXPECT "test-message1" cat $M1/file
+
+EXPECT_WITHIN $UMOUNT_TIMEOUT "Y" force_umount $M1
+TEST [ -f $SHM ]
+EXPECT_WITHIN $UMOUNT_TIMEOUT "Y" force_umount $M0
+EXPECT_WITHIN $UMOUNT_TIMEOUT "N" shm_exists
+
+#A client killed outright does not keep the segment alive
+TEST glusterfs --volfile-id=/$V0 --volfile-server=$H0 $M0 --attribute-timeout=0 --entry-timeout=0
+TEST glusterfs --volfile-id=/$V0 --volfile-server=$H0 $M1 --attribute-timeout=0 --entry-timeout=0
+EXPECT "test-message1" cat $M1/file
+TEST kill -9 $(get_mount_process_pid $V0 $M1)
+EXPECT_WITHIN $UMOUNT_TIMEOUT "Y" force_umount $M1
+EXPECT "test-message1" cat $M0/file
+EXPECT_WITHIN $UMOUNT_TIMEOUT "Y" force_umount $M0
+EXPECT_WITHIN $UMOUNT_TIMEOUT "N" shm_exists
+
+cleanup
@@ -0,0 +1,46 @@
+#!/bin/bash
+
+. $(dirname $0)/../include.rc
+. $(dirname $0)/../volume.rc
+
+#This script checks the stream detection of read-ahead and its counters
+
+#Reads 4KB every 1MB of the file, through a single fd
+function strided_read {
+        local i
+        exec 5<$1
+        for i in $(seq 1 32); do
+                dd of=/dev/null bs=4k count=1 skip=255 <&5 2>/dev/null || return 1
+        done
+        exec 5<&-
+}
+
+cleanup;
+
+TEST glusterd
+TEST pidof glusterd
+TEST $CLI volume create $V0 $H0:$B0/${V0}
+TEST $CLI volume set $V0 performance.read-ahead on
+TEST $CLI volume set $V0 performance.io-cache off
+TEST $CLI volume set $V0 performance.quick-read off
+TEST $CLI volume start $V0
+
+TEST glusterfs --volfile-id=/$V0 --volfile-server=$H0 $M0 --attribute-timeout=0 --entry-timeout=0 --direct-io-mode=yes
+
+TEST dd if=/dev/urandom of=$M0/file bs=1M count=40
+EXPECT "0" get_mount_statedump_value $V0 $M0 prefetched
+
+#Sequential reads are prefetched, and the prefetched pages get read
+TEST dd if=$M0/file of=/dev/null bs=64k count=64
+EXPECT_NOT "0" get_mount_statedump_value $V0 $M0 prefetched
+EXPECT_NOT "0" get_mount_statedump_value $V0 $M0 prefetch_hits
+
+#So are strided reads
+prefetched=$(get_mount_statedump_value $V0 $M0 prefetched)
+hits=$(get_mount_statedump_value $V0 $M0 prefetch_hits)
+TEST strided_read $M0/file
+TEST [ $(get_mount_statedump_value $V0 $M0 prefetched) -gt $prefetched ]
+TEST [ $(get_mount_statedump_value $V0 $M0 prefetch_hits) -gt $hits ]
+
+EXPECT_WITHIN $UMOUNT_TIMEOUT "Y" force_umount $M0
+cleanup
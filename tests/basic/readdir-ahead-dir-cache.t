@@ -0,0 +1,51 @@
+#!/bin/bash
+
+. $(dirname $0)/../include.rc
+. $(dirname $0)/../volume.rc
+
+#This script checks that readdir-ahead serves a directory read again from the
+#listing it kept, and that an entry created by another client shows up in it
+
+function count_entries {
+        ls $1 | wc -l
+}
+
+cleanup;
+
+TEST glusterd
+TEST pidof glusterd
+TEST $CLI volume create $V0 $H0:$B0/${V0}{0,1}
+TEST $CLI volume set $V0 performance.readdir-ahead on
+TEST $CLI volume set $V0 performance.rda-dir-cache on
+TEST ! $CLI volume set $V0 performance.rda-dir-cache-timeout 1000
+TEST $CLI volume set $V0 performance.rda-dir-cache-timeout 600
+TEST $CLI volume set $V0 features.cache-invalidation on
+TEST $CLI volume set $V0 features.cache-invalidation-timeout 600
+TEST $CLI volume start $V0
+
+TEST glusterfs --volfile-id=/$V0 --volfile-server=$H0 $M0 --attribute-timeout=0 --entry-timeout=0
+TEST glusterfs --volfile-id=/$V0 --volfile-server=$H0 $M1 --attribute-timeout=0 --entry-timeout=0
+
+TEST mkdir $M0/dir
+TEST touch $M0/dir/file{1..10}
+EXPECT "10" count_entries $M0/dir
+EXPECT "10" count_entries $M0/dir
+EXPECT_NOT "0" get_mount_statedump_value $V0 $M0 dir_cache_hits
+
+#An entry created on this mount drops the listing
+TEST touch $M0/dir/file11
+EXPECT "11" count_entries $M0/dir
+
+#One created on the other mount is notified by upcall
+TEST touch $M1/dir/file12
+EXPECT_WITHIN $MDC_TIMEOUT "12" count_entries $M0/dir
+TEST rm -f $M1/dir/file1
+EXPECT_WITHIN $MDC_TIMEOUT "11" count_entries $M0/dir
+
+TEST $CLI volume set $V0 performance.rda-dir-cache off
+EXPECT_WITHIN $CONFIG_UPDATE_TIMEOUT "0" get_mount_statedump_value $V0 $M0 dir_cache_listings
+
+EXPECT_WITHIN $UMOUNT_TIMEOUT "Y" force_umount $M1
+EXPECT_WITHIN $UMOUNT_TIMEOUT "Y" force_umount $M0
+
+cleanup
@@ -0,0 +1,46 @@
+#!/bin/bash
+
+. $(dirname $0)/../include.rc
+. $(dirname $0)/../volume.rc
+
+#This script checks the adaptive window of write-behind and its global
+#limit on dirty data
+
+cleanup;
+
+TEST glusterd
+TEST pidof glusterd
+TEST $CLI volume create $V0 $H0:$B0/${V0}{0,1}
+TEST $CLI volume set $V0 performance.write-behind on
+TEST $CLI volume set $V0 performance.write-behind-adaptive-window on
+TEST $CLI volume set $V0 performance.write-behind-max-dirty-size 128KB
+TEST ! $CLI volume set $V0 performance.write-behind-adaptive-window-max 1KB
+TEST $CLI volume start $V0
+
+TEST glusterfs --volfile-id=/$V0 --volfile-server=$H0 $M0 --attribute-timeout=0 --entry-timeout=0
+EXPECT "1" get_mount_statedump_value $V0 $M0 adaptive_window
+
+#Writes to several files share the 128KB of dirty data allowed
+dd if=/dev/zero of=$M0/file1 bs=128k count=256 2>/dev/null &
+TEST dd if=/dev/zero of=$M0/file2 bs=128k count=256
+wait
+EXPECT_NOT "0" get_mount_statedump_value $V0 $M0 throttled_writes
+EXPECT_WITHIN $CONFIG_UPDATE_TIMEOUT "0" get_mount_statedump_value $V0 $M0 dirty_size
+
+TEST cmp <(dd if=/dev/zero bs=128k count=256 2>/dev/null) $M0/file1
+TEST cmp <(dd if=/dev/zero bs=128k count=256 2>/dev/null) $M0/file2
+
+#Small writes held back by the limit must not wait for more to aggregate
+#with, even without trickling-writes
+TEST $CLI volume set $V0 performance.write-behind-trickling-writes off
+dd if=/dev/zero of=$M0/file3 bs=4k count=2048 2>/dev/null &
+TEST timeout 120 dd if=/dev/zero of=$M0/file4 bs=4k count=2048
+wait
+TEST cmp <(dd if=/dev/zero bs=4k count=2048 2>/dev/null) $M0/file3
+TEST cmp <(dd if=/dev/zero bs=4k count=2048 2>/dev/null) $M0/file4
+
+TEST $CLI volume set $V0 performance.write-behind-adaptive-window off
+EXPECT_WITHIN $CONFIG_UPDATE_TIMEOUT "0" get_mount_statedump_value $V0 $M0 adaptive_window
+
+EXPECT_WITHIN $UMOUNT_TIMEOUT "Y" force_umount $M0
+cleanup
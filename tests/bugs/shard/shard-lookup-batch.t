@@ -0,0 +1,80 @@
+#!/bin/bash
+#Test that shards of a cold file are resolved correctly when their lookups are
+#batched, both when the graph below settles the batch and when it falls back
+#to single lookups.
+
+. $(dirname $0)/../../include.rc
+. $(dirname $0)/../../volume.rc
+
+function shard_value {
+        get_mount_statedump_value $V0 $M0 $1
+}
+
+cleanup
+
+TEST glusterd
+TEST pidof glusterd
+TEST $CLI volume create $V0 replica 3 $H0:$B0/${V0}{0..5}
+TEST $CLI volume set $V0 features.shard on
+TEST $CLI volume set $V0 features.shard-block-size 4MB
+TEST $CLI volume set $V0 performance.quick-read off
+TEST $CLI volume set $V0 performance.io-cache off
+TEST $CLI volume set $V0 performance.read-ahead off
+TEST $CLI volume start $V0
+
+TEST $GFS --volfile-id=$V0 --volfile-server=$H0 $M0
+TEST dd if=/dev/urandom of=$M0/file bs=1M count=42
+md5=$(md5sum $M0/file | awk '{print $1}')
+md5_4m=$(head -c 4M $M0/file | md5sum | awk '{print $1}')
+TEST cp $M0/file $M0/file1
+TEST cp $M0/file $M0/file2
+TEST cp $M0/file $M0/file3
+EXPECT "^40$" echo $(find $B0/${V0}{0,3}/.shard -type f | wc -l)
+
+#Cold read, the shards are resolved as the reads reach them.
+EXPECT_WITHIN $UMOUNT_TIMEOUT "Y" force_umount $M0
+TEST $GFS --volfile-id=$V0 --volfile-server=$H0 $M0
+EXPECT "$md5" echo $(md5sum $M0/file | awk '{print $1}')
+
+#Holes are reported as missing shards, not as errors.
+TEST truncate -s 80M $M0/file
+EXPECT_WITHIN $UMOUNT_TIMEOUT "Y" force_umount $M0
+TEST $GFS --volfile-id=$V0 --volfile-server=$H0 $M0
+EXPECT "$md5" echo $(head -c 42M $M0/file | md5sum | awk '{print $1}')
+EXPECT "0" echo $(tail -c 38M $M0/file | tr -d '\0' | wc -c)
+
+#Truncating a cold file resolves all the shards past the new size at once,
+#in one batch the replicas settle.
+EXPECT_WITHIN $UMOUNT_TIMEOUT "Y" force_umount $M0
+TEST $GFS --volfile-id=$V0 --volfile-server=$H0 $M0
+TEST truncate -s 4M $M0/file1
+EXPECT "$md5_4m" echo $(md5sum $M0/file1 | awk '{print $1}')
+EXPECT_NOT "^0$" shard_value lookup-batches
+EXPECT "^10$" shard_value lookup-batch-shards
+EXPECT "^0$" shard_value lookup-batch-fallbacks
+
+#With a brick down the replicas cannot settle the batch and its shards are
+#looked up on their own.
+TEST kill_brick $V0 $H0 $B0/${V0}0
+EXPECT_WITHIN $UMOUNT_TIMEOUT "Y" force_umount $M0
+TEST $GFS --volfile-id=$V0 --volfile-server=$H0 $M0
+TEST truncate -s 4M $M0/file2
+EXPECT "$md5_4m" echo $(md5sum $M0/file2 | awk '{print $1}')
+EXPECT_NOT "^0$" shard_value lookup-batches
+EXPECT_NOT "^0$" shard_value lookup-batch-fallbacks
+TEST $CLI volume start $V0 force
+EXPECT_WITHIN $PROCESS_UP_TIMEOUT "1" afr_child_up_status $V0 0
+
+#Batching can be switched off.
+TEST $CLI volume set $V0 features.shard-lookup-batch off
+EXPECT_WITHIN $UMOUNT_TIMEOUT "Y" force_umount $M0
+TEST $GFS --volfile-id=$V0 --volfile-server=$H0 $M0
+TEST truncate -s 4M $M0/file3
+EXPECT "$md5_4m" echo $(md5sum $M0/file3 | awk '{print $1}')
+EXPECT "^0$" shard_value lookup-batches
+
+EXPECT_WITHIN $UMOUNT_TIMEOUT "Y" force_umount $M0
+TEST $CLI volume stop $V0
+TEST $CLI volume delete $V0
+
+cleanup
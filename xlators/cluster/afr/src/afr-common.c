@@ -2462,6 +2462,11 @@ afr_local_transaction_cleanup(afr_local_t *local, xlator_t *this)
         GF_FREE(local->transaction.changelog_xdata);
     }
 
+    if (local->transaction.compound_args) {
+        compound_args_cleanup(local->transaction.compound_args);
+        local->transaction.compound_args = NULL;
+    }
+
     GF_FREE(local->transaction.failed_subvols);
 
     GF_FREE(local->transaction.basename);
@@ -2576,6 +2581,7 @@ afr_handle_inconsistent_fop(call_frame_t *frame, int32_t *op_ret,
     local = frame->local;
     switch (local->op) {
         case GF_FOP_LOOKUP:
+        case GF_FOP_COMPOUND:
         case GF_FOP_INODELK:
         case GF_FOP_FINODELK:
         case GF_FOP_ENTRYLK:
@@ -2604,6 +2610,7 @@ void
 afr_local_cleanup(afr_local_t *local, xlator_t *this)
 {
     afr_private_t *priv = NULL;
+    int i = 0;
 
     if (!local)
         return;
@@ -2738,6 +2745,16 @@ afr_local_cleanup(afr_local_t *local, xlator_t *this)
             dict_unref(local->cont.entrylk.xdata);
     }
 
+    { /* compound */
+        compound_args_cleanup(local->cont.compound.args);
+        compound_args_cbk_cleanup(local->cont.compound.rsp);
+        if (local->cont.compound.replies) {
+            for (i = 0; i < priv->child_count; i++)
+                compound_args_cbk_cleanup(local->cont.compound.replies[i]);
+            GF_FREE(local->cont.compound.replies);
+        }
+    }
+
     GF_FREE(local->need_open);
 
     if (local->xdata_req)
@@ -4058,6 +4075,231 @@ out:
     return 0;
 }
 
+/*
+ * afr_compound()
+ *
+ * Batched lookups. The lookups are sent to all the children as one compound
+ * and an entry is answered here only when every child resolves it the same
+ * way: missing everywhere, or the same regular file without any pending or
+ * dirty data and metadata changelog. Everything else (directories, entries
+ * that need heal, partial replies) needs the full afr_lookup() treatment and
+ * is returned with ECANCELED for the caller to look it up again.
+ */
+
+static void
+afr_compound_done(call_frame_t *frame, xlator_t *this)
+{
+    afr_private_t *priv = NULL;
+    afr_local_t *local = NULL;
+    compound_args_t *args = NULL;
+    default_args_cbk_t *reply = NULL;
+    default_args_cbk_t *first = NULL;
+    unsigned char *readable = NULL;
+    inode_t *inode = NULL;
+    gf_boolean_t clean = _gf_true;
+    int missing = 0;
+    int found = 0;
+    int i = 0;
+    int j = 0;
+
+    priv = this->private;
+    local = frame->local;
+    args = local->cont.compound.args;
+
+    readable = alloca0(priv->child_count);
+    memset(readable, 1, priv->child_count);
+
+    for (i = 0; i < args->fop_length; i++) {
+        inode = args->req_list[i].loc.inode;
+        first = NULL;
+        clean = _gf_true;
+        missing = 0;
+        found = 0;
+
+        for (j = 0; j < priv->child_count; j++) {
+            reply = &local->cont.compound.replies[j]->rsp_list[i];
+            if (reply->op_ret == -1) {
+                if (reply->op_errno == ENOENT)
+                    missing++;
+                continue;
+            }
+
+            found++;
+            if (!reply->xdata || !IA_ISREG(reply->stat.ia_type) ||
+                afr_is_pending_set(this, reply->xdata, AFR_DATA_TRANSACTION) ||
+                afr_is_pending_set(this, reply->xdata,
+                                   AFR_METADATA_TRANSACTION)) {
+                clean = _gf_false;
+                continue;
+            }
+
+            if (!first) {
+                first = reply;
+                continue;
+            }
+
+            if (gf_uuid_compare(first->stat.ia_gfid, reply->stat.ia_gfid))
+                clean = _gf_false;
+        }
+
+        if (missing == priv->child_count) {
+            local->cont.compound.rsp->rsp_list[i].op_errno = ENOENT;
+            continue;
+        }
+
+        if (found != priv->child_count || !clean)
+            continue;
+
+        afr_inode_read_subvol_set(inode, this, readable, readable,
+                                  local->event_generation);
+        args_lookup_cbk_store(&local->cont.compound.rsp->rsp_list[i], 0, 0,
+                              inode, &first->stat, first->xdata,
+                              &first->postparent);
+    }
+
+    AFR_STACK_UNWIND(compound, frame, 0, 0, local->cont.compound.rsp, NULL);
+}
+
+static int
+afr_compound_cbk(call_frame_t *frame, void *cookie, xlator_t *this,
+                 int32_t op_ret, int32_t op_errno, void *data, dict_t *xdata)
+{
+    afr_local_t *local = NULL;
+    compound_args_cbk_t *args_cbk = data;
+    compound_args_cbk_t *replies = NULL;
+    default_args_cbk_t *reply = NULL;
+    int child_index = (long)cookie;
+    int call_count = 0;
+    int i = 0;
+
+    local = frame->local;
+    replies = local->cont.compound.replies[child_index];
+
+    for (i = 0; args_cbk && i < replies->fop_length; i++) {
+        if (i >= args_cbk->fop_length)
+            break;
+        reply = &args_cbk->rsp_list[i];
+        args_lookup_cbk_store(&replies->rsp_list[i], reply->op_ret,
+                              reply->op_errno, NULL, &reply->stat,
+                              reply->xdata, &reply->postparent);
+    }
+
+    call_count = afr_frame_return(frame);
+    if (call_count == 0)
+        afr_compound_done(frame, this);
+
+    return 0;
+}
+
+int
+afr_compound(call_frame_t *frame, xlator_t *this, void *data, dict_t *xdata)
+{
+    afr_private_t *priv = NULL;
+    afr_local_t *local = NULL;
+    compound_args_t *args = data;
+    loc_t *loc = NULL;
+    dict_t *xattr_req = NULL;
+    int32_t op_errno = ENOTSUP;
+    int i = 0;
+    int j = 0;
+    int ret = 0;
+
+    priv = this->private;
+
+    if (!compound_args_only_fop(args, GF_FOP_LOOKUP) || priv->arbiter_count ||
+        priv->thin_arbiter_count)
+        goto out;
+
+    for (i = 0; i < priv->child_count; i++) {
+        if (!priv->children[i]->fops->compound)
+            goto out;
+    }
+
+    for (i = 0; i < args->fop_length; i++) {
+        loc = &args->req_list[i].loc;
+        if (loc_is_nameless(loc) || !loc->inode ||
+            afr_is_private_directory(priv, loc->parent->gfid, loc->name,
+                                     frame->root->pid))
+            goto out;
+    }
+
+    local = AFR_FRAME_INIT(frame, op_errno);
+    if (!local)
+        goto out;
+
+    /* Replies from a subset of the children cannot settle anything. */
+    if (local->call_count != priv->child_count) {
+        op_errno = ENOTSUP;
+        goto out;
+    }
+
+    local->op = GF_FOP_COMPOUND;
+    local->cont.compound.replies = GF_CALLOC(
+        priv->child_count, sizeof(*local->cont.compound.replies),
+        gf_afr_mt_compound_rsp_t);
+    local->cont.compound.rsp = compound_args_cbk_alloc(args->fop_length,
+                                                       NULL);
+    local->cont.compound.args = compound_fop_alloc(args->fop_length,
+                                                   args->xdata);
+    if (!local->cont.compound.replies || !local->cont.compound.rsp ||
+        !local->cont.compound.args) {
+        op_errno = ENOMEM;
+        goto out;
+    }
+
+    /* A child which does not reply leaves its entries ECANCELED. */
+    for (i = 0; i < priv->child_count; i++) {
+        local->cont.compound.replies[i] = compound_args_cbk_alloc(
+            args->fop_length, NULL);
+        if (!local->cont.compound.replies[i]) {
+            op_errno = ENOMEM;
+            goto out;
+        }
+        for (j = 0; j < args->fop_length; j++) {
+            local->cont.compound.replies[i]->rsp_list[j].op_ret = -1;
+            local->cont.compound.replies[i]->rsp_list[j].op_errno = ECANCELED;
+        }
+    }
+
+    for (i = 0; i < args->fop_length; i++) {
+        local->cont.compound.rsp->enum_list[i] = GF_FOP_LOOKUP;
+        local->cont.compound.rsp->rsp_list[i].op_ret = -1;
+        local->cont.compound.rsp->rsp_list[i].op_errno = ECANCELED;
+
+        if (args->req_list[i].xdata)
+            xattr_req = dict_copy_with_ref(args->req_list[i].xdata, NULL);
+        else
+            xattr_req = dict_new();
+        if (!xattr_req) {
+            op_errno = ENOMEM;
+            goto out;
+        }
+
+        ret = afr_xattr_req_prepare(this, xattr_req);
+        if (ret) {
+            dict_unref(xattr_req);
+            op_errno = -ret;
+            goto out;
+        }
+
+        COMPOUND_PACK_ARGS(lookup, GF_FOP_LOOKUP, local->cont.compound.args,
+                           i, &args->req_list[i].loc, xattr_req);
+        dict_unref(xattr_req);
+    }
+
+    for (i = 0; i < priv->child_count; i++) {
+        STACK_WIND_COOKIE(frame, afr_compound_cbk, (void *)(long)i,
+                          priv->children[i], priv->children[i]->fops->compound,
+                          local->cont.compound.args,
+                          local->cont.compound.args->xdata);
+    }
+
+    return 0;
+out:
+    AFR_STACK_UNWIND(compound, frame, -1, op_errno, NULL, NULL);
+    return 0;
+}
+
 void
 _afr_cleanup_fd_ctx(xlator_t *this, afr_fd_ctx_t *fd_ctx)
 {
@@ -5644,6 +5886,7 @@ int
 afr_priv_dump(xlator_t *this)
 {
     afr_private_t *priv = NULL;
+    struct subvol_healer *healer = NULL;
     char key_prefix[GF_DUMP_MAX_BUF_LEN];
     char key[GF_DUMP_MAX_BUF_LEN];
     int i = 0;
@@ -5669,6 +5912,8 @@ afr_priv_dump(xlator_t *this)
         gf_proc_dump_write(key, "%d", priv->halo_child_up[i]);
     }
     gf_proc_dump_write("data_self_heal", "%d", priv->data_self_heal);
+    gf_proc_dump_write("data_self_heal_region_shift", "%u",
+                       priv->region_shift);
     gf_proc_dump_write("metadata_self_heal", "%d", priv->metadata_self_heal);
     gf_proc_dump_write("entry_self_heal", "%d", priv->entry_self_heal);
     gf_proc_dump_write("read_child", "%d", priv->read_child);
@@ -5689,6 +5934,27 @@ afr_priv_dump(xlator_t *this)
         gf_proc_dump_write("quorum-count", "%d", priv->quorum_count);
     }
     gf_proc_dump_write("up", "%u", afr_has_quorum(priv->child_up, this, NULL));
+    if (priv->shd.iamshd && priv->shd.index_healers) {
+        gf_proc_dump_write("shd-client-latency-target", "%u",
+                           priv->shd.client_latency_target);
+        for (i = 0; i < priv->child_count; i++) {
+            healer = &priv->shd.index_healers[i];
+            if (!healer->local)
+                continue;
+            sprintf(key, "shd_heal_limit[%d]", i);
+            gf_proc_dump_write(key, "%u",
+                               syncop_throttle_limit(&healer->throttle));
+            sprintf(key, "shd_heals_per_min[%d]", i);
+            gf_proc_dump_write(key, "%" PRIu64, healer->throttle.rate);
+            sprintf(key, "shd_heals[%d]", i);
+            gf_proc_dump_write(key, "%" PRId64,
+                               GF_ATOMIC_GET(healer->throttle.done));
+            sprintf(key, "shd_client_latency_usec[%d]", i);
+            gf_proc_dump_write(key, "%" PRIu64, healer->throttle.latency);
+            sprintf(key, "shd_heal_backoffs[%d]", i);
+            gf_proc_dump_write(key, "%" PRIu64, healer->throttle.backoffs);
+        }
+    }
     if (priv->thin_arbiter_count) {
         gf_proc_dump_write("ta_child_up", "%d", priv->ta_child_up);
         gf_proc_dump_write("ta_bad_child_index", "%d",
@@ -6676,10 +6942,15 @@ afr_priv_destroy(afr_private_t *priv)
         for (i = 0; i < child_count; i++)
             GF_FREE(priv->pending_key[i]);
     }
+    if (priv->region_key) {
+        for (i = 0; i < priv->child_count; i++)
+            GF_FREE(priv->region_key[i]);
+    }
 
     GF_FREE(priv->pending_reads);
     GF_FREE(priv->local);
     GF_FREE(priv->pending_key);
+    GF_FREE(priv->region_key);
     GF_FREE(priv->children);
     GF_FREE(priv->anon_inode);
     GF_FREE(priv->child_up);
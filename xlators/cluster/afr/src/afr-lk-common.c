@@ -224,6 +224,13 @@ afr_locked_nodes_count(unsigned char *locked_nodes, int child_count)
     return call_count;
 }
 
+gf_boolean_t
+afr_is_locked_on_child(afr_internal_lock_t *int_lock, int lockee_num,
+                       int child)
+{
+    return !!(int_lock->lockee[lockee_num].locked_nodes[child] & LOCKED_YES);
+}
+
 static void
 afr_log_locks_failure(call_frame_t *frame, char *where, char *what,
                       int op_errno)
@@ -268,6 +275,28 @@ afr_log_locks_failure(call_frame_t *frame, char *where, char *what,
     }
 }
 
+/* Bookkeeping for a lock released on @child_index, either by a plain unlock
+ * or as the last step of a compound post-op. */
+int
+afr_unlock_done_on_child(call_frame_t *frame, xlator_t *this, int child_index,
+                         int lockee_num, int32_t op_ret, int32_t op_errno)
+{
+    afr_local_t *local = frame->local;
+    afr_private_t *priv = this->private;
+    afr_internal_lock_t *int_lock = &local->internal_lock;
+
+    if (op_ret < 0 && op_errno != ENOTCONN && op_errno != EBADFD) {
+        afr_log_locks_failure(frame, priv->children[child_index]->name,
+                              "unlock", op_errno);
+    }
+
+    int_lock->lockee[lockee_num].locked_nodes[child_index] &= LOCKED_NO;
+    if (local->transaction.type == AFR_DATA_TRANSACTION && op_ret != 1)
+        return afr_write_subvol_reset(frame, this);
+
+    return 0;
+}
+
 static int32_t
 afr_unlock_common_cbk(call_frame_t *frame, void *cookie, xlator_t *this,
                       int32_t op_ret, int32_t op_errno, dict_t *xdata)
@@ -286,14 +315,8 @@ afr_unlock_common_cbk(call_frame_t *frame, void *cookie, xlator_t *this,
     lockee_num = (int)((long)cookie) / priv->child_count;
     child_index = (int)((long)cookie) % priv->child_count;
 
-    if (op_ret < 0 && op_errno != ENOTCONN && op_errno != EBADFD) {
-        afr_log_locks_failure(frame, priv->children[child_index]->name,
-                              "unlock", op_errno);
-    }
-
-    int_lock->lockee[lockee_num].locked_nodes[child_index] &= LOCKED_NO;
-    if (local->transaction.type == AFR_DATA_TRANSACTION && op_ret != 1)
-        ret = afr_write_subvol_reset(frame, this);
+    ret = afr_unlock_done_on_child(frame, this, child_index, lockee_num, op_ret,
+                                   op_errno);
 
     LOCK(&frame->lock);
     {
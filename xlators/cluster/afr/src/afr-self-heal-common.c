@@ -582,6 +582,52 @@ err:
     return NULL;
 }
 
+/* Subtract the region maps @subvol was seen with for the sinks in @clear,
+ * in the same xattrop that clears their pending data counters. */
+static int
+afr_selfheal_output_regions(xlator_t *this, dict_t *xattr,
+                            struct afr_reply *replies, int subvol,
+                            unsigned char *clear)
+{
+    afr_private_t *priv = this->private;
+    int32_t *in = NULL;
+    int32_t *out = NULL;
+    int len = 0;
+    int i = 0;
+    int j = 0;
+    int ret = 0;
+
+    if (!replies[subvol].valid || replies[subvol].op_ret != 0 ||
+        !replies[subvol].xdata)
+        return 0;
+
+    for (j = 0; j < priv->child_count; j++) {
+        if (!clear[j])
+            continue;
+
+        if (dict_get_ptr_and_len(replies[subvol].xdata, priv->region_key[j],
+                                 (void **)&in, &len) ||
+            len != AFR_REGION_MAP_SIZE || memeqzero((char *)in, len))
+            continue;
+
+        out = GF_CALLOC(AFR_REGION_MAP_LEN, sizeof(*out), gf_afr_mt_int32_t);
+        if (!out)
+            return -ENOMEM;
+
+        for (i = 0; i < AFR_REGION_MAP_LEN; i++)
+            out[i] = hton32(-ntoh32(in[i]));
+
+        ret = dict_set_bin(xattr, priv->region_key[j], out,
+                           AFR_REGION_MAP_SIZE);
+        if (ret) {
+            GF_FREE(out);
+            return ret;
+        }
+    }
+
+    return 0;
+}
+
 int
 afr_selfheal_undo_pending(call_frame_t *frame, xlator_t *this, inode_t *inode,
                           unsigned char *sources, unsigned char *sinks,
@@ -595,6 +641,7 @@ afr_selfheal_undo_pending(call_frame_t *frame, xlator_t *this, inode_t *inode,
     int i = 0;
     int j = 0;
     unsigned char *pending = NULL;
+    unsigned char *clear = NULL;
     int *input_dirty = NULL;
     int **input_matrix = NULL;
     int **full_heal_mtx_in = NULL;
@@ -649,6 +696,12 @@ afr_selfheal_undo_pending(call_frame_t *frame, xlator_t *this, inode_t *inode,
             output_dirty[i] = -input_dirty[i];
     }
 
+    if (type == AFR_DATA_TRANSACTION) {
+        clear = alloca0(priv->child_count);
+        for (j = 0; j < priv->child_count; j++)
+            clear[j] = !pending[j] && locked_on[j];
+    }
+
     for (i = 0; i < priv->child_count; i++) {
         if (!locked_on[i])
             /* perform post-op only on subvols we had locked
@@ -667,6 +720,9 @@ afr_selfheal_undo_pending(call_frame_t *frame, xlator_t *this, inode_t *inode,
             continue;
         }
 
+        if (clear)
+            afr_selfheal_output_regions(this, xattr, replies, i, clear);
+
         if ((type == AFR_ENTRY_TRANSACTION) && (priv->esh_granular)) {
             if (xdata && dict_set_int8(xdata, GF_XATTROP_PURGE_INDEX, 1))
                 gf_msg(this->name, GF_LOG_WARNING, 0, AFR_MSG_DICT_SET_FAILED,
@@ -1452,6 +1508,7 @@ _afr_fav_child_reset_sink_xattrs(call_frame_t *frame, xlator_t *this,
     int **input_matrix = NULL;
     int *output_dirty = NULL;
     int **output_matrix = NULL;
+    unsigned char *clear = NULL;
     dict_t *xattr = NULL;
     dict_t *xdata = NULL;
     int i = 0;
@@ -1480,11 +1537,18 @@ _afr_fav_child_reset_sink_xattrs(call_frame_t *frame, xlator_t *this,
         output_matrix[i][source] = -input_matrix[i][source];
     }
 
+    if (type == AFR_DATA_TRANSACTION) {
+        clear = alloca0(priv->child_count);
+        clear[source] = 1;
+    }
+
     for (i = 0; i < priv->child_count; i++) {
         if (!healed_sinks[i] || !locked_on[i])
             continue;
         xattr = afr_selfheal_output_xattr(this, _gf_false, type, output_dirty,
                                           output_matrix, i, NULL);
+        if (clear)
+            afr_selfheal_output_regions(this, xattr, replies, i, clear);
 
         afr_selfheal_post_op(frame, this, inode, i, xattr, xdata);
 
@@ -331,6 +331,117 @@ afr_data_self_heal_type_get(afr_private_t *priv, unsigned char *healed_sinks,
     return type;
 }
 
+static int32_t *
+afr_selfheal_region_map(xlator_t *this, struct afr_reply *reply, int sink)
+{
+    afr_private_t *priv = this->private;
+    void *map = NULL;
+    int len = 0;
+
+    if (!reply->valid || reply->op_ret != 0 || !reply->xdata)
+        return NULL;
+
+    if (dict_get_ptr_and_len(reply->xdata, priv->region_key[sink], &map,
+                             &len) ||
+        len != AFR_REGION_MAP_SIZE)
+        return NULL;
+
+    return map;
+}
+
+/*
+ * afr_selfheal_data_regions:
+ *
+ * Folds the region maps recorded for every healed sink into @dirty. The maps
+ * can only be trusted when they account for every write the sink missed: the
+ * number of writes they recorded must match the pending data counter of the
+ * source, all of them must have used the current region size, no write may
+ * be in flight (dirty) and every other brick that is not being healed must
+ * have seen exactly the same writes fail. Anything else, such as a truncate
+ * or a write from a client without region tracking, makes us fall back to
+ * the configured algorithm.
+ */
+static gf_boolean_t
+afr_selfheal_data_regions(xlator_t *this, int source,
+                          unsigned char *healed_sinks,
+                          struct afr_reply *replies, unsigned char *dirty)
+{
+    afr_private_t *priv = this->private;
+    int *input_dirty = NULL;
+    int **input_matrix = NULL;
+    int32_t *map = NULL;
+    int32_t *other = NULL;
+    int32_t count = 0;
+    int i = 0;
+    int j = 0;
+    int r = 0;
+
+    if (!priv->region_shift)
+        return _gf_false;
+
+    input_dirty = alloca0(priv->child_count * sizeof(int));
+    input_matrix = ALLOC_MATRIX(priv->child_count, int);
+    afr_selfheal_extract_xattr(this, replies, AFR_DATA_TRANSACTION,
+                               input_dirty, input_matrix);
+
+    for (i = 0; i < priv->child_count; i++) {
+        if (input_dirty[i])
+            return _gf_false;
+    }
+
+    memset(dirty, 0, AFR_REGION_COUNT);
+    for (j = 0; j < priv->child_count; j++) {
+        if (!healed_sinks[j])
+            continue;
+
+        map = afr_selfheal_region_map(this, &replies[source], j);
+        if (!map)
+            return _gf_false;
+
+        count = ntoh32(map[AFR_REGION_HDR_COUNT]);
+        if (count <= 0 || count != input_matrix[source][j])
+            return _gf_false;
+        if ((uint32_t)ntoh32(map[AFR_REGION_HDR_SHIFT]) !=
+            (uint32_t)count * priv->region_shift)
+            return _gf_false;
+
+        for (i = 0; i < priv->child_count; i++) {
+            if (i == source || healed_sinks[i] ||
+                AFR_IS_ARBITER_BRICK(priv, i))
+                continue;
+            other = afr_selfheal_region_map(this, &replies[i], j);
+            if (!other || memcmp(map, other, AFR_REGION_MAP_SIZE))
+                return _gf_false;
+        }
+
+        for (r = 0; r < AFR_REGION_COUNT; r++) {
+            if (map[AFR_REGION_HDR_LEN + r])
+                dirty[r] = 1;
+        }
+    }
+
+    return _gf_true;
+}
+
+static gf_boolean_t
+afr_selfheal_data_block_dirty(afr_private_t *priv, unsigned char *dirty,
+                              off_t offset, size_t size)
+{
+    uint64_t first = offset >> priv->region_shift;
+    uint64_t last = (offset + size - 1) >> priv->region_shift;
+    uint64_t r = 0;
+
+    if (last - first >= AFR_REGION_COUNT)
+        return _gf_true;
+
+    for (r = first; r <= last; r++) {
+        if (dirty[r % AFR_REGION_COUNT])
+            return _gf_true;
+    }
+
+    return _gf_false;
+}
+
 static int
 afr_selfheal_data_do(call_frame_t *frame, xlator_t *this, fd_t *fd, int source,
                      unsigned char *healed_sinks, struct afr_reply *replies)
@@ -342,6 +453,10 @@ afr_selfheal_data_do(call_frame_t *frame, xlator_t *this, fd_t *fd, int source,
     int ret = -1;
     call_frame_t *iter_frame = NULL;
     unsigned char arbiter_sink_status = 0;
+    unsigned char dirty[AFR_REGION_COUNT];
+    gf_boolean_t use_regions = _gf_false;
+    uint64_t healed = 0;
+    uint64_t skipped = 0;
 
     gf_msg(this->name, GF_LOG_INFO, 0, AFR_MSG_SELF_HEAL_INFO,
            "performing data selfheal on %s", uuid_utoa(fd->inode->gfid));
@@ -361,6 +476,8 @@ afr_selfheal_data_do(call_frame_t *frame, xlator_t *this, fd_t *fd, int source,
     }
 
     type = afr_data_self_heal_type_get(priv, healed_sinks, source, replies);
+    use_regions = afr_selfheal_data_regions(this, source, healed_sinks,
+                                            replies, dirty);
 
     iter_frame = afr_copy_frame(frame);
     if (!iter_frame) {
@@ -374,10 +491,20 @@ afr_selfheal_data_do(call_frame_t *frame, xlator_t *this, fd_t *fd, int source,
             goto out;
         }
 
+        /* The sinks were truncated to the size of the source, so blocks
+         * past their old end are covered by the writes that grew the
+         * file and are dirty as well. */
+        if (use_regions &&
+            !afr_selfheal_data_block_dirty(priv, dirty, off, block)) {
+            skipped += min(block, replies[source].poststat.ia_size - off);
+            continue;
+        }
+
         ret = afr_selfheal_data_block(iter_frame, this, fd, source,
                                       healed_sinks, off, block, type, replies);
         if (ret < 0)
             goto out;
+        healed += min(block, replies[source].poststat.ia_size - off);
 
         AFR_STACK_RESET(iter_frame);
         if (iter_frame->local == NULL) {
@@ -388,6 +515,11 @@ afr_selfheal_data_do(call_frame_t *frame, xlator_t *this, fd_t *fd, int source,
 
     ret = afr_selfheal_data_fsync(frame, this, fd, healed_sinks);
 
+    if (use_regions)
+        gf_msg(this->name, GF_LOG_INFO, 0, AFR_MSG_SELF_HEAL_INFO,
+               "healed dirty regions of %s: %" PRIu64
+               " bytes copied, %" PRIu64 " bytes skipped",
+               uuid_utoa(fd->inode->gfid), healed, skipped);
 out:
     if (arbiter_sink_status)
         healed_sinks[ARBITER_BRICK_INDEX] = arbiter_sink_status;
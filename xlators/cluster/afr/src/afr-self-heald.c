@@ -398,6 +398,37 @@ afr_shd_sweep_done(struct subvol_healer *healer)
     _unmask_cancellation();
 }
 
+/* Lets fewer heals run together while the clients of the bricks wait for
+ * their fops longer than the target, and more again when they do not. */
+static void
+afr_shd_throttle(struct subvol_healer *healer)
+{
+    afr_private_t *priv = healer->this->private;
+    syncop_throttle_t *throttle = &healer->throttle;
+    uint32_t limit = syncop_throttle_limit(throttle);
+    uint64_t latency = 0;
+    uint64_t worst = 0;
+    int i = 0;
+
+    if (!syncop_throttle_due(throttle))
+        return;
+
+    for (i = 0; throttle->target && (i < priv->child_count); i++) {
+        if (!priv->child_up[i])
+            continue;
+        if (syncop_subvol_load(priv->children[i], &latency) == 0)
+            worst = max(worst, latency);
+    }
+
+    syncop_throttle_adjust(throttle, worst, priv->shd.max_threads);
+
+    if (syncop_throttle_limit(throttle) != limit)
+        gf_msg_debug(healer->this->name, 0,
+                     "%u heals of %s allowed, clients wait %" PRIu64 "us",
+                     syncop_throttle_limit(throttle),
+                     priv->children[healer->subvol]->name, worst);
+}
+
 int
 afr_shd_index_heal(xlator_t *subvol, gf_dirent_t *entry, loc_t *parent,
                    void *data)
@@ -434,6 +465,9 @@ afr_shd_index_heal(xlator_t *subvol, gf_dirent_t *entry, loc_t *parent,
          */
         afr_shd_zero_xattrop(healer->this, gfid);
 
+    GF_ATOMIC_INC(healer->throttle.done);
+    afr_shd_throttle(healer);
+
     return 0;
 }
 
@@ -471,9 +505,16 @@ afr_shd_index_sweep(struct subvol_healer *healer, char *vgfid)
         goto out;
     }
 
+    syncop_throttle_reset(&healer->throttle,
+                          priv->shd.client_latency_target * 1000,
+                          priv->shd.max_threads);
+    /* Start from the load of the bricks now rather than from where the
+     * previous crawl left the limit. */
+    afr_shd_throttle(healer);
     ret = syncop_mt_dir_scan(frame, subvol, &loc, GF_CLIENT_PID_SELF_HEALD,
                              healer, afr_shd_index_heal, xdata,
-                             priv->shd.max_threads, priv->shd.wait_qlength);
+                             priv->shd.max_threads, &healer->throttle,
+                             priv->shd.wait_qlength);
 
     if (ret == 0)
         ret = healer->crawl_event.healed_count;
@@ -1001,7 +1042,8 @@ afr_cleanup_anon_inode_dir(struct subvol_healer *healer)
     ret = syncop_mt_dir_scan(frame, priv->children[healer->subvol], &loc,
                              GF_CLIENT_PID_SELF_HEALD, healer,
                              afr_shd_anon_inode_cleaner, NULL,
-                             priv->shd.max_threads, priv->shd.wait_qlength);
+                             priv->shd.max_threads, NULL,
+                             priv->shd.wait_qlength);
 out:
     if (frame)
         AFR_STACK_DESTROY(frame);
@@ -1150,6 +1192,8 @@ afr_shd_healer_init(xlator_t *this, struct subvol_healer *healer)
     healer->running = _gf_false;
     healer->rerun = _gf_false;
     healer->local = _gf_false;
+    syncop_throttle_init(&healer->throttle, 0,
+                         ((afr_private_t *)this->private)->shd.max_threads);
 out:
     return ret;
 }
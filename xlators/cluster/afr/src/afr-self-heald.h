@@ -43,6 +43,7 @@ struct subvol_healer {
     gf_boolean_t local;
     gf_boolean_t running;
     gf_boolean_t rerun;
+    syncop_throttle_t throttle; /* of the index heals */
 };
 
 typedef struct {
@@ -54,6 +55,7 @@ typedef struct {
     time_t timeout;
     uint32_t max_threads;
     uint32_t wait_qlength;
+    uint32_t client_latency_target; /* msecs, 0 not to throttle the heals */
     uint32_t halo_max_latency_msec;
     gf_boolean_t iamshd;
     gf_boolean_t enabled;
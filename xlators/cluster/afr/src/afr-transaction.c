@@ -635,6 +635,82 @@ afr_set_pending_dict(afr_private_t *priv, dict_t *xattr, int **pending)
     return ret;
 }
 
+static gf_boolean_t
+afr_txn_written_range(afr_local_t *local, off_t *start, size_t *len)
+{
+    switch (local->op) {
+        case GF_FOP_WRITE:
+            if (local->transaction.len)
+                break;
+            /* Appending writes lock the whole file, where they landed is
+             * only known from the size they left behind. */
+            if (local->op_ret <= 0 ||
+                local->cont.inode_wfop.postbuf.ia_size < local->op_ret)
+                return _gf_false;
+            *start = local->cont.inode_wfop.postbuf.ia_size - local->op_ret;
+            *len = local->op_ret;
+            return _gf_true;
+        case GF_FOP_ZEROFILL:
+            if (!local->transaction.len)
+                return _gf_false;
+            break;
+        default:
+            /* truncate, fallocate and discard change the size or the
+             * allocation of the file, leave them to a regular heal. */
+            return _gf_false;
+    }
+
+    *start = local->transaction.start;
+    *len = local->transaction.len;
+    return _gf_true;
+}
+
+static void
+afr_set_region_dict(afr_private_t *priv, afr_local_t *local, dict_t *xattr)
+{
+    int32_t *map = NULL;
+    off_t start = 0;
+    size_t len = 0;
+    uint64_t first = 0;
+    uint64_t last = 0;
+    uint64_t r = 0;
+    int i = 0;
+
+    /* Not recording a write leaves the map behind the pending counter,
+     * which is what makes self-heal ignore it, so nothing here is fatal
+     * for the post-op. */
+    if (!afr_txn_written_range(local, &start, &len))
+        return;
+
+    first = start >> priv->region_shift;
+    last = (start + len - 1) >> priv->region_shift;
+
+    for (i = 0; i < priv->child_count; i++) {
+        if (!local->transaction.failed_subvols[i])
+            continue;
+
+        map = GF_CALLOC(AFR_REGION_MAP_LEN, sizeof(*map), gf_afr_mt_int32_t);
+        if (!map)
+            return;
+
+        map[AFR_REGION_HDR_COUNT] = hton32(1);
+        map[AFR_REGION_HDR_SHIFT] = hton32(priv->region_shift);
+        if (last - first >= AFR_REGION_COUNT) {
+            for (r = 0; r < AFR_REGION_COUNT; r++)
+                map[AFR_REGION_HDR_LEN + r] = hton32(1);
+        } else {
+            for (r = first; r <= last; r++)
+                map[AFR_REGION_HDR_LEN + (r % AFR_REGION_COUNT)] = hton32(1);
+        }
+
+        if (dict_set_bin(xattr, priv->region_key[i], map,
+                         AFR_REGION_MAP_SIZE)) {
+            GF_FREE(map);
+            return;
+        }
+    }
+}
+
 static void
 afr_ta_dom_lock_check_and_release(afr_ta_fop_state_t fop_state, xlator_t *this)
 {
@@ -1427,6 +1503,10 @@ afr_changelog_post_op_do(call_frame_t *frame, xlator_t *this)
         goto out;
     }
 
+    if (priv->region_shift &&
+        local->transaction.type == AFR_DATA_TRANSACTION && !nothing_failed)
+        afr_set_region_dict(priv, local, xattr);
+
     if (need_undirty)
         local->dirty[idx] = hton32(-1);
     else
@@ -1792,6 +1872,124 @@ afr_changelog_prepare(xlator_t *this, call_frame_t *frame, int *call_count,
     return 0;
 }
 
+static int
+afr_changelog_compound_cbk(call_frame_t *frame, void *cookie, xlator_t *this,
+                           int op_ret, int op_errno, void *data, dict_t *xdata)
+{
+    afr_local_t *local = NULL;
+    afr_private_t *priv = NULL;
+    compound_args_t *args = NULL;
+    compound_args_cbk_t *args_cbk = data;
+    default_args_cbk_t *rsp = NULL;
+    int child_index = (long)cookie;
+
+    local = frame->local;
+    priv = this->private;
+    args = local->transaction.compound_args;
+
+    if (!args_cbk) {
+        if (op_errno != ENOTSUP)
+            return afr_changelog_cbk(frame, cookie, this, -1, op_errno, NULL,
+                                     NULL);
+
+        /* Nothing was sent to the brick, the connection can not carry
+         * compound fops. Send the post-op on its own, the lock is released
+         * later by afr_unlock(). */
+        if (local->fd) {
+            STACK_WIND_COOKIE(frame, afr_changelog_cbk, cookie,
+                              priv->children[child_index],
+                              priv->children[child_index]->fops->fxattrop,
+                              local->fd, GF_XATTROP_ADD_ARRAY,
+                              args->req_list[0].xattr, args->req_list[0].xdata);
+        } else {
+            STACK_WIND_COOKIE(frame, afr_changelog_cbk, cookie,
+                              priv->children[child_index],
+                              priv->children[child_index]->fops->xattrop,
+                              &local->loc, GF_XATTROP_ADD_ARRAY,
+                              args->req_list[0].xattr, args->req_list[0].xdata);
+        }
+        return 0;
+    }
+
+    /* The brick runs the unlock even if the post-op failed. */
+    if (args_cbk->fop_length > 1) {
+        rsp = &args_cbk->rsp_list[1];
+        afr_unlock_done_on_child(frame, this, child_index, 0, rsp->op_ret,
+                                 rsp->op_errno);
+    }
+
+    rsp = &args_cbk->rsp_list[0];
+    return afr_changelog_cbk(frame, cookie, this, rsp->op_ret, rsp->op_errno,
+                             rsp->xattr, rsp->xdata);
+}
+
+/* With eager-lock off the post-op of a data/metadata transaction is
+ * immediately followed by the unlock, pack both into one compound fop so
+ * that each brick is visited once. */
+static void
+afr_changelog_compound_prepare(call_frame_t *frame, xlator_t *this,
+                               dict_t *xattr, dict_t *xdata)
+{
+    afr_local_t *local = frame->local;
+    afr_private_t *priv = this->private;
+    afr_internal_lock_t *int_lock = &local->internal_lock;
+    compound_args_t *args = NULL;
+    struct gf_flock flock = {
+        0,
+    };
+
+    if (local->transaction.compound_args) {
+        compound_args_cleanup(local->transaction.compound_args);
+        local->transaction.compound_args = NULL;
+    }
+
+    if (!priv->use_compound_fops || priv->thin_arbiter_count ||
+        local->transaction.eager_lock_on || local->transaction.resume_stub ||
+        int_lock->lockee_count != 1)
+        return;
+
+    if (local->transaction.type != AFR_DATA_TRANSACTION &&
+        local->transaction.type != AFR_METADATA_TRANSACTION)
+        return;
+
+    args = compound_fop_alloc(2, NULL);
+    if (!args)
+        return;
+
+    flock = int_lock->lockee[0].flock;
+    flock.l_type = F_UNLCK;
+
+    if (local->fd) {
+        COMPOUND_PACK_ARGS(fxattrop, GF_FOP_FXATTROP, args, 0, local->fd,
+                           GF_XATTROP_ADD_ARRAY, xattr, xdata);
+        COMPOUND_PACK_ARGS(finodelk, GF_FOP_FINODELK, args, 1,
+                           int_lock->domain, int_lock->lockee[0].fd, F_SETLK,
+                           &flock, NULL);
+    } else {
+        COMPOUND_PACK_ARGS(xattrop, GF_FOP_XATTROP, args, 0, &local->loc,
+                           GF_XATTROP_ADD_ARRAY, xattr, xdata);
+        COMPOUND_PACK_ARGS(inodelk, GF_FOP_INODELK, args, 1, int_lock->domain,
+                           &int_lock->lockee[0].loc, F_SETLK, &flock, NULL);
+    }
+
+    local->transaction.compound_args = args;
+}
+
+static gf_boolean_t
+afr_changelog_can_compound(call_frame_t *frame, xlator_t *this, int child)
+{
+    afr_local_t *local = frame->local;
+    afr_private_t *priv = this->private;
+
+    if (!local->transaction.compound_args)
+        return _gf_false;
+
+    if (!priv->children[child]->fops->compound)
+        return _gf_false;
+
+    return afr_is_locked_on_child(&local->internal_lock, 0, child);
+}
+
 int
 afr_changelog_do(call_frame_t *frame, xlator_t *this, dict_t *xattr,
                  afr_changelog_resume_t changelog_resume, afr_xattrop_type_t op)
@@ -1820,6 +2018,9 @@ afr_changelog_do(call_frame_t *frame, xlator_t *this, dict_t *xattr,
     if (ret)
         return 0;
 
+    if (op == AFR_TRANSACTION_POST_OP)
+        afr_changelog_compound_prepare(frame, this, xattr, xdata);
+
     for (i = 0; i < priv->child_count; i++) {
         if (!local->transaction.pre_op[i] ||
             local->transaction.failed_subvols[i])
@@ -1828,7 +2029,13 @@ afr_changelog_do(call_frame_t *frame, xlator_t *this, dict_t *xattr,
         switch (local->transaction.type) {
             case AFR_DATA_TRANSACTION:
             case AFR_METADATA_TRANSACTION:
-                if (!local->fd) {
+                if (op == AFR_TRANSACTION_POST_OP &&
+                    afr_changelog_can_compound(frame, this, i)) {
+                    STACK_WIND_COOKIE(frame, afr_changelog_compound_cbk,
+                                      (void *)(long)i, priv->children[i],
+                                      priv->children[i]->fops->compound,
+                                      local->transaction.compound_args, NULL);
+                } else if (!local->fd) {
                     STACK_WIND_COOKIE(
                         frame, afr_changelog_cbk, (void *)(long)i,
                         priv->children[i], priv->children[i]->fops->xattrop,
@@ -135,6 +135,24 @@ set_data_self_heal_algorithm(afr_private_t *priv, char *algo)
     }
 }
 
+static void
+set_data_self_heal_region_size(afr_private_t *priv, uint64_t size)
+{
+    uint32_t shift = 0;
+
+    /* Regions are rounded down to a power of two and are never smaller
+     * than the 128KB block that data self-heal copies at a time. */
+    if (!size) {
+        priv->region_shift = 0;
+        return;
+    }
+
+    while ((size >> (shift + 1)) != 0)
+        shift++;
+
+    priv->region_shift = max(shift, 17);
+}
+
 void
 afr_handle_anon_inode_options(afr_private_t *priv, dict_t *options)
 {
@@ -172,6 +190,7 @@ reconfigure(xlator_t *this, dict_t *options)
     char *data_self_heal = NULL;
     char *data_self_heal_algorithm = NULL;
     char *locking_scheme = NULL;
+    uint64_t region_size = 0;
     gf_boolean_t consistent_io = _gf_false;
     gf_boolean_t choose_local_old = _gf_false;
     gf_boolean_t enabled_old = _gf_false;
@@ -200,6 +219,10 @@ reconfigure(xlator_t *this, dict_t *options)
     GF_OPTION_RECONF("data-self-heal-window-size",
                      priv->data_self_heal_window_size, options, uint32, out);
 
+    GF_OPTION_RECONF("data-self-heal-region-size", region_size, options,
+                     size_uint64, out);
+    set_data_self_heal_region_size(priv, region_size);
+
     GF_OPTION_RECONF("data-self-heal-algorithm", data_self_heal_algorithm,
                      options, str, out);
     set_data_self_heal_algorithm(priv, data_self_heal_algorithm);
@@ -299,6 +322,9 @@ reconfigure(xlator_t *this, dict_t *options)
     GF_OPTION_RECONF("shd-wait-qlength", priv->shd.wait_qlength, options,
                      uint32, out);
 
+    GF_OPTION_RECONF("shd-client-latency-target",
+                     priv->shd.client_latency_target, options, uint32, out);
+
     GF_OPTION_RECONF("favorite-child-policy", fav_child_policy, options, str,
                      out);
     if (afr_set_favorite_child_policy(priv, fav_child_policy) == -1)
@@ -311,6 +337,9 @@ reconfigure(xlator_t *this, dict_t *options)
         consistent_io = _gf_false;
     priv->consistent_io = consistent_io;
 
+    GF_OPTION_RECONF("use-compound-fops", priv->use_compound_fops, options,
+                     bool, out);
+
     afr_handle_anon_inode_options(priv, options);
 
     GF_OPTION_RECONF("use-anonymous-inode", priv->use_anon_inode, options, bool,
@@ -393,6 +422,25 @@ out:
     return ret;
 }
 
+static int
+afr_region_keys_init(afr_private_t *priv)
+{
+    int i = 0;
+
+    priv->region_key = GF_CALLOC(sizeof(*priv->region_key), priv->child_count,
+                                 gf_afr_mt_char);
+    if (!priv->region_key)
+        return -ENOMEM;
+
+    for (i = 0; i < priv->child_count; i++) {
+        if (gf_asprintf(&priv->region_key[i], "%s%s", priv->pending_key[i],
+                        AFR_REGION_KEY_SUFFIX) == -1)
+            return -ENOMEM;
+    }
+
+    return 0;
+}
+
 void
 afr_ta_init(afr_private_t *priv)
 {
@@ -426,6 +474,7 @@ init(xlator_t *this)
     char *data_self_heal = NULL;
     char *locking_scheme = NULL;
     char *data_self_heal_algorithm = NULL;
+    uint64_t region_size = 0;
 
     if (!this->children) {
         gf_msg(this->name, GF_LOG_ERROR, 0, AFR_MSG_CHILD_MISCONFIGURED,
@@ -505,6 +554,9 @@ init(xlator_t *this)
 
     GF_OPTION_INIT("shd-wait-qlength", priv->shd.wait_qlength, uint32, out);
 
+    GF_OPTION_INIT("shd-client-latency-target",
+                   priv->shd.client_latency_target, uint32, out);
+
     GF_OPTION_INIT("background-self-heal-count",
                    priv->background_self_heal_count, uint32, out);
 
@@ -521,6 +573,10 @@ init(xlator_t *this)
     GF_OPTION_INIT("data-self-heal-window-size",
                    priv->data_self_heal_window_size, uint32, out);
 
+    GF_OPTION_INIT("data-self-heal-region-size", region_size, size_uint64,
+                   out);
+    set_data_self_heal_region_size(priv, region_size);
+
     GF_OPTION_INIT("metadata-self-heal", priv->metadata_self_heal, bool, out);
 
     GF_OPTION_INIT("entry-self-heal", priv->entry_self_heal, bool, out);
@@ -564,6 +620,7 @@ init(xlator_t *this)
 
     GF_OPTION_INIT("consistent-metadata", priv->consistent_metadata, bool, out);
     GF_OPTION_INIT("consistent-io", priv->consistent_io, bool, out);
+    GF_OPTION_INIT("use-compound-fops", priv->use_compound_fops, bool, out);
     afr_handle_anon_inode_options(priv, this->options);
 
     GF_OPTION_INIT("use-anonymous-inode", priv->use_anon_inode, bool, out);
@@ -610,6 +667,10 @@ init(xlator_t *this)
     if (ret)
         goto out;
 
+    ret = afr_region_keys_init(priv);
+    if (ret)
+        goto out;
+
     trav = this->children;
     i = 0;
     while (i < child_count) {
@@ -753,6 +814,7 @@ fini(xlator_t *this)
 
 struct xlator_fops fops = {
     .lookup = afr_lookup,
+    .compound = afr_compound,
     .lk = afr_lk,
     .flush = afr_flush,
     .statfs = afr_statfs,
@@ -989,6 +1051,21 @@ struct volume_options options[] = {
      .tags = {"replicate"},
      .description = "Maximum number of 128KB blocks per file for which "
                     "self-heal process would be applied simultaneously."},
+    {.key = {"data-self-heal-region-size"},
+     .type = GF_OPTION_TYPE_SIZET,
+     .min = 0,
+     .max = 1 * GF_UNIT_GB,
+     .default_value = "0",
+     .op_version = {GD_OP_VERSION_10_0},
+     .flags = OPT_FLAG_CLIENT_OPT | OPT_FLAG_SETTABLE | OPT_FLAG_DOC,
+     .tags = {"replicate"},
+     .description = "When non-zero, writes that fail on a replica record the "
+                    "region of the file they touched (rounded down to a "
+                    "power of two, at least 128KB) next to the pending "
+                    "changelog. Data self-heal then copies only those "
+                    "regions instead of checksumming or copying the whole "
+                    "file, falling back to the configured algorithm when "
+                    "the record is incomplete. 0 disables the tracking."},
     {.key = {"metadata-self-heal"},
      .type = GF_OPTION_TYPE_BOOL,
      .default_value = "off",
@@ -1263,6 +1340,21 @@ struct volume_options options[] = {
         .description = "This option can be used to control number of heals"
                        " that can wait in SHD per subvolume",
     },
+    {
+        .key = {"shd-client-latency-target"},
+        .type = GF_OPTION_TYPE_INT,
+        .min = 0,
+        .max = 60000,
+        .default_value = "0",
+        .op_version = {GD_OP_VERSION_10_0},
+        .flags = OPT_FLAG_CLIENT_OPT | OPT_FLAG_SETTABLE | OPT_FLAG_DOC,
+        .tags = {"replicate"},
+        .description = "Latency in milliseconds the fops of the clients may "
+                       "see on the bricks before SHD lowers the number of "
+                       "parallel heals, which grows back up to "
+                       "shd-max-threads while they stay below it. 0 lets SHD "
+                       "always run shd-max-threads heals.",
+    },
     {
         .key = {"locking-scheme"},
         .type = GF_OPTION_TYPE_STR,
@@ -1324,8 +1416,10 @@ struct volume_options options[] = {
      .op_version = {GD_OP_VERSION_3_8_4},
      .flags = OPT_FLAG_CLIENT_OPT | OPT_FLAG_SETTABLE | OPT_FLAG_DOC,
      .tags = {"replicate"},
-     .description = "This option exists only for backward compatibility "
-                    "and configuring it doesn't have any effect"},
+     .description = "Send the post-op changelog update and the unlock of "
+                    "a data/metadata transaction to each brick as a single "
+                    "compound fop, saving a network round trip per write "
+                    "when eager-lock is off."},
     {.key = {"use-anonymous-inode"},
      .type = GF_OPTION_TYPE_BOOL,
      .default_value = "no",
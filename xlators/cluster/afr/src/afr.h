@@ -18,6 +18,7 @@
 #include "libxlator.h"
 #include <glusterfs/timer.h>
 #include <glusterfs/syncop.h>
+#include <glusterfs/syncop-utils.h>
 
 #include "afr-self-heald.h"
 #include "afr-messages.h"
@@ -33,6 +34,20 @@
 #define AFR_NUM_CHANGE_LOGS 3              /*data + metadata + entry*/
 #define AFR_DEFAULT_SPB_CHOICE_TIMEOUT 300 /*in seconds*/
 
+/* Per-sink map of the file regions written while that sink was down. It is
+ * stored next to the pending key as "<pending_key>.regions" and is updated
+ * with GF_XATTROP_ADD_ARRAY in the same post-op as the data changelog, so
+ * its header counts the same failed writes as the pending data counter:
+ * [0] number of writes recorded, [1] sum of the region shifts they used,
+ * [2..] per-region write counts (regions wrap around modulo the count). */
+#define AFR_REGION_KEY_SUFFIX ".regions"
+#define AFR_REGION_COUNT 128
+#define AFR_REGION_HDR_COUNT 0
+#define AFR_REGION_HDR_SHIFT 1
+#define AFR_REGION_HDR_LEN 2
+#define AFR_REGION_MAP_LEN (AFR_REGION_HDR_LEN + AFR_REGION_COUNT)
+#define AFR_REGION_MAP_SIZE (AFR_REGION_MAP_LEN * sizeof(int32_t))
+
 #define ARBITER_BRICK_INDEX 2
 #define THIN_ARBITER_BRICK_INDEX 2
 #define AFR_TA_DOM_NOTIFY "afr.ta.dom-notify"
@@ -195,10 +210,13 @@ typedef struct _afr_private {
     unsigned char *local;
 
     char **pending_key;
+    char **region_key;
 
     afr_data_self_heal_type_t data_self_heal_algorithm;
     unsigned int data_self_heal_window_size; /* max number of pipelined
                                                 read/writes */
+    uint32_t region_shift; /* log2 of the dirty region size, 0 if
+                              region tracking is off */
 
     struct list_head heal_waiting; /*queue for files that need heal*/
     uint32_t heal_wait_qlen; /*configurable queue length for heal_waiting*/
@@ -272,6 +290,7 @@ typedef struct _afr_private {
     gf_boolean_t full_lock;
     gf_boolean_t esh_granular;
     gf_boolean_t consistent_io;
+    gf_boolean_t use_compound_fops;
     gf_boolean_t data_self_heal; /* on/off */
     gf_boolean_t use_anon_inode;
 
@@ -814,6 +833,12 @@ typedef struct _afr_local {
             gf_boolean_t needs_fresh_lookup;
         } lookup;
 
+        struct {
+            compound_args_t *args;
+            compound_args_cbk_t **replies; /* one per child */
+            compound_args_cbk_t *rsp;
+        } compound;
+
     } cont;
 
     struct {
@@ -834,6 +859,10 @@ typedef struct _afr_local {
 
         /* Changelog xattr dict for [f]xattrop*/
         dict_t **changelog_xdata;
+
+        /* post-op + unlock shared by every child when the post-op is
+           sent as a compound fop */
+        compound_args_t *compound_args;
         unsigned char *pre_op_sources;
 
         /* @failed_subvols: subvolumes on which a pre-op or a
@@ -1062,6 +1091,14 @@ afr_set_lock_number(call_frame_t *frame, xlator_t *this);
 int32_t
 afr_unlock(call_frame_t *frame, xlator_t *this);
 
+gf_boolean_t
+afr_is_locked_on_child(afr_internal_lock_t *int_lock, int lockee_num,
+                       int child);
+
+int
+afr_unlock_done_on_child(call_frame_t *frame, xlator_t *this, int child_index,
+                         int lockee_num, int32_t op_ret, int32_t op_errno);
+
 int
 afr_lock_nonblocking(call_frame_t *frame, xlator_t *this);
 
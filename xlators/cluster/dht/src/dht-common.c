@@ -3577,6 +3577,230 @@ err:
     return 0;
 }
 
+/* Batched lookups. Every lookup of the compound is sent to its hashed
+ * subvolume, lookups hashing to the same subvolume are sent there as one
+ * compound. Only data files found on their hashed subvolume and misses that
+ * dht_lookup_cbk() would not chase on the other subvolumes are answered here,
+ * everything else (directories, linkto files, errors) is returned with
+ * ECANCELED and the caller looks the entry up again with a regular lookup.
+ */
+static int
+dht_compound_cbk(call_frame_t *frame, void *cookie, xlator_t *this,
+                 int32_t op_ret, int32_t op_errno, void *data, dict_t *xdata)
+{
+    dht_local_t *local = NULL;
+    dht_conf_t *conf = NULL;
+    dht_compound_batch_t *batch = cookie;
+    compound_args_cbk_t *args_cbk = data;
+    default_args_cbk_t *rsp = NULL;
+    default_args_t *req = NULL;
+    struct iatt *stbuf = NULL;
+    uint32_t vol_commit_hash = 0;
+    int this_call_cnt = 0;
+    int ret = 0;
+    int i = 0;
+    int idx = 0;
+
+    local = frame->local;
+    conf = this->private;
+
+    for (i = 0; i < batch->args->fop_length; i++) {
+        idx = batch->index[i];
+        req = &batch->args->req_list[i];
+
+        /* The entry stays ECANCELED unless settled below. */
+        if (!args_cbk || i >= args_cbk->fop_length)
+            continue;
+
+        rsp = &args_cbk->rsp_list[i];
+        if (rsp->op_ret == -1) {
+            if (ENTRY_MISSING(rsp->op_ret, rsp->op_errno) &&
+                ((conf->subvolume_cnt == 1) ||
+                 !dht_should_lookup_everywhere(this, conf, &req->loc)))
+                local->compound.rsp->rsp_list[idx].op_errno = ENOENT;
+            continue;
+        }
+
+        stbuf = &rsp->stat;
+        if (check_is_dir(req->loc.inode, stbuf, rsp->xdata) ||
+            check_is_linkfile(req->loc.inode, stbuf, rsp->xdata,
+                              conf->link_xattr_name))
+            continue;
+
+        ret = dht_layout_preset(this, batch->subvol, req->loc.inode);
+        if (ret < 0) {
+            gf_msg(this->name, GF_LOG_INFO, 0, DHT_MSG_LAYOUT_PRESET_FAILED,
+                   "%s: could not set pre-set layout for subvolume %s",
+                   req->loc.path, batch->subvol->name);
+            continue;
+        }
+
+        if (!conf->vch_forced && rsp->xdata) {
+            ret = dict_get_uint32(rsp->xdata, conf->commithash_xattr_name,
+                                  &vol_commit_hash);
+            if (ret == 0)
+                conf->vol_commit_hash = vol_commit_hash;
+        }
+
+        dht_inode_ctx_time_update(req->loc.parent, this, &rsp->postparent, 1);
+
+        DHT_STRIP_PHASE1_FLAGS(stbuf);
+        dht_set_fixed_dir_stat(&rsp->postparent);
+        args_lookup_cbk_store(&local->compound.rsp->rsp_list[idx], 0, 0,
+                              req->loc.inode, stbuf, rsp->xdata,
+                              &rsp->postparent);
+    }
+
+    this_call_cnt = dht_frame_return(frame);
+    if (is_last_call(this_call_cnt))
+        DHT_STACK_UNWIND(compound, frame, 0, 0, local->compound.rsp, NULL);
+
+    return 0;
+}
+
+int32_t
+dht_compound(call_frame_t *frame, xlator_t *this, void *data, dict_t *xdata)
+{
+    compound_args_t *args = data;
+    dht_local_t *local = NULL;
+    dht_conf_t *conf = NULL;
+    dht_compound_batch_t *batch = NULL;
+    xlator_t *hashed[GF_COMPOUND_MAX_FOPS] = {
+        NULL,
+    };
+    loc_t *loc = NULL;
+    dict_t *xattr_req = NULL;
+    loc_t new_loc = {
+        0,
+    };
+    int op_errno = ENOTSUP;
+    int batch_cnt = 0;
+    int cnt = 0;
+    int i = 0;
+    int j = 0;
+    int ret = 0;
+
+    VALIDATE_OR_GOTO(frame, err);
+    VALIDATE_OR_GOTO(this, err);
+
+    conf = this->private;
+    if (!conf)
+        goto err;
+
+    if (!compound_args_only_fop(args, GF_FOP_LOOKUP))
+        goto err;
+
+    /* Only entries resolved by their hashed subvolume are batched. Nameless
+     * lookups, names with a subvolume filter and entries of directories
+     * without a layout are left to dht_lookup().
+     */
+    for (i = 0; i < args->fop_length; i++) {
+        loc = &args->req_list[i].loc;
+        if (!loc->inode || !loc->parent || !loc->name)
+            goto err;
+
+        if (dht_filter_loc_subvol_key(this, loc, &new_loc, &hashed[i])) {
+            loc_wipe(&new_loc);
+            goto err;
+        }
+
+        hashed[i] = dht_subvol_get_hashed(this, loc);
+        if (!hashed[i] || !hashed[i]->fops->compound)
+            goto err;
+    }
+
+    local = dht_local_init(frame, NULL, NULL, GF_FOP_COMPOUND);
+    if (!local) {
+        op_errno = ENOMEM;
+        goto err;
+    }
+
+    local->compound.rsp = compound_args_cbk_alloc(args->fop_length, NULL);
+    local->compound.batch = GF_CALLOC(args->fop_length, sizeof(*batch),
+                                      gf_dht_mt_compound_batch_t);
+    if (!local->compound.rsp || !local->compound.batch) {
+        op_errno = ENOMEM;
+        goto err;
+    }
+
+    for (i = 0; i < args->fop_length; i++) {
+        local->compound.rsp->enum_list[i] = GF_FOP_LOOKUP;
+        local->compound.rsp->rsp_list[i].op_ret = -1;
+        local->compound.rsp->rsp_list[i].op_errno = ECANCELED;
+
+        for (j = 0; j < batch_cnt; j++) {
+            if (local->compound.batch[j].subvol == hashed[i])
+                break;
+        }
+        if (j < batch_cnt)
+            continue;
+
+        /* First entry hashing to this subvolume, collect all of them. */
+        batch = &local->compound.batch[batch_cnt];
+        local->compound.batch_cnt = ++batch_cnt;
+        batch->subvol = hashed[i];
+
+        for (cnt = 0, j = i; j < args->fop_length; j++) {
+            if (hashed[j] == hashed[i])
+                cnt++;
+        }
+
+        batch->args = compound_fop_alloc(cnt, args->xdata);
+        batch->index = GF_CALLOC(cnt, sizeof(*batch->index), gf_common_mt_int);
+        if (!batch->args || !batch->index) {
+            op_errno = ENOMEM;
+            goto err;
+        }
+
+        for (cnt = 0, j = i; j < args->fop_length; j++) {
+            if (hashed[j] != hashed[i])
+                continue;
+
+            loc = &args->req_list[j].loc;
+            if (args->req_list[j].xdata)
+                xattr_req = dict_copy_with_ref(args->req_list[j].xdata, NULL);
+            else
+                xattr_req = dict_new();
+            if (!xattr_req) {
+                op_errno = ENOMEM;
+                goto err;
+            }
+
+            /* As in dht_do_fresh_lookup(), the gfid-req is dropped and the
+             * linkto and open fd count xattrs are requested. */
+            dict_del(xattr_req, "gfid-req");
+            ret = dht_set_file_xattr_req(this, loc, xattr_req);
+            if (ret) {
+                dict_unref(xattr_req);
+                op_errno = -ret;
+                goto err;
+            }
+
+            COMPOUND_PACK_ARGS(lookup, GF_FOP_LOOKUP, batch->args, cnt, loc,
+                               xattr_req);
+            dict_unref(xattr_req);
+            batch->index[cnt++] = j;
+        }
+    }
+
+    local->call_cnt = batch_cnt;
+    batch = local->compound.batch;
+
+    for (i = 0; i < batch_cnt; i++) {
+        gf_msg_debug(this->name, 0, "sending %d lookups to %s",
+                     batch[i].args->fop_length, batch[i].subvol->name);
+        STACK_WIND_COOKIE(frame, dht_compound_cbk, &batch[i], batch[i].subvol,
+                          batch[i].subvol->fops->compound, batch[i].args,
+                          batch[i].args->xdata);
+    }
+
+    return 0;
+
+err:
+    DHT_STACK_UNWIND(compound, frame, -1, op_errno, NULL, NULL);
+    return 0;
+}
+
 static int
 dht_unlink_linkfile_cbk(call_frame_t *frame, void *cookie, xlator_t *this,
                         int op_ret, int op_errno, struct iatt *preparent,
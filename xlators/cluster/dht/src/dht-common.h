@@ -64,6 +64,34 @@ typedef int (*dht_refresh_layout_unlock)(call_frame_t *frame, xlator_t *this,
 
 typedef int (*dht_refresh_layout_done_handle)(call_frame_t *frame);
 
+#define DHT_LAYOUT_CACHE_SIZE 8
+#define DHT_LAYOUT_CACHE_NAME_MAX 23
+
+/* A recently hashed name of the directory, so that looking the same name up
+ * again (lookup followed by create, open, ...) skips the regex munging and
+ * gf_dm_hashfn(). */
+struct dht_layout_cache_entry {
+    uint32_t regex_gen; /* conf->regex_gen the hash was computed with */
+    uint32_t hash;
+    uint8_t len; /* 0 when the entry is unused */
+    char name[DHT_LAYOUT_CACHE_NAME_MAX];
+};
+
+struct dht_layout_range {
+    uint32_t start;
+    uint32_t stop;
+    int index; /* of the range in layout->list */
+};
+
+/* Built once a directory layout is set in the inode ctx: the ranges sorted
+ * by start for a binary search, and the per-directory name cache. */
+struct dht_layout_search {
+    gf_lock_t lock; /* protects cache */
+    struct dht_layout_cache_entry cache[DHT_LAYOUT_CACHE_SIZE];
+    int cnt; /* 0 when the ranges overlap, search linearly */
+    struct dht_layout_range range[];
+};
+
 struct dht_layout {
     int spread_cnt; /* layout spread count per directory,
                        is controlled by 'setxattr()' with
@@ -88,6 +116,7 @@ struct dht_layout {
     int type;
     gf_atomic_t ref; /* use with dht_conf_t->layout_lock */
     uint32_t search_unhashed;
+    struct dht_layout_search *search;
     struct {
         int err; /* 0 = normal
                     -1 = dir exists and no xattr
@@ -240,6 +269,14 @@ typedef gf_boolean_t (*dht_need_heal_t)(call_frame_t *frame,
                                         dht_layout_t **inmem,
                                         dht_layout_t **ondisk);
 
+/* The lookups of a compound fop that hash to the same subvolume, sent
+ * there as one compound of their own. */
+typedef struct dht_compound_batch {
+    xlator_t *subvol;
+    compound_args_t *args;
+    int *index; /* position of each lookup in the compound of the parent */
+} dht_compound_batch_t;
+
 struct dht_local {
     loc_t loc;
     loc_t loc2;
@@ -347,6 +384,13 @@ struct dht_local {
     /* rename rollback */
     int *ret_cache;
 
+    /* batched lookups */
+    struct {
+        compound_args_cbk_t *rsp;
+        dht_compound_batch_t *batch;
+        int batch_cnt;
+    } compound;
+
     loc_t loc2_copy;
 
     int rename_inodelk_bc_count;
@@ -611,6 +655,9 @@ struct dht_conf {
 
     gf_boolean_t extra_regex_valid;
 
+    /* bumped whenever the regexes change, invalidates the name caches */
+    uint32_t regex_gen;
+
     /* Support size-weighted rebalancing (heterogeneous bricks). */
     gf_boolean_t do_weighting;
 
@@ -770,6 +817,8 @@ dht_layout_t *
 dht_layout_for_subvol(xlator_t *this, xlator_t *subvol);
 xlator_t *
 dht_layout_search(xlator_t *this, dht_layout_t *layout, const char *name);
+int
+dht_layout_search_build(dht_layout_t *layout);
 int32_t
 dht_migration_get_dst_subvol(xlator_t *this, dht_local_t *local);
 int32_t
@@ -913,6 +962,9 @@ dht_init_local_subvolumes(xlator_t *this, dht_conf_t *conf);
 int32_t
 dht_lookup(call_frame_t *frame, xlator_t *this, loc_t *loc, dict_t *xattr_req);
 
+int32_t
+dht_compound(call_frame_t *frame, xlator_t *this, void *data, dict_t *xdata);
+
 int32_t
 dht_stat(call_frame_t *frame, xlator_t *this, loc_t *loc, dict_t *xdata);
 
@@ -802,6 +802,18 @@ dht_local_wipe(dht_local_t *local)
     if (local->ret_cache)
         GF_FREE(local->ret_cache);
 
+    if (local->compound.rsp)
+        compound_args_cbk_cleanup(local->compound.rsp);
+
+    if (local->compound.batch) {
+        for (i = 0; i < local->compound.batch_cnt; i++) {
+            if (local->compound.batch[i].args)
+                compound_args_cleanup(local->compound.batch[i].args);
+            GF_FREE(local->compound.batch[i].index);
+        }
+        GF_FREE(local->compound.batch);
+    }
+
     mem_put(local);
 }
 
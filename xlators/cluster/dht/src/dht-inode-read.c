@@ -1096,16 +1096,69 @@ dht_lease_cbk(call_frame_t *frame, void *cookie, xlator_t *this, int op_ret,
     return 0;
 }
 
+static int
+dht_lease_dir_cbk(call_frame_t *frame, void *cookie, xlator_t *this,
+                  int op_ret, int op_errno, struct gf_lease *lease,
+                  dict_t *xdata)
+{
+    dht_local_t *local = NULL;
+    int this_call_cnt = 0;
+
+    local = frame->local;
+
+    LOCK(&frame->lock);
+    {
+        if (op_ret == -1) {
+            local->op_ret = -1;
+            local->op_errno = op_errno;
+        }
+    }
+    UNLOCK(&frame->lock);
+    this_call_cnt = dht_frame_return(frame);
+    if (is_last_call(this_call_cnt))
+        DHT_STACK_UNWIND(lease, frame, local->op_ret, local->op_errno, lease,
+                         xdata);
+
+    return 0;
+}
+
 int
 dht_lease(call_frame_t *frame, xlator_t *this, loc_t *loc,
           struct gf_lease *lease, dict_t *xdata)
 {
     xlator_t *subvol = NULL;
+    dht_local_t *local = NULL;
+    dht_conf_t *conf = NULL;
     int op_errno = -1;
+    int i = 0;
 
     VALIDATE_OR_GOTO(frame, err);
     VALIDATE_OR_GOTO(this, err);
     VALIDATE_OR_GOTO(loc, err);
+    VALIDATE_OR_GOTO(this->private, err);
+
+    conf = this->private;
+
+    /* The entries of a directory are created on the subvolumes their names
+     * hash to, the lease has to be held on all of them to be recalled by
+     * any change of the directory */
+    if (loc->inode && IA_ISDIR(loc->inode->ia_type)) {
+        local = dht_local_init(frame, loc, NULL, GF_FOP_LEASE);
+        if (!local) {
+            op_errno = ENOMEM;
+            goto err;
+        }
+
+        local->op_ret = 0;
+        local->call_cnt = conf->subvolume_cnt;
+
+        for (i = 0; i < conf->subvolume_cnt; i++) {
+            STACK_WIND(frame, dht_lease_dir_cbk, conf->subvolumes[i],
+                       conf->subvolumes[i]->fops->lease, loc, lease, xdata);
+        }
+
+        return 0;
+    }
 
     subvol = dht_subvol_get_cached(this, loc->inode);
     if (!subvol) {
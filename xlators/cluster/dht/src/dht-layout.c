@@ -10,7 +10,9 @@
 
 #include "dht-common.h"
 #include <glusterfs/byte-order.h>
+#include <glusterfs/hashfn.h>
 #include "unittest/unittest.h"
+#include <urcu/uatomic.h>
 
 #define layout_base_size (sizeof(dht_layout_t))
 
@@ -77,6 +79,10 @@ dht_layout_set(xlator_t *this, inode_t *inode, dht_layout_t *layout)
     if (!conf || !layout)
         goto out;
 
+    /* a failure only costs the linear search */
+    if (!layout->preset && !layout->search)
+        dht_layout_search_build(layout);
+
     LOCK(&conf->layout_lock);
     {
         oldret = dht_inode_ctx_layout_get(inode, this, &old_layout);
@@ -106,8 +112,13 @@ dht_layout_unref(dht_layout_t *layout)
 
     ref = GF_ATOMIC_DEC(layout->ref);
 
-    if (!ref)
+    if (!ref) {
+        if (layout->search) {
+            LOCK_DESTROY(&layout->search->lock);
+            GF_FREE(layout->search);
+        }
         GF_FREE(layout);
+    }
 }
 
 dht_layout_t *
@@ -121,21 +132,184 @@ dht_layout_ref(xlator_t *this, dht_layout_t *layout)
     return layout;
 }
 
+static int
+dht_layout_range_cmp(const void *a, const void *b)
+{
+    const struct dht_layout_range *ra = a;
+    const struct dht_layout_range *rb = b;
+
+    if (ra->start != rb->start)
+        return (ra->start < rb->start) ? -1 : 1;
+
+    return ra->index - rb->index;
+}
+
+int
+dht_layout_search_build(dht_layout_t *layout)
+{
+    struct dht_layout_search *search = NULL;
+    int cnt = 0;
+    int i = 0;
+
+    search = GF_CALLOC(1,
+                       sizeof(*search) + layout->cnt * sizeof(search->range[0]),
+                       gf_dht_mt_layout_search_t);
+    if (!search)
+        return -1;
+
+    LOCK_INIT(&search->lock);
+
+    for (i = 0; i < layout->cnt; i++) {
+        /* zeroed out ranges (of subvolumes without the directory) can
+         * only match hash 0, for which dht_layout_search() scans the
+         * list; inverted ones never match at all */
+        if (!layout->list[i].stop ||
+            layout->list[i].start > layout->list[i].stop)
+            continue;
+
+        search->range[cnt].start = layout->list[i].start;
+        search->range[cnt].stop = layout->list[i].stop;
+        search->range[cnt].index = i;
+        cnt++;
+    }
+
+    qsort(search->range, cnt, sizeof(search->range[0]), dht_layout_range_cmp);
+
+    for (i = 1; i < cnt; i++) {
+        /* with overlaps the first matching range of layout->list wins,
+         * which only the linear scan gets right */
+        if (search->range[i].start <= search->range[i - 1].stop) {
+            cnt = 0;
+            break;
+        }
+    }
+    search->cnt = cnt;
+
+    /* lost against a concurrent dht_layout_set() of the same layout */
+    if (uatomic_cmpxchg(&layout->search, NULL, search) != NULL) {
+        LOCK_DESTROY(&search->lock);
+        GF_FREE(search);
+    }
+
+    return 0;
+}
+
+/* Returns the position in layout->list of the range containing @hash, or -1
+ * if the sorted ranges have none. The loop runs log2(cnt) times whatever the
+ * hash, with a conditional move instead of a branch to mispredict. */
+static int
+dht_layout_range_find(dht_layout_t *layout, struct dht_layout_search *search,
+                      uint32_t hash)
+{
+    struct dht_layout_range *base = search->range;
+    int n = search->cnt;
+    int half = 0;
+    int i = 0;
+
+    if (!n)
+        return -1;
+
+    while (n > 1) {
+        half = n / 2;
+        base = (base[half].start <= hash) ? base + half : base;
+        n -= half;
+    }
+
+    if (base->start > hash || base->stop < hash)
+        return -1;
+
+    /* the layout is not supposed to change once set, but do not trust
+     * the copy blindly */
+    i = base->index;
+    if (i >= layout->cnt || layout->list[i].start != base->start ||
+        layout->list[i].stop != base->stop)
+        return -1;
+
+    return i;
+}
+
+static int
+dht_layout_hash_compute(xlator_t *this, dht_layout_t *layout,
+                        struct dht_layout_search *search, const char *name,
+                        uint32_t *hash_p)
+{
+    struct dht_layout_cache_entry *entry = NULL;
+    dht_conf_t *conf = this->private;
+    uint32_t regex_gen = 0;
+    size_t len = 0;
+    int hit = 0;
+    int ret = 0;
+
+    if (!search || !conf || !name)
+        goto nocache;
+
+    len = strlen(name);
+    if (!len || len > DHT_LAYOUT_CACHE_NAME_MAX)
+        goto nocache;
+
+    /* read before hashing: a reconfigure racing with us then leaves an
+     * entry that is already stale, never a stale entry that looks valid */
+    regex_gen = uatomic_read(&conf->regex_gen);
+    entry = &search->cache[SuperFastHash(name, len) % DHT_LAYOUT_CACHE_SIZE];
+
+    LOCK(&search->lock);
+    {
+        if (entry->len == len && entry->regex_gen == regex_gen &&
+            !memcmp(entry->name, name, len)) {
+            *hash_p = entry->hash;
+            hit = 1;
+        }
+    }
+    UNLOCK(&search->lock);
+
+    if (hit)
+        return 0;
+
+    ret = dht_hash_compute(this, layout->type, name, hash_p);
+    if (ret)
+        return ret;
+
+    LOCK(&search->lock);
+    {
+        entry->regex_gen = regex_gen;
+        entry->hash = *hash_p;
+        entry->len = len;
+        memcpy(entry->name, name, len);
+    }
+    UNLOCK(&search->lock);
+
+    return 0;
+
+nocache:
+    return dht_hash_compute(this, layout->type, name, hash_p);
+}
+
 xlator_t *
 dht_layout_search(xlator_t *this, dht_layout_t *layout, const char *name)
 {
+    struct dht_layout_search *search = NULL;
     uint32_t hash = 0;
     xlator_t *subvol = NULL;
     int i = 0;
     int ret = 0;
 
-    ret = dht_hash_compute(this, layout->type, name, &hash);
+    search = uatomic_read(&layout->search);
+
+    ret = dht_layout_hash_compute(this, layout, search, name, &hash);
     if (ret != 0) {
         gf_smsg(this->name, GF_LOG_WARNING, 0, DHT_MSG_COMPUTE_HASH_FAILED,
                 "type=%d", layout->type, "name=%s", name, NULL);
         goto out;
     }
 
+    if (search && hash) {
+        i = dht_layout_range_find(layout, search, hash);
+        if (i >= 0) {
+            subvol = layout->list[i].xlator;
+            goto out;
+        }
+    }
+
     for (i = 0; i < layout->cnt; i++) {
         if (layout->list[i].start <= hash && layout->list[i].stop >= hash) {
             subvol = layout->list[i].xlator;
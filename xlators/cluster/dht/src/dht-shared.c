@@ -317,6 +317,7 @@ dht_init_regex(xlator_t *this, dict_t *odict, char *name, regex_t *re,
 
     LOCK(&conf->lock);
     {
+        conf->regex_gen++;
         if (*re_valid) {
             regfree(re);
             *re_valid = _gf_false;
@@ -40,6 +40,7 @@ struct xlator_fops dht_pt_fops = {
 struct xlator_fops fops = {
     .ipc = dht_ipc,
     .lookup = dht_lookup,
+    .compound = dht_compound,
     .mknod = dht_mknod,
     .create = dht_create,
 
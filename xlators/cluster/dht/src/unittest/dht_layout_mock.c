@@ -15,6 +15,7 @@
 int
 dht_hash_compute(xlator_t *this, int type, const char *name, uint32_t *hash_p)
 {
+    *hash_p = mock_type(uint32_t);
     return 0;
 }
 
@@ -116,11 +116,115 @@ test_dht_layout_new(void **state)
     helper_xlator_destroy(xl);
 }
 
+/* the subvolume the linear scan of the layout finds for @hash */
+static xlator_t *
+helper_layout_scan(dht_layout_t *layout, uint32_t hash)
+{
+    int i;
+
+    for (i = 0; i < layout->cnt; i++) {
+        if (layout->list[i].start <= hash && layout->list[i].stop >= hash)
+            return layout->list[i].xlator;
+    }
+    return NULL;
+}
+
+static void
+test_dht_layout_search(void **state)
+{
+    xlator_t *xl;
+    xlator_t *subvols;
+    dht_layout_t *layout;
+    dht_conf_t *conf;
+    uint32_t chunk;
+    uint32_t hash;
+    char name[32];
+    int cnt = 97;
+    int i;
+
+    xl = helper_xlator_init(10);
+    conf = (dht_conf_t *)test_calloc(1, sizeof(dht_conf_t));
+    assert_non_null(conf);
+    xl->private = conf;
+
+    subvols = test_calloc(cnt, sizeof(xlator_t));
+    assert_non_null(subvols);
+
+    /* evenly spread ranges, stored in reverse order and with the last
+     * subvolume zeroed out as if the directory was missing on it */
+    layout = dht_layout_new(xl, cnt);
+    assert_non_null(layout);
+    chunk = 0xffffffff / (cnt - 1);
+    for (i = 0; i < cnt - 1; i++) {
+        layout->list[cnt - 2 - i].start = i * chunk;
+        layout->list[cnt - 2 - i].stop = (i == cnt - 2) ? 0xffffffff
+                                                        : (i + 1) * chunk - 1;
+        layout->list[cnt - 2 - i].xlator = &subvols[i];
+    }
+    layout->list[cnt - 1].xlator = &subvols[cnt - 1];
+
+    assert_int_equal(dht_layout_search_build(layout), 0);
+    assert_non_null(layout->search);
+    assert_int_equal(layout->search->cnt, cnt - 1);
+    for (i = 1; i < layout->search->cnt; i++)
+        assert_true(layout->search->range[i - 1].stop <
+                    layout->search->range[i].start);
+
+    /* the sorted search must agree with the linear one everywhere, the
+     * range boundaries and hash 0 included */
+    for (i = 0; i < 4096; i++) {
+        if (i < cnt - 1)
+            hash = i * chunk;
+        else if (i < 2 * (cnt - 1))
+            hash = (i - cnt + 2) * chunk - 1;
+        else
+            hash = (uint32_t)random() * 2 + (i & 1);
+
+        snprintf(name, sizeof(name), "file-%d", i);
+        will_return(dht_hash_compute, hash);
+        assert_ptr_equal(dht_layout_search(xl, layout, name),
+                         helper_layout_scan(layout, hash));
+    }
+
+    /* a name searched again is served from the cache, without hashing */
+    will_return(dht_hash_compute, 12345);
+    assert_ptr_equal(dht_layout_search(xl, layout, "cached"),
+                     helper_layout_scan(layout, 12345));
+    assert_ptr_equal(dht_layout_search(xl, layout, "cached"),
+                     helper_layout_scan(layout, 12345));
+
+    /* changing the regexes invalidates the cache */
+    conf->regex_gen++;
+    will_return(dht_hash_compute, 0xf0000000);
+    assert_ptr_equal(dht_layout_search(xl, layout, "cached"),
+                     helper_layout_scan(layout, 0xf0000000));
+
+    /* overlapping ranges leave the search to the linear scan */
+    layout->list[0].start = layout->list[1].start;
+    LOCK_DESTROY(&layout->search->lock);
+    free(layout->search);
+    layout->search = NULL;
+    assert_int_equal(dht_layout_search_build(layout), 0);
+    assert_int_equal(layout->search->cnt, 0);
+    hash = layout->list[1].start;
+    will_return(dht_hash_compute, hash);
+    assert_ptr_equal(dht_layout_search(xl, layout, "overlap"),
+                     layout->list[0].xlator);
+
+    LOCK_DESTROY(&layout->search->lock);
+    free(layout->search);
+    free(layout);
+    free(subvols);
+    free(conf);
+    helper_xlator_destroy(xl);
+}
+
 int
 main(void)
 {
     const struct CMUnitTest xlator_dht_layout_tests[] = {
         unit_test(test_dht_layout_new),
+        unit_test(test_dht_layout_search),
     };
 
     return cmocka_run_group_tests(xlator_dht_layout_tests, NULL, NULL);
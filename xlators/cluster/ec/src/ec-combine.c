@@ -955,6 +955,14 @@ ec_combine(ec_cbk_data_t *newcbk, ec_combine_f combine)
 
     fop->received |= newcbk->mask;
 
+    if (fop->answer != NULL) {
+        /* Late answer of a hedged fop. The accepted answer may already be
+         * being rebuilt, so it must not be touched. */
+        UNLOCK(&fop->lock);
+
+        return;
+    }
+
     item = fop->cbk_list.prev;
     list_for_each_entry(cbk, &fop->cbk_list, list)
     {
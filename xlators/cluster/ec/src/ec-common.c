@@ -185,11 +185,113 @@ ec_lock_conflict(ec_lock_link_t *l1, ec_lock_link_t *l2)
     return ec_is_range_conflict(l1, l2);
 }
 
+static gf_boolean_t
+ec_child_valid(ec_t *ec, ec_fop_data_t *fop, uint32_t idx);
+
+static gf_boolean_t
+ec_read_policy_is_adaptive(ec_t *ec)
+{
+    return (ec->read_policy == EC_LEAST_LOAD) ||
+           (ec->read_policy == EC_LEAST_LATENCY) ||
+           (ec->read_policy == EC_LOAD_LATENCY_HYBRID);
+}
+
+static int64_t
+ec_child_read_cost(ec_t *ec, uint32_t idx)
+{
+    int64_t pending = GF_ATOMIC_GET(ec->child_stats[idx].pending);
+    int64_t latency = GF_ATOMIC_GET(ec->child_stats[idx].latency);
+
+    switch (ec->read_policy) {
+        case EC_LEAST_LOAD:
+            return pending;
+        case EC_LEAST_LATENCY:
+            return latency;
+        default:
+            return (pending + 1) * (latency + 1);
+    }
+}
+
+/* Returns the cheapest brick still available to the fop and not in @skip.
+ * The scan starts at @start so that bricks with the same cost take turns. */
+static uint32_t
+ec_child_cheapest(ec_t *ec, ec_fop_data_t *fop, uint32_t start,
+                  uintptr_t skip)
+{
+    uint32_t i, idx, best = EC_INVALID_INDEX;
+    int64_t cost, best_cost = 0;
+
+    for (i = 0; i < ec->nodes; i++) {
+        idx = (start + i) % ec->nodes;
+        if (!ec_child_valid(ec, fop, idx) || (((skip >> idx) & 1) != 0)) {
+            continue;
+        }
+        cost = ec_child_read_cost(ec, idx);
+        if ((best == EC_INVALID_INDEX) || (cost < best_cost)) {
+            best = idx;
+            best_cost = cost;
+        }
+    }
+
+    return best;
+}
+
+void
+ec_child_stats_sample(ec_t *ec, int32_t idx, int64_t latency)
+{
+    int64_t avg;
+
+    /* Moving average giving 1/8 of the weight to the new sample. Two
+     * concurrent updates may lose one of the samples, which is harmless. */
+    avg = GF_ATOMIC_GET(ec->child_stats[idx].latency);
+    GF_ATOMIC_SWAP(ec->child_stats[idx].latency, avg + (latency - avg) / 8);
+}
+
+void
+ec_read_stats_wind(ec_t *ec, ec_fop_data_t *fop, int32_t idx)
+{
+    GF_ATOMIC_INC(ec->child_stats[idx].pending);
+}
+
+void
+ec_read_stats_done(ec_t *ec, ec_fop_data_t *fop, int32_t idx)
+{
+    struct timespec now;
+
+    GF_ATOMIC_DEC(ec->child_stats[idx].pending);
+
+    /* Only the bricks of the first dispatch share its start time. */
+    if (((fop->timed >> idx) & 1) == 0) {
+        return;
+    }
+
+    timespec_now(&now);
+    ec_child_stats_sample(ec, idx,
+                          gf_tsdiff(&fop->dispatch_time, &now) / 1000);
+}
+
+static int32_t
+ec_read_hedge_count(ec_t *ec, ec_fop_data_t *fop)
+{
+    /* Internal reads, like the head and tail of a write, are waited for by
+     * their parent fop anyway. */
+    if ((fop->parent != NULL) || (fop->minimum != ec->fragments)) {
+        return 0;
+    }
+
+    return min(ec->read_hedge_count, ec->redundancy);
+}
+
 uint32_t
 ec_select_first_by_read_policy(ec_t *ec, ec_fop_data_t *fop)
 {
+    uint32_t idx;
+
     if (ec->read_policy == EC_ROUND_ROBIN) {
         return ec->idx;
+    } else if (ec_read_policy_is_adaptive(ec)) {
+        idx = ec_child_cheapest(ec, fop, ec->idx, 0);
+        return (idx != EC_INVALID_INDEX) ? idx : ec->idx;
     } else if (ec->read_policy == EC_GFID_HASH) {
         if (fop->use_fd) {
             return SuperFastHash((char *)fop->fd->inode->gfid,
@@ -536,6 +638,7 @@ void
 ec_complete(ec_fop_data_t *fop)
 {
     ec_cbk_data_t *cbk = NULL;
+    uintptr_t good = 0;
     int32_t resume = 0, update = 0;
     int healing_count = 0;
 
@@ -552,11 +655,28 @@ ec_complete(ec_fop_data_t *fop)
                  * successful on at least fop->minimum good copies*/
                 if ((cbk->count - healing_count) >= fop->minimum) {
                     fop->answer = cbk;
+                    good = cbk->mask;
 
                     update = 1;
                 }
             }
 
+            resume = 1;
+        }
+    } else if (((fop->flags & EC_FLAG_HEDGED) != 0) && (fop->answer == NULL) &&
+               !list_empty(&fop->cbk_list)) {
+        /* A hedged fop doesn't wait for the slowest bricks once enough
+         * successful answers agree. The bricks still running the request
+         * are not bad, so they are kept in the good mask. */
+        cbk = list_entry(fop->cbk_list.next, ec_cbk_data_t, list);
+        healing_count = gf_bits_count(cbk->mask & fop->healing);
+        if ((cbk->op_ret >= 0) &&
+            ((cbk->count - healing_count) >= fop->minimum)) {
+            fop->answer = cbk;
+            good = cbk->mask |
+                   ((fop->mask ^ fop->remaining) & ~fop->received);
+
+            update = 1;
             resume = 1;
         }
     }
@@ -568,7 +688,7 @@ ec_complete(ec_fop_data_t *fop)
        be called more than once for each fop, it can be called from outside
        the fop->lock locked region. */
     if (update) {
-        ec_update_good(fop, cbk->mask);
+        ec_update_good(fop, good);
     }
 
     if (resume) {
@@ -706,7 +826,7 @@ ec_child_select(ec_fop_data_t *fop)
             fop->minimum = 1;
     }
 
-    if (ec->read_policy == EC_ROUND_ROBIN) {
+    if ((ec->read_policy == EC_ROUND_ROBIN) || ec_read_policy_is_adaptive(ec)) {
         first = ec->idx;
         if (++first >= ec->nodes) {
             first = 0;
@@ -887,16 +1007,31 @@ ec_dispatch_min(ec_fop_data_t *fop)
     if (ec_child_select(fop)) {
         ec_sleep(fop);
 
-        fop->expected = count = ec->fragments;
+        fop->expected = ec->fragments;
+        count = ec->fragments + ec_read_hedge_count(ec, fop);
         fop->first = ec_select_first_by_read_policy(fop->xl->private, fop);
         idx = fop->first - 1;
         mask = 0;
         while (count-- > 0) {
-            idx = ec_child_next(ec, fop, idx + 1);
+            if (ec_read_policy_is_adaptive(ec)) {
+                idx = ec_child_cheapest(ec, fop, fop->first, mask);
+            } else {
+                idx = ec_child_next(ec, fop, idx + 1);
+            }
             if (idx < EC_MAX_NODES)
                 mask |= 1ULL << idx;
         }
 
+        /* Hedged reads ask for more fragments than needed and are decoded
+         * from the first ones that agree, see ec_complete(). */
+        if (gf_bits_count(mask) > fop->expected) {
+            fop->expected = gf_bits_count(mask);
+            fop->flags |= EC_FLAG_HEDGED;
+        }
+
+        fop->timed = mask;
+        timespec_now(&fop->dispatch_time);
+
         ec_dispatch_mask(fop, mask);
     }
 }
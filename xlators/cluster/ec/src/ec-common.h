@@ -24,6 +24,9 @@ typedef enum { EC_DATA_TXN, EC_METADATA_TXN } ec_txn_t;
 #define EC_CONFIG_ALGORITHM 0
 
 #define EC_FLAG_LOCK_SHARED 0x0001
+/* The fop has been sent to more bricks than needed and can be answered as
+ * soon as enough of them agree. */
+#define EC_FLAG_HEDGED 0x0002
 
 #define QUORUM_CBK(fn, fop, frame, cookie, this, op_ret, op_errno, params...)  \
     do {                                                                       \
@@ -185,6 +188,15 @@ void
 ec_dispatch_inc(ec_fop_data_t *fop);
 void
 ec_dispatch_min(ec_fop_data_t *fop);
+
+void
+ec_child_stats_sample(ec_t *ec, int32_t idx, int64_t latency);
+
+void
+ec_read_stats_wind(ec_t *ec, ec_fop_data_t *fop, int32_t idx);
+
+void
+ec_read_stats_done(ec_t *ec, ec_fop_data_t *fop, int32_t idx);
 void
 ec_dispatch_one(ec_fop_data_t *fop);
 
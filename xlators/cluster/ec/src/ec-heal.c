@@ -346,16 +346,51 @@ ec_heal_readv_cbk(call_frame_t *frame, void *cookie, xlator_t *this,
     return 0;
 }
 
+/* Reads all the windows of the block at once. Each window is decoded in the
+ * callback of its read and written as soon as it is ready, the block is done
+ * once all the windows have been written. */
 void
 ec_heal_data_block(ec_heal_t *heal)
 {
+    ec_heal_t *window = NULL;
+    int32_t i;
+
     ec_trace("DATA", heal->fop, "good=%lX, bad=%lX", heal->good, heal->bad);
 
-    if ((heal->good != 0) && (heal->bad != 0) &&
-        (heal->iatt.ia_type == IA_IFREG)) {
-        ec_readv(heal->fop->frame, heal->xl, heal->good, EC_MINIMUM_MIN,
-                 ec_heal_readv_cbk, heal, heal->fd, heal->size, heal->offset, 0,
-                 NULL);
+    if ((heal->good == 0) || (heal->bad == 0) ||
+        (heal->iatt.ia_type != IA_IFREG)) {
+        return;
+    }
+
+    for (i = 0; i < heal->window_count; i++) {
+        window = &heal->windows[i];
+        window->fop = heal->fop;
+        window->xl = heal->xl;
+        window->fd = heal->fd;
+        window->iatt.ia_type = heal->iatt.ia_type;
+        window->good = heal->good;
+        window->bad = heal->bad;
+        window->done = 0;
+        window->size = heal->size;
+        window->offset = heal->offset + i * heal->size;
+
+        ec_readv(heal->fop->frame, heal->xl, window->good, EC_MINIMUM_MIN,
+                 ec_heal_readv_cbk, window, heal->fd, window->size,
+                 window->offset, 0, NULL);
+    }
+}
+
+static void
+ec_heal_data_block_merge(ec_heal_t *heal)
+{
+    int32_t i;
+
+    for (i = 0; i < heal->window_count; i++) {
+        heal->good &= heal->windows[i].good;
+        heal->bad &= heal->windows[i].bad;
+        if (heal->windows[i].done) {
+            heal->done = 1;
+        }
     }
 }
 
@@ -1963,6 +1998,7 @@ ec_manager_heal_block(ec_fop_data_t *fop, int32_t state)
         case -EC_STATE_HEAL_DATA_COPY:
         case -EC_STATE_HEAL_DATA_UNLOCK:
         case EC_STATE_HEAL_DATA_UNLOCK:
+            ec_heal_data_block_merge(heal);
             ec_heal_inodelk(heal, F_UNLCK, 1, 0, 0);
 
             return EC_STATE_REPORT;
@@ -2050,12 +2086,77 @@ ec_sync_heal_block(call_frame_t *frame, xlator_t *this, ec_heal_t *heal)
     return 0;
 }
 
+/* Finds the extent of data of the file which starts at or after *offset, as
+ * seen by the first source, and returns it in *offset and *end, both aligned
+ * to @align. *offset is set to @size if only holes are left. When the source
+ * can't tell, everything up to @size is treated as data. */
+static void
+ec_heal_data_extent(ec_t *ec, fd_t *fd, unsigned char *sources, uint64_t align,
+                    uint64_t size, uint64_t *offset, uint64_t *end)
+{
+    xlator_t *source = NULL;
+    off_t data = 0;
+    off_t hole = 0;
+    uint64_t start = 0;
+    int ret = 0;
+    int i = 0;
+
+    *end = size;
+
+    for (i = 0; i < ec->nodes; i++) {
+        if (sources[i]) {
+            source = ec->xl_list[i];
+            break;
+        }
+    }
+    if (source == NULL) {
+        return;
+    }
+
+    /* Offsets of the file map to offsets of the fragments stripe by
+     * stripe, a stripe holds fragment_size bytes of each fragment. */
+    ret = syncop_seek(source, fd, *offset / ec->fragments, GF_SEEK_DATA, NULL,
+                      &data);
+    if (ret == -ENXIO) {
+        *offset = size;
+        return;
+    }
+    if (ret < 0) {
+        return;
+    }
+
+    start = (data / ec->fragment_size) * ec->stripe_size;
+    start -= start % align;
+    if (start > *offset) {
+        *offset = start;
+    }
+
+    ret = syncop_seek(source, fd, data, GF_SEEK_HOLE, NULL, &hole);
+    if (ret < 0) {
+        return;
+    }
+
+    hole = ((hole + ec->fragment_size - 1) / ec->fragment_size) *
+           ec->stripe_size;
+    hole += (align - hole % align) % align;
+    if (hole < size) {
+        *end = hole;
+    }
+}
+
 int
 ec_rebuild_data(call_frame_t *frame, ec_t *ec, fd_t *fd, uint64_t size,
                 unsigned char *sources, unsigned char *healed_sinks)
 {
     ec_heal_t *heal = NULL;
+    struct timespec start;
+    struct timespec end;
+    uint64_t extent_end = 0;
+    uint64_t copied = 0;
+    uint64_t usecs = 0;
+    uint32_t depth = ec->self_heal_pipeline_depth;
     int ret = 0;
+    int i = 0;
     syncbarrier_t barrier;
 
     if (syncbarrier_init(&barrier))
@@ -2077,9 +2178,18 @@ ec_rebuild_data(call_frame_t *frame, ec_t *ec, fd_t *fd, uint64_t size,
     heal->good = ec_char_array_to_mask(sources, ec->nodes);
     heal->iatt.ia_type = IA_IFREG;
     LOCK_INIT(&heal->lock);
+    heal->windows = alloca0(depth * sizeof(*heal->windows));
+    for (i = 0; i < depth; i++) {
+        LOCK_INIT(&heal->windows[i].lock);
+    }
 
-    for (heal->offset = 0; (heal->offset < size) && !heal->done;
-         heal->offset += heal->size) {
+    timespec_now(&start);
+
+    /* Each block covers up to 'depth' windows of the current extent of
+     * data. Holes are not copied, the sinks have been emptied by
+     * __ec_heal_trim_sinks(). */
+    heal->offset = 0;
+    while ((heal->offset < size) && !heal->done) {
         /* We immediately abort any heal if a shutdown request has been
          * received to avoid delays. The healing of this file will be
          * restarted by another SHD or other client that accesses the
@@ -2092,19 +2202,61 @@ ec_rebuild_data(call_frame_t *frame, ec_t *ec, fd_t *fd, uint64_t size,
             break;
         }
 
+        if (heal->offset >= extent_end) {
+            ec_heal_data_extent(ec, fd, sources, heal->size, size,
+                                &heal->offset, &extent_end);
+            if (heal->offset >= size) {
+                break;
+            }
+        }
+
+        heal->window_count = (extent_end - heal->offset + heal->size - 1) /
+                             heal->size;
+        if (heal->window_count > depth) {
+            heal->window_count = depth;
+        }
+
         gf_msg_debug(ec->xl->name, 0,
                      "%s: sources: %d, sinks: "
-                     "%d, offset: %" PRIu64 " bsize: %" PRIu64,
+                     "%d, offset: %" PRIu64 " bsize: %" PRIu64
+                     " windows: %d",
                      uuid_utoa(fd->inode->gfid), EC_COUNT(sources, ec->nodes),
                      EC_COUNT(healed_sinks, ec->nodes), heal->offset,
-                     heal->size);
+                     heal->size, heal->window_count);
         ret = ec_sync_heal_block(frame, ec->xl, heal);
         if (ret < 0)
             break;
+
+        heal->offset += heal->window_count * heal->size;
+        copied += heal->window_count * heal->size;
     }
+
+    timespec_now(&end);
     memset(healed_sinks, 0, ec->nodes);
     ec_mask_to_char_array(heal->bad, healed_sinks, ec->nodes);
+
+    if (ret == 0) {
+        if (copied > size) {
+            copied = size;
+        }
+        usecs = gf_tsdiff(&start, &end) / 1000;
+        for (i = 0; i < ec->nodes; i++) {
+            if (!healed_sinks[i])
+                continue;
+            GF_ATOMIC_ADD(ec->child_stats[i].heal_bytes,
+                          copied / ec->fragments);
+            GF_ATOMIC_ADD(ec->child_stats[i].heal_usecs, usecs);
+        }
+        gf_msg_debug(ec->xl->name, 0,
+                     "%s: healed %" PRIu64 " of %" PRIu64
+                     " bytes in %" PRIu64 " usecs",
+                     uuid_utoa(fd->inode->gfid), copied, size, usecs);
+    }
+
     fd_unref(heal->fd);
+    for (i = 0; i < depth; i++) {
+        LOCK_DESTROY(&heal->windows[i].lock);
+    }
     LOCK_DESTROY(&heal->lock);
     syncbarrier_destroy(heal->data);
     if (ret < 0)
@@ -2127,16 +2279,25 @@ __ec_heal_trim_sinks(call_frame_t *frame, ec_t *ec, fd_t *fd,
     EC_REPLIES_ALLOC(replies, ec->nodes);
     output = alloca0(ec->nodes);
 
-    if (EC_COUNT(trim, ec->nodes) == 0) {
-        ret = 0;
-        goto out;
+    /* ec_rebuild_data() does not copy the holes of the file, so the sinks
+     * are emptied and then extended to the size of the fragments, reading
+     * zeros wherever nothing is written. */
+    if (EC_COUNT(trim, ec->nodes) != 0) {
+        ret = cluster_ftruncate(ec->xl_list, trim, ec->nodes, replies, output,
+                                frame, ec->xl, fd, 0, NULL);
+        for (i = 0; i < ec->nodes; i++) {
+            if (!output[i] && trim[i])
+                healed_sinks[i] = 0;
+        }
+        cluster_replies_wipe(replies, ec->nodes);
     }
+
     trim_offset = size;
     ec_adjust_offset_up(ec, &trim_offset, _gf_true);
-    ret = cluster_ftruncate(ec->xl_list, trim, ec->nodes, replies, output,
-                            frame, ec->xl, fd, trim_offset, NULL);
+    ret = cluster_ftruncate(ec->xl_list, healed_sinks, ec->nodes, replies,
+                            output, frame, ec->xl, fd, trim_offset, NULL);
     for (i = 0; i < ec->nodes; i++) {
-        if (!output[i] && trim[i])
+        if (!output[i] && healed_sinks[i])
             healed_sinks[i] = 0;
     }
 
@@ -233,6 +233,37 @@ ec_shd_selfheal(struct subvol_healer *healer, int child, loc_t *loc,
     return ret;
 }
 
+/* Lets fewer heals run together while the clients of the bricks wait for
+ * their fops longer than the target, and more again when they do not. */
+static void
+ec_shd_throttle(struct subvol_healer *healer)
+{
+    ec_t *ec = healer->this->private;
+    syncop_throttle_t *throttle = &healer->throttle;
+    uint32_t limit = syncop_throttle_limit(throttle);
+    uint64_t latency = 0;
+    uint64_t worst = 0;
+    int i = 0;
+
+    if (!syncop_throttle_due(throttle))
+        return;
+
+    for (i = 0; throttle->target && (i < ec->nodes); i++) {
+        if (!(ec->xl_up & (1ULL << i)))
+            continue;
+        if (syncop_subvol_load(ec->xl_list[i], &latency) == 0)
+            worst = max(worst, latency);
+    }
+
+    syncop_throttle_adjust(throttle, worst, ec->shd.max_threads);
+
+    if (syncop_throttle_limit(throttle) != limit)
+        gf_msg_debug(healer->this->name, 0,
+                     "%u heals of %s allowed, clients wait %" PRIu64 "us",
+                     syncop_throttle_limit(throttle),
+                     ec->xl_list[healer->subvol]->name, worst);
+}
+
 int
 ec_shd_index_heal(xlator_t *subvol, gf_dirent_t *entry, loc_t *parent,
                   void *data)
@@ -267,6 +298,9 @@ ec_shd_index_heal(xlator_t *subvol, gf_dirent_t *entry, loc_t *parent,
         goto out;
 
     ec_shd_selfheal(healer, healer->subvol, &loc, _gf_false);
+
+    GF_ATOMIC_INC(healer->throttle.done);
+    ec_shd_throttle(healer);
 out:
     if (ret == -ENOENT || ret == -ESTALE) {
         gf_msg(healer->this->name, GF_LOG_DEBUG, 0, EC_MSG_HEAL_FAIL,
@@ -304,10 +338,18 @@ ec_shd_index_sweep(struct subvol_healer *healer)
         goto out;
     }
 
+    syncop_throttle_reset(&healer->throttle,
+                          ec->shd.client_latency_target * 1000,
+                          ec->shd.max_threads);
+    /* Start from the load of the bricks now rather than from where the
+     * previous crawl left the limit. */
+    ec_shd_throttle(healer);
+
     _mask_cancellation();
     ret = syncop_mt_dir_scan(NULL, subvol, &loc, GF_CLIENT_PID_SELF_HEALD,
                              healer, ec_shd_index_heal, xdata,
-                             ec->shd.max_threads, ec->shd.wait_qlength);
+                             ec->shd.max_threads, &healer->throttle,
+                             ec->shd.wait_qlength);
     _unmask_cancellation();
 out:
     if (xdata)
@@ -469,6 +511,8 @@ ec_shd_healer_init(xlator_t *this, struct subvol_healer *healer)
     healer->this = this;
     healer->running = _gf_false;
     healer->rerun = _gf_false;
+    syncop_throttle_init(&healer->throttle, 0,
+                         ((ec_t *)this->private)->shd.max_threads);
 out:
     return ret;
 }
@@ -1165,13 +1165,24 @@ ec_readv_rebuild(ec_t *ec, ec_fop_data_t *fop, ec_cbk_data_t *cbk)
     GF_ASSERT(ec_get_inode_size(fop, fop->fd->inode, &cbk->iatt[0].ia_size));
 
     if (cbk->op_ret > 0) {
-        void *blocks[cbk->count];
-        uint32_t values[cbk->count];
+        void *blocks[ec->fragments];
+        uint32_t values[ec->fragments];
+        uintptr_t mask = cbk->mask;
+
+        /* A hedged read can be answered by more bricks than needed, as the
+         * late answers keep being combined into it. Only as many as there
+         * are fragments are decoded. */
+        while (gf_bits_count(mask) > ec->fragments) {
+            mask &= mask - 1;
+        }
 
         fsize = cbk->op_ret;
         size = fsize * ec->fragments;
         for (ans = cbk; ans != NULL; ans = ans->next) {
-            pos = gf_bits_count(cbk->mask & ((1 << ans->idx) - 1));
+            if ((mask & (1ULL << ans->idx)) == 0) {
+                continue;
+            }
+            pos = gf_bits_count(mask & ((1ULL << ans->idx) - 1));
             values[pos] = ans->idx + 1;
             blocks[pos] = ans->vector[0].iov_base;
             if ((ans->int32 != 1) ||
@@ -1193,8 +1204,7 @@ ec_readv_rebuild(ec_t *ec, ec_fop_data_t *fop, ec_cbk_data_t *cbk)
             goto out;
         }
 
-        err = ec_method_decode(&ec->matrix, fsize, cbk->mask, values, blocks,
-                               ptr);
+        err = ec_method_decode(&ec->matrix, fsize, mask, values, blocks, ptr);
         if (err != 0) {
             goto out;
         }
@@ -1281,6 +1291,8 @@ ec_readv_cbk(call_frame_t *frame, void *cookie, xlator_t *this, int32_t op_ret,
     ec_trace("CBK", fop, "idx=%d, frame=%p, op_ret=%d, op_errno=%d", idx, frame,
              op_ret, op_errno);
 
+    ec_read_stats_done(ec, fop, idx);
+
     cbk = ec_cbk_data_allocate(frame, this, fop, GF_FOP_READ, idx, op_ret,
                                op_errno);
     if (cbk != NULL) {
@@ -1343,6 +1355,8 @@ ec_wind_readv(ec_t *ec, ec_fop_data_t *fop, int32_t idx)
 {
     ec_trace("WIND", fop, "idx=%d", idx);
 
+    ec_read_stats_wind(ec, fop, idx);
+
     STACK_WIND_COOKIE(fop->frame, ec_readv_cbk, (void *)(uintptr_t)idx,
                       ec->xl_list[idx], ec->xl_list[idx]->fops->readv, fop->fd,
                       fop->size, fop->offset, fop->uint32, fop->xdata);
@@ -15,6 +15,7 @@
 #include <glusterfs/timer.h>
 #include "libxlator.h"
 #include <glusterfs/atomic.h>
+#include <glusterfs/syncop-utils.h>
 
 #define EC_GF_MAX_REGS 16
 
@@ -121,6 +122,9 @@ typedef struct _ec_self_heald ec_self_heald_t;
 struct _ec_statistics;
 typedef struct _ec_statistics ec_statistics_t;
 
+struct _ec_child_stats;
+typedef struct _ec_child_stats ec_child_stats_t;
+
 struct _ec;
 typedef struct _ec ec_t;
 
@@ -128,7 +132,14 @@ typedef void (*ec_wind_f)(ec_t *, ec_fop_data_t *, int32_t);
 typedef int32_t (*ec_handler_f)(ec_fop_data_t *, int32_t);
 typedef void (*ec_resume_f)(ec_fop_data_t *, int32_t);
 
-enum _ec_read_policy { EC_ROUND_ROBIN, EC_GFID_HASH, EC_READ_POLICY_MAX };
+enum _ec_read_policy {
+    EC_ROUND_ROBIN,
+    EC_GFID_HASH,
+    EC_LEAST_LOAD,
+    EC_LEAST_LATENCY,
+    EC_LOAD_LATENCY_HYBRID,
+    EC_READ_POLICY_MAX
+};
 
 enum _ec_heal_need {
     EC_HEAL_NONEED,
@@ -347,6 +358,8 @@ struct _ec_fop_data {
     uintptr_t remaining;
     uintptr_t received; /* Mask of responses */
     uintptr_t good;
+    uintptr_t timed; /* Mask of answers used to sample brick latency */
+    struct timespec dispatch_time;
 
     uid_t uid;
     gid_t gid;
@@ -586,6 +599,8 @@ struct _ec_heal {
     uint64_t total_size;
     uint64_t version[2];
     uint64_t raw_size;
+    struct _ec_heal *windows; /* Windows healed in parallel by a data block */
+    int32_t window_count;
 };
 
 struct subvol_healer {
@@ -596,6 +611,7 @@ struct subvol_healer {
     pthread_mutex_t mutex;
     pthread_cond_t cond;
     pthread_t thread;
+    syncop_throttle_t throttle; /* of the index heals */
 };
 
 struct _ec_self_heald {
@@ -604,10 +620,20 @@ struct _ec_self_heald {
     time_t timeout;
     uint32_t max_threads;
     uint32_t wait_qlength;
+    uint32_t client_latency_target; /* msecs, 0 not to throttle the heals */
     struct subvol_healer *index_healers;
     struct subvol_healer *full_healers;
 };
 
+/* Live view of each brick used by the load and latency aware read
+ * policies. Only reads are accounted. */
+struct _ec_child_stats {
+    gf_atomic_t pending;    /* Reads sent and not answered yet. */
+    gf_atomic_t latency;    /* Moving average of the read latency in usecs. */
+    gf_atomic_t heal_bytes; /* Data written to the brick by self-heal. */
+    gf_atomic_t heal_usecs; /* Time spent healing the data of the brick. */
+};
+
 struct _ec_statistics {
     struct {
         gf_atomic_t hits;    /* Cache hits. */
@@ -671,6 +697,7 @@ struct _ec {
     uint32_t background_heals;
     uint32_t heal_wait_qlen;
     uint32_t self_heal_window_size; /* max size of read/writes */
+    uint32_t self_heal_pipeline_depth; /* windows healed at once per file */
     time_t eager_lock_timeout;
     time_t other_eager_lock_timeout;
     struct list_head pending_fops;
@@ -683,6 +710,8 @@ struct _ec {
     char vol_uuid[UUID_SIZE + 1];
     dict_t *leaf_to_subvolid;
     ec_read_policy_t read_policy;
+    uint32_t read_hedge_count; /* Extra fragments requested by reads */
+    ec_child_stats_t *child_stats;
     ec_matrix_list_t matrix;
     ec_statistics_t stats;
 };
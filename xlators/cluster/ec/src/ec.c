@@ -28,6 +28,9 @@
 static char *ec_read_policies[EC_READ_POLICY_MAX + 1] = {
     [EC_ROUND_ROBIN] = "round-robin",
     [EC_GFID_HASH] = "gfid-hash",
+    [EC_LEAST_LOAD] = "least-load",
+    [EC_LEAST_LATENCY] = "least-latency",
+    [EC_LOAD_LATENCY_HYBRID] = "load-latency-hybrid",
     [EC_READ_POLICY_MAX] = NULL};
 
 #define EC_INTERNAL_XATTR_OR_GOTO(name, xattr, op_errno, label)                \
@@ -108,11 +111,23 @@ ec_prepare_childs(xlator_t *this)
 
         return ENOMEM;
     }
+    ec->child_stats = GF_CALLOC(count, sizeof(ec->child_stats[0]),
+                                ec_mt_ec_child_stats_t);
+    if (ec->child_stats == NULL) {
+        gf_msg(this->name, GF_LOG_ERROR, ENOMEM, EC_MSG_NO_MEMORY,
+               "Allocation of child statistics failed");
+
+        return ENOMEM;
+    }
     ec->xl_up = 0;
     ec->xl_up_count = 0;
 
     count = 0;
     for (child = this->children; child != NULL; child = child->next) {
+        GF_ATOMIC_INIT(ec->child_stats[count].pending, 0);
+        GF_ATOMIC_INIT(ec->child_stats[count].latency, 0);
+        GF_ATOMIC_INIT(ec->child_stats[count].heal_bytes, 0);
+        GF_ATOMIC_INIT(ec->child_stats[count].heal_usecs, 0);
         ec->xl_list[count++] = child->xlator;
     }
 
@@ -179,6 +194,9 @@ __ec_destroy_private(xlator_t *this)
             ec->xl_list = NULL;
         }
 
+        GF_FREE(ec->child_stats);
+        ec->child_stats = NULL;
+
         if (ec->fop_pool != NULL) {
             mem_pool_destroy(ec->fop_pool);
         }
@@ -271,14 +289,20 @@ reconfigure(xlator_t *this, dict_t *options)
                      failed);
     GF_OPTION_RECONF("self-heal-window-size", ec->self_heal_window_size,
                      options, uint32, failed);
+    GF_OPTION_RECONF("self-heal-pipeline-depth", ec->self_heal_pipeline_depth,
+                     options, uint32, failed);
     GF_OPTION_RECONF("heal-timeout", ec->shd.timeout, options, time, failed);
     ec_configure_background_heal_opts(ec, background_heals, heal_wait_qlen);
     GF_OPTION_RECONF("shd-max-threads", ec->shd.max_threads, options, uint32,
                      failed);
     GF_OPTION_RECONF("shd-wait-qlength", ec->shd.wait_qlength, options, uint32,
                      failed);
+    GF_OPTION_RECONF("shd-client-latency-target", ec->shd.client_latency_target,
+                     options, uint32, failed);
 
     GF_OPTION_RECONF("read-policy", read_policy, options, str, failed);
+    GF_OPTION_RECONF("read-hedge-count", ec->read_hedge_count, options, uint32,
+                     failed);
 
     GF_OPTION_RECONF("optimistic-change-log", ec->optimistic_changelog, options,
                      bool, failed);
@@ -606,6 +630,13 @@ ec_notify(xlator_t *this, int32_t event, void *data, void *data2)
         }
     }
 
+    if ((event == GF_EVENT_CHILD_PING) && (idx < ec->nodes)) {
+        /* Keeps the latency of bricks that are not being read from up to
+         * date, otherwise a brick that was slow once would never be
+         * selected again by the latency aware read policies. */
+        ec_child_stats_sample(ec, idx, (int64_t)(uintptr_t)data2 * 1000);
+    }
+
     LOCK(&ec->lock);
 
     if (event == GF_EVENT_PARENT_UP) {
@@ -855,15 +886,20 @@ init(xlator_t *this)
     GF_OPTION_INIT("heal-wait-qlength", ec->heal_wait_qlen, uint32, failed);
     GF_OPTION_INIT("self-heal-window-size", ec->self_heal_window_size, uint32,
                    failed);
+    GF_OPTION_INIT("self-heal-pipeline-depth", ec->self_heal_pipeline_depth,
+                   uint32, failed);
     ec_configure_background_heal_opts(ec, ec->background_heals,
                                       ec->heal_wait_qlen);
     GF_OPTION_INIT("read-policy", read_policy, str, failed);
     if (ec_assign_read_policy(ec, read_policy))
         goto failed;
+    GF_OPTION_INIT("read-hedge-count", ec->read_hedge_count, uint32, failed);
 
     GF_OPTION_INIT("heal-timeout", ec->shd.timeout, time, failed);
     GF_OPTION_INIT("shd-max-threads", ec->shd.max_threads, uint32, failed);
     GF_OPTION_INIT("shd-wait-qlength", ec->shd.wait_qlength, uint32, failed);
+    GF_OPTION_INIT("shd-client-latency-target", ec->shd.client_latency_target,
+                   uint32, failed);
     GF_OPTION_INIT("optimistic-change-log", ec->optimistic_changelog, bool,
                    failed);
     GF_OPTION_INIT("parallel-writes", ec->parallel_writes, bool, failed);
@@ -1531,7 +1567,12 @@ ec_dump_private(xlator_t *this)
 {
     ec_t *ec = NULL;
     char key_prefix[GF_DUMP_MAX_BUF_LEN];
+    char key[64];
     char tmp[65];
+    uint64_t heal_bytes;
+    uint64_t heal_usecs;
+    syncop_throttle_t *throttle;
+    int32_t i;
 
     GF_ASSERT(this);
 
@@ -1556,9 +1597,45 @@ ec_dump_private(xlator_t *this)
     gf_proc_dump_write("heal-wait-qlength", "%d", ec->heal_wait_qlen);
     gf_proc_dump_write("self-heal-window-size", "%" PRIu32,
                        ec->self_heal_window_size);
+    gf_proc_dump_write("self-heal-pipeline-depth", "%" PRIu32,
+                       ec->self_heal_pipeline_depth);
     gf_proc_dump_write("healers", "%d", ec->healers);
     gf_proc_dump_write("heal-waiters", "%d", ec->heal_waiters);
     gf_proc_dump_write("read-policy", "%s", ec_read_policies[ec->read_policy]);
+    gf_proc_dump_write("read-hedge-count", "%u", ec->read_hedge_count);
+    gf_proc_dump_write("shd-client-latency-target", "%u",
+                       ec->shd.client_latency_target);
+    for (i = 0; i < ec->nodes; i++) {
+        snprintf(key, sizeof(key), "child[%d].pending-reads", i);
+        gf_proc_dump_write(key, "%" GF_PRI_ATOMIC,
+                           GF_ATOMIC_GET(ec->child_stats[i].pending));
+        snprintf(key, sizeof(key), "child[%d].read-latency-usec", i);
+        gf_proc_dump_write(key, "%" GF_PRI_ATOMIC,
+                           GF_ATOMIC_GET(ec->child_stats[i].latency));
+        heal_bytes = GF_ATOMIC_GET(ec->child_stats[i].heal_bytes);
+        heal_usecs = GF_ATOMIC_GET(ec->child_stats[i].heal_usecs);
+        snprintf(key, sizeof(key), "child[%d].healed-bytes", i);
+        gf_proc_dump_write(key, "%" PRIu64, heal_bytes);
+        snprintf(key, sizeof(key), "child[%d].heal-throughput-KBps", i);
+        /* in KB first, bytes * 10^6 overflows past 16TB healed */
+        gf_proc_dump_write(key, "%" PRIu64,
+                           heal_usecs ? (heal_bytes >> 10) * 1000000 / heal_usecs
+                                      : 0);
+        if (!ec->shd.iamshd || !ec->shd.index_healers)
+            continue;
+        throttle = &ec->shd.index_healers[i].throttle;
+        snprintf(key, sizeof(key), "child[%d].shd-heal-limit", i);
+        gf_proc_dump_write(key, "%u", syncop_throttle_limit(throttle));
+        snprintf(key, sizeof(key), "child[%d].shd-heals-per-min", i);
+        gf_proc_dump_write(key, "%" PRIu64, throttle->rate);
+        snprintf(key, sizeof(key), "child[%d].shd-heals", i);
+        gf_proc_dump_write(key, "%" GF_PRI_ATOMIC,
+                           GF_ATOMIC_GET(throttle->done));
+        snprintf(key, sizeof(key), "child[%d].shd-client-latency-usec", i);
+        gf_proc_dump_write(key, "%" PRIu64, throttle->latency);
+        snprintf(key, sizeof(key), "child[%d].shd-heal-backoffs", i);
+        gf_proc_dump_write(key, "%" PRIu64, throttle->backoffs);
+    }
     gf_proc_dump_write("parallel-writes", "%d", ec->parallel_writes);
     gf_proc_dump_write("quorum-count", "%u", ec->quorum_count);
 
@@ -1747,7 +1824,8 @@ struct volume_options options[] = {
     {
         .key = {"read-policy"},
         .type = GF_OPTION_TYPE_STR,
-        .value = {"round-robin", "gfid-hash"},
+        .value = {"round-robin", "gfid-hash", "least-load", "least-latency",
+                  "load-latency-hybrid"},
         .default_value = "gfid-hash",
         .op_version = {GD_OP_VERSION_3_7_6},
         .flags = OPT_FLAG_SETTABLE | OPT_FLAG_CLIENT_OPT | OPT_FLAG_DOC,
@@ -1756,7 +1834,26 @@ struct volume_options options[] = {
             "inode-read fops happen only on 'k' number of bricks in"
             " n=k+m disperse subvolume. 'round-robin' selects the read"
             " subvolume using round-robin algo. 'gfid-hash' selects read"
-            " subvolume based on hash of the gfid of that file/directory.",
+            " subvolume based on hash of the gfid of that file/directory."
+            " 'least-load' selects the bricks with the fewest reads in"
+            " flight. 'least-latency' selects the bricks with the lowest"
+            " recent read latency. 'load-latency-hybrid' weighs the"
+            " latency of each brick by its reads in flight.",
+    },
+    {
+        .key = {"read-hedge-count"},
+        .type = GF_OPTION_TYPE_INT,
+        .min = 0,
+        .max = EC_MAX_FRAGMENTS,
+        .default_value = "0",
+        .op_version = {GD_OP_VERSION_10_0},
+        .flags = OPT_FLAG_SETTABLE | OPT_FLAG_CLIENT_OPT | OPT_FLAG_DOC,
+        .tags = {"disperse"},
+        .description =
+            "Number of extra fragments requested by each read. The data is"
+            " decoded from the first 'k' fragments that arrive and a slow"
+            " brick doesn't delay the read. It is capped to the redundancy"
+            " of the volume. 0 disables hedged reads.",
     },
     {.key = {"shd-max-threads"},
      .type = GF_OPTION_TYPE_INT,
@@ -1780,9 +1877,22 @@ struct volume_options options[] = {
      .tags = {"disperse"},
      .description = "This option can be used to control number of heals"
                     " that can wait in SHD per subvolume"},
+    {.key = {"shd-client-latency-target"},
+     .type = GF_OPTION_TYPE_INT,
+     .min = 0,
+     .max = 60000,
+     .default_value = "0",
+     .op_version = {GD_OP_VERSION_10_0},
+     .flags = OPT_FLAG_SETTABLE | OPT_FLAG_DOC,
+     .tags = {"disperse"},
+     .description = "Latency in milliseconds the fops of the clients may see "
+                    "on the bricks before SHD lowers the number of parallel "
+                    "heals, which grows back up to shd-max-threads while they "
+                    "stay below it. 0 lets SHD always run shd-max-threads "
+                    "heals."},
     {.key = {"cpu-extensions"},
      .type = GF_OPTION_TYPE_STR,
-     .value = {"none", "auto", "x64", "sse", "avx"},
+     .value = {"none", "auto", "x64", "sse", "avx", "avx512"},
      .default_value = "auto",
      .op_version = {GD_OP_VERSION_3_9_0},
      .flags = OPT_FLAG_SETTABLE | OPT_FLAG_CLIENT_OPT | OPT_FLAG_DOC,
@@ -1799,6 +1909,17 @@ struct volume_options options[] = {
      .tags = {"disperse"},
      .description = "Maximum number blocks(128KB) per file for which "
                     "self-heal process would be applied simultaneously."},
+    {.key = {"self-heal-pipeline-depth"},
+     .type = GF_OPTION_TYPE_INT,
+     .min = 1,
+     .max = 16,
+     .default_value = "4",
+     .op_version = {GD_OP_VERSION_10_0},
+     .flags = OPT_FLAG_SETTABLE | OPT_FLAG_CLIENT_OPT | OPT_FLAG_DOC,
+     .tags = {"disperse"},
+     .description = "Number of self-heal windows of a file which are read, "
+                    "decoded and written in parallel. Each window is "
+                    "self-heal-window-size blocks long."},
     {.key = {"optimistic-change-log"},
      .type = GF_OPTION_TYPE_BOOL,
      .default_value = "on",
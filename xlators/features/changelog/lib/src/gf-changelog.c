@@ -143,8 +143,7 @@ gf_changelog_ctx_defaults_init(glusterfs_ctx_t *ctx)
     if (!ctx->logbuf_pool)
         goto free_pool;
 
-    INIT_LIST_HEAD(&pool->all_frames);
-    LOCK_INIT(&pool->lock);
+    call_pool_init(pool);
     ctx->pool = pool;
 
     LOCK_INIT(&ctx->lock);
@@ -288,6 +288,44 @@ out:
     return found_lease;
 }
 
+/* Checks for metadata leases held by clients other than the one sending the
+ * fop. The fops of a client keep its own cache up to date.
+ */
+static gf_boolean_t
+__metadata_lease_conflict(call_frame_t *frame, lease_inode_ctx_t *lease_ctx)
+{
+    lease_id_entry_t *lease_entry = NULL;
+    client_t *client = frame->root->client;
+
+    list_for_each_entry(lease_entry, &lease_ctx->lease_id_list, lease_id_list)
+    {
+        if (!lease_entry->lease_cnt ||
+            !(lease_entry->lease_flags & GF_LEASE_METADATA))
+            continue;
+
+        if (!client || strcmp(client->client_uid, lease_entry->client_uid))
+            return _gf_true;
+    }
+
+    return _gf_false;
+}
+
+/* Checks if the leases on the inode, if any, are all metadata leases */
+static gf_boolean_t
+__is_metadata_lease_only(lease_inode_ctx_t *lease_ctx)
+{
+    lease_id_entry_t *lease_entry = NULL;
+
+    list_for_each_entry(lease_entry, &lease_ctx->lease_id_list, lease_id_list)
+    {
+        if (lease_entry->lease_cnt &&
+            !(lease_entry->lease_flags & GF_LEASE_METADATA))
+            return _gf_false;
+    }
+
+    return _gf_true;
+}
+
 /* Returns the lease_id_entry for a given lease_id and a given inode.
  * Return values:
  * NULL - If no client entry found
@@ -501,9 +539,18 @@ __add_lease(call_frame_t *frame, inode_t *inode, lease_inode_ctx_t *lease_ctx,
         goto out;
     }
 
+    /* A metadata cache asks again whenever it isn't sure it still holds
+     * the lease, e.g. after a brick went down. It holds one or none. */
+    if ((lease->lease_flags & GF_LEASE_METADATA) &&
+        (lease_entry->lease_type_cnt[lease->lease_type] > 0)) {
+        ret = 0;
+        goto out;
+    }
+
     lease_entry->lease_type_cnt[lease->lease_type]++;
     lease_entry->lease_cnt++;
     lease_entry->lease_type |= lease->lease_type;
+    lease_entry->lease_flags |= lease->lease_flags;
     /* If this is the first lease taken by the client on the file, then
      * add this inode/file to the client disconnect cleanup list
      */
@@ -1062,6 +1109,19 @@ __check_lease_conflict(call_frame_t *frame, lease_inode_ctx_t *lease_ctx,
 
     lease_type = lease_ctx->lease_type;
 
+    /* Metadata leases conflict with the modifications from other clients,
+     * whatever other leases there are */
+    if (is_write && (frame->root->pid >= 0) &&
+        __metadata_lease_conflict(frame, lease_ctx)) {
+        conflicts = _gf_true;
+        goto recall;
+    }
+
+    if (__is_metadata_lease_only(lease_ctx)) {
+        conflicts = _gf_false;
+        goto recall;
+    }
+
     /* If the fop is rename or unlink conflict the lease even if its
      * from the same client??
      */
@@ -1159,7 +1219,9 @@ check_lease_conflict(call_frame_t *frame, inode_t *inode, const char *lease_id,
         conflicts = __check_lease_conflict(frame, lease_ctx, lease_id,
                                            is_write_fop);
         if (conflicts) {
-            if (is_blocking_fop) {
+            /* failing the fop is for the leases of applications, which
+             * know what they asked for */
+            if (is_blocking_fop || __is_metadata_lease_only(lease_ctx)) {
                 gf_msg_debug(frame->this->name, 0,
                              "Fop: %s "
                              "conflicting existing "
@@ -1186,6 +1248,43 @@ out:
     return ret;
 }
 
+/* Metadata leases are also broken by the changes to the xattrs of the inode
+ * and, for a directory, to its entries. The fop always waits for the recall.
+ *
+ * Return values as for check_lease_conflict()
+ */
+int
+check_metadata_lease_conflict(call_frame_t *frame, inode_t *inode)
+{
+    lease_inode_ctx_t *lease_ctx = NULL;
+    uint64_t ctx = 0;
+    int ret = WIND_FOP;
+
+    if (!inode || (frame->root->pid < 0))
+        goto out;
+
+    /* not creating a context for every parent directory, an inode
+     * without one has no lease */
+    if (inode_ctx_get(inode, frame->this, &ctx) < 0)
+        goto out;
+    lease_ctx = (lease_inode_ctx_t *)(long)ctx;
+
+    pthread_mutex_lock(&lease_ctx->lock);
+    {
+        if (__metadata_lease_conflict(frame, lease_ctx)) {
+            gf_msg_debug(frame->this->name, 0,
+                         "Fop: %s conflicting existing metadata lease on "
+                         "gfid(%s), blocking the fop",
+                         gf_fop_list[frame->root->op], uuid_utoa(inode->gfid));
+            __recall_lease(frame->this, lease_ctx);
+            ret = BLOCK_FOP;
+        }
+    }
+    pthread_mutex_unlock(&lease_ctx->lock);
+out:
+    return ret;
+}
+
 static int
 remove_clnt_leases(const char *client_uid, inode_t *inode, xlator_t *this)
 {
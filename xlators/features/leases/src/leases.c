@@ -380,6 +380,7 @@ leases_rename(call_frame_t *frame, xlator_t *this, loc_t *oldloc, loc_t *newloc,
 {
     uint32_t fop_flags = 0;
     char *lease_id = NULL;
+    inode_t *block_inode = NULL;
     int ret = 0;
 
     EXIT_IF_LEASES_OFF(this, out);
@@ -389,16 +390,35 @@ leases_rename(call_frame_t *frame, xlator_t *this, loc_t *oldloc, loc_t *newloc,
     GET_LEASE_ID(xdata, lease_id, frame->root->client->client_uid);
     GET_FLAGS(frame->root->op, 0);
 
-    ret = check_lease_conflict(frame, oldloc->inode, lease_id, fop_flags);
+    block_inode = oldloc->inode;
+    ret = check_lease_conflict(frame, block_inode, lease_id, fop_flags);
     if (ret < 0)
         goto err;
     else if (ret == BLOCK_FOP)
         goto block;
+
+    /* the entries of both parents change, as does the link count of the
+     * file replaced */
+    block_inode = oldloc->parent;
+    ret = check_metadata_lease_conflict(frame, block_inode);
+    if (ret == BLOCK_FOP)
+        goto block;
+
+    block_inode = newloc->parent;
+    ret = check_metadata_lease_conflict(frame, block_inode);
+    if (ret == BLOCK_FOP)
+        goto block;
+
+    block_inode = newloc->inode;
+    ret = check_metadata_lease_conflict(frame, block_inode);
+    if (ret == BLOCK_FOP)
+        goto block;
     else if (ret == WIND_FOP)
         goto out;
 
 block:
-    LEASE_BLOCK_FOP(oldloc->inode, rename, frame, this, oldloc, newloc, xdata);
+    LEASE_BLOCK_FOP_RECHECK(block_inode, rename, frame, this, oldloc, newloc,
+                            xdata);
     return 0;
 
 out:
@@ -429,6 +449,7 @@ leases_unlink(call_frame_t *frame, xlator_t *this, loc_t *loc, int xflag,
 {
     uint32_t fop_flags = 0;
     char *lease_id = NULL;
+    inode_t *block_inode = NULL;
     int ret = 0;
 
     EXIT_IF_LEASES_OFF(this, out);
@@ -437,16 +458,23 @@ leases_unlink(call_frame_t *frame, xlator_t *this, loc_t *loc, int xflag,
     GET_LEASE_ID(xdata, lease_id, frame->root->client->client_uid);
     GET_FLAGS(frame->root->op, 0);
 
-    ret = check_lease_conflict(frame, loc->inode, lease_id, fop_flags);
+    block_inode = loc->inode;
+    ret = check_lease_conflict(frame, block_inode, lease_id, fop_flags);
     if (ret < 0)
         goto err;
     else if (ret == BLOCK_FOP)
         goto block;
+
+    block_inode = loc->parent;
+    ret = check_metadata_lease_conflict(frame, block_inode);
+    if (ret == BLOCK_FOP)
+        goto block;
     else if (ret == WIND_FOP)
         goto out;
 
 block:
-    LEASE_BLOCK_FOP(loc->inode, unlink, frame, this, loc, xflag, xdata);
+    LEASE_BLOCK_FOP_RECHECK(block_inode, unlink, frame, this, loc, xflag,
+                            xdata);
     return 0;
 
 out:
@@ -476,6 +504,7 @@ leases_link(call_frame_t *frame, xlator_t *this, loc_t *oldloc, loc_t *newloc,
 {
     uint32_t fop_flags = 0;
     char *lease_id = NULL;
+    inode_t *block_inode = NULL;
     int ret = 0;
 
     EXIT_IF_LEASES_OFF(this, out);
@@ -484,16 +513,23 @@ leases_link(call_frame_t *frame, xlator_t *this, loc_t *oldloc, loc_t *newloc,
     GET_LEASE_ID(xdata, lease_id, frame->root->client->client_uid);
     GET_FLAGS(frame->root->op, 0);
 
-    ret = check_lease_conflict(frame, oldloc->inode, lease_id, fop_flags);
+    block_inode = oldloc->inode;
+    ret = check_lease_conflict(frame, block_inode, lease_id, fop_flags);
     if (ret < 0)
         goto err;
     else if (ret == BLOCK_FOP)
         goto block;
+
+    block_inode = newloc->parent;
+    ret = check_metadata_lease_conflict(frame, block_inode);
+    if (ret == BLOCK_FOP)
+        goto block;
     else if (ret == WIND_FOP)
         goto out;
 
 block:
-    LEASE_BLOCK_FOP(oldloc->inode, link, frame, this, oldloc, newloc, xdata);
+    LEASE_BLOCK_FOP_RECHECK(block_inode, link, frame, this, oldloc, newloc,
+                            xdata);
     return 0;
 out:
     STACK_WIND(frame, leases_link_cbk, FIRST_CHILD(this),
@@ -523,6 +559,7 @@ leases_create(call_frame_t *frame, xlator_t *this, loc_t *loc, int32_t flags,
 {
     uint32_t fop_flags = 0;
     char *lease_id = NULL;
+    inode_t *block_inode = NULL;
     int ret = 0;
 
     EXIT_IF_LEASES_OFF(this, out);
@@ -531,17 +568,23 @@ leases_create(call_frame_t *frame, xlator_t *this, loc_t *loc, int32_t flags,
     GET_LEASE_ID(xdata, lease_id, frame->root->client->client_uid);
     GET_FLAGS(frame->root->op, flags);
 
-    ret = check_lease_conflict(frame, fd->inode, lease_id, fop_flags);
+    block_inode = fd->inode;
+    ret = check_lease_conflict(frame, block_inode, lease_id, fop_flags);
     if (ret < 0)
         goto err;
     else if (ret == BLOCK_FOP)
         goto block;
+
+    block_inode = loc->parent;
+    ret = check_metadata_lease_conflict(frame, block_inode);
+    if (ret == BLOCK_FOP)
+        goto block;
     else if (ret == WIND_FOP)
         goto out;
 
 block:
-    LEASE_BLOCK_FOP(fd->inode, create, frame, this, loc, flags, mode, umask, fd,
-                    xdata);
+    LEASE_BLOCK_FOP_RECHECK(block_inode, create, frame, this, loc, flags, mode,
+                            umask, fd, xdata);
     return 0;
 
 out:
@@ -556,6 +599,314 @@ err:
     return 0;
 }
 
+/* The fops below conflict only with the metadata leases, those of
+ * applications are about the data of the file */
+
+int32_t
+leases_mknod_cbk(call_frame_t *frame, void *cookie, xlator_t *this,
+                 int32_t op_ret, int32_t op_errno, inode_t *inode,
+                 struct iatt *stbuf, struct iatt *preparent,
+                 struct iatt *postparent, dict_t *xdata)
+{
+    STACK_UNWIND_STRICT(mknod, frame, op_ret, op_errno, inode, stbuf,
+                        preparent, postparent, xdata);
+
+    return 0;
+}
+
+int32_t
+leases_mknod(call_frame_t *frame, xlator_t *this, loc_t *loc, mode_t mode,
+             dev_t rdev, mode_t umask, dict_t *xdata)
+{
+    int ret = 0;
+
+    EXIT_IF_LEASES_OFF(this, out);
+    EXIT_IF_INTERNAL_FOP(frame, xdata, out);
+
+    ret = check_metadata_lease_conflict(frame, loc->parent);
+    if (ret == WIND_FOP)
+        goto out;
+
+    LEASE_BLOCK_FOP_RECHECK(loc->parent, mknod, frame, this, loc, mode, rdev,
+                            umask, xdata);
+    return 0;
+
+out:
+    STACK_WIND(frame, leases_mknod_cbk, FIRST_CHILD(this),
+               FIRST_CHILD(this)->fops->mknod, loc, mode, rdev, umask, xdata);
+    return 0;
+
+err:
+    STACK_UNWIND_STRICT(mknod, frame, -1, errno, NULL, NULL, NULL, NULL, NULL);
+    return 0;
+}
+
+int32_t
+leases_mkdir_cbk(call_frame_t *frame, void *cookie, xlator_t *this,
+                 int32_t op_ret, int32_t op_errno, inode_t *inode,
+                 struct iatt *stbuf, struct iatt *preparent,
+                 struct iatt *postparent, dict_t *xdata)
+{
+    STACK_UNWIND_STRICT(mkdir, frame, op_ret, op_errno, inode, stbuf,
+                        preparent, postparent, xdata);
+
+    return 0;
+}
+
+int32_t
+leases_mkdir(call_frame_t *frame, xlator_t *this, loc_t *loc, mode_t mode,
+             mode_t umask, dict_t *xdata)
+{
+    int ret = 0;
+
+    EXIT_IF_LEASES_OFF(this, out);
+    EXIT_IF_INTERNAL_FOP(frame, xdata, out);
+
+    ret = check_metadata_lease_conflict(frame, loc->parent);
+    if (ret == WIND_FOP)
+        goto out;
+
+    LEASE_BLOCK_FOP_RECHECK(loc->parent, mkdir, frame, this, loc, mode, umask,
+                            xdata);
+    return 0;
+
+out:
+    STACK_WIND(frame, leases_mkdir_cbk, FIRST_CHILD(this),
+               FIRST_CHILD(this)->fops->mkdir, loc, mode, umask, xdata);
+    return 0;
+
+err:
+    STACK_UNWIND_STRICT(mkdir, frame, -1, errno, NULL, NULL, NULL, NULL, NULL);
+    return 0;
+}
+
+int32_t
+leases_symlink_cbk(call_frame_t *frame, void *cookie, xlator_t *this,
+                   int32_t op_ret, int32_t op_errno, inode_t *inode,
+                   struct iatt *stbuf, struct iatt *preparent,
+                   struct iatt *postparent, dict_t *xdata)
+{
+    STACK_UNWIND_STRICT(symlink, frame, op_ret, op_errno, inode, stbuf,
+                        preparent, postparent, xdata);
+
+    return 0;
+}
+
+int32_t
+leases_symlink(call_frame_t *frame, xlator_t *this, const char *linkpath,
+               loc_t *loc, mode_t umask, dict_t *xdata)
+{
+    int ret = 0;
+
+    EXIT_IF_LEASES_OFF(this, out);
+    EXIT_IF_INTERNAL_FOP(frame, xdata, out);
+
+    ret = check_metadata_lease_conflict(frame, loc->parent);
+    if (ret == WIND_FOP)
+        goto out;
+
+    LEASE_BLOCK_FOP_RECHECK(loc->parent, symlink, frame, this, linkpath, loc,
+                            umask, xdata);
+    return 0;
+
+out:
+    STACK_WIND(frame, leases_symlink_cbk, FIRST_CHILD(this),
+               FIRST_CHILD(this)->fops->symlink, linkpath, loc, umask, xdata);
+    return 0;
+
+err:
+    STACK_UNWIND_STRICT(symlink, frame, -1, errno, NULL, NULL, NULL, NULL,
+                        NULL);
+    return 0;
+}
+
+int32_t
+leases_rmdir_cbk(call_frame_t *frame, void *cookie, xlator_t *this,
+                 int32_t op_ret, int32_t op_errno, struct iatt *preparent,
+                 struct iatt *postparent, dict_t *xdata)
+{
+    STACK_UNWIND_STRICT(rmdir, frame, op_ret, op_errno, preparent, postparent,
+                        xdata);
+
+    return 0;
+}
+
+int32_t
+leases_rmdir(call_frame_t *frame, xlator_t *this, loc_t *loc, int flags,
+             dict_t *xdata)
+{
+    inode_t *block_inode = NULL;
+    int ret = 0;
+
+    EXIT_IF_LEASES_OFF(this, out);
+    EXIT_IF_INTERNAL_FOP(frame, xdata, out);
+
+    block_inode = loc->inode;
+    ret = check_metadata_lease_conflict(frame, block_inode);
+    if (ret == BLOCK_FOP)
+        goto block;
+
+    block_inode = loc->parent;
+    ret = check_metadata_lease_conflict(frame, block_inode);
+    if (ret == WIND_FOP)
+        goto out;
+
+block:
+    LEASE_BLOCK_FOP_RECHECK(block_inode, rmdir, frame, this, loc, flags,
+                            xdata);
+    return 0;
+
+out:
+    STACK_WIND(frame, leases_rmdir_cbk, FIRST_CHILD(this),
+               FIRST_CHILD(this)->fops->rmdir, loc, flags, xdata);
+    return 0;
+
+err:
+    STACK_UNWIND_STRICT(rmdir, frame, -1, errno, NULL, NULL, NULL);
+    return 0;
+}
+
+int32_t
+leases_setxattr_cbk(call_frame_t *frame, void *cookie, xlator_t *this,
+                    int32_t op_ret, int32_t op_errno, dict_t *xdata)
+{
+    STACK_UNWIND_STRICT(setxattr, frame, op_ret, op_errno, xdata);
+
+    return 0;
+}
+
+int32_t
+leases_setxattr(call_frame_t *frame, xlator_t *this, loc_t *loc, dict_t *dict,
+                int32_t flags, dict_t *xdata)
+{
+    int ret = 0;
+
+    EXIT_IF_LEASES_OFF(this, out);
+    EXIT_IF_INTERNAL_FOP(frame, xdata, out);
+
+    ret = check_metadata_lease_conflict(frame, loc->inode);
+    if (ret == WIND_FOP)
+        goto out;
+
+    LEASE_BLOCK_FOP(loc->inode, setxattr, frame, this, loc, dict, flags,
+                    xdata);
+    return 0;
+
+out:
+    STACK_WIND(frame, leases_setxattr_cbk, FIRST_CHILD(this),
+               FIRST_CHILD(this)->fops->setxattr, loc, dict, flags, xdata);
+    return 0;
+
+err:
+    STACK_UNWIND_STRICT(setxattr, frame, -1, errno, NULL);
+    return 0;
+}
+
+int32_t
+leases_fsetxattr_cbk(call_frame_t *frame, void *cookie, xlator_t *this,
+                     int32_t op_ret, int32_t op_errno, dict_t *xdata)
+{
+    STACK_UNWIND_STRICT(fsetxattr, frame, op_ret, op_errno, xdata);
+
+    return 0;
+}
+
+int32_t
+leases_fsetxattr(call_frame_t *frame, xlator_t *this, fd_t *fd, dict_t *dict,
+                 int32_t flags, dict_t *xdata)
+{
+    int ret = 0;
+
+    EXIT_IF_LEASES_OFF(this, out);
+    EXIT_IF_INTERNAL_FOP(frame, xdata, out);
+
+    ret = check_metadata_lease_conflict(frame, fd->inode);
+    if (ret == WIND_FOP)
+        goto out;
+
+    LEASE_BLOCK_FOP(fd->inode, fsetxattr, frame, this, fd, dict, flags, xdata);
+    return 0;
+
+out:
+    STACK_WIND(frame, leases_fsetxattr_cbk, FIRST_CHILD(this),
+               FIRST_CHILD(this)->fops->fsetxattr, fd, dict, flags, xdata);
+    return 0;
+
+err:
+    STACK_UNWIND_STRICT(fsetxattr, frame, -1, errno, NULL);
+    return 0;
+}
+
+int32_t
+leases_removexattr_cbk(call_frame_t *frame, void *cookie, xlator_t *this,
+                       int32_t op_ret, int32_t op_errno, dict_t *xdata)
+{
+    STACK_UNWIND_STRICT(removexattr, frame, op_ret, op_errno, xdata);
+
+    return 0;
+}
+
+int32_t
+leases_removexattr(call_frame_t *frame, xlator_t *this, loc_t *loc,
+                   const char *name, dict_t *xdata)
+{
+    int ret = 0;
+
+    EXIT_IF_LEASES_OFF(this, out);
+    EXIT_IF_INTERNAL_FOP(frame, xdata, out);
+
+    ret = check_metadata_lease_conflict(frame, loc->inode);
+    if (ret == WIND_FOP)
+        goto out;
+
+    LEASE_BLOCK_FOP(loc->inode, removexattr, frame, this, loc, name, xdata);
+    return 0;
+
+out:
+    STACK_WIND(frame, leases_removexattr_cbk, FIRST_CHILD(this),
+               FIRST_CHILD(this)->fops->removexattr, loc, name, xdata);
+    return 0;
+
+err:
+    STACK_UNWIND_STRICT(removexattr, frame, -1, errno, NULL);
+    return 0;
+}
+
+int32_t
+leases_fremovexattr_cbk(call_frame_t *frame, void *cookie, xlator_t *this,
+                        int32_t op_ret, int32_t op_errno, dict_t *xdata)
+{
+    STACK_UNWIND_STRICT(fremovexattr, frame, op_ret, op_errno, xdata);
+
+    return 0;
+}
+
+int32_t
+leases_fremovexattr(call_frame_t *frame, xlator_t *this, fd_t *fd,
+                    const char *name, dict_t *xdata)
+{
+    int ret = 0;
+
+    EXIT_IF_LEASES_OFF(this, out);
+    EXIT_IF_INTERNAL_FOP(frame, xdata, out);
+
+    ret = check_metadata_lease_conflict(frame, fd->inode);
+    if (ret == WIND_FOP)
+        goto out;
+
+    LEASE_BLOCK_FOP(fd->inode, fremovexattr, frame, this, fd, name, xdata);
+    return 0;
+
+out:
+    STACK_WIND(frame, leases_fremovexattr_cbk, FIRST_CHILD(this),
+               FIRST_CHILD(this)->fops->fremovexattr, fd, name, xdata);
+    return 0;
+
+err:
+    STACK_UNWIND_STRICT(fremovexattr, frame, -1, errno, NULL);
+    return 0;
+}
+
 int32_t
 leases_fsync_cbk(call_frame_t *frame, void *cookie, xlator_t *this,
                  int32_t op_ret, int32_t op_errno, struct iatt *prebuf,
@@ -1117,6 +1468,16 @@ struct xlator_fops fops = {
     .unlink = leases_unlink,
     .link = leases_link,
 
+    /* Fops breaking only metadata leases */
+    .mknod = leases_mknod,
+    .mkdir = leases_mkdir,
+    .symlink = leases_symlink,
+    .rmdir = leases_rmdir,
+    .setxattr = leases_setxattr,
+    .fsetxattr = leases_fsetxattr,
+    .removexattr = leases_removexattr,
+    .fremovexattr = leases_fremovexattr,
+
 #ifdef NOT_SUPPORTED
     /* internal lk fops */
     .inodelk = leases_inodelk,
@@ -97,14 +97,17 @@
                                                                                \
     } while (0)
 
-#define LEASE_BLOCK_FOP(inode, fop_name, frame, this, params...)               \
+/* Queues the fop until the leases conflicting with it are recalled, to be
+ * resumed by @resume_fn. The leases may have gone already, then the fop is
+ * resumed right away. */
+#define __LEASE_BLOCK_FOP(inode, fop_name, resume_fn, frame, this, params...)  \
     do {                                                                       \
         call_stub_t *__stub = NULL;                                            \
         fop_stub_t *blk_fop = NULL;                                            \
         lease_inode_ctx_t *lease_ctx = NULL;                                   \
+        gf_boolean_t __resume = _gf_false;                                     \
                                                                                \
-        __stub = fop_##fop_name##_stub(frame, default_##fop_name##_resume,     \
-                                       params);                                \
+        __stub = fop_##fop_name##_stub(frame, resume_fn, params);              \
         if (!__stub) {                                                         \
             gf_msg(this->name, GF_LOG_WARNING, ENOMEM, LEASE_MSG_NO_MEM,       \
                    "Unable to create stub");                                   \
@@ -131,13 +134,20 @@
         blk_fop->stub = __stub;                                                \
         pthread_mutex_lock(&lease_ctx->lock);                                  \
         {                                                                      \
-            /*TODO: If the lease is unlocked btw check lease conflict and      \
-             * by now, then this fop shouldn't be add to the blocked fop       \
-             * list, can use generation number for the same?*/                 \
-            list_add_tail(&blk_fop->list, &lease_ctx->blocked_list);           \
+            /* the leases were unlocked, and the blocked fops resumed,         \
+             * since the conflict was found */                                 \
+            if (lease_ctx->lease_cnt == 0)                                     \
+                __resume = _gf_true;                                           \
+            else                                                               \
+                list_add_tail(&blk_fop->list, &lease_ctx->blocked_list);       \
         }                                                                      \
         pthread_mutex_unlock(&lease_ctx->lock);                                \
                                                                                \
+        if (__resume) {                                                        \
+            GF_FREE(blk_fop);                                                  \
+            call_resume(__stub);                                               \
+        }                                                                      \
+                                                                               \
     __out:                                                                     \
         if (ret < 0) {                                                         \
             gf_msg(this->name, GF_LOG_WARNING, ENOMEM, LEASE_MSG_NO_MEM,       \
@@ -151,6 +161,15 @@
         }                                                                      \
     } while (0)
 
+#define LEASE_BLOCK_FOP(inode, fop_name, frame, this, params...)               \
+    __LEASE_BLOCK_FOP(inode, fop_name, default_##fop_name##_resume, frame,     \
+                      this, params)
+
+/* For the fops conflicting on more than one inode: once resumed, the fop
+ * goes through all the checks again */
+#define LEASE_BLOCK_FOP_RECHECK(inode, fop_name, frame, this, params...)       \
+    __LEASE_BLOCK_FOP(inode, fop_name, leases_##fop_name, frame, this, params)
+
 struct _leases_private {
     struct list_head client_list;
     struct list_head recall_list;
@@ -219,7 +238,8 @@ struct _lease_id_entry {
     time_t recall_time; /* time @ which recall was sent */
     int lease_type;     /* Union of all the leases taken
                            under the given lease id */
-    char _pad[4];       /* manual padding */
+    /* GF_LEASE_METADATA if taken by a metadata cache */
+    uint32_t lease_flags;
 };
 typedef struct _lease_id_entry lease_id_entry_t;
 
@@ -250,6 +270,9 @@ int
 check_lease_conflict(call_frame_t *frame, inode_t *inode, const char *lease_id,
                      uint32_t fop_flags);
 
+int
+check_metadata_lease_conflict(call_frame_t *frame, inode_t *inode);
+
 int
 cleanup_client_leases(xlator_t *this, const char *client_uid);
 
@@ -14,6 +14,7 @@
 #include "shard-mem-types.h"
 #include <glusterfs/byte-order.h>
 #include <glusterfs/defaults.h>
+#include <glusterfs/default-args.h>
 #include <glusterfs/statedump.h>
 
 #define SHARD_PATH_MAX (sizeof(GF_SHARD_DIR) + GF_UUID_BUF_SIZE + 16)
@@ -2484,6 +2485,110 @@ out:
     return new;
 }
 
+static void
+shard_lookup_batch_free(shard_lookup_batch_t *batch)
+{
+    if (!batch)
+        return;
+
+    compound_args_cleanup(batch->args);
+    GF_FREE(batch);
+}
+
+static shard_lookup_batch_t *
+shard_lookup_batch_new(int count)
+{
+    shard_lookup_batch_t *batch = NULL;
+    dict_t *xdata = NULL;
+
+    xdata = dict_new();
+    if (!xdata)
+        return NULL;
+
+    if (dict_set_int8(xdata, GF_COMPOUND_INDEPENDENT_KEY, 1))
+        goto out;
+
+    batch = GF_CALLOC(1, sizeof(*batch), gf_shard_mt_lookup_batch_t);
+    if (!batch)
+        goto out;
+
+    batch->args = compound_fop_alloc(count, xdata);
+    if (!batch->args) {
+        GF_FREE(batch);
+        batch = NULL;
+    }
+
+out:
+    dict_unref(xdata);
+    return batch;
+}
+
+/* Every shard of the batch is completed through
+ * shard_common_lookup_shards_cbk(). Shards the layers below could not
+ * resolve in the batch are looked up again one by one. Neither frame->local
+ * nor the frame may be touched once the last shard is completed. */
+int
+shard_common_lookup_shards_batch_cbk(call_frame_t *frame, void *cookie,
+                                     xlator_t *this, int32_t op_ret,
+                                     int32_t op_errno, void *data,
+                                     dict_t *xdata)
+{
+    int i = 0;
+    shard_priv_t *priv = this->private;
+    shard_lookup_batch_t *batch = cookie;
+    compound_args_cbk_t *args_cbk = data;
+    default_args_cbk_t *rsp = NULL;
+    default_args_t *req = NULL;
+
+    for (i = 0; i < batch->count; i++) {
+        req = &batch->args->req_list[i];
+        rsp = NULL;
+        if (args_cbk && (i < args_cbk->fop_length))
+            rsp = &args_cbk->rsp_list[i];
+
+        if (rsp && (rsp->op_ret == 0)) {
+            GF_ATOMIC_INC(priv->lookup_batch_shards);
+            shard_common_lookup_shards_cbk(
+                frame, (void *)(long)batch->block_num[i], this, 0, 0,
+                req->loc.inode, &rsp->stat, rsp->xdata, &rsp->postparent);
+        } else if (rsp && (rsp->op_errno == ENOENT)) {
+            GF_ATOMIC_INC(priv->lookup_batch_shards);
+            shard_common_lookup_shards_cbk(
+                frame, (void *)(long)batch->block_num[i], this, -1, ENOENT,
+                NULL, NULL, rsp->xdata, NULL);
+        } else {
+            GF_ATOMIC_INC(priv->lookup_batch_fallbacks);
+            STACK_WIND_COOKIE(frame, shard_common_lookup_shards_cbk,
+                              (void *)(long)batch->block_num[i],
+                              FIRST_CHILD(this),
+                              FIRST_CHILD(this)->fops->lookup, &req->loc,
+                              req->xdata);
+        }
+    }
+
+    shard_lookup_batch_free(batch);
+    return 0;
+}
+
+static void
+shard_lookup_batch_wind(call_frame_t *frame, xlator_t *this,
+                        shard_lookup_batch_t *batch)
+{
+    shard_priv_t *priv = this->private;
+
+    /* A batch cut short by a failure only carries the shards packed so
+     * far. */
+    batch->args->fop_length = batch->count;
+
+    gf_msg_debug(this->name, 0, "Looking up %d shards in one batch",
+                 batch->count);
+    GF_ATOMIC_INC(priv->lookup_batches);
+
+    STACK_WIND_COOKIE(frame, shard_common_lookup_shards_batch_cbk, batch,
+                      FIRST_CHILD(this), FIRST_CHILD(this)->fops->compound,
+                      batch->args, batch->args->xdata);
+}
+
 int
 shard_common_lookup_shards(call_frame_t *frame, xlator_t *this, inode_t *inode,
                            shard_post_lookup_shards_fop_handler_t handler)
@@ -2503,6 +2608,7 @@ shard_common_lookup_shards(call_frame_t *frame, xlator_t *this, inode_t *inode,
     shard_priv_t *priv = NULL;
     gf_boolean_t wind_failed = _gf_false;
     dict_t *xattr_req = NULL;
+    shard_lookup_batch_t *batch = NULL;
 
     priv = this->private;
     local = frame->local;
@@ -2572,9 +2678,26 @@ shard_common_lookup_shards(call_frame_t *frame, xlator_t *this, inode_t *inode,
             goto next;
         }
 
-        STACK_WIND_COOKIE(frame, shard_common_lookup_shards_cbk,
-                          (void *)(long)shard_idx_iter, FIRST_CHILD(this),
-                          FIRST_CHILD(this)->fops->lookup, &loc, xattr_req);
+        /* Send the lookups of up to GF_COMPOUND_MAX_FOPS shards at a time
+         * as one compound fop if the graph below supports it. */
+        if (!batch && priv->lookup_batch && (call_count > 1) &&
+            FIRST_CHILD(this)->fops->compound)
+            batch = shard_lookup_batch_new(min(call_count,
+                                               GF_COMPOUND_MAX_FOPS));
+
+        if (batch) {
+            COMPOUND_PACK_ARGS(lookup, GF_FOP_LOOKUP, batch->args,
+                               batch->count, &loc, xattr_req);
+            batch->block_num[batch->count++] = shard_idx_iter;
+            if (batch->count == batch->args->fop_length) {
+                shard_lookup_batch_wind(frame, this, batch);
+                batch = NULL;
+            }
+        } else {
+            STACK_WIND_COOKIE(frame, shard_common_lookup_shards_cbk,
+                              (void *)(long)shard_idx_iter, FIRST_CHILD(this),
+                              FIRST_CHILD(this)->fops->lookup, &loc, xattr_req);
+        }
         loc_wipe(&loc);
         dict_unref(xattr_req);
     next:
@@ -2584,6 +2707,8 @@ shard_common_lookup_shards(call_frame_t *frame, xlator_t *this, inode_t *inode,
         if (!--call_count)
             break;
     }
+    if (batch)
+        shard_lookup_batch_wind(frame, this, batch);
     if (local->lookup_shards_barriered) {
         syncbarrier_wait(&local->barrier, count);
         local->pls_fop_handler(frame, this);
@@ -7459,6 +7584,11 @@ init(xlator_t *this)
 
     GF_OPTION_INIT("shard-lru-limit", priv->lru_limit, uint64, out);
 
+    GF_OPTION_INIT("shard-lookup-batch", priv->lookup_batch, bool, out);
+    GF_ATOMIC_INIT(priv->lookup_batches, 0);
+    GF_ATOMIC_INIT(priv->lookup_batch_shards, 0);
+    GF_ATOMIC_INIT(priv->lookup_batch_fallbacks, 0);
+
     this->local_pool = mem_pool_new(shard_local_t, 128);
     if (!this->local_pool) {
         ret = -1;
@@ -7527,6 +7657,9 @@ reconfigure(xlator_t *this, dict_t *options)
 
     GF_OPTION_RECONF("shard-deletion-rate", priv->deletion_rate, options,
                      uint32, out);
+
+    GF_OPTION_RECONF("shard-lookup-batch", priv->lookup_batch, options, bool,
+                     out);
     ret = 0;
 
 out:
@@ -7591,6 +7724,13 @@ shard_priv_dump(xlator_t *this)
     gf_proc_dump_write("inode-count", "%d", priv->inode_count);
     gf_proc_dump_write("ilist_head", "%p", &priv->ilist_head);
     gf_proc_dump_write("lru-max-limit", "%" PRIu64, priv->lru_limit);
+    gf_proc_dump_write("lookup-batch", "%d", priv->lookup_batch);
+    gf_proc_dump_write("lookup-batches", "%" GF_PRI_ATOMIC,
+                       GF_ATOMIC_GET(priv->lookup_batches));
+    gf_proc_dump_write("lookup-batch-shards", "%" GF_PRI_ATOMIC,
+                       GF_ATOMIC_GET(priv->lookup_batch_shards));
+    gf_proc_dump_write("lookup-batch-fallbacks", "%" GF_PRI_ATOMIC,
+                       GF_ATOMIC_GET(priv->lookup_batch_fallbacks));
 
     GF_FREE(str);
 
@@ -7695,6 +7835,18 @@ struct volume_options options[] = {
                        "amount of memory consumed by these inodes and their "
                        "internal metadata",
     },
+    {
+        .key = {"shard-lookup-batch"},
+        .type = GF_OPTION_TYPE_BOOL,
+        .op_version = {GD_OP_VERSION_10_0},
+        .flags = OPT_FLAG_SETTABLE | OPT_FLAG_CLIENT_OPT | OPT_FLAG_DOC,
+        .tags = {"shard"},
+        .default_value = "on",
+        .description = "Look up the missing shards of a file in batches, "
+                       "with one compound fop per batch, instead of one "
+                       "lookup per shard. Shards the batch could not resolve "
+                       "are looked up one by one.",
+    },
     {.key = {NULL}},
 };
 
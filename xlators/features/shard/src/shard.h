@@ -15,6 +15,7 @@
 #include <glusterfs/compat-errno.h>
 #include "shard-messages.h"
 #include <glusterfs/syncop.h>
+#include <glusterfs/defaults.h>
 
 #define GF_SHARD_DIR ".shard"
 #define GF_SHARD_REMOVE_ME_DIR ".remove_me"
@@ -231,6 +232,10 @@ typedef struct shard_priv {
     gf_boolean_t first_lookup_done;
     uint64_t lru_limit;
     shard_unlink_thread_t thread_info;
+    gf_boolean_t lookup_batch;
+    gf_atomic_t lookup_batches;         /* compound fops sent */
+    gf_atomic_t lookup_batch_shards;    /* shards they resolved */
+    gf_atomic_t lookup_batch_fallbacks; /* shards looked up alone again */
 } shard_priv_t;
 
 typedef struct {
@@ -332,6 +337,13 @@ typedef struct shard_local {
     char *name;
 } shard_local_t;
 
+/* Lookups of missing shards sent down as one compound fop */
+typedef struct shard_lookup_batch {
+    compound_args_t *args;
+    int count;
+    int block_num[GF_COMPOUND_MAX_FOPS];
+} shard_lookup_batch_t;
+
 typedef struct shard_inode_ctx {
     uint64_t block_size; /* The block size with which this inode is
                             sharded */
@@ -269,6 +269,64 @@ err:
     return 0;
 }
 
+int32_t
+gf_utime_compound_cbk(call_frame_t *frame, void *cookie, xlator_t *this,
+                      int32_t op_ret, int32_t op_errno, void *data,
+                      dict_t *xdata)
+{
+    compound_args_cbk_t *args_cbk = data;
+    default_args_cbk_t *rsp = NULL;
+    int i = 0;
+
+    /* Entries without time attributes are looked up again on their own,
+     * gf_utime_lookup() knows how to set them. */
+    for (i = 0; args_cbk && i < args_cbk->fop_length; i++) {
+        rsp = &args_cbk->rsp_list[i];
+        if (rsp->op_ret == 0 &&
+            (!rsp->xdata || !dict_get(rsp->xdata, GF_XATTR_MDATA_KEY))) {
+            rsp->op_ret = -1;
+            rsp->op_errno = ECANCELED;
+        }
+    }
+
+    STACK_UNWIND_STRICT(compound, frame, op_ret, op_errno, data, xdata);
+    return 0;
+}
+
+int
+gf_utime_compound(call_frame_t *frame, xlator_t *this, void *data,
+                  dict_t *xdata)
+{
+    compound_args_t *args = data;
+    default_args_t *req = NULL;
+    int op_errno = ENOTSUP;
+    int i = 0;
+
+    /* Only batched lookups go through, the time attributes of the other
+     * fops are not set on their steps. */
+    if (!FIRST_CHILD(this)->fops->compound ||
+        !compound_args_only_fop(args, GF_FOP_LOOKUP))
+        goto err;
+
+    for (i = 0; i < args->fop_length; i++) {
+        req = &args->req_list[i];
+        if (!req->xdata)
+            req->xdata = dict_new();
+        if (!req->xdata || dict_set_int8(req->xdata, GF_XATTR_MDATA_KEY, 1)) {
+            op_errno = ENOMEM;
+            goto err;
+        }
+    }
+
+    STACK_WIND(frame, gf_utime_compound_cbk, FIRST_CHILD(this),
+               FIRST_CHILD(this)->fops->compound, data, xdata);
+    return 0;
+
+err:
+    STACK_UNWIND_STRICT(compound, frame, -1, op_errno, NULL, NULL);
+    return 0;
+}
+
 int32_t
 init(xlator_t *this)
 {
@@ -340,6 +398,7 @@ struct xlator_fops fops = {
     .opendir = gf_utime_opendir,
     .removexattr = gf_utime_removexattr,
     .lookup = gf_utime_lookup,
+    .compound = gf_utime_compound,
 };
 struct xlator_cbks cbks = {
     .invalidate = gf_utime_invalidate,
@@ -2833,6 +2833,7 @@ perfxl_option_handler(volgen_graph_t *graph, struct volopt_map_entry *vme,
     gf_boolean_t enabled = _gf_false;
     glusterd_volinfo_t *volinfo = NULL;
     glusterd_conf_t *priv = NULL;
+    xlator_t *xl = NULL;
 
     GF_VALIDATE_OR_GOTO("glusterd", param, out);
     volinfo = param;
@@ -2869,8 +2870,17 @@ perfxl_option_handler(volgen_graph_t *graph, struct volopt_map_entry *vme,
         glusterd_volinfo_get_boolean(volinfo, VKEY_PARALLEL_READDIR))
         return 0;
 
-    if (volgen_graph_add(graph, vme->voltype, volinfo->volname))
-        return 0;
+    xl = volgen_graph_add(graph, vme->voltype, volinfo->volname);
+    if (!xl)
+        goto out;
+
+    /* the segment of the shared cache is named after the volume id */
+    if (!strcmp(vme->voltype, "performance/quick-read") &&
+        (priv->op_version >= GD_OP_VERSION_10_0))
+        return xlator_set_fixed_option(xl, "volume-id",
+                                       uuid_utoa(volinfo->volume_id));
+
+    return 0;
 out:
     return -1;
 }
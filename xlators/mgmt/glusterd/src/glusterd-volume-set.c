@@ -993,6 +993,11 @@ struct volopt_map_entry glusterd_volopt_map[] = {
      .option = "data-self-heal-window-size",
      .op_version = 1,
      .flags = VOLOPT_FLAG_CLIENT_OPT},
+    {.key = "cluster.data-self-heal-region-size",
+     .voltype = "cluster/replicate",
+     .option = "data-self-heal-region-size",
+     .op_version = GD_OP_VERSION_10_0,
+     .flags = VOLOPT_FLAG_CLIENT_OPT},
     {.key = "cluster.data-change-log",
      .voltype = "cluster/replicate",
      .op_version = 1,
@@ -1215,6 +1220,11 @@ struct volopt_map_entry glusterd_volopt_map[] = {
      .option = "cache-size",
      .op_version = GD_OP_VERSION_8_0,
      .flags = VOLOPT_FLAG_CLIENT_OPT},
+    {.key = "performance.io-cache-policy",
+     .voltype = "performance/io-cache",
+     .option = "cache-policy",
+     .op_version = GD_OP_VERSION_10_0,
+     .flags = VOLOPT_FLAG_CLIENT_OPT},
     {
         .key = "performance.cache-size",
         .voltype = "performance/io-cache",
@@ -1297,6 +1307,16 @@ struct volopt_map_entry glusterd_volopt_map[] = {
      .option = "ctime-invalidation",
      .op_version = GD_OP_VERSION_5_0,
      .flags = VOLOPT_FLAG_CLIENT_OPT},
+    {.key = "performance.quick-read-shared-cache",
+     .voltype = "performance/quick-read",
+     .option = "shared-cache",
+     .op_version = GD_OP_VERSION_10_0,
+     .flags = VOLOPT_FLAG_CLIENT_OPT},
+    {.key = "performance.quick-read-shared-cache-size",
+     .voltype = "performance/quick-read",
+     .option = "shared-cache-size",
+     .op_version = GD_OP_VERSION_10_0,
+     .flags = VOLOPT_FLAG_CLIENT_OPT},
     {.key = "performance.flush-behind",
      .voltype = "performance/write-behind",
      .option = "flush-behind",
@@ -1367,6 +1387,21 @@ struct volopt_map_entry glusterd_volopt_map[] = {
      .option = "trickling-writes",
      .op_version = GD_OP_VERSION_3_13_1,
      .flags = VOLOPT_FLAG_CLIENT_OPT},
+    {.key = "performance.write-behind-adaptive-window",
+     .voltype = "performance/write-behind",
+     .option = "adaptive-window",
+     .op_version = GD_OP_VERSION_10_0,
+     .flags = VOLOPT_FLAG_CLIENT_OPT},
+    {.key = "performance.write-behind-adaptive-window-max",
+     .voltype = "performance/write-behind",
+     .option = "adaptive-window-max",
+     .op_version = GD_OP_VERSION_10_0,
+     .flags = VOLOPT_FLAG_CLIENT_OPT},
+    {.key = "performance.write-behind-max-dirty-size",
+     .voltype = "performance/write-behind",
+     .option = "max-dirty-size",
+     .op_version = GD_OP_VERSION_10_0,
+     .flags = VOLOPT_FLAG_CLIENT_OPT},
     {.key = "performance.lazy-open",
      .voltype = "performance/open-behind",
      .option = "lazy-open",
@@ -1444,6 +1479,16 @@ struct volopt_map_entry glusterd_volopt_map[] = {
      .option = "md-cache-statfs",
      .op_version = GD_OP_VERSION_4_0_0,
      .flags = VOLOPT_FLAG_CLIENT_OPT},
+    {.key = "performance.md-cache-leases",
+     .voltype = "performance/md-cache",
+     .option = "md-cache-leases",
+     .op_version = GD_OP_VERSION_10_0,
+     .flags = VOLOPT_FLAG_CLIENT_OPT},
+    {.key = "performance.md-cache-lease-limit",
+     .voltype = "performance/md-cache",
+     .option = "md-cache-lease-limit",
+     .op_version = GD_OP_VERSION_10_0,
+     .flags = VOLOPT_FLAG_CLIENT_OPT},
     {.key = "performance.xattr-cache-list",
      .voltype = "performance/md-cache",
      .option = "xattr-cache-list",
@@ -1518,6 +1563,12 @@ struct volopt_map_entry glusterd_volopt_map[] = {
      .op_version = GD_OP_VERSION_3_10_2,
      .value = "9",
      .flags = VOLOPT_FLAG_CLIENT_OPT},
+    {.key = "client.io-uring",
+     .voltype = "protocol/client",
+     .option = "transport.socket.io-uring",
+     .op_version = GD_OP_VERSION_10_0,
+     .value = "off",
+     .flags = VOLOPT_FLAG_CLIENT_OPT},
     {.key = "client.strict-locks",
      .voltype = "protocol/client",
      .option = "strict-locks",
@@ -1673,6 +1724,13 @@ struct volopt_map_entry glusterd_volopt_map[] = {
         .op_version = GD_OP_VERSION_3_10_2,
         .value = "9",
     },
+    {
+        .key = "server.io-uring",
+        .voltype = "protocol/server",
+        .option = "transport.socket.io-uring",
+        .op_version = GD_OP_VERSION_10_0,
+        .value = "off",
+    },
     {
         .key = "transport.listen-backlog",
         .voltype = "protocol/server",
@@ -2619,6 +2677,10 @@ struct volopt_map_entry glusterd_volopt_map[] = {
      .voltype = "features/shard",
      .op_version = GD_OP_VERSION_5_0,
      .flags = VOLOPT_FLAG_CLIENT_OPT},
+    {.key = "features.shard-lookup-batch",
+     .voltype = "features/shard",
+     .op_version = GD_OP_VERSION_10_0,
+     .flags = VOLOPT_FLAG_CLIENT_OPT},
     {
         .key = "features.scrub-throttle",
         .voltype = "features/bit-rot",
@@ -2715,6 +2777,10 @@ struct volopt_map_entry glusterd_volopt_map[] = {
      .voltype = "cluster/disperse",
      .op_version = GD_OP_VERSION_3_7_6,
      .flags = VOLOPT_FLAG_CLIENT_OPT},
+    {.key = "disperse.read-hedge-count",
+     .voltype = "cluster/disperse",
+     .op_version = GD_OP_VERSION_10_0,
+     .flags = VOLOPT_FLAG_CLIENT_OPT},
     {.key = "cluster.shd-max-threads",
      .voltype = "cluster/replicate",
      .op_version = GD_OP_VERSION_3_7_12,
@@ -2724,6 +2790,10 @@ struct volopt_map_entry glusterd_volopt_map[] = {
      .voltype = "cluster/replicate",
      .op_version = GD_OP_VERSION_3_7_12,
      .flags = VOLOPT_FLAG_CLIENT_OPT},
+    {.key = "cluster.shd-client-latency-target",
+     .voltype = "cluster/replicate",
+     .op_version = GD_OP_VERSION_10_0,
+     .flags = VOLOPT_FLAG_CLIENT_OPT},
     {.key = "cluster.locking-scheme",
      .voltype = "cluster/replicate",
      .type = DOC,
@@ -2780,6 +2850,10 @@ struct volopt_map_entry glusterd_volopt_map[] = {
      .voltype = "cluster/disperse",
      .op_version = GD_OP_VERSION_3_9_0,
      .flags = VOLOPT_FLAG_CLIENT_OPT},
+    {.key = "disperse.shd-client-latency-target",
+     .voltype = "cluster/disperse",
+     .op_version = GD_OP_VERSION_10_0,
+     .flags = VOLOPT_FLAG_CLIENT_OPT},
     {.key = "disperse.cpu-extensions",
      .voltype = "cluster/disperse",
      .op_version = GD_OP_VERSION_3_9_0,
@@ -2788,11 +2862,17 @@ struct volopt_map_entry glusterd_volopt_map[] = {
      .voltype = "cluster/disperse",
      .op_version = GD_OP_VERSION_3_11_0,
      .flags = VOLOPT_FLAG_CLIENT_OPT},
+    {.key = "disperse.self-heal-pipeline-depth",
+     .voltype = "cluster/disperse",
+     .op_version = GD_OP_VERSION_10_0,
+     .flags = VOLOPT_FLAG_CLIENT_OPT},
     {.key = "cluster.use-compound-fops",
      .voltype = "cluster/replicate",
      .value = "off",
      .type = DOC,
      .op_version = GD_OP_VERSION_3_8_4,
+     .description = "Send the post-op and unlock of a replicate "
+                    "transaction as one compound fop to each brick.",
      .flags = VOLOPT_FLAG_CLIENT_OPT},
     {.key = "performance.parallel-readdir",
      .voltype = "performance/readdir-ahead",
@@ -2837,6 +2917,20 @@ struct volopt_map_entry glusterd_volopt_map[] = {
      .flags = VOLOPT_FLAG_CLIENT_OPT,
      .op_version = GD_OP_VERSION_3_9_1,
      .validate_fn = validate_rda_cache_limit},
+    {.key = "performance.rda-dir-cache",
+     .voltype = "performance/readdir-ahead",
+     .option = "rda-dir-cache",
+     .value = "off",
+     .type = DOC,
+     .flags = VOLOPT_FLAG_CLIENT_OPT,
+     .op_version = GD_OP_VERSION_10_0},
+    {.key = "performance.rda-dir-cache-timeout",
+     .voltype = "performance/readdir-ahead",
+     .option = "rda-dir-cache-timeout",
+     .value = "60",
+     .type = DOC,
+     .flags = VOLOPT_FLAG_CLIENT_OPT,
+     .op_version = GD_OP_VERSION_10_0},
     {
         .key = "performance.nl-cache-positive-entry",
         .voltype = "performance/nl-cache",
@@ -2860,6 +2954,23 @@ struct volopt_map_entry glusterd_volopt_map[] = {
         .flags = VOLOPT_FLAG_CLIENT_OPT,
         .op_version = GD_OP_VERSION_3_11_0,
     },
+    {
+        .key = "performance.nl-cache-complete-dir",
+        .voltype = "performance/nl-cache",
+        .option = "nl-cache-complete-dir",
+        .value = "off",
+        .type = DOC,
+        .flags = VOLOPT_FLAG_CLIENT_OPT,
+        .op_version = GD_OP_VERSION_10_0,
+    },
+    {
+        .key = "performance.nl-cache-filter-bits",
+        .voltype = "performance/nl-cache",
+        .option = "nl-cache-filter-bits",
+        .value = "10",
+        .flags = VOLOPT_FLAG_CLIENT_OPT,
+        .op_version = GD_OP_VERSION_10_0,
+    },
 
     /* Brick multiplexing options */
     {.key = GLUSTERD_BRICK_MULTIPLEX_KEY,
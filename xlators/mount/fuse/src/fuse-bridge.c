@@ -5144,6 +5144,25 @@ fuse_init(xlator_t *this, fuse_in_header_t *finh, void *msg,
     fino.max_readahead = 1 << 17;
     fino.max_write = 1 << 17;
     fino.flags = FUSE_ASYNC_READ | FUSE_POSIX_LOCKS;
+#if FUSE_KERNEL_MINOR_VERSION >= 28
+    if (fini->minor >= 28 && (fini->flags & FUSE_MAX_PAGES) &&
+        priv->max_write > fino.max_write) {
+        /* The kernel caps a request at max_pages pages (32 unless we
+         * tell it otherwise), so ask for as many as it takes to carry
+         * max-write bytes of payload. The reader threads size their
+         * buffers for max-write right from the start. */
+        fino.flags |= FUSE_MAX_PAGES;
+        fino.max_pages = (priv->max_write + priv->page_size - 1) /
+                         priv->page_size;
+        fino.max_write = priv->max_write;
+        fino.max_readahead = priv->max_write;
+
+        /* Lookups and readdirs in one directory need not be serialized
+         * by the kernel, the inode table copes with racing lookups. */
+        if (fini->flags & FUSE_PARALLEL_DIROPS)
+            fino.flags |= FUSE_PARALLEL_DIROPS;
+    }
+#endif
 #if FUSE_KERNEL_MINOR_VERSION >= 17
     if (fini->minor >= 17)
         fino.flags |= FUSE_FLOCK_LOCKS;
@@ -5290,13 +5309,17 @@ fuse_init(xlator_t *this, fuse_in_header_t *finh, void *msg,
 #endif
 
     ret = send_fuse_data(this, finh, &fino, size);
-    if (ret == 0)
+    if (ret == 0) {
         gf_log("glusterfs-fuse", GF_LOG_INFO,
                "FUSE inited with protocol versions:"
                " glusterfs %d.%d kernel %d.%d",
                FUSE_KERNEL_VERSION, FUSE_KERNEL_MINOR_VERSION, fini->major,
                fini->minor);
-    else {
+        if (fino.flags & FUSE_MAX_PAGES)
+            gf_log("glusterfs-fuse", GF_LOG_INFO,
+                   "negotiated requests of up to %u bytes (%u pages)",
+                   fino.max_write, fino.max_pages);
+    } else {
         gf_log("glusterfs-fuse", GF_LOG_ERROR, "FUSE init failed (%s)",
                strerror(ret));
 
@@ -6084,6 +6107,11 @@ fuse_thread_proc(void *data)
     THIS = this;
 
     psize = ((struct iobuf_pool *)this->ctx->iobuf_pool)->default_page_size;
+    /* Once INIT is answered the kernel may hand a write of max-write
+     * bytes to a reader that is already blocked in readv, so the
+     * buffers have to be large enough before the negotiation. */
+    if (priv->max_write > psize)
+        psize = priv->max_write;
     priv->msg0_len_p = &msg0_size;
 
     for (;;) {
@@ -6135,11 +6163,7 @@ fuse_thread_proc(void *data)
         if (priv->init_recvd)
             fuse_graph_sync(this);
 
-        /* TODO: This place should always get maximum supported buffer
-           size from 'fuse', which is as of today 128KB. If we bring in
-           support for higher block sizes support, then we should be
-           changing this one too */
-        iobuf = iobuf_get(this->ctx->iobuf_pool);
+        iobuf = iobuf_get2(this->ctx->iobuf_pool, psize);
 
         /* Add extra 512 byte to the first iov so that it can
          * accommodate "ordinary" non-write requests. It's not
@@ -6858,6 +6882,9 @@ init(xlator_t *this_xl)
     GF_OPTION_INIT("congestion-threshold", priv->congestion_threshold, int32,
                    cleanup_exit);
 
+    GF_OPTION_INIT("max-write", priv->max_write, size_uint64, cleanup_exit);
+    priv->page_size = sysconf(_SC_PAGESIZE);
+
     GF_OPTION_INIT("no-root-squash", priv->no_root_squash, bool, cleanup_exit);
     /* change the client_pid to no-root-squash pid only if the
        client is neither defrag process or gsyncd process.
@@ -7130,6 +7157,17 @@ struct volume_options options[] = {
         .min = 12,
         .max = (64 * GF_UNIT_KB),
     },
+    {
+        .key = {"max-write"},
+        .type = GF_OPTION_TYPE_SIZET,
+        .default_value = "128KB",
+        .min = 128 * GF_UNIT_KB,
+        .max = 1 * GF_UNIT_MB,
+        .description = "Largest read or write request the kernel may send "
+                       "in one piece. Values above 128KB need a kernel "
+                       "with FUSE protocol 7.28 (max_pages), older kernels "
+                       "stay at 128KB.",
+    },
     {.key = {"fuse-mountopts"}, .type = GF_OPTION_TYPE_STR},
     {.key = {"use-readdirp"},
      .type = GF_OPTION_TYPE_BOOL,
@@ -129,6 +129,8 @@ struct fuse_private {
 
     /* for fuse queue length and congestion threshold */
     int background_qlen;
+    uint64_t max_write; /* largest request payload offered to the kernel */
+    long page_size;
     int congestion_threshold;
 
     /* for using fuse-kernel readdirp*/
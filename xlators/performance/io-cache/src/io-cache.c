@@ -116,7 +116,8 @@ ioc_update_pages(call_frame_t *frame, ioc_inode_t *ioc_inode,
                                count, write_offset, page_end - page_offset);
             } else if (trav) {
                 if (!trav->waitq)
-                    ioc_inode->table->cache_used -= __ioc_page_destroy(trav);
+                    GF_ATOMIC_SUB(ioc_inode->table->cache_used,
+                                  __ioc_page_destroy(trav));
             }
 
             if (trav_offset == rounded_offset)
@@ -182,13 +183,8 @@ ioc_inode_flush(ioc_inode_t *ioc_inode)
     }
     ioc_inode_unlock(ioc_inode);
 
-    if (destroy_size) {
-        ioc_table_lock(ioc_inode->table);
-        {
-            ioc_inode->table->cache_used -= destroy_size;
-        }
-        ioc_table_unlock(ioc_inode->table);
-    }
+    if (destroy_size)
+        GF_ATOMIC_SUB(ioc_inode->table->cache_used, destroy_size);
 
     return;
 }
@@ -266,12 +262,7 @@ ioc_inode_update(xlator_t *this, inode_t *inode, char *path, struct iatt *iabuf)
         ioc_inode_flush(ioc_inode);
     }
 
-    ioc_table_lock(ioc_inode->table);
-    {
-        list_move_tail(&ioc_inode->inode_lru,
-                       &table->inode_lru[ioc_inode->weight]);
-    }
-    ioc_table_unlock(ioc_inode->table);
+    ioc_inode_lru_touch(ioc_inode);
 
 out:
     return 0;
@@ -431,13 +422,8 @@ ioc_cache_validate_cbk(call_frame_t *frame, void *cookie, xlator_t *this,
         local_stbuf = NULL;
     }
 
-    if (destroy_size) {
-        ioc_table_lock(ioc_inode->table);
-        {
-            ioc_inode->table->cache_used -= destroy_size;
-        }
-        ioc_table_unlock(ioc_inode->table);
-    }
+    if (destroy_size)
+        GF_ATOMIC_SUB(ioc_inode->table->cache_used, destroy_size);
 
     if (op_ret < 0)
         local_stbuf = NULL;
@@ -619,12 +605,7 @@ ioc_open_cbk(call_frame_t *frame, void *cookie, xlator_t *this, int32_t op_ret,
             goto out;
         }
 
-        ioc_table_lock(ioc_inode->table);
-        {
-            list_move_tail(&ioc_inode->inode_lru,
-                           &table->inode_lru[ioc_inode->weight]);
-        }
-        ioc_table_unlock(ioc_inode->table);
+        ioc_inode_lru_touch(ioc_inode);
 
         ioc_inode_lock(ioc_inode);
         {
@@ -924,11 +905,7 @@ ioc_need_prune(ioc_table_t *table)
 {
     int64_t cache_difference = 0;
 
-    ioc_table_lock(table);
-    {
-        cache_difference = table->cache_used - table->cache_size;
-    }
-    ioc_table_unlock(table);
+    cache_difference = GF_ATOMIC_GET(table->cache_used) - table->cache_size;
 
     if (cache_difference > 0)
         return 1;
@@ -964,6 +941,7 @@ ioc_dispatch_requests(call_frame_t *frame, ioc_inode_t *ioc_inode, fd_t *fd,
                                      * if a page exists, do we need
                                      * to validate it?
                                      */
+    int8_t sequential = 0;
     local = frame->local;
     table = ioc_inode->table;
 
@@ -986,6 +964,13 @@ ioc_dispatch_requests(call_frame_t *frame, ioc_inode_t *ioc_inode, fd_t *fd,
     while (trav_offset < rounded_end) {
         ioc_inode_lock(ioc_inode);
         {
+            if (trav_offset == rounded_offset) {
+                /* a read continuing in the page the last one ended in
+                 * is not a new reference to that page */
+                sequential = (rounded_offset == ioc_inode->last_page);
+                ioc_inode->last_page = rounded_end - table->page_size;
+            }
+
             /* look for requested region in the cache */
             trav = __ioc_page_get(ioc_inode, trav_offset);
 
@@ -996,6 +981,7 @@ ioc_dispatch_requests(call_frame_t *frame, ioc_inode_t *ioc_inode, fd_t *fd,
                 /* page not in cache, we need to generate page
                  * fault
                  */
+                GF_ATOMIC_INC(table->ioc_counter.cache_miss);
                 trav = __ioc_page_create(ioc_inode, trav_offset);
                 fault = 1;
                 if (!trav) {
@@ -1006,12 +992,18 @@ ioc_dispatch_requests(call_frame_t *frame, ioc_inode_t *ioc_inode, fd_t *fd,
                     ioc_inode_unlock(ioc_inode);
                     goto out;
                 }
+            } else {
+                GF_ATOMIC_INC(table->ioc_counter.cache_hit);
             }
 
             __ioc_wait_on_page(trav, frame, local_offset, trav_size);
 
             if (trav->ready) {
                 /* page found in cache */
+                if ((table->policy == IOC_POLICY_2Q) && !trav->hot &&
+                    !(sequential && (trav_offset == rounded_offset)))
+                    __ioc_page_promote(trav);
+
                 if (!might_need_validate && !ioc_inode->waitq) {
                     /* fresh enough */
                     gf_msg_trace(frame->this->name, 0,
@@ -1107,7 +1099,6 @@ ioc_readv(call_frame_t *frame, xlator_t *this, fd_t *fd, size_t size,
     uint64_t tmp_ioc_inode = 0;
     ioc_inode_t *ioc_inode = NULL;
     ioc_local_t *local = NULL;
-    uint32_t weight = 0;
     ioc_table_t *table = NULL;
     int32_t op_errno = EINVAL;
 
@@ -1188,14 +1179,7 @@ ioc_readv(call_frame_t *frame, xlator_t *this, fd_t *fd, size_t size,
                  "= %" PRId64 " && size = %" GF_PRI_SIZET "",
                  frame, offset, size);
 
-    weight = ioc_inode->weight;
-
-    ioc_table_lock(ioc_inode->table);
-    {
-        list_move_tail(&ioc_inode->inode_lru,
-                       &ioc_inode->table->inode_lru[weight]);
-    }
-    ioc_table_unlock(ioc_inode->table);
+    ioc_inode_lru_touch(ioc_inode);
 
     ioc_dispatch_requests(frame, ioc_inode, fd, offset, size);
     return 0;
@@ -1656,6 +1640,15 @@ out:
     return ret;
 }
 
+static ioc_policy_t
+ioc_get_policy(const char *policy)
+{
+    if (!strcmp(policy, "2q"))
+        return IOC_POLICY_2Q;
+
+    return IOC_POLICY_LRU;
+}
+
 int
 reconfigure(xlator_t *this, dict_t *options)
 {
@@ -1663,6 +1656,7 @@ reconfigure(xlator_t *this, dict_t *options)
     ioc_table_t *table = NULL;
     int ret = -1;
     uint64_t cache_size_new = 0;
+    char *policy = NULL;
     if (!this || !this->private)
         goto out;
 
@@ -1676,6 +1670,9 @@ reconfigure(xlator_t *this, dict_t *options)
         GF_OPTION_RECONF("cache-timeout", table->cache_timeout, options, time,
                          unlock);
 
+        GF_OPTION_RECONF("cache-policy", policy, options, str, unlock);
+        table->policy = ioc_get_policy(policy);
+
         data = dict_get(options, "priority");
         if (data) {
             char *option_list = data_to_str(data);
@@ -1738,6 +1735,8 @@ init(xlator_t *this)
     glusterfs_ctx_t *ctx = NULL;
     data_t *data = 0;
     uint32_t num_pages = 0;
+    char *policy = NULL;
+    int i = 0;
 
     xl_options = this->options;
 
@@ -1771,6 +1770,9 @@ init(xlator_t *this)
 
     GF_OPTION_INIT("max-file-size", table->max_file_size, size_uint64, out);
 
+    GF_OPTION_INIT("cache-policy", policy, str, out);
+    table->policy = ioc_get_policy(policy);
+
     if (!check_cache_size_ok(this, table->cache_size)) {
         ret = -1;
         goto out;
@@ -1802,14 +1804,25 @@ init(xlator_t *this)
         goto out;
     }
 
-    table->inode_lru = GF_CALLOC(table->max_pri, sizeof(struct list_head),
-                                 gf_ioc_mt_list_head);
-    if (table->inode_lru == NULL) {
-        goto out;
+    for (i = 0; i < IOC_TABLE_SHARDS; i++) {
+        table->shards[i].inode_lru = GF_CALLOC(
+            table->max_pri, sizeof(struct list_head), gf_ioc_mt_list_head);
+        if (table->shards[i].inode_lru == NULL) {
+            goto out;
+        }
+
+        for (index = 0; index < (table->max_pri); index++)
+            INIT_LIST_HEAD(&table->shards[i].inode_lru[index]);
+
+        pthread_mutex_init(&table->shards[i].lock, NULL);
     }
 
-    for (index = 0; index < (table->max_pri); index++)
-        INIT_LIST_HEAD(&table->inode_lru[index]);
+    GF_ATOMIC_INIT(table->cache_used, 0);
+    GF_ATOMIC_INIT(table->hot_used, 0);
+    GF_ATOMIC_INIT(table->ioc_counter.cache_hit, 0);
+    GF_ATOMIC_INIT(table->ioc_counter.cache_miss, 0);
+    GF_ATOMIC_INIT(table->ioc_counter.evictions, 0);
+    GF_ATOMIC_INIT(table->ioc_counter.promotions, 0);
 
     this->local_pool = mem_pool_new(ioc_local_t, 64);
     if (!this->local_pool) {
@@ -1820,6 +1833,7 @@ init(xlator_t *this)
     }
 
     pthread_mutex_init(&table->table_lock, NULL);
+    pthread_mutex_init(&table->prune_lock, NULL);
     this->private = table;
 
     num_pages = (table->cache_size / table->page_size) +
@@ -1840,7 +1854,8 @@ init(xlator_t *this)
 out:
     if (ret == -1) {
         if (table != NULL) {
-            GF_FREE(table->inode_lru);
+            for (i = 0; i < IOC_TABLE_SHARDS; i++)
+                GF_FREE(table->shards[i].inode_lru);
             GF_FREE(table);
         }
     }
@@ -2054,7 +2069,20 @@ ioc_priv_dump(xlator_t *this)
     {
         gf_proc_dump_write("page_size", "%" PRIu64, priv->page_size);
         gf_proc_dump_write("cache_size", "%" PRIu64, priv->cache_size);
-        gf_proc_dump_write("cache_used", "%" PRIu64, priv->cache_used);
+        gf_proc_dump_write("cache_used", "%" PRId64,
+                           GF_ATOMIC_GET(priv->cache_used));
+        gf_proc_dump_write("cache_policy", "%s",
+                           (priv->policy == IOC_POLICY_2Q) ? "2q" : "lru");
+        gf_proc_dump_write("hot_used", "%" PRId64,
+                           GF_ATOMIC_GET(priv->hot_used));
+        gf_proc_dump_write("cache_hit", "%" PRId64,
+                           GF_ATOMIC_GET(priv->ioc_counter.cache_hit));
+        gf_proc_dump_write("cache_miss", "%" PRId64,
+                           GF_ATOMIC_GET(priv->ioc_counter.cache_miss));
+        gf_proc_dump_write("evictions", "%" PRId64,
+                           GF_ATOMIC_GET(priv->ioc_counter.evictions));
+        gf_proc_dump_write("promotions", "%" PRId64,
+                           GF_ATOMIC_GET(priv->ioc_counter.promotions));
         gf_proc_dump_write("inode_count", "%u", priv->inode_count);
         gf_proc_dump_write("cache_timeout", "%ld", priv->cache_timeout);
         gf_proc_dump_write("min-file-size", "%" PRIu64, priv->min_file_size);
@@ -2081,6 +2109,28 @@ out:
     return 0;
 }
 
+static int32_t
+ioc_dump_metrics(xlator_t *this, int fd)
+{
+    ioc_table_t *table = this->private;
+
+    if (!table)
+        return 0;
+
+    dprintf(fd, "%s.total_cache_used %" PRId64 "\n", this->name,
+            GF_ATOMIC_GET(table->cache_used));
+    dprintf(fd, "%s.cache-hit %" PRId64 "\n", this->name,
+            GF_ATOMIC_GET(table->ioc_counter.cache_hit));
+    dprintf(fd, "%s.cache-miss %" PRId64 "\n", this->name,
+            GF_ATOMIC_GET(table->ioc_counter.cache_miss));
+    dprintf(fd, "%s.cache-evictions %" PRId64 "\n", this->name,
+            GF_ATOMIC_GET(table->ioc_counter.evictions));
+    dprintf(fd, "%s.cache-promotions %" PRId64 "\n", this->name,
+            GF_ATOMIC_GET(table->ioc_counter.promotions));
+
+    return 0;
+}
+
 /*
  * fini -
  *
@@ -2092,6 +2142,7 @@ fini(xlator_t *this)
 {
     ioc_table_t *table = NULL;
     struct ioc_priority *curr = NULL, *tmp = NULL;
+    int i = 0;
 
     table = this->private;
 
@@ -2116,11 +2167,16 @@ fini(xlator_t *this)
      * called soon after init()? Hence commenting the below asserts.
      */
     /*for (i = 0; i < table->max_pri; i++) {
-            GF_ASSERT (list_empty (&table->inode_lru[i]));
+            GF_ASSERT (list_empty (&table->shards[0].inode_lru[i]));
     }
 
     GF_ASSERT (list_empty (&table->inodes));
     */
+    for (i = 0; i < IOC_TABLE_SHARDS; i++) {
+        pthread_mutex_destroy(&table->shards[i].lock);
+        GF_FREE(table->shards[i].inode_lru);
+    }
+    pthread_mutex_destroy(&table->prune_lock);
     pthread_mutex_destroy(&table->table_lock);
     GF_FREE(table);
 
@@ -2213,6 +2269,19 @@ struct volume_options options[] = {
      .flags = OPT_FLAG_SETTABLE | OPT_FLAG_DOC | OPT_FLAG_CLIENT_OPT,
      .tags = {"io-cache"},
      .description = "Enable/Disable io cache translator"},
+    {.key = {"cache-policy"},
+     .type = GF_OPTION_TYPE_STR,
+     .value = {"lru", "2q"},
+     .default_value = "lru",
+     .op_version = {GD_OP_VERSION_10_0},
+     .flags = OPT_FLAG_CLIENT_OPT | OPT_FLAG_SETTABLE | OPT_FLAG_DOC,
+     .tags = {"io-cache"},
+     .description = "Page replacement policy of the cache. 'lru' evicts "
+                    "the least recently used pages. '2q' keeps the pages "
+                    "read only once apart from those read again, and "
+                    "evicts them first, so that streaming large files "
+                    "through the cache does not flush the pages other "
+                    "applications keep reading."},
     {.key = {NULL}},
 };
 
@@ -2221,6 +2290,7 @@ xlator_api_t xlator_api = {
     .fini = fini,
     .reconfigure = reconfigure,
     .mem_acct_init = mem_acct_init,
+    .dump_metrics = ioc_dump_metrics,
     .op_version = {1}, /* Present from the initial version */
     .dumpops = &dumpops,
     .fops = &fops,
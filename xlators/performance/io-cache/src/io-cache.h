@@ -26,11 +26,33 @@
 #define IOC_CACHE_SIZE (32 * 1024 * 1024)
 #define IOC_PAGE_TABLE_BUCKET_COUNT 1
 
+/* Number of independent inode LRUs of the table. An ioc_inode is assigned
+ * to a shard when it is created, and the shard lock protects its place in
+ * the shard's inode_lru lists. */
+#define IOC_TABLE_SHARDS 16
+
+/* With the 2q policy, pages seen only once are evicted before any page
+ * seen twice, as long as they take more than 1/IOC_2Q_COLD_SHARE of the
+ * cache. */
+#define IOC_2Q_COLD_SHARE 4
+
 struct ioc_table;
 struct ioc_local;
 struct ioc_page;
 struct ioc_inode;
 
+typedef enum {
+    IOC_POLICY_LRU = 0,
+    IOC_POLICY_2Q,
+} ioc_policy_t;
+
+/* which pages a prune pass may evict */
+typedef enum {
+    IOC_PRUNE_ALL = 0,
+    IOC_PRUNE_COLD,
+    IOC_PRUNE_HOT,
+} ioc_prune_class_t;
+
 struct ioc_priority {
     struct list_head list;
     char *pattern;
@@ -112,6 +134,8 @@ struct ioc_page {
     pthread_mutex_t page_lock;
     int32_t op_errno;
     char stale;
+    char hot;        /* referenced again since it was cached (2q) */
+    size_t hot_size; /* bytes accounted in table->hot_used */
 };
 
 struct ioc_cache {
@@ -142,25 +166,46 @@ struct ioc_inode {
                       * on each read
                       */
     inode_t *inode;
+    struct ioc_table_shard *shard; /* shard whose inode_lru we are in */
+    off_t last_page;               /* last page of the last read, to
+                                    * tell a sequential read from a
+                                    * re-read */
+};
+
+struct ioc_table_shard {
+    pthread_mutex_t lock;
+    struct list_head *inode_lru; /* max_pri lists, least recent first */
+} __attribute__((aligned(CAA_CACHE_LINE_SIZE)));
+
+struct ioc_statistics {
+    gf_atomic_t cache_hit;
+    gf_atomic_t cache_miss;
+    gf_atomic_t evictions;
+    gf_atomic_t promotions;
 };
 
 struct ioc_table {
     uint64_t page_size;
     uint64_t cache_size;
-    uint64_t cache_used;
+    gf_atomic_t cache_used;
+    gf_atomic_t hot_used; /* part of cache_used in hot pages */
     uint64_t min_file_size;
     uint64_t max_file_size;
     struct list_head inodes; /* list of inodes cached */
     struct list_head active;
-    struct list_head *inode_lru;
     struct list_head priority_list;
     int32_t readv_count;
-    pthread_mutex_t table_lock;
+    pthread_mutex_t table_lock; /* inodes, inode_count and the options */
+    pthread_mutex_t prune_lock; /* one pruner at a time */
     xlator_t *xl;
     uint32_t inode_count;
+    uint32_t next_shard;
     time_t cache_timeout;
     int32_t max_pri;
+    ioc_policy_t policy;
     struct mem_pool *mem_pool;
+    struct ioc_statistics ioc_counter;
+    struct ioc_table_shard shards[IOC_TABLE_SHARDS];
 };
 
 typedef struct ioc_table ioc_table_t;
@@ -240,6 +285,16 @@ ioc_frame_fill(ioc_page_t *page, call_frame_t *frame, off_t offset, size_t size,
         gf_msg_trace(table->xl->name, 0, "unlocked table(%p)", table);         \
     } while (0)
 
+#define ioc_shard_lock(shard)                                                  \
+    do {                                                                       \
+        pthread_mutex_lock(&(shard)->lock);                                    \
+    } while (0)
+
+#define ioc_shard_unlock(shard)                                                \
+    do {                                                                       \
+        pthread_mutex_unlock(&(shard)->lock);                                  \
+    } while (0)
+
 #define ioc_local_lock(local)                                                  \
     do {                                                                       \
         gf_msg_trace(local->inode->table->xl->name, 0, "locked local(%p)",     \
@@ -270,6 +325,12 @@ ioc_inode_create(ioc_table_t *table, inode_t *inode, uint32_t weight);
 int64_t
 __ioc_page_destroy(ioc_page_t *page);
 
+void
+__ioc_page_promote(ioc_page_t *page);
+
+void
+ioc_inode_lru_touch(ioc_inode_t *ioc_inode);
+
 int64_t
 __ioc_inode_flush(ioc_inode_t *ioc_inode);
 
@@ -178,15 +178,20 @@ ioc_inode_create(ioc_table_t *table, inode_t *inode, uint32_t weight)
     INIT_LIST_HEAD(&ioc_inode->cache.page_lru);
     pthread_mutex_init(&ioc_inode->inode_lock, NULL);
     ioc_inode->weight = weight;
+    ioc_inode->last_page = -1;
+    INIT_LIST_HEAD(&ioc_inode->inode_lru);
 
     ioc_table_lock(table);
     {
         table->inode_count++;
         list_add(&ioc_inode->inode_list, &table->inodes);
-        list_add_tail(&ioc_inode->inode_lru, &table->inode_lru[weight]);
+        ioc_inode->shard = &table->shards[table->next_shard++ %
+                                          IOC_TABLE_SHARDS];
     }
     ioc_table_unlock(table);
 
+    ioc_inode_lru_touch(ioc_inode);
+
     gf_msg_trace(table->xl->name, 0, "adding to inode_lru[%d]", weight);
 
 out:
@@ -213,10 +218,15 @@ ioc_inode_destroy(ioc_inode_t *ioc_inode)
     {
         table->inode_count--;
         list_del(&ioc_inode->inode_list);
-        list_del(&ioc_inode->inode_lru);
     }
     ioc_table_unlock(table);
 
+    ioc_shard_lock(ioc_inode->shard);
+    {
+        list_del(&ioc_inode->inode_lru);
+    }
+    ioc_shard_unlock(ioc_inode->shard);
+
     ioc_inode_flush(ioc_inode);
     rbthash_table_destroy(ioc_inode->cache.page_table);
 
@@ -225,3 +235,23 @@ ioc_inode_destroy(ioc_inode_t *ioc_inode)
 out:
     return;
 }
+
+/*
+ * ioc_inode_lru_touch - make ioc_inode the most recently used inode of its
+ *                       priority in its shard
+ *
+ * @ioc_inode:
+ *
+ */
+void
+ioc_inode_lru_touch(ioc_inode_t *ioc_inode)
+{
+    struct ioc_table_shard *shard = ioc_inode->shard;
+
+    ioc_shard_lock(shard);
+    {
+        list_move_tail(&ioc_inode->inode_lru,
+                       &shard->inode_lru[ioc_inode->weight]);
+    }
+    ioc_shard_unlock(shard);
+}
@@ -17,6 +17,18 @@
 #include <assert.h>
 #include <sys/time.h>
 #include "io-cache-messages.h"
+/* With the 2q policy, pages only seen once stay in the order they were
+ * cached, so a file streamed through the cache is evicted before the pages
+ * referenced again, which are kept in LRU order. */
+static void
+__ioc_page_lru_update(ioc_page_t *page)
+{
+    if ((page->inode->table->policy == IOC_POLICY_2Q) && !page->hot)
+        return;
+
+    list_move_tail(&page->page_lru, &page->inode->cache.page_lru);
+}
+
 char
 ioc_empty(struct ioc_cache *cache)
 {
@@ -49,7 +61,7 @@ __ioc_page_get(ioc_inode_t *ioc_inode, off_t offset)
 
     if (page != NULL) {
         /* push the page to the end of the lru list */
-        list_move_tail(&page->page_lru, &ioc_inode->cache.page_lru);
+        __ioc_page_lru_update(page);
     }
 
 out:
@@ -100,6 +112,9 @@ __ioc_page_destroy(ioc_page_t *page)
                        sizeof(page->offset));
         list_del(&page->page_lru);
 
+        if (page->hot)
+            GF_ATOMIC_SUB(page->inode->table->hot_used, page->hot_size);
+
         gf_msg_trace(page->inode->table->xl->name, 0,
                      "destroying page = %p, offset = %" PRId64
                      " "
@@ -145,9 +160,30 @@ out:
     return ret;
 }
 
+/*
+ * __ioc_page_promote - a page of the 2q probation FIFO was referenced
+ *                      again, move it to the LRU of hot pages
+ *
+ * @page:
+ *
+ */
+void
+__ioc_page_promote(ioc_page_t *page)
+{
+    ioc_table_t *table = page->inode->table;
+
+    page->hot = 1;
+    page->hot_size = page->iobref ? iobref_size(page->iobref) : 0;
+    GF_ATOMIC_ADD(table->hot_used, page->hot_size);
+    GF_ATOMIC_INC(table->ioc_counter.promotions);
+
+    list_move_tail(&page->page_lru, &page->inode->cache.page_lru);
+}
+
 int32_t
 __ioc_inode_prune(ioc_inode_t *curr, uint64_t *size_pruned,
-                  uint64_t size_to_prune, uint32_t index)
+                  uint64_t size_to_prune, uint32_t index,
+                  ioc_prune_class_t class)
 {
     ioc_page_t *page = NULL, *next = NULL;
     int32_t ret = 0;
@@ -161,18 +197,25 @@ __ioc_inode_prune(ioc_inode_t *curr, uint64_t *size_pruned,
 
     list_for_each_entry_safe(page, next, &curr->cache.page_lru, page_lru)
     {
+        if (((class == IOC_PRUNE_COLD) && page->hot) ||
+            ((class == IOC_PRUNE_HOT) && !page->hot))
+            continue;
+
         *size_pruned += page->size;
         ret = __ioc_page_destroy(page);
 
-        if (ret != -1)
-            table->cache_used -= ret;
+        if (ret != -1) {
+            GF_ATOMIC_SUB(table->cache_used, ret);
+            GF_ATOMIC_INC(table->ioc_counter.evictions);
+        }
 
         gf_msg_trace(table->xl->name, 0,
                      "index = %d && "
-                     "table->cache_used = %" PRIu64
+                     "table->cache_used = %" PRId64
                      " && table->"
                      "cache_size = %" PRIu64,
-                     index, table->cache_used, table->cache_size);
+                     index, GF_ATOMIC_GET(table->cache_used),
+                     table->cache_size);
 
         if ((*size_pruned) >= size_to_prune)
             break;
@@ -185,6 +228,70 @@ __ioc_inode_prune(ioc_inode_t *curr, uint64_t *size_pruned,
 out:
     return 0;
 }
+static void
+ioc_shard_prune(struct ioc_table_shard *shard, int32_t index,
+                ioc_prune_class_t class, uint64_t *size_pruned,
+                uint64_t size_to_prune)
+{
+    ioc_inode_t *curr = NULL, *next_ioc_inode = NULL;
+
+    ioc_shard_lock(shard);
+    {
+        /* take out the least recently used inode */
+        list_for_each_entry_safe(curr, next_ioc_inode,
+                                 &shard->inode_lru[index], inode_lru)
+        {
+            /* prune page-by-page for this inode, till
+             * we reach the equilibrium */
+            ioc_inode_lock(curr);
+            {
+                __ioc_inode_prune(curr, size_pruned, size_to_prune, index,
+                                  class);
+            }
+            ioc_inode_unlock(curr);
+
+            if (*size_pruned >= size_to_prune)
+                break;
+        } /* list_for_each_entry_safe (curr...) */
+    }
+    ioc_shard_unlock(shard);
+}
+
+/* Every shard has its own inode LRU and inodes are spread evenly over the
+ * shards, so each shard gives up its share of the pages to prune, taken
+ * from its least recently used inodes, which is close to pruning the least
+ * recently used inodes of the whole table. */
+static uint64_t
+ioc_table_prune(ioc_table_t *table, ioc_prune_class_t class,
+                uint64_t size_to_prune)
+{
+    uint64_t size_pruned = 0;
+    uint64_t last_pruned = 0;
+    uint64_t quota = 0;
+    int32_t index = 0;
+    int i = 0;
+
+    for (index = 0; index < table->max_pri; index++) {
+        do {
+            last_pruned = size_pruned;
+            for (i = 0; (i < IOC_TABLE_SHARDS) && (size_pruned < size_to_prune);
+                 i++) {
+                quota = size_pruned + (size_to_prune - size_pruned +
+                                       IOC_TABLE_SHARDS - i - 1) /
+                                          (IOC_TABLE_SHARDS - i);
+                ioc_shard_prune(&table->shards[i], index, class, &size_pruned,
+                                quota);
+            }
+            /* some shards had less than their share */
+        } while ((size_pruned < size_to_prune) && (size_pruned != last_pruned));
+
+        if (size_pruned >= size_to_prune)
+            break;
+    }
+
+    return size_pruned;
+}
+
 /*
  * ioc_prune - prune the cache. we have a limit to the number of pages we
  *             can have in-memory.
@@ -195,40 +302,40 @@ out:
 int32_t
 ioc_prune(ioc_table_t *table)
 {
-    ioc_inode_t *curr = NULL, *next_ioc_inode = NULL;
-    int32_t index = 0;
-    uint64_t size_to_prune = 0;
+    int64_t size_to_prune = 0;
+    int64_t cold_used = 0;
+    int64_t cold_min = 0;
     uint64_t size_pruned = 0;
 
     GF_VALIDATE_OR_GOTO("io-cache", table, out);
 
-    ioc_table_lock(table);
-    {
-        size_to_prune = table->cache_used - table->cache_size;
-        /* take out the least recently used inode */
-        for (index = 0; index < table->max_pri; index++) {
-            list_for_each_entry_safe(curr, next_ioc_inode,
-                                     &table->inode_lru[index], inode_lru)
-            {
-                /* prune page-by-page for this inode, till
-                 * we reach the equilibrium */
-                ioc_inode_lock(curr);
-                {
-                    __ioc_inode_prune(curr, &size_pruned, size_to_prune, index);
-                }
-                ioc_inode_unlock(curr);
-
-                if (size_pruned >= size_to_prune)
-                    break;
-            } /* list_for_each_entry_safe (curr...) */
+    /* whoever holds it prunes down to cache_size for everyone */
+    if (pthread_mutex_trylock(&table->prune_lock))
+        goto out;
 
-            if (size_pruned >= size_to_prune)
-                break;
-        } /* for(index=0;...) */
+    size_to_prune = GF_ATOMIC_GET(table->cache_used) - table->cache_size;
+    if (size_to_prune <= 0)
+        goto unlock;
+
+    if (table->policy == IOC_POLICY_2Q) {
+        /* pages seen once go first, down to their reserved share */
+        cold_used = GF_ATOMIC_GET(table->cache_used) -
+                    GF_ATOMIC_GET(table->hot_used);
+        cold_min = table->cache_size / IOC_2Q_COLD_SHARE;
+        if (cold_used > cold_min)
+            size_pruned = ioc_table_prune(
+                table, IOC_PRUNE_COLD, min(size_to_prune, cold_used - cold_min));
+
+        if (size_pruned < size_to_prune)
+            size_pruned += ioc_table_prune(table, IOC_PRUNE_HOT,
+                                           size_to_prune - size_pruned);
+    }
 
-    } /* ioc_inode_table locked region end */
-    ioc_table_unlock(table);
+    if (size_pruned < size_to_prune)
+        ioc_table_prune(table, IOC_PRUNE_ALL, size_to_prune - size_pruned);
 
+unlock:
+    pthread_mutex_unlock(&table->prune_lock);
 out:
     return 0;
 }
@@ -463,6 +570,7 @@ ioc_fault_cbk(call_frame_t *frame, void *cookie, xlator_t *this, int32_t op_ret,
                         ioc_inode, NULL);
             } else {
                 if (page->vector) {
+                    destroy_size += iobref_size(page->iobref);
                     iobref_unref(page->iobref);
                     GF_FREE(page->vector);
                     page->vector = NULL;
@@ -515,21 +623,11 @@ unlock:
 
     ioc_waitq_return(waitq);
 
-    if (iobref_page_size) {
-        ioc_table_lock(table);
-        {
-            table->cache_used += iobref_page_size;
-        }
-        ioc_table_unlock(table);
-    }
+    if (iobref_page_size)
+        GF_ATOMIC_ADD(table->cache_used, iobref_page_size);
 
-    if (destroy_size) {
-        ioc_table_lock(table);
-        {
-            table->cache_used -= destroy_size;
-        }
-        ioc_table_unlock(table);
-    }
+    if (destroy_size)
+        GF_ATOMIC_SUB(table->cache_used, destroy_size);
 
     if (ioc_need_prune(ioc_inode->table)) {
         ioc_prune(ioc_inode->table);
@@ -671,7 +769,7 @@ __ioc_frame_fill(ioc_page_t *page, call_frame_t *frame, off_t offset,
                  frame, offset, size, page->size, local->wait_count);
 
     /* immediately move this page to the end of the page_lru list */
-    list_move_tail(&page->page_lru, &ioc_inode->cache.page_lru);
+    __ioc_page_lru_update(page);
     /* fill local->pending_size bytes from local->pending_offset */
     if (local->op_ret != -1) {
         local->op_errno = op_errno;
@@ -991,7 +1089,7 @@ __ioc_page_error(ioc_page_t *page, int32_t op_ret, int32_t op_errno)
     ret = __ioc_page_destroy(page);
 
     if (ret != -1) {
-        table->cache_used -= ret;
+        GF_ATOMIC_SUB(table->cache_used, ret);
     }
 
 out:
@@ -29,6 +29,8 @@ int
 iot_workers_scale(iot_conf_t *conf);
 int
 __iot_workers_scale(iot_conf_t *conf);
+static int
+iot_queued(iot_conf_t *conf, int pri);
 struct volume_options options[];
 
 #define IOT_FOP(name, frame, this, args...)                                    \
@@ -56,16 +58,20 @@ struct volume_options options[];
 iot_client_ctx_t *
 iot_get_ctx(xlator_t *this, client_t *client)
 {
+    iot_conf_t *conf = this->private;
     iot_client_ctx_t *ctx = NULL;
     iot_client_ctx_t *setted_ctx = NULL;
+    int32_t queue = 0;
     int i;
 
     if (client_ctx_get(client, this, (void **)&ctx) != 0) {
         ctx = GF_MALLOC(GF_FOP_PRI_MAX * sizeof(*ctx), gf_iot_mt_client_ctx_t);
         if (ctx) {
+            queue = GF_ATOMIC_INC(conf->next_queue) % conf->queue_count;
             for (i = 0; i < GF_FOP_PRI_MAX; ++i) {
                 INIT_LIST_HEAD(&ctx[i].clients);
                 INIT_LIST_HEAD(&ctx[i].reqs);
+                ctx[i].queue = queue;
             }
             setted_ctx = client_ctx_set(client, this, ctx);
             if (ctx != setted_ctx) {
@@ -78,62 +84,91 @@ iot_get_ctx(xlator_t *this, client_t *client)
     return ctx;
 }
 
+static call_stub_t *
+__iot_queue_dequeue(iot_queue_t *queue, int pri)
+{
+    call_stub_t *stub = NULL;
+    iot_client_ctx_t *ctx;
+
+    /* Get the first per-client queue for this priority. */
+    ctx = list_first_entry(&queue->clients[pri], iot_client_ctx_t, clients);
+
+    /* Get the first request on that queue. */
+    stub = list_first_entry(&ctx->reqs, call_stub_t, list);
+    list_del_init(&stub->list);
+    if (list_empty(&ctx->reqs)) {
+        list_del_init(&ctx->clients);
+    } else {
+        list_rotate_left(&queue->clients[pri]);
+    }
+
+    GF_ATOMIC_DEC(queue->sizes[pri]);
+
+    return stub;
+}
+
+/*
+ * Take the request of the highest priority there is room for, from the own
+ * queue of the worker first. A slot of the priority is only reserved with a
+ * request at hand, so that a worker never misses a request because another
+ * one holds the slot for nothing.
+ */
 call_stub_t *
-__iot_dequeue(iot_conf_t *conf, int *pri)
+iot_dequeue(iot_conf_t *conf, iot_queue_t *own, int *pri)
 {
     call_stub_t *stub = NULL;
+    iot_queue_t *queue = NULL;
     int i = 0;
-    iot_client_ctx_t *ctx;
+    int j = 0;
 
     *pri = -1;
     for (i = 0; i < GF_FOP_PRI_MAX; i++) {
-        if (conf->ac_iot_count[i] >= conf->ac_iot_limit[i]) {
+        if (GF_ATOMIC_GET(conf->ac_iot_count[i]) >= conf->ac_iot_limit[i]) {
             continue;
         }
 
-        if (list_empty(&conf->clients[i])) {
-            continue;
-        }
-
-        /* Get the first per-client queue for this priority. */
-        ctx = list_first_entry(&conf->clients[i], iot_client_ctx_t, clients);
-        if (!ctx) {
-            continue;
-        }
+        for (j = 0; j < conf->queue_count; j++) {
+            queue = &conf->queues[(own->index + j) % conf->queue_count];
+            if (!GF_ATOMIC_GET(queue->sizes[i])) {
+                continue;
+            }
 
-        if (list_empty(&ctx->reqs)) {
-            continue;
-        }
+            pthread_mutex_lock(&queue->mutex);
+            {
+                if (!list_empty(&queue->clients[i])) {
+                    if (GF_ATOMIC_INC(conf->ac_iot_count[i]) >
+                        conf->ac_iot_limit[i]) {
+                        GF_ATOMIC_DEC(conf->ac_iot_count[i]);
+                        pthread_mutex_unlock(&queue->mutex);
+                        break;
+                    }
+                    stub = __iot_queue_dequeue(queue, i);
+                }
+            }
+            pthread_mutex_unlock(&queue->mutex);
 
-        /* Get the first request on that queue. */
-        stub = list_first_entry(&ctx->reqs, call_stub_t, list);
-        list_del_init(&stub->list);
-        if (list_empty(&ctx->reqs)) {
-            list_del_init(&ctx->clients);
-        } else {
-            list_rotate_left(&conf->clients[i]);
+            if (stub) {
+                if (queue != own) {
+                    GF_ATOMIC_INC(own->steals);
+                }
+                GF_ATOMIC_INC(own->served);
+                GF_ATOMIC_DEC(conf->queue_size);
+                conf->queue_marked[i] = _gf_false;
+                *pri = i;
+                return stub;
+            }
         }
-
-        conf->ac_iot_count[i]++;
-        conf->queue_marked[i] = _gf_false;
-        *pri = i;
-        break;
     }
 
-    if (!stub)
-        return NULL;
-
-    conf->queue_size--;
-    conf->queue_sizes[*pri]--;
-
-    return stub;
+    return NULL;
 }
 
-void
+static iot_queue_t *
 __iot_enqueue(iot_conf_t *conf, call_stub_t *stub, int pri)
 {
     client_t *client = stub->frame->root->client;
     iot_client_ctx_t *ctx;
+    iot_queue_t *queue;
 
     if (pri < 0 || pri >= GF_FOP_PRI_MAX)
         pri = GF_FOP_PRI_MAX - 1;
@@ -146,97 +181,193 @@ __iot_enqueue(iot_conf_t *conf, call_stub_t *stub, int pri)
     } else {
         ctx = NULL;
     }
-    if (!ctx) {
-        ctx = &conf->no_client[pri];
+
+    if (ctx) {
+        queue = &conf->queues[ctx->queue];
+    } else {
+        queue = &conf->queues[GF_ATOMIC_INC(conf->next_queue) %
+                              conf->queue_count];
     }
 
-    if (list_empty(&ctx->reqs)) {
-        list_add_tail(&ctx->clients, &conf->clients[pri]);
+    pthread_mutex_lock(&queue->mutex);
+    {
+        if (!ctx) {
+            ctx = &queue->no_client[pri];
+        }
+
+        if (list_empty(&ctx->reqs)) {
+            list_add_tail(&ctx->clients, &queue->clients[pri]);
+        }
+        list_add_tail(&stub->list, &ctx->reqs);
+
+        GF_ATOMIC_INC(queue->sizes[pri]);
     }
-    list_add_tail(&stub->list, &ctx->reqs);
+    pthread_mutex_unlock(&queue->mutex);
 
-    conf->queue_size++;
+    GF_ATOMIC_INC(conf->queue_size);
     GF_ATOMIC_INC(conf->stub_cnt);
-    conf->queue_sizes[pri]++;
+
+    return queue;
+}
+
+/*
+ * Wake up one idle worker, of the queue of the request if it has one. The
+ * workers announce themselves idle before looking at the queues one last
+ * time, hence either they see the request or it sees them.
+ */
+static void
+iot_wake(iot_conf_t *conf, iot_queue_t *queue)
+{
+    iot_queue_t *target = NULL;
+    gf_boolean_t woken = _gf_false;
+    int j = 0;
+
+    if (!GF_ATOMIC_GET(conf->sleep_count))
+        return;
+
+    for (j = 0; j < conf->queue_count && !woken; j++) {
+        target = &conf->queues[(queue->index + j) % conf->queue_count];
+        if (!GF_ATOMIC_GET(target->idle))
+            continue;
+
+        pthread_mutex_lock(&target->mutex);
+        {
+            if (target->kicks < GF_ATOMIC_GET(target->idle)) {
+                target->kicks++;
+                pthread_cond_signal(&target->cond);
+                woken = _gf_true;
+            }
+        }
+        pthread_mutex_unlock(&target->mutex);
+    }
+}
+
+/* Fops of the least priority are those of the internal clients, heals and
+ * rebalance, they are left out of the load of the clients. */
+static void
+iot_client_latency_sample(iot_conf_t *conf, struct timespec *begin)
+{
+    struct timespec end;
+    int64_t latency = 0;
+    int64_t avg = 0;
+    time_t now = 0;
+
+    timespec_now(&end);
+    latency = gf_tsdiff(begin, &end) / 1000;
+
+    avg = GF_ATOMIC_GET(conf->client_latency);
+    GF_ATOMIC_SWAP(conf->client_latency, avg + (latency - avg) / 8);
+
+    now = gf_time();
+    if (conf->client_stamp != now)
+        conf->client_stamp = now;
+}
+
+static gf_boolean_t
+iot_worker_exit(iot_conf_t *conf, iot_queue_t *queue)
+{
+    gf_boolean_t bye = _gf_false;
+
+    pthread_mutex_lock(&conf->mutex);
+    {
+        if (conf->down || conf->curr_count > IOT_MIN_THREADS) {
+            conf->curr_count--;
+            queue->workers--;
+            if (conf->curr_count == 0)
+                pthread_cond_broadcast(&conf->cond);
+            gf_msg_debug(conf->this->name, 0,
+                         "terminated. "
+                         "conf->curr_count=%d",
+                         conf->curr_count);
+            bye = _gf_true;
+        }
+    }
+    pthread_mutex_unlock(&conf->mutex);
+
+    return bye;
 }
 
 void *
 iot_worker(void *data)
 {
     iot_conf_t *conf = NULL;
+    iot_queue_t *queue = NULL;
     xlator_t *this = NULL;
     call_stub_t *stub = NULL;
     struct timespec sleep_till = {
         0,
     };
+    struct timespec begin;
     int ret = 0;
     int pri = -1;
-    gf_boolean_t bye = _gf_false;
 
-    conf = data;
+    queue = data;
+    conf = queue->conf;
     this = conf->this;
     THIS = this;
 
     for (;;) {
-        pthread_mutex_lock(&conf->mutex);
-        {
-            if (pri != -1) {
-                conf->ac_iot_count[pri]--;
-                pri = -1;
-            }
-            while (conf->queue_size == 0) {
-                if (conf->down) {
-                    bye = _gf_true; /*Avoid sleep*/
-                    break;
-                }
+        if (pri != -1) {
+            GF_ATOMIC_DEC(conf->ac_iot_count[pri]);
+            pri = -1;
+        }
 
-                clock_gettime(CLOCK_REALTIME_COARSE, &sleep_till);
-                sleep_till.tv_sec += conf->idle_time;
+        stub = iot_dequeue(conf, queue, &pri);
+        if (!stub) {
+            GF_ATOMIC_INC(queue->idle);
+            GF_ATOMIC_INC(conf->sleep_count);
 
-                conf->sleep_count++;
-                ret = pthread_cond_timedwait(&conf->cond, &conf->mutex,
-                                             &sleep_till);
-                conf->sleep_count--;
+            ret = 0;
+            stub = iot_dequeue(conf, queue, &pri);
+            if (!stub) {
+                pthread_mutex_lock(&queue->mutex);
+                {
+                    while (!queue->kicks && !conf->down) {
+                        clock_gettime(CLOCK_REALTIME_COARSE, &sleep_till);
+                        sleep_till.tv_sec += conf->idle_time;
 
-                if (conf->down || ret == ETIMEDOUT) {
-                    bye = _gf_true;
-                    break;
+                        ret = pthread_cond_timedwait(&queue->cond,
+                                                     &queue->mutex,
+                                                     &sleep_till);
+                        if (ret == ETIMEDOUT)
+                            break;
+                    }
+                    if (queue->kicks) {
+                        queue->kicks--;
+                        ret = 0;
+                    }
                 }
+                pthread_mutex_unlock(&queue->mutex);
             }
 
-            if (bye) {
-                if (conf->down || conf->curr_count > IOT_MIN_THREADS) {
-                    conf->curr_count--;
-                    if (conf->curr_count == 0)
-                        pthread_cond_broadcast(&conf->cond);
-                    gf_msg_debug(conf->this->name, 0,
-                                 "terminated. "
-                                 "conf->curr_count=%d",
-                                 conf->curr_count);
-                } else {
-                    bye = _gf_false;
+            GF_ATOMIC_DEC(conf->sleep_count);
+            GF_ATOMIC_DEC(queue->idle);
+
+            if (!stub) {
+                /* a request too many for its priority is left to the
+                 * workers running that priority, as before */
+                if ((conf->down && !GF_ATOMIC_GET(conf->queue_size)) ||
+                    (ret == ETIMEDOUT)) {
+                    if (iot_worker_exit(conf, queue))
+                        break;
                 }
+                continue;
             }
-
-            if (!bye)
-                stub = __iot_dequeue(conf, &pri);
         }
-        pthread_mutex_unlock(&conf->mutex);
 
-        if (stub) { /* guard against spurious wakeups */
-            if (stub->poison) {
-                gf_log(this->name, GF_LOG_INFO, "Dropping poisoned request %p.",
-                       stub);
-                call_stub_destroy(stub);
-            } else {
-                call_resume(stub);
-            }
-            GF_ATOMIC_DEC(conf->stub_cnt);
+        if (stub->poison) {
+            gf_log(this->name, GF_LOG_INFO, "Dropping poisoned request %p.",
+                   stub);
+            call_stub_destroy(stub);
+        } else if (pri < GF_FOP_PRI_LEAST) {
+            timespec_now(&begin);
+            call_resume(stub);
+            iot_client_latency_sample(conf, &begin);
+        } else {
+            call_resume(stub);
         }
+        GF_ATOMIC_DEC(conf->stub_cnt);
         stub = NULL;
-
-        if (bye)
-            break;
     }
 
     return NULL;
@@ -245,17 +376,17 @@ iot_worker(void *data)
 int
 do_iot_schedule(iot_conf_t *conf, call_stub_t *stub, int pri)
 {
+    iot_queue_t *queue = NULL;
     int ret = 0;
 
-    pthread_mutex_lock(&conf->mutex);
-    {
-        __iot_enqueue(conf, stub, pri);
+    queue = __iot_enqueue(conf, stub, pri);
 
-        pthread_cond_signal(&conf->cond);
+    iot_wake(conf, queue);
 
-        ret = __iot_workers_scale(conf);
-    }
-    pthread_mutex_unlock(&conf->mutex);
+    /* every worker is busy, more may be needed */
+    if (!GF_ATOMIC_GET(conf->sleep_count) &&
+        (conf->curr_count < conf->max_count))
+        ret = iot_workers_scale(conf);
 
     return ret;
 }
@@ -602,6 +733,31 @@ iot_setxattr(call_frame_t *frame, xlator_t *this, loc_t *loc, dict_t *dict,
     return 0;
 }
 
+/*
+ * What a fop of a client costs on the brick, the running time of the last
+ * ones stretched by the requests waiting for a worker, for the self-heal
+ * daemons to slow down when the clients suffer.
+ */
+static uint64_t
+iot_client_load(iot_conf_t *conf)
+{
+    int64_t latency = 0;
+    int queued = 0;
+    int workers = 0;
+    int i = 0;
+
+    for (i = 0; i < GF_FOP_PRI_LEAST; i++)
+        queued += iot_queued(conf, i);
+
+    if (!queued && (gf_time() - conf->client_stamp > IOT_CLIENT_IDLE_SECS))
+        return 0;
+
+    latency = GF_ATOMIC_GET(conf->client_latency);
+    workers = max(conf->curr_count, 1);
+
+    return latency + latency * queued / workers;
+}
+
 int
 iot_getxattr(call_frame_t *frame, xlator_t *this, loc_t *loc, const char *name,
              dict_t *xdata)
@@ -614,6 +770,24 @@ iot_getxattr(call_frame_t *frame, xlator_t *this, loc_t *loc, const char *name,
 
     conf = this->private;
 
+    if (name && strcmp(name, IO_THREADS_LOAD_KEY) == 0) {
+        depths = dict_new();
+        if (depths && dict_set_uint64(depths, IO_THREADS_LOAD_KEY,
+                                      iot_client_load(conf)) != 0) {
+            dict_unref(depths);
+            depths = NULL;
+        }
+        if (!depths) {
+            op_ret = -1;
+            op_errno = ENOMEM;
+        }
+
+        STACK_UNWIND_STRICT(getxattr, frame, op_ret, op_errno, depths, xdata);
+        if (depths)
+            dict_unref(depths);
+        return 0;
+    }
+
     if (name && strcmp(name, IO_THREADS_QUEUE_SIZE_KEY) == 0) {
         /*
          * We explicitly do not want a reference count
@@ -628,7 +802,7 @@ iot_getxattr(call_frame_t *frame, xlator_t *this, loc_t *loc, const char *name,
 
         for (i = 0; i < GF_FOP_PRI_MAX; i++) {
             if (dict_set_int32(depths, (char *)fop_pri_to_string(i),
-                               conf->queue_sizes[i]) != 0) {
+                               iot_queued(conf, i)) != 0) {
                 dict_unref(depths);
                 depths = NULL;
                 goto unwind_special_getxattr;
@@ -807,9 +981,37 @@ iot_setactivelk(call_frame_t *frame, xlator_t *this, loc_t *loc,
     return 0;
 }
 
+static int
+iot_queued(iot_conf_t *conf, int pri)
+{
+    int queued = 0;
+    int i = 0;
+
+    for (i = 0; i < conf->queue_count; i++)
+        queued += GF_ATOMIC_GET(conf->queues[i].sizes[pri]);
+
+    return queued;
+}
+
+/* The queue with the fewest workers gets the new one */
+static iot_queue_t *
+__iot_worker_queue(iot_conf_t *conf)
+{
+    iot_queue_t *queue = &conf->queues[0];
+    int i = 0;
+
+    for (i = 1; i < conf->queue_count; i++) {
+        if (conf->queues[i].workers < queue->workers)
+            queue = &conf->queues[i];
+    }
+
+    return queue;
+}
+
 int
 __iot_workers_scale(iot_conf_t *conf)
 {
+    iot_queue_t *queue = NULL;
     int scale = 0;
     int diff = 0;
     pthread_t thread;
@@ -817,7 +1019,7 @@ __iot_workers_scale(iot_conf_t *conf)
     int i = 0;
 
     for (i = 0; i < GF_FOP_PRI_MAX; i++)
-        scale += min(conf->queue_sizes[i], conf->ac_iot_limit[i]);
+        scale += min(iot_queued(conf, i), conf->ac_iot_limit[i]);
 
     if (scale < IOT_MIN_THREADS)
         scale = IOT_MIN_THREADS;
@@ -832,14 +1034,17 @@ __iot_workers_scale(iot_conf_t *conf)
     while (diff) {
         diff--;
 
-        ret = gf_thread_create(&thread, &conf->w_attr, iot_worker, conf,
+        queue = __iot_worker_queue(conf);
+        ret = gf_thread_create(&thread, &conf->w_attr, iot_worker, queue,
                                "iotwr%03hx", conf->curr_count & 0x3ff);
         if (ret == 0) {
             pthread_detach(thread);
             conf->curr_count++;
+            queue->workers++;
             gf_msg_debug(conf->this->name, 0,
-                         "scaled threads to %d (queue_size=%d/%d)",
-                         conf->curr_count, conf->queue_size, scale);
+                         "scaled threads to %d (queue_size=%" PRId64 "/%d)",
+                         conf->curr_count, GF_ATOMIC_GET(conf->queue_size),
+                         scale);
         } else {
             break;
         }
@@ -926,7 +1131,10 @@ iot_priv_dump(xlator_t *this)
     iot_conf_t *conf = NULL;
     char key_prefix[GF_DUMP_MAX_BUF_LEN];
     char key[GF_DUMP_MAX_BUF_LEN];
+    iot_queue_t *queue = NULL;
+    int queued = 0;
     int i = 0;
+    int j = 0;
 
     if (!this)
         return 0;
@@ -941,7 +1149,8 @@ iot_priv_dump(xlator_t *this)
 
     gf_proc_dump_write("maximum_threads_count", "%d", conf->max_count);
     gf_proc_dump_write("current_threads_count", "%d", conf->curr_count);
-    gf_proc_dump_write("sleep_count", "%d", conf->sleep_count);
+    gf_proc_dump_write("sleep_count", "%" PRId64,
+                       GF_ATOMIC_GET(conf->sleep_count));
     gf_proc_dump_write("idle_time", "%ld", conf->idle_time);
     gf_proc_dump_write("stack_size", "%zd", conf->stack_size);
     gf_proc_dump_write("max_high_priority_threads", "%d",
@@ -952,20 +1161,40 @@ iot_priv_dump(xlator_t *this)
                        conf->ac_iot_limit[GF_FOP_PRI_LO]);
     gf_proc_dump_write("max_least_priority_threads", "%d",
                        conf->ac_iot_limit[GF_FOP_PRI_LEAST]);
-    gf_proc_dump_write("current_high_priority_threads", "%d",
-                       conf->ac_iot_count[GF_FOP_PRI_HI]);
-    gf_proc_dump_write("current_normal_priority_threads", "%d",
-                       conf->ac_iot_count[GF_FOP_PRI_NORMAL]);
-    gf_proc_dump_write("current_low_priority_threads", "%d",
-                       conf->ac_iot_count[GF_FOP_PRI_LO]);
-    gf_proc_dump_write("current_least_priority_threads", "%d",
-                       conf->ac_iot_count[GF_FOP_PRI_LEAST]);
+    gf_proc_dump_write("current_high_priority_threads", "%" PRId64,
+                       GF_ATOMIC_GET(conf->ac_iot_count[GF_FOP_PRI_HI]));
+    gf_proc_dump_write("current_normal_priority_threads", "%" PRId64,
+                       GF_ATOMIC_GET(conf->ac_iot_count[GF_FOP_PRI_NORMAL]));
+    gf_proc_dump_write("current_low_priority_threads", "%" PRId64,
+                       GF_ATOMIC_GET(conf->ac_iot_count[GF_FOP_PRI_LO]));
+    gf_proc_dump_write("current_least_priority_threads", "%" PRId64,
+                       GF_ATOMIC_GET(conf->ac_iot_count[GF_FOP_PRI_LEAST]));
     for (i = 0; i < GF_FOP_PRI_MAX; i++) {
-        if (!conf->queue_sizes[i])
+        queued = iot_queued(conf, i);
+        if (!queued)
             continue;
         snprintf(key, sizeof(key), "%s_priority_queue_length",
                  iot_get_pri_meaning(i));
-        gf_proc_dump_write(key, "%d", conf->queue_sizes[i]);
+        gf_proc_dump_write(key, "%d", queued);
+    }
+
+    gf_proc_dump_write("client_latency_usec", "%" PRId64,
+                       GF_ATOMIC_GET(conf->client_latency));
+    gf_proc_dump_write("client_load_usec", "%" PRIu64, iot_client_load(conf));
+
+    gf_proc_dump_write("worker_queues", "%d", conf->queue_count);
+    for (i = 0; i < conf->queue_count; i++) {
+        queue = &conf->queues[i];
+        queued = 0;
+        for (j = 0; j < GF_FOP_PRI_MAX; j++)
+            queued += GF_ATOMIC_GET(queue->sizes[j]);
+        snprintf(key, sizeof(key), "worker_queue[%d]", i);
+        gf_proc_dump_write(key,
+                           "workers=%d, idle=%" PRId64 ", depth=%d, "
+                           "served=%" PRId64 ", stolen=%" PRId64,
+                           queue->workers, GF_ATOMIC_GET(queue->idle), queued,
+                           GF_ATOMIC_GET(queue->served),
+                           GF_ATOMIC_GET(queue->steals));
     }
 
     return 0;
@@ -1078,7 +1307,7 @@ iot_watchdog(void *arg)
             } else {
                 bad_times[i] = 0;
             }
-            priv->queue_marked[i] = (priv->queue_sizes[i] > 0);
+            priv->queue_marked[i] = (iot_queued(priv, i) > 0);
         }
         pthread_mutex_unlock(&priv->mutex);
         pthread_setcancelstate(PTHREAD_CANCEL_ENABLE, NULL);
@@ -1175,6 +1404,53 @@ out:
     return ret;
 }
 
+static int
+iot_queue_init(iot_conf_t *conf, iot_queue_t *queue, int index)
+{
+    int ret = 0;
+    int i = 0;
+
+    ret = pthread_mutex_init(&queue->mutex, NULL);
+    if (ret != 0)
+        return ret;
+
+    ret = pthread_cond_init(&queue->cond, NULL);
+    if (ret != 0) {
+        pthread_mutex_destroy(&queue->mutex);
+        return ret;
+    }
+
+    for (i = 0; i < GF_FOP_PRI_MAX; i++) {
+        INIT_LIST_HEAD(&queue->clients[i]);
+        INIT_LIST_HEAD(&queue->no_client[i].clients);
+        INIT_LIST_HEAD(&queue->no_client[i].reqs);
+        queue->no_client[i].queue = index;
+        GF_ATOMIC_INIT(queue->sizes[i], 0);
+    }
+    GF_ATOMIC_INIT(queue->idle, 0);
+    GF_ATOMIC_INIT(queue->served, 0);
+    GF_ATOMIC_INIT(queue->steals, 0);
+    queue->index = index;
+    queue->conf = conf;
+
+    return 0;
+}
+
+static void
+iot_queues_destroy(iot_conf_t *conf)
+{
+    int i = 0;
+
+    for (i = 0; i < conf->queues_inited; i++) {
+        pthread_cond_destroy(&conf->queues[i].cond);
+        pthread_mutex_destroy(&conf->queues[i].mutex);
+    }
+    conf->queues_inited = 0;
+
+    GF_FREE(conf->queues);
+    conf->queues = NULL;
+}
+
 int
 init(xlator_t *this)
 {
@@ -1246,11 +1522,33 @@ init(xlator_t *this)
 
     conf->this = this;
     GF_ATOMIC_INIT(conf->stub_cnt, 0);
+    GF_ATOMIC_INIT(conf->queue_size, 0);
+    GF_ATOMIC_INIT(conf->client_latency, 0);
+    GF_ATOMIC_INIT(conf->sleep_count, 0);
+    GF_ATOMIC_INIT(conf->next_queue, 0);
+    for (i = 0; i < GF_FOP_PRI_MAX; i++)
+        GF_ATOMIC_INIT(conf->ac_iot_count[i], 0);
 
-    for (i = 0; i < GF_FOP_PRI_MAX; i++) {
-        INIT_LIST_HEAD(&conf->clients[i]);
-        INIT_LIST_HEAD(&conf->no_client[i].clients);
-        INIT_LIST_HEAD(&conf->no_client[i].reqs);
+    /* One queue per worker the configuration allows at start */
+    conf->queue_count = conf->max_count;
+    conf->queues = GF_CALLOC(conf->queue_count, sizeof(*conf->queues),
+                             gf_iot_mt_iot_queue_t);
+    if (!conf->queues) {
+        gf_smsg(this->name, GF_LOG_ERROR, ENOMEM, IO_THREADS_MSG_OUT_OF_MEMORY,
+                NULL);
+        goto out;
+    }
+
+    for (i = 0; i < conf->queue_count; i++) {
+        ret = iot_queue_init(conf, &conf->queues[i], i);
+        if (ret != 0) {
+            gf_smsg(this->name, GF_LOG_ERROR, 0,
+                    IO_THREADS_MSG_PTHREAD_INIT_FAILED,
+                    "worker queue init ret=%d", ret, NULL);
+            ret = -1;
+            goto out;
+        }
+        conf->queues_inited++;
     }
 
     if (!this->pass_through) {
@@ -1273,8 +1571,10 @@ init(xlator_t *this)
 
     ret = 0;
 out:
-    if (ret)
+    if (ret && conf) {
+        iot_queues_destroy(conf);
         GF_FREE(conf);
+    }
 
     return ret;
 }
@@ -1282,11 +1582,23 @@ out:
 static void
 iot_exit_threads(iot_conf_t *conf)
 {
+    int i = 0;
+
     pthread_mutex_lock(&conf->mutex);
     {
         conf->down = _gf_true;
-        /*Let all the threads know that xl is going down*/
-        pthread_cond_broadcast(&conf->cond);
+    }
+    pthread_mutex_unlock(&conf->mutex);
+
+    /*Let all the threads know that xl is going down*/
+    for (i = 0; i < conf->queues_inited; i++) {
+        pthread_mutex_lock(&conf->queues[i].mutex);
+        pthread_cond_broadcast(&conf->queues[i].cond);
+        pthread_mutex_unlock(&conf->queues[i].mutex);
+    }
+
+    pthread_mutex_lock(&conf->mutex);
+    {
         while (conf->curr_count) /*Wait for threads to exit*/
             pthread_cond_wait(&conf->cond, &conf->mutex);
     }
@@ -1360,6 +1672,8 @@ fini(xlator_t *this)
 
     stop_iot_watchdog(this);
 
+    iot_queues_destroy(conf);
+
     GF_FREE(conf);
 
     this->private = NULL;
@@ -1382,30 +1696,35 @@ static int
 iot_disconnect_cbk(xlator_t *this, client_t *client)
 {
     int i;
+    int j;
     call_stub_t *curr;
     call_stub_t *next;
     iot_conf_t *conf = this->private;
     iot_client_ctx_t *ctx;
+    iot_queue_t *queue;
 
     if (!conf || !conf->cleanup_disconnected_reqs) {
         goto out;
     }
 
-    pthread_mutex_lock(&conf->mutex);
-    for (i = 0; i < GF_FOP_PRI_MAX; i++) {
-        ctx = &conf->no_client[i];
-        list_for_each_entry_safe(curr, next, &ctx->reqs, list)
-        {
-            if (curr->frame->root->client != client) {
-                continue;
+    for (j = 0; j < conf->queue_count; j++) {
+        queue = &conf->queues[j];
+        pthread_mutex_lock(&queue->mutex);
+        for (i = 0; i < GF_FOP_PRI_MAX; i++) {
+            ctx = &queue->no_client[i];
+            list_for_each_entry_safe(curr, next, &ctx->reqs, list)
+            {
+                if (curr->frame->root->client != client) {
+                    continue;
+                }
+                gf_log(this->name, GF_LOG_INFO,
+                       "poisoning %s fop at %p for client %s",
+                       gf_fop_list[curr->fop], curr, client->client_uid);
+                curr->poison = _gf_true;
             }
-            gf_log(this->name, GF_LOG_INFO,
-                   "poisoning %s fop at %p for client %s",
-                   gf_fop_list[curr->fop], curr, client->client_uid);
-            curr->poison = _gf_true;
         }
+        pthread_mutex_unlock(&queue->mutex);
     }
-    pthread_mutex_unlock(&conf->mutex);
 
 out:
     return 0;
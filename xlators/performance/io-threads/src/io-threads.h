@@ -36,21 +36,25 @@ struct iot_conf;
 
 #define IOT_THREAD_STACK_SIZE ((size_t)(256 * 1024))
 
+/* The clients have been idle since as long for the load told to the heals */
+#define IOT_CLIENT_IDLE_SECS 2
+
 typedef struct {
     struct list_head clients;
     struct list_head reqs;
+    int32_t queue; /* the worker queue the requests of the client go to */
 } iot_client_ctx_t;
 
-struct iot_conf {
+/*
+ * Requests are spread over several queues, each with its own lock, so that
+ * the bricks with many cores do not all contend on one mutex. A worker is
+ * bound to a queue, takes the requests from it first and steals from the
+ * others when it has nothing of the same priority. The requests of a client
+ * always go to the same queue, where the clients are served round-robin.
+ */
+typedef struct iot_queue {
     pthread_mutex_t mutex;
     pthread_cond_t cond;
-
-    int32_t max_count;  /* configured maximum */
-    int32_t curr_count; /* actual number of threads running */
-    int32_t sleep_count;
-
-    time_t idle_time; /* in seconds */
-
     struct list_head clients[GF_FOP_PRI_MAX];
     /*
      * It turns out that there are several ways a frame can get to us
@@ -59,12 +63,38 @@ struct iot_conf {
      * we use this to queue them.
      */
     iot_client_ctx_t no_client[GF_FOP_PRI_MAX];
+    gf_atomic_t sizes[GF_FOP_PRI_MAX];
+    gf_atomic_t idle;   /* workers looking for a request or asleep */
+    gf_atomic_t served; /* requests run by the workers of the queue */
+    gf_atomic_t steals; /* of which taken from the other queues */
+    int32_t kicks;      /* wakeups not yet taken by an idle worker */
+    int32_t workers;    /* bound to the queue, under conf->mutex */
+    int32_t index;
+    struct iot_conf *conf;
+} iot_queue_t;
+
+struct iot_conf {
+    pthread_mutex_t mutex; /* for the workers, not for the queues */
+    pthread_cond_t cond;
+
+    int32_t max_count;  /* configured maximum */
+    int32_t curr_count; /* actual number of threads running */
+    gf_atomic_t sleep_count;
+
+    time_t idle_time; /* in seconds */
+
+    iot_queue_t *queues;
+    int32_t queue_count;
+    int32_t queues_inited;
+    gf_atomic_t next_queue;
 
     int32_t ac_iot_limit[GF_FOP_PRI_MAX];
-    int32_t ac_iot_count[GF_FOP_PRI_MAX];
-    int queue_sizes[GF_FOP_PRI_MAX];
-    int32_t queue_size;
+    gf_atomic_t ac_iot_count[GF_FOP_PRI_MAX];
+    gf_atomic_t queue_size;
     gf_atomic_t stub_cnt;
+    gf_atomic_t client_latency; /* moving average of the fops of the
+                                   clients, in usecs */
+    time_t client_stamp;        /* when one of them last ran */
     pthread_attr_t w_attr;
     gf_boolean_t least_priority; /*Enable/Disable least-priority */
 
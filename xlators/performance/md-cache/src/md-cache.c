@@ -56,8 +56,28 @@ struct mdc_statistics {
     gf_atomic_t xattr_invals; /* No. of invalidates received from upcall */
     gf_atomic_t need_lookup;  /* No. of lookups issued, because other
                                  xlators requested for explicit lookup */
+
+    gf_atomic_t leases_granted; /* No. of metadata leases obtained */
+    gf_atomic_t lease_recalls;  /* No. of metadata leases recalled */
+    gf_atomic_t lease_failures; /* No. of lease requests that failed */
+};
+
+/* A read lease with GF_LEASE_METADATA set keeps the cached attributes and
+ * xattrs of an inode valid until the lease is recalled, instead of until
+ * md-cache-timeout expires. */
+enum mdc_lease_state {
+    MDC_LEASE_NONE = 0,
+    MDC_LEASE_REQUESTED,
+    MDC_LEASE_HELD,
 };
 
+/* No. of timeout revalidations of a regular file that make it hot enough to
+ * be worth a lease, directories get one right away */
+#define MDC_LEASE_HOT 3
+
+/* Seconds before a lease is asked for again after a recall or a failure */
+#define MDC_LEASE_RETRY 60
+
 struct mdc_conf {
     time_t timeout;
     gf_boolean_t cache_posix_acl;
@@ -78,6 +98,15 @@ struct mdc_conf {
     struct mdc_statfs_cache statfs_cache;
     char *mdc_xattr_str;
     gf_atomic_uint32_t generation;
+
+    gf_boolean_t leases;
+    uint32_t lease_limit;
+    char lease_id[LEASE_ID_SIZE];
+    gf_atomic_uint32_t lease_epoch; /* bumped when a child goes down, the
+                                       leases taken before may be gone */
+    time_t lease_retry; /* no leases until then, the bricks lack them */
+    uint32_t lease_count;
+    struct list_head lease_list; /* of md_cache holding leases, under lock */
 };
 
 struct mdc_local;
@@ -120,6 +149,14 @@ struct md_cache {
     gf_boolean_t gen_rollover;
     gf_boolean_t invalidation_rollover;
     gf_lock_t lock;
+
+    struct list_head lease_list;
+    inode_t *lease_inode; /* ref held unless lease_state is NONE */
+    int lease_state;
+    uint32_t lease_epoch;
+    uint32_t lease_seq; /* of the last lease request */
+    uint32_t revalidations;
+    time_t lease_retry;
 };
 
 struct mdc_local {
@@ -351,6 +388,7 @@ mdc_inode_prep(xlator_t *this, inode_t *inode)
         }
 
         LOCK_INIT(&mdc->lock);
+        INIT_LIST_HEAD(&mdc->lease_list);
 
         ret = __mdc_inode_ctx_set(this, inode, mdc);
         if (ret) {
@@ -404,6 +442,17 @@ out:
     return ret;
 }
 
+/* The lease is held, and was obtained after the last time a child went
+ * down */
+static gf_boolean_t
+__mdc_lease_valid(xlator_t *this, struct md_cache *mdc)
+{
+    struct mdc_conf *conf = this->private;
+
+    return (mdc->lease_state == MDC_LEASE_HELD) &&
+           (mdc->lease_epoch == GF_ATOMIC_GET(conf->lease_epoch));
+}
+
 static gf_boolean_t
 is_md_cache_iatt_valid(xlator_t *this, struct md_cache *mdc)
 {
@@ -413,9 +462,13 @@ is_md_cache_iatt_valid(xlator_t *this, struct md_cache *mdc)
     {
         if (mdc->valid == _gf_false) {
             ret = mdc->valid;
+        } else if (mdc->ia_time && __mdc_lease_valid(this, mdc)) {
+            ret = _gf_true;
         } else {
             ret = __is_cache_valid(this, mdc->ia_time);
             if (ret == _gf_false) {
+                if (mdc->ia_time)
+                    mdc->revalidations++;
                 mdc->ia_time = 0;
                 mdc->generation = 0;
             }
@@ -433,10 +486,14 @@ is_md_cache_xatt_valid(xlator_t *this, struct md_cache *mdc)
 
     LOCK(&mdc->lock);
     {
+        if (mdc->xa_time && __mdc_lease_valid(this, mdc))
+            goto unlock;
+
         ret = __is_cache_valid(this, mdc->xa_time);
         if (ret == _gf_false)
             mdc->xa_time = 0;
     }
+unlock:
     UNLOCK(&mdc->lock);
 
     return ret;
@@ -961,6 +1018,347 @@ out:
     return ret;
 }
 
+/* Forgets the lease of @mdc, called with mdc->lock held. Returns the inode
+ * whose lease has to be unlocked on the bricks, with the ref taken when the
+ * lease was asked for. */
+static inode_t *
+__mdc_lease_drop(xlator_t *this, struct md_cache *mdc)
+{
+    struct mdc_conf *conf = this->private;
+    inode_t *inode = NULL;
+
+    if (mdc->lease_state == MDC_LEASE_NONE)
+        goto out;
+
+    LOCK(&conf->lock);
+    {
+        list_del_init(&mdc->lease_list);
+        conf->lease_count--;
+    }
+    UNLOCK(&conf->lock);
+
+    inode = mdc->lease_inode;
+    mdc->lease_inode = NULL;
+    mdc->lease_state = MDC_LEASE_NONE;
+out:
+    return inode;
+}
+
+static int32_t
+mdc_lease_unlock_cbk(call_frame_t *frame, void *cookie, xlator_t *this,
+                     int32_t op_ret, int32_t op_errno, struct gf_lease *lease,
+                     dict_t *xdata)
+{
+    mdc_local_t *local = frame->local;
+
+    if (op_ret < 0)
+        gf_msg_debug(this->name, op_errno,
+                     "unlocking the metadata lease of %s failed",
+                     uuid_utoa(local->loc.gfid));
+
+    frame->local = NULL;
+    mdc_local_wipe(this, local);
+    STACK_DESTROY(frame->root);
+
+    return 0;
+}
+
+/* Takes over the ref on @inode returned by __mdc_lease_drop() */
+static void
+mdc_lease_unlock(xlator_t *this, inode_t *inode)
+{
+    struct mdc_conf *conf = this->private;
+    call_frame_t *frame = NULL;
+    mdc_local_t *local = NULL;
+    struct gf_lease lease = {
+        0,
+    };
+
+    frame = create_frame(this, this->ctx->pool);
+    if (!frame)
+        goto err;
+
+    local = GF_CALLOC(1, sizeof(*local), gf_mdc_mt_mdc_local_t);
+    if (!local)
+        goto err;
+
+    local->loc.inode = inode;
+    gf_uuid_copy(local->loc.gfid, inode->gfid);
+    frame->local = local;
+
+    lease.cmd = GF_UNLK_LEASE;
+    lease.lease_type = GF_RD_LEASE;
+    lease.lease_flags = GF_LEASE_METADATA;
+    memcpy(lease.lease_id, conf->lease_id, LEASE_ID_SIZE);
+
+    STACK_WIND(frame, mdc_lease_unlock_cbk, FIRST_CHILD(this),
+               FIRST_CHILD(this)->fops->lease, &local->loc, &lease, NULL);
+    return;
+
+err:
+    gf_msg(this->name, GF_LOG_WARNING, ENOMEM, MD_CACHE_MSG_NO_MEMORY,
+           "unable to unlock the metadata lease of %s",
+           uuid_utoa(inode->gfid));
+    if (frame)
+        STACK_DESTROY(frame->root);
+    inode_unref(inode);
+}
+
+static void
+mdc_lease_release(xlator_t *this, inode_t *inode)
+{
+    struct md_cache *mdc = NULL;
+    inode_t *lease_inode = NULL;
+
+    if (mdc_inode_ctx_get(this, inode, &mdc) != 0 || !mdc)
+        return;
+
+    LOCK(&mdc->lock);
+    {
+        lease_inode = __mdc_lease_drop(this, mdc);
+    }
+    UNLOCK(&mdc->lock);
+
+    if (lease_inode)
+        mdc_lease_unlock(this, lease_inode);
+}
+
+static int32_t
+mdc_lease_cbk(call_frame_t *frame, void *cookie, xlator_t *this,
+              int32_t op_ret, int32_t op_errno, struct gf_lease *lease,
+              dict_t *xdata)
+{
+    struct mdc_conf *conf = this->private;
+    mdc_local_t *local = frame->local;
+    struct md_cache *mdc = NULL;
+    inode_t *lease_inode = NULL;
+    uint32_t seq = (uint32_t)(uintptr_t)cookie;
+    uint64_t gen = 0;
+
+    mdc_inode_ctx_get(this, local->loc.inode, &mdc);
+    if (!mdc)
+        goto out;
+
+    LOCK(&mdc->lock);
+    {
+        /* recalled or released since it was asked for */
+        if ((mdc->lease_state != MDC_LEASE_REQUESTED) ||
+            (mdc->lease_seq != seq))
+            goto unlock;
+
+        if (op_ret < 0) {
+            if (op_errno == ENOSYS)
+                conf->lease_retry = gf_time() + MDC_LEASE_RETRY;
+            else
+                mdc->lease_retry = gf_time() + MDC_LEASE_RETRY;
+
+            lease_inode = __mdc_lease_drop(this, mdc);
+            goto unlock;
+        }
+
+        /* What is cached now, and what the replies in flight carry, may
+         * have been changed by another client before the lease was
+         * granted. Only what is fetched from now on is trusted. */
+        gen = __mdc_inc_generation(this, mdc);
+        mdc->generation = (gen & 0xffffffff);
+        mdc->ia_time = 0;
+        mdc->xa_time = 0;
+        mdc->lease_state = MDC_LEASE_HELD;
+    }
+unlock:
+    UNLOCK(&mdc->lock);
+
+    if (op_ret < 0) {
+        GF_ATOMIC_INC(conf->mdc_counter.lease_failures);
+        gf_msg_debug(this->name, op_errno,
+                     "metadata lease on %s not granted, falling back to "
+                     "md-cache-timeout",
+                     uuid_utoa(local->loc.gfid));
+    } else {
+        GF_ATOMIC_INC(conf->mdc_counter.leases_granted);
+    }
+
+    /* a directory lease may have been granted by some of the subvolumes,
+     * the bricks not knowing of leases are not asked again */
+    if (lease_inode) {
+        if (op_errno != ENOSYS)
+            mdc_lease_unlock(this, lease_inode);
+        else
+            inode_unref(lease_inode);
+    }
+out:
+    frame->local = NULL;
+    mdc_local_wipe(this, local);
+    STACK_DESTROY(frame->root);
+
+    return 0;
+}
+
+/* Asks for a metadata lease on a directory, or on a regular file whose
+ * attributes keep being revalidated */
+static void
+mdc_lease_acquire(xlator_t *this, inode_t *inode)
+{
+    struct mdc_conf *conf = this->private;
+    struct md_cache *mdc = NULL;
+    call_frame_t *frame = NULL;
+    mdc_local_t *local = NULL;
+    gf_boolean_t request = _gf_false;
+    uint32_t seq = 0;
+    time_t now = 0;
+    struct gf_lease lease = {
+        0,
+    };
+
+    if (!conf->leases || !inode || !inode_is_linked(inode))
+        return;
+
+    if (!IA_ISDIR(inode->ia_type) && !IA_ISREG(inode->ia_type))
+        return;
+
+    now = gf_time();
+    if (now < conf->lease_retry)
+        return;
+
+    if (mdc_inode_ctx_get(this, inode, &mdc) != 0 || !mdc)
+        return;
+
+    LOCK(&mdc->lock);
+    {
+        if ((mdc->lease_state == MDC_LEASE_REQUESTED) ||
+            __mdc_lease_valid(this, mdc) || (now < mdc->lease_retry))
+            goto unlock;
+
+        if (IA_ISREG(inode->ia_type) && (mdc->revalidations < MDC_LEASE_HOT))
+            goto unlock;
+
+        /* a lease held from before a child went down is asked for again,
+         * setting it again is a no-op for the bricks still holding it */
+        if (mdc->lease_state == MDC_LEASE_NONE) {
+            LOCK(&conf->lock);
+            {
+                if (conf->lease_count < conf->lease_limit) {
+                    mdc->lease_inode = inode_ref(inode);
+                    list_add_tail(&mdc->lease_list, &conf->lease_list);
+                    conf->lease_count++;
+                    request = _gf_true;
+                }
+            }
+            UNLOCK(&conf->lock);
+
+            if (!request)
+                goto unlock;
+        }
+
+        request = _gf_true;
+        mdc->lease_state = MDC_LEASE_REQUESTED;
+        mdc->lease_epoch = GF_ATOMIC_GET(conf->lease_epoch);
+        seq = ++mdc->lease_seq;
+    }
+unlock:
+    UNLOCK(&mdc->lock);
+
+    if (!request)
+        return;
+
+    frame = create_frame(this, this->ctx->pool);
+    if (!frame)
+        goto err;
+
+    local = GF_CALLOC(1, sizeof(*local), gf_mdc_mt_mdc_local_t);
+    if (!local)
+        goto err;
+
+    local->loc.inode = inode_ref(inode);
+    gf_uuid_copy(local->loc.gfid, inode->gfid);
+    frame->local = local;
+
+    lease.cmd = GF_SET_LEASE;
+    lease.lease_type = GF_RD_LEASE;
+    lease.lease_flags = GF_LEASE_METADATA;
+    memcpy(lease.lease_id, conf->lease_id, LEASE_ID_SIZE);
+
+    STACK_WIND_COOKIE(frame, mdc_lease_cbk, (void *)(uintptr_t)seq,
+                      FIRST_CHILD(this), FIRST_CHILD(this)->fops->lease,
+                      &local->loc, &lease, NULL);
+    return;
+
+err:
+    if (frame)
+        STACK_DESTROY(frame->root);
+    mdc_lease_release(this, inode);
+}
+
+/* A lease is recalled when another client is about to change the inode */
+static void
+mdc_lease_recall(xlator_t *this, struct gf_upcall *up_data)
+{
+    struct mdc_conf *conf = this->private;
+    struct md_cache *mdc = NULL;
+    inode_table_t *itable = NULL;
+    inode_t *inode = NULL;
+    inode_t *lease_inode = NULL;
+
+    if (up_data->event_type != GF_UPCALL_RECALL_LEASE)
+        return;
+
+    itable = ((xlator_t *)this->graph->top)->itable;
+    inode = inode_find(itable, up_data->gfid);
+    if (!inode)
+        return;
+
+    if (mdc_inode_ctx_get(this, inode, &mdc) != 0 || !mdc)
+        goto out;
+
+    LOCK(&mdc->lock);
+    {
+        lease_inode = __mdc_lease_drop(this, mdc);
+        if (lease_inode)
+            mdc->lease_retry = gf_time() + MDC_LEASE_RETRY;
+    }
+    UNLOCK(&mdc->lock);
+
+    /* the recall may as well be for a lease of the application */
+    if (!lease_inode)
+        goto out;
+
+    GF_ATOMIC_INC(conf->mdc_counter.lease_recalls);
+    mdc_inode_iatt_invalidate(this, inode);
+    mdc_inode_xatt_invalidate(this, inode);
+
+    mdc_lease_unlock(this, lease_inode);
+out:
+    inode_unref(inode);
+}
+
+static void
+mdc_lease_release_all(xlator_t *this)
+{
+    struct mdc_conf *conf = this->private;
+    struct md_cache *mdc = NULL;
+    inode_t *inode = NULL;
+
+    for (;;) {
+        inode = NULL;
+
+        LOCK(&conf->lock);
+        {
+            if (!list_empty(&conf->lease_list)) {
+                mdc = list_first_entry(&conf->lease_list, struct md_cache,
+                                       lease_list);
+                inode = inode_ref(mdc->lease_inode);
+            }
+        }
+        UNLOCK(&conf->lock);
+
+        if (!inode)
+            break;
+
+        mdc_lease_release(this, inode);
+        inode_unref(inode);
+    }
+}
+
 static int
 mdc_update_gfid_stat(xlator_t *this, struct iatt *iatt)
 {
@@ -1242,6 +1640,7 @@ mdc_lookup_cbk(call_frame_t *frame, void *cookie, xlator_t *this,
         if (local->update_cache) {
             mdc_inode_xatt_set(this, local->loc.inode, dict);
         }
+        mdc_lease_acquire(this, local->loc.inode);
     }
 out:
     MDC_STACK_UNWIND(lookup, frame, op_ret, op_errno, inode, stbuf, dict,
@@ -1347,6 +1746,7 @@ mdc_stat_cbk(call_frame_t *frame, void *cookie, xlator_t *this, int32_t op_ret,
     if (local->update_cache) {
         mdc_inode_xatt_set(this, local->loc.inode, xdata);
     }
+    mdc_lease_acquire(this, local->loc.inode);
 
 out:
     MDC_STACK_UNWIND(stat, frame, op_ret, op_errno, buf, xdata);
@@ -1418,6 +1818,7 @@ mdc_fstat_cbk(call_frame_t *frame, void *cookie, xlator_t *this, int32_t op_ret,
     if (local->update_cache) {
         mdc_inode_xatt_set(this, local->fd->inode, xdata);
     }
+    mdc_lease_acquire(this, local->fd->inode);
 
 out:
     MDC_STACK_UNWIND(fstat, frame, op_ret, op_errno, buf, xdata);
@@ -1688,6 +2089,7 @@ mdc_unlink_cbk(call_frame_t *frame, void *cookie, xlator_t *this,
 
     if (local->loc.inode) {
         mdc_inode_iatt_set(this, local->loc.inode, NULL, local->incident_time);
+        mdc_lease_release(this, local->loc.inode);
     }
 
 out:
@@ -1745,6 +2147,9 @@ mdc_rmdir_cbk(call_frame_t *frame, void *cookie, xlator_t *this, int32_t op_ret,
                            local->incident_time);
     }
 
+    if (local->loc.inode)
+        mdc_lease_release(this, local->loc.inode);
+
 out:
     MDC_STACK_UNWIND(rmdir, frame, op_ret, op_errno, preparent, postparent,
                      xdata);
@@ -1867,6 +2272,10 @@ mdc_rename_cbk(call_frame_t *frame, void *cookie, xlator_t *this,
         mdc_inode_iatt_set(this, local->loc2.parent, postnewparent,
                            local->incident_time);
     }
+
+    /* the file replaced by the rename */
+    if (local->loc2.inode && (local->loc2.inode != local->loc.inode))
+        mdc_lease_release(this, local->loc2.inode);
 out:
     MDC_STACK_UNWIND(rename, frame, op_ret, op_errno, buf, preoldparent,
                      postoldparent, prenewparent, postnewparent, xdata);
@@ -3261,6 +3670,14 @@ mdc_priv_dump(xlator_t *this)
                        GF_ATOMIC_GET(conf->mdc_counter.stat_invals));
     gf_proc_dump_write("xattr_invalidations_received", "%" PRId64,
                        GF_ATOMIC_GET(conf->mdc_counter.xattr_invals));
+    gf_proc_dump_write("leases", "%d", conf->leases);
+    gf_proc_dump_write("leases_held", "%u", conf->lease_count);
+    gf_proc_dump_write("leases_granted", "%" PRId64,
+                       GF_ATOMIC_GET(conf->mdc_counter.leases_granted));
+    gf_proc_dump_write("lease_recalls_received", "%" PRId64,
+                       GF_ATOMIC_GET(conf->mdc_counter.lease_recalls));
+    gf_proc_dump_write("lease_failures", "%" PRId64,
+                       GF_ATOMIC_GET(conf->mdc_counter.lease_failures));
 
     return 0;
 }
@@ -3290,6 +3707,12 @@ mdc_dump_metrics(xlator_t *this, int fd)
             this->name, GF_ATOMIC_GET(conf->mdc_counter.stat_invals));
     dprintf(fd, "%s.xattr_cache_invalidations_received %" PRId64 "\n",
             this->name, GF_ATOMIC_GET(conf->mdc_counter.xattr_invals));
+    dprintf(fd, "%s.leases_granted %" PRId64 "\n", this->name,
+            GF_ATOMIC_GET(conf->mdc_counter.leases_granted));
+    dprintf(fd, "%s.lease_recalls_received %" PRId64 "\n", this->name,
+            GF_ATOMIC_GET(conf->mdc_counter.lease_recalls));
+    dprintf(fd, "%s.lease_failures %" PRId64 "\n", this->name,
+            GF_ATOMIC_GET(conf->mdc_counter.lease_failures));
 out:
     return 0;
 }
@@ -3648,6 +4071,13 @@ mdc_reconfigure(xlator_t *this, dict_t *options)
 
     GF_OPTION_RECONF("md-cache-statfs", conf->cache_statfs, options, bool, out);
 
+    GF_OPTION_RECONF("md-cache-lease-limit", conf->lease_limit, options,
+                     uint32, out);
+
+    GF_OPTION_RECONF("md-cache-leases", conf->leases, options, bool, out);
+    if (!conf->leases)
+        mdc_lease_release_all(this);
+
     GF_OPTION_RECONF("xattr-cache-list", tmp_str, options, str, out);
 
     ret = mdc_xattr_list_populate(conf, tmp_str);
@@ -3676,6 +4106,19 @@ mdc_mem_acct_init(xlator_t *this)
     return xlator_mem_acct_init(this, gf_mdc_mt_end);
 }
 
+/* The leases of all the inodes go by one id, that of this client.
+ * features/leases compares ids up to their first zero byte. */
+static void
+mdc_lease_id_init(struct mdc_conf *conf)
+{
+    uuid_t id;
+    int i = 0;
+
+    gf_uuid_generate(id);
+    for (i = 0; i < LEASE_ID_SIZE; i++)
+        conf->lease_id[i] = id[i] ? id[i] : 1;
+}
+
 int
 mdc_init(xlator_t *this)
 {
@@ -3726,6 +4169,11 @@ mdc_init(xlator_t *this)
     GF_OPTION_INIT("xattr-cache-list", tmp_str, str, out);
     mdc_xattr_list_populate(conf, tmp_str);
 
+    INIT_LIST_HEAD(&conf->lease_list);
+    GF_OPTION_INIT("md-cache-leases", conf->leases, bool, out);
+    GF_OPTION_INIT("md-cache-lease-limit", conf->lease_limit, uint32, out);
+    mdc_lease_id_init(conf);
+
     conf->last_child_down = gf_time();
     conf->statfs_cache.last_refreshed = (time_t)-1;
 
@@ -3739,7 +4187,11 @@ mdc_init(xlator_t *this)
     GF_ATOMIC_INIT(conf->mdc_counter.stat_invals, 0);
     GF_ATOMIC_INIT(conf->mdc_counter.xattr_invals, 0);
     GF_ATOMIC_INIT(conf->mdc_counter.need_lookup, 0);
+    GF_ATOMIC_INIT(conf->mdc_counter.leases_granted, 0);
+    GF_ATOMIC_INIT(conf->mdc_counter.lease_recalls, 0);
+    GF_ATOMIC_INIT(conf->mdc_counter.lease_failures, 0);
     GF_ATOMIC_INIT(conf->generation, 0);
+    GF_ATOMIC_INIT(conf->lease_epoch, 0);
 
     /* If timeout is greater than 60s (default before the patch that added
      * cache invalidation support was added) then, cache invalidation
@@ -3783,10 +4235,12 @@ mdc_notify(xlator_t *this, int event, void *data, ...)
         case GF_EVENT_CHILD_DOWN:
         case GF_EVENT_SOME_DESCENDENT_DOWN:
             mdc_update_child_down_time(this, gf_time());
+            GF_ATOMIC_INC(conf->lease_epoch);
             break;
         case GF_EVENT_UPCALL:
             if (conf->mdc_invalidation)
                 ret = mdc_invalidate(this, data);
+            mdc_lease_recall(this, data);
             break;
         case GF_EVENT_CHILD_UP:
         case GF_EVENT_SOME_DESCENDENT_UP:
@@ -3989,6 +4443,30 @@ struct volume_options mdc_options[] = {
         .flags = OPT_FLAG_SETTABLE | OPT_FLAG_CLIENT_OPT | OPT_FLAG_DOC,
         .description = "Cache statfs information of filesystem on the client",
     },
+    {
+        .key = {"md-cache-leases"},
+        .type = GF_OPTION_TYPE_BOOL,
+        .default_value = "off",
+        .op_version = {GD_OP_VERSION_10_0},
+        .flags = OPT_FLAG_SETTABLE | OPT_FLAG_CLIENT_OPT | OPT_FLAG_DOC,
+        .description = "Take read leases on directories and on frequently "
+                       "revalidated files, and keep their cached metadata "
+                       "valid until the lease is recalled instead of "
+                       "md-cache-timeout. Needs features.leases on the "
+                       "volume, md-cache-timeout is used when leases are not "
+                       "available.",
+    },
+    {
+        .key = {"md-cache-lease-limit"},
+        .type = GF_OPTION_TYPE_INT,
+        .min = 0,
+        .max = 1048576,
+        .default_value = "16384",
+        .op_version = {GD_OP_VERSION_10_0},
+        .flags = OPT_FLAG_SETTABLE | OPT_FLAG_CLIENT_OPT | OPT_FLAG_DOC,
+        .description = "Maximum number of inodes holding a metadata lease, "
+                       "each of them is kept in the inode table",
+    },
     {
         .key = {"xattr-cache-list"},
         .type = GF_OPTION_TYPE_STR,
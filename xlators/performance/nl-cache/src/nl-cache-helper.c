@@ -11,6 +11,7 @@
 #include "nl-cache.h"
 #include "timer-wheel.h"
 #include <glusterfs/statedump.h>
+#include <glusterfs/hashfn.h>
 
 /* Caching guidelines:
  * This xlator serves negative lookup(ENOENT lookups) from the cache,
@@ -50,6 +51,16 @@
  *          Name/inode Add - O(1)
  *          Name Delete - O(n)
  *          Inode Delete - O(1)
+ *      Once the negative entries are many, a bloom filter of their names
+ *          lets the search skip the list for the names that are not in it.
+ *
+ *   Complete listings (nl-cache-complete-dir):
+ *      A readdir(p) of the whole directory, from offset 0 to the end on the
+ *      same fd, leaves a bloom filter of every name in it. A lookup of a name
+ *      the filter does not have is then answered ENOENT, whatever the size of
+ *      the directory. Names added by this client go into the filter, names
+ *      removed stay in it (they are only looked up for nothing). A listing
+ *      that raced with an addition is dropped, through nlc_ctx->generation.
  *
  * Locking order:
  *
@@ -71,12 +82,143 @@ nlc_remove_from_lru(xlator_t *this, inode_t *inode);
 void
 __nlc_inode_ctx_timer_delete(xlator_t *this, nlc_ctx_t *nlc_ctx);
 gf_boolean_t
-__nlc_search_ne(nlc_ctx_t *nlc_ctx, const char *name);
+__nlc_search_ne(xlator_t *this, nlc_ctx_t *nlc_ctx, const char *name,
+                uint32_t *hash);
 void
 __nlc_free_pe(xlator_t *this, nlc_ctx_t *nlc_ctx, nlc_pe_t *pe);
 void
 __nlc_free_ne(xlator_t *this, nlc_ctx_t *nlc_ctx, nlc_ne_t *ne);
 
+static void
+nlc_filter_hash(const char *name, uint32_t *hash)
+{
+    int len = strlen(name);
+
+    hash[0] = gf_dm_hashfn(name, len);
+    hash[1] = SuperFastHash(name, len) | 1;
+}
+
+static nlc_filter_t *
+nlc_filter_new(xlator_t *this, uint64_t names)
+{
+    nlc_conf_t *conf = NULL;
+    nlc_filter_t *filter = NULL;
+    uint64_t nbits = 64;
+    size_t size = 0;
+
+    conf = this->private;
+
+    if (names < NLC_FILTER_MIN_NAMES)
+        names = NLC_FILTER_MIN_NAMES;
+
+    while (nbits < (names * conf->filter_bits))
+        nbits <<= 1;
+
+    size = sizeof(*filter) + (nbits / 8);
+    if (size > conf->cache_size)
+        goto out;
+
+    filter = GF_CALLOC(1, size, gf_nlc_mt_nlc_filter_t);
+    if (!filter)
+        goto out;
+
+    filter->nbits = nbits;
+    /* ln(2) times the bits per name gives the fewest false positives */
+    filter->nhashes = max(conf->filter_bits * 7 / 10, 1);
+    filter->capacity = names;
+    filter->size = size;
+out:
+    return filter;
+}
+
+static void
+__nlc_filter_add(nlc_filter_t *filter, uint32_t *hash)
+{
+    uint64_t bit = 0;
+    uint32_t i = 0;
+
+    for (i = 0; i < filter->nhashes; i++) {
+        bit = ((uint64_t)hash[0] + (uint64_t)i * hash[1]) & (filter->nbits - 1);
+        filter->bits[bit / 64] |= (1ULL << (bit % 64));
+    }
+    filter->count++;
+}
+
+static gf_boolean_t
+__nlc_filter_test(nlc_filter_t *filter, uint32_t *hash)
+{
+    uint64_t bit = 0;
+    uint32_t i = 0;
+
+    for (i = 0; i < filter->nhashes; i++) {
+        bit = ((uint64_t)hash[0] + (uint64_t)i * hash[1]) & (filter->nbits - 1);
+        if (!(filter->bits[bit / 64] & (1ULL << (bit % 64))))
+            return _gf_false;
+    }
+    return _gf_true;
+}
+
+static void
+__nlc_filter_free(xlator_t *this, nlc_ctx_t *nlc_ctx, nlc_filter_t **filter_p)
+{
+    nlc_conf_t *conf = NULL;
+    nlc_filter_t *filter = *filter_p;
+
+    conf = this->private;
+
+    if (!filter)
+        return;
+
+    nlc_ctx->cache_size -= filter->size;
+    GF_ATOMIC_SUB(conf->current_cache_size, filter->size);
+    GF_ATOMIC_SUB(conf->nlc_counter.filter_size, filter->size);
+
+    GF_FREE(filter);
+    *filter_p = NULL;
+}
+
+static void
+__nlc_filter_set(xlator_t *this, nlc_ctx_t *nlc_ctx, nlc_filter_t **filter_p,
+                 nlc_filter_t *filter)
+{
+    nlc_conf_t *conf = NULL;
+
+    conf = this->private;
+
+    __nlc_filter_free(this, nlc_ctx, filter_p);
+
+    nlc_ctx->cache_size += filter->size;
+    GF_ATOMIC_ADD(conf->current_cache_size, filter->size);
+    GF_ATOMIC_ADD(conf->nlc_counter.filter_size, filter->size);
+
+    *filter_p = filter;
+}
+
+/* Size the filter of the negative entries for the ones there are now, with
+ * room to grow */
+static void
+__nlc_ne_filter_build(xlator_t *this, nlc_ctx_t *nlc_ctx)
+{
+    nlc_filter_t *filter = NULL;
+    nlc_ne_t *ne = NULL;
+    uint32_t hash[2];
+
+    filter = nlc_filter_new(this, nlc_ctx->ne_count * 4);
+    if (!filter) {
+        /* the search falls back to the list */
+        __nlc_filter_free(this, nlc_ctx, &nlc_ctx->ne_filter);
+        return;
+    }
+
+    list_for_each_entry(ne, &nlc_ctx->ne, list)
+    {
+        nlc_filter_hash(ne->name, hash);
+        __nlc_filter_add(filter, hash);
+    }
+
+    __nlc_filter_set(this, nlc_ctx, &nlc_ctx->ne_filter, filter);
+}
+
 static int32_t
 nlc_get_cache_timeout(xlator_t *this)
 {
@@ -224,6 +366,11 @@ __nlc_inode_clear_entries(xlator_t *this, nlc_ctx_t *nlc_ctx)
             __nlc_free_ne(this, nlc_ctx, ne);
         }
 
+    __nlc_filter_free(this, nlc_ctx, &nlc_ctx->ne_filter);
+    __nlc_filter_free(this, nlc_ctx, &nlc_ctx->names);
+    nlc_ctx->ne_count = 0;
+    nlc_ctx->generation++;
+
     nlc_ctx->cache_time = 0;
     nlc_ctx->state = 0;
     GF_ASSERT(nlc_ctx->cache_size == sizeof(*nlc_ctx));
@@ -383,6 +530,9 @@ nlc_local_wipe(xlator_t *this, nlc_local_t *local)
 
     loc_wipe(&local->loc2);
 
+    if (local->fd)
+        fd_unref(local->fd);
+
     GF_FREE(local);
 out:
     return;
@@ -681,6 +831,7 @@ __nlc_free_ne(xlator_t *this, nlc_ctx_t *nlc_ctx, nlc_ne_t *ne)
     list_del(&ne->list);
     GF_FREE(ne->name);
     GF_FREE(ne);
+    nlc_ctx->ne_count--;
 
     nlc_ctx->cache_size -= sizeof(*ne) + sizeof(ne->name);
     GF_ATOMIC_SUB(conf->current_cache_size, (sizeof(*ne) + sizeof(ne->name)));
@@ -842,6 +993,7 @@ __nlc_add_ne(xlator_t *this, nlc_ctx_t *nlc_ctx, const char *name)
     nlc_ne_t *ne = NULL;
     int ret = -1;
     nlc_conf_t *conf = NULL;
+    uint32_t hash[2];
 
     conf = this->private;
 
@@ -858,9 +1010,18 @@ __nlc_add_ne(xlator_t *this, nlc_ctx_t *nlc_ctx, const char *name)
         goto out;
 
     list_add(&ne->list, &nlc_ctx->ne);
+    nlc_ctx->ne_count++;
 
     nlc_ctx->cache_size += sizeof(*ne) + sizeof(ne->name);
     GF_ATOMIC_ADD(conf->current_cache_size, (sizeof(*ne) + sizeof(ne->name)));
+
+    if (nlc_ctx->ne_filter &&
+        (nlc_ctx->ne_filter->count < nlc_ctx->ne_filter->capacity)) {
+        nlc_filter_hash(name, hash);
+        __nlc_filter_add(nlc_ctx->ne_filter, hash);
+    } else if (nlc_ctx->ne_count >= NLC_NE_FILTER_MIN) {
+        __nlc_ne_filter_build(this, nlc_ctx);
+    }
     ret = 0;
 out:
     if (ret)
@@ -873,6 +1034,7 @@ void
 nlc_dir_add_ne(xlator_t *this, inode_t *inode, const char *name)
 {
     nlc_ctx_t *nlc_ctx = NULL;
+    uint32_t hash[2];
 
     if (inode->ia_type != IA_IFDIR) {
         gf_msg_callingfn(this->name, GF_LOG_ERROR, EINVAL, NLC_MSG_EINVAL,
@@ -884,12 +1046,14 @@ nlc_dir_add_ne(xlator_t *this, inode_t *inode, const char *name)
     if (!nlc_ctx)
         goto out;
 
+    nlc_filter_hash(name, hash);
+
     LOCK(&nlc_ctx->lock);
     {
         /* There is one possibility where we need to search before
          * adding NE: when there are two parallel lookups on a non
          * existent file */
-        if (!__nlc_search_ne(nlc_ctx, name)) {
+        if (!__nlc_search_ne(this, nlc_ctx, name, hash)) {
             __nlc_add_ne(this, nlc_ctx, name);
             __nlc_set_dir_state(nlc_ctx, NLC_NE_VALID);
         }
@@ -935,6 +1099,10 @@ nlc_dir_add_pe(xlator_t *this, inode_t *inode, inode_t *entry_ino,
                const char *name)
 {
     nlc_ctx_t *nlc_ctx = NULL;
+    nlc_conf_t *conf = NULL;
+    uint32_t hash[2];
+
+    conf = this->private;
 
     if (inode->ia_type != IA_IFDIR) {
         gf_msg_callingfn(this->name, GF_LOG_ERROR, EINVAL, NLC_MSG_EINVAL,
@@ -946,12 +1114,29 @@ nlc_dir_add_pe(xlator_t *this, inode_t *inode, inode_t *entry_ino,
     if (!nlc_ctx)
         goto out;
 
+    nlc_filter_hash(name, hash);
+
     LOCK(&nlc_ctx->lock);
     {
+        /* a listing being read may have missed the name */
+        nlc_ctx->generation++;
+
         __nlc_del_ne(this, nlc_ctx, name);
-        __nlc_add_pe(this, nlc_ctx, entry_ino, name);
-        if (!IS_PE_VALID(nlc_ctx->state))
-            __nlc_set_dir_state(nlc_ctx, NLC_PE_PARTIAL);
+
+        if (nlc_ctx->names) {
+            __nlc_filter_add(nlc_ctx->names, hash);
+            /* past twice its size, it hardly answers anything */
+            if (nlc_ctx->names->count > (2 * nlc_ctx->names->capacity)) {
+                __nlc_filter_free(this, nlc_ctx, &nlc_ctx->names);
+                nlc_ctx->state &= ~NLC_NAMES_FULL;
+            }
+        }
+
+        if (IS_PEC_ENABLED(conf)) {
+            __nlc_add_pe(this, nlc_ctx, entry_ino, name);
+            if (!IS_PE_VALID(nlc_ctx->state))
+                __nlc_set_dir_state(nlc_ctx, NLC_PE_PARTIAL);
+        }
     }
     UNLOCK(&nlc_ctx->lock);
 out:
@@ -959,15 +1144,24 @@ out:
 }
 
 gf_boolean_t
-__nlc_search_ne(nlc_ctx_t *nlc_ctx, const char *name)
+__nlc_search_ne(xlator_t *this, nlc_ctx_t *nlc_ctx, const char *name,
+                uint32_t *hash)
 {
     gf_boolean_t found = _gf_false;
     nlc_ne_t *ne = NULL;
     nlc_ne_t *tmp = NULL;
+    nlc_conf_t *conf = NULL;
+
+    conf = this->private;
 
     if (!IS_NE_VALID(nlc_ctx->state))
         goto out;
 
+    if (nlc_ctx->ne_filter && !__nlc_filter_test(nlc_ctx->ne_filter, hash)) {
+        GF_ATOMIC_INC(conf->nlc_counter.ne_filter_skip);
+        goto out;
+    }
+
     list_for_each_entry_safe(ne, tmp, &nlc_ctx->ne, list)
     {
         if (strcmp(ne->name, name) == 0) {
@@ -1038,7 +1232,10 @@ nlc_is_negative_lookup(xlator_t *this, loc_t *loc)
     nlc_ctx_t *nlc_ctx = NULL;
     inode_t *inode = NULL;
     gf_boolean_t neg_entry = _gf_false;
+    nlc_conf_t *conf = NULL;
+    uint32_t hash[2];
 
+    conf = this->private;
     inode = loc->parent;
     GF_VALIDATE_OR_GOTO(this->name, inode, out);
 
@@ -1052,12 +1249,14 @@ nlc_is_negative_lookup(xlator_t *this, loc_t *loc)
     if (!nlc_ctx)
         goto out;
 
+    nlc_filter_hash(loc->name, hash);
+
     LOCK(&nlc_ctx->lock);
     {
         if (!__nlc_is_cache_valid(this, nlc_ctx))
             goto unlock;
 
-        if (__nlc_search_ne(nlc_ctx, loc->name)) {
+        if (__nlc_search_ne(this, nlc_ctx, loc->name, hash)) {
             neg_entry = _gf_true;
             goto unlock;
         }
@@ -1066,6 +1265,15 @@ nlc_is_negative_lookup(xlator_t *this, loc_t *loc)
             neg_entry = _gf_true;
             goto unlock;
         }
+        if (conf->complete_dir && (nlc_ctx->state & NLC_NAMES_FULL) &&
+            nlc_ctx->names) {
+            if (!__nlc_filter_test(nlc_ctx->names, hash)) {
+                GF_ATOMIC_INC(conf->nlc_counter.names_filter_hit);
+                neg_entry = _gf_true;
+                goto unlock;
+            }
+            GF_ATOMIC_INC(conf->nlc_counter.names_filter_pass);
+        }
     }
 unlock:
     UNLOCK(&nlc_ctx->lock);
@@ -1176,6 +1384,16 @@ nlc_dump_inodectx(xlator_t *this, inode_t *inode)
         gf_proc_dump_write("cache-time", "%ld", nlc_ctx->cache_time);
         gf_proc_dump_write("cache-size", "%zu", nlc_ctx->cache_size);
         gf_proc_dump_write("refd-inodes", "%" PRIu64, nlc_ctx->refd_inodes);
+        gf_proc_dump_write("ne-count", "%" PRIu64, nlc_ctx->ne_count);
+        gf_proc_dump_write("generation", "%" PRIu64, nlc_ctx->generation);
+        if (nlc_ctx->ne_filter)
+            gf_proc_dump_write("ne-filter", "%" PRIu64 " bits, %" PRIu64
+                               " names", nlc_ctx->ne_filter->nbits,
+                               nlc_ctx->ne_filter->count);
+        if (nlc_ctx->names)
+            gf_proc_dump_write("names-filter", "%" PRIu64 " bits, %" PRIu64
+                               " names", nlc_ctx->names->nbits,
+                               nlc_ctx->names->count);
 
         if (IS_PE_VALID(nlc_ctx->state))
             list_for_each_entry_safe(pe, tmp, &nlc_ctx->pe, list)
@@ -1199,3 +1417,223 @@ nlc_dump_inodectx(xlator_t *this, inode_t *inode)
 out:
     return;
 }
+
+/* A new directory is complete and empty */
+void
+nlc_dir_set_empty(xlator_t *this, inode_t *inode)
+{
+    nlc_ctx_t *nlc_ctx = NULL;
+    nlc_filter_t *filter = NULL;
+
+    nlc_inode_ctx_get_set(this, inode, &nlc_ctx);
+    if (!nlc_ctx)
+        goto out;
+
+    filter = nlc_filter_new(this, NLC_FILTER_MIN_NAMES);
+    if (!filter)
+        goto out;
+
+    LOCK(&nlc_ctx->lock);
+    {
+        __nlc_filter_set(this, nlc_ctx, &nlc_ctx->names, filter);
+        __nlc_set_dir_state(nlc_ctx, NLC_NAMES_FULL);
+    }
+    UNLOCK(&nlc_ctx->lock);
+out:
+    return;
+}
+
+uint64_t
+nlc_dir_generation(xlator_t *this, inode_t *inode)
+{
+    nlc_ctx_t *nlc_ctx = NULL;
+    uint64_t generation = 0;
+
+    nlc_inode_ctx_get_set(this, inode, &nlc_ctx);
+    if (!nlc_ctx)
+        goto out;
+
+    LOCK(&nlc_ctx->lock);
+    {
+        generation = nlc_ctx->generation;
+    }
+    UNLOCK(&nlc_ctx->lock);
+out:
+    return generation;
+}
+
+static void
+nlc_dir_set_names(xlator_t *this, inode_t *inode, uint32_t *hashes,
+                  uint64_t count, uint64_t generation)
+{
+    nlc_conf_t *conf = NULL;
+    nlc_ctx_t *nlc_ctx = NULL;
+    nlc_filter_t *filter = NULL;
+    uint64_t i = 0;
+
+    conf = this->private;
+
+    filter = nlc_filter_new(this, count);
+    if (!filter)
+        goto out;
+
+    for (i = 0; i < count; i++)
+        __nlc_filter_add(filter, &hashes[2 * i]);
+
+    nlc_inode_ctx_get_set(this, inode, &nlc_ctx);
+    if (!nlc_ctx)
+        goto out;
+
+    LOCK(&nlc_ctx->lock);
+    {
+        if (!__nlc_is_cache_valid(this, nlc_ctx) ||
+            (nlc_ctx->generation != generation))
+            goto unlock;
+
+        __nlc_filter_set(this, nlc_ctx, &nlc_ctx->names, filter);
+        __nlc_set_dir_state(nlc_ctx, NLC_NAMES_FULL);
+        filter = NULL;
+    }
+unlock:
+    UNLOCK(&nlc_ctx->lock);
+
+    if (!filter) {
+        GF_ATOMIC_INC(conf->nlc_counter.complete_listings);
+        nlc_lru_prune(this, NULL);
+    }
+out:
+    GF_FREE(filter);
+    return;
+}
+
+static nlc_fd_ctx_t *
+nlc_fd_ctx_get_set(xlator_t *this, fd_t *fd)
+{
+    nlc_fd_ctx_t *fd_ctx = NULL;
+    uint64_t value = 0;
+
+    LOCK(&fd->lock);
+    {
+        if (__fd_ctx_get(fd, this, &value) == 0) {
+            fd_ctx = (nlc_fd_ctx_t *)(uintptr_t)value;
+            goto unlock;
+        }
+
+        fd_ctx = GF_CALLOC(1, sizeof(*fd_ctx), gf_nlc_mt_nlc_fd_ctx_t);
+        if (!fd_ctx)
+            goto unlock;
+
+        LOCK_INIT(&fd_ctx->lock);
+        fd_ctx->next_offset = -1;
+
+        value = (uint64_t)(uintptr_t)fd_ctx;
+        if (__fd_ctx_set(fd, this, value)) {
+            LOCK_DESTROY(&fd_ctx->lock);
+            GF_FREE(fd_ctx);
+            fd_ctx = NULL;
+        }
+    }
+unlock:
+    UNLOCK(&fd->lock);
+
+    return fd_ctx;
+}
+
+void
+nlc_fd_ctx_free(xlator_t *this, fd_t *fd)
+{
+    nlc_fd_ctx_t *fd_ctx = NULL;
+    uint64_t value = 0;
+
+    fd_ctx_del(fd, this, &value);
+    fd_ctx = (nlc_fd_ctx_t *)(uintptr_t)value;
+    if (!fd_ctx)
+        return;
+
+    GF_FREE(fd_ctx->hashes);
+    LOCK_DESTROY(&fd_ctx->lock);
+    GF_FREE(fd_ctx);
+}
+
+/* Gather the names a readdir(p) on the fd returned, and once the whole
+ * directory was read in order turn them into its names filter */
+void
+nlc_dir_listing(xlator_t *this, fd_t *fd, off_t offset, uint64_t generation,
+                int32_t op_ret, int32_t op_errno, gf_dirent_t *entries)
+{
+    nlc_conf_t *conf = NULL;
+    nlc_fd_ctx_t *fd_ctx = NULL;
+    gf_dirent_t *entry = NULL;
+    uint32_t *hashes = NULL;
+    uint64_t alloc = 0;
+    uint64_t count = 0;
+    gf_boolean_t done = _gf_false;
+
+    conf = this->private;
+
+    fd_ctx = nlc_fd_ctx_get_set(this, fd);
+    if (!fd_ctx)
+        goto out;
+
+    LOCK(&fd_ctx->lock);
+    {
+        if (offset == 0) {
+            fd_ctx->count = 0;
+            fd_ctx->generation = generation;
+            fd_ctx->next_offset = 0;
+        } else if ((fd_ctx->next_offset < 0) ||
+                   (offset != fd_ctx->next_offset)) {
+            goto broken;
+        }
+
+        if (op_ret > 0) {
+            list_for_each_entry(entry, &entries->list, list)
+            {
+                if (fd_ctx->count == fd_ctx->alloc) {
+                    alloc = fd_ctx->alloc ? (fd_ctx->alloc * 2) : 1024;
+                    /* the filter would not fit in the cache either */
+                    if ((alloc * 2 * sizeof(*hashes)) > conf->cache_size)
+                        goto broken;
+                    if (fd_ctx->hashes)
+                        hashes = GF_REALLOC(fd_ctx->hashes,
+                                            alloc * 2 * sizeof(*hashes));
+                    else
+                        hashes = GF_MALLOC(alloc * 2 * sizeof(*hashes),
+                                           gf_nlc_mt_nlc_names_t);
+                    if (!hashes)
+                        goto broken;
+                    fd_ctx->hashes = hashes;
+                    fd_ctx->alloc = alloc;
+                }
+
+                nlc_filter_hash(entry->d_name,
+                                &fd_ctx->hashes[2 * fd_ctx->count]);
+                fd_ctx->count++;
+                fd_ctx->next_offset = entry->d_off;
+            }
+            goto unlock;
+        }
+
+        /* the end of the directory */
+        if ((op_ret == 0) || (op_errno == ENOENT))
+            done = _gf_true;
+
+    broken:
+        hashes = fd_ctx->hashes;
+        count = fd_ctx->count;
+        generation = fd_ctx->generation;
+        fd_ctx->hashes = NULL;
+        fd_ctx->alloc = 0;
+        fd_ctx->count = 0;
+        fd_ctx->next_offset = -1;
+    }
+unlock:
+    UNLOCK(&fd_ctx->lock);
+
+    if (done)
+        nlc_dir_set_names(this, fd->inode, hashes, count, generation);
+
+    GF_FREE(hashes);
+out:
+    return;
+}
@@ -16,12 +16,16 @@ static void
 nlc_dentry_op(call_frame_t *frame, xlator_t *this, gf_boolean_t multilink)
 {
     nlc_local_t *local = frame->local;
+    nlc_conf_t *conf = this->private;
 
     GF_VALIDATE_OR_GOTO(this->name, local, out);
 
     switch (local->fop) {
         case GF_FOP_MKDIR:
-            nlc_set_dir_state(this, local->loc.inode, NLC_PE_FULL);
+            if (IS_PEC_ENABLED(conf))
+                nlc_set_dir_state(this, local->loc.inode, NLC_PE_FULL);
+            if (conf->complete_dir)
+                nlc_dir_set_empty(this, local->loc.inode);
             /*fall-through*/
         case GF_FOP_MKNOD:
         case GF_FOP_CREATE:
@@ -65,7 +69,7 @@ out:
                                                                                \
         conf = this->private;                                                  \
                                                                                \
-        if (!IS_PEC_ENABLED(conf))                                             \
+        if (!IS_DENTRY_TRACKED(conf))                                          \
             goto disabled;                                                     \
                                                                                \
         __local = nlc_local_init(frame, this, _op, loc1, loc2);                \
@@ -92,7 +96,7 @@ out:
                                                                                \
         conf = this->private;                                                  \
                                                                                \
-        if (op_ret < 0 || !IS_PEC_ENABLED(conf))                               \
+        if (op_ret < 0 || !IS_DENTRY_TRACKED(conf))                            \
             goto out;                                                          \
         nlc_dentry_op(frame, this, multilink);                                 \
     out:                                                                       \
@@ -417,7 +421,7 @@ nlc_unlink(call_frame_t *frame, xlator_t *this, loc_t *loc, int32_t flags,
 
     conf = this->private;
 
-    if (!IS_PEC_ENABLED(conf))
+    if (!IS_DENTRY_TRACKED(conf))
         goto do_fop;
 
     if (!xdata) {
@@ -440,6 +444,92 @@ do_fop:
     return 0;
 }
 
+static int32_t
+nlc_readdirp_cbk(call_frame_t *frame, void *cookie, xlator_t *this,
+                 int32_t op_ret, int32_t op_errno, gf_dirent_t *entries,
+                 dict_t *xdata)
+{
+    nlc_local_t *local = frame->local;
+
+    if (local)
+        nlc_dir_listing(this, local->fd, local->offset, local->generation,
+                        op_ret, op_errno, entries);
+
+    NLC_STACK_UNWIND(readdirp, frame, op_ret, op_errno, entries, xdata);
+    return 0;
+}
+
+static int32_t
+nlc_readdirp(call_frame_t *frame, xlator_t *this, fd_t *fd, size_t size,
+             off_t offset, dict_t *xdata)
+{
+    nlc_local_t *local = NULL;
+    nlc_conf_t *conf = NULL;
+
+    conf = this->private;
+
+    if (!conf->complete_dir)
+        goto wind;
+
+    local = nlc_local_init(frame, this, GF_FOP_READDIRP, NULL, NULL);
+    if (!local)
+        goto wind;
+
+    local->fd = fd_ref(fd);
+    local->offset = offset;
+    /* taken before the entries are read, an addition meanwhile makes the
+     * listing useless */
+    if (offset == 0)
+        local->generation = nlc_dir_generation(this, fd->inode);
+
+wind:
+    STACK_WIND(frame, nlc_readdirp_cbk, FIRST_CHILD(this),
+               FIRST_CHILD(this)->fops->readdirp, fd, size, offset, xdata);
+    return 0;
+}
+
+static int32_t
+nlc_readdir_cbk(call_frame_t *frame, void *cookie, xlator_t *this,
+                int32_t op_ret, int32_t op_errno, gf_dirent_t *entries,
+                dict_t *xdata)
+{
+    nlc_local_t *local = frame->local;
+
+    if (local)
+        nlc_dir_listing(this, local->fd, local->offset, local->generation,
+                        op_ret, op_errno, entries);
+
+    NLC_STACK_UNWIND(readdir, frame, op_ret, op_errno, entries, xdata);
+    return 0;
+}
+
+static int32_t
+nlc_readdir(call_frame_t *frame, xlator_t *this, fd_t *fd, size_t size,
+            off_t offset, dict_t *xdata)
+{
+    nlc_local_t *local = NULL;
+    nlc_conf_t *conf = NULL;
+
+    conf = this->private;
+
+    if (!conf->complete_dir)
+        goto wind;
+
+    local = nlc_local_init(frame, this, GF_FOP_READDIR, NULL, NULL);
+    if (!local)
+        goto wind;
+
+    local->fd = fd_ref(fd);
+    local->offset = offset;
+    if (offset == 0)
+        local->generation = nlc_dir_generation(this, fd->inode);
+
+wind:
+    STACK_WIND(frame, nlc_readdir_cbk, FIRST_CHILD(this),
+               FIRST_CHILD(this)->fops->readdir, fd, size, offset, xdata);
+    return 0;
+}
+
 static int32_t
 nlc_invalidate(xlator_t *this, void *data)
 {
@@ -570,6 +660,13 @@ nlc_forget(xlator_t *this, inode_t *inode)
     return 0;
 }
 
+static int32_t
+nlc_releasedir(xlator_t *this, fd_t *fd)
+{
+    nlc_fd_ctx_free(this, fd);
+    return 0;
+}
+
 static int32_t
 nlc_inodectx(xlator_t *this, inode_t *inode)
 {
@@ -604,6 +701,16 @@ nlc_priv_dump(xlator_t *this)
                        GF_ATOMIC_GET(conf->nlc_counter.ne_inode_cnt));
     gf_proc_dump_write("dentry_invalidations_received", "%" PRId64,
                        GF_ATOMIC_GET(conf->nlc_counter.nlc_invals));
+    gf_proc_dump_write("complete_listings", "%" PRId64,
+                       GF_ATOMIC_GET(conf->nlc_counter.complete_listings));
+    gf_proc_dump_write("names_filter_hit_count", "%" PRId64,
+                       GF_ATOMIC_GET(conf->nlc_counter.names_filter_hit));
+    gf_proc_dump_write("names_filter_pass_count", "%" PRId64,
+                       GF_ATOMIC_GET(conf->nlc_counter.names_filter_pass));
+    gf_proc_dump_write("negative_filter_skip_count", "%" PRId64,
+                       GF_ATOMIC_GET(conf->nlc_counter.ne_filter_skip));
+    gf_proc_dump_write("filter_size", "%" PRId64,
+                       GF_ATOMIC_GET(conf->nlc_counter.filter_size));
     gf_proc_dump_write("cache_limit", "%" PRIu64, conf->cache_size);
     gf_proc_dump_write("consumed_cache_size", "%" PRId64,
                        GF_ATOMIC_GET(conf->current_cache_size));
@@ -637,6 +744,16 @@ nlc_dump_metrics(xlator_t *this, int fd)
             this->name, GF_ATOMIC_GET(conf->nlc_counter.ne_inode_cnt));
     dprintf(fd, "%s.dentry_invalidations_received %" PRId64 "\n", this->name,
             GF_ATOMIC_GET(conf->nlc_counter.nlc_invals));
+    dprintf(fd, "%s.complete_listings %" PRId64 "\n", this->name,
+            GF_ATOMIC_GET(conf->nlc_counter.complete_listings));
+    dprintf(fd, "%s.names_filter_hit_count %" PRId64 "\n", this->name,
+            GF_ATOMIC_GET(conf->nlc_counter.names_filter_hit));
+    dprintf(fd, "%s.names_filter_pass_count %" PRId64 "\n", this->name,
+            GF_ATOMIC_GET(conf->nlc_counter.names_filter_pass));
+    dprintf(fd, "%s.negative_filter_skip_count %" PRId64 "\n", this->name,
+            GF_ATOMIC_GET(conf->nlc_counter.ne_filter_skip));
+    dprintf(fd, "%s.filter_size %" PRId64 "\n", this->name,
+            GF_ATOMIC_GET(conf->nlc_counter.filter_size));
     dprintf(fd, "%s.cache_limit %" PRIu64 "\n", this->name, conf->cache_size);
     dprintf(fd, "%s.consumed_cache_size %" PRId64 "\n", this->name,
             GF_ATOMIC_GET(conf->current_cache_size));
@@ -673,6 +790,7 @@ int32_t
 nlc_reconfigure(xlator_t *this, dict_t *options)
 {
     nlc_conf_t *conf = NULL;
+    gf_boolean_t complete_dir = _gf_false;
 
     conf = this->private;
 
@@ -683,6 +801,15 @@ nlc_reconfigure(xlator_t *this, dict_t *options)
     GF_OPTION_RECONF("nl-cache-limit", conf->cache_size, options, size_uint64,
                      out);
     GF_OPTION_RECONF("pass-through", this->pass_through, options, bool, out);
+    GF_OPTION_RECONF("nl-cache-filter-bits", conf->filter_bits, options,
+                     uint32, out);
+
+    complete_dir = conf->complete_dir;
+    GF_OPTION_RECONF("nl-cache-complete-dir", conf->complete_dir, options,
+                     bool, out);
+    /* the names filters were not kept up to date while it was off */
+    if (complete_dir != conf->complete_dir)
+        nlc_clear_all_cache(this);
 
 out:
     return 0;
@@ -704,6 +831,8 @@ nlc_init(xlator_t *this)
                    out);
     GF_OPTION_INIT("nl-cache-limit", conf->cache_size, size_uint64, out);
     GF_OPTION_INIT("pass-through", this->pass_through, bool, out);
+    GF_OPTION_INIT("nl-cache-complete-dir", conf->complete_dir, bool, out);
+    GF_OPTION_INIT("nl-cache-filter-bits", conf->filter_bits, uint32, out);
 
     /* Since the positive entries are stored as list of refs on
      * existing inodes, we should not overflow the inode lru_limit.
@@ -727,6 +856,11 @@ nlc_init(xlator_t *this)
     GF_ATOMIC_INIT(conf->nlc_counter.pe_inode_cnt, 0);
     GF_ATOMIC_INIT(conf->nlc_counter.ne_inode_cnt, 0);
     GF_ATOMIC_INIT(conf->nlc_counter.nlc_invals, 0);
+    GF_ATOMIC_INIT(conf->nlc_counter.names_filter_hit, 0);
+    GF_ATOMIC_INIT(conf->nlc_counter.names_filter_pass, 0);
+    GF_ATOMIC_INIT(conf->nlc_counter.ne_filter_skip, 0);
+    GF_ATOMIC_INIT(conf->nlc_counter.complete_listings, 0);
+    GF_ATOMIC_INIT(conf->nlc_counter.filter_size, 0);
 
     INIT_LIST_HEAD(&conf->lru);
     conf->last_child_down = gf_time();
@@ -759,15 +893,16 @@ struct xlator_fops nlc_fops = {
     .symlink = nlc_symlink,
     .link = nlc_link,
     .unlink = nlc_unlink,
+    .readdir = nlc_readdir,
+    .readdirp = nlc_readdirp,
     /* TODO:
-    .readdir              = nlc_readdir,
-    .readdirp             = nlc_readdirp,
     .seek                 = nlc_seek,
     .opendir              = nlc_opendir, */
 };
 
 struct xlator_cbks nlc_cbks = {
     .forget = nlc_forget,
+    .releasedir = nlc_releasedir,
 };
 
 struct xlator_dumpops nlc_dumpops = {
@@ -812,6 +947,30 @@ struct volume_options nlc_options[] = {
         .flags = OPT_FLAG_SETTABLE | OPT_FLAG_CLIENT_OPT | OPT_FLAG_DOC,
         .description = "Time period after which cache has to be refreshed",
     },
+    {
+        .key = {"nl-cache-complete-dir"},
+        .type = GF_OPTION_TYPE_BOOL,
+        .default_value = "off",
+        .op_version = {GD_OP_VERSION_10_0},
+        .flags = OPT_FLAG_SETTABLE | OPT_FLAG_CLIENT_OPT | OPT_FLAG_DOC,
+        .description = "Once a directory is read in full, serve the lookups "
+                       "of the names it does not have from a bloom filter "
+                       "of its entries, whatever its size. Meant for create "
+                       "heavy loads in huge directories, along with "
+                       "features.cache-invalidation",
+    },
+    {
+        .key = {"nl-cache-filter-bits"},
+        .type = GF_OPTION_TYPE_INT,
+        .min = 4,
+        .max = 32,
+        .default_value = "10",
+        .op_version = {GD_OP_VERSION_10_0},
+        .flags = OPT_FLAG_SETTABLE | OPT_FLAG_CLIENT_OPT | OPT_FLAG_DOC,
+        .description = "Bits of the bloom filters per name. 10 bits send "
+                       "about 1% of the lookups of absent names to the "
+                       "bricks anyway, each bit less doubles it",
+    },
     {.key = {"pass-through"},
      .type = GF_OPTION_TYPE_BOOL,
      .default_value = "false",
@@ -22,6 +22,11 @@
 #define NLC_PE_FULL 0x0001
 #define NLC_PE_PARTIAL 0x0002
 #define NLC_NE_VALID 0x0004
+#define NLC_NAMES_FULL 0x0008 /* the names filter has every entry */
+
+/* The negative entries get a filter once there are that many */
+#define NLC_NE_FILTER_MIN 32
+#define NLC_FILTER_MIN_NAMES 64
 
 #define IS_PE_VALID(state)                                                     \
     ((state != NLC_INVALID) && (state & (NLC_PE_FULL | NLC_PE_PARTIAL)))
@@ -29,6 +34,8 @@
 
 #define IS_PEC_ENABLED(conf) (conf->positive_entry_cache)
 #define IS_CACHE_ENABLED(conf) ((!conf->cache_disabled))
+#define IS_DENTRY_TRACKED(conf)                                                \
+    (conf->positive_entry_cache || conf->complete_dir)
 
 #define NLC_STACK_UNWIND(fop, frame, params...)                                \
     do {                                                                       \
@@ -61,6 +68,30 @@ struct nlc_pe {
 };
 typedef struct nlc_pe nlc_pe_t;
 
+/* Bloom filter of the names of a directory. It never answers that a name
+ * is absent when it was added, hence a name it does not find is surely not
+ * there; the names it finds may still be absent. */
+struct nlc_filter {
+    uint64_t nbits; /* a power of two */
+    uint32_t nhashes;
+    uint32_t capacity; /* names it was sized for */
+    uint64_t count;    /* names added */
+    size_t size;       /* of the allocation */
+    uint64_t bits[];
+};
+typedef struct nlc_filter nlc_filter_t;
+
+/* Names read so far by a readdir(p) from offset 0 on the fd */
+struct nlc_fd_ctx {
+    gf_lock_t lock;
+    uint64_t generation; /* of the dir when the listing started */
+    off_t next_offset;   /* -1 unless the listing can go on */
+    uint32_t *hashes;    /* two per name */
+    uint64_t count;
+    uint64_t alloc;
+};
+typedef struct nlc_fd_ctx nlc_fd_ctx_t;
+
 struct nlc_timer_data {
     inode_t *inode;
     xlator_t *this;
@@ -82,6 +113,10 @@ struct nlc_ctx {
     nlc_timer_data_t *timer_data;
     size_t cache_size;
     uint64_t refd_inodes;
+    nlc_filter_t *names;     /* every name, valid with NLC_NAMES_FULL */
+    nlc_filter_t *ne_filter; /* the names in ne, to skip searching it */
+    uint64_t ne_count;
+    uint64_t generation; /* bumped when a name is added or the cache cleared */
     gf_lock_t lock;
 };
 typedef struct nlc_ctx nlc_ctx_t;
@@ -94,6 +129,8 @@ struct nlc_local {
     fd_t *fd;
     char *linkname;
     glusterfs_fop_t fop;
+    off_t offset;
+    uint64_t generation;
 };
 typedef struct nlc_local nlc_local_t;
 
@@ -107,6 +144,11 @@ struct nlc_statistics {
     gf_atomic_t pe_inode_cnt;
     gf_atomic_t ne_inode_cnt;
     gf_atomic_t nlc_invals; /* No. of invalidates received from upcall*/
+    gf_atomic_t names_filter_hit;  /* negative lookups served by a listing */
+    gf_atomic_t names_filter_pass; /* lookups a listing could not answer */
+    gf_atomic_t ne_filter_skip;    /* ne searches skipped by the filter */
+    gf_atomic_t complete_listings; /* listings turned into a names filter */
+    gf_atomic_t filter_size;
 };
 
 struct nlc_conf {
@@ -114,6 +156,8 @@ struct nlc_conf {
     gf_boolean_t positive_entry_cache;
     gf_boolean_t negative_entry_cache;
     gf_boolean_t disable_cache;
+    gf_boolean_t complete_dir;
+    uint32_t filter_bits; /* per name */
     uint64_t cache_size;
     gf_atomic_t current_cache_size;
     uint64_t inode_limit;
@@ -172,4 +216,17 @@ nlc_disable_cache(xlator_t *this);
 void
 nlc_lru_prune(xlator_t *this, inode_t *inode);
 
+void
+nlc_dir_set_empty(xlator_t *this, inode_t *inode);
+
+uint64_t
+nlc_dir_generation(xlator_t *this, inode_t *inode);
+
+void
+nlc_dir_listing(xlator_t *this, fd_t *fd, off_t offset, uint64_t generation,
+                int32_t op_ret, int32_t op_errno, gf_dirent_t *entries);
+
+void
+nlc_fd_ctx_free(xlator_t *this, fd_t *fd);
+
 #endif /* __NL_CACHE_H__ */
@@ -18,6 +18,7 @@ enum gf_qr_mem_types_ {
     gf_qr_mt_content_t,
     gf_qr_mt_qr_priority_t,
     gf_qr_mt_qr_private_t,
+    gf_qr_mt_qr_shm_t,
     gf_qr_mt_end
 };
 #endif
@@ -0,0 +1,480 @@
+/*
+  Copyright (c) 2026 Red Hat, Inc. <http://www.redhat.com>
+  This file is part of GlusterFS.
+
+  This file is licensed to you under your choice of the GNU Lesser
+  General Public License, version 3 or any later version (LGPLv3 or
+  later), or the GNU General Public License, version 2 (GPLv2), in all
+  cases as published by the Free Software Foundation.
+*/
+
+#include <sys/file.h>
+#include <sys/mman.h>
+#include <signal.h>
+
+#include <glusterfs/syscall.h>
+
+#include "quick-read.h"
+#include "quick-read-messages.h"
+
+/* slots start on the cache line after the header */
+#define QR_SHM_SLOTS_OFFSET 64
+
+/* of a segment being created by another process */
+#define QR_SHM_ATTACH_TRIES 100
+
+/* segments attached by the process, for qr_shm_exit() */
+static pthread_mutex_t qr_shm_mutex = PTHREAD_MUTEX_INITIALIZER;
+static struct list_head qr_shm_list = {&qr_shm_list, &qr_shm_list};
+
+static struct qr_shm_slot *
+qr_shm_slot(qr_shm_t *shm, uint32_t idx)
+{
+    return (struct qr_shm_slot *)((char *)shm->base + QR_SHM_SLOTS_OFFSET +
+                                  (size_t)idx * shm->header->slot_stride);
+}
+
+/* first slot of the set of @gfid. gfids are random, any 8 bytes of them
+ * make a good hash. */
+static uint32_t
+qr_shm_set(qr_shm_t *shm, uuid_t gfid)
+{
+    uint64_t hash = 0;
+
+    memcpy(&hash, gfid + 8, sizeof(hash));
+
+    return (hash % (shm->header->slot_count / QR_SHM_WAYS)) * QR_SHM_WAYS;
+}
+
+/* Take the slot for writing, or fail without waiting if another process
+ * has it. A slot left locked by a process which died is taken over. */
+static gf_boolean_t
+qr_shm_slot_lock(struct qr_shm_slot *slot)
+{
+    uint32_t owner = 0;
+    uint32_t self = getpid();
+
+    if (!__atomic_compare_exchange_n(&slot->lock, &owner, self, _gf_false,
+                                     __ATOMIC_ACQUIRE, __ATOMIC_RELAXED)) {
+        if ((kill(owner, 0) == 0) || (errno != ESRCH))
+            return _gf_false;
+
+        if (!__atomic_compare_exchange_n(&slot->lock, &owner, self, _gf_false,
+                                         __ATOMIC_ACQUIRE, __ATOMIC_RELAXED))
+            return _gf_false;
+    }
+
+    /* the dead owner may have left it odd already */
+    if (!(slot->seq & 1))
+        __atomic_store_n(&slot->seq, slot->seq + 1, __ATOMIC_RELAXED);
+    __atomic_thread_fence(__ATOMIC_RELEASE);
+
+    return _gf_true;
+}
+
+static void
+qr_shm_slot_unlock(struct qr_shm_slot *slot)
+{
+    __atomic_store_n(&slot->seq, slot->seq + 1, __ATOMIC_RELEASE);
+    __atomic_store_n(&slot->lock, 0, __ATOMIC_RELEASE);
+}
+
+static gf_boolean_t
+qr_shm_slot_matches(struct qr_shm_slot *slot, struct iatt *buf,
+                    gf_boolean_t use_ctime)
+{
+    if (slot->ia_size != buf->ia_size)
+        return _gf_false;
+
+    if (use_ctime)
+        return (slot->ia_ctime == buf->ia_ctime &&
+                slot->ia_ctime_nsec == buf->ia_ctime_nsec);
+
+    return (slot->ia_mtime == buf->ia_mtime &&
+            slot->ia_mtime_nsec == buf->ia_mtime_nsec);
+}
+
+static int
+qr_shm_init_header(qr_shm_t *shm, uint64_t slot_size)
+{
+    struct qr_shm_header *header = shm->header;
+    uint64_t stride = 0;
+    uint64_t count = 0;
+
+    stride = gf_roof(sizeof(struct qr_shm_slot) + slot_size, 64);
+    count = (shm->size - QR_SHM_SLOTS_OFFSET) / stride;
+    count -= count % QR_SHM_WAYS;
+    if (!count || (count > UINT32_MAX))
+        return -1;
+
+    header->version = QR_SHM_VERSION;
+    header->size = shm->size;
+    header->slot_count = count;
+    header->slot_size = slot_size;
+    header->slot_stride = stride;
+    header->clock = 0;
+
+    __atomic_store_n(&header->magic, QR_SHM_MAGIC, __ATOMIC_RELEASE);
+
+    return 0;
+}
+
+/* Opens the segment, creating it if needed, and initializes or maps it.
+ * Returns -EAGAIN when the segment went away or is being created by
+ * another process in the meantime. */
+static int
+qr_shm_open(qr_shm_t *shm, uint64_t size, uint64_t slot_size)
+{
+    struct stat stbuf = {
+        0,
+    };
+    struct stat pathbuf = {
+        0,
+    };
+    gf_boolean_t created = _gf_false;
+    int fd = -1;
+    int ret = -1;
+
+    fd = open(shm->path, O_RDWR | O_CLOEXEC);
+    if ((fd < 0) && (errno == ENOENT)) {
+        fd = open(shm->path, O_RDWR | O_CREAT | O_EXCL | O_CLOEXEC, 0600);
+        if ((fd < 0) && (errno == EEXIST))
+            return -EAGAIN;
+        created = _gf_true;
+    }
+    if (fd < 0)
+        return -errno;
+
+    if ((flock(fd, LOCK_SH) < 0) || (fstat(fd, &stbuf) < 0)) {
+        ret = -errno;
+        goto err;
+    }
+
+    /* removed by the last user while we were opening it */
+    if ((sys_stat(shm->path, &pathbuf) < 0) ||
+        (pathbuf.st_dev != stbuf.st_dev) || (pathbuf.st_ino != stbuf.st_ino)) {
+        ret = -EAGAIN;
+        goto err;
+    }
+
+    /* the content of the cached files is no one else's business */
+    if ((stbuf.st_uid != geteuid()) || (stbuf.st_mode & 077)) {
+        ret = -EPERM;
+        goto err;
+    }
+
+    if (created) {
+        shm->size = size;
+        if (ftruncate(fd, shm->size) < 0) {
+            ret = -errno;
+            goto err;
+        }
+    } else if (stbuf.st_size < QR_SHM_SLOTS_OFFSET) {
+        goto stale;
+    } else {
+        shm->size = stbuf.st_size;
+    }
+
+    shm->base = mmap(NULL, shm->size, PROT_READ | PROT_WRITE, MAP_SHARED, fd,
+                     0);
+    if (shm->base == MAP_FAILED) {
+        shm->base = NULL;
+        ret = -errno;
+        goto err;
+    }
+    shm->header = shm->base;
+
+    if (created) {
+        /* left as is on failure, for the next one to replace */
+        if (qr_shm_init_header(shm, slot_size) < 0) {
+            ret = -EINVAL;
+            goto err;
+        }
+    } else if ((__atomic_load_n(&shm->header->magic, __ATOMIC_ACQUIRE) !=
+                QR_SHM_MAGIC) ||
+               (shm->header->version != QR_SHM_VERSION) ||
+               (shm->header->size != shm->size)) {
+        goto stale;
+    }
+
+    shm->fd = fd;
+
+    return 0;
+
+stale:
+    /* Still being created, left over by a process which died while
+     * creating it, or by an incompatible version. Replaced only if nobody
+     * uses it, otherwise retried until its creator is done with it. */
+    if (flock(fd, LOCK_EX | LOCK_NB) == 0)
+        sys_unlink(shm->path);
+    ret = -EAGAIN;
+err:
+    if (shm->base) {
+        munmap(shm->base, shm->size);
+        shm->base = NULL;
+        shm->header = NULL;
+    }
+    sys_close(fd);
+
+    return ret;
+}
+
+qr_shm_t *
+qr_shm_attach(xlator_t *this, uint64_t size, uint64_t slot_size)
+{
+    qr_shm_t *shm = NULL;
+    char *volume_id = NULL;
+    int tries = 0;
+    int ret = -1;
+
+    shm = GF_CALLOC(1, sizeof(*shm), gf_qr_mt_qr_shm_t);
+    if (!shm)
+        goto out;
+
+    INIT_LIST_HEAD(&shm->list);
+    shm->fd = -1;
+    GF_ATOMIC_INIT(shm->hits, 0);
+    GF_ATOMIC_INIT(shm->misses, 0);
+    GF_ATOMIC_INIT(shm->stores, 0);
+
+    /* the volume name may be reused by another volume, or differ between
+     * the client graphs of the same volume, its id does not */
+    if (dict_get_str_sizen(this->options, "volume-id", &volume_id) != 0)
+        volume_id = this->name;
+
+    ret = gf_asprintf(&shm->path, QR_SHM_DIR "/glusterfs-qr-%s", volume_id);
+    if (ret < 0)
+        goto out;
+
+    for (tries = 0; tries < QR_SHM_ATTACH_TRIES; tries++) {
+        ret = qr_shm_open(shm, size, slot_size);
+        if (ret != -EAGAIN)
+            break;
+        usleep(1000);
+    }
+    if (ret < 0) {
+        gf_msg(this->name, GF_LOG_WARNING, (ret == -EAGAIN) ? EPROTO : -ret,
+               QUICK_READ_MSG_SHARED_CACHE_FAILED,
+               "cannot attach to the shared cache %s", shm->path);
+        goto out;
+    }
+
+    pthread_mutex_lock(&qr_shm_mutex);
+    {
+        list_add_tail(&shm->list, &qr_shm_list);
+    }
+    pthread_mutex_unlock(&qr_shm_mutex);
+
+    gf_msg_debug(this->name, 0, "attached to %s: %u slots of %u bytes",
+                 shm->path, shm->header->slot_count, shm->header->slot_size);
+
+out:
+    if (ret < 0 && shm) {
+        GF_FREE(shm->path);
+        GF_FREE(shm);
+        shm = NULL;
+    }
+
+    return shm;
+}
+
+/* The last one out removes the segment, which would otherwise hold on to
+ * its memory. Our own shared lock is dropped on the way, so of several
+ * processes leaving at once one is granted the exclusive lock. */
+static void
+qr_shm_release(qr_shm_t *shm)
+{
+    if (flock(shm->fd, LOCK_EX | LOCK_NB) == 0)
+        sys_unlink(shm->path);
+
+    sys_close(shm->fd);
+    shm->fd = -1;
+}
+
+void
+qr_shm_detach(qr_shm_t *shm)
+{
+    if (!shm)
+        return;
+
+    pthread_mutex_lock(&qr_shm_mutex);
+    {
+        list_del_init(&shm->list);
+        if (shm->fd >= 0)
+            qr_shm_release(shm);
+    }
+    pthread_mutex_unlock(&qr_shm_mutex);
+
+    munmap(shm->base, shm->size);
+    GF_FREE(shm->path);
+    GF_FREE(shm);
+}
+
+/* FUSE exits without calling fini() of the graph. The segments the process
+ * is still attached to are let go of here, their mappings are left to the
+ * exit as other threads may still be reading them. */
+static void __attribute__((destructor))
+qr_shm_exit(void)
+{
+    qr_shm_t *shm = NULL;
+    qr_shm_t *tmp = NULL;
+
+    pthread_mutex_lock(&qr_shm_mutex);
+    {
+        list_for_each_entry_safe(shm, tmp, &qr_shm_list, list)
+        {
+            list_del_init(&shm->list);
+            qr_shm_release(shm);
+        }
+    }
+    pthread_mutex_unlock(&qr_shm_mutex);
+}
+
+gf_boolean_t
+qr_shm_lookup(qr_shm_t *shm, uuid_t gfid)
+{
+    struct qr_shm_slot *slot = NULL;
+    uint32_t set = 0;
+    uint32_t i = 0;
+
+    set = qr_shm_set(shm, gfid);
+    for (i = 0; i < QR_SHM_WAYS; i++) {
+        slot = qr_shm_slot(shm, set + i);
+        if (!gf_uuid_compare(slot->gfid, gfid))
+            return _gf_true;
+    }
+
+    return _gf_false;
+}
+
+/* Returns a copy of the content of the file, or NULL if it isn't cached or
+ * doesn't match @buf. */
+void *
+qr_shm_get(qr_shm_t *shm, uuid_t gfid, struct iatt *buf,
+           gf_boolean_t use_ctime)
+{
+    struct qr_shm_slot *slot = NULL;
+    void *content = NULL;
+    uint64_t seq = 0;
+    uint32_t set = 0;
+    uint32_t i = 0;
+    gf_boolean_t stale = _gf_false;
+
+    if (!buf->ia_size || (buf->ia_size > shm->header->slot_size))
+        goto out;
+
+    set = qr_shm_set(shm, gfid);
+    for (i = 0; i < QR_SHM_WAYS; i++) {
+        slot = qr_shm_slot(shm, set + i);
+
+        seq = __atomic_load_n(&slot->seq, __ATOMIC_ACQUIRE);
+        if ((seq & 1) || gf_uuid_compare(slot->gfid, gfid))
+            continue;
+
+        if (!qr_shm_slot_matches(slot, buf, use_ctime)) {
+            stale = _gf_true;
+            continue;
+        }
+
+        content = GF_MALLOC(buf->ia_size, gf_qr_mt_content_t);
+        if (!content)
+            goto out;
+
+        memcpy(content, slot->data, buf->ia_size);
+
+        /* rewritten while we copied it? */
+        __atomic_thread_fence(__ATOMIC_ACQUIRE);
+        if (__atomic_load_n(&slot->seq, __ATOMIC_RELAXED) != seq) {
+            GF_FREE(content);
+            content = NULL;
+            continue;
+        }
+
+        break;
+    }
+
+    /* the file changed since it was cached */
+    if (!content && stale)
+        qr_shm_invalidate(shm, gfid);
+
+out:
+    if (content)
+        GF_ATOMIC_INC(shm->hits);
+    else
+        GF_ATOMIC_INC(shm->misses);
+
+    return content;
+}
+
+void
+qr_shm_put(qr_shm_t *shm, uuid_t gfid, struct iatt *buf, void *data)
+{
+    struct qr_shm_slot *slot = NULL;
+    struct qr_shm_slot *victim = NULL;
+    uint32_t set = 0;
+    uint32_t i = 0;
+
+    if (!buf->ia_size || (buf->ia_size > shm->header->slot_size))
+        return;
+
+    /* the same file, else an empty slot, else the oldest store */
+    set = qr_shm_set(shm, gfid);
+    for (i = 0; i < QR_SHM_WAYS; i++) {
+        slot = qr_shm_slot(shm, set + i);
+        if (!gf_uuid_compare(slot->gfid, gfid)) {
+            victim = slot;
+            break;
+        }
+
+        if (!victim || (gf_uuid_is_null(slot->gfid) &&
+                        !gf_uuid_is_null(victim->gfid))) {
+            victim = slot;
+            continue;
+        }
+
+        if (!gf_uuid_is_null(victim->gfid) && (slot->stamp < victim->stamp))
+            victim = slot;
+    }
+
+    if (!qr_shm_slot_lock(victim))
+        return;
+
+    gf_uuid_copy(victim->gfid, gfid);
+    victim->ia_size = buf->ia_size;
+    victim->ia_mtime = buf->ia_mtime;
+    victim->ia_mtime_nsec = buf->ia_mtime_nsec;
+    victim->ia_ctime = buf->ia_ctime;
+    victim->ia_ctime_nsec = buf->ia_ctime_nsec;
+    victim->stamp = __atomic_add_fetch(&shm->header->clock, 1,
+                                       __ATOMIC_RELAXED);
+    memcpy(victim->data, data, buf->ia_size);
+
+    qr_shm_slot_unlock(victim);
+
+    GF_ATOMIC_INC(shm->stores);
+}
+
+void
+qr_shm_invalidate(qr_shm_t *shm, uuid_t gfid)
+{
+    struct qr_shm_slot *slot = NULL;
+    uint32_t set = 0;
+    uint32_t i = 0;
+
+    set = qr_shm_set(shm, gfid);
+    for (i = 0; i < QR_SHM_WAYS; i++) {
+        slot = qr_shm_slot(shm, set + i);
+        if (gf_uuid_compare(slot->gfid, gfid))
+            continue;
+
+        /* a concurrent writer stores content it validated itself, a
+         * stale copy of it gets caught by qr_shm_get() */
+        if (!qr_shm_slot_lock(slot))
+            continue;
+
+        if (!gf_uuid_compare(slot->gfid, gfid))
+            gf_uuid_clear(slot->gfid);
+
+        qr_shm_slot_unlock(slot);
+    }
+}
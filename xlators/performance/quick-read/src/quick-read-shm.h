@@ -0,0 +1,94 @@
+/*
+  Copyright (c) 2026 Red Hat, Inc. <http://www.redhat.com>
+  This file is part of GlusterFS.
+
+  This file is licensed to you under your choice of the GNU Lesser
+  General Public License, version 3 or any later version (LGPLv3 or
+  later), or the GNU General Public License, version 2 (GPLv2), in all
+  cases as published by the Free Software Foundation.
+*/
+
+#ifndef __QUICK_READ_SHM_H
+#define __QUICK_READ_SHM_H
+
+#include <glusterfs/glusterfs.h>
+#include <glusterfs/iatt.h>
+
+/* Host wide cache of small file content, shared by all the client processes
+ * of a volume (FUSE mount, gfapi consumers) through a segment in /dev/shm.
+ *
+ * The segment is an array of fixed size slots, each holding the content of
+ * one file along with its gfid and the times and size it had when cached.
+ * A gfid hashes to a set of QR_SHM_WAYS slots. Every slot is protected by a
+ * sequence number, odd while a process writes the slot, so that readers
+ * never take a lock and a writer only skips a slot somebody else is
+ * writing. Content is used only when it matches a fresh iatt of the file,
+ * the invalidations only save the checks that would fail.
+ *
+ * The segment is named after the volume id. Each attachment holds a shared
+ * flock on it, which the kernel drops however the process ends, so that
+ * whoever gets the lock exclusive knows nobody uses the segment anymore. */
+
+#define QR_SHM_MAGIC 0x51525348 /* "QRSH" */
+#define QR_SHM_VERSION 2
+#define QR_SHM_WAYS 4
+#define QR_SHM_DIR "/dev/shm"
+
+struct qr_shm_header {
+    uint32_t magic;
+    uint32_t version;
+    uint64_t size;       /* of the whole segment */
+    uint32_t slot_count; /* a multiple of QR_SHM_WAYS */
+    uint32_t slot_size;  /* of the content of a slot */
+    uint32_t slot_stride;
+    uint32_t reserved;
+    uint64_t clock; /* bumped on each store, for the slot stamps */
+};
+
+struct qr_shm_slot {
+    uint64_t seq;  /* odd while being written */
+    uint32_t lock; /* pid of the writer, 0 if none */
+    uint32_t ia_mtime;
+    uint32_t ia_mtime_nsec;
+    uint32_t ia_ctime;
+    uint32_t ia_ctime_nsec;
+    uint32_t pad;
+    uint64_t ia_size;
+    uint64_t stamp; /* header clock at store */
+    uuid_t gfid;    /* null if the slot is empty */
+    char data[];
+};
+
+struct qr_shm {
+    struct list_head list; /* in the segments attached by the process */
+    char *path;
+    int fd; /* holds the shared lock */
+    void *base;
+    size_t size;
+    struct qr_shm_header *header;
+    gf_atomic_t hits;
+    gf_atomic_t misses;
+    gf_atomic_t stores;
+};
+typedef struct qr_shm qr_shm_t;
+
+qr_shm_t *
+qr_shm_attach(xlator_t *this, uint64_t size, uint64_t slot_size);
+
+void
+qr_shm_detach(qr_shm_t *shm);
+
+gf_boolean_t
+qr_shm_lookup(qr_shm_t *shm, uuid_t gfid);
+
+void *
+qr_shm_get(qr_shm_t *shm, uuid_t gfid, struct iatt *buf,
+           gf_boolean_t use_ctime);
+
+void
+qr_shm_put(qr_shm_t *shm, uuid_t gfid, struct iatt *buf, void *data);
+
+void
+qr_shm_invalidate(qr_shm_t *shm, uuid_t gfid);
+
+#endif /* __QUICK_READ_SHM_H */
@@ -19,6 +19,7 @@ typedef struct qr_local {
     inode_t *inode;
     uint64_t incident_gen;
     fd_t *fd;
+    gf_boolean_t shm_probe; /* content may be in the shared cache */
 } qr_local_t;
 
 qr_inode_t *
@@ -349,6 +350,22 @@ qr_inode_prune(xlator_t *this, inode_t *inode, uint64_t gen)
     UNLOCK(&table->lock);
 }
 
+/* The content of the file changed: drop it from this process and from the
+ * shared cache, so that the other processes need not find out through a
+ * mismatching iatt. */
+static void
+qr_inode_invalidate(xlator_t *this, inode_t *inode, uint64_t gen)
+{
+    qr_private_t *priv = NULL;
+
+    priv = this->private;
+
+    qr_inode_prune(this, inode, gen);
+
+    if (priv->shm && !gf_uuid_is_null(inode->gfid))
+        qr_shm_invalidate(priv->shm, inode->gfid);
+}
+
 /* To be called with priv->table.lock held */
 void
 __qr_cache_prune(xlator_t *this, qr_inode_table_t *table, qr_conf_t *conf)
@@ -573,9 +590,13 @@ qr_lookup_cbk(call_frame_t *frame, void *cookie, xlator_t *this, int32_t op_ret,
     qr_inode_t *qr_inode = NULL;
     inode_t *inode = NULL;
     qr_local_t *local = NULL;
+    qr_private_t *priv = NULL;
+    qr_conf_t *conf = NULL;
 
     local = frame->local;
     inode = local->inode;
+    priv = this->private;
+    conf = &priv->conf;
 
     if (op_ret == -1) {
         qr_inode_prune(this, inode, local->incident_gen);
@@ -594,6 +615,16 @@ qr_lookup_cbk(call_frame_t *frame, void *cookie, xlator_t *this, int32_t op_ret,
 
     content = qr_content_extract(xdata);
 
+    if (content) {
+        if (conf->shared_cache && priv->shm)
+            qr_shm_put(priv->shm, buf->ia_gfid, buf, content);
+    } else if (local->shm_probe && IA_ISREG(buf->ia_type) &&
+               qr_size_fits(conf, buf)) {
+        /* another process of this host read it already */
+        content = qr_shm_get(priv->shm, buf->ia_gfid, buf,
+                             conf->ctime_invalidation);
+    }
+
     if (content) {
         /* new content came along, always replace old content */
         qr_inode = qr_inode_ctx_get_or_new(this, inode);
@@ -619,6 +650,27 @@ out:
     return 0;
 }
 
+static gf_boolean_t
+qr_shm_probe(xlator_t *this, loc_t *loc)
+{
+    qr_private_t *priv = NULL;
+    unsigned char *gfid = NULL;
+
+    priv = this->private;
+
+    if (!priv->conf.shared_cache || !priv->shm)
+        return _gf_false;
+
+    if (!gf_uuid_is_null(loc->inode->gfid))
+        gfid = loc->inode->gfid;
+    else if (!gf_uuid_is_null(loc->gfid))
+        gfid = loc->gfid;
+    else
+        return _gf_false;
+
+    return qr_shm_lookup(priv->shm, gfid);
+}
+
 int
 qr_lookup(call_frame_t *frame, xlator_t *this, loc_t *loc, dict_t *xdata)
 {
@@ -640,6 +692,12 @@ qr_lookup(call_frame_t *frame, xlator_t *this, loc_t *loc, dict_t *xdata)
         /* cached. only validate in qr_lookup_cbk */
         goto wind;
 
+    if (qr_shm_probe(this, loc)) {
+        /* cached by another process. only validate in qr_lookup_cbk */
+        local->shm_probe = _gf_true;
+        goto wind;
+    }
+
     if (!xdata)
         xdata = new_xdata = dict_new();
 
@@ -815,7 +873,7 @@ qr_writev_cbk(call_frame_t *frame, void *cookie, xlator_t *this, int32_t op_ret,
 
     local = frame->local;
 
-    qr_inode_prune(this, local->fd->inode, local->incident_gen);
+    qr_inode_invalidate(this, local->fd->inode, local->incident_gen);
 
     QR_STACK_UNWIND(writev, frame, op_ret, op_errno, prebuf, postbuf, xdata);
     return 0;
@@ -847,7 +905,7 @@ qr_truncate_cbk(call_frame_t *frame, void *cookie, xlator_t *this,
     qr_local_t *local = NULL;
 
     local = frame->local;
-    qr_inode_prune(this, local->inode, local->incident_gen);
+    qr_inode_invalidate(this, local->inode, local->incident_gen);
 
     QR_STACK_UNWIND(truncate, frame, op_ret, op_errno, prebuf, postbuf, xdata);
     return 0;
@@ -876,7 +934,7 @@ qr_ftruncate_cbk(call_frame_t *frame, void *cookie, xlator_t *this,
     qr_local_t *local = NULL;
 
     local = frame->local;
-    qr_inode_prune(this, local->fd->inode, local->incident_gen);
+    qr_inode_invalidate(this, local->fd->inode, local->incident_gen);
 
     QR_STACK_UNWIND(ftruncate, frame, op_ret, op_errno, prebuf, postbuf, xdata);
     return 0;
@@ -905,7 +963,7 @@ qr_fallocate_cbk(call_frame_t *frame, void *cookie, xlator_t *this,
     qr_local_t *local = NULL;
 
     local = frame->local;
-    qr_inode_prune(this, local->fd->inode, local->incident_gen);
+    qr_inode_invalidate(this, local->fd->inode, local->incident_gen);
 
     QR_STACK_UNWIND(fallocate, frame, op_ret, op_errno, pre, post, xdata);
     return 0;
@@ -935,7 +993,7 @@ qr_discard_cbk(call_frame_t *frame, void *cookie, xlator_t *this,
     qr_local_t *local = NULL;
 
     local = frame->local;
-    qr_inode_prune(this, local->fd->inode, local->incident_gen);
+    qr_inode_invalidate(this, local->fd->inode, local->incident_gen);
 
     QR_STACK_UNWIND(discard, frame, op_ret, op_errno, pre, post, xdata);
     return 0;
@@ -964,7 +1022,7 @@ qr_zerofill_cbk(call_frame_t *frame, void *cookie, xlator_t *this,
     qr_local_t *local = NULL;
 
     local = frame->local;
-    qr_inode_prune(this, local->fd->inode, local->incident_gen);
+    qr_inode_invalidate(this, local->fd->inode, local->incident_gen);
 
     QR_STACK_UNWIND(zerofill, frame, op_ret, op_errno, pre, post, xdata);
     return 0;
@@ -1097,6 +1155,16 @@ qr_priv_dump(xlator_t *this)
     gf_proc_dump_write("cache-invalidations", "%" GF_PRI_ATOMIC,
                        GF_ATOMIC_GET(priv->qr_counter.file_data_invals));
 
+    if (priv->shm) {
+        gf_proc_dump_write("shared_cache", "%s", priv->shm->path);
+        gf_proc_dump_write("shared-cache-hit", "%" GF_PRI_ATOMIC,
+                           GF_ATOMIC_GET(priv->shm->hits));
+        gf_proc_dump_write("shared-cache-miss", "%" GF_PRI_ATOMIC,
+                           GF_ATOMIC_GET(priv->shm->misses));
+        gf_proc_dump_write("shared-cache-store", "%" GF_PRI_ATOMIC,
+                           GF_ATOMIC_GET(priv->shm->stores));
+    }
+
 out:
     return 0;
 }
@@ -1121,6 +1189,15 @@ qr_dump_metrics(xlator_t *this, int fd)
     dprintf(fd, "%s.cache-invalidations %" PRId64 "\n", this->name,
             GF_ATOMIC_GET(priv->qr_counter.file_data_invals));
 
+    if (priv->shm) {
+        dprintf(fd, "%s.shared-cache-hit %" PRId64 "\n", this->name,
+                GF_ATOMIC_GET(priv->shm->hits));
+        dprintf(fd, "%s.shared-cache-miss %" PRId64 "\n", this->name,
+                GF_ATOMIC_GET(priv->shm->misses));
+        dprintf(fd, "%s.shared-cache-store %" PRId64 "\n", this->name,
+                GF_ATOMIC_GET(priv->shm->stores));
+    }
+
     return 0;
 }
 
@@ -1216,6 +1293,13 @@ qr_reconfigure(xlator_t *this, dict_t *options)
     }
     conf->cache_size = cache_size_new;
 
+    GF_OPTION_RECONF("shared-cache", conf->shared_cache, options, bool, out);
+    if (conf->shared_cache && !priv->shm && conf->max_file_size)
+        /* the segment, once attached, stays until fini, turning the
+         * option off only stops using it */
+        priv->shm = qr_shm_attach(this, conf->shared_cache_size,
+                                  conf->max_file_size);
+
     ret = 0;
 out:
     return ret;
@@ -1363,6 +1447,11 @@ qr_init(xlator_t *this)
 
     GF_OPTION_INIT("ctime-invalidation", conf->ctime_invalidation, bool, out);
 
+    GF_OPTION_INIT("shared-cache", conf->shared_cache, bool, out);
+
+    GF_OPTION_INIT("shared-cache-size", conf->shared_cache_size, size_uint64,
+                   out);
+
     INIT_LIST_HEAD(&conf->priority_list);
     conf->max_pri = 1;
     if (dict_get(this->options, "priority")) {
@@ -1392,6 +1481,12 @@ qr_init(xlator_t *this)
 
     priv->last_child_down = gf_time();
     GF_ATOMIC_INIT(priv->generation, 0);
+
+    /* not fatal, the cache of this process works without it */
+    if (conf->shared_cache && conf->max_file_size)
+        priv->shm = qr_shm_attach(this, conf->shared_cache_size,
+                                  conf->max_file_size);
+
     this->private = priv;
 out:
     if ((ret == -1) && priv) {
@@ -1479,7 +1574,7 @@ qr_invalidate(xlator_t *this, void *data)
             ret = -1;
             goto out;
         }
-        qr_inode_prune(this, inode, qr_get_generation(this, inode));
+        qr_inode_invalidate(this, inode, qr_get_generation(this, inode));
     }
 
 out:
@@ -1534,6 +1629,7 @@ qr_fini(xlator_t *this)
 
     qr_inode_table_destroy(priv);
     qr_conf_destroy(&priv->conf);
+    qr_shm_detach(priv->shm);
 
     this->private = NULL;
 
@@ -1625,6 +1721,36 @@ struct volume_options qr_options[] = {
                        "changes to file data. So, use this only when mtime "
                        "is not reliable",
     },
+    {
+        .key = {"shared-cache"},
+        .type = GF_OPTION_TYPE_BOOL,
+        .default_value = "off",
+        .op_version = {GD_OP_VERSION_10_0},
+        .flags = OPT_FLAG_CLIENT_OPT | OPT_FLAG_SETTABLE | OPT_FLAG_DOC,
+        .description = "Share the content of small files between the client "
+                       "processes of a host (mounts and gfapi applications "
+                       "of the same user) through a segment in /dev/shm. A "
+                       "process can then serve a file another one read, "
+                       "after checking it against a fresh lookup.",
+    },
+    {
+        .key = {"shared-cache-size"},
+        .type = GF_OPTION_TYPE_SIZET,
+        .min = 1 * GF_UNIT_MB,
+        .max = 4 * GF_UNIT_GB,
+        .default_value = "64MB",
+        .op_version = {GD_OP_VERSION_10_0},
+        .flags = OPT_FLAG_CLIENT_OPT | OPT_FLAG_SETTABLE | OPT_FLAG_DOC,
+        .description = "Size of the segment of shared-cache. It is set by "
+                       "the first process to attach to it.",
+    },
+    {
+        .key = {"volume-id"},
+        .type = GF_OPTION_TYPE_STR,
+        .op_version = {GD_OP_VERSION_10_0},
+        .description = "UUID of the volume, which names the segment of "
+                       "shared-cache.",
+    },
     {.key = {NULL}}};
 
 xlator_api_t xlator_api = {
@@ -28,6 +28,7 @@
 #include <unistd.h>
 #include <fnmatch.h>
 #include "quick-read-mem-types.h"
+#include "quick-read-shm.h"
 
 struct qr_inode {
     void *data;
@@ -60,6 +61,8 @@ struct qr_conf {
     int max_pri;
     gf_boolean_t qr_invalidation;
     gf_boolean_t ctime_invalidation;
+    gf_boolean_t shared_cache;
+    uint64_t shared_cache_size;
     struct list_head priority_list;
 };
 typedef struct qr_conf qr_conf_t;
@@ -85,6 +88,7 @@ struct qr_private {
     gf_lock_t lock;
     struct qr_statistics qr_counter;
     gf_atomic_int32_t generation;
+    qr_shm_t *shm; /* host wide cache, NULL unless shared-cache is on */
 };
 typedef struct qr_private qr_private_t;
 
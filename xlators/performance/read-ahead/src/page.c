@@ -135,6 +135,8 @@ ra_fault_cbk(call_frame_t *frame, void *cookie, xlator_t *this, int32_t op_ret,
     fd_t *fd = NULL;
     uint64_t tmp_file = 0;
     gf_boolean_t stale = _gf_false;
+    struct timespec now;
+    int64_t rtt = 0;
 
     GF_ASSERT(frame);
 
@@ -155,10 +157,16 @@ ra_fault_cbk(call_frame_t *frame, void *cookie, xlator_t *this, int32_t op_ret,
         goto out;
     }
 
+    timespec_now(&now);
+    rtt = gf_tsdiff(&local->start, &now);
+
     ra_file_lock(file);
     {
-        if (op_ret >= 0)
+        if (op_ret >= 0) {
             file->stbuf = *stbuf;
+            /* moving average over the last 8 or so faults */
+            file->rtt = file->rtt ? file->rtt + (rtt - file->rtt) / 8 : rtt;
+        }
 
         page = ra_page_get(file, pending_offset);
 
@@ -223,6 +231,7 @@ unlock:
     ra_file_unlock(file);
 
     if (stale) {
+        timespec_now(&local->start);
         STACK_WIND(frame, ra_fault_cbk, FIRST_CHILD(frame->this),
                    FIRST_CHILD(frame->this)->fops->readv, local->fd,
                    local->pending_size, local->pending_offset, 0, NULL);
@@ -274,6 +283,7 @@ ra_page_fault(ra_file_t *file, call_frame_t *frame, off_t offset)
     fault_local->pending_size = file->page_size;
 
     fault_local->fd = fd_ref(file->fd);
+    timespec_now(&fault_local->start);
 
     STACK_WIND(fault_frame, ra_fault_cbk, FIRST_CHILD(fault_frame->this),
                FIRST_CHILD(fault_frame->this)->fops->readv, file->fd,
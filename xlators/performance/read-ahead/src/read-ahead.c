@@ -26,7 +26,7 @@
 #include "read-ahead-messages.h"
 
 static void
-read_ahead(call_frame_t *frame, ra_file_t *file);
+ra_file_reset_streams(ra_file_t *file);
 
 int
 ra_open_cbk(call_frame_t *frame, void *cookie, xlator_t *this, int32_t op_ret,
@@ -57,7 +57,6 @@ ra_open_cbk(call_frame_t *frame, void *cookie, xlator_t *this, int32_t op_ret,
     if ((fd->flags & O_DIRECT) || ((fd->flags & O_ACCMODE) == O_WRONLY))
         file->disabled = 1;
 
-    file->offset = (unsigned long long)0;
     file->conf = conf;
     file->pages.next = &file->pages;
     file->pages.prev = &file->pages;
@@ -74,12 +73,11 @@ ra_open_cbk(call_frame_t *frame, void *cookie, xlator_t *this, int32_t op_ret,
     ra_conf_unlock(conf);
 
     file->fd = fd;
-    file->page_count = conf->page_count;
     file->page_size = conf->page_size;
     pthread_mutex_init(&file->file_lock, NULL);
 
     if (!file->disabled) {
-        file->page_count = 1;
+        ra_file_reset_streams(file);
     }
 
     ret = fd_ctx_set(fd, this, (uint64_t)(long)file);
@@ -131,7 +129,6 @@ ra_create_cbk(call_frame_t *frame, void *cookie, xlator_t *this, int32_t op_ret,
     if ((fd->flags & O_DIRECT) || ((fd->flags & O_ACCMODE) == O_WRONLY))
         file->disabled = 1;
 
-    file->offset = (unsigned long long)0;
     // file->size = fd->inode->buf.ia_size;
     file->conf = conf;
     file->pages.next = &file->pages;
@@ -149,7 +146,6 @@ ra_create_cbk(call_frame_t *frame, void *cookie, xlator_t *this, int32_t op_ret,
     ra_conf_unlock(conf);
 
     file->fd = fd;
-    file->page_count = conf->page_count;
     file->page_size = conf->page_size;
     pthread_mutex_init(&file->file_lock, NULL);
 
@@ -250,28 +246,261 @@ out:
     return 0;
 }
 
-void
-read_ahead(call_frame_t *frame, ra_file_t *file)
+/* Forget the access pattern. The first stream starts out at offset 0, so
+ * that reading a freshly opened file from its start is sequential from the
+ * first read. */
+static void
+ra_file_reset_streams(ra_file_t *file)
+{
+    memset(file->streams, 0, sizeof(file->streams));
+    file->streams[0].used = ++file->seq;
+    file->streams[0].window = 1;
+}
+
+/* Find the stream a read at @offset belongs to, learning a new stride or
+ * starting a new stream if none matches. Called with the file lock held. */
+static ra_stream_t *
+__ra_stream_get(ra_file_t *file, off_t offset, size_t size)
+{
+    ra_stream_t *stream = NULL;
+    ra_stream_t *victim = NULL;
+    struct timespec now;
+    off_t delta = 0;
+    int i = 0;
+
+    for (i = 0; i < RA_MAX_STREAMS; i++) {
+        stream = &file->streams[i];
+        if (!stream->used)
+            continue;
+
+        if (offset == stream->offset + stream->size) {
+            stream->stride = 0;
+            stream->matched++;
+            goto found;
+        }
+
+        if (stream->stride && (offset == stream->offset + stream->stride)) {
+            stream->matched++;
+            goto found;
+        }
+    }
+
+    /* a second read near a lone one gives the stride of a new stream */
+    for (i = 0; i < RA_MAX_STREAMS; i++) {
+        stream = &file->streams[i];
+        if (!stream->used || stream->matched)
+            continue;
+
+        delta = offset - stream->offset;
+        if (delta && (delta <= RA_MAX_STRIDE) && (delta >= -RA_MAX_STRIDE)) {
+            stream->stride = delta;
+            stream->matched = 1;
+            goto found;
+        }
+    }
+
+    for (i = 0; i < RA_MAX_STREAMS; i++) {
+        stream = &file->streams[i];
+        if (!victim || (stream->used < victim->used))
+            victim = stream;
+    }
+
+    stream = victim;
+    memset(stream, 0, sizeof(*stream));
+    stream->window = 1;
+
+found:
+    timespec_now(&now);
+    if (stream->matched) {
+        delta = gf_tsdiff(&stream->last, &now);
+        stream->gap = stream->gap ? stream->gap + (delta - stream->gap) / 8
+                                  : delta;
+    }
+
+    stream->last = now;
+    stream->offset = offset;
+    stream->size = size;
+    stream->used = ++file->seq;
+
+    return stream;
+}
+
+/* Size the prefetch window of a stream after one of its reads, @late
+ * being the number of pages of the read which were not there yet. The
+ * window has to cover the reads issued while a page fault is in flight,
+ * that is the fault latency over the time between two reads. It doubles
+ * when the prefetch falls behind and shrinks back slowly while all reads
+ * hit. Called with the file lock held. */
+static void
+__ra_stream_adapt(ra_file_t *file, ra_stream_t *stream, int late)
+{
+    uint32_t limit = file->conf->page_count;
+    uint64_t target = stream->window;
+    uint64_t pages = 0;
+
+    pages = gf_roof(stream->size, file->page_size) / file->page_size;
+    if (stream->gap > 0)
+        target = (file->rtt / stream->gap + 1) * max(pages, 1);
+
+    target = min(max(target, 1), limit);
+
+    if (late) {
+        stream->hits = 0;
+        stream->window = min(stream->window * 2, limit);
+    } else if (++stream->hits >= RA_SHRINK_HITS) {
+        stream->hits = 0;
+        if (stream->window > target)
+            stream->window--;
+    }
+
+    stream->window = max(stream->window, target);
+}
+
+/* Pages of a stream worth keeping: those of its last read and those its
+ * next reads are predicted to touch. */
+static void
+ra_stream_zone(ra_file_t *file, ra_stream_t *stream, off_t *start, off_t *end)
+{
+    off_t far = 0;
+
+    *start = gf_floor(stream->offset, file->page_size);
+    *end = stream->offset + stream->size;
+
+    if (!stream->stride) {
+        *end += 2 * stream->window * file->page_size;
+        return;
+    }
+
+    far = stream->offset + (off_t)(stream->window + 1) * stream->stride;
+    *start = min(*start, gf_floor(max(far, 0), file->page_size));
+    *end = max(*end, far + (off_t)stream->size);
+}
+
+/* Drop the cached pages no stream is going to read. This replaces flushing
+ * the whole file on every non sequential read, which made interleaved
+ * streams throw away each other's read-ahead. */
+static void
+ra_file_trim(ra_file_t *file)
+{
+    ra_conf_t *conf = file->conf;
+    ra_page_t *trav = NULL;
+    ra_page_t *next = NULL;
+    off_t start[RA_MAX_STREAMS];
+    off_t end[RA_MAX_STREAMS];
+    int count = 0;
+    int i = 0;
+
+    ra_file_lock(file);
+    {
+        for (i = 0; i < RA_MAX_STREAMS; i++) {
+            if (!file->streams[i].used)
+                continue;
+            ra_stream_zone(file, &file->streams[i], &start[count],
+                           &end[count]);
+            count++;
+        }
+
+        for (trav = file->pages.next; trav != &file->pages; trav = next) {
+            next = trav->next;
+
+            /* in flight or waited for, left to its fault */
+            if (trav->waitq || !trav->ready)
+                continue;
+
+            for (i = 0; i < count; i++) {
+                if ((trav->offset >= start[i]) && (trav->offset < end[i]))
+                    break;
+            }
+
+            if (i < count)
+                continue;
+
+            if (trav->dirty)
+                GF_ATOMIC_INC(conf->ra_counter.prefetch_wasted);
+            ra_page_purge(trav);
+        }
+    }
+    ra_file_unlock(file);
+}
+
+/* Returns -1 when out of memory */
+static int
+ra_prefetch_page(call_frame_t *frame, ra_file_t *file, off_t offset)
+{
+    ra_page_t *trav = NULL;
+    char fault = 0;
+
+    ra_file_lock(file);
+    {
+        trav = ra_page_get(file, offset);
+        if (!trav) {
+            fault = 1;
+            trav = ra_page_create(file, offset);
+            if (trav)
+                trav->dirty = 1;
+        }
+    }
+    ra_file_unlock(file);
+
+    if (!trav)
+        return -1;
+
+    if (fault) {
+        gf_msg_trace(frame->this->name, 0, "RA at offset=%" PRId64, offset);
+        GF_ATOMIC_INC(file->conf->ra_counter.prefetched);
+        ra_page_fault(file, frame, offset);
+    }
+
+    return 0;
+}
+
+static void
+read_ahead(call_frame_t *frame, ra_file_t *file, ra_stream_t *stream)
 {
     off_t ra_offset = 0;
     size_t ra_size = 0;
     off_t trav_offset = 0;
+    off_t next = 0;
+    off_t end = 0;
     ra_page_t *trav = NULL;
     off_t cap = 0;
-    char fault = 0;
+    uint32_t budget = 0;
 
     GF_VALIDATE_OR_GOTO("read-ahead", frame, out);
     GF_VALIDATE_OR_GOTO(frame->this->name, file, out);
 
-    if (!file->page_count) {
+    if (!stream->matched) {
+        goto out;
+    }
+
+    if (stream->stride) {
+        /* a stride is only trusted once it has been seen twice */
+        if (stream->matched < 2) {
+            goto out;
+        }
+
+        budget = stream->window;
+        cap = file->size ? file->size : GF_OFF_MAX;
+        for (next = stream->offset + stream->stride;
+             budget && (next >= 0) && (next < cap); next += stream->stride) {
+            end = min(next + (off_t)stream->size, cap);
+            for (trav_offset = gf_floor(next, file->page_size);
+                 budget && (trav_offset < end);
+                 trav_offset += file->page_size, budget--) {
+                if (ra_prefetch_page(frame, file, trav_offset))
+                    goto out;
+            }
+        }
+
         goto out;
     }
 
-    ra_size = file->page_size * file->page_count;
-    ra_offset = gf_floor(file->offset, file->page_size);
-    cap = file->size ? file->size : file->offset + ra_size;
+    next = stream->offset + stream->size;
+    ra_size = file->page_size * stream->window;
+    ra_offset = gf_floor(next, file->page_size);
+    cap = file->size ? file->size : next + ra_size;
 
-    while (ra_offset < min(file->offset + ra_size, cap)) {
+    while (ra_offset < min(next + ra_size, cap)) {
         ra_file_lock(file);
         {
             trav = ra_page_get(file, ra_offset);
@@ -294,29 +523,10 @@ read_ahead(call_frame_t *frame, ra_file_t *file)
     cap = file->size ? file->size : ra_offset + ra_size;
 
     while (trav_offset < min(ra_offset + ra_size, cap)) {
-        fault = 0;
-        ra_file_lock(file);
-        {
-            trav = ra_page_get(file, trav_offset);
-            if (!trav) {
-                fault = 1;
-                trav = ra_page_create(file, trav_offset);
-                if (trav)
-                    trav->dirty = 1;
-            }
-        }
-        ra_file_unlock(file);
-
-        if (!trav) {
+        if (ra_prefetch_page(frame, file, trav_offset)) {
             /* OUT OF MEMORY */
             break;
         }
-
-        if (fault) {
-            gf_msg_trace(frame->this->name, 0, "RA at offset=%" PRId64,
-                         trav_offset);
-            ra_page_fault(file, frame, trav_offset);
-        }
         trav_offset += file->page_size;
     }
 
@@ -335,7 +545,8 @@ ra_need_atime_cbk(call_frame_t *frame, void *cookie, xlator_t *this,
     return 0;
 }
 
-static void
+/* Returns the number of pages of the read which were not cached yet */
+static int
 dispatch_requests(call_frame_t *frame, ra_file_t *file)
 {
     ra_local_t *local = NULL;
@@ -347,6 +558,7 @@ dispatch_requests(call_frame_t *frame, ra_file_t *file)
     call_frame_t *ra_frame = NULL;
     char need_atime_update = 1;
     char fault = 0;
+    int late = 0;
 
     GF_VALIDATE_OR_GOTO("read-ahead", frame, out);
     GF_VALIDATE_OR_GOTO(frame->this->name, file, out);
@@ -375,7 +587,11 @@ dispatch_requests(call_frame_t *frame, ra_file_t *file)
                 fault = 1;
                 need_atime_update = 0;
             }
-            trav->dirty = 0;
+
+            if (trav->dirty) {
+                GF_ATOMIC_INC(conf->ra_counter.prefetch_hits);
+                trav->dirty = 0;
+            }
 
             if (trav->ready) {
                 gf_msg_trace(frame->this->name, 0, "HIT at offset=%" PRId64 ".",
@@ -388,6 +604,7 @@ dispatch_requests(call_frame_t *frame, ra_file_t *file)
                              trav_offset);
                 ra_wait_on_page(trav, frame);
                 need_atime_update = 0;
+                late++;
             }
         }
     unlock:
@@ -420,7 +637,7 @@ dispatch_requests(call_frame_t *frame, ra_file_t *file)
     }
 
 out:
-    return;
+    return late;
 }
 
 int
@@ -445,8 +662,12 @@ ra_readv(call_frame_t *frame, xlator_t *this, fd_t *fd, size_t size,
     ra_local_t *local = NULL;
     ra_conf_t *conf = NULL;
     int op_errno = EINVAL;
-    char expected_offset = 1;
     uint64_t tmp_file = 0;
+    ra_stream_t *stream = NULL;
+    ra_stream_t snapshot = {
+        0,
+    };
+    int late = 0;
 
     GF_ASSERT(frame);
     GF_VALIDATE_OR_GOTO(frame->this->name, this, unwind);
@@ -465,29 +686,19 @@ ra_readv(call_frame_t *frame, xlator_t *this, fd_t *fd, size_t size,
         goto disabled;
     }
 
-    if (file->offset != offset) {
-        gf_msg_trace(this->name, 0,
-                     "unexpected offset (%" PRId64 " != %" PRId64
-                     ") "
-                     "resetting",
-                     file->offset, offset);
-
-        expected_offset = file->expected = file->page_count = 0;
-    } else {
-        gf_msg_trace(this->name, 0,
-                     "expected offset (%" PRId64 ") when page_count=%d", offset,
-                     file->page_count);
-
-        if (file->expected < (file->page_size * conf->page_count)) {
-            file->expected += size;
-            file->page_count = min((file->expected / file->page_size),
-                                   conf->page_count);
-        }
+    ra_file_lock(file);
+    {
+        stream = __ra_stream_get(file, offset, size);
+        snapshot = *stream;
     }
+    ra_file_unlock(file);
 
-    if (!expected_offset) {
-        flush_region(frame, file, 0, file->pages.prev->offset + 1, 0);
-    }
+    gf_msg_trace(this->name, 0,
+                 "stream %d: stride=%" PRId64 " matched=%u window=%u",
+                 (int)(stream - file->streams), snapshot.stride,
+                 snapshot.matched, snapshot.window);
+
+    ra_file_trim(file);
 
     local = mem_get0(this->local_pool);
     if (!local) {
@@ -507,13 +718,19 @@ ra_readv(call_frame_t *frame, xlator_t *this, fd_t *fd, size_t size,
 
     frame->local = local;
 
-    dispatch_requests(frame, file);
+    late = dispatch_requests(frame, file);
 
-    flush_region(frame, file, 0, gf_floor(offset, file->page_size), 0);
-
-    read_ahead(frame, file);
+    ra_file_lock(file);
+    {
+        /* unless a concurrent read took the stream over */
+        if (stream->used == snapshot.used) {
+            __ra_stream_adapt(file, stream, late);
+            snapshot = *stream;
+        }
+    }
+    ra_file_unlock(file);
 
-    file->offset = offset + size;
+    read_ahead(frame, file, &snapshot);
 
     ra_frame_return(frame);
 
@@ -641,8 +858,12 @@ ra_writev(call_frame_t *frame, xlator_t *this, fd_t *fd, struct iovec *vector,
 
             flush_region(frame, file, 0, file->pages.prev->offset + 1, 1);
 
-            /* reset the read-ahead counters too */
-            file->expected = file->page_count = 0;
+            /* reset the read-ahead streams too */
+            ra_file_lock(file);
+            {
+                ra_file_reset_streams(file);
+            }
+            ra_file_unlock(file);
         }
     }
     UNLOCK(&inode->lock);
@@ -767,6 +988,7 @@ ra_fdctx_dump(xlator_t *this, fd_t *fd)
 {
     ra_file_t *file = NULL;
     ra_page_t *page = NULL;
+    ra_stream_t *stream = NULL;
     int32_t ret = 0, i = 0;
     uint64_t tmp_file = 0;
     char *path = NULL;
@@ -803,10 +1025,19 @@ ra_fdctx_dump(xlator_t *this, fd_t *fd)
 
     gf_proc_dump_write("page-size", "%" PRId64, file->page_size);
 
-    gf_proc_dump_write("page-count", "%u", file->page_count);
-
-    gf_proc_dump_write("next-expected-offset-for-sequential-reads", "%" PRId64,
-                       file->offset);
+    gf_proc_dump_write("fault-latency-usec", "%" PRId64, file->rtt / 1000);
+
+    for (i = 0; i < RA_MAX_STREAMS; i++) {
+        stream = &file->streams[i];
+        if (!stream->used)
+            continue;
+        gf_proc_dump_write("stream",
+                           "%d: offset=%" PRId64 " stride=%" PRId64
+                           " matched=%u window=%u",
+                           i, stream->offset, stream->stride, stream->matched,
+                           stream->window);
+    }
+    i = 0;
 
     for (page = file->pages.next; page != &file->pages; page = page->next) {
         gf_proc_dump_write("page", "%d: %p", i++, (void *)page);
@@ -1045,6 +1276,12 @@ ra_priv_dump(xlator_t *this)
         gf_proc_dump_write("page_count", "%d", conf->page_count);
         gf_proc_dump_write("force_atime_update", "%d",
                            conf->force_atime_update);
+        gf_proc_dump_write("prefetched", "%" PRId64,
+                           GF_ATOMIC_GET(conf->ra_counter.prefetched));
+        gf_proc_dump_write("prefetch_hits", "%" PRId64,
+                           GF_ATOMIC_GET(conf->ra_counter.prefetch_hits));
+        gf_proc_dump_write("prefetch_wasted", "%" PRId64,
+                           GF_ATOMIC_GET(conf->ra_counter.prefetch_wasted));
     }
     pthread_mutex_unlock(&conf->conf_lock);
 
@@ -1057,6 +1294,24 @@ out:
     return ret;
 }
 
+static int
+ra_dump_metrics(xlator_t *this, int fd)
+{
+    ra_conf_t *conf = this->private;
+
+    if (!conf)
+        return 0;
+
+    dprintf(fd, "%s.prefetched %" PRId64 "\n", this->name,
+            GF_ATOMIC_GET(conf->ra_counter.prefetched));
+    dprintf(fd, "%s.prefetch-hits %" PRId64 "\n", this->name,
+            GF_ATOMIC_GET(conf->ra_counter.prefetch_hits));
+    dprintf(fd, "%s.prefetch-wasted %" PRId64 "\n", this->name,
+            GF_ATOMIC_GET(conf->ra_counter.prefetch_wasted));
+
+    return 0;
+}
+
 int32_t
 mem_acct_init(xlator_t *this)
 {
@@ -1139,6 +1394,10 @@ init(xlator_t *this)
     conf->files.next = &conf->files;
     conf->files.prev = &conf->files;
 
+    GF_ATOMIC_INIT(conf->ra_counter.prefetched, 0);
+    GF_ATOMIC_INIT(conf->ra_counter.prefetch_hits, 0);
+    GF_ATOMIC_INIT(conf->ra_counter.prefetch_wasted, 0);
+
     pthread_mutex_init(&conf->conf_lock, NULL);
 
     this->local_pool = mem_pool_new(ra_local_t, 64);
@@ -1237,7 +1496,10 @@ struct volume_options options[] = {
      .default_value = "4",
      .op_version = {1},
      .tags = {"read-ahead"},
-     .description = "Number of pages that will be pre-fetched"},
+     .description = "Maximum number of pages pre-fetched for one stream of "
+                    "reads. Each fd tracks up to 4 sequential or strided "
+                    "streams, and the pages actually pre-fetched depend on "
+                    "the latency of the reads and on how fast they come."},
     {.key = {"page-size"},
      .type = GF_OPTION_TYPE_SIZET,
      .min = 4096,
@@ -1262,6 +1524,7 @@ xlator_api_t xlator_api = {
     .fini = fini,
     .reconfigure = reconfigure,
     .mem_acct_init = mem_acct_init,
+    .dump_metrics = ra_dump_metrics,
     .op_version = {1}, /* Present from the initial version */
     .dumpops = &dumpops,
     .fops = &fops,
@@ -18,6 +18,18 @@
 #include <glusterfs/common-utils.h>
 #include "read-ahead-mem-types.h"
 
+/* Number of access streams tracked on one fd. Each is a sequence of reads
+ * at a constant distance from each other: sequential reads, forward or
+ * backward, or strided reads. */
+#define RA_MAX_STREAMS 4
+
+/* Reads further apart than this do not make a strided stream */
+#define RA_MAX_STRIDE ((off_t)(64 * GF_UNIT_MB))
+
+/* Reads of a stream served from prefetched pages in a row before its
+ * window is allowed to shrink */
+#define RA_SHRINK_HITS 8
+
 struct ra_conf;
 struct ra_local;
 struct ra_page;
@@ -51,6 +63,7 @@ struct ra_local {
     fd_t *fd;
     int32_t wait_count;
     pthread_mutex_t local_lock;
+    struct timespec start; /* when the page fault was sent */
 };
 
 struct ra_page {
@@ -69,21 +82,40 @@ struct ra_page {
     char stale;
 };
 
+struct ra_stream {
+    off_t offset;        /* offset of the last read */
+    size_t size;         /* size of the last read */
+    off_t stride;        /* offset distance between two reads, 0 if the
+                          * reads are contiguous */
+    uint32_t matched;    /* reads which followed the pattern, in a row */
+    uint32_t window;     /* pages to keep prefetched */
+    uint32_t hits;       /* reads fully served from the window, in a row */
+    uint64_t used;       /* ra_file->seq when last read, 0 if unused */
+    struct timespec last; /* time of the last read */
+    int64_t gap;         /* average time between two reads, in ns */
+};
+
 struct ra_file {
     struct ra_file *next;
     struct ra_file *prev;
     struct ra_conf *conf;
     fd_t *fd;
     int disabled;
-    size_t expected;
     struct ra_page pages;
-    off_t offset;
     size_t size;
     int32_t refcount;
     pthread_mutex_t file_lock;
     struct iatt stbuf;
     uint64_t page_size;
-    uint32_t page_count;
+    struct ra_stream streams[RA_MAX_STREAMS];
+    uint64_t seq;
+    int64_t rtt; /* average latency of a page fault, in ns */
+};
+
+struct ra_statistics {
+    gf_atomic_t prefetched;      /* pages read ahead */
+    gf_atomic_t prefetch_hits;   /* of those, pages later read */
+    gf_atomic_t prefetch_wasted; /* of those, pages dropped unread */
 };
 
 struct ra_conf {
@@ -93,6 +125,7 @@ struct ra_conf {
     struct ra_file files;
     gf_boolean_t force_atime_update;
     pthread_mutex_t conf_lock;
+    struct ra_statistics ra_counter;
 };
 
 typedef struct ra_conf ra_conf_t;
@@ -101,6 +134,7 @@ typedef struct ra_page ra_page_t;
 typedef struct ra_file ra_file_t;
 typedef struct ra_waitq ra_waitq_t;
 typedef struct ra_fill ra_fill_t;
+typedef struct ra_stream ra_stream_t;
 
 ra_page_t *
 ra_page_get(ra_file_t *file, off_t offset);
@@ -30,6 +30,8 @@
 #include "readdir-ahead.h"
 #include "readdir-ahead-mem-types.h"
 #include <glusterfs/defaults.h>
+#include <glusterfs/statedump.h>
+#include <glusterfs/upcall-utils.h>
 #include "readdir-ahead-messages.h"
 static int
 rda_fill_fd(call_frame_t *, xlator_t *, fd_t *);
@@ -43,6 +45,8 @@ rda_local_wipe(struct rda_local *local)
         dict_unref(local->xattrs);
     if (local->inode)
         inode_unref(local->inode);
+    if (local->inode2)
+        inode_unref(local->inode2);
 }
 
 /*
@@ -64,6 +68,7 @@ get_rda_fd_ctx(fd_t *fd, xlator_t *this)
 
         LOCK_INIT(&ctx->lock);
         INIT_LIST_HEAD(&ctx->entries.list);
+        INIT_LIST_HEAD(&ctx->listing.list);
         ctx->state = RDA_FD_NEW;
         /* ctx offset values initialized to 0 */
         ctx->xattrs = NULL;
@@ -97,6 +102,7 @@ __rda_inode_ctx_get(inode_t *inode, xlator_t *this)
         return NULL;
 
     GF_ATOMIC_INIT(ctx_p->generation, 0);
+    GF_ATOMIC_INIT(ctx_p->dir_generation, 0);
 
     ctx_uint = (uint64_t)(uintptr_t)ctx_p;
     ret = __inode_ctx_set1(inode, this, &ctx_uint);
@@ -181,6 +187,291 @@ rda_inode_ctx_update_iatts(inode_t *inode, xlator_t *this,
     return ret;
 }
 
+static rda_inode_ctx_t *
+rda_inode_ctx_get(inode_t *inode, xlator_t *this)
+{
+    rda_inode_ctx_t *ctx_p = NULL;
+
+    LOCK(&inode->lock);
+    {
+        ctx_p = __rda_inode_ctx_get(inode, this);
+    }
+    UNLOCK(&inode->lock);
+
+    return ctx_p;
+}
+
+static void
+rda_listing_free(struct rda_dir_listing *listing)
+{
+    gf_dirent_free(&listing->entries);
+    GF_FREE(listing);
+}
+
+/* priv->lock must be held */
+static void
+__rda_listing_unlink(struct rda_priv *priv, struct rda_dir_listing *listing)
+{
+    list_del_init(&listing->lru);
+    listing->ctx->listing = NULL;
+    priv->listing_size -= listing->size;
+    priv->listing_count--;
+}
+
+/*
+ * Drop the listings least recently used until they fit, along with the
+ * preload buffers, in rda-cache-limit. priv->lock must be held, the listings
+ * dropped are moved to @evicted.
+ */
+static void
+__rda_listing_prune(struct rda_priv *priv, struct list_head *evicted)
+{
+    struct rda_dir_listing *listing = NULL;
+
+    while (!list_empty(&priv->listing_lru) &&
+           ((priv->listing_size + GF_ATOMIC_GET(priv->rda_cache_size)) >
+            priv->rda_cache_limit)) {
+        listing = list_first_entry(&priv->listing_lru, struct rda_dir_listing,
+                                   lru);
+        __rda_listing_unlink(priv, listing);
+        list_add_tail(&listing->lru, evicted);
+    }
+}
+
+static void
+rda_listing_free_all(struct list_head *listings)
+{
+    struct rda_dir_listing *listing = NULL;
+    struct rda_dir_listing *tmp = NULL;
+
+    list_for_each_entry_safe(listing, tmp, listings, lru)
+    {
+        list_del_init(&listing->lru);
+        rda_listing_free(listing);
+    }
+}
+
+/*
+ * The entries of the directory changed, drop its listing and make the ones
+ * being read stale.
+ */
+static void
+rda_dir_invalidate(xlator_t *this, inode_t *inode)
+{
+    struct rda_priv *priv = this->private;
+    struct rda_dir_listing *listing = NULL;
+    rda_inode_ctx_t *ctx_p = NULL;
+    uint64_t ctx_uint = 0;
+
+    if (!inode)
+        return;
+
+    if (inode_ctx_get1(inode, this, &ctx_uint) != 0)
+        return;
+
+    ctx_p = (rda_inode_ctx_t *)(uintptr_t)ctx_uint;
+    GF_ATOMIC_INC(ctx_p->dir_generation);
+
+    LOCK(&priv->lock);
+    {
+        listing = ctx_p->listing;
+        if (listing)
+            __rda_listing_unlink(priv, listing);
+    }
+    UNLOCK(&priv->lock);
+
+    if (listing) {
+        GF_ATOMIC_INC(priv->listing_invals);
+        rda_listing_free(listing);
+    }
+}
+
+/*
+ * Keep the entries a full read of the directory has gathered, unless they
+ * changed meanwhile.
+ */
+static void
+rda_listing_publish(xlator_t *this, inode_t *inode, gf_dirent_t *entries,
+                    size_t size, uint64_t generation, time_t time,
+                    int op_errno)
+{
+    struct rda_priv *priv = this->private;
+    struct rda_dir_listing *listing = NULL;
+    struct rda_dir_listing *old = NULL;
+    rda_inode_ctx_t *ctx_p = NULL;
+    struct list_head evicted;
+
+    INIT_LIST_HEAD(&evicted);
+
+    ctx_p = rda_inode_ctx_get(inode, this);
+    if (!ctx_p)
+        goto out;
+
+    listing = GF_CALLOC(1, sizeof(*listing), gf_rda_mt_dir_listing_t);
+    if (!listing)
+        goto out;
+
+    INIT_LIST_HEAD(&listing->lru);
+    INIT_LIST_HEAD(&listing->entries.list);
+    list_splice_init(&entries->list, &listing->entries.list);
+    listing->size = size;
+    listing->time = time;
+    listing->op_errno = op_errno;
+
+    LOCK(&priv->lock);
+    {
+        if (!priv->dir_cache ||
+            (GF_ATOMIC_GET(ctx_p->dir_generation) != generation))
+            goto unlock;
+
+        old = ctx_p->listing;
+        if (old)
+            __rda_listing_unlink(priv, old);
+
+        listing->ctx = ctx_p;
+        ctx_p->listing = listing;
+        list_add_tail(&listing->lru, &priv->listing_lru);
+        priv->listing_size += size;
+        priv->listing_count++;
+        listing = NULL;
+
+        __rda_listing_prune(priv, &evicted);
+    }
+unlock:
+    UNLOCK(&priv->lock);
+
+    if (listing)
+        rda_listing_free(listing);
+    if (old)
+        rda_listing_free(old);
+    rda_listing_free_all(&evicted);
+out:
+    gf_dirent_free(entries);
+}
+
+/*
+ * Load the fd with the listing cached for the directory, as if the preload
+ * had read it all. ctx must be locked and new.
+ */
+static gf_boolean_t
+__rda_serve_listing(xlator_t *this, fd_t *fd, struct rda_fd_ctx *ctx,
+                    rda_inode_ctx_t *dir_ctx)
+{
+    struct rda_priv *priv = this->private;
+    struct rda_dir_listing *listing = NULL;
+    struct rda_dir_listing *expired = NULL;
+    rda_inode_ctx_t *ctx_p = NULL;
+    gf_dirent_t *entry = NULL;
+    gf_dirent_t *copy = NULL;
+    inode_t *inode = NULL;
+    size_t dirent_size = 0;
+    uint64_t ctx_uint = 0;
+    gf_boolean_t served = _gf_false;
+    int op_errno = 0;
+
+    if (!priv->dir_cache || !dir_ctx)
+        return _gf_false;
+
+    LOCK(&priv->lock);
+    {
+        listing = dir_ctx->listing;
+        if (!listing)
+            goto unlock;
+
+        if (gf_time() >= (listing->time + priv->dir_cache_timeout)) {
+            __rda_listing_unlink(priv, listing);
+            expired = listing;
+            goto unlock;
+        }
+
+        list_for_each_entry(entry, &listing->entries.list, list)
+        {
+            copy = entry_copy(entry);
+            if (!copy) {
+                gf_dirent_free(&ctx->entries);
+                goto unlock;
+            }
+            list_add_tail(&copy->list, &ctx->entries.list);
+        }
+
+        list_move_tail(&listing->lru, &priv->listing_lru);
+        op_errno = listing->op_errno;
+        served = _gf_true;
+    }
+unlock:
+    UNLOCK(&priv->lock);
+
+    if (expired)
+        rda_listing_free(expired);
+
+    if (!served) {
+        GF_ATOMIC_INC(priv->listing_misses);
+        return _gf_false;
+    }
+
+    GF_ATOMIC_INC(priv->listing_hits);
+
+    list_for_each_entry(entry, &ctx->entries.list, list)
+    {
+        dirent_size = gf_dirent_size(entry->d_name);
+        ctx->cur_size += dirent_size;
+        GF_ATOMIC_ADD(priv->rda_cache_size, dirent_size);
+        ctx->next_offset = entry->d_off;
+
+        if ((strcmp(entry->d_name, ".") == 0) ||
+            (strcmp(entry->d_name, "..") == 0))
+            continue;
+
+        /* Only the entries whose attributes are known, and kept up to
+         * date, go up with an inode. The others are looked up. */
+        inode = inode_find(fd->inode->table, entry->d_stat.ia_gfid);
+        if (!inode)
+            continue;
+
+        ctx_uint = 0;
+        inode_ctx_get1(inode, this, &ctx_uint);
+        ctx_p = (rda_inode_ctx_t *)(uintptr_t)ctx_uint;
+        if (ctx_p && ctx_p->statbuf.ia_ctime)
+            entry->inode = inode;
+        else
+            inode_unref(inode);
+    }
+
+    ctx->state = RDA_FD_EOD;
+    ctx->op_errno = op_errno;
+
+    return _gf_true;
+}
+
+static gf_boolean_t
+rda_serve_listing(xlator_t *this, fd_t *fd)
+{
+    struct rda_priv *priv = this->private;
+    struct rda_fd_ctx *ctx = NULL;
+    rda_inode_ctx_t *dir_ctx = NULL;
+    gf_boolean_t served = _gf_false;
+
+    if (!priv->dir_cache)
+        goto out;
+
+    ctx = get_rda_fd_ctx(fd, this);
+    if (!ctx)
+        goto out;
+
+    dir_ctx = rda_inode_ctx_get(fd->inode, this);
+    if (!dir_ctx)
+        goto out;
+
+    LOCK(&ctx->lock);
+    {
+        if (ctx->state == RDA_FD_NEW)
+            served = __rda_serve_listing(this, fd, ctx, dir_ctx);
+    }
+    UNLOCK(&ctx->lock);
+out:
+    return served;
+}
+
 /*
  * Reset the tracking state of the context.
  */
@@ -200,6 +491,9 @@ rda_reset_ctx(xlator_t *this, struct rda_fd_ctx *ctx)
     GF_ATOMIC_SUB(priv->rda_cache_size, ctx->cur_size);
     ctx->cur_size = 0;
 
+    gf_dirent_free(&ctx->listing);
+    ctx->listing_size = 0;
+
     if (ctx->xattrs) {
         dict_unref(ctx->xattrs);
         ctx->xattrs = NULL;
@@ -384,6 +678,8 @@ rda_readdirp(call_frame_t *frame, xlator_t *this, fd_t *fd, size_t size,
     int ret = 0;
     int op_errno = 0;
     gf_boolean_t serve = _gf_false;
+    rda_inode_ctx_t *dir_ctx = NULL;
+    struct rda_priv *priv = this->private;
 
     ctx = get_rda_fd_ctx(fd, this);
     if (!ctx)
@@ -392,6 +688,9 @@ rda_readdirp(call_frame_t *frame, xlator_t *this, fd_t *fd, size_t size,
     if (ctx->state & RDA_FD_BYPASS)
         goto bypass;
 
+    if (!off && priv->dir_cache)
+        dir_ctx = rda_inode_ctx_get(fd->inode, this);
+
     INIT_LIST_HEAD(&entries.list);
     LOCK(&ctx->lock);
 
@@ -416,7 +715,8 @@ rda_readdirp(call_frame_t *frame, xlator_t *this, fd_t *fd, size_t size,
          * requests issued by this xlator.
          */
         ctx->xattrs = dict_ref(xdata);
-        fill = 1;
+        if (!__rda_serve_listing(this, fd, ctx, dir_ctx))
+            fill = 1;
     }
 
     /*
@@ -499,8 +799,13 @@ rda_fill_fd_cbk(call_frame_t *frame, void *cookie, xlator_t *this,
     };
     uint64_t generation = 0;
     call_frame_t *fill_frame = NULL;
+    gf_dirent_t listing;
+    gf_dirent_t *copy = NULL;
+    size_t listing_size = 0;
+    gf_boolean_t publish = _gf_false;
 
     INIT_LIST_HEAD(&serve_entries.list);
+    INIT_LIST_HEAD(&listing.list);
     LOCK(&ctx->lock);
 
     /* Verify that the preload buffer is still pending on this data. */
@@ -546,6 +851,26 @@ rda_fill_fd_cbk(call_frame_t *frame, void *cookie, xlator_t *this,
 
             dirent_size = gf_dirent_size(dirent->d_name);
 
+            if (ctx->state & RDA_FD_LISTING) {
+                /* the xattrs and the inode are not kept, they would go
+                 * stale */
+                copy = gf_dirent_for_name(dirent->d_name);
+                if (copy) {
+                    copy->d_off = dirent->d_off;
+                    copy->d_ino = dirent->d_ino;
+                    copy->d_type = dirent->d_type;
+                    copy->d_stat = dirent->d_stat;
+                    list_add_tail(&copy->list, &ctx->listing.list);
+                    ctx->listing_size += dirent_size;
+                }
+
+                if (!copy || (ctx->listing_size > priv->rda_cache_limit)) {
+                    ctx->state &= ~RDA_FD_LISTING;
+                    gf_dirent_free(&ctx->listing);
+                    ctx->listing_size = 0;
+                }
+            }
+
             ctx->cur_size += dirent_size;
 
             GF_ATOMIC_ADD(priv->rda_cache_size, dirent_size);
@@ -569,6 +894,14 @@ rda_fill_fd_cbk(call_frame_t *frame, void *cookie, xlator_t *this,
         ctx->state &= ~RDA_FD_RUNNING;
         ctx->state |= RDA_FD_EOD;
         ctx->op_errno = op_errno;
+
+        if (ctx->state & RDA_FD_LISTING) {
+            ctx->state &= ~RDA_FD_LISTING;
+            list_splice_init(&ctx->listing.list, &listing.list);
+            listing_size = ctx->listing_size;
+            ctx->listing_size = 0;
+            publish = _gf_true;
+        }
     } else if (op_ret == -1) {
         /* kill the preload and pend the error */
         ctx->state &= ~RDA_FD_RUNNING;
@@ -613,11 +946,25 @@ out:
         ctx->fill_frame = NULL;
     }
 
+    /* a directory read in part, or out of order, is not cached */
+    if ((ctx->state & RDA_FD_LISTING) &&
+        (ctx->state & (RDA_FD_BYPASS | RDA_FD_ERROR))) {
+        ctx->state &= ~RDA_FD_LISTING;
+        gf_dirent_free(&ctx->listing);
+        ctx->listing_size = 0;
+    }
+
     if (op_errno == ENOENT &&
         !((ctx->state & RDA_FD_EOD) && (ctx->cur_size == 0)))
         op_errno = 0;
 
     UNLOCK(&ctx->lock);
+
+    if (publish)
+        rda_listing_publish(this, local->fd->inode, &listing, listing_size,
+                            ctx->listing_generation, ctx->listing_time,
+                            ctx->op_errno);
+
     if (fill_frame) {
         rda_local_wipe(fill_frame->local);
         STACK_DESTROY(fill_frame->root);
@@ -648,11 +995,15 @@ rda_fill_fd(call_frame_t *frame, xlator_t *this, fd_t *fd)
     struct rda_fd_ctx *ctx;
     off_t offset;
     struct rda_priv *priv = this->private;
+    rda_inode_ctx_t *dir_ctx = NULL;
 
     ctx = get_rda_fd_ctx(fd, this);
     if (!ctx)
         goto err;
 
+    if (priv->dir_cache)
+        dir_ctx = rda_inode_ctx_get(fd->inode, this);
+
     LOCK(&ctx->lock);
 
     if (ctx->state & RDA_FD_NEW) {
@@ -660,6 +1011,13 @@ rda_fill_fd(call_frame_t *frame, xlator_t *this, fd_t *fd)
         ctx->state |= RDA_FD_RUNNING;
         if (priv->rda_low_wmark)
             ctx->state |= RDA_FD_PLUGGED;
+
+        /* read from the start, the entries are kept for the next fds */
+        if (dir_ctx && !ctx->next_offset) {
+            ctx->state |= RDA_FD_LISTING;
+            ctx->listing_generation = GF_ATOMIC_GET(dir_ctx->dir_generation);
+            ctx->listing_time = gf_time();
+        }
     }
 
     offset = ctx->next_offset;
@@ -716,7 +1074,7 @@ static int32_t
 rda_opendir_cbk(call_frame_t *frame, void *cookie, xlator_t *this,
                 int32_t op_ret, int32_t op_errno, fd_t *fd, dict_t *xdata)
 {
-    if (!op_ret)
+    if (!op_ret && !rda_serve_listing(this, fd))
         rda_fill_fd(frame, this, fd);
 
     RDA_STACK_UNWIND(opendir, frame, op_ret, op_errno, fd, xdata);
@@ -1129,6 +1487,207 @@ rda_fremovexattr(call_frame_t *frame, xlator_t *this, fd_t *fd,
     return 0;
 }
 
+static int32_t
+rda_create_cbk(call_frame_t *frame, void *cookie, xlator_t *this,
+               int32_t op_ret, int32_t op_errno, fd_t *fd, inode_t *inode,
+               struct iatt *buf, struct iatt *preparent,
+               struct iatt *postparent, dict_t *xdata)
+{
+    struct rda_local *local = frame->local;
+
+    if (local)
+        rda_dir_invalidate(this, local->inode);
+
+    RDA_STACK_UNWIND(create, frame, op_ret, op_errno, fd, inode, buf,
+                     preparent, postparent, xdata);
+    return 0;
+}
+
+static int32_t
+rda_create(call_frame_t *frame, xlator_t *this, loc_t *loc, int32_t flags,
+           mode_t mode, mode_t umask, fd_t *fd, dict_t *xdata)
+{
+    RDA_ENTRY_MODIFICATION_FOP(create, frame, this, loc->parent, NULL, xdata,
+                               loc, flags, mode, umask, fd);
+    return 0;
+}
+
+static int32_t
+rda_mknod_cbk(call_frame_t *frame, void *cookie, xlator_t *this,
+              int32_t op_ret, int32_t op_errno, inode_t *inode,
+              struct iatt *buf, struct iatt *preparent,
+              struct iatt *postparent, dict_t *xdata)
+{
+    struct rda_local *local = frame->local;
+
+    if (local)
+        rda_dir_invalidate(this, local->inode);
+
+    RDA_STACK_UNWIND(mknod, frame, op_ret, op_errno, inode, buf, preparent,
+                     postparent, xdata);
+    return 0;
+}
+
+static int32_t
+rda_mknod(call_frame_t *frame, xlator_t *this, loc_t *loc, mode_t mode,
+          dev_t rdev, mode_t umask, dict_t *xdata)
+{
+    RDA_ENTRY_MODIFICATION_FOP(mknod, frame, this, loc->parent, NULL, xdata,
+                               loc, mode, rdev, umask);
+    return 0;
+}
+
+static int32_t
+rda_mkdir_cbk(call_frame_t *frame, void *cookie, xlator_t *this,
+              int32_t op_ret, int32_t op_errno, inode_t *inode,
+              struct iatt *buf, struct iatt *preparent,
+              struct iatt *postparent, dict_t *xdata)
+{
+    struct rda_local *local = frame->local;
+
+    if (local)
+        rda_dir_invalidate(this, local->inode);
+
+    RDA_STACK_UNWIND(mkdir, frame, op_ret, op_errno, inode, buf, preparent,
+                     postparent, xdata);
+    return 0;
+}
+
+static int32_t
+rda_mkdir(call_frame_t *frame, xlator_t *this, loc_t *loc, mode_t mode,
+          mode_t umask, dict_t *xdata)
+{
+    RDA_ENTRY_MODIFICATION_FOP(mkdir, frame, this, loc->parent, NULL, xdata,
+                               loc, mode, umask);
+    return 0;
+}
+
+static int32_t
+rda_symlink_cbk(call_frame_t *frame, void *cookie, xlator_t *this,
+                int32_t op_ret, int32_t op_errno, inode_t *inode,
+                struct iatt *buf, struct iatt *preparent,
+                struct iatt *postparent, dict_t *xdata)
+{
+    struct rda_local *local = frame->local;
+
+    if (local)
+        rda_dir_invalidate(this, local->inode);
+
+    RDA_STACK_UNWIND(symlink, frame, op_ret, op_errno, inode, buf, preparent,
+                     postparent, xdata);
+    return 0;
+}
+
+static int32_t
+rda_symlink(call_frame_t *frame, xlator_t *this, const char *linkpath,
+            loc_t *loc, mode_t umask, dict_t *xdata)
+{
+    RDA_ENTRY_MODIFICATION_FOP(symlink, frame, this, loc->parent, NULL, xdata,
+                               linkpath, loc, umask);
+    return 0;
+}
+
+static int32_t
+rda_link_cbk(call_frame_t *frame, void *cookie, xlator_t *this,
+             int32_t op_ret, int32_t op_errno, inode_t *inode,
+             struct iatt *buf, struct iatt *preparent,
+             struct iatt *postparent, dict_t *xdata)
+{
+    struct rda_local *local = frame->local;
+
+    if (local)
+        rda_dir_invalidate(this, local->inode);
+
+    RDA_STACK_UNWIND(link, frame, op_ret, op_errno, inode, buf, preparent,
+                     postparent, xdata);
+    return 0;
+}
+
+static int32_t
+rda_link(call_frame_t *frame, xlator_t *this, loc_t *oldloc, loc_t *newloc,
+         dict_t *xdata)
+{
+    RDA_ENTRY_MODIFICATION_FOP(link, frame, this, newloc->parent, NULL, xdata,
+                               oldloc, newloc);
+    return 0;
+}
+
+static int32_t
+rda_unlink_cbk(call_frame_t *frame, void *cookie, xlator_t *this,
+               int32_t op_ret, int32_t op_errno, struct iatt *preparent,
+               struct iatt *postparent, dict_t *xdata)
+{
+    struct rda_local *local = frame->local;
+
+    if (local)
+        rda_dir_invalidate(this, local->inode);
+
+    RDA_STACK_UNWIND(unlink, frame, op_ret, op_errno, preparent, postparent,
+                     xdata);
+    return 0;
+}
+
+static int32_t
+rda_unlink(call_frame_t *frame, xlator_t *this, loc_t *loc, int xflag,
+           dict_t *xdata)
+{
+    RDA_ENTRY_MODIFICATION_FOP(unlink, frame, this, loc->parent, NULL, xdata,
+                               loc, xflag);
+    return 0;
+}
+
+static int32_t
+rda_rmdir_cbk(call_frame_t *frame, void *cookie, xlator_t *this,
+              int32_t op_ret, int32_t op_errno, struct iatt *preparent,
+              struct iatt *postparent, dict_t *xdata)
+{
+    struct rda_local *local = frame->local;
+
+    if (local)
+        rda_dir_invalidate(this, local->inode);
+
+    RDA_STACK_UNWIND(rmdir, frame, op_ret, op_errno, preparent, postparent,
+                     xdata);
+    return 0;
+}
+
+static int32_t
+rda_rmdir(call_frame_t *frame, xlator_t *this, loc_t *loc, int flags,
+          dict_t *xdata)
+{
+    RDA_ENTRY_MODIFICATION_FOP(rmdir, frame, this, loc->parent, NULL, xdata,
+                               loc, flags);
+    return 0;
+}
+
+static int32_t
+rda_rename_cbk(call_frame_t *frame, void *cookie, xlator_t *this,
+               int32_t op_ret, int32_t op_errno, struct iatt *buf,
+               struct iatt *preoldparent, struct iatt *postoldparent,
+               struct iatt *prenewparent, struct iatt *postnewparent,
+               dict_t *xdata)
+{
+    struct rda_local *local = frame->local;
+
+    if (local) {
+        rda_dir_invalidate(this, local->inode);
+        rda_dir_invalidate(this, local->inode2);
+    }
+
+    RDA_STACK_UNWIND(rename, frame, op_ret, op_errno, buf, preoldparent,
+                     postoldparent, prenewparent, postnewparent, xdata);
+    return 0;
+}
+
+static int32_t
+rda_rename(call_frame_t *frame, xlator_t *this, loc_t *oldloc, loc_t *newloc,
+           dict_t *xdata)
+{
+    RDA_ENTRY_MODIFICATION_FOP(rename, frame, this, oldloc->parent,
+                               newloc->parent, xdata, oldloc, newloc);
+    return 0;
+}
+
 static int32_t
 rda_releasedir(xlator_t *this, fd_t *fd)
 {
@@ -1161,6 +1720,8 @@ rda_forget(xlator_t *this, inode_t *inode)
 {
     uint64_t ctx_uint = 0;
     rda_inode_ctx_t *ctx = NULL;
+    struct rda_priv *priv = this->private;
+    struct rda_dir_listing *listing = NULL;
 
     inode_ctx_del1(inode, this, &ctx_uint);
     if (!ctx_uint)
@@ -1168,11 +1729,129 @@ rda_forget(xlator_t *this, inode_t *inode)
 
     ctx = (rda_inode_ctx_t *)(uintptr_t)ctx_uint;
 
+    LOCK(&priv->lock);
+    {
+        listing = ctx->listing;
+        if (listing)
+            __rda_listing_unlink(priv, listing);
+    }
+    UNLOCK(&priv->lock);
+
+    if (listing)
+        rda_listing_free(listing);
+
     GF_FREE(ctx);
 
     return 0;
 }
 
+static int
+rda_priv_dump(xlator_t *this)
+{
+    struct rda_priv *priv = this->private;
+    char key_prefix[GF_DUMP_MAX_BUF_LEN];
+
+    if (!priv)
+        return 0;
+
+    gf_proc_dump_build_key(key_prefix, "xlator.performance.readdir-ahead",
+                           "priv");
+    gf_proc_dump_add_section("%s", key_prefix);
+
+    gf_proc_dump_write("rda_cache_size", "%" PRId64,
+                       GF_ATOMIC_GET(priv->rda_cache_size));
+    gf_proc_dump_write("dir_cache", "%d", priv->dir_cache);
+    gf_proc_dump_write("dir_cache_size", "%" PRIu64, priv->listing_size);
+    gf_proc_dump_write("dir_cache_listings", "%u", priv->listing_count);
+    gf_proc_dump_write("dir_cache_hits", "%" PRId64,
+                       GF_ATOMIC_GET(priv->listing_hits));
+    gf_proc_dump_write("dir_cache_misses", "%" PRId64,
+                       GF_ATOMIC_GET(priv->listing_misses));
+    gf_proc_dump_write("dir_cache_invalidations", "%" PRId64,
+                       GF_ATOMIC_GET(priv->listing_invals));
+
+    return 0;
+}
+
+static void
+rda_invalidate(xlator_t *this, void *data)
+{
+    struct gf_upcall *up_data = NULL;
+    struct gf_upcall_cache_invalidation *up_ci = NULL;
+    inode_table_t *itable = NULL;
+    inode_t *inode = NULL;
+    inode_t *parent1 = NULL;
+    inode_t *parent2 = NULL;
+
+    up_data = (struct gf_upcall *)data;
+
+    if (up_data->event_type != GF_UPCALL_CACHE_INVALIDATION)
+        return;
+
+    up_ci = (struct gf_upcall_cache_invalidation *)up_data->data;
+
+    itable = ((xlator_t *)this->graph->top)->itable;
+    inode = inode_find(itable, up_data->gfid);
+    if (inode) {
+        /* the times of a directory change along with its entries */
+        if (IA_ISDIR(inode->ia_type) && (up_ci->flags & UP_TIMES))
+            rda_dir_invalidate(this, inode);
+
+        if (up_ci->flags & (UP_ATTR_FLAGS | UP_NLINK | UP_RENAME_FLAGS |
+                            UP_FORGET | UP_INVAL_ATTR))
+            rda_inode_ctx_update_iatts(inode, this, NULL, NULL, -1);
+    }
+
+    if (up_ci->flags & UP_PARENT_DENTRY_FLAGS) {
+        if (!gf_uuid_is_null(up_ci->p_stat.ia_gfid))
+            parent1 = inode_find(itable, up_ci->p_stat.ia_gfid);
+        if (!gf_uuid_is_null(up_ci->oldp_stat.ia_gfid))
+            parent2 = inode_find(itable, up_ci->oldp_stat.ia_gfid);
+
+        rda_dir_invalidate(this, parent1);
+        rda_dir_invalidate(this, parent2);
+    }
+
+    if (inode)
+        inode_unref(inode);
+    if (parent1)
+        inode_unref(parent1);
+    if (parent2)
+        inode_unref(parent2);
+}
+
+int
+notify(xlator_t *this, int event, void *data, ...)
+{
+    if (event == GF_EVENT_UPCALL)
+        rda_invalidate(this, data);
+
+    return default_notify(this, event, data);
+}
+
+static void
+rda_listing_drop_all(xlator_t *this)
+{
+    struct rda_priv *priv = this->private;
+    struct rda_dir_listing *listing = NULL;
+    struct list_head dropped;
+
+    INIT_LIST_HEAD(&dropped);
+
+    LOCK(&priv->lock);
+    {
+        while (!list_empty(&priv->listing_lru)) {
+            listing = list_first_entry(&priv->listing_lru,
+                                       struct rda_dir_listing, lru);
+            __rda_listing_unlink(priv, listing);
+            list_add_tail(&listing->lru, &dropped);
+        }
+    }
+    UNLOCK(&priv->lock);
+
+    rda_listing_free_all(&dropped);
+}
+
 int32_t
 mem_acct_init(xlator_t *this)
 {
@@ -1208,6 +1887,11 @@ reconfigure(xlator_t *this, dict_t *options)
     GF_OPTION_RECONF("parallel-readdir", priv->parallel_readdir, options, bool,
                      err);
     GF_OPTION_RECONF("pass-through", this->pass_through, options, bool, err);
+    GF_OPTION_RECONF("rda-dir-cache-timeout", priv->dir_cache_timeout, options,
+                     time, err);
+    GF_OPTION_RECONF("rda-dir-cache", priv->dir_cache, options, bool, err);
+    if (!priv->dir_cache)
+        rda_listing_drop_all(this);
 
     return 0;
 err:
@@ -1241,6 +1925,11 @@ init(xlator_t *this)
     this->private = priv;
 
     GF_ATOMIC_INIT(priv->rda_cache_size, 0);
+    GF_ATOMIC_INIT(priv->listing_hits, 0);
+    GF_ATOMIC_INIT(priv->listing_misses, 0);
+    GF_ATOMIC_INIT(priv->listing_invals, 0);
+    LOCK_INIT(&priv->lock);
+    INIT_LIST_HEAD(&priv->listing_lru);
 
     this->local_pool = mem_pool_new(struct rda_local, 32);
     if (!this->local_pool)
@@ -1252,6 +1941,9 @@ init(xlator_t *this)
     GF_OPTION_INIT("rda-cache-limit", priv->rda_cache_limit, size_uint64, err);
     GF_OPTION_INIT("parallel-readdir", priv->parallel_readdir, bool, err);
     GF_OPTION_INIT("pass-through", this->pass_through, bool, err);
+    GF_OPTION_INIT("rda-dir-cache", priv->dir_cache, bool, err);
+    GF_OPTION_INIT("rda-dir-cache-timeout", priv->dir_cache_timeout, time,
+                   err);
 
     return 0;
 
@@ -1267,8 +1959,16 @@ err:
 void
 fini(xlator_t *this)
 {
+    struct rda_priv *priv = NULL;
+
     GF_VALIDATE_OR_GOTO("readdir-ahead", this, out);
 
+    priv = this->private;
+    if (priv) {
+        rda_listing_drop_all(this);
+        LOCK_DESTROY(&priv->lock);
+    }
+
     GF_FREE(this->private);
 
 out:
@@ -1295,6 +1995,15 @@ struct xlator_fops fops = {
     .fsetattr = rda_fsetattr,
     .removexattr = rda_removexattr,
     .fremovexattr = rda_fremovexattr,
+    /* entry write, for the dir cache */
+    .create = rda_create,
+    .mknod = rda_mknod,
+    .mkdir = rda_mkdir,
+    .symlink = rda_symlink,
+    .link = rda_link,
+    .unlink = rda_unlink,
+    .rmdir = rda_rmdir,
+    .rename = rda_rename,
 };
 
 struct xlator_cbks cbks = {
@@ -1302,6 +2011,10 @@ struct xlator_cbks cbks = {
     .forget = rda_forget,
 };
 
+struct xlator_dumpops dumpops = {
+    .priv = rda_priv_dump,
+};
+
 struct volume_options options[] = {
     {
         .key = {"readdir-ahead"},
@@ -1358,6 +2071,27 @@ struct volume_options options[] = {
                     "improving the performance of readdir. Note that "
                     "the performance improvement is higher in large "
                     "clusters"},
+    {.key = {"rda-dir-cache"},
+     .type = GF_OPTION_TYPE_BOOL,
+     .op_version = {GD_OP_VERSION_10_0},
+     .flags = OPT_FLAG_SETTABLE | OPT_FLAG_CLIENT_OPT | OPT_FLAG_DOC,
+     .default_value = "off",
+     .description = "Keep the entries of a directory read in full, and "
+                    "serve the readdirp calls of the fds opened on it later "
+                    "from them. The cache is dropped by the entry fops of "
+                    "this client and by the cache-invalidation "
+                    "notifications of the others, and counts against "
+                    "rda-cache-limit."},
+    {.key = {"rda-dir-cache-timeout"},
+     .type = GF_OPTION_TYPE_INT,
+     .min = 0,
+     .max = 600,
+     .op_version = {GD_OP_VERSION_10_0},
+     .flags = OPT_FLAG_SETTABLE | OPT_FLAG_CLIENT_OPT | OPT_FLAG_DOC,
+     .default_value = "60",
+     .description = "Time in seconds after which a cached directory listing "
+                    "is read again. Without features.cache-invalidation, "
+                    "the changes made by other clients are seen after it."},
     {.key = {"pass-through"},
      .type = GF_OPTION_TYPE_BOOL,
      .default_value = "false",
@@ -1371,9 +2105,11 @@ struct volume_options options[] = {
 xlator_api_t xlator_api = {
     .init = init,
     .fini = fini,
+    .notify = notify,
     .reconfigure = reconfigure,
     .mem_acct_init = mem_acct_init,
     .op_version = {1}, /* Present from the initial version */
+    .dumpops = &dumpops,
     .fops = &fops,
     .cbks = &cbks,
     .options = options,
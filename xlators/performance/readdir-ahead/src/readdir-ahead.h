@@ -18,6 +18,7 @@
 #define RDA_FD_ERROR (1 << 3)
 #define RDA_FD_BYPASS (1 << 4)
 #define RDA_FD_PLUGGED (1 << 5)
+#define RDA_FD_LISTING (1 << 6) /* copying the entries for the dir cache */
 
 #define RDA_COMMON_MODIFICATION_FOP(name, frame, this, __inode, __xdata,       \
                                     args...)                                   \
@@ -42,6 +43,29 @@
                    FIRST_CHILD(this)->fops->name, args, __xdata);              \
     } while (0)
 
+/* The listing cached for a directory is dropped when a fop changing its
+ * entries is sent, and again when it completes */
+#define RDA_ENTRY_MODIFICATION_FOP(name, frame, this, __parent, __parent2,     \
+                                   __xdata, args...)                           \
+    do {                                                                       \
+        struct rda_local *__local = NULL;                                      \
+                                                                               \
+        __local = mem_get0(this->local_pool);                                  \
+        if (__local) {                                                         \
+            if (__parent)                                                      \
+                __local->inode = inode_ref(__parent);                          \
+            if (__parent2)                                                     \
+                __local->inode2 = inode_ref(__parent2);                        \
+        }                                                                      \
+        frame->local = __local;                                                \
+                                                                               \
+        rda_dir_invalidate(this, __parent);                                    \
+        rda_dir_invalidate(this, __parent2);                                   \
+                                                                               \
+        STACK_WIND(frame, rda_##name##_cbk, FIRST_CHILD(this),                 \
+                   FIRST_CHILD(this)->fops->name, args, __xdata);              \
+    } while (0)
+
 #define RDA_STACK_UNWIND(fop, frame, params...)                                \
     do {                                                                       \
         struct rda_local *__local = NULL;                                      \
@@ -69,6 +93,21 @@ struct rda_fd_ctx {
     dict_t *xattrs; /* md-cache keys to be sent in readdirp() */
     dict_t *writes_during_prefetch;
     gf_atomic_t prefetching;
+    gf_dirent_t listing; /* copy of the entries read from offset 0 */
+    size_t listing_size;
+    uint64_t listing_generation; /* of the directory when it was started */
+    time_t listing_time;
+};
+
+/* The entries of a directory read in full by an fd, served to the fds
+ * opened on it later */
+struct rda_dir_listing {
+    struct list_head lru; /* in rda_priv */
+    struct rda_inode_ctx *ctx;
+    gf_dirent_t entries;
+    size_t size;
+    time_t time;
+    int op_errno; /* with which the last readdirp ended */
 };
 
 struct rda_local {
@@ -76,6 +115,7 @@ struct rda_local {
     fd_t *fd;
     dict_t *xattrs; /* md-cache keys to be sent in readdirp() */
     inode_t *inode;
+    inode_t *inode2; /* the other parent of a rename */
     off_t offset;
     uint64_t generation;
     int32_t skip_dir;
@@ -88,11 +128,22 @@ struct rda_priv {
     uint64_t rda_cache_limit;
     gf_atomic_t rda_cache_size;
     gf_boolean_t parallel_readdir;
+    gf_boolean_t dir_cache;
+    time_t dir_cache_timeout;
+    gf_lock_t lock; /* for the listings and their lru */
+    struct list_head listing_lru;
+    uint64_t listing_size;
+    uint32_t listing_count;
+    gf_atomic_t listing_hits;
+    gf_atomic_t listing_misses;
+    gf_atomic_t listing_invals;
 };
 
 typedef struct rda_inode_ctx {
     struct iatt statbuf;
     gf_atomic_t generation;
+    gf_atomic_t dir_generation; /* bumped whenever the entries change */
+    struct rda_dir_listing *listing; /* under rda_priv lock */
 } rda_inode_ctx_t;
 
 #endif /* __READDIR_AHEAD_H */
@@ -26,6 +26,12 @@
 #define WB_AGGREGATE_SIZE 131072 /* 128 KB */
 #define WB_WINDOW_SIZE 1048576   /* 1MB */
 
+/* With adaptive-window, the largest write sent to the server at once */
+#define WB_AGGREGATE_MAX 1048576 /* 1MB */
+
+/* Shortest period over which the throughput of the acks is measured */
+#define WB_RATE_INTERVAL (100 * 1000 * 1000) /* 100ms, in ns */
+
 typedef struct list_head list_head_t;
 struct wb_conf;
 struct wb_inode;
@@ -124,6 +130,16 @@ typedef struct wb_inode {
     gf_atomic_int32_t readdirps;
     gf_atomic_int8_t invalidate;
 
+    /* with adaptive-window, window_conf and aggregate_size follow the
+     * bandwidth-delay product of the link, measured from the acks of
+     * the writes sent to the server.
+     */
+    uint64_t aggregate_size;
+    int64_t ack_latency; /* smallest recent ack latency, in ns */
+    uint64_t ack_rate;   /* bytes acked per second */
+    uint64_t acked;      /* bytes acked since rate_start */
+    struct timespec rate_start;
+
 } wb_inode_t;
 
 typedef struct wb_request {
@@ -172,8 +188,13 @@ typedef struct wb_request {
         int lied : 1;      /* sin committed */
         int fulfilled : 1; /* got server acknowledgement */
         int go : 1;        /* enough aggregating, good to go */
+        int throttled : 1; /* held back by max-dirty-size */
     } ordering;
 
+    size_t dirty_size; /* lied size accounted in wb_conf->dirty. A
+                          collapsed request hands it to its holder. */
+    struct timespec wind_time; /* valid only in @head in wb_fulfill() */
+
     /* for debug purposes. A request might outlive the fop it is
      * representing. So, preserve essential info for logging.
      */
@@ -190,6 +211,11 @@ typedef struct wb_conf {
     gf_boolean_t strict_write_ordering;
     gf_boolean_t strict_O_DIRECT;
     gf_boolean_t resync_after_fsync;
+    gf_boolean_t adaptive_window;
+    uint64_t window_max;  /* window ceiling with adaptive-window */
+    uint64_t dirty_limit; /* lied bytes allowed across all inodes */
+    gf_atomic_t dirty;    /* lied bytes not acked yet, all inodes */
+    gf_atomic_t throttled; /* writes not lied about due to dirty_limit */
 } wb_conf_t;
 
 wb_inode_t *
@@ -383,6 +409,19 @@ wb_wip_has_conflict(wb_inode_t *wb_inode, wb_request_t *req)
     return NULL;
 }
 
+static void
+__wb_request_undirty(wb_request_t *req)
+{
+    wb_conf_t *conf = NULL;
+
+    if (!req->dirty_size)
+        return;
+
+    conf = req->wb_inode->this->private;
+    GF_ATOMIC_SUB(conf->dirty, req->dirty_size);
+    req->dirty_size = 0;
+}
+
 static int
 __wb_request_unref(wb_request_t *req)
 {
@@ -422,6 +461,8 @@ __wb_request_unref(wb_request_t *req)
         list_del_init(&req->lie);
         list_del_init(&req->wip);
 
+        __wb_request_undirty(req);
+
         list_del_init(&req->all);
         if (list_empty(&wb_inode->all)) {
             wb_inode->gen = 0;
@@ -678,6 +719,7 @@ __wb_inode_create(xlator_t *this, inode_t *inode)
     wb_inode->this = this;
 
     wb_inode->window_conf = conf->window_size;
+    wb_inode->aggregate_size = conf->aggregate_size;
     wb_inode->inode = inode;
 
     LOCK_INIT(&wb_inode->lock);
@@ -742,6 +784,8 @@ __wb_fulfill_request(wb_request_t *req)
     wb_inode->window_current -= req->total_size;
     wb_inode->transit -= req->total_size;
 
+    __wb_request_undirty(req);
+
     uuid_utoa_r(req->gfid, gfid);
 
     gf_log_callingfn(wb_inode->this->name, GF_LOG_DEBUG,
@@ -1060,6 +1104,61 @@ out:
     return;
 }
 
+/* Resize the window of the inode to twice the bandwidth-delay product of
+ * the link, so that the writes lied about keep the link busy while the
+ * earlier ones are acked, without holding more dirty data than that.
+ * The throughput is the rate of the acks while writes are in transit,
+ * and the delay the smallest recent ack latency, which unlike the average
+ * does not grow with the queueing the window itself causes. A window too
+ * small to fill the link caps the throughput at window / latency, so the
+ * window doubles each interval until the link is full.
+ */
+static void
+__wb_inode_adapt(wb_inode_t *wb_inode, wb_request_t *head, size_t size)
+{
+    wb_conf_t *conf = wb_inode->this->private;
+    struct timespec now;
+    int64_t latency = 0;
+    int64_t elapsed = 0;
+    uint64_t rate = 0;
+    uint64_t window = 0;
+
+    if (!conf->adaptive_window) {
+        wb_inode->window_conf = conf->window_size;
+        wb_inode->aggregate_size = conf->aggregate_size;
+        return;
+    }
+
+    timespec_now(&now);
+
+    latency = gf_tsdiff(&head->wind_time, &now);
+    if (!wb_inode->ack_latency || (latency < wb_inode->ack_latency))
+        wb_inode->ack_latency = latency;
+    else
+        wb_inode->ack_latency += (latency - wb_inode->ack_latency) / 64;
+
+    wb_inode->acked += size;
+    elapsed = gf_tsdiff(&wb_inode->rate_start, &now);
+    if (elapsed < WB_RATE_INTERVAL)
+        return;
+
+    rate = wb_inode->acked * GF_SEC_IN_NS / elapsed;
+    wb_inode->ack_rate = wb_inode->ack_rate
+                             ? (3 * wb_inode->ack_rate + rate) / 4
+                             : rate;
+    wb_inode->acked = 0;
+    wb_inode->rate_start = now;
+
+    /* in us, as bytes/s times ns overflows on fast links */
+    window = 2 * wb_inode->ack_rate * (wb_inode->ack_latency / 1000) /
+             1000000;
+    window = min(max(window, conf->aggregate_size), conf->window_max);
+
+    wb_inode->window_conf = window;
+    wb_inode->aggregate_size = min(max(window / 8, conf->aggregate_size),
+                                   WB_AGGREGATE_MAX);
+}
+
 int
 wb_fulfill_cbk(call_frame_t *frame, void *cookie, xlator_t *this,
                int32_t op_ret, int32_t op_errno, struct iatt *prebuf,
@@ -1097,6 +1196,14 @@ wb_fulfill_cbk(call_frame_t *frame, void *cookie, xlator_t *this,
      * </comment> */
     wb_set_invalidate(wb_inode);
 
+    if (op_ret > 0) {
+        LOCK(&wb_inode->lock);
+        {
+            __wb_inode_adapt(wb_inode, head, op_ret);
+        }
+        UNLOCK(&wb_inode->lock);
+    }
+
     if (op_ret == -1) {
         wb_fulfill_err(head, op_errno);
     } else if (op_ret < head->total_size) {
@@ -1150,8 +1257,15 @@ wb_fulfill_head(wb_inode_t *wb_inode, wb_request_t *head)
     frame->root->pid = head->client_pid;
     frame->local = head;
 
+    timespec_now(&head->wind_time);
+
     LOCK(&wb_inode->lock);
     {
+        /* do not count the time the link was idle in the throughput */
+        if (!wb_inode->transit) {
+            wb_inode->acked = 0;
+            wb_inode->rate_start = head->wind_time;
+        }
         wb_inode->transit += head->total_size;
     }
     UNLOCK(&wb_inode->lock);
@@ -1191,8 +1305,6 @@ wb_fulfill(wb_inode_t *wb_inode, list_head_t *liabilities)
     size_t vector_count = 0;
     int ret = 0;
 
-    conf = wb_inode->this->private;
-
     list_for_each_entry_safe(req, tmp, liabilities, winds)
     {
         list_del_init(&req->winds);
@@ -1217,7 +1329,7 @@ wb_fulfill(wb_inode_t *wb_inode, list_head_t *liabilities)
             continue;
         }
 
-        if ((curr_aggregate + req->write_size) > conf->aggregate_size) {
+        if ((curr_aggregate + req->write_size) > wb_inode->aggregate_size) {
             NEXT_HEAD(head, req);
             continue;
         }
@@ -1263,21 +1375,46 @@ wb_do_unwinds(wb_inode_t *wb_inode, list_head_t *lies)
     return;
 }
 
-void
+/* Returns the number of writes newly held back by max-dirty-size, which
+ * need another pass to be wound. */
+int
 __wb_pick_unwinds(wb_inode_t *wb_inode, list_head_t *lies)
 {
     wb_request_t *req = NULL;
     wb_request_t *tmp = NULL;
+    wb_conf_t *conf = NULL;
+    int throttled = 0;
     char gfid[64] = {
         0,
     };
 
+    conf = wb_inode->this->private;
+
     list_for_each_entry_safe(req, tmp, &wb_inode->temptation, lie)
     {
         if (!req->ordering.fulfilled &&
             wb_inode->window_current > wb_inode->window_conf)
             continue;
 
+        /* past the global limit, writes wait for their own ack, which
+         * holds the application back until the server catches up. The
+         * dirty data may well belong to other inodes, so the write must
+         * not sit in the queue waiting for more to aggregate with. */
+        if (!req->ordering.fulfilled && conf->adaptive_window &&
+            conf->dirty_limit &&
+            (GF_ATOMIC_GET(conf->dirty) + req->orig_size >
+             conf->dirty_limit)) {
+            if (!req->ordering.throttled) {
+                req->ordering.throttled = 1;
+                GF_ATOMIC_INC(conf->throttled);
+                if (!list_empty(&req->todo) && !req->ordering.go) {
+                    req->ordering.go = 1;
+                    throttled++;
+                }
+            }
+            continue;
+        }
+
         list_del_init(&req->lie);
         list_move_tail(&req->unwinds, lies);
 
@@ -1291,6 +1428,9 @@ __wb_pick_unwinds(wb_inode_t *wb_inode, list_head_t *lies)
 
             req->ordering.lied = 1;
 
+            req->dirty_size = req->orig_size;
+            GF_ATOMIC_ADD(conf->dirty, req->dirty_size);
+
             uuid_utoa_r(req->gfid, gfid);
             gf_msg_debug(wb_inode->this->name, 0,
                          "(unique=%" PRIu64
@@ -1303,7 +1443,7 @@ __wb_pick_unwinds(wb_inode_t *wb_inode, list_head_t *lies)
         }
     }
 
-    return;
+    return throttled;
 }
 
 int
@@ -1323,7 +1463,8 @@ __wb_collapse_small_writes(wb_conf_t *conf, wb_request_t *holder,
                                 holder->stub->args.count);
         req_len = iov_length(req->stub->args.vector, req->stub->args.count);
 
-        required_size = max((conf->page_size), (holder_len + req_len));
+        required_size = max((req->wb_inode->aggregate_size),
+                            (holder_len + req_len));
         iobuf = iobuf_get2(req->wb_inode->this->ctx->iobuf_pool, required_size);
         if (iobuf == NULL) {
             goto out;
@@ -1366,6 +1507,9 @@ __wb_collapse_small_writes(wb_conf_t *conf, wb_request_t *holder,
     holder->write_size += req->write_size;
     holder->ordering.size += req->write_size;
 
+    holder->dirty_size += req->dirty_size;
+    req->dirty_size = 0;
+
     ret = 0;
 out:
     return ret;
@@ -1396,7 +1540,7 @@ __wb_preprocess_winds(wb_inode_t *wb_inode)
     */
 
     conf = wb_inode->this->private;
-    page_size = conf->page_size;
+    page_size = wb_inode->aggregate_size;
 
     list_for_each_entry_safe(req, tmp, &wb_inode->todo, todo)
     {
@@ -1755,6 +1899,7 @@ wb_process_queue(wb_inode_t *wb_inode)
     list_head_t lies;
     list_head_t liabilities;
     int wind_failure = 0;
+    int throttled = 0;
 
     INIT_LIST_HEAD(&tasks);
     INIT_LIST_HEAD(&lies);
@@ -1770,7 +1915,7 @@ wb_process_queue(wb_inode_t *wb_inode)
 
             __wb_pick_winds(wb_inode, &tasks, &liabilities);
 
-            __wb_pick_unwinds(wb_inode, &lies);
+            throttled = __wb_pick_unwinds(wb_inode, &lies);
         }
         UNLOCK(&wb_inode->lock);
 
@@ -1786,7 +1931,7 @@ wb_process_queue(wb_inode_t *wb_inode)
          */
         if (!list_empty(&liabilities))
             wind_failure = wb_fulfill(wb_inode, &liabilities);
-    } while (wind_failure);
+    } while (wind_failure || throttled);
 
     return;
 }
@@ -2867,6 +3012,12 @@ wb_priv_dump(xlator_t *this)
     gf_proc_dump_write("window_size", "%" PRIu64, conf->window_size);
     gf_proc_dump_write("flush_behind", "%d", conf->flush_behind);
     gf_proc_dump_write("trickling_writes", "%d", conf->trickling_writes);
+    gf_proc_dump_write("adaptive_window", "%d", conf->adaptive_window);
+    gf_proc_dump_write("adaptive_window_max", "%" PRIu64, conf->window_max);
+    gf_proc_dump_write("max_dirty_size", "%" PRIu64, conf->dirty_limit);
+    gf_proc_dump_write("dirty_size", "%" PRId64, GF_ATOMIC_GET(conf->dirty));
+    gf_proc_dump_write("throttled_writes", "%" PRId64,
+                       GF_ATOMIC_GET(conf->throttled));
 
     ret = 0;
 out:
@@ -2983,6 +3134,13 @@ wb_inode_dump(xlator_t *this, inode_t *inode)
 
     gf_proc_dump_write("transit-size", "%" GF_PRI_SIZET, wb_inode->transit);
 
+    gf_proc_dump_write("aggregate-size", "%" PRIu64, wb_inode->aggregate_size);
+
+    gf_proc_dump_write("ack-latency-usec", "%" PRId64,
+                       wb_inode->ack_latency / 1000);
+
+    gf_proc_dump_write("ack-rate", "%" PRIu64, wb_inode->ack_rate);
+
     gf_proc_dump_write("dontsync", "%d", wb_inode->dontsync);
 
     ret = TRY_LOCK(&wb_inode->lock);
@@ -3049,6 +3207,15 @@ reconfigure(xlator_t *this, dict_t *options)
     GF_OPTION_RECONF("resync-failed-syncs-after-fsync",
                      conf->resync_after_fsync, options, bool, out);
 
+    GF_OPTION_RECONF("adaptive-window", conf->adaptive_window, options, bool,
+                     out);
+
+    GF_OPTION_RECONF("adaptive-window-max", conf->window_max, options,
+                     size_uint64, out);
+
+    GF_OPTION_RECONF("max-dirty-size", conf->dirty_limit, options, size_uint64,
+                     out);
+
     GF_OPTION_RECONF("pass-through", pass_through, options, bool, out);
     if (pass_through != this->pass_through) {
         gf_msg(this->name, GF_LOG_WARNING, ENOTSUP,
@@ -3124,6 +3291,15 @@ init(xlator_t *this)
     GF_OPTION_INIT("resync-failed-syncs-after-fsync", conf->resync_after_fsync,
                    bool, out);
 
+    GF_OPTION_INIT("adaptive-window", conf->adaptive_window, bool, out);
+
+    GF_OPTION_INIT("adaptive-window-max", conf->window_max, size_uint64, out);
+
+    GF_OPTION_INIT("max-dirty-size", conf->dirty_limit, size_uint64, out);
+
+    GF_ATOMIC_INIT(conf->dirty, 0);
+    GF_ATOMIC_INIT(conf->throttled, 0);
+
     GF_OPTION_INIT("pass-through", this->pass_through, bool, out);
 
     this->private = conf;
@@ -3278,6 +3454,45 @@ struct volume_options options[] = {
                        " so that writes are aggregated till a max of "
                        "\"aggregate-size\" bytes",
     },
+    {
+        .key = {"adaptive-window"},
+        .type = GF_OPTION_TYPE_BOOL,
+        .default_value = "off",
+        .op_version = {GD_OP_VERSION_10_0},
+        .flags = OPT_FLAG_SETTABLE | OPT_FLAG_DOC | OPT_FLAG_CLIENT_OPT,
+        .tags = {"write-behind"},
+        .description = "Size the write-behind buffer of each file from the "
+                       "measured latency and throughput of the writes to the "
+                       "server, between aggregate-size and "
+                       "adaptive-window-max, instead of using cache-size. "
+                       "The aggregate size grows with the buffer, up to 1MB.",
+    },
+    {
+        .key = {"adaptive-window-max"},
+        .type = GF_OPTION_TYPE_SIZET,
+        .min = 512 * GF_UNIT_KB,
+        .max = 1 * GF_UNIT_GB,
+        .default_value = "32MB",
+        .op_version = {GD_OP_VERSION_10_0},
+        .flags = OPT_FLAG_SETTABLE | OPT_FLAG_DOC | OPT_FLAG_CLIENT_OPT,
+        .tags = {"write-behind"},
+        .description = "Largest write-behind buffer of a single file "
+                       "(inode) with adaptive-window.",
+    },
+    {
+        .key = {"max-dirty-size"},
+        .type = GF_OPTION_TYPE_SIZET,
+        .min = 0,
+        .max = 32 * GF_UNIT_GB,
+        .default_value = "256MB",
+        .op_version = {GD_OP_VERSION_10_0},
+        .flags = OPT_FLAG_SETTABLE | OPT_FLAG_DOC | OPT_FLAG_CLIENT_OPT,
+        .tags = {"write-behind"},
+        .description = "With adaptive-window, the most data written behind "
+                       "and not yet acknowledged by the server, across all "
+                       "files. Past it, writes return only once written to "
+                       "the server. 0 means no limit.",
+    },
     {.key = {NULL}},
 };
 
@@ -926,3 +926,421 @@ out:
 
     return ret;
 }
+
+/* A loc based fop of a compound need not name its inode when an earlier
+ * fop of the same compound looks it up; the server then uses the gfid that
+ * lookup returned. */
+static gf_boolean_t
+client_compound_loc_is_chained(compound_args_t *args, int index)
+{
+    loc_t *loc = &args->req_list[index].loc;
+    int i = 0;
+
+    if (loc->inode && !gf_uuid_is_null(loc->inode->gfid))
+        return _gf_false;
+
+    if (!gf_uuid_is_null(loc->gfid))
+        return _gf_false;
+
+    for (i = 0; i < index; i++) {
+        if (args->enum_list[i] == GF_FOP_LOOKUP ||
+            args->enum_list[i] == GF_FOP_STAT)
+            return _gf_true;
+    }
+
+    return _gf_false;
+}
+
+/* Likewise an fd based fop can work on an fd which an earlier fop of the
+ * same compound opens. It is sent as an anonymous fd and the server swaps
+ * in the one it just opened. */
+static gf_boolean_t
+client_compound_fd_is_chained(xlator_t *this, compound_args_t *args,
+                              int index)
+{
+    fd_t *fd = args->req_list[index].fd;
+    int i = 0;
+
+    if (!fd || this_fd_get_ctx(fd, this))
+        return _gf_false;
+
+    for (i = 0; i < index; i++) {
+        if (args->enum_list[i] == GF_FOP_OPEN && args->req_list[i].fd == fd)
+            return _gf_true;
+    }
+
+    return _gf_false;
+}
+
+int
+client_handle_fop_requirements_v2(xlator_t *this, compound_args_t *args,
+                                  int index, compound_req_v2 *req)
+{
+    default_args_t *this_args = &args->req_list[index];
+    int ret = -EINVAL;
+
+    req->fop_enum = args->enum_list[index];
+
+    switch (req->fop_enum) {
+        case GF_FOP_LOOKUP:
+            ret = client_pre_lookup_v2(
+                this, &req->compound_req_v2_u.compound_lookup_req,
+                &this_args->loc, this_args->xdata);
+            break;
+        case GF_FOP_STAT:
+            if (client_compound_loc_is_chained(args, index)) {
+                dict_to_xdr(this_args->xdata,
+                            &req->compound_req_v2_u.compound_stat_req.xdata);
+                ret = 0;
+                break;
+            }
+            ret = client_pre_stat_v2(
+                this, &req->compound_req_v2_u.compound_stat_req,
+                &this_args->loc, this_args->xdata);
+            break;
+        case GF_FOP_OPEN:
+            if (client_compound_loc_is_chained(args, index)) {
+                req->compound_req_v2_u.compound_open_req.flags =
+                    gf_flags_from_flags(this_args->flags);
+                dict_to_xdr(this_args->xdata,
+                            &req->compound_req_v2_u.compound_open_req.xdata);
+                ret = 0;
+                break;
+            }
+            ret = client_pre_open_v2(
+                this, &req->compound_req_v2_u.compound_open_req,
+                &this_args->loc, this_args->fd, this_args->flags,
+                this_args->xdata);
+            break;
+        case GF_FOP_READ:
+            ret = client_pre_readv_v2(
+                this, &req->compound_req_v2_u.compound_read_req,
+                this_args->fd, this_args->size, this_args->offset,
+                this_args->flags, this_args->xdata);
+            break;
+        case GF_FOP_WRITE:
+            ret = client_pre_writev_v2(
+                this, &req->compound_req_v2_u.compound_write_req,
+                this_args->fd, iov_length(this_args->vector, this_args->count),
+                this_args->offset, this_args->flags, &this_args->xdata);
+            break;
+        case GF_FOP_FLUSH:
+            if (client_compound_fd_is_chained(this, args, index)) {
+                req->compound_req_v2_u.compound_flush_req.fd = GF_ANON_FD_NO;
+                memcpy(req->compound_req_v2_u.compound_flush_req.gfid,
+                       this_args->fd->inode->gfid, 16);
+                dict_to_xdr(this_args->xdata,
+                            &req->compound_req_v2_u.compound_flush_req.xdata);
+                ret = 0;
+                break;
+            }
+            ret = client_pre_flush_v2(
+                this, &req->compound_req_v2_u.compound_flush_req,
+                this_args->fd, this_args->xdata);
+            break;
+        case GF_FOP_FSTAT:
+            if (client_compound_fd_is_chained(this, args, index)) {
+                req->compound_req_v2_u.compound_fstat_req.fd = GF_ANON_FD_NO;
+                memcpy(req->compound_req_v2_u.compound_fstat_req.gfid,
+                       this_args->fd->inode->gfid, 16);
+                dict_to_xdr(this_args->xdata,
+                            &req->compound_req_v2_u.compound_fstat_req.xdata);
+                ret = 0;
+                break;
+            }
+            ret = client_pre_fstat_v2(
+                this, &req->compound_req_v2_u.compound_fstat_req,
+                this_args->fd, this_args->xdata);
+            break;
+        case GF_FOP_INODELK:
+            ret = client_pre_inodelk_v2(
+                this, &req->compound_req_v2_u.compound_inodelk_req,
+                &this_args->loc, this_args->cmd, &this_args->lock,
+                this_args->volume, this_args->xdata);
+            break;
+        case GF_FOP_FINODELK:
+            ret = client_pre_finodelk_v2(
+                this, &req->compound_req_v2_u.compound_finodelk_req,
+                this_args->fd, this_args->cmd, &this_args->lock,
+                this_args->volume, this_args->xdata);
+            break;
+        case GF_FOP_XATTROP:
+            ret = client_pre_xattrop_v2(
+                this, &req->compound_req_v2_u.compound_xattrop_req,
+                &this_args->loc, this_args->xattr, this_args->optype,
+                this_args->xdata);
+            break;
+        case GF_FOP_FXATTROP:
+            ret = client_pre_fxattrop_v2(
+                this, &req->compound_req_v2_u.compound_fxattrop_req,
+                this_args->fd, this_args->xattr, this_args->optype,
+                this_args->xdata);
+            break;
+        default:
+            /* only the fops the server knows how to run in a compound */
+            ret = -ENOTSUP;
+            break;
+    }
+
+    return ret;
+}
+
+void
+compound_request_cleanup_v2(gfx_compound_req *req)
+{
+    compound_req_v2 *curr_req = NULL;
+    int i = 0;
+
+    if (!req->compound_req_array.compound_req_array_val)
+        return;
+
+    for (i = 0; i < req->compound_req_array.compound_req_array_len; i++) {
+        curr_req = &req->compound_req_array.compound_req_array_val[i];
+
+        switch (curr_req->fop_enum) {
+            case GF_FOP_LOOKUP:
+                GF_FREE(curr_req->compound_req_v2_u.compound_lookup_req.xdata
+                            .pairs.pairs_val);
+                break;
+            case GF_FOP_STAT:
+                GF_FREE(curr_req->compound_req_v2_u.compound_stat_req.xdata
+                            .pairs.pairs_val);
+                break;
+            case GF_FOP_OPEN:
+                GF_FREE(curr_req->compound_req_v2_u.compound_open_req.xdata
+                            .pairs.pairs_val);
+                break;
+            case GF_FOP_READ:
+                GF_FREE(curr_req->compound_req_v2_u.compound_read_req.xdata
+                            .pairs.pairs_val);
+                break;
+            case GF_FOP_WRITE:
+                GF_FREE(curr_req->compound_req_v2_u.compound_write_req.xdata
+                            .pairs.pairs_val);
+                break;
+            case GF_FOP_FLUSH:
+                GF_FREE(curr_req->compound_req_v2_u.compound_flush_req.xdata
+                            .pairs.pairs_val);
+                break;
+            case GF_FOP_FSTAT:
+                GF_FREE(curr_req->compound_req_v2_u.compound_fstat_req.xdata
+                            .pairs.pairs_val);
+                break;
+            case GF_FOP_INODELK:
+                GF_FREE(curr_req->compound_req_v2_u.compound_inodelk_req.xdata
+                            .pairs.pairs_val);
+                break;
+            case GF_FOP_FINODELK:
+                GF_FREE(curr_req->compound_req_v2_u.compound_finodelk_req.xdata
+                            .pairs.pairs_val);
+                break;
+            case GF_FOP_XATTROP:
+                GF_FREE(curr_req->compound_req_v2_u.compound_xattrop_req.dict
+                            .pairs.pairs_val);
+                GF_FREE(curr_req->compound_req_v2_u.compound_xattrop_req.xdata
+                            .pairs.pairs_val);
+                break;
+            case GF_FOP_FXATTROP:
+                GF_FREE(curr_req->compound_req_v2_u.compound_fxattrop_req.dict
+                            .pairs.pairs_val);
+                GF_FREE(curr_req->compound_req_v2_u.compound_fxattrop_req
+                            .xdata.pairs.pairs_val);
+                break;
+            default:
+                break;
+        }
+    }
+
+    GF_FREE(req->compound_req_array.compound_req_array_val);
+    req->compound_req_array.compound_req_array_val = NULL;
+}
+
+/* Unpacks the reply of one fop of a compound into @args_cbk. The data of
+ * READ fops follows the reply header in @payload, in the order of the fops;
+ * it is consumed from the front as the replies are processed. */
+int
+client_process_response_v2(call_frame_t *frame, xlator_t *this,
+                           struct rpc_req *req, compound_rsp_v2 *rsp,
+                           compound_args_t *args, compound_args_cbk_t *args_cbk,
+                           int index, struct iovec *payload)
+{
+    default_args_t *this_args = &args->req_list[index];
+    default_args_cbk_t *this_args_cbk = &args_cbk->rsp_list[index];
+    struct iatt iatt = {
+        0,
+    };
+    struct iatt iatt2 = {
+        0,
+    };
+    struct iovec vector[MAX_IOVEC] = {
+        {
+            0,
+        },
+    };
+    struct iobref *iobref = NULL;
+    dict_t *xdata = NULL;
+    dict_t *xattr = NULL;
+    int op_ret = 0;
+    int op_errno = 0;
+    int count = 0;
+    int ret = 0;
+
+    args_cbk->enum_list[index] = rsp->fop_enum;
+
+    if (rsp->fop_enum != args->enum_list[index]) {
+        gf_smsg(this->name, GF_LOG_ERROR, EINVAL, PC_MSG_XDR_DECODING_FAILED,
+                "index=%d", index, NULL);
+        ret = -EINVAL;
+        goto out;
+    }
+
+    switch (rsp->fop_enum) {
+        case GF_FOP_LOOKUP: {
+            gfx_common_2iatt_rsp *this_rsp = &rsp->compound_rsp_v2_u
+                                                  .compound_lookup_rsp;
+
+            op_ret = this_rsp->op_ret;
+            op_errno = gf_error_to_errno(this_rsp->op_errno);
+            client_post_common_2iatt(this, this_rsp, &iatt, &iatt2, &xdata);
+            if ((op_ret == 0) && this_args->loc.inode &&
+                !gf_uuid_is_null(this_args->loc.inode->gfid) &&
+                gf_uuid_compare(iatt.ia_gfid, this_args->loc.inode->gfid)) {
+                op_ret = -1;
+                op_errno = ESTALE;
+            }
+            args_lookup_cbk_store(this_args_cbk, op_ret, op_errno,
+                                  this_args->loc.inode, &iatt, xdata, &iatt2);
+            break;
+        }
+        case GF_FOP_STAT:
+        case GF_FOP_FSTAT: {
+            gfx_common_iatt_rsp *this_rsp = &rsp->compound_rsp_v2_u
+                                                 .compound_stat_rsp;
+
+            if (rsp->fop_enum == GF_FOP_FSTAT)
+                this_rsp = &rsp->compound_rsp_v2_u.compound_fstat_rsp;
+
+            op_ret = this_rsp->op_ret;
+            op_errno = gf_error_to_errno(this_rsp->op_errno);
+            client_post_common_iatt(this, this_rsp, &iatt, &xdata);
+            if (rsp->fop_enum == GF_FOP_STAT)
+                args_stat_cbk_store(this_args_cbk, op_ret, op_errno, &iatt,
+                                    xdata);
+            else
+                args_fstat_cbk_store(this_args_cbk, op_ret, op_errno, &iatt,
+                                     xdata);
+            break;
+        }
+        case GF_FOP_OPEN: {
+            gfx_open_rsp *this_rsp = &rsp->compound_rsp_v2_u.compound_open_rsp;
+
+            op_ret = this_rsp->op_ret;
+            op_errno = gf_error_to_errno(this_rsp->op_errno);
+            xdr_to_dict(&this_rsp->xdata, &xdata);
+            if (op_ret != -1) {
+                ret = client_add_fd_to_saved_fds(this, this_args->fd,
+                                                 &this_args->loc,
+                                                 this_args->flags,
+                                                 this_rsp->fd, 0);
+                if (ret) {
+                    op_ret = -1;
+                    op_errno = -ret;
+                    ret = 0;
+                }
+            }
+            args_open_cbk_store(this_args_cbk, op_ret, op_errno, this_args->fd,
+                                xdata);
+            break;
+        }
+        case GF_FOP_READ: {
+            gfx_read_rsp *this_rsp = &rsp->compound_rsp_v2_u.compound_read_rsp;
+
+            op_ret = this_rsp->op_ret;
+            op_errno = gf_error_to_errno(this_rsp->op_errno);
+            if ((op_ret >= 0) &&
+                ((op_ret > payload->iov_len) || !req->rsp_iobref)) {
+                ret = -EINVAL;
+                goto out;
+            }
+            client_post_readv_v2(this, this_rsp, &iobref, req->rsp_iobref,
+                                 &iatt, vector, payload, &count, &xdata);
+            if (op_ret > 0) {
+                payload->iov_base += op_ret;
+                payload->iov_len -= op_ret;
+            }
+            args_readv_cbk_store(this_args_cbk, op_ret, op_errno, vector, count,
+                                 &iatt, iobref, xdata);
+            break;
+        }
+        case GF_FOP_WRITE: {
+            gfx_common_2iatt_rsp *this_rsp = &rsp->compound_rsp_v2_u
+                                                  .compound_write_rsp;
+
+            op_ret = this_rsp->op_ret;
+            op_errno = gf_error_to_errno(this_rsp->op_errno);
+            client_post_common_2iatt(this, this_rsp, &iatt, &iatt2, &xdata);
+            args_writev_cbk_store(this_args_cbk, op_ret, op_errno, &iatt,
+                                  &iatt2, xdata);
+            break;
+        }
+        case GF_FOP_FLUSH:
+        case GF_FOP_INODELK:
+        case GF_FOP_FINODELK: {
+            gfx_common_rsp *this_rsp = &rsp->compound_rsp_v2_u
+                                            .compound_flush_rsp;
+
+            if (rsp->fop_enum == GF_FOP_INODELK)
+                this_rsp = &rsp->compound_rsp_v2_u.compound_inodelk_rsp;
+            else if (rsp->fop_enum == GF_FOP_FINODELK)
+                this_rsp = &rsp->compound_rsp_v2_u.compound_finodelk_rsp;
+
+            op_ret = this_rsp->op_ret;
+            op_errno = gf_error_to_errno(this_rsp->op_errno);
+            xdr_to_dict(&this_rsp->xdata, &xdata);
+            if (rsp->fop_enum == GF_FOP_FLUSH)
+                args_flush_cbk_store(this_args_cbk, op_ret, op_errno, xdata);
+            else if (rsp->fop_enum == GF_FOP_INODELK)
+                args_inodelk_cbk_store(this_args_cbk, op_ret, op_errno, xdata);
+            else
+                args_finodelk_cbk_store(this_args_cbk, op_ret, op_errno,
+                                        xdata);
+            break;
+        }
+        case GF_FOP_XATTROP:
+        case GF_FOP_FXATTROP: {
+            gfx_common_dict_rsp *this_rsp = &rsp->compound_rsp_v2_u
+                                                 .compound_xattrop_rsp;
+
+            if (rsp->fop_enum == GF_FOP_FXATTROP)
+                this_rsp = &rsp->compound_rsp_v2_u.compound_fxattrop_rsp;
+
+            op_ret = this_rsp->op_ret;
+            op_errno = gf_error_to_errno(this_rsp->op_errno);
+            client_post_common_dict(this, this_rsp, &xattr, &xdata);
+            if (rsp->fop_enum == GF_FOP_XATTROP)
+                args_xattrop_cbk_store(this_args_cbk, op_ret, op_errno, xattr,
+                                       xdata);
+            else
+                args_fxattrop_cbk_store(this_args_cbk, op_ret, op_errno, xattr,
+                                        xdata);
+            break;
+        }
+        default:
+            ret = -ENOTSUP;
+            goto out;
+    }
+
+    if (op_ret == -1)
+        gf_smsg(this->name,
+                fop_log_level(rsp->fop_enum, op_errno), op_errno,
+                PC_MSG_REMOTE_OP_FAILED, "fop=%s", gf_fop_list[rsp->fop_enum],
+                "index=%d", index, NULL);
+out:
+    if (xdata)
+        dict_unref(xdata);
+
+    if (xattr)
+        dict_unref(xattr);
+
+    return ret;
+}
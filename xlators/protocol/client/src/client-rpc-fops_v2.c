@@ -5972,6 +5972,222 @@ unwind:
     return 0;
 }
 
+int
+client4_0_compound_cbk(struct rpc_req *req, struct iovec *iov, int count,
+                       void *myframe)
+{
+    gfx_compound_rsp rsp = {
+        0,
+    };
+    compound_args_cbk_t *args_cbk = NULL;
+    compound_args_t *args = NULL;
+    call_frame_t *frame = NULL;
+    clnt_local_t *local = NULL;
+    xlator_t *this = NULL;
+    dict_t *xdata = NULL;
+    struct iovec payload = {
+        0,
+    };
+    int length = 0;
+    int op_errno = EINVAL;
+    int ret = 0;
+    int err = 0;
+    int i = 0;
+
+    this = THIS;
+
+    frame = myframe;
+    local = frame->local;
+    args = local->compound_args;
+
+    if (-1 == req->rpc_status) {
+        rsp.op_ret = -1;
+        op_errno = ENOTCONN;
+        goto out;
+    }
+
+    ret = xdr_to_generic(*iov, &rsp, (xdrproc_t)xdr_gfx_compound_rsp);
+    if (ret < 0) {
+        gf_smsg(this->name, GF_LOG_ERROR, EINVAL, PC_MSG_XDR_DECODING_FAILED,
+                NULL);
+        rsp.op_ret = -1;
+        op_errno = EINVAL;
+        goto out;
+    }
+
+    /* the data of READ fops follows the reply header */
+    payload.iov_base = iov->iov_base + ret;
+    payload.iov_len = iov->iov_len - ret;
+
+    length = rsp.compound_rsp_array.compound_rsp_array_len;
+    if (length != args->fop_length) {
+        gf_smsg(this->name, GF_LOG_ERROR, EINVAL, PC_MSG_XDR_DECODING_FAILED,
+                "fops=%d", length, NULL);
+        rsp.op_ret = -1;
+        op_errno = EINVAL;
+        goto out;
+    }
+
+    args_cbk = compound_args_cbk_alloc(length, NULL);
+    if (!args_cbk) {
+        rsp.op_ret = -1;
+        op_errno = ENOMEM;
+        goto out;
+    }
+
+    op_errno = gf_error_to_errno(rsp.op_errno);
+
+    /* every reply has to be looked at, they own memory of the decoder */
+    for (i = 0; i < length; i++) {
+        ret = client_process_response_v2(
+            frame, this, req, &rsp.compound_rsp_array.compound_rsp_array_val[i],
+            args, args_cbk, i, &payload);
+        if (ret && !err)
+            err = ret;
+    }
+
+    if (err) {
+        rsp.op_ret = -1;
+        op_errno = -err;
+        compound_args_cbk_cleanup(args_cbk);
+        args_cbk = NULL;
+    }
+
+    xdr_to_dict(&rsp.xdata, &xdata);
+out:
+    if (rsp.op_ret == -1 && !args_cbk) {
+        gf_smsg(this->name, GF_LOG_WARNING, op_errno, PC_MSG_REMOTE_OP_FAILED,
+                "fop=%s", "COMPOUND", NULL);
+    }
+
+    CLIENT_STACK_UNWIND(compound, frame, rsp.op_ret, op_errno, args_cbk,
+                        xdata);
+
+    free(rsp.compound_rsp_array.compound_rsp_array_val);
+
+    if (xdata)
+        dict_unref(xdata);
+
+    compound_args_cbk_cleanup(args_cbk);
+
+    return 0;
+}
+
+/* Sends all the fops of @data in one GFS3_OP_COMPOUND request. The server
+ * runs them in order and stops at the first failure, apart from unlocks
+ * which always run, unless GF_COMPOUND_INDEPENDENT_KEY is set in the xdata
+ * of the compound. The data of WRITE fops is sent as the payload of the
+ * request, in the order of the fops. */
+int32_t
+client4_0_compound(call_frame_t *frame, xlator_t *this, void *data)
+{
+    compound_args_t *args = NULL;
+    default_args_t *this_args = NULL;
+    clnt_conf_t *conf = NULL;
+    clnt_local_t *local = NULL;
+    gfx_compound_req req = {
+        0,
+    };
+    client_payload_t cp;
+    struct iovec vector[MAX_IOVEC];
+    struct iobref *req_iobref = NULL;
+    int length = 0;
+    int count = 0;
+    int op_errno = ENOMEM;
+    int ret = 0;
+    int i = 0;
+
+    if (!frame || !this || !data) {
+        op_errno = EINVAL;
+        goto unwind;
+    }
+
+    args = data;
+    conf = this->private;
+    length = args->fop_length;
+
+    if ((length <= 0) || (length > GF_COMPOUND_MAX_FOPS)) {
+        op_errno = EINVAL;
+        goto unwind;
+    }
+
+    local = mem_get0(this->local_pool);
+    if (!local)
+        goto unwind;
+    frame->local = local;
+    local->compound_args = args;
+
+    req.compound_req_array.compound_req_array_val = GF_CALLOC(
+        length, sizeof(compound_req_v2), gf_client_mt_compound_req_t);
+    if (!req.compound_req_array.compound_req_array_val)
+        goto unwind;
+    req.compound_req_array.compound_req_array_len = length;
+
+    for (i = 0; i < length; i++) {
+        ret = client_handle_fop_requirements_v2(
+            this, args, i, &req.compound_req_array.compound_req_array_val[i]);
+        if (ret) {
+            op_errno = -ret;
+            goto unwind;
+        }
+
+        if (args->enum_list[i] != GF_FOP_WRITE)
+            continue;
+
+        this_args = &args->req_list[i];
+        if (count + this_args->count > MAX_IOVEC) {
+            op_errno = EINVAL;
+            goto unwind;
+        }
+        memcpy(&vector[count], this_args->vector,
+               this_args->count * sizeof(struct iovec));
+        count += this_args->count;
+
+        if (this_args->iobref) {
+            if (!req_iobref) {
+                req_iobref = iobref_new();
+                if (!req_iobref) {
+                    op_errno = ENOMEM;
+                    goto unwind;
+                }
+            }
+            iobref_merge(req_iobref, this_args->iobref);
+        }
+    }
+
+    dict_to_xdr(args->xdata, &req.xdata);
+
+    memset(&cp, 0, sizeof(client_payload_t));
+    cp.iobref = req_iobref;
+    cp.payload = vector;
+    cp.payload_cnt = count;
+    ret = client_submit_request(this, &req, frame, conf->fops,
+                                GFS3_OP_COMPOUND, client4_0_compound_cbk, &cp,
+                                (xdrproc_t)xdr_gfx_compound_req);
+    if (ret) {
+        gf_smsg(this->name, GF_LOG_WARNING, 0, PC_MSG_FOP_SEND_FAILED, NULL);
+    }
+
+    if (req_iobref)
+        iobref_unref(req_iobref);
+
+    compound_request_cleanup_v2(&req);
+    GF_FREE(req.xdata.pairs.pairs_val);
+
+    return 0;
+
+unwind:
+    CLIENT_STACK_UNWIND(compound, frame, -1, op_errno, NULL, NULL);
+
+    if (req_iobref)
+        iobref_unref(req_iobref);
+
+    compound_request_cleanup_v2(&req);
+    GF_FREE(req.xdata.pairs.pairs_val);
+
+    return 0;
+}
+
 int32_t
 client4_0_fsetattr(call_frame_t *frame, xlator_t *this, void *data)
 {
@@ -6170,7 +6386,7 @@ rpc_clnt_procedure_t clnt4_0_fop_actors[GF_FOP_MAXVALUE] = {
     [GF_FOP_LEASE] = {"LEASE", client4_0_lease},
     [GF_FOP_GETACTIVELK] = {"GETACTIVELK", client4_0_getactivelk},
     [GF_FOP_SETACTIVELK] = {"SETACTIVELK", client4_0_setactivelk},
-    [GF_FOP_COMPOUND] = {"COMPOUND", NULL},
+    [GF_FOP_COMPOUND] = {"COMPOUND", client4_0_compound},
     [GF_FOP_ICREATE] = {"ICREATE", client4_0_icreate},
     [GF_FOP_NAMELINK] = {"NAMELINK", client4_0_namelink},
     [GF_FOP_COPY_FILE_RANGE] = {"COPY-FILE-RANGE", client4_0_copy_file_range},
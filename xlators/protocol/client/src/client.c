@@ -2071,10 +2071,15 @@ client_compound(call_frame_t *frame, xlator_t *this, void *data, dict_t *xdata)
         goto out;
 
     proc = &conf->fops->proctable[GF_FOP_COMPOUND];
-    if (proc->fn) {
-        args->xdata = xdata;
-        ret = proc->fn(frame, this, args);
+    if (!proc->fn) {
+        /* the GlusterFS 3.3 program can not carry compound fops */
+        STACK_UNWIND_STRICT(compound, frame, -1, ENOTSUP, NULL, NULL);
+        return 0;
     }
+
+    if (xdata && !args->xdata)
+        args->xdata = dict_ref(xdata);
+    ret = proc->fn(frame, this, args);
 out:
     if (ret)
         STACK_UNWIND_STRICT(compound, frame, -1, ENOTCONN, NULL, NULL);
@@ -2817,6 +2822,7 @@ client_priv_dump(xlator_t *this)
                            conn->trans->total_bytes_write);
         gf_proc_dump_write("ping_msgs_sent", "%" PRIu64, conn->pingcnt);
         gf_proc_dump_write("msgs_sent", "%" PRIu64, conn->msgcnt);
+        rpc_clnt_saved_frames_dump(conf->rpc);
     }
     pthread_mutex_unlock(&conf->lock);
 
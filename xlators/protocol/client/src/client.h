@@ -215,6 +215,8 @@ typedef struct client_local {
      * only for copy_file_range fop
      */
     gf_boolean_t attempt_reopen_out;
+    /* only for compound fop, the caller keeps it alive till the unwind */
+    compound_args_t *compound_args;
 } clnt_local_t;
 
 typedef struct client_args {
@@ -404,4 +406,17 @@ client_is_setlk(int32_t cmd);
 gf_boolean_t
 fdctx_lock_lists_empty(clnt_fd_ctx_t *fdctx);
 
+int
+client_handle_fop_requirements_v2(xlator_t *this, compound_args_t *args,
+                                  int index, compound_req_v2 *req);
+
+void
+compound_request_cleanup_v2(gfx_compound_req *req);
+
+int
+client_process_response_v2(call_frame_t *frame, xlator_t *this,
+                           struct rpc_req *req, compound_rsp_v2 *rsp,
+                           compound_args_t *args, compound_args_cbk_t *args_cbk,
+                           int index, struct iovec *payload);
+
 #endif /* !_CLIENT_H */
@@ -204,6 +204,9 @@ free_state(server_state_t *state)
     server_resolve_wipe(&state->resolve);
     server_resolve_wipe(&state->resolve2);
 
+    server_compound_ctx_free(state->compound);
+    state->compound = NULL;
+
     /* Call rpc_trnasport_unref to avoid crashes at last after free
        all resources because of server_rpc_notify (for transport destroy)
        call's xlator_mem_cleanup if all xprt are destroyed that internally
@@ -1204,6 +1207,102 @@ getactivelkinfo_rsp_cleanup_v2(gfx_getactivelk_rsp *rsp)
     return 0;
 }
 
+void
+server_compound_rsp_cleanup_v2(compound_rsp_v2 *rsp, int count)
+{
+    compound_rsp_v2 *this_rsp = NULL;
+    int i = 0;
+
+    for (i = 0; i < count; i++) {
+        this_rsp = &rsp[i];
+        switch (this_rsp->fop_enum) {
+            case GF_FOP_LOOKUP:
+                GF_FREE(this_rsp->compound_rsp_v2_u.compound_lookup_rsp.xdata
+                            .pairs.pairs_val);
+                break;
+            case GF_FOP_STAT:
+                GF_FREE(this_rsp->compound_rsp_v2_u.compound_stat_rsp.xdata
+                            .pairs.pairs_val);
+                break;
+            case GF_FOP_OPEN:
+                GF_FREE(this_rsp->compound_rsp_v2_u.compound_open_rsp.xdata
+                            .pairs.pairs_val);
+                break;
+            case GF_FOP_READ:
+                GF_FREE(this_rsp->compound_rsp_v2_u.compound_read_rsp.xdata
+                            .pairs.pairs_val);
+                break;
+            case GF_FOP_WRITE:
+                GF_FREE(this_rsp->compound_rsp_v2_u.compound_write_rsp.xdata
+                            .pairs.pairs_val);
+                break;
+            case GF_FOP_FLUSH:
+                GF_FREE(this_rsp->compound_rsp_v2_u.compound_flush_rsp.xdata
+                            .pairs.pairs_val);
+                break;
+            case GF_FOP_FSTAT:
+                GF_FREE(this_rsp->compound_rsp_v2_u.compound_fstat_rsp.xdata
+                            .pairs.pairs_val);
+                break;
+            case GF_FOP_INODELK:
+                GF_FREE(this_rsp->compound_rsp_v2_u.compound_inodelk_rsp.xdata
+                            .pairs.pairs_val);
+                break;
+            case GF_FOP_FINODELK:
+                GF_FREE(this_rsp->compound_rsp_v2_u.compound_finodelk_rsp.xdata
+                            .pairs.pairs_val);
+                break;
+            case GF_FOP_XATTROP:
+                GF_FREE(this_rsp->compound_rsp_v2_u.compound_xattrop_rsp.dict
+                            .pairs.pairs_val);
+                GF_FREE(this_rsp->compound_rsp_v2_u.compound_xattrop_rsp.xdata
+                            .pairs.pairs_val);
+                break;
+            case GF_FOP_FXATTROP:
+                GF_FREE(this_rsp->compound_rsp_v2_u.compound_fxattrop_rsp.dict
+                            .pairs.pairs_val);
+                GF_FREE(this_rsp->compound_rsp_v2_u.compound_fxattrop_rsp.xdata
+                            .pairs.pairs_val);
+                break;
+            default:
+                break;
+        }
+    }
+}
+
+void
+server_compound_ctx_free(server_compound_ctx_t *ctx)
+{
+    server_compound_step_t *step = NULL;
+    int i = 0;
+
+    if (!ctx)
+        return;
+
+    if (ctx->rsp) {
+        server_compound_rsp_cleanup_v2(ctx->rsp, ctx->count);
+        GF_FREE(ctx->rsp);
+    }
+
+    if (ctx->steps) {
+        for (i = 0; i < ctx->count; i++) {
+            step = &ctx->steps[i];
+            GF_FREE(step->bname);
+            args_wipe(&step->args);
+            if (step->rsp_xdata)
+                dict_unref(step->rsp_xdata);
+            if (step->rsp_dict)
+                dict_unref(step->rsp_dict);
+        }
+        GF_FREE(ctx->steps);
+    }
+
+    if (ctx->rsp_iobref)
+        iobref_unref(ctx->rsp_iobref);
+
+    GF_FREE(ctx);
+}
+
 int
 gf_server_check_getxattr_cmd(call_frame_t *frame, const char *key)
 {
@@ -36,6 +36,9 @@ free_state(server_state_t *state);
 void
 server_loc_wipe(loc_t *loc);
 
+void
+server_resolve_wipe(server_resolve_t *resolve);
+
 void
 server_print_request(call_frame_t *frame);
 
@@ -104,4 +107,10 @@ serialize_rsp_dirent_v2(gf_dirent_t *entries, gfx_readdir_rsp *rsp);
 int
 serialize_rsp_direntp_v2(gf_dirent_t *entries, gfx_readdirp_rsp *rsp);
 
+void
+server_compound_rsp_cleanup_v2(compound_rsp_v2 *rsp, int count);
+
+void
+server_compound_ctx_free(server_compound_ctx_t *ctx);
+
 #endif /* !_SERVER_HELPERS_H */
@@ -138,6 +138,7 @@ GLFS_MSGID(
 #define PS_MSG_ZEROFILL_INFO_STR "ZEROFILL info"
 #define PS_MSG_SERVER_IPC_INFO_STR "IPC info"
 #define PS_MSG_SEEK_INFO_STR "SEEK info"
+#define PS_MSG_COMPOUND_INFO_STR "COMPOUND info"
 #define PS_MSG_SETACTIVELK_INFO_STR "SETACTIVELK info"
 #define PS_MSG_CREATE_INFO_STR "CREATE info"
 #define PS_MSG_PUT_INFO_STR "PUT info"
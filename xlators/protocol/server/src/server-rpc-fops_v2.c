@@ -5872,11 +5872,896 @@ out:
     return ret;
 }
 
+static int
+server4_compound_next(call_frame_t *frame);
+
+#define SERVER4_COMPOUND_RSP(ctx, fop)                                        \
+    (&(ctx)->rsp[(ctx)->current].compound_rsp_v2_u.compound_##fop##_rsp)
+
+#define SERVER4_COMPOUND_SET_ERROR(rsp, fop, errnum)                          \
+    do {                                                                       \
+        (rsp)->compound_rsp_v2_u.compound_##fop##_rsp.op_ret = -1;             \
+        (rsp)->compound_rsp_v2_u.compound_##fop##_rsp.op_errno =               \
+            gf_errno_to_error(errnum);                                         \
+        dict_to_xdr(NULL, &(rsp)->compound_rsp_v2_u.compound_##fop##_rsp       \
+                               .xdata);                                        \
+    } while (0)
+
+static void
+server4_compound_rsp_set_error(compound_rsp_v2 *rsp, glusterfs_fop_t fop,
+                               int op_errno)
+{
+    rsp->fop_enum = fop;
+
+    switch (fop) {
+        case GF_FOP_LOOKUP:
+            SERVER4_COMPOUND_SET_ERROR(rsp, lookup, op_errno);
+            break;
+        case GF_FOP_STAT:
+            SERVER4_COMPOUND_SET_ERROR(rsp, stat, op_errno);
+            break;
+        case GF_FOP_OPEN:
+            SERVER4_COMPOUND_SET_ERROR(rsp, open, op_errno);
+            break;
+        case GF_FOP_READ:
+            SERVER4_COMPOUND_SET_ERROR(rsp, read, op_errno);
+            break;
+        case GF_FOP_WRITE:
+            SERVER4_COMPOUND_SET_ERROR(rsp, write, op_errno);
+            break;
+        case GF_FOP_FLUSH:
+            SERVER4_COMPOUND_SET_ERROR(rsp, flush, op_errno);
+            break;
+        case GF_FOP_FSTAT:
+            SERVER4_COMPOUND_SET_ERROR(rsp, fstat, op_errno);
+            break;
+        case GF_FOP_INODELK:
+            SERVER4_COMPOUND_SET_ERROR(rsp, inodelk, op_errno);
+            break;
+        case GF_FOP_FINODELK:
+            SERVER4_COMPOUND_SET_ERROR(rsp, finodelk, op_errno);
+            break;
+        case GF_FOP_XATTROP:
+            SERVER4_COMPOUND_SET_ERROR(rsp, xattrop, op_errno);
+            dict_to_xdr(NULL, &rsp->compound_rsp_v2_u.compound_xattrop_rsp.dict);
+            break;
+        case GF_FOP_FXATTROP:
+            SERVER4_COMPOUND_SET_ERROR(rsp, fxattrop, op_errno);
+            dict_to_xdr(NULL,
+                        &rsp->compound_rsp_v2_u.compound_fxattrop_rsp.dict);
+            break;
+        default:
+            break;
+    }
+}
+
+/* Records the outcome of the current step and moves on to the next one. The
+ * reply of the step itself has already been filled in by the caller. */
+static int
+server4_compound_step_done(call_frame_t *frame, int32_t op_ret,
+                           int32_t op_errno, dict_t *xdata)
+{
+    server_state_t *state = NULL;
+    server_compound_ctx_t *ctx = NULL;
+    server_compound_step_t *step = NULL;
+
+    state = CALL_STATE(frame);
+    ctx = state->compound;
+    step = &ctx->steps[ctx->current];
+
+    if (xdata)
+        step->rsp_xdata = dict_ref(xdata);
+
+    if (op_ret < 0) {
+        gf_msg_debug(frame->this->name, op_errno,
+                     "%" PRId64 ": compound step %d (%s) failed",
+                     frame->root->unique, ctx->current,
+                     gf_fop_list[step->fop]);
+        if (ctx->op_ret == 0 && !ctx->independent) {
+            ctx->op_ret = -1;
+            ctx->op_errno = op_errno;
+        }
+    }
+
+    ctx->current++;
+
+    return server4_compound_next(frame);
+}
+
+static int
+server4_compound_step_fail(call_frame_t *frame, int32_t op_errno)
+{
+    server_state_t *state = NULL;
+    server_compound_ctx_t *ctx = NULL;
+
+    state = CALL_STATE(frame);
+    ctx = state->compound;
+
+    server4_compound_rsp_set_error(&ctx->rsp[ctx->current],
+                                   ctx->steps[ctx->current].fop, op_errno);
+
+    return server4_compound_step_done(frame, -1, op_errno, NULL);
+}
+
+static int
+server4_compound_lookup_cbk(call_frame_t *frame, void *cookie, xlator_t *this,
+                            int32_t op_ret, int32_t op_errno, inode_t *inode,
+                            struct iatt *stbuf, dict_t *xdata,
+                            struct iatt *postparent)
+{
+    server_state_t *state = NULL;
+    server_compound_ctx_t *ctx = NULL;
+    gfx_common_2iatt_rsp *rsp = NULL;
+
+    state = CALL_STATE(frame);
+    ctx = state->compound;
+    ctx->rsp[ctx->current].fop_enum = GF_FOP_LOOKUP;
+    rsp = SERVER4_COMPOUND_RSP(ctx, lookup);
+
+    if (postparent)
+        gfx_stat_from_iattx(&rsp->poststat, postparent);
+    dict_to_xdr(xdata, &rsp->xdata);
+
+    if (op_ret == 0) {
+        gf_uuid_copy(ctx->last_gfid, inode->gfid);
+        server4_post_lookup(rsp, frame, state, inode, stbuf);
+    }
+
+    rsp->op_ret = op_ret;
+    rsp->op_errno = gf_errno_to_error(op_errno);
+
+    return server4_compound_step_done(frame, op_ret, op_errno, xdata);
+}
+
+static int
+server4_compound_stat_cbk(call_frame_t *frame, void *cookie, xlator_t *this,
+                          int32_t op_ret, int32_t op_errno, struct iatt *stbuf,
+                          dict_t *xdata)
+{
+    server_state_t *state = NULL;
+    server_compound_ctx_t *ctx = NULL;
+    gfx_common_iatt_rsp *rsp = NULL;
+
+    state = CALL_STATE(frame);
+    ctx = state->compound;
+    ctx->rsp[ctx->current].fop_enum = frame->root->op;
+    if (frame->root->op == GF_FOP_FSTAT)
+        rsp = SERVER4_COMPOUND_RSP(ctx, fstat);
+    else
+        rsp = SERVER4_COMPOUND_RSP(ctx, stat);
+
+    dict_to_xdr(xdata, &rsp->xdata);
+
+    if (op_ret == 0) {
+        gf_uuid_copy(ctx->last_gfid, stbuf->ia_gfid);
+        server4_post_common_iatt(state, rsp, stbuf);
+    }
+
+    rsp->op_ret = op_ret;
+    rsp->op_errno = gf_errno_to_error(op_errno);
+
+    return server4_compound_step_done(frame, op_ret, op_errno, xdata);
+}
+
+static int
+server4_compound_open_cbk(call_frame_t *frame, void *cookie, xlator_t *this,
+                          int32_t op_ret, int32_t op_errno, fd_t *fd,
+                          dict_t *xdata)
+{
+    server_state_t *state = NULL;
+    server_compound_ctx_t *ctx = NULL;
+    gfx_open_rsp *rsp = NULL;
+
+    state = CALL_STATE(frame);
+    ctx = state->compound;
+    ctx->rsp[ctx->current].fop_enum = GF_FOP_OPEN;
+    rsp = SERVER4_COMPOUND_RSP(ctx, open);
+
+    dict_to_xdr(xdata, &rsp->xdata);
+
+    if (op_ret == 0) {
+        op_ret = server4_post_open(frame, this, rsp, fd);
+        if (op_ret == 0) {
+            ctx->open_fd_no = rsp->fd;
+            gf_uuid_copy(ctx->open_gfid, fd->inode->gfid);
+        }
+    }
+
+    rsp->op_ret = op_ret;
+    rsp->op_errno = gf_errno_to_error(op_errno);
+
+    return server4_compound_step_done(frame, op_ret, op_errno, xdata);
+}
+
+static int
+server4_compound_readv_cbk(call_frame_t *frame, void *cookie, xlator_t *this,
+                           int32_t op_ret, int32_t op_errno,
+                           struct iovec *vector, int32_t count,
+                           struct iatt *stbuf, struct iobref *iobref,
+                           dict_t *xdata)
+{
+    server_state_t *state = NULL;
+    server_compound_ctx_t *ctx = NULL;
+    gfx_read_rsp *rsp = NULL;
+    int i = 0;
+
+    state = CALL_STATE(frame);
+    ctx = state->compound;
+    ctx->rsp[ctx->current].fop_enum = GF_FOP_READ;
+    rsp = SERVER4_COMPOUND_RSP(ctx, read);
+
+    dict_to_xdr(xdata, &rsp->xdata);
+
+    if (op_ret >= 0) {
+        /* the data of every READ step travels as the payload of the
+         * compound reply, in the order of the steps */
+        if (state->rsp_count + count > MAX_IOVEC) {
+            op_ret = -1;
+            op_errno = ENOBUFS;
+            goto out;
+        }
+
+        if (iobref) {
+            if (!ctx->rsp_iobref) {
+                ctx->rsp_iobref = iobref_new();
+                if (!ctx->rsp_iobref) {
+                    op_ret = -1;
+                    op_errno = ENOMEM;
+                    goto out;
+                }
+            }
+            iobref_merge(ctx->rsp_iobref, iobref);
+        }
+
+        for (i = 0; i < count; i++)
+            state->rsp_vector[state->rsp_count++] = vector[i];
+
+        server4_post_readv(rsp, stbuf, op_ret);
+    }
+out:
+    rsp->op_ret = op_ret;
+    rsp->op_errno = gf_errno_to_error(op_errno);
+
+    return server4_compound_step_done(frame, op_ret, op_errno, xdata);
+}
+
+static int
+server4_compound_writev_cbk(call_frame_t *frame, void *cookie, xlator_t *this,
+                            int32_t op_ret, int32_t op_errno,
+                            struct iatt *prebuf, struct iatt *postbuf,
+                            dict_t *xdata)
+{
+    server_state_t *state = NULL;
+    server_compound_ctx_t *ctx = NULL;
+    gfx_common_2iatt_rsp *rsp = NULL;
+
+    state = CALL_STATE(frame);
+    ctx = state->compound;
+    ctx->rsp[ctx->current].fop_enum = GF_FOP_WRITE;
+    rsp = SERVER4_COMPOUND_RSP(ctx, write);
+
+    dict_to_xdr(xdata, &rsp->xdata);
+
+    if (op_ret >= 0)
+        server4_post_common_2iatt(rsp, prebuf, postbuf);
+
+    rsp->op_ret = op_ret;
+    rsp->op_errno = gf_errno_to_error(op_errno);
+
+    return server4_compound_step_done(frame, op_ret, op_errno, xdata);
+}
+
+static int
+server4_compound_common_cbk(call_frame_t *frame, void *cookie, xlator_t *this,
+                            int32_t op_ret, int32_t op_errno, dict_t *xdata)
+{
+    server_state_t *state = NULL;
+    server_compound_ctx_t *ctx = NULL;
+    gfx_common_rsp *rsp = NULL;
+
+    state = CALL_STATE(frame);
+    ctx = state->compound;
+    ctx->rsp[ctx->current].fop_enum = frame->root->op;
+    switch (frame->root->op) {
+        case GF_FOP_FLUSH:
+            rsp = SERVER4_COMPOUND_RSP(ctx, flush);
+            break;
+        case GF_FOP_INODELK:
+            rsp = SERVER4_COMPOUND_RSP(ctx, inodelk);
+            break;
+        default:
+            rsp = SERVER4_COMPOUND_RSP(ctx, finodelk);
+            break;
+    }
+
+    dict_to_xdr(xdata, &rsp->xdata);
+
+    rsp->op_ret = op_ret;
+    rsp->op_errno = gf_errno_to_error(op_errno);
+
+    return server4_compound_step_done(frame, op_ret, op_errno, xdata);
+}
+
+static int
+server4_compound_xattrop_cbk(call_frame_t *frame, void *cookie, xlator_t *this,
+                             int32_t op_ret, int32_t op_errno, dict_t *dict,
+                             dict_t *xdata)
+{
+    server_state_t *state = NULL;
+    server_compound_ctx_t *ctx = NULL;
+    gfx_common_dict_rsp *rsp = NULL;
+
+    state = CALL_STATE(frame);
+    ctx = state->compound;
+    ctx->rsp[ctx->current].fop_enum = frame->root->op;
+    if (frame->root->op == GF_FOP_FXATTROP)
+        rsp = SERVER4_COMPOUND_RSP(ctx, fxattrop);
+    else
+        rsp = SERVER4_COMPOUND_RSP(ctx, xattrop);
+
+    dict_to_xdr(xdata, &rsp->xdata);
+
+    if (op_ret == 0) {
+        dict_to_xdr(dict, &rsp->dict);
+        if (dict)
+            ctx->steps[ctx->current].rsp_dict = dict_ref(dict);
+    } else {
+        dict_to_xdr(NULL, &rsp->dict);
+    }
+
+    rsp->op_ret = op_ret;
+    rsp->op_errno = gf_errno_to_error(op_errno);
+
+    return server4_compound_step_done(frame, op_ret, op_errno, xdata);
+}
+
+static int
+server4_compound_resume(call_frame_t *frame, xlator_t *bound_xl)
+{
+    server_state_t *state = NULL;
+    server_compound_ctx_t *ctx = NULL;
+    int op_errno = EINVAL;
+
+    state = CALL_STATE(frame);
+    ctx = state->compound;
+
+    if (state->resolve.op_ret != 0) {
+        op_errno = state->resolve.op_errno;
+        goto err;
+    }
+
+    switch (ctx->steps[ctx->current].fop) {
+        case GF_FOP_LOOKUP:
+            if (!state->loc.inode)
+                state->loc.inode = server_inode_new(state->itable,
+                                                    state->loc.gfid);
+
+            STACK_WIND(frame, server4_compound_lookup_cbk, bound_xl,
+                       bound_xl->fops->lookup, &state->loc, state->xdata);
+            break;
+        case GF_FOP_STAT:
+            STACK_WIND(frame, server4_compound_stat_cbk, bound_xl,
+                       bound_xl->fops->stat, &state->loc, state->xdata);
+            break;
+        case GF_FOP_OPEN:
+            state->fd = fd_create(state->loc.inode, frame->root->pid);
+            if (!state->fd) {
+                op_errno = ENOMEM;
+                goto err;
+            }
+            state->fd->flags = state->flags;
+
+            STACK_WIND(frame, server4_compound_open_cbk, bound_xl,
+                       bound_xl->fops->open, &state->loc, state->flags,
+                       state->fd, state->xdata);
+            break;
+        case GF_FOP_READ:
+            STACK_WIND(frame, server4_compound_readv_cbk, bound_xl,
+                       bound_xl->fops->readv, state->fd, state->size,
+                       state->offset, state->flags, state->xdata);
+            break;
+        case GF_FOP_WRITE:
+            STACK_WIND(frame, server4_compound_writev_cbk, bound_xl,
+                       bound_xl->fops->writev, state->fd,
+                       state->payload_vector, state->payload_count,
+                       state->offset, state->flags, state->iobref,
+                       state->xdata);
+            break;
+        case GF_FOP_FLUSH:
+            STACK_WIND(frame, server4_compound_common_cbk, bound_xl,
+                       bound_xl->fops->flush, state->fd, state->xdata);
+            break;
+        case GF_FOP_FSTAT:
+            STACK_WIND(frame, server4_compound_stat_cbk, bound_xl,
+                       bound_xl->fops->fstat, state->fd, state->xdata);
+            break;
+        case GF_FOP_INODELK:
+        case GF_FOP_FINODELK:
+            if (!state->xdata)
+                state->xdata = dict_new();
+
+            if (state->xdata)
+                (void)dict_set_str(state->xdata, "connection-id",
+                                   frame->root->client->client_uid);
+
+            if (frame->root->op == GF_FOP_INODELK)
+                STACK_WIND(frame, server4_compound_common_cbk, bound_xl,
+                           bound_xl->fops->inodelk, state->volume,
+                           &state->loc, state->cmd, &state->flock,
+                           state->xdata);
+            else
+                STACK_WIND(frame, server4_compound_common_cbk, bound_xl,
+                           bound_xl->fops->finodelk, state->volume,
+                           state->fd, state->cmd, &state->flock,
+                           state->xdata);
+            break;
+        case GF_FOP_XATTROP:
+            STACK_WIND(frame, server4_compound_xattrop_cbk, bound_xl,
+                       bound_xl->fops->xattrop, &state->loc, state->flags,
+                       state->dict, state->xdata);
+            break;
+        case GF_FOP_FXATTROP:
+            STACK_WIND(frame, server4_compound_xattrop_cbk, bound_xl,
+                       bound_xl->fops->fxattrop, state->fd, state->flags,
+                       state->dict, state->xdata);
+            break;
+        default:
+            goto err;
+    }
+
+    return 0;
+err:
+    return server4_compound_step_fail(frame, op_errno);
+}
+
+/* Drops whatever the previous step left in the state, so that the next one
+ * can be resolved from scratch. */
+static void
+server4_compound_state_reset(server_state_t *state)
+{
+    if (state->fd) {
+        fd_unref(state->fd);
+        state->fd = NULL;
+    }
+
+    if (state->dict) {
+        dict_unref(state->dict);
+        state->dict = NULL;
+    }
+
+    if (state->xdata) {
+        dict_unref(state->xdata);
+        state->xdata = NULL;
+    }
+
+    GF_FREE((void *)state->volume);
+    state->volume = NULL;
+
+    server_loc_wipe(&state->loc);
+    server_loc_wipe(&state->loc2);
+    memset(&state->loc, 0, sizeof(state->loc));
+    memset(&state->loc2, 0, sizeof(state->loc2));
+
+    server_resolve_wipe(&state->resolve);
+    server_resolve_wipe(&state->resolve2);
+    memset(&state->resolve, 0, sizeof(state->resolve));
+    memset(&state->resolve2, 0, sizeof(state->resolve2));
+    state->resolve.fd_no = -1;
+    state->resolve2.fd_no = -1;
+
+    state->resolve_now = NULL;
+    state->loc_now = NULL;
+    state->payload_count = 0;
+    state->is_revalidate = 0;
+}
+
+static gf_boolean_t
+server4_compound_step_is_unlock(server_compound_step_t *step)
+{
+    return ((step->fop == GF_FOP_INODELK || step->fop == GF_FOP_FINODELK) &&
+            step->args.lock.l_type == F_UNLCK);
+}
+
+static int
+server4_compound_reply(call_frame_t *frame)
+{
+    server_state_t *state = NULL;
+    server_compound_ctx_t *ctx = NULL;
+    rpcsvc_request_t *req = NULL;
+    gfx_compound_rsp rsp = {
+        0,
+    };
+
+    state = CALL_STATE(frame);
+    ctx = state->compound;
+
+    if (ctx->op_ret) {
+        gf_smsg(frame->this->name,
+                fop_log_level(GF_FOP_COMPOUND, ctx->op_errno), ctx->op_errno,
+                PS_MSG_COMPOUND_INFO, "frame=%" PRId64, frame->root->unique,
+                "fops=%d", ctx->count, "client=%s",
+                STACK_CLIENT_NAME(frame->root), "error-xlator=%s",
+                STACK_ERR_XL_NAME(frame->root), NULL);
+    }
+
+    frame->root->op = GF_FOP_COMPOUND;
+
+    rsp.op_ret = ctx->op_ret;
+    rsp.op_errno = gf_errno_to_error(ctx->op_errno);
+    rsp.compound_rsp_array.compound_rsp_array_val = ctx->rsp;
+    rsp.compound_rsp_array.compound_rsp_array_len = ctx->count;
+    dict_to_xdr(NULL, &rsp.xdata);
+
+    /* the per step replies and everything they point into are released
+     * along with the state, once the reply is serialized */
+    req = frame->local;
+    server_submit_reply(frame, req, &rsp, state->rsp_vector, state->rsp_count,
+                        ctx->rsp_iobref, (xdrproc_t)xdr_gfx_compound_rsp);
+
+    return 0;
+}
+
+static int
+server4_compound_next(call_frame_t *frame)
+{
+    server_state_t *state = NULL;
+    server_compound_ctx_t *ctx = NULL;
+    server_compound_step_t *step = NULL;
+    struct iovec *vector = NULL;
+
+    state = CALL_STATE(frame);
+    ctx = state->compound;
+
+    server4_compound_state_reset(state);
+
+    /* once a step failed, the rest are not attempted; unlocks still are,
+     * so that a failed compound never leaves locks behind */
+    for (; ctx->current < ctx->count; ctx->current++) {
+        step = &ctx->steps[ctx->current];
+        if (ctx->op_ret == 0 || server4_compound_step_is_unlock(step))
+            break;
+
+        if (step->fop == GF_FOP_WRITE)
+            ctx->payload_offset += step->args.size;
+        server4_compound_rsp_set_error(&ctx->rsp[ctx->current], step->fop,
+                                       ECANCELED);
+    }
+
+    if (ctx->current == ctx->count)
+        return server4_compound_reply(frame);
+
+    frame->root->op = step->fop;
+
+    state->resolve.type = step->type;
+    state->resolve.fd_no = step->fd_no;
+    gf_uuid_copy(state->resolve.gfid, step->gfid);
+    gf_uuid_copy(state->resolve.pargfid, step->pargfid);
+    if (step->bname)
+        state->resolve.bname = gf_strdup(step->bname);
+
+    /* a step that names no inode works on what the previous lookup or
+     * stat returned, and an anonymous fd on the file opened earlier in
+     * this same compound */
+    if (gf_uuid_is_null(step->gfid) && gf_uuid_is_null(step->pargfid))
+        gf_uuid_copy(state->resolve.gfid, ctx->last_gfid);
+
+    if ((step->fd_no == GF_ANON_FD_NO) && (ctx->open_fd_no >= 0) &&
+        (gf_uuid_is_null(step->gfid) ||
+         !gf_uuid_compare(step->gfid, ctx->open_gfid)))
+        state->resolve.fd_no = ctx->open_fd_no;
+
+    state->flags = step->args.flags;
+    state->size = step->args.size;
+    state->offset = step->args.offset;
+    state->cmd = step->args.cmd;
+    state->flock = step->args.lock;
+    if (step->args.volume)
+        state->volume = gf_strdup(step->args.volume);
+    if (step->args.xattr)
+        state->dict = dict_ref(step->args.xattr);
+    if (step->args.xdata)
+        state->xdata = dict_ref(step->args.xdata);
+
+    if (step->fop == GF_FOP_WRITE) {
+        vector = state->payload_vector;
+        state->payload_count = iov_subset(ctx->payload, ctx->payload_count,
+                                          ctx->payload_offset, state->size,
+                                          &vector, MAX_IOVEC);
+        ctx->payload_offset += state->size;
+        if (state->payload_count < 0) {
+            state->payload_count = 0;
+            return server4_compound_step_fail(frame, EINVAL);
+        }
+    }
+
+    resolve_and_resume(frame, server4_compound_resume);
+
+    return 0;
+}
+
+static int
+server4_compound_lk_cmd(int gf_cmd)
+{
+    switch (gf_cmd) {
+        case GF_LK_GETLK:
+            return F_GETLK;
+        case GF_LK_SETLK:
+            return F_SETLK;
+        case GF_LK_SETLKW:
+            return F_SETLKW;
+    }
+
+    return -1;
+}
+
+static void
+server4_compound_lk_type(int gf_type, struct gf_flock *flock)
+{
+    switch (gf_type) {
+        case GF_LK_F_RDLCK:
+            flock->l_type = F_RDLCK;
+            break;
+        case GF_LK_F_WRLCK:
+            flock->l_type = F_WRLCK;
+            break;
+        case GF_LK_F_UNLCK:
+            flock->l_type = F_UNLCK;
+            break;
+    }
+}
+
+/* Moves one fop of the request off the wire into @step. Everything the wire
+ * format allocated is released here, so that nothing but the step needs to
+ * be cleaned up later on. */
+static int
+server4_compound_populate_step(client_t *client, compound_req_v2 *this_req,
+                               server_compound_step_t *step)
+{
+    default_args_t *args = &step->args;
+    int ret = 0;
+
+    step->fop = this_req->fop_enum;
+    step->fd_no = -1;
+    step->type = RESOLVE_MUST;
+
+    switch (step->fop) {
+        case GF_FOP_LOOKUP: {
+            gfx_lookup_req *req = &this_req->compound_req_v2_u
+                                       .compound_lookup_req;
+
+            step->type = RESOLVE_DONTCARE;
+            if (req->bname && strcmp(req->bname, "")) {
+                set_resolve_gfid(client, step->pargfid, req->pargfid);
+                step->bname = gf_strdup(req->bname);
+            } else {
+                set_resolve_gfid(client, step->gfid, req->gfid);
+            }
+            free(req->bname);
+            ret = xdr_to_dict(&req->xdata, &args->xdata);
+            break;
+        }
+        case GF_FOP_STAT: {
+            gfx_stat_req *req = &this_req->compound_req_v2_u.compound_stat_req;
+
+            set_resolve_gfid(client, step->gfid, req->gfid);
+            ret = xdr_to_dict(&req->xdata, &args->xdata);
+            break;
+        }
+        case GF_FOP_OPEN: {
+            gfx_open_req *req = &this_req->compound_req_v2_u.compound_open_req;
+
+            memcpy(step->gfid, req->gfid, 16);
+            args->flags = gf_flags_to_flags(req->flags);
+            ret = xdr_to_dict(&req->xdata, &args->xdata);
+            break;
+        }
+        case GF_FOP_READ: {
+            gfx_read_req *req = &this_req->compound_req_v2_u.compound_read_req;
+
+            step->fd_no = req->fd;
+            memcpy(step->gfid, req->gfid, 16);
+            args->size = req->size;
+            args->offset = req->offset;
+            args->flags = req->flag;
+            ret = xdr_to_dict(&req->xdata, &args->xdata);
+            break;
+        }
+        case GF_FOP_WRITE: {
+            gfx_write_req *req = &this_req->compound_req_v2_u
+                                      .compound_write_req;
+
+            step->fd_no = req->fd;
+            memcpy(step->gfid, req->gfid, 16);
+            args->size = req->size;
+            args->offset = req->offset;
+            args->flags = req->flag;
+            ret = xdr_to_dict(&req->xdata, &args->xdata);
+            break;
+        }
+        case GF_FOP_FLUSH: {
+            gfx_flush_req *req = &this_req->compound_req_v2_u
+                                      .compound_flush_req;
+
+            step->fd_no = req->fd;
+            memcpy(step->gfid, req->gfid, 16);
+            ret = xdr_to_dict(&req->xdata, &args->xdata);
+            break;
+        }
+        case GF_FOP_FSTAT: {
+            gfx_fstat_req *req = &this_req->compound_req_v2_u
+                                      .compound_fstat_req;
+
+            step->fd_no = req->fd;
+            set_resolve_gfid(client, step->gfid, req->gfid);
+            ret = xdr_to_dict(&req->xdata, &args->xdata);
+            break;
+        }
+        case GF_FOP_INODELK: {
+            gfx_inodelk_req *req = &this_req->compound_req_v2_u
+                                        .compound_inodelk_req;
+
+            step->type = RESOLVE_EXACT;
+            set_resolve_gfid(client, step->gfid, req->gfid);
+            args->cmd = server4_compound_lk_cmd(req->cmd);
+            gf_proto_flock_to_flock(&req->flock, &args->lock);
+            server4_compound_lk_type(req->type, &args->lock);
+            args->volume = gf_strdup(req->volume);
+            free(req->volume);
+            free(req->flock.lk_owner.lk_owner_val);
+            ret = xdr_to_dict(&req->xdata, &args->xdata);
+            break;
+        }
+        case GF_FOP_FINODELK: {
+            gfx_finodelk_req *req = &this_req->compound_req_v2_u
+                                         .compound_finodelk_req;
+
+            step->type = RESOLVE_EXACT;
+            step->fd_no = req->fd;
+            set_resolve_gfid(client, step->gfid, req->gfid);
+            args->cmd = server4_compound_lk_cmd(req->cmd);
+            gf_proto_flock_to_flock(&req->flock, &args->lock);
+            server4_compound_lk_type(req->type, &args->lock);
+            args->volume = gf_strdup(req->volume);
+            free(req->volume);
+            free(req->flock.lk_owner.lk_owner_val);
+            ret = xdr_to_dict(&req->xdata, &args->xdata);
+            break;
+        }
+        case GF_FOP_XATTROP: {
+            gfx_xattrop_req *req = &this_req->compound_req_v2_u
+                                        .compound_xattrop_req;
+
+            set_resolve_gfid(client, step->gfid, req->gfid);
+            args->flags = req->flags;
+            ret = xdr_to_dict(&req->dict, &args->xattr);
+            ret |= xdr_to_dict(&req->xdata, &args->xdata);
+            break;
+        }
+        case GF_FOP_FXATTROP: {
+            gfx_fxattrop_req *req = &this_req->compound_req_v2_u
+                                         .compound_fxattrop_req;
+
+            step->fd_no = req->fd;
+            set_resolve_gfid(client, step->gfid, req->gfid);
+            args->flags = req->flags;
+            ret = xdr_to_dict(&req->dict, &args->xattr);
+            ret |= xdr_to_dict(&req->xdata, &args->xdata);
+            break;
+        }
+        default:
+            ret = -1;
+            break;
+    }
+
+    return ret;
+}
+
 int
 server4_0_compound(rpcsvc_request_t *req)
 {
+    server_state_t *state = NULL;
+    call_frame_t *frame = NULL;
+    server_compound_ctx_t *ctx = NULL;
+    gfx_compound_req args = {
+        0,
+    };
+    ssize_t len = 0;
+    size_t write_size = 0;
+    int length = 0;
+    int op_errno = 0;
+    int i = 0;
     int ret = -1;
-    SERVER_REQ_SET_ERROR(req, ret);
+
+    if (!req)
+        return ret;
+
+    ret = rpc_receive_common(req, &frame, &state, &len, &args,
+                             xdr_gfx_compound_req, GF_FOP_COMPOUND);
+    if (ret != 0) {
+        goto out;
+    }
+
+    ret = -1;
+    length = args.compound_req_array.compound_req_array_len;
+    if ((length == 0) || (length > GF_COMPOUND_MAX_FOPS)) {
+        gf_smsg(THIS->name, GF_LOG_WARNING, EINVAL, PS_MSG_COMPOUND_INFO,
+                "frame=%" PRId64, frame->root->unique, "fops=%d", length,
+                "client=%s", STACK_CLIENT_NAME(frame->root), NULL);
+        SERVER_REQ_SET_ERROR(req, ret);
+        goto out;
+    }
+
+    ctx = GF_CALLOC(1, sizeof(*ctx), gf_server_mt_compound_ctx_t);
+    if (!ctx) {
+        SERVER_REQ_SET_ERROR(req, ret);
+        goto out;
+    }
+    state->compound = ctx;
+    ctx->count = length;
+    ctx->open_fd_no = -1;
+
+    ctx->steps = GF_CALLOC(length, sizeof(*ctx->steps),
+                           gf_server_mt_compound_ctx_t);
+    ctx->rsp = GF_CALLOC(length, sizeof(*ctx->rsp),
+                         gf_server_mt_compound_rsp_t);
+    if (!ctx->steps || !ctx->rsp) {
+        SERVER_REQ_SET_ERROR(req, ret);
+        goto out;
+    }
+
+    for (i = 0; i < length; i++) {
+        if (server4_compound_populate_step(
+                frame->root->client,
+                &args.compound_req_array.compound_req_array_val[i],
+                &ctx->steps[i]))
+            op_errno = EINVAL;
+        if (ctx->steps[i].fop == GF_FOP_WRITE)
+            write_size += ctx->steps[i].args.size;
+    }
+
+    /* the steps own everything the wire format allocated by now */
+    free(args.compound_req_array.compound_req_array_val);
+    args.compound_req_array.compound_req_array_val = NULL;
+    args.compound_req_array.compound_req_array_len = 0;
+
+    if (xdr_to_dict(&args.xdata, &state->xdata))
+        op_errno = EINVAL;
+    else if (state->xdata &&
+             dict_get_sizen(state->xdata, GF_COMPOUND_INDEPENDENT_KEY))
+        ctx->independent = _gf_true;
+
+    /* whatever follows the header is the data of the WRITE steps */
+    state->iobref = iobref_ref(req->iobref);
+    if (len < req->msg[0].iov_len) {
+        ctx->payload[0].iov_base = (req->msg[0].iov_base + len);
+        ctx->payload[0].iov_len = req->msg[0].iov_len - len;
+        ctx->payload_count = 1;
+    }
+
+    for (i = 1; (i < req->count) && (ctx->payload_count < MAX_IOVEC); i++) {
+        ctx->payload[ctx->payload_count++] = req->msg[i];
+    }
+
+    if (iov_length(ctx->payload, ctx->payload_count) != write_size)
+        op_errno = EINVAL;
+
+    ret = 0;
+    if (op_errno) {
+        /* nothing has been wound yet, every step carries the error */
+        ctx->op_ret = -1;
+        ctx->op_errno = op_errno;
+        for (i = 0; i < length; i++)
+            server4_compound_rsp_set_error(&ctx->rsp[i], ctx->steps[i].fop,
+                                           op_errno);
+        server4_compound_reply(frame);
+        goto out;
+    }
+
+    server4_compound_next(frame);
+out:
+    if (ret)
+        xdr_free((xdrproc_t)xdr_gfx_compound_req, (char *)&args);
+
     return ret;
 }
 
@@ -599,7 +599,7 @@ glusterfs_ctx_pool_destroy(glusterfs_ctx_t *ctx)
             mem_pool_destroy(pool->frame_mem_pool);
         if (pool->stack_mem_pool)
             mem_pool_destroy(pool->stack_mem_pool);
-        LOCK_DESTROY(&pool->lock);
+        call_pool_fini(pool);
         GF_FREE(pool);
     }
 
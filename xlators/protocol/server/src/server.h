@@ -178,8 +178,51 @@ struct _server_state {
 
     /* subdir mount */
     client_t *client;
+
+    /* set only while a GFS3_OP_COMPOUND request is being executed */
+    struct _server_compound_ctx *compound;
 };
 
+/* One fop of a compound request, decoded off the wire. The fields mirror
+ * what the plain fop handlers put into server_state_t before resolving. */
+typedef struct _server_compound_step {
+    glusterfs_fop_t fop;
+    server_resolve_type_t type;
+    int64_t fd_no;
+    uuid_t gfid;
+    uuid_t pargfid;
+    char *bname;
+    default_args_t args;
+
+    /* the reply of this step points into these until it is submitted */
+    dict_t *rsp_xdata;
+    dict_t *rsp_dict;
+} server_compound_step_t;
+
+typedef struct _server_compound_ctx {
+    server_compound_step_t *steps;
+    compound_rsp_v2 *rsp;
+    int count;
+    int current;
+    int op_ret;
+    int op_errno;
+    /* steps do not depend on each other, a failure cancels nothing */
+    gf_boolean_t independent;
+
+    /* write payload of the whole request, sliced per WRITE step */
+    struct iovec payload[MAX_IOVEC];
+    int payload_count;
+    size_t payload_offset;
+
+    /* holds the buffers of READ steps appended to the reply */
+    struct iobref *rsp_iobref;
+
+    /* let later steps use what earlier steps looked up or opened */
+    uuid_t last_gfid;
+    uuid_t open_gfid;
+    int64_t open_fd_no;
+} server_compound_ctx_t;
+
 extern struct rpcsvc_program gluster_handshake_prog;
 extern struct rpcsvc_program glusterfs3_3_fop_prog;
 extern struct rpcsvc_program glusterfs4_0_fop_prog;
@@ -119,6 +119,14 @@ posix_priv(xlator_t *this)
     gf_proc_dump_write("max_read", "%" PRId64, GF_ATOMIC_GET(priv->read_value));
     gf_proc_dump_write("max_write", "%" PRId64,
                        GF_ATOMIC_GET(priv->write_value));
+#ifdef HAVE_LIBURING
+    if (priv->uring_fixed_bufs) {
+        gf_proc_dump_write("uring_fixed_ios", "%" PRId64,
+                           GF_ATOMIC_GET(priv->uring_fixed_ios));
+        gf_proc_dump_write("uring_fixed_bufs_released", "%" PRId64,
+                           GF_ATOMIC_GET(priv->uring_buf_released));
+    }
+#endif
 
     return 0;
 }
@@ -1091,6 +1099,9 @@ posix_init(xlator_t *this)
         }
     }
 
+#ifdef HAVE_LIBURING
+    pthread_mutex_init(&_private->sq_mutex, NULL);
+#endif
     GF_OPTION_INIT("linux-io_uring", _private->io_uring_configured, bool, out);
     if (_private->io_uring_configured) {
         op_ret = posix_io_uring_on(this);
@@ -1345,6 +1356,9 @@ posix_fini(xlator_t *this)
     pthread_cond_destroy(&priv->fsync_cond);
     pthread_mutex_destroy(&priv->janitor_mutex);
     pthread_cond_destroy(&priv->janitor_cond);
+#ifdef HAVE_LIBURING
+    pthread_mutex_destroy(&priv->sq_mutex);
+#endif
     GF_FREE(priv->trash_path);
     GF_FREE(priv);
     this->private = NULL;
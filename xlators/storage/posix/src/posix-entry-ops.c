@@ -132,7 +132,7 @@ out:
     return ret;
 }
 
-static dict_t *
+dict_t *
 posix_dict_set_nlink(dict_t *req, dict_t *res, int32_t nlink)
 {
     int ret = -1;
@@ -383,7 +383,7 @@ nameless_lookup_unlink_dir_out:
     return 0;
 }
 
-static int32_t
+int32_t
 posix_set_gfid2path_xattr(xlator_t *this, const char *path, uuid_t pgfid,
                           const char *bname)
 {
@@ -434,7 +434,7 @@ posix_acl_xattr_from_dict(const char *path, char *key, dict_t *xattr_req)
     return ret;
 }
 
-static int
+int
 posix_acl_xattr_set(const char *path, dict_t *xattr_req)
 {
     int ret = 0;
@@ -1078,7 +1078,7 @@ out:
     return ret;
 }
 
-static int32_t
+int32_t
 posix_move_gfid_to_unlink(xlator_t *this, uuid_t gfid, loc_t *loc)
 {
     char *unlink_path = NULL;
@@ -1276,7 +1276,7 @@ posix_skip_non_linkto_unlink(dict_t *xdata, loc_t *loc, char *key,
     return skip_unlink;
 }
 
-static int32_t
+int32_t
 posix_remove_gfid2path_xattr(xlator_t *this, const char *path, uuid_t pgfid,
                              const char *bname)
 {
@@ -51,6 +51,7 @@
 #include <glusterfs/glusterfs-acl.h>
 #include "posix-messages.h"
 #include "posix-metadata.h"
+#include "posix-io-uring.h"
 #include <glusterfs/events.h>
 #include "posix-gfid-path.h"
 #include <glusterfs/compat-uuid.h>
@@ -2601,6 +2602,7 @@ posix_release(xlator_t *this, fd_t *fd)
                "pfd->dir is %p (not NULL) for file fd=%p", pfd->dir, fd);
     }
 
+    posix_io_uring_release_fd(this, pfd);
     posix_add_fd_to_cleanup(this, pfd);
 
 out:
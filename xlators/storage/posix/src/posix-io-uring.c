@@ -8,14 +8,47 @@
    cases as published by the Free Software Foundation.
 */
 
+#include <libgen.h>
 #include "posix.h"
 #include "posix-messages.h"
 #include "posix-io-uring.h"
 #include "posix-handle.h"
+#include "posix-metadata.h"
+#include "posix-gfid-path.h"
+#include <glusterfs/syscall.h>
+#include <glusterfs/byte-order.h>
+#include <glusterfs/glusterfs-acl.h>
 
 #ifdef HAVE_LIBURING
 #include <liburing.h>
 
+#undef HAVE_SET_FSID
+#ifdef HAVE_SET_FSID
+
+#define DECLARE_OLD_FS_ID_VAR                                                  \
+    uid_t old_fsuid;                                                           \
+    gid_t old_fsgid;
+
+#define SET_FS_ID(uid, gid)                                                    \
+    do {                                                                       \
+        old_fsuid = setfsuid(uid);                                             \
+        old_fsgid = setfsgid(gid);                                             \
+    } while (0)
+
+#define SET_TO_OLD_FS_ID()                                                     \
+    do {                                                                       \
+        setfsuid(old_fsuid);                                                   \
+        setfsgid(old_fsgid);                                                   \
+    } while (0)
+
+#else
+
+#define DECLARE_OLD_FS_ID_VAR
+#define SET_FS_ID(uid, gid)
+#define SET_TO_OLD_FS_ID()
+
+#endif
+
 struct posix_uring_ctx;
 typedef void(fop_unwind_f)(struct posix_uring_ctx *, int32_t);
 typedef void(fop_prep_f)(struct io_uring_sqe *sqe, struct posix_uring_ctx *);
@@ -28,24 +61,73 @@ struct posix_uring_ctx {
     dict_t *xdata;
     fd_t *fd;
     int _fd;
+    int fdflags;
+    int file_index; /* in the registered file table, -1 if none */
     int op;
 
+    /* inode based fops: the gfid handle, relative to its hash directory */
+    loc_t loc;
+    int dfd;
+    char handle[POSIX_GFID_HASH2_LEN];
+
     union {
         struct {
             struct iovec *iov;
             int count;
             off_t offset;
+            int buf_index;
         } write;
 
         struct {
             struct iobuf *iobuf;
             struct iovec iovec;
             off_t offset;
+            int buf_index;
         } read;
 
         struct {
             int32_t datasync;
         } fsync;
+
+        struct {
+            struct statx stx;
+        } stat;
+
+        struct {
+            int32_t flags;
+        } open;
+
+        struct {
+            int32_t mode;
+            off_t offset;
+            off_t len;
+        } fallocate;
+
+        struct {
+            char *name;
+            char *value;
+            size_t size;
+            int32_t flags;
+            dict_t *dict;
+            char *path; /* of the gfid handle, for getxattr and setxattr */
+        } xattr;
+
+        struct {
+            char *real_path;
+            char *par_path;
+            struct iatt preparent;
+            mode_t mode;
+            gid_t gid;
+            /* rename: the destination and what it replaced */
+            loc_t newloc;
+            char *real_newpath;
+            char *par_newpath;
+            struct iatt prenewparent;
+            uuid_t victim;
+            int32_t nlink;
+            gf_boolean_t was_present;
+            gf_boolean_t was_dir;
+        } entry;
     } fop;
 
     fop_prep_f *prepare;
@@ -61,25 +143,50 @@ posix_io_uring_ctx_free(struct posix_uring_ctx *ctx)
         fd_unref(ctx->fd);
     if (ctx->xdata)
         dict_unref(ctx->xdata);
+    loc_wipe(&ctx->loc);
     switch (ctx->op) {
         case GF_FOP_READ:
             if (ctx->fop.read.iobuf)
                 iobuf_unref(ctx->fop.read.iobuf);
             break;
+        case GF_FOP_FGETXATTR:
+            GF_FREE(ctx->fop.xattr.name);
+            GF_FREE(ctx->fop.xattr.value);
+            break;
+        case GF_FOP_FSETXATTR:
+            if (ctx->fop.xattr.dict)
+                dict_unref(ctx->fop.xattr.dict);
+            break;
+        case GF_FOP_GETXATTR:
+            GF_FREE(ctx->fop.xattr.name);
+            GF_FREE(ctx->fop.xattr.value);
+            GF_FREE(ctx->fop.xattr.path);
+            break;
+        case GF_FOP_SETXATTR:
+            if (ctx->fop.xattr.dict)
+                dict_unref(ctx->fop.xattr.dict);
+            GF_FREE(ctx->fop.xattr.path);
+            break;
+        case GF_FOP_MKDIR:
+        case GF_FOP_UNLINK:
+        case GF_FOP_RENAME:
+            GF_FREE(ctx->fop.entry.real_path);
+            GF_FREE(ctx->fop.entry.par_path);
+            GF_FREE(ctx->fop.entry.real_newpath);
+            GF_FREE(ctx->fop.entry.par_newpath);
+            loc_wipe(&ctx->fop.entry.newloc);
+            break;
         default:
             break;
     }
     GF_FREE(ctx);
 }
 
-struct posix_uring_ctx *
-posix_io_uring_ctx_init(call_frame_t *frame, xlator_t *this, fd_t *fd, int op,
-                        fop_prep_f prepare, fop_unwind_f unwind,
-                        int32_t *op_errno, dict_t *xdata)
+static struct posix_uring_ctx *
+posix_io_uring_ctx_alloc(call_frame_t *frame, int op, fop_prep_f prepare,
+                         fop_unwind_f unwind, dict_t *xdata)
 {
     struct posix_uring_ctx *ctx = NULL;
-    struct posix_fd *pfd = NULL;
-    int ret = 0;
 
     ctx = GF_CALLOC(1, sizeof(*ctx), gf_posix_mt_uring_ctx);
     if (!ctx) {
@@ -87,12 +194,149 @@ posix_io_uring_ctx_init(call_frame_t *frame, xlator_t *this, fd_t *fd, int op,
     }
 
     ctx->frame = frame;
-    ctx->fd = fd_ref(fd);
     ctx->prepare = prepare;
     ctx->unwind = unwind;
     if (xdata)
         ctx->xdata = dict_ref(xdata);
     ctx->op = op;
+    ctx->_fd = -1;
+    ctx->dfd = -1;
+    ctx->file_index = -1;
+
+    return ctx;
+}
+
+/* Give @pfd a slot in the registered file table on its first I/O through
+ * the ring, sparing the kernel the fd lookup and file refcounting on every
+ * request after that. The slot is returned in posix_io_uring_release_fd().
+ * A slot taken in the table of a ring since torn down is void.
+ */
+static int
+posix_io_uring_file_index(struct posix_private *priv, struct posix_fd *pfd)
+{
+    int index = -1;
+
+    pthread_mutex_lock(&priv->sq_mutex);
+    {
+        if (pfd->uring_files_gen != priv->uring_files_gen)
+            pfd->uring_file = 0;
+
+        if (!pfd->uring_file && priv->uring_files &&
+            priv->uring_files_free > 0) {
+            index = priv->uring_files[--priv->uring_files_free];
+            if (io_uring_register_files_update(&priv->ring, index, &pfd->fd,
+                                               1) == 1) {
+                pfd->uring_file = index + 1;
+                pfd->uring_files_gen = priv->uring_files_gen;
+            } else {
+                priv->uring_files[priv->uring_files_free++] = index;
+            }
+        }
+        index = pfd->uring_file - 1;
+    }
+    pthread_mutex_unlock(&priv->sq_mutex);
+
+    return index;
+}
+
+/* Brings the fixed buffer table of the ring up to date with the arenas
+ * noted by posix_io_uring_arena_notify(). Must not be called with the iobuf
+ * pool mutex held. */
+static void
+posix_io_uring_buf_sync(struct posix_private *priv)
+{
+    struct iovec iov = {
+        0,
+    };
+    __u64 tag = 0;
+    int slot = 0;
+    int ret = 0;
+
+    if (!priv->uring_fixed_bufs || !priv->uring_buf_npending)
+        return;
+
+    pthread_mutex_lock(&priv->uring_buf_mutex);
+    for (slot = 0; slot < GF_IOBUF_ARENA_SLOTS; slot++) {
+        LOCK(&priv->uring_buf_lock);
+        {
+            if (!priv->uring_buf_dirty[slot]) {
+                UNLOCK(&priv->uring_buf_lock);
+                continue;
+            }
+            iov = priv->uring_buf_pending[slot];
+            priv->uring_buf_dirty[slot] = 0;
+            priv->uring_buf_npending--;
+        }
+        UNLOCK(&priv->uring_buf_lock);
+
+        if (!iov.iov_base && !priv->uring_buf_live[slot])
+            continue;
+
+        /* an unmapped arena is replaced by an empty entry, the kernel keeps
+         * its pages pinned until they are no longer registered */
+        ret = io_uring_register_buffers_update_tag(&priv->ring, slot, &iov,
+                                                   &tag, 1);
+        if (ret != 1) {
+            gf_msg(THIS->name, GF_LOG_WARNING, -ret, P_MSG_POSIX_IO_URING,
+                   "failed to %sregister iobuf arena %p as fixed buffer %d",
+                   iov.iov_base ? "" : "un", iov.iov_base, slot);
+            if (iov.iov_base)
+                priv->uring_buf_live[slot] = 0;
+        } else {
+            if (!iov.iov_base)
+                GF_ATOMIC_INC(priv->uring_buf_released);
+            priv->uring_buf_live[slot] = (iov.iov_base != NULL);
+        }
+
+        LOCK(&priv->uring_buf_lock);
+        {
+            /* unless the slot changed again in the meantime */
+            if (!priv->uring_buf_dirty[slot])
+                priv->uring_buf_registered[slot] = priv->uring_buf_live[slot];
+        }
+        UNLOCK(&priv->uring_buf_lock);
+    }
+    pthread_mutex_unlock(&priv->uring_buf_mutex);
+}
+
+/* Index of the fixed buffer holding [@base, @base + @len), or -1 if @iobuf
+ * does not come from a registered arena. */
+static int
+posix_io_uring_buf_index(struct posix_private *priv, struct iobuf *iobuf,
+                         void *base, size_t len)
+{
+    struct iobuf_arena *arena = NULL;
+
+    if (!priv->uring_fixed_bufs || !iobuf)
+        return -1;
+
+    arena = iobuf->iobuf_arena;
+    if (!arena || (arena->slot < 0) ||
+        !priv->uring_buf_registered[arena->slot])
+        return -1;
+
+    if (((char *)base < (char *)arena->mem_base) ||
+        ((char *)base + len > (char *)arena->mem_base + arena->arena_size))
+        return -1;
+
+    return arena->slot;
+}
+
+struct posix_uring_ctx *
+posix_io_uring_ctx_init(call_frame_t *frame, xlator_t *this, fd_t *fd, int op,
+                        fop_prep_f prepare, fop_unwind_f unwind,
+                        int32_t *op_errno, dict_t *xdata)
+{
+    struct posix_uring_ctx *ctx = NULL;
+    struct posix_fd *pfd = NULL;
+    int ret = 0;
+
+    ctx = posix_io_uring_ctx_alloc(frame, op, prepare, unwind, xdata);
+    if (!ctx) {
+        return NULL;
+    }
+
+    ctx->fd = fd_ref(fd);
 
     ret = posix_fd_ctx_get(fd, this, &pfd, op_errno);
     if (ret < 0) {
@@ -101,9 +345,15 @@ posix_io_uring_ctx_init(call_frame_t *frame, xlator_t *this, fd_t *fd, int op,
         goto err;
     }
     ctx->_fd = pfd->fd;
+    ctx->fdflags = pfd->flags;
+    /* statx does not take registered files */
+    if (op != GF_FOP_FSTAT)
+        ctx->file_index = posix_io_uring_file_index(this->private, pfd);
 
     /* TODO: Explore filling up pre and post bufs using IOSQE_IO_LINK*/
-    if ((op == GF_FOP_WRITE) || (op == GF_FOP_FSYNC)) {
+    if ((op == GF_FOP_WRITE) || (op == GF_FOP_FSYNC) ||
+        (op == GF_FOP_FALLOCATE) || (op == GF_FOP_DISCARD) ||
+        (op == GF_FOP_ZEROFILL) || (op == GF_FOP_FSETXATTR)) {
         if (posix_fdstat(this, fd->inode, pfd->fd, &ctx->prebuf) != 0) {
             *op_errno = errno;
             gf_msg(this->name, GF_LOG_ERROR, *op_errno, P_MSG_FSTAT_FAILED,
@@ -119,6 +369,79 @@ err:
     return NULL;
 }
 
+/* Inode based fops go straight to the gfid handle. Only regular files are
+ * handled here: their handle is a hard link, while directory handles are
+ * symlinks which need to be resolved first. */
+static struct posix_uring_ctx *
+posix_io_uring_ctx_init_loc(call_frame_t *frame, xlator_t *this, loc_t *loc,
+                            int op, fop_prep_f prepare, fop_unwind_f unwind,
+                            int32_t *op_errno, dict_t *xdata)
+{
+    struct posix_private *priv = this->private;
+    struct posix_uring_ctx *ctx = NULL;
+
+    ctx = posix_io_uring_ctx_alloc(frame, op, prepare, unwind, xdata);
+    if (!ctx) {
+        *op_errno = ENOMEM;
+        return NULL;
+    }
+
+    if (loc_copy(&ctx->loc, loc) != 0) {
+        *op_errno = ENOMEM;
+        posix_io_uring_ctx_free(ctx);
+        return NULL;
+    }
+
+    snprintf(ctx->handle, sizeof(ctx->handle), "%02x/%s", loc->gfid[1],
+             uuid_utoa(loc->gfid));
+    ctx->dfd = priv->arrdfd[loc->gfid[0]];
+
+    return ctx;
+}
+
+static gf_boolean_t
+posix_io_uring_loc_ok(loc_t *loc)
+{
+    return (loc && loc->inode && (loc->inode->ia_type == IA_IFREG) &&
+            !gf_uuid_is_null(loc->gfid));
+}
+
+static gf_boolean_t
+posix_io_uring_cs_xdata(dict_t *xdata)
+{
+    return (xdata && (dict_get_sizen(xdata, GF_CS_OBJECT_STATUS) ||
+                      dict_get_sizen(xdata, GF_CS_OBJECT_REPAIR)));
+}
+
+static gf_boolean_t
+posix_io_uring_op_supported(struct posix_private *priv, int opcode)
+{
+    return (priv->uring_probe &&
+            io_uring_opcode_supported(priv->uring_probe, opcode));
+}
+
+static void
+posix_statx_to_stat(struct statx *stx, struct stat *st)
+{
+    memset(st, 0, sizeof(*st));
+    st->st_dev = makedev(stx->stx_dev_major, stx->stx_dev_minor);
+    st->st_ino = stx->stx_ino;
+    st->st_mode = stx->stx_mode;
+    st->st_nlink = stx->stx_nlink;
+    st->st_uid = stx->stx_uid;
+    st->st_gid = stx->stx_gid;
+    st->st_rdev = makedev(stx->stx_rdev_major, stx->stx_rdev_minor);
+    st->st_size = stx->stx_size;
+    st->st_blksize = stx->stx_blksize;
+    st->st_blocks = stx->stx_blocks;
+    st->st_atim.tv_sec = stx->stx_atime.tv_sec;
+    st->st_atim.tv_nsec = stx->stx_atime.tv_nsec;
+    st->st_mtim.tv_sec = stx->stx_mtime.tv_sec;
+    st->st_mtim.tv_nsec = stx->stx_mtime.tv_nsec;
+    st->st_ctim.tv_sec = stx->stx_ctime.tv_sec;
+    st->st_ctim.tv_nsec = stx->stx_ctime.tv_nsec;
+}
+
 static void
 posix_io_uring_readv_complete(struct posix_uring_ctx *ctx, int32_t res)
 {
@@ -197,15 +520,22 @@ out:
 static void
 posix_prep_readv(struct io_uring_sqe *sqe, struct posix_uring_ctx *ctx)
 {
+    if (ctx->fop.read.buf_index >= 0)
+        io_uring_prep_read_fixed(sqe, ctx->_fd, ctx->fop.read.iovec.iov_base,
+                                 ctx->fop.read.iovec.iov_len,
+                                 ctx->fop.read.offset, ctx->fop.read.buf_index);
+    else
+        io_uring_prep_readv(sqe, ctx->_fd, &ctx->fop.read.iovec, 1,
+                            ctx->fop.read.offset);
+    /* after the prep helper, which resets the sqe flags */
     sqe->flags |= IOSQE_ASYNC;
-    io_uring_prep_readv(sqe, ctx->_fd, &ctx->fop.read.iovec, 1,
-                        ctx->fop.read.offset);
 }
 
 int
 posix_io_uring_readv(call_frame_t *frame, xlator_t *this, fd_t *fd, size_t size,
                      off_t offset, uint32_t flags, dict_t *xdata)
 {
+    struct posix_private *priv = this->private;
     struct posix_uring_ctx *ctx = NULL;
     int32_t op_errno = ENOMEM;
     struct iobuf *iobuf = NULL;
@@ -218,7 +548,10 @@ posix_io_uring_readv(call_frame_t *frame, xlator_t *this, fd_t *fd, size_t size,
         goto err;
     }
 
-    iobuf = iobuf_get2(this->ctx->iobuf_pool, size);
+    if (priv->uring_fixed_bufs)
+        iobuf = iobuf_get_from_arena(this->ctx->iobuf_pool, size);
+    else
+        iobuf = iobuf_get2(this->ctx->iobuf_pool, size);
     if (!iobuf) {
         op_errno = ENOMEM;
         goto err;
@@ -227,6 +560,11 @@ posix_io_uring_readv(call_frame_t *frame, xlator_t *this, fd_t *fd, size_t size,
     ctx->fop.read.iovec.iov_base = iobuf_ptr(iobuf);
     ctx->fop.read.iovec.iov_len = size;
     ctx->fop.read.offset = offset;
+    posix_io_uring_buf_sync(priv);
+    ctx->fop.read.buf_index = posix_io_uring_buf_index(priv, iobuf,
+                                                       iobuf_ptr(iobuf), size);
+    if (ctx->fop.read.buf_index >= 0)
+        GF_ATOMIC_INC(priv->uring_fixed_ios);
 
     ret = posix_io_uring_submit(this, ctx);
     if (ret < 0) {
@@ -313,8 +651,45 @@ out:
 static void
 posix_prep_writev(struct io_uring_sqe *sqe, struct posix_uring_ctx *ctx)
 {
-    io_uring_prep_writev(sqe, ctx->_fd, ctx->fop.write.iov,
-                         ctx->fop.write.count, ctx->fop.write.offset);
+    if (ctx->fop.write.buf_index >= 0)
+        io_uring_prep_write_fixed(sqe, ctx->_fd, ctx->fop.write.iov[0].iov_base,
+                                  ctx->fop.write.iov[0].iov_len,
+                                  ctx->fop.write.offset,
+                                  ctx->fop.write.buf_index);
+    else
+        io_uring_prep_writev(sqe, ctx->_fd, ctx->fop.write.iov,
+                             ctx->fop.write.count, ctx->fop.write.offset);
+}
+
+/* A single vector entirely within one iobuf of @iobref can be written from
+ * the registered buffer. */
+static int
+posix_io_uring_writev_buf_index(struct posix_private *priv, struct iovec *iov,
+                                int count, struct iobref *iobref)
+{
+    int index = -1;
+    int i = 0;
+
+    if (!priv->uring_fixed_bufs || (count != 1) || !iobref)
+        return -1;
+
+    posix_io_uring_buf_sync(priv);
+
+    LOCK(&iobref->lock);
+    {
+        for (i = 0; i < iobref->allocated; i++) {
+            index = posix_io_uring_buf_index(priv, iobref->iobrefs[i],
+                                             iov[0].iov_base, iov[0].iov_len);
+            if (index >= 0)
+                break;
+        }
+    }
+    UNLOCK(&iobref->lock);
+
+    if (index >= 0)
+        GF_ATOMIC_INC(priv->uring_fixed_ios);
+
+    return index;
 }
 
 int
@@ -336,6 +711,8 @@ posix_io_uring_writev(call_frame_t *frame, xlator_t *this, fd_t *fd,
     ctx->fop.write.iov = iov;
     ctx->fop.write.count = count;
     ctx->fop.write.offset = offset;
+    ctx->fop.write.buf_index = posix_io_uring_writev_buf_index(
+        this->private, iov, count, iobref);
 
     ret = posix_io_uring_submit(this, ctx);
     if (ret < 0) {
@@ -444,130 +821,2106 @@ err:
     return 0;
 }
 
+/* Hand @ctx to the ring. -EAGAIN means the submission queue was full and
+ * nothing was queued, the caller can still serve the fop synchronously. */
 static int
-posix_io_uring_submit(xlator_t *this, struct posix_uring_ctx *ctx)
+posix_io_uring_start(xlator_t *this, struct posix_uring_ctx *ctx)
 {
-    struct posix_private *priv = this->private;
-    struct io_uring_sqe *sqe = NULL;
     int ret = 0;
 
-    pthread_mutex_lock(&priv->sq_mutex);
-    {
-        sqe = io_uring_get_sqe(&priv->ring);
-        if (!sqe) {
-            /*TODO: Retry until we get an sqe instead of failing. */
-            pthread_mutex_unlock(&priv->sq_mutex);
-            ret = -EAGAIN;
+    DECLARE_OLD_FS_ID_VAR;
+
+    /* The kernel runs the request with the credentials of the submitter,
+     * the fs ids must be those of the caller, as for the synchronous fops. */
+    SET_FS_ID(ctx->frame->root->uid, ctx->frame->root->gid);
+    ret = posix_io_uring_submit(this, ctx);
+    SET_TO_OLD_FS_ID();
+
+    if (ret < 0) {
+        if (ret != -EAGAIN)
             gf_msg(this->name, GF_LOG_ERROR, -ret, P_MSG_POSIX_IO_URING,
-                   "Failed to get sqe");
-            goto out;
-        }
-        ctx->prepare(sqe, ctx);
-        io_uring_sqe_set_data(sqe, ctx);
-        ret = io_uring_submit(&priv->ring);
+                   "Failed to submit sqe");
+        return ret;
     }
-    pthread_mutex_unlock(&priv->sq_mutex);
-
-out:
-    return ret;
+    if (ret == 0) {
+        gf_msg(this->name, GF_LOG_WARNING, 0, P_MSG_POSIX_IO_URING,
+               "submit sqe got zero");
+    }
+    return 0;
 }
 
-static void *
-posix_io_uring_thread(void *data)
+static void
+posix_io_uring_stat_complete(struct posix_uring_ctx *ctx, int32_t res)
 {
+    call_frame_t *frame = NULL;
     xlator_t *this = NULL;
     struct posix_private *priv = NULL;
-    int ret = 0;
-    int32_t res = 0;
-    struct io_uring_cqe *cqe = NULL;
-    struct posix_uring_ctx *ctx = NULL;
+    struct stat lstatbuf = {
+        0,
+    };
+    struct iatt buf = {
+        0,
+    };
+    dict_t *xattr_rsp = NULL;
+    char *real_path = NULL;
+    loc_t *loc = NULL;
+    int op_ret = -1;
+    int op_errno = 0;
 
-    this = data;
-    THIS = this;
+    frame = ctx->frame;
+    this = frame->this;
     priv = this->private;
-    while (1) {
-        pthread_mutex_lock(&priv->cq_mutex);
-        {
-            ret = io_uring_wait_cqe(&priv->ring, &cqe);
-        }
-        pthread_mutex_unlock(&priv->cq_mutex);
-        if (ret != 0) {
-            if (ret == -EINTR)
-                continue;
-            gf_msg(this->name, GF_LOG_WARNING, -ret, P_MSG_POSIX_IO_URING,
-                   "Unable to get cqe. Exiting.");
-            abort();
-        }
+    loc = &ctx->loc;
 
-        ctx = (struct posix_uring_ctx *)io_uring_cqe_get_data(cqe);
-        if (priv->uring_thread_exit == _gf_true && ctx == NULL)
-            pthread_exit(NULL);
-        res = cqe->res;
-        io_uring_cqe_seen(&priv->ring, cqe);
-        ctx->unwind(ctx, res);
+    MAKE_HANDLE_ABSPATH(real_path, this, loc->gfid);
+
+    if (res < 0) {
+        op_errno = -res;
+        if (op_errno == ENOENT) {
+            gf_msg_debug(this->name, op_errno,
+                         "statx(async) on gfid-handle %s (path: %s) failed",
+                         real_path, loc->path);
+        } else {
+            gf_msg(this->name, GF_LOG_ERROR, op_errno, P_MSG_LSTAT_FAILED,
+                   "statx(async) on gfid-handle %s (path: %s) failed",
+                   real_path, loc->path);
+        }
+        goto out;
     }
 
-    return NULL;
-}
+    posix_statx_to_stat(&ctx->fop.stat.stx, &lstatbuf);
 
-int
-posix_io_uring_init(xlator_t *this)
-{
-    int ret = -1;
-    unsigned flags = 0;
-    struct posix_private *priv = this->private;
+    if (S_ISLNK(lstatbuf.st_mode)) {
+        /* A directory handle, the inode type we were given was stale.
+         * Resolve it the usual way. */
+        posix_stat(frame, this, loc, ctx->xdata);
+        posix_io_uring_ctx_free(ctx);
+        return;
+    }
 
-    // TODO:Try-out flags |= IORING_SETUP_IOPOLL;
-    ret = io_uring_queue_init(POSIX_URING_MAX_ENTRIES, &priv->ring, flags);
-    if (ret == -1) {
-        gf_msg(this->name, GF_LOG_ERROR, 0, P_MSG_POSIX_IO_URING,
-               "io_uring init failed.");
+    if ((lstatbuf.st_ino == priv->handledir.st_ino) &&
+        (lstatbuf.st_dev == priv->handledir.st_dev)) {
+        op_errno = ENOENT;
         goto out;
     }
 
-    pthread_mutex_init(&priv->sq_mutex, NULL);
-    pthread_mutex_init(&priv->cq_mutex, NULL);
-    ret = gf_thread_create(&priv->uring_thread, NULL, posix_io_uring_thread,
-                           this, "posix-iouring");
-    if (ret != 0) {
-        io_uring_queue_exit(&priv->ring);
-        pthread_mutex_destroy(&priv->sq_mutex);
-        pthread_mutex_destroy(&priv->cq_mutex);
+    if (!S_ISDIR(lstatbuf.st_mode))
+        lstatbuf.st_nlink--;
+
+    iatt_from_stat(&buf, &lstatbuf);
+
+    if (priv->ctime &&
+        posix_get_mdata_xattr(this, real_path, -1, loc->inode, &buf)) {
+        op_errno = errno;
+        gf_msg(this->name, GF_LOG_WARNING, errno, P_MSG_GETMDATA_FAILED,
+               "posix get mdata failed on %s", real_path);
         goto out;
     }
 
+    gf_uuid_copy(buf.ia_gfid, loc->gfid);
+    buf.ia_flags |= IATT_GFID;
+    posix_fill_ino_from_gfid(this, &buf);
+
+    if (ctx->xdata)
+        xattr_rsp = posix_xattr_fill(this, real_path, loc, NULL, -1,
+                                     ctx->xdata, &buf);
+
+    op_ret = 0;
 out:
-    return ret;
+    STACK_UNWIND_STRICT(stat, frame, op_ret, op_errno, &buf, xattr_rsp);
+    if (xattr_rsp)
+        dict_unref(xattr_rsp);
+    posix_io_uring_ctx_free(ctx);
 }
 
-static int
-posix_io_uring_drain(struct posix_private *priv)
+static void
+posix_prep_stat(struct io_uring_sqe *sqe, struct posix_uring_ctx *ctx)
 {
-    struct io_uring_sqe *sqe = NULL;
-    int ret = -1;
-
-    priv->uring_thread_exit = _gf_true;
-    sqe = io_uring_get_sqe(&priv->ring);
-    if (!sqe)
-        return ret;
-
-    io_uring_sqe_set_flags(sqe, IOSQE_IO_DRAIN);
-    io_uring_sqe_set_data(sqe, NULL);
-    io_uring_prep_nop(sqe);
-    ret = io_uring_submit(&priv->ring);
-
-    return ret;
+    io_uring_prep_statx(sqe, ctx->dfd, ctx->handle,
+                        AT_SYMLINK_NOFOLLOW | AT_STATX_SYNC_AS_STAT,
+                        STATX_BASIC_STATS, &ctx->fop.stat.stx);
 }
 
-void
-posix_io_uring_fini(xlator_t *this)
+int
+posix_io_uring_stat(call_frame_t *frame, xlator_t *this, loc_t *loc,
+                    dict_t *xdata)
 {
-    struct posix_private *priv = this->private;
+    struct posix_uring_ctx *ctx = NULL;
+    int32_t op_errno = ENOMEM;
+    int ret = 0;
+
+    if (!posix_io_uring_loc_ok(loc) || posix_io_uring_cs_xdata(xdata))
+        return posix_stat(frame, this, loc, xdata);
+
+    ctx = posix_io_uring_ctx_init_loc(frame, this, loc, GF_FOP_STAT,
+                                      posix_prep_stat,
+                                      posix_io_uring_stat_complete, &op_errno,
+                                      xdata);
+    if (!ctx) {
+        goto err;
+    }
+
+    ret = posix_io_uring_start(this, ctx);
+    if (ret == -EAGAIN) {
+        posix_io_uring_ctx_free(ctx);
+        return posix_stat(frame, this, loc, xdata);
+    }
+    if (ret < 0) {
+        op_errno = -ret;
+        goto err;
+    }
+    return 0;
+err:
+    STACK_UNWIND_STRICT(stat, frame, -1, op_errno, NULL, NULL);
+    posix_io_uring_ctx_free(ctx);
+    return 0;
+}
+
+static void
+posix_io_uring_fstat_complete(struct posix_uring_ctx *ctx, int32_t res)
+{
+    call_frame_t *frame = NULL;
+    xlator_t *this = NULL;
+    struct stat fstatbuf = {
+        0,
+    };
+    struct iatt buf = {
+        0,
+    };
+    dict_t *xattr_rsp = NULL;
+    fd_t *fd = NULL;
+    int _fd = -1;
+    int op_ret = -1;
+    int op_errno = 0;
+
+    frame = ctx->frame;
+    this = frame->this;
+    fd = ctx->fd;
+    _fd = ctx->_fd;
+
+    if (res < 0) {
+        op_errno = -res;
+        gf_msg(this->name, GF_LOG_ERROR, op_errno, P_MSG_FSTAT_FAILED,
+               "fstat(async) failed on fd=%p", fd);
+        goto out;
+    }
+
+    posix_statx_to_stat(&ctx->fop.stat.stx, &fstatbuf);
+
+    if (posix_fdstat_from_stat(this, fd->inode, _fd, &fstatbuf, &buf) == -1) {
+        op_errno = errno;
+        gf_msg(this->name, GF_LOG_ERROR, errno, P_MSG_FSTAT_FAILED,
+               "fstat failed on fd=%p", fd);
+        goto out;
+    }
+
+    if (ctx->xdata)
+        xattr_rsp = posix_xattr_fill(this, NULL, NULL, fd, _fd, ctx->xdata,
+                                     &buf);
+
+    op_ret = 0;
+out:
+    STACK_UNWIND_STRICT(fstat, frame, op_ret, op_errno, &buf, xattr_rsp);
+    if (xattr_rsp)
+        dict_unref(xattr_rsp);
+    posix_io_uring_ctx_free(ctx);
+}
+
+static void
+posix_prep_fstat(struct io_uring_sqe *sqe, struct posix_uring_ctx *ctx)
+{
+    io_uring_prep_statx(sqe, ctx->_fd, "",
+                        AT_EMPTY_PATH | AT_STATX_SYNC_AS_STAT,
+                        STATX_BASIC_STATS, &ctx->fop.stat.stx);
+}
+
+int
+posix_io_uring_fstat(call_frame_t *frame, xlator_t *this, fd_t *fd,
+                     dict_t *xdata)
+{
+    struct posix_uring_ctx *ctx = NULL;
+    int32_t op_errno = ENOMEM;
+    int ret = 0;
+
+    if (posix_io_uring_cs_xdata(xdata))
+        return posix_fstat(frame, this, fd, xdata);
+
+    ctx = posix_io_uring_ctx_init(frame, this, fd, GF_FOP_FSTAT,
+                                  posix_prep_fstat,
+                                  posix_io_uring_fstat_complete, &op_errno,
+                                  xdata);
+    if (!ctx) {
+        goto err;
+    }
+
+    ret = posix_io_uring_start(this, ctx);
+    if (ret == -EAGAIN) {
+        posix_io_uring_ctx_free(ctx);
+        return posix_fstat(frame, this, fd, xdata);
+    }
+    if (ret < 0) {
+        op_errno = -ret;
+        goto err;
+    }
+    return 0;
+err:
+    STACK_UNWIND_STRICT(fstat, frame, -1, op_errno, NULL, NULL);
+    posix_io_uring_ctx_free(ctx);
+    return 0;
+}
+
+static void
+posix_io_uring_open_complete(struct posix_uring_ctx *ctx, int32_t res)
+{
+    call_frame_t *frame = NULL;
+    xlator_t *this = NULL;
+    struct posix_fd *pfd = NULL;
+    char *real_path = NULL;
+    loc_t *loc = NULL;
+    fd_t *fd = NULL;
+    int _fd = -1;
+    int op_ret = -1;
+    int op_errno = 0;
+
+    frame = ctx->frame;
+    this = frame->this;
+    loc = &ctx->loc;
+    fd = ctx->fd;
+
+    MAKE_HANDLE_ABSPATH(real_path, this, loc->gfid);
+
+    if (res < 0) {
+        op_errno = -res;
+        gf_msg(this->name, GF_LOG_ERROR, op_errno, P_MSG_FILE_OP_FAILED,
+               "open(async) on gfid-handle %s (path: %s), flags: %d",
+               real_path, loc->path, ctx->fop.open.flags);
+        goto out;
+    }
+    _fd = res;
+
+    posix_set_ctime(frame, this, real_path, -1, loc->inode, &ctx->prebuf);
+
+    pfd = GF_CALLOC(1, sizeof(*pfd), gf_posix_mt_posix_fd);
+    if (!pfd) {
+        op_errno = ENOMEM;
+        goto out;
+    }
+
+    pfd->flags = ctx->fop.open.flags;
+    pfd->fd = _fd;
+
+    if (fd_ctx_set(fd, this, (uint64_t)(long)pfd))
+        gf_msg(this->name, GF_LOG_WARNING, 0, P_MSG_FD_PATH_SETTING_FAILED,
+               "failed to set the fd context gfid-handle=%s path=%s fd=%p",
+               real_path, loc->path, fd);
+
+    op_ret = 0;
+out:
+    if ((op_ret == -1) && (_fd != -1))
+        sys_close(_fd);
+
+    STACK_UNWIND_STRICT(open, frame, op_ret, op_errno, fd, NULL);
+    posix_io_uring_ctx_free(ctx);
+}
+
+static void
+posix_prep_open(struct io_uring_sqe *sqe, struct posix_uring_ctx *ctx)
+{
+    struct posix_private *priv = ctx->frame->this->private;
+
+    io_uring_prep_openat(sqe, ctx->dfd, ctx->handle, ctx->fop.open.flags,
+                         priv->force_create_mode);
+}
+
+int
+posix_io_uring_open(call_frame_t *frame, xlator_t *this, loc_t *loc,
+                    int32_t flags, fd_t *fd, dict_t *xdata)
+{
+    struct posix_private *priv = this->private;
+    struct posix_uring_ctx *ctx = NULL;
+    int32_t op_errno = ENOMEM;
+    int ret = 0;
+
+    /* creation needs the disk space checks of the synchronous path */
+    if (!posix_io_uring_loc_ok(loc) || (flags & O_CREAT) ||
+        posix_io_uring_cs_xdata(xdata))
+        return posix_open(frame, this, loc, flags, fd, xdata);
+
+    ctx = posix_io_uring_ctx_init_loc(frame, this, loc, GF_FOP_OPEN,
+                                      posix_prep_open,
+                                      posix_io_uring_open_complete, &op_errno,
+                                      xdata);
+    if (!ctx) {
+        goto err;
+    }
+
+    /* same checks as posix_open(), the iatt is also needed for the ctime */
+    if (posix_istat(this, loc->inode, loc->gfid, NULL, &ctx->prebuf) < 0) {
+        op_errno = (errno == ENOENT) ? ESTALE : errno;
+        goto err;
+    }
+    if (IA_ISLNK(ctx->prebuf.ia_type)) {
+        op_errno = ELOOP;
+        goto err;
+    }
+
+    ctx->fd = fd_ref(fd);
+    ctx->fop.open.flags = flags;
+    if (priv->o_direct)
+        ctx->fop.open.flags |= O_DIRECT;
+
+    ret = posix_io_uring_start(this, ctx);
+    if (ret == -EAGAIN) {
+        posix_io_uring_ctx_free(ctx);
+        return posix_open(frame, this, loc, flags, fd, xdata);
+    }
+    if (ret < 0) {
+        op_errno = -ret;
+        goto err;
+    }
+    return 0;
+err:
+    STACK_UNWIND_STRICT(open, frame, -1, op_errno, fd, NULL);
+    posix_io_uring_ctx_free(ctx);
+    return 0;
+}
+
+static void
+posix_io_uring_fallocate_unwind(struct posix_uring_ctx *ctx, int32_t op_ret,
+                                int32_t op_errno, struct iatt *postbuf)
+{
+    struct iatt *prebuf = (op_ret < 0) ? NULL : &ctx->prebuf;
+
+    switch (ctx->op) {
+        case GF_FOP_FALLOCATE:
+            STACK_UNWIND_STRICT(fallocate, ctx->frame, op_ret, op_errno,
+                                prebuf, postbuf, NULL);
+            break;
+        case GF_FOP_DISCARD:
+            STACK_UNWIND_STRICT(discard, ctx->frame, op_ret, op_errno, prebuf,
+                                postbuf, NULL);
+            break;
+        case GF_FOP_ZEROFILL:
+            STACK_UNWIND_STRICT(zerofill, ctx->frame, op_ret, op_errno,
+                                prebuf, postbuf, NULL);
+            break;
+        default:
+            break;
+    }
+}
+
+static void
+posix_io_uring_fallocate_complete(struct posix_uring_ctx *ctx, int32_t res)
+{
+    call_frame_t *frame = NULL;
+    xlator_t *this = NULL;
+    struct iatt postbuf = {
+        0,
+    };
+    fd_t *fd = NULL;
+    int _fd = -1;
+    int op_ret = -1;
+    int op_errno = 0;
+
+    frame = ctx->frame;
+    this = frame->this;
+    fd = ctx->fd;
+    _fd = ctx->_fd;
+
+    if (res < 0) {
+        op_errno = -res;
+        if ((ctx->op == GF_FOP_ZEROFILL) &&
+            ((op_errno == ENOSYS) || (op_errno == EOPNOTSUPP))) {
+            /* No FALLOC_FL_ZERO_RANGE on this filesystem, the synchronous
+             * path knows how to write the zeroes itself. */
+            posix_zerofill(frame, this, fd, ctx->fop.fallocate.offset,
+                           ctx->fop.fallocate.len, ctx->xdata);
+            posix_io_uring_ctx_free(ctx);
+            return;
+        }
+        gf_msg(this->name, GF_LOG_ERROR, op_errno, P_MSG_FALLOCATE_FAILED,
+               "fallocate(async) failed on %s offset: %jd, len:%jd, "
+               "flags: %d",
+               uuid_utoa(fd->inode->gfid), (intmax_t)ctx->fop.fallocate.offset,
+               (intmax_t)ctx->fop.fallocate.len, ctx->fop.fallocate.mode);
+        goto out;
+    }
+
+    if ((ctx->op == GF_FOP_ZEROFILL) && (ctx->fdflags & (O_SYNC | O_DSYNC))) {
+        if (sys_fsync(_fd)) {
+            op_errno = errno;
+            gf_msg(this->name, GF_LOG_ERROR, op_errno, P_MSG_WRITEV_FAILED,
+                   "fsync() in zerofill on fd %d failed", _fd);
+            goto out;
+        }
+    }
+
+    if (posix_fdstat(this, fd->inode, _fd, &postbuf) == -1) {
+        op_errno = errno;
+        gf_msg(this->name, GF_LOG_ERROR, op_errno, P_MSG_FSTAT_FAILED,
+               "fstat failed on fd=%d", _fd);
+        goto out;
+    }
+
+    posix_set_ctime(frame, this, NULL, _fd, fd->inode, &postbuf);
+
+    op_ret = 0;
+out:
+    posix_io_uring_fallocate_unwind(ctx, op_ret, op_errno,
+                                    (op_ret < 0) ? NULL : &postbuf);
+    posix_io_uring_ctx_free(ctx);
+}
+
+static void
+posix_prep_fallocate(struct io_uring_sqe *sqe, struct posix_uring_ctx *ctx)
+{
+    io_uring_prep_fallocate(sqe, ctx->_fd, ctx->fop.fallocate.mode,
+                            ctx->fop.fallocate.offset,
+                            ctx->fop.fallocate.len);
+}
+
+/* Space reservation, the overwrite-on-ENOSPC logic and atomic updates are
+ * left to the synchronous implementation. */
+static gf_boolean_t
+posix_io_uring_fallocate_ok(struct posix_private *priv, dict_t *xdata)
+{
+    if (priv->disk_reserve || priv->disk_space_full)
+        return _gf_false;
+
+    if (xdata && dict_get_sizen(xdata, GLUSTERFS_WRITE_UPDATE_ATOMIC))
+        return _gf_false;
+
+    return !posix_io_uring_cs_xdata(xdata);
+}
+
+static int
+posix_io_uring_do_fallocate(call_frame_t *frame, xlator_t *this, fd_t *fd,
+                            int op, int32_t mode, off_t offset, off_t len,
+                            dict_t *xdata)
+{
+    struct posix_uring_ctx *ctx = NULL;
+    int32_t op_errno = ENOMEM;
+    int ret = 0;
+
+    ctx = posix_io_uring_ctx_init(frame, this, fd, op, posix_prep_fallocate,
+                                  posix_io_uring_fallocate_complete, &op_errno,
+                                  xdata);
+    if (!ctx) {
+        return -op_errno;
+    }
+
+    ctx->fop.fallocate.mode = mode;
+    ctx->fop.fallocate.offset = offset;
+    ctx->fop.fallocate.len = len;
+
+    ret = posix_io_uring_start(this, ctx);
+    if (ret < 0)
+        posix_io_uring_ctx_free(ctx);
+
+    return ret;
+}
+
+int
+posix_io_uring_fallocate(call_frame_t *frame, xlator_t *this, fd_t *fd,
+                         int32_t keep_size, off_t offset, size_t len,
+                         dict_t *xdata)
+{
+    int32_t mode = 0;
+    int ret = 0;
+
+    if (!posix_io_uring_fallocate_ok(this->private, xdata))
+        return posix_glfallocate(frame, this, fd, keep_size, offset, len,
+                                 xdata);
+
+    if (keep_size)
+        mode = FALLOC_FL_KEEP_SIZE;
+
+    ret = posix_io_uring_do_fallocate(frame, this, fd, GF_FOP_FALLOCATE, mode,
+                                      offset, len, xdata);
+    if (ret == -EAGAIN)
+        return posix_glfallocate(frame, this, fd, keep_size, offset, len,
+                                 xdata);
+    if (ret < 0)
+        STACK_UNWIND_STRICT(fallocate, frame, -1, -ret, NULL, NULL, NULL);
+    return 0;
+}
+
+int
+posix_io_uring_discard(call_frame_t *frame, xlator_t *this, fd_t *fd,
+                       off_t offset, size_t len, dict_t *xdata)
+{
+    int ret = 0;
+
+    if (!posix_io_uring_fallocate_ok(this->private, xdata))
+        return posix_discard(frame, this, fd, offset, len, xdata);
+
+    ret = posix_io_uring_do_fallocate(frame, this, fd, GF_FOP_DISCARD,
+                                      FALLOC_FL_KEEP_SIZE |
+                                          FALLOC_FL_PUNCH_HOLE,
+                                      offset, len, xdata);
+    if (ret == -EAGAIN)
+        return posix_discard(frame, this, fd, offset, len, xdata);
+    if (ret < 0)
+        STACK_UNWIND_STRICT(discard, frame, -1, -ret, NULL, NULL, NULL);
+    return 0;
+}
+
+int
+posix_io_uring_zerofill(call_frame_t *frame, xlator_t *this, fd_t *fd,
+                        off_t offset, off_t len, dict_t *xdata)
+{
+    int ret = 0;
+
+    if (!posix_io_uring_fallocate_ok(this->private, xdata))
+        return posix_zerofill(frame, this, fd, offset, len, xdata);
+
+    ret = posix_io_uring_do_fallocate(frame, this, fd, GF_FOP_ZEROFILL,
+                                      FALLOC_FL_ZERO_RANGE, offset, len,
+                                      xdata);
+    if (ret == -EAGAIN)
+        return posix_zerofill(frame, this, fd, offset, len, xdata);
+    if (ret < 0)
+        STACK_UNWIND_STRICT(zerofill, frame, -1, -ret, NULL, NULL, NULL);
+    return 0;
+}
+
+static void
+posix_io_uring_fgetxattr_complete(struct posix_uring_ctx *ctx, int32_t res)
+{
+    call_frame_t *frame = NULL;
+    xlator_t *this = NULL;
+    struct iatt buf = {
+        0,
+    };
+    dict_t *dict = NULL;
+    dict_t *xattr_rsp = NULL;
+    char *name = NULL;
+    char *value = NULL;
+    fd_t *fd = NULL;
+    int op_ret = -1;
+    int op_errno = 0;
+
+    frame = ctx->frame;
+    this = frame->this;
+    fd = ctx->fd;
+    name = ctx->fop.xattr.name;
+
+    if (res == -ERANGE) {
+        /* larger than XATTR_VAL_BUF_SIZE, let the synchronous path size
+         * the buffer */
+        posix_fgetxattr(frame, this, fd, name, ctx->xdata);
+        posix_io_uring_ctx_free(ctx);
+        return;
+    }
+
+    dict = dict_new();
+    if (!dict) {
+        op_errno = ENOMEM;
+        goto out;
+    }
+
+    if (res < 0) {
+        op_errno = -res;
+        if (op_errno == ENODATA) {
+            gf_msg_debug(this->name, op_errno, "fgetxattr failed on key %s",
+                         name);
+        } else {
+            gf_msg(this->name, GF_LOG_ERROR, op_errno, P_MSG_XATTR_FAILED,
+                   "fgetxattr(async) failed on key %s", name);
+        }
+        goto out;
+    }
+
+    value = GF_MALLOC(res + 1, gf_posix_mt_char);
+    if (!value) {
+        op_errno = ENOMEM;
+        goto out;
+    }
+    memcpy(value, ctx->fop.xattr.value, res);
+    value[res] = '\0';
+
+    if (dict_set_dynptr(dict, name, value, res) < 0) {
+        op_errno = ENOMEM;
+        gf_msg(this->name, GF_LOG_ERROR, 0, P_MSG_DICT_SET_FAILED,
+               "dict set operation on key %s failed", name);
+        GF_FREE(value);
+        goto out;
+    }
+
+    op_ret = res;
+
+    if (ctx->xdata)
+        xattr_rsp = posix_xattr_fill(this, NULL, NULL, fd, ctx->_fd,
+                                     ctx->xdata, &buf);
+
+    dict_del(dict, GFID_XATTR_KEY);
+    dict_del(dict, GF_XATTR_VOL_ID_KEY);
+out:
+    STACK_UNWIND_STRICT(fgetxattr, frame, op_ret, op_errno, dict, xattr_rsp);
+    if (xattr_rsp)
+        dict_unref(xattr_rsp);
+    if (dict)
+        dict_unref(dict);
+    posix_io_uring_ctx_free(ctx);
+}
+
+static void
+posix_prep_fgetxattr(struct io_uring_sqe *sqe, struct posix_uring_ctx *ctx)
+{
+    io_uring_prep_fgetxattr(sqe, ctx->_fd, ctx->fop.xattr.name,
+                            ctx->fop.xattr.value, ctx->fop.xattr.size);
+}
+
+int
+posix_io_uring_fgetxattr(call_frame_t *frame, xlator_t *this, fd_t *fd,
+                         const char *name, dict_t *xdata)
+{
+    struct posix_uring_ctx *ctx = NULL;
+    int32_t op_errno = ENOMEM;
+    int ret = 0;
+
+    /* listing and virtual keys stay synchronous */
+    if (!name || !strcmp(name, GLUSTERFS_OPEN_FD_COUNT) ||
+        !strncmp(name, GLUSTERFS_GET_OBJECT_SIGNATURE,
+                 SLEN(GLUSTERFS_GET_OBJECT_SIGNATURE)))
+        return posix_fgetxattr(frame, this, fd, name, xdata);
+
+    ctx = posix_io_uring_ctx_init(frame, this, fd, GF_FOP_FGETXATTR,
+                                  posix_prep_fgetxattr,
+                                  posix_io_uring_fgetxattr_complete,
+                                  &op_errno, xdata);
+    if (!ctx) {
+        goto err;
+    }
+
+    ctx->fop.xattr.name = gf_strdup(name);
+    ctx->fop.xattr.value = GF_MALLOC(XATTR_VAL_BUF_SIZE, gf_posix_mt_char);
+    if (!ctx->fop.xattr.name || !ctx->fop.xattr.value) {
+        op_errno = ENOMEM;
+        goto err;
+    }
+    ctx->fop.xattr.size = XATTR_VAL_BUF_SIZE - 1;
+
+    ret = posix_io_uring_start(this, ctx);
+    if (ret == -EAGAIN) {
+        posix_io_uring_ctx_free(ctx);
+        return posix_fgetxattr(frame, this, fd, name, xdata);
+    }
+    if (ret < 0) {
+        op_errno = -ret;
+        goto err;
+    }
+    return 0;
+err:
+    STACK_UNWIND_STRICT(fgetxattr, frame, -1, op_errno, NULL, NULL);
+    posix_io_uring_ctx_free(ctx);
+    return 0;
+}
+
+static void
+posix_io_uring_fsetxattr_complete(struct posix_uring_ctx *ctx, int32_t res)
+{
+    call_frame_t *frame = NULL;
+    xlator_t *this = NULL;
+    struct iatt postbuf = {
+        0,
+    };
+    dict_t *xattr = NULL;
+    fd_t *fd = NULL;
+    int _fd = -1;
+    int op_ret = -1;
+    int op_errno = 0;
+
+    frame = ctx->frame;
+    this = frame->this;
+    fd = ctx->fd;
+    _fd = ctx->_fd;
+
+    if (res < 0) {
+        op_errno = -res;
+        gf_msg(this->name, GF_LOG_ERROR, op_errno, P_MSG_XATTR_FAILED,
+               "fd=%d: key:%s", _fd, ctx->fop.xattr.name);
+    } else {
+        op_ret = 0;
+    }
+
+    if (posix_fdstat(this, fd->inode, _fd, &postbuf) == -1) {
+        op_ret = -1;
+        op_errno = errno;
+        gf_msg(this->name, GF_LOG_ERROR, op_errno, P_MSG_XATTR_FAILED,
+               "fsetxattr (fstat) failed on fd=%p", fd);
+        goto out;
+    }
+
+    if (op_ret == 0)
+        posix_set_ctime(frame, this, NULL, _fd, fd->inode, &postbuf);
+
+    xattr = dict_new();
+    if (xattr)
+        posix_set_iatt_in_dict(xattr, &ctx->prebuf, &postbuf);
+out:
+    STACK_UNWIND_STRICT(fsetxattr, frame, op_ret, op_errno, xattr);
+    if (xattr)
+        dict_unref(xattr);
+    posix_io_uring_ctx_free(ctx);
+}
+
+static void
+posix_prep_fsetxattr(struct io_uring_sqe *sqe, struct posix_uring_ctx *ctx)
+{
+    io_uring_prep_fsetxattr(sqe, ctx->_fd, ctx->fop.xattr.name,
+                            ctx->fop.xattr.value, ctx->fop.xattr.flags,
+                            ctx->fop.xattr.size);
+}
+
+/* Only a single plain key is set from the ring, everything with a special
+ * meaning for posix_fhandle_pair() takes the synchronous path. */
+static gf_boolean_t
+posix_io_uring_fsetxattr_ok(struct posix_private *priv, dict_t *dict,
+                            dict_t *xdata)
+{
+    const char *key = NULL;
+
+    if (!dict || (dict->count != 1) || !dict->members_list)
+        return _gf_false;
+
+    if (priv->disk_space_full)
+        return _gf_false;
+
+    if (xdata && dict_get_sizen(xdata, GLUSTERFS_DURABLE_OP))
+        return _gf_false;
+
+    key = dict->members_list->key;
+    if (!strcmp(key, GFID_XATTR_KEY) || !strcmp(key, GF_XATTR_VOL_ID_KEY) ||
+        XATTR_IS_PATHINFO(key) || posix_is_gfid2path_xattr(key) ||
+        !strncmp(key, POSIX_ACL_ACCESS_XATTR, SLEN(POSIX_ACL_ACCESS_XATTR)))
+        return _gf_false;
+
+    return _gf_true;
+}
+
+int
+posix_io_uring_fsetxattr(call_frame_t *frame, xlator_t *this, fd_t *fd,
+                         dict_t *dict, int flags, dict_t *xdata)
+{
+    struct posix_uring_ctx *ctx = NULL;
+    data_pair_t *pair = NULL;
+    int32_t op_errno = ENOMEM;
+    int ret = 0;
+
+    if (!posix_io_uring_fsetxattr_ok(this->private, dict, xdata))
+        return posix_fsetxattr(frame, this, fd, dict, flags, xdata);
+
+    ctx = posix_io_uring_ctx_init(frame, this, fd, GF_FOP_FSETXATTR,
+                                  posix_prep_fsetxattr,
+                                  posix_io_uring_fsetxattr_complete,
+                                  &op_errno, xdata);
+    if (!ctx) {
+        goto err;
+    }
+
+    pair = dict->members_list;
+    ctx->fop.xattr.dict = dict_ref(dict);
+    ctx->fop.xattr.name = pair->key;
+    ctx->fop.xattr.value = pair->value->data;
+    ctx->fop.xattr.size = pair->value->len;
+    ctx->fop.xattr.flags = flags;
+
+    ret = posix_io_uring_start(this, ctx);
+    if (ret == -EAGAIN) {
+        posix_io_uring_ctx_free(ctx);
+        return posix_fsetxattr(frame, this, fd, dict, flags, xdata);
+    }
+    if (ret < 0) {
+        op_errno = -ret;
+        goto err;
+    }
+    return 0;
+err:
+    STACK_UNWIND_STRICT(fsetxattr, frame, -1, op_errno, NULL);
+    posix_io_uring_ctx_free(ctx);
+    return 0;
+}
+
+static void
+posix_io_uring_getxattr_complete(struct posix_uring_ctx *ctx, int32_t res)
+{
+    call_frame_t *frame = NULL;
+    xlator_t *this = NULL;
+    struct iatt buf = {
+        0,
+    };
+    dict_t *dict = NULL;
+    dict_t *xattr_rsp = NULL;
+    char *real_path = NULL;
+    char *name = NULL;
+    char *value = NULL;
+    loc_t *loc = NULL;
+    int op_ret = -1;
+    int op_errno = 0;
+
+    frame = ctx->frame;
+    this = frame->this;
+    loc = &ctx->loc;
+    name = ctx->fop.xattr.name;
+    real_path = ctx->fop.xattr.path;
+
+    if (res == -ERANGE) {
+        /* larger than XATTR_VAL_BUF_SIZE, let the synchronous path size
+         * the buffer */
+        posix_getxattr(frame, this, loc, name, ctx->xdata);
+        posix_io_uring_ctx_free(ctx);
+        return;
+    }
+
+    dict = dict_new();
+    if (!dict) {
+        op_errno = ENOMEM;
+        goto out;
+    }
+
+    if (res < 0) {
+        op_errno = -res;
+        if ((op_errno == ENOATTR) || (op_errno == ENODATA)) {
+            gf_msg_debug(this->name, 0,
+                         "No such attribute:%s for file %s (path: %s)", name,
+                         real_path, loc->path);
+        } else {
+            gf_msg(this->name, GF_LOG_ERROR, op_errno, P_MSG_XATTR_FAILED,
+                   "getxattr(async) failed on %s (path: %s): %s ", real_path,
+                   loc->path, name);
+        }
+        goto out;
+    }
+
+    value = GF_MALLOC(res + 1, gf_posix_mt_char);
+    if (!value) {
+        op_errno = ENOMEM;
+        goto out;
+    }
+    memcpy(value, ctx->fop.xattr.value, res);
+    value[res] = '\0';
+
+    if (dict_set_dynptr(dict, name, value, res) < 0) {
+        op_errno = ENOMEM;
+        gf_msg(this->name, GF_LOG_ERROR, 0, P_MSG_DICT_SET_FAILED,
+               "dict set operation on %s (gfid-handle: %s) for the key %s "
+               "failed.",
+               loc->path, real_path, name);
+        GF_FREE(value);
+        goto out;
+    }
+
+    op_ret = res;
+
+    if (ctx->xdata)
+        xattr_rsp = posix_xattr_fill(this, real_path, loc, NULL, -1,
+                                     ctx->xdata, &buf);
+
+    dict_del(dict, GFID_XATTR_KEY);
+    dict_del(dict, GF_XATTR_VOL_ID_KEY);
+out:
+    STACK_UNWIND_STRICT(getxattr, frame, op_ret, op_errno, dict, xattr_rsp);
+    if (xattr_rsp)
+        dict_unref(xattr_rsp);
+    if (dict)
+        dict_unref(dict);
+    posix_io_uring_ctx_free(ctx);
+}
+
+static void
+posix_prep_getxattr(struct io_uring_sqe *sqe, struct posix_uring_ctx *ctx)
+{
+    io_uring_prep_getxattr(sqe, ctx->fop.xattr.name, ctx->fop.xattr.value,
+                           ctx->fop.xattr.path, ctx->fop.xattr.size);
+}
+
+/* Only a stored key is read from the ring, the keys posix_getxattr() answers
+ * or rejects by itself take the synchronous path. */
+static gf_boolean_t
+posix_io_uring_getxattr_ok(call_frame_t *frame, loc_t *loc, const char *name)
+{
+    int op_errno = 0;
+
+    if (!posix_io_uring_loc_ok(loc) || !name)
+        return _gf_false;
+
+    if ((posix_handle_georep_xattrs(frame, name, &op_errno, _gf_true) == -1) ||
+        (posix_handle_mdata_xattr(frame, name, &op_errno) == -1))
+        return _gf_false;
+
+    if (posix_is_gfid2path_xattr(name) || GF_POSIX_ACL_REQUEST(name) ||
+        XATTR_IS_PATHINFO(name) || !strcmp(name, GLUSTERFS_OPEN_FD_COUNT) ||
+        !strcmp(name, GF_XATTR_NODE_UUID_KEY) ||
+        !strcmp(name, GFID_TO_PATH_KEY) ||
+        !strcmp(name, GFID2PATH_VIRT_XATTR_KEY) ||
+        !strcmp(name, GET_ANCESTRY_PATH_KEY) ||
+        !strncmp(name, GF_XATTR_GET_REAL_FILENAME_KEY,
+                 SLEN(GF_XATTR_GET_REAL_FILENAME_KEY)) ||
+        !strncmp(name, GLUSTERFS_GET_OBJECT_SIGNATURE,
+                 SLEN(GLUSTERFS_GET_OBJECT_SIGNATURE)))
+        return _gf_false;
+
+    return _gf_true;
+}
+
+int
+posix_io_uring_getxattr(call_frame_t *frame, xlator_t *this, loc_t *loc,
+                        const char *name, dict_t *xdata)
+{
+    struct posix_uring_ctx *ctx = NULL;
+    char *real_path = NULL;
+    int32_t op_errno = ENOMEM;
+    int ret = 0;
+
+    if (!posix_io_uring_getxattr_ok(frame, loc, name))
+        return posix_getxattr(frame, this, loc, name, xdata);
+
+    ctx = posix_io_uring_ctx_init_loc(frame, this, loc, GF_FOP_GETXATTR,
+                                      posix_prep_getxattr,
+                                      posix_io_uring_getxattr_complete,
+                                      &op_errno, xdata);
+    if (!ctx) {
+        goto err;
+    }
+
+    MAKE_HANDLE_ABSPATH(real_path, this, loc->gfid);
+    ctx->fop.xattr.path = gf_strdup(real_path);
+    ctx->fop.xattr.name = gf_strdup(name);
+    ctx->fop.xattr.value = GF_MALLOC(XATTR_VAL_BUF_SIZE, gf_posix_mt_char);
+    if (!ctx->fop.xattr.path || !ctx->fop.xattr.name ||
+        !ctx->fop.xattr.value) {
+        op_errno = ENOMEM;
+        goto err;
+    }
+    ctx->fop.xattr.size = XATTR_VAL_BUF_SIZE - 1;
+
+    ret = posix_io_uring_start(this, ctx);
+    if (ret == -EAGAIN) {
+        posix_io_uring_ctx_free(ctx);
+        return posix_getxattr(frame, this, loc, name, xdata);
+    }
+    if (ret < 0) {
+        op_errno = -ret;
+        goto err;
+    }
+    return 0;
+err:
+    STACK_UNWIND_STRICT(getxattr, frame, -1, op_errno, NULL, NULL);
+    posix_io_uring_ctx_free(ctx);
+    return 0;
+}
+
+static void
+posix_io_uring_setxattr_complete(struct posix_uring_ctx *ctx, int32_t res)
+{
+    call_frame_t *frame = NULL;
+    xlator_t *this = NULL;
+    struct iatt postop = {
+        0,
+    };
+    dict_t *xattr = NULL;
+    char *real_path = NULL;
+    loc_t *loc = NULL;
+    int op_ret = -1;
+    int op_errno = 0;
+
+    frame = ctx->frame;
+    this = frame->this;
+    loc = &ctx->loc;
+    real_path = ctx->fop.xattr.path;
+
+    if (res < 0) {
+        op_errno = -res;
+        if (op_errno == EEXIST) {
+            gf_msg_debug(this->name, 0, "%s: key:%s flags: %u length:%zu",
+                         real_path, ctx->fop.xattr.name, ctx->fop.xattr.flags,
+                         ctx->fop.xattr.size);
+        } else {
+            gf_msg(this->name, GF_LOG_ERROR, op_errno, P_MSG_XATTR_FAILED,
+                   "%s: key:%s flags: %u length:%zu", real_path,
+                   ctx->fop.xattr.name, ctx->fop.xattr.flags,
+                   ctx->fop.xattr.size);
+        }
+        goto out;
+    }
+
+    op_ret = 0;
+
+    /* same as posix_setxattr(), the iatts are only a hint for DHT */
+    xattr = dict_new();
+    if (!xattr)
+        goto out;
+
+    if (posix_pstat(this, loc->inode, loc->gfid, real_path, &postop,
+                    _gf_false) == 0)
+        posix_set_iatt_in_dict(xattr, &ctx->prebuf, &postop);
+out:
+    STACK_UNWIND_STRICT(setxattr, frame, op_ret, op_errno, xattr);
+    if (xattr)
+        dict_unref(xattr);
+    posix_io_uring_ctx_free(ctx);
+}
+
+static void
+posix_prep_setxattr(struct io_uring_sqe *sqe, struct posix_uring_ctx *ctx)
+{
+    io_uring_prep_setxattr(sqe, ctx->fop.xattr.name, ctx->fop.xattr.value,
+                           ctx->fop.xattr.path, ctx->fop.xattr.flags,
+                           ctx->fop.xattr.size);
+}
+
+/* On top of what the fd based variant leaves out, posix_setxattr() has its
+ * own handling for a few keys. */
+static gf_boolean_t
+posix_io_uring_setxattr_ok(struct posix_private *priv, loc_t *loc,
+                           dict_t *dict, dict_t *xdata)
+{
+    const char *key = NULL;
+
+    if (!posix_io_uring_loc_ok(loc) ||
+        !posix_io_uring_fsetxattr_ok(priv, dict, xdata))
+        return _gf_false;
+
+    if (xdata && dict_get_sizen(xdata, "sync_backend_xattrs"))
+        return _gf_false;
+
+    key = dict->members_list->key;
+    if (!strcmp(key, CTIME_MDATA_XDATA_KEY) ||
+        !strcmp(key, GF_CS_OBJECT_UPLOAD_COMPLETE) ||
+        !strcmp(key, GF_XATTR_IOSTATS_DUMP_KEY) ||
+        !strcmp(key, GF_XATTR_MDATA_KEY) || GF_POSIX_ACL_REQUEST(key) ||
+        !strncmp(key, GF_INTERNAL_CTX_KEY, SLEN(GF_INTERNAL_CTX_KEY)) ||
+        !strncmp(key, GF_FORCE_REPLACE_KEY, SLEN(GF_FORCE_REPLACE_KEY)))
+        return _gf_false;
+
+    return _gf_true;
+}
+
+int
+posix_io_uring_setxattr(call_frame_t *frame, xlator_t *this, loc_t *loc,
+                        dict_t *dict, int flags, dict_t *xdata)
+{
+    struct posix_uring_ctx *ctx = NULL;
+    data_pair_t *pair = NULL;
+    char *real_path = NULL;
+    int32_t op_errno = ENOMEM;
+    int ret = 0;
+
+    if (!posix_io_uring_setxattr_ok(this->private, loc, dict, xdata))
+        return posix_setxattr(frame, this, loc, dict, flags, xdata);
+
+    ctx = posix_io_uring_ctx_init_loc(frame, this, loc, GF_FOP_SETXATTR,
+                                      posix_prep_setxattr,
+                                      posix_io_uring_setxattr_complete,
+                                      &op_errno, xdata);
+    if (!ctx) {
+        goto err;
+    }
+
+    MAKE_HANDLE_ABSPATH(real_path, this, loc->gfid);
+    ctx->fop.xattr.path = gf_strdup(real_path);
+    if (!ctx->fop.xattr.path) {
+        op_errno = ENOMEM;
+        goto err;
+    }
+
+    posix_pstat(this, loc->inode, loc->gfid, real_path, &ctx->prebuf,
+                _gf_false);
+
+    pair = dict->members_list;
+    ctx->fop.xattr.dict = dict_ref(dict);
+    ctx->fop.xattr.name = pair->key;
+    ctx->fop.xattr.value = pair->value->data;
+    ctx->fop.xattr.size = pair->value->len;
+    ctx->fop.xattr.flags = flags;
+
+    ret = posix_io_uring_start(this, ctx);
+    if (ret == -EAGAIN) {
+        posix_io_uring_ctx_free(ctx);
+        return posix_setxattr(frame, this, loc, dict, flags, xdata);
+    }
+    if (ret < 0) {
+        op_errno = -ret;
+        goto err;
+    }
+    return 0;
+err:
+    STACK_UNWIND_STRICT(setxattr, frame, -1, op_errno, NULL);
+    posix_io_uring_ctx_free(ctx);
+    return 0;
+}
+
+/* Resolve the entry @loc names, stat it and its parent, as the synchronous
+ * entry fops do before their syscall. The paths are kept for the completion. */
+static int
+posix_io_uring_entry_path(xlator_t *this, loc_t *loc, char **real_path,
+                          char **par_path, struct iatt *stbuf,
+                          struct iatt *preparent, int32_t *op_errno)
+{
+    char *entry_path = NULL;
+    char *parent_path = NULL;
+    int op_ret = -1;
+
+    MAKE_ENTRY_HANDLE(entry_path, parent_path, this, loc, stbuf);
+    if (!entry_path || !parent_path) {
+        op_ret = -1;
+        *op_errno = ESTALE;
+        goto out;
+    }
+
+    *real_path = gf_strdup(entry_path);
+    *par_path = gf_strdup(parent_path);
+    if (!*real_path || !*par_path) {
+        op_ret = -1;
+        *op_errno = ENOMEM;
+        goto out;
+    }
+
+    op_ret = posix_pstat(this, loc->parent, loc->pargfid, parent_path,
+                         preparent, _gf_false);
+    if (op_ret == -1) {
+        *op_errno = errno;
+        gf_msg(this->name, GF_LOG_ERROR, errno, P_MSG_LSTAT_FAILED,
+               "pre-operation lstat on parent %s failed", parent_path);
+        goto out;
+    }
+
+    op_ret = 0;
+out:
+    return op_ret;
+}
+
+static struct posix_uring_ctx *
+posix_io_uring_ctx_init_entry(call_frame_t *frame, xlator_t *this, loc_t *loc,
+                              int op, fop_prep_f prepare, fop_unwind_f unwind,
+                              int32_t *op_errno, dict_t *xdata)
+{
+    struct posix_uring_ctx *ctx = NULL;
+
+    ctx = posix_io_uring_ctx_alloc(frame, op, prepare, unwind, xdata);
+    if (!ctx) {
+        *op_errno = ENOMEM;
+        return NULL;
+    }
+
+    if (loc_copy(&ctx->loc, loc) != 0) {
+        *op_errno = ENOMEM;
+        goto err;
+    }
+
+    if (posix_io_uring_entry_path(this, loc, &ctx->fop.entry.real_path,
+                                  &ctx->fop.entry.par_path, &ctx->prebuf,
+                                  &ctx->fop.entry.preparent, op_errno) < 0)
+        goto err;
+
+    return ctx;
+
+err:
+    posix_io_uring_ctx_free(ctx);
+    return NULL;
+}
+
+static void
+posix_io_uring_mkdir_complete(struct posix_uring_ctx *ctx, int32_t res)
+{
+    call_frame_t *frame = NULL;
+    xlator_t *this = NULL;
+    struct iatt stbuf = {
+        0,
+    };
+    struct iatt postparent = {
+        0,
+    };
+    gf_boolean_t entry_created = _gf_false;
+    gf_boolean_t gfid_set = _gf_false;
+    char *real_path = NULL;
+    char *par_path = NULL;
+    loc_t *loc = NULL;
+    int op_ret = -1;
+    int op_errno = 0;
+
+    frame = ctx->frame;
+    this = frame->this;
+    loc = &ctx->loc;
+    real_path = ctx->fop.entry.real_path;
+    par_path = ctx->fop.entry.par_path;
+
+    if (res < 0) {
+        op_errno = -res;
+        gf_msg(this->name, GF_LOG_ERROR, op_errno, P_MSG_MKDIR_FAILED,
+               "mkdir(async) of %s failed", real_path);
+        goto out;
+    }
+
+    entry_created = _gf_true;
+
+#ifndef HAVE_SET_FSID
+    if (sys_chown(real_path, frame->root->uid, ctx->fop.entry.gid) == -1) {
+        op_errno = errno;
+        gf_msg(this->name, GF_LOG_ERROR, errno, P_MSG_CHOWN_FAILED,
+               "chown on %s failed", real_path);
+        goto out;
+    }
+#endif
+    if (posix_acl_xattr_set(real_path, ctx->xdata))
+        gf_msg(this->name, GF_LOG_ERROR, errno, P_MSG_ACL_FAILED,
+               "setting ACLs on %s failed ", real_path);
+
+    if (posix_entry_create_xattr_set(this, loc, real_path, ctx->xdata))
+        gf_msg(this->name, GF_LOG_ERROR, errno, P_MSG_XATTR_FAILED,
+               "setting xattrs on %s failed", real_path);
+
+    if (posix_gfid_set(this, real_path, loc, ctx->xdata, frame->root->pid,
+                       &op_errno)) {
+        gf_msg(this->name, GF_LOG_ERROR, op_errno, P_MSG_GFID_FAILED,
+               "setting gfid on %s failed", real_path);
+        goto out;
+    }
+    gfid_set = _gf_true;
+
+    if (posix_pstat(this, loc->inode, NULL, real_path, &stbuf, _gf_false) ==
+        -1) {
+        op_errno = errno;
+        gf_msg(this->name, GF_LOG_ERROR, errno, P_MSG_LSTAT_FAILED,
+               "lstat on %s failed", real_path);
+        goto out;
+    }
+
+    posix_set_ctime(frame, this, real_path, -1, loc->inode, &stbuf);
+
+    if (posix_pstat(this, loc->parent, loc->pargfid, par_path, &postparent,
+                    _gf_false) == -1) {
+        op_errno = errno;
+        gf_msg(this->name, GF_LOG_ERROR, errno, P_MSG_LSTAT_FAILED,
+               "post-operation lstat on parent of %s failed", real_path);
+        goto out;
+    }
+
+    posix_set_parent_ctime(frame, this, par_path, -1, loc->parent, &postparent);
+
+    op_ret = 0;
+out:
+    if (op_ret < 0) {
+        if (entry_created)
+            sys_rmdir(real_path);
+
+        if (gfid_set)
+            posix_gfid_unset(this, ctx->xdata);
+    }
+
+    STACK_UNWIND_STRICT(mkdir, frame, op_ret, op_errno, loc->inode, &stbuf,
+                        &ctx->fop.entry.preparent, &postparent, NULL);
+    posix_io_uring_ctx_free(ctx);
+}
+
+static void
+posix_prep_mkdir(struct io_uring_sqe *sqe, struct posix_uring_ctx *ctx)
+{
+    io_uring_prep_mkdirat(sqe, AT_FDCWD, ctx->fop.entry.real_path,
+                          ctx->fop.entry.mode);
+}
+
+/* The refusals and the repairs posix_mkdir() does before mkdir(2) stay
+ * synchronous: the hidden directory, a missing gfid-req, the preop check on
+ * the parent, a full disk and a gfid already in use by another directory. */
+static gf_boolean_t
+posix_io_uring_mkdir_ok(xlator_t *this, loc_t *loc, dict_t *xdata)
+{
+    struct posix_private *priv = this->private;
+    struct iatt stbuf = {
+        0,
+    };
+    uuid_t uuid_req = {
+        0,
+    };
+
+    if (!loc || !loc->inode || !loc->name)
+        return _gf_false;
+
+    if (__is_root_gfid(loc->pargfid) && !strcmp(loc->name, GF_HIDDEN_PATH))
+        return _gf_false;
+
+    if (priv->disk_space_full)
+        return _gf_false;
+
+    if (!xdata || dict_get_sizen(xdata, GF_PREOP_PARENT_KEY) ||
+        dict_get_gfuuid(xdata, "gfid-req", &uuid_req) ||
+        gf_uuid_is_null(uuid_req))
+        return _gf_false;
+
+    if ((posix_istat(this, loc->inode, uuid_req, NULL, &stbuf) == 0) &&
+        IA_ISDIR(stbuf.ia_type))
+        return _gf_false;
+
+    return _gf_true;
+}
+
+int
+posix_io_uring_mkdir(call_frame_t *frame, xlator_t *this, loc_t *loc,
+                     mode_t mode, mode_t umask, dict_t *xdata)
+{
+    struct posix_private *priv = this->private;
+    struct posix_uring_ctx *ctx = NULL;
+    int32_t op_errno = ENOMEM;
+    mode_t mode_bit = 0;
+    int ret = 0;
+
+    if (!posix_io_uring_mkdir_ok(this, loc, xdata))
+        return posix_mkdir(frame, this, loc, mode, umask, xdata);
+
+    ctx = posix_io_uring_ctx_init_entry(frame, this, loc, GF_FOP_MKDIR,
+                                        posix_prep_mkdir,
+                                        posix_io_uring_mkdir_complete,
+                                        &op_errno, xdata);
+    if (!ctx) {
+        goto err;
+    }
+
+    mode_bit = (priv->create_directory_mask & mode) |
+               priv->force_directory_mode;
+    ctx->fop.entry.mode = posix_override_umask(mode, mode_bit);
+    ctx->fop.entry.gid = frame->root->gid;
+    if (ctx->fop.entry.preparent.ia_prot.sgid) {
+        ctx->fop.entry.gid = ctx->fop.entry.preparent.ia_gid;
+        ctx->fop.entry.mode |= S_ISGID;
+    }
+
+    ret = posix_io_uring_start(this, ctx);
+    if (ret == -EAGAIN) {
+        posix_io_uring_ctx_free(ctx);
+        return posix_mkdir(frame, this, loc, mode, umask, xdata);
+    }
+    if (ret < 0) {
+        op_errno = -ret;
+        goto err;
+    }
+    return 0;
+err:
+    STACK_UNWIND_STRICT(mkdir, frame, -1, op_errno, NULL, NULL, NULL, NULL,
+                        NULL);
+    posix_io_uring_ctx_free(ctx);
+    return 0;
+}
+
+/* The entry is gone but the inode still has other links, drop this one from
+ * the pgfid and gfid2path xattrs through the gfid handle. */
+static void
+posix_io_uring_unlink_links(xlator_t *this, loc_t *loc, struct iatt *stbuf)
+{
+    struct posix_private *priv = this->private;
+    posix_inode_ctx_t *ctx = NULL;
+    char *pgfid_xattr_key = NULL;
+    char *gfid_path = NULL;
+    int32_t nlink_samepgfid = 0;
+    int32_t op_errno = 0;
+    int op_ret = 0;
+
+    MAKE_HANDLE_ABSPATH(gfid_path, this, stbuf->ia_gfid);
+
+    if (priv->update_pgfid_nlinks) {
+        MAKE_PGFID_XATTR_KEY(pgfid_xattr_key, PGFID_XATTR_KEY_PREFIX,
+                             loc->pargfid);
+        op_ret = posix_inode_ctx_get_all(loc->inode, this, &ctx);
+        if (op_ret < 0)
+            goto gfid2path;
+
+        pthread_mutex_lock(&ctx->pgfid_lock);
+        {
+            UNLINK_MODIFY_PGFID_XATTR(gfid_path, pgfid_xattr_key,
+                                      nlink_samepgfid, 0, op_ret, this, unlock);
+        }
+    unlock:
+        pthread_mutex_unlock(&ctx->pgfid_lock);
+
+        if (op_ret < 0)
+            gf_msg(this->name, GF_LOG_WARNING, op_errno, P_MSG_XATTR_FAILED,
+                   "modification of parent gfid xattr failed (path:%s "
+                   "gfid:%s)",
+                   gfid_path, uuid_utoa(stbuf->ia_gfid));
+    }
+
+gfid2path:
+    if (priv->gfid2path)
+        posix_remove_gfid2path_xattr(this, gfid_path, loc->pargfid,
+                                     loc->name);
+}
+
+static void
+posix_io_uring_unlink_complete(struct posix_uring_ctx *ctx, int32_t res)
+{
+    call_frame_t *frame = NULL;
+    xlator_t *this = NULL;
+    struct iatt postparent = {
+        0,
+    };
+    struct iatt *stbuf = NULL;
+    dict_t *unwind_dict = NULL;
+    char *real_path = NULL;
+    char *par_path = NULL;
+    loc_t *loc = NULL;
+    int fd_count = 0;
+    int op_ret = -1;
+    int op_errno = 0;
+    int ret = 0;
+
+    frame = ctx->frame;
+    this = frame->this;
+    loc = &ctx->loc;
+    stbuf = &ctx->prebuf;
+    real_path = ctx->fop.entry.real_path;
+    par_path = ctx->fop.entry.par_path;
+
+    if (res < 0) {
+        op_errno = -res;
+        gf_msg(this->name, GF_LOG_ERROR, op_errno, P_MSG_UNLINK_FAILED,
+               "unlink(async) of %s failed", real_path);
+        goto out;
+    }
+
+    if (stbuf->ia_nlink == 1) {
+        /* that was the last link, the gfid handle goes with it */
+        LOCK(&loc->inode->lock);
+        fd_count = loc->inode->fd_count;
+        UNLOCK(&loc->inode->lock);
+
+        if (fd_count == 0)
+            ret = posix_handle_unset(this, stbuf->ia_gfid, NULL);
+        else
+            ret = posix_move_gfid_to_unlink(this, stbuf->ia_gfid, loc);
+        if (ret)
+            gf_msg(this->name, GF_LOG_ERROR, errno, P_MSG_UNLINK_FAILED,
+                   "unlink of gfid handle failed for path:%s with gfid %s",
+                   real_path, uuid_utoa(stbuf->ia_gfid));
+    } else {
+        posix_io_uring_unlink_links(this, loc, stbuf);
+        posix_set_ctime(frame, this, NULL, -1, loc->inode, stbuf);
+    }
+
+    unwind_dict = dict_new();
+    if (unwind_dict && ctx->xdata &&
+        dict_get_sizen(ctx->xdata, GF_GET_FILE_BLOCK_COUNT)) {
+        ret = dict_set_uint64(unwind_dict, GF_GET_FILE_BLOCK_COUNT,
+                              stbuf->ia_blocks);
+        if (ret)
+            gf_msg(this->name, GF_LOG_WARNING, 0, P_MSG_SET_XDATA_FAIL,
+                   "Failed to set %s in rsp dict", GF_GET_FILE_BLOCK_COUNT);
+    }
+
+    if (posix_pstat(this, loc->parent, loc->pargfid, par_path, &postparent,
+                    _gf_false) == -1) {
+        op_errno = errno;
+        gf_msg(this->name, GF_LOG_ERROR, errno, P_MSG_LSTAT_FAILED,
+               "post-operation lstat on parent %s failed", par_path);
+        goto out;
+    }
+
+    posix_set_parent_ctime(frame, this, par_path, -1, loc->parent, &postparent);
+
+    unwind_dict = posix_dict_set_nlink(ctx->xdata, unwind_dict,
+                                       stbuf->ia_nlink);
+    op_ret = 0;
+out:
+    STACK_UNWIND_STRICT(unlink, frame, op_ret, op_errno,
+                        &ctx->fop.entry.preparent, &postparent, unwind_dict);
+    if (unwind_dict)
+        dict_unref(unwind_dict);
+    posix_io_uring_ctx_free(ctx);
+}
+
+static void
+posix_prep_unlink(struct io_uring_sqe *sqe, struct posix_uring_ctx *ctx)
+{
+    io_uring_prep_unlinkat(sqe, AT_FDCWD, ctx->fop.entry.real_path, 0);
+}
+
+/* DHT's conditional unlinks and the link count it asks for need the inode
+ * lock around the unlink, and the post-op fstat and background unlink need an
+ * fd opened on the entry before it goes. */
+static gf_boolean_t
+posix_io_uring_unlink_ok(struct posix_private *priv, loc_t *loc, dict_t *xdata)
+{
+    if (!loc || !loc->inode || IA_ISDIR(loc->inode->ia_type))
+        return _gf_false;
+
+    if (priv->background_unlink && IA_ISREG(loc->inode->ia_type))
+        return _gf_false;
+
+    if (xdata && (dict_get_sizen(xdata, DHT_SKIP_OPEN_FD_UNLINK) ||
+                  dict_get_sizen(xdata, DHT_SKIP_NON_LINKTO_UNLINK) ||
+                  dict_get_sizen(xdata, DHT_IATT_IN_XDATA_KEY) ||
+                  dict_get_sizen(xdata, GET_LINK_COUNT)))
+        return _gf_false;
+
+    return _gf_true;
+}
+
+int
+posix_io_uring_unlink(call_frame_t *frame, xlator_t *this, loc_t *loc,
+                      int xflag, dict_t *xdata)
+{
+    struct posix_uring_ctx *ctx = NULL;
+    int32_t op_errno = ENOMEM;
+    int ret = 0;
+
+    if (!posix_io_uring_unlink_ok(this->private, loc, xdata))
+        return posix_unlink(frame, this, loc, xflag, xdata);
+
+    ctx = posix_io_uring_ctx_init_entry(frame, this, loc, GF_FOP_UNLINK,
+                                        posix_prep_unlink,
+                                        posix_io_uring_unlink_complete,
+                                        &op_errno, xdata);
+    if (!ctx) {
+        goto err;
+    }
+
+    ret = posix_io_uring_start(this, ctx);
+    if (ret == -EAGAIN) {
+        posix_io_uring_ctx_free(ctx);
+        return posix_unlink(frame, this, loc, xflag, xdata);
+    }
+    if (ret < 0) {
+        op_errno = -ret;
+        goto err;
+    }
+    return 0;
+err:
+    STACK_UNWIND_STRICT(unlink, frame, -1, op_errno, NULL, NULL, NULL);
+    posix_io_uring_ctx_free(ctx);
+    return 0;
+}
+
+/* The pgfid and gfid2path xattrs of a renamed file follow it from the old
+ * parent to the new one. */
+static void
+posix_io_uring_rename_links(xlator_t *this, loc_t *oldloc, loc_t *newloc,
+                            const char *real_newpath)
+{
+    struct posix_private *priv = this->private;
+    posix_inode_ctx_t *ctx = NULL;
+    char *pgfid_xattr_key = NULL;
+    char *gfid_path = NULL;
+    int32_t nlink_samepgfid = 0;
+    int32_t op_errno = 0;
+    int op_ret = 0;
+
+    if (priv->update_pgfid_nlinks) {
+        op_ret = posix_inode_ctx_get_all(oldloc->inode, this, &ctx);
+        if (op_ret < 0)
+            goto gfid2path;
+
+        pthread_mutex_lock(&ctx->pgfid_lock);
+        {
+            MAKE_PGFID_XATTR_KEY(pgfid_xattr_key, PGFID_XATTR_KEY_PREFIX,
+                                 oldloc->pargfid);
+            UNLINK_MODIFY_PGFID_XATTR(real_newpath, pgfid_xattr_key,
+                                      nlink_samepgfid, 0, op_ret, this, unlock);
+
+            MAKE_PGFID_XATTR_KEY(pgfid_xattr_key, PGFID_XATTR_KEY_PREFIX,
+                                 newloc->pargfid);
+            LINK_MODIFY_PGFID_XATTR(real_newpath, pgfid_xattr_key,
+                                    nlink_samepgfid, 0, op_ret, this, unlock);
+        }
+    unlock:
+        pthread_mutex_unlock(&ctx->pgfid_lock);
+
+        if (op_ret < 0)
+            gf_msg(this->name, GF_LOG_WARNING, op_errno, P_MSG_XATTR_FAILED,
+                   "modification of parent gfid xattr failed (gfid:%s)",
+                   uuid_utoa(oldloc->inode->gfid));
+    }
+
+gfid2path:
+    if (priv->gfid2path) {
+        MAKE_HANDLE_ABSPATH(gfid_path, this, oldloc->inode->gfid);
+
+        posix_remove_gfid2path_xattr(this, gfid_path, oldloc->pargfid,
+                                     oldloc->name);
+        posix_set_gfid2path_xattr(this, gfid_path, newloc->pargfid,
+                                  newloc->name);
+    }
+}
+
+static void
+posix_io_uring_rename_complete(struct posix_uring_ctx *ctx, int32_t res)
+{
+    call_frame_t *frame = NULL;
+    xlator_t *this = NULL;
+    struct iatt stbuf = {
+        0,
+    };
+    struct iatt postoldparent = {
+        0,
+    };
+    struct iatt postnewparent = {
+        0,
+    };
+    dict_t *unwind_dict = NULL;
+    char *real_oldpath = NULL;
+    char *real_newpath = NULL;
+    loc_t *oldloc = NULL;
+    loc_t *newloc = NULL;
+    int op_ret = -1;
+    int op_errno = 0;
+
+    frame = ctx->frame;
+    this = frame->this;
+    oldloc = &ctx->loc;
+    newloc = &ctx->fop.entry.newloc;
+    real_oldpath = ctx->fop.entry.real_path;
+    real_newpath = ctx->fop.entry.real_newpath;
+
+    if (res < 0) {
+        op_errno = -res;
+        if (op_errno == ENOTEMPTY) {
+            gf_msg_debug(this->name, op_errno, "rename of %s to %s failed",
+                         real_oldpath, real_newpath);
+        } else {
+            gf_msg(this->name, GF_LOG_ERROR, op_errno, P_MSG_RENAME_FAILED,
+                   "rename(async) of %s to %s failed", real_oldpath,
+                   real_newpath);
+        }
+        goto out;
+    }
+
+    if (IA_ISDIR(oldloc->inode->ia_type)) {
+        /* the handle of a directory is a symlink to its entry */
+        posix_handle_unset(this, oldloc->inode->gfid, NULL);
+        posix_handle_soft(this, real_newpath, newloc, oldloc->inode->gfid,
+                          NULL);
+    } else {
+        posix_io_uring_rename_links(this, oldloc, newloc, real_newpath);
+    }
+
+    if (ctx->fop.entry.was_dir ||
+        (ctx->fop.entry.was_present && (ctx->fop.entry.nlink == 1)))
+        posix_handle_unset(this, ctx->fop.entry.victim, NULL);
+
+    if (posix_pstat(this, newloc->inode, NULL, real_newpath, &stbuf,
+                    _gf_false) == -1) {
+        op_errno = errno;
+        gf_msg(this->name, GF_LOG_ERROR, errno, P_MSG_LSTAT_FAILED,
+               "lstat on %s failed", real_newpath);
+        goto out;
+    }
+
+    posix_set_ctime(frame, this, real_newpath, -1, oldloc->inode, &stbuf);
+
+    if (posix_pstat(this, oldloc->parent, oldloc->pargfid,
+                    ctx->fop.entry.par_path, &postoldparent,
+                    _gf_false) == -1) {
+        op_errno = errno;
+        gf_msg(this->name, GF_LOG_ERROR, errno, P_MSG_LSTAT_FAILED,
+               "post-operation lstat on parent %s failed",
+               ctx->fop.entry.par_path);
+        goto out;
+    }
+
+    posix_set_parent_ctime(frame, this, ctx->fop.entry.par_path, -1,
+                           oldloc->parent, &postoldparent);
+
+    if (posix_pstat(this, newloc->parent, newloc->pargfid,
+                    ctx->fop.entry.par_newpath, &postnewparent,
+                    _gf_false) == -1) {
+        op_errno = errno;
+        gf_msg(this->name, GF_LOG_ERROR, errno, P_MSG_LSTAT_FAILED,
+               "post-operation lstat on parent %s failed",
+               ctx->fop.entry.par_newpath);
+        goto out;
+    }
+
+    posix_set_parent_ctime(frame, this, ctx->fop.entry.par_newpath, -1,
+                           newloc->parent, &postnewparent);
+
+    if (ctx->fop.entry.was_present)
+        unwind_dict = posix_dict_set_nlink(ctx->xdata, NULL,
+                                           ctx->fop.entry.nlink);
+    op_ret = 0;
+out:
+    STACK_UNWIND_STRICT(rename, frame, op_ret, op_errno, &stbuf,
+                        &ctx->fop.entry.preparent, &postoldparent,
+                        &ctx->fop.entry.prenewparent, &postnewparent,
+                        unwind_dict);
+    if (unwind_dict)
+        dict_unref(unwind_dict);
+    posix_io_uring_ctx_free(ctx);
+}
+
+static void
+posix_prep_rename(struct io_uring_sqe *sqe, struct posix_uring_ctx *ctx)
+{
+    io_uring_prep_renameat(sqe, AT_FDCWD, ctx->fop.entry.real_path, AT_FDCWD,
+                           ctx->fop.entry.real_newpath, 0);
+}
+
+/* Look at what the rename is going to replace, as posix_rename() does. */
+static int
+posix_io_uring_rename_target(xlator_t *this, struct posix_uring_ctx *ctx,
+                             int32_t *op_errno)
+{
+    loc_t *newloc = &ctx->fop.entry.newloc;
+    struct iatt stbuf = {
+        0,
+    };
+    char olddirid[64];
+    char newdirid[64];
+
+    if (posix_io_uring_entry_path(this, newloc, &ctx->fop.entry.real_newpath,
+                                  &ctx->fop.entry.par_newpath, &stbuf,
+                                  &ctx->fop.entry.prenewparent,
+                                  op_errno) < 0)
+        return -1;
+
+    if ((posix_pstat(this, newloc->inode, NULL, ctx->fop.entry.real_newpath,
+                     &stbuf, _gf_false) == -1) &&
+        (errno == ENOENT))
+        return 0;
+
+    ctx->fop.entry.was_present = _gf_true;
+    gf_uuid_copy(ctx->fop.entry.victim, stbuf.ia_gfid);
+    ctx->fop.entry.was_dir = IA_ISDIR(stbuf.ia_type);
+    ctx->fop.entry.nlink = stbuf.ia_nlink;
+
+    if (ctx->fop.entry.was_dir && !newloc->inode) {
+        gf_msg(this->name, GF_LOG_WARNING, EEXIST, P_MSG_DIR_FOUND,
+               "found directory at %s while expecting ENOENT",
+               ctx->fop.entry.real_newpath);
+        *op_errno = EEXIST;
+        return -1;
+    }
+
+    if (ctx->fop.entry.was_dir &&
+        gf_uuid_compare(newloc->inode->gfid, stbuf.ia_gfid)) {
+        gf_msg(this->name, GF_LOG_WARNING, EEXIST, P_MSG_DIR_FOUND,
+               "found directory %s at %s while renaming %s",
+               uuid_utoa_r(newloc->inode->gfid, olddirid),
+               ctx->fop.entry.real_newpath,
+               uuid_utoa_r(stbuf.ia_gfid, newdirid));
+        *op_errno = EEXIST;
+        return -1;
+    }
+
+    return 0;
+}
+
+int
+posix_io_uring_rename(call_frame_t *frame, xlator_t *this, loc_t *oldloc,
+                      loc_t *newloc, dict_t *xdata)
+{
+    struct posix_uring_ctx *ctx = NULL;
+    int32_t op_errno = ENOMEM;
+    int ret = 0;
+
+    /* the link count DHT asks for is read under the lock of the target,
+     * across the rename */
+    if (!oldloc || !oldloc->inode || !newloc ||
+        (xdata && dict_get_sizen(xdata, GET_LINK_COUNT)))
+        return posix_rename(frame, this, oldloc, newloc, xdata);
+
+    ctx = posix_io_uring_ctx_init_entry(frame, this, oldloc, GF_FOP_RENAME,
+                                        posix_prep_rename,
+                                        posix_io_uring_rename_complete,
+                                        &op_errno, xdata);
+    if (!ctx) {
+        goto err;
+    }
+
+    if (loc_copy(&ctx->fop.entry.newloc, newloc) != 0) {
+        op_errno = ENOMEM;
+        goto err;
+    }
+
+    if (posix_io_uring_rename_target(this, ctx, &op_errno) < 0)
+        goto err;
+
+    ret = posix_io_uring_start(this, ctx);
+    if (ret == -EAGAIN) {
+        posix_io_uring_ctx_free(ctx);
+        return posix_rename(frame, this, oldloc, newloc, xdata);
+    }
+    if (ret < 0) {
+        op_errno = -ret;
+        goto err;
+    }
+    return 0;
+err:
+    STACK_UNWIND_STRICT(rename, frame, -1, op_errno, NULL, NULL, NULL, NULL,
+                        NULL, NULL);
+    posix_io_uring_ctx_free(ctx);
+    return 0;
+}
+
+static int
+posix_io_uring_submit(xlator_t *this, struct posix_uring_ctx *ctx)
+{
+    struct posix_private *priv = this->private;
+    struct io_uring_sqe *sqe = NULL;
+    int ret = 0;
+
+    pthread_mutex_lock(&priv->sq_mutex);
+    {
+        sqe = io_uring_get_sqe(&priv->ring);
+        if (!sqe) {
+            /*TODO: Retry until we get an sqe instead of failing. */
+            pthread_mutex_unlock(&priv->sq_mutex);
+            ret = -EAGAIN;
+            gf_msg(this->name, GF_LOG_ERROR, -ret, P_MSG_POSIX_IO_URING,
+                   "Failed to get sqe");
+            goto out;
+        }
+        ctx->prepare(sqe, ctx);
+        if (ctx->file_index >= 0) {
+            sqe->fd = ctx->file_index;
+            sqe->flags |= IOSQE_FIXED_FILE;
+        }
+        io_uring_sqe_set_data(sqe, ctx);
+        ret = io_uring_submit(&priv->ring);
+    }
+    pthread_mutex_unlock(&priv->sq_mutex);
+
+out:
+    return ret;
+}
+
+static void *
+posix_io_uring_thread(void *data)
+{
+    xlator_t *this = NULL;
+    struct posix_private *priv = NULL;
+    int ret = 0;
+    int32_t res = 0;
+    struct io_uring_cqe *cqe = NULL;
+    struct posix_uring_ctx *ctx = NULL;
+
+    this = data;
+    THIS = this;
+    priv = this->private;
+    while (1) {
+        pthread_mutex_lock(&priv->cq_mutex);
+        {
+            ret = io_uring_wait_cqe(&priv->ring, &cqe);
+        }
+        pthread_mutex_unlock(&priv->cq_mutex);
+        if (ret != 0) {
+            if (ret == -EINTR)
+                continue;
+            gf_msg(this->name, GF_LOG_WARNING, -ret, P_MSG_POSIX_IO_URING,
+                   "Unable to get cqe. Exiting.");
+            abort();
+        }
+
+        ctx = (struct posix_uring_ctx *)io_uring_cqe_get_data(cqe);
+        if (priv->uring_thread_exit == _gf_true && ctx == NULL)
+            pthread_exit(NULL);
+        res = cqe->res;
+        io_uring_cqe_seen(&priv->ring, cqe);
+        ctx->unwind(ctx, res);
+    }
+
+    return NULL;
+}
+
+/* Notes the arenas mapped and unmapped by the iobuf pool. Called under the
+ * pool mutex, the ring itself is updated by posix_io_uring_buf_sync() on the
+ * next submission, so that the pool is never held across io_uring_register()
+ * while the kernel pins or releases the pages of the arena. */
+static void
+posix_io_uring_arena_notify(struct iobuf_arena *arena, int mapped, void *data)
+{
+    xlator_t *this = data;
+    struct posix_private *priv = this->private;
+    struct iovec iov = {
+        0,
+    };
+
+    if (mapped) {
+        iov.iov_base = arena->mem_base;
+        iov.iov_len = arena->arena_size;
+    }
+
+    LOCK(&priv->uring_buf_lock);
+    {
+        /* not usable until the kernel has the new entry */
+        priv->uring_buf_registered[arena->slot] = 0;
+        priv->uring_buf_pending[arena->slot] = iov;
+        if (!priv->uring_buf_dirty[arena->slot]) {
+            priv->uring_buf_dirty[arena->slot] = 1;
+            priv->uring_buf_npending++;
+        }
+    }
+    UNLOCK(&priv->uring_buf_lock);
+}
+
+static void
+posix_io_uring_register(xlator_t *this)
+{
+#ifdef HAVE_LIBURING_REGISTER_SPARSE
+    struct posix_private *priv = this->private;
+    int ret = 0;
+    int i = 0;
+
+    ret = io_uring_register_buffers_sparse(&priv->ring, GF_IOBUF_ARENA_SLOTS);
+    if (ret == 0) {
+        LOCK_INIT(&priv->uring_buf_lock);
+        pthread_mutex_init(&priv->uring_buf_mutex, NULL);
+        GF_ATOMIC_INIT(priv->uring_fixed_ios, 0);
+        GF_ATOMIC_INIT(priv->uring_buf_released, 0);
+        priv->uring_fixed_bufs = _gf_true;
+        if (iobuf_pool_add_arena_notify(this->ctx->iobuf_pool,
+                                        posix_io_uring_arena_notify,
+                                        this) != 0) {
+            priv->uring_fixed_bufs = _gf_false;
+            io_uring_unregister_buffers(&priv->ring);
+            LOCK_DESTROY(&priv->uring_buf_lock);
+            pthread_mutex_destroy(&priv->uring_buf_mutex);
+        }
+    }
+    if (!priv->uring_fixed_bufs)
+        gf_msg(this->name, GF_LOG_INFO, -ret, P_MSG_POSIX_IO_URING,
+               "io_uring fixed buffers unavailable, using plain read/write");
+
+    ret = io_uring_register_files_sparse(&priv->ring, POSIX_URING_MAX_FILES);
+    if (ret == 0) {
+        priv->uring_files = GF_CALLOC(POSIX_URING_MAX_FILES, sizeof(int),
+                                      gf_common_mt_int);
+        if (!priv->uring_files) {
+            io_uring_unregister_files(&priv->ring);
+            return;
+        }
+        for (i = 0; i < POSIX_URING_MAX_FILES; i++)
+            priv->uring_files[i] = POSIX_URING_MAX_FILES - 1 - i;
+        priv->uring_files_free = POSIX_URING_MAX_FILES;
+    } else {
+        gf_msg(this->name, GF_LOG_INFO, -ret, P_MSG_POSIX_IO_URING,
+               "io_uring registered files unavailable");
+    }
+#endif
+}
+
+void
+posix_io_uring_release_fd(xlator_t *this, struct posix_fd *pfd)
+{
+    struct posix_private *priv = this->private;
+    int fd = -1;
+    int index = 0;
+
+    if (!pfd->uring_file)
+        return;
+
+    pthread_mutex_lock(&priv->sq_mutex);
+    {
+        index = pfd->uring_file - 1;
+        pfd->uring_file = 0;
+        if (priv->uring_files &&
+            (pfd->uring_files_gen == priv->uring_files_gen)) {
+            (void)io_uring_register_files_update(&priv->ring, index, &fd, 1);
+            priv->uring_files[priv->uring_files_free++] = index;
+        }
+    }
+    pthread_mutex_unlock(&priv->sq_mutex);
+}
+
+int
+posix_io_uring_init(xlator_t *this)
+{
+    int ret = -1;
+    unsigned flags = 0;
+    struct posix_private *priv = this->private;
+
+    // TODO:Try-out flags |= IORING_SETUP_IOPOLL;
+    ret = io_uring_queue_init(POSIX_URING_MAX_ENTRIES, &priv->ring, flags);
+    if (ret == -1) {
+        gf_msg(this->name, GF_LOG_ERROR, 0, P_MSG_POSIX_IO_URING,
+               "io_uring init failed.");
+        goto out;
+    }
+
+    /* Older kernels lack some of the opcodes, those fops are then left on
+     * the synchronous path. */
+    priv->uring_probe = io_uring_get_probe_ring(&priv->ring);
+    posix_io_uring_register(this);
+
+    pthread_mutex_init(&priv->cq_mutex, NULL);
+    priv->uring_thread_exit = _gf_false;
+    ret = gf_thread_create(&priv->uring_thread, NULL, posix_io_uring_thread,
+                           this, "posix-iouring");
+    if (ret != 0) {
+        if (priv->uring_fixed_bufs) {
+            iobuf_pool_del_arena_notify(this->ctx->iobuf_pool,
+                                        posix_io_uring_arena_notify, this);
+            priv->uring_fixed_bufs = _gf_false;
+            LOCK_DESTROY(&priv->uring_buf_lock);
+            pthread_mutex_destroy(&priv->uring_buf_mutex);
+        }
+        GF_FREE(priv->uring_files);
+        priv->uring_files = NULL;
+        if (priv->uring_probe) {
+            io_uring_free_probe(priv->uring_probe);
+            priv->uring_probe = NULL;
+        }
+        io_uring_queue_exit(&priv->ring);
+        pthread_mutex_destroy(&priv->cq_mutex);
+        goto out;
+    }
+
+out:
+    return ret;
+}
+
+static int
+posix_io_uring_drain(struct posix_private *priv)
+{
+    struct io_uring_sqe *sqe = NULL;
+    int ret = -1;
+
+    priv->uring_thread_exit = _gf_true;
+    sqe = io_uring_get_sqe(&priv->ring);
+    if (!sqe)
+        return ret;
+
+    io_uring_sqe_set_flags(sqe, IOSQE_IO_DRAIN);
+    io_uring_sqe_set_data(sqe, NULL);
+    io_uring_prep_nop(sqe);
+    ret = io_uring_submit(&priv->ring);
+
+    return ret;
+}
+
+void
+posix_io_uring_fini(xlator_t *this)
+{
+    struct posix_private *priv = this->private;
 
     posix_io_uring_drain(priv);
     (void)pthread_join(priv->uring_thread, NULL);
+    if (priv->uring_fixed_bufs) {
+        iobuf_pool_del_arena_notify(this->ctx->iobuf_pool,
+                                    posix_io_uring_arena_notify, this);
+        priv->uring_fixed_bufs = _gf_false;
+        memset(priv->uring_buf_registered, 0,
+               sizeof(priv->uring_buf_registered));
+        /* the whole table goes away with the ring */
+        memset(priv->uring_buf_dirty, 0, sizeof(priv->uring_buf_dirty));
+        memset(priv->uring_buf_live, 0, sizeof(priv->uring_buf_live));
+        priv->uring_buf_npending = 0;
+        LOCK_DESTROY(&priv->uring_buf_lock);
+        pthread_mutex_destroy(&priv->uring_buf_mutex);
+    }
+    /* fds released from now on have nothing left to unregister, and the
+     * slots they hold are void in the table of the next ring */
+    pthread_mutex_lock(&priv->sq_mutex);
+    {
+        GF_FREE(priv->uring_files);
+        priv->uring_files = NULL;
+        priv->uring_files_free = 0;
+        priv->uring_files_gen++;
+    }
+    pthread_mutex_unlock(&priv->sq_mutex);
+    if (priv->uring_probe) {
+        io_uring_free_probe(priv->uring_probe);
+        priv->uring_probe = NULL;
+    }
     io_uring_queue_exit(&priv->ring);
-    pthread_mutex_destroy(&priv->sq_mutex);
     pthread_mutex_destroy(&priv->cq_mutex);
 }
 
@@ -592,6 +2945,31 @@ posix_io_uring_on(xlator_t *this)
         this->fops->readv = posix_io_uring_readv;
         this->fops->writev = posix_io_uring_writev;
         this->fops->fsync = posix_io_uring_fsync;
+        if (posix_io_uring_op_supported(priv, IORING_OP_STATX)) {
+            this->fops->stat = posix_io_uring_stat;
+            this->fops->fstat = posix_io_uring_fstat;
+        }
+        if (posix_io_uring_op_supported(priv, IORING_OP_OPENAT))
+            this->fops->open = posix_io_uring_open;
+        if (posix_io_uring_op_supported(priv, IORING_OP_FALLOCATE)) {
+            this->fops->fallocate = posix_io_uring_fallocate;
+            this->fops->discard = posix_io_uring_discard;
+            this->fops->zerofill = posix_io_uring_zerofill;
+        }
+        if (posix_io_uring_op_supported(priv, IORING_OP_FGETXATTR))
+            this->fops->fgetxattr = posix_io_uring_fgetxattr;
+        if (posix_io_uring_op_supported(priv, IORING_OP_FSETXATTR))
+            this->fops->fsetxattr = posix_io_uring_fsetxattr;
+        if (posix_io_uring_op_supported(priv, IORING_OP_GETXATTR))
+            this->fops->getxattr = posix_io_uring_getxattr;
+        if (posix_io_uring_op_supported(priv, IORING_OP_SETXATTR))
+            this->fops->setxattr = posix_io_uring_setxattr;
+        if (posix_io_uring_op_supported(priv, IORING_OP_MKDIRAT))
+            this->fops->mkdir = posix_io_uring_mkdir;
+        if (posix_io_uring_op_supported(priv, IORING_OP_UNLINKAT))
+            this->fops->unlink = posix_io_uring_unlink;
+        if (posix_io_uring_op_supported(priv, IORING_OP_RENAMEAT))
+            this->fops->rename = posix_io_uring_rename;
         ret = 0;
     }
 
@@ -611,8 +2989,25 @@ posix_io_uring_off(xlator_t *this)
     this->fops->readv = posix_readv;
     this->fops->writev = posix_writev;
     this->fops->fsync = posix_fsync;
-    if (priv->io_uring_capable)
+    this->fops->stat = posix_stat;
+    this->fops->fstat = posix_fstat;
+    this->fops->open = posix_open;
+    this->fops->fallocate = posix_glfallocate;
+    this->fops->discard = posix_discard;
+    this->fops->zerofill = posix_zerofill;
+    this->fops->fgetxattr = posix_fgetxattr;
+    this->fops->fsetxattr = posix_fsetxattr;
+    this->fops->getxattr = posix_getxattr;
+    this->fops->setxattr = posix_setxattr;
+    this->fops->mkdir = posix_mkdir;
+    this->fops->unlink = posix_unlink;
+    this->fops->rename = posix_rename;
+    if (priv->io_uring_capable) {
         posix_io_uring_fini(this);
+        /* turning it on again sets up a new ring */
+        priv->io_uring_init_done = _gf_false;
+        priv->io_uring_capable = _gf_false;
+    }
 
     return 0;
 }
@@ -633,4 +3028,9 @@ posix_io_uring_off(xlator_t *this)
     return 0;
 }
 
+void
+posix_io_uring_release_fd(xlator_t *this, struct posix_fd *pfd)
+{
+}
+
 #endif
@@ -131,7 +131,8 @@ struct posix_fd {
     struct list_head list; /* to add to the janitor list */
     int odirect;
     xlator_t *xl;
-    char _pad[4]; /* manual padding */
+    int uring_file; /* index in the io_uring file table + 1, 0 if none */
+    uint32_t uring_files_gen; /* of the table uring_file belongs to */
 };
 
 struct posix_diskxl {
@@ -274,8 +275,29 @@ struct posix_private {
     gf_boolean_t io_uring_capable;
     gf_boolean_t uring_thread_exit;
     pthread_t uring_thread;
-    pthread_mutex_t sq_mutex;
+    pthread_mutex_t sq_mutex; /* lives as long as the xlator, unlike the
+                                 ring */
     pthread_mutex_t cq_mutex;
+    struct io_uring_probe *uring_probe;
+    /* iobuf arenas registered as fixed buffers, by arena slot */
+    gf_boolean_t uring_fixed_bufs;
+    unsigned char uring_buf_registered[GF_IOBUF_ARENA_SLOTS];
+    /* arenas (un)mapped since the last submission, noted under the iobuf
+     * pool mutex and uring_buf_lock, registered with the ring afterwards
+     * under uring_buf_mutex, which also covers uring_buf_live */
+    gf_lock_t uring_buf_lock;
+    pthread_mutex_t uring_buf_mutex;
+    struct iovec uring_buf_pending[GF_IOBUF_ARENA_SLOTS];
+    unsigned char uring_buf_dirty[GF_IOBUF_ARENA_SLOTS];
+    unsigned char uring_buf_live[GF_IOBUF_ARENA_SLOTS];
+    int uring_buf_npending;
+    gf_atomic_t uring_fixed_ios;
+    gf_atomic_t uring_buf_released;
+    /* free indices of the registered file table, under sq_mutex. The
+     * generation tells the tables of successive rings apart. */
+    int *uring_files;
+    int uring_files_free;
+    uint32_t uring_files_gen;
 #endif
     void *pxl;
 };
@@ -350,6 +372,9 @@ posix_gfid_set(xlator_t *this, const char *path, loc_t *loc, dict_t *xattr_req,
 int
 posix_fdstat(xlator_t *this, inode_t *inode, int fd, struct iatt *stbuf_p);
 int
+posix_fdstat_from_stat(xlator_t *this, inode_t *inode, int fd,
+                       struct stat *fstatbuf, struct iatt *stbuf_p);
+int
 posix_istat(xlator_t *this, inode_t *inode, uuid_t gfid, const char *basename,
             struct iatt *iatt);
 int
@@ -407,6 +432,23 @@ posix_resolve_dirgfid_to_path(const uuid_t dirgfid, const char *brick_path,
 void
 posix_gfid_unset(xlator_t *this, dict_t *xdata);
 
+int
+posix_acl_xattr_set(const char *path, dict_t *xattr_req);
+
+int32_t
+posix_set_gfid2path_xattr(xlator_t *this, const char *path, uuid_t pgfid,
+                          const char *bname);
+
+int32_t
+posix_remove_gfid2path_xattr(xlator_t *this, const char *path, uuid_t pgfid,
+                             const char *bname);
+
+int32_t
+posix_move_gfid_to_unlink(xlator_t *this, uuid_t gfid, loc_t *loc);
+
+dict_t *
+posix_dict_set_nlink(dict_t *req, dict_t *res, int32_t nlink);
+
 int
 posix_pacl_get(const char *path, int fdnum, const char *key, char **acl_s);
 